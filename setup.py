@@ -58,12 +58,13 @@ setup(
     packages=find_packages(exclude=['tests']),
     install_requires=[],
     package_data={
-        'shivyc': ['include/*.h'],
+        'shivyc': ['include/*.h', 'runtime/*.c'],
     },
 
     entry_points={
         'console_scripts': [
             'shivyc=shivyc.main:main',
+            'shivyc-client=shivyc.server:client_main',
         ],
     },
 
@@ -0,0 +1,200 @@
+"""Passing of arguments and return values under the System V x86-64 ABI.
+
+Each argument is classified by its type. A struct or union of more than 16
+bytes has class MEMORY and is copied onto the stack. Any other argument is
+split into eightbytes, its 8-byte pieces, and each eightbyte is passed in
+a register of its own class: SSE if it holds only floating values, passed
+in the next of XMM0 to XMM7, and INTEGER otherwise, passed in the next
+general argument register. An argument is passed on the stack instead if
+not enough registers are left for all of its eightbytes.
+
+Arguments on the stack take a whole number of eightbytes each, and are
+stored in order just above the return address, so the first one is at
+[rsp] when the function is called.
+
+A return value is returned with its INTEGER eightbytes in RAX and then RDX,
+and its SSE eightbytes in XMM0 and then XMM1. For a return value of class
+MEMORY, the caller passes the address to store the value at in RDI, as a
+hidden first argument, and the function returns that address in RAX.
+
+A function which takes a variable number of arguments, or may, since it
+has no prototype, is called with the number of SSE registers used in AL.
+"""
+
+import shivyc.asm_cmds as asm_cmds
+import shivyc.spots as spots
+from shivyc.spots import LiteralSpot, MemSpot
+
+arg_regs = [spots.RDI, spots.RSI, spots.RDX, spots.RCX, spots.R8, spots.R9]
+ret_regs = [spots.RAX, spots.RDX]
+sse_arg_regs = spots.xmm_registers[:8]
+sse_ret_regs = spots.xmm_registers[:2]
+
+# Classes of an eightbyte passed in a register.
+INTEGER = "INTEGER"
+SSE = "SSE"
+
+
+class ArgLocation:
+    """Location of an argument passed to a function.
+
+    regs (List[Spot]) - Registers holding the eightbytes of the argument,
+    in order, or an empty list if the argument is passed on the stack. Each
+    is a general register or an SSE register, by the class of its eightbyte.
+    offset (int) - If the argument is passed on the stack, its offset from
+    RSP when the function is called.
+    """
+
+    def __init__(self, regs, offset=None):
+        """Initialize ArgLocation."""
+        self.regs = regs
+        self.offset = offset
+
+
+def eightbytes(ctype):
+    """Return the number of eightbytes a value of given type takes."""
+    return (ctype.size + 7) // 8
+
+
+def in_memory(ctype):
+    """Return whether given type has class MEMORY.
+
+    A value is in memory if it is larger than two eightbytes, or if a
+    packed struct leaves a member of it unaligned.
+    """
+    if ctype.is_void():
+        return False
+    return ctype.size > 16 or any(
+        offset % scalar.align for offset, scalar in _scalars(ctype, 0))
+
+
+def classes(ctype):
+    """Return the class of each eightbyte of given type, not of class MEMORY.
+    """
+    floating = [True] * eightbytes(ctype)
+    for offset, scalar in _scalars(ctype, 0):
+        if not scalar.is_floating():
+            floating[offset // 8] = False
+    return [SSE if f else INTEGER for f in floating]
+
+
+def _scalars(ctype, offset):
+    """Yield the offset and type of each scalar in a value of given type,
+    at `offset` bytes into the value.
+    """
+    if ctype.is_struct_union():
+        for member_offset, member in ctype.offsets.values():
+            yield from _scalars(member, offset + member_offset)
+    elif ctype.is_array():
+        for n in range(ctype.n or 0):
+            yield from _scalars(ctype.el, offset + n * ctype.el.size)
+    else:
+        yield offset, ctype
+
+
+def arg_locations(arg_types, ret):
+    """Return where each argument of a call is passed.
+
+    arg_types (List[CType]) - Types of the arguments, in order.
+    ret (CType) - Return type of the function called.
+    returns - a list of the ArgLocation of each argument, and the number of
+    bytes of arguments passed on the stack
+    """
+    next_reg = {INTEGER: 1 if in_memory(ret) else 0, SSE: 0}
+    regs = {INTEGER: arg_regs, SSE: sse_arg_regs}
+    stack_size = 0
+
+    locations = []
+    for ctype in arg_types:
+        arg_classes = [] if in_memory(ctype) else classes(ctype)
+        if arg_classes and all(
+                next_reg[c] + arg_classes.count(c) <= len(regs[c])
+                for c in arg_classes):
+            location = []
+            for c in arg_classes:
+                location.append(regs[c][next_reg[c]])
+                next_reg[c] += 1
+            locations.append(ArgLocation(location))
+        else:
+            locations.append(ArgLocation([], stack_size))
+            stack_size += 8 * eightbytes(ctype)
+
+    return locations, stack_size
+
+
+def ret_locations(ctype):
+    """Return the registers holding each eightbyte of a return value of
+    given type, not of class MEMORY.
+    """
+    regs = {INTEGER: iter(ret_regs), SSE: iter(sse_ret_regs)}
+    return [next(regs[c]) for c in classes(ctype)]
+
+
+def sse_count(locations):
+    """Return the number of SSE registers the given ArgLocations use."""
+    return sum(1 for location in locations for reg in location.regs
+               if reg in sse_arg_regs)
+
+
+def parts(ctype):
+    """Return the offset and size of each eightbyte of given type."""
+    return [(shift, min(8, ctype.size - shift))
+            for shift in range(0, ctype.size, 8)]
+
+
+def _pieces(size):
+    """Split the size of an eightbyte into sizes a register can move.
+
+    returns - list of the offset and size of each piece, largest first
+    """
+    pieces = []
+    shift = 0
+    for piece in [4, 2, 1]:
+        if size - shift >= piece:
+            pieces.append((shift, piece))
+            shift += piece
+    return pieces
+
+
+def load_part(reg, spot, size, get_tmp, asm_code):
+    """Emit code to load an eightbyte of `size` bytes at `spot` into `reg`.
+
+    If the size is not one of 1, 2, 4, or 8, the eightbyte is loaded in
+    pieces, combined through a register from `get_tmp()`. No bytes past the
+    end of the eightbyte are read.
+    """
+    if size in {1, 2, 4, 8} or not isinstance(spot, MemSpot):
+        if spot != reg:
+            asm_code.add(asm_cmds.Mov(reg, spot, size))
+        return
+
+    tmp = get_tmp()
+    for shift, piece in _pieces(size):
+        dest = tmp if shift else reg
+        if piece == 4:
+            asm_code.add(asm_cmds.Mov(dest, spot.shift(shift), 4))
+        else:
+            asm_code.add(asm_cmds.Movzx(dest, spot.shift(shift), 8, piece))
+
+        if shift:
+            asm_code.add(asm_cmds.Sal(tmp, LiteralSpot(8 * shift), 8, 1))
+            asm_code.add(asm_cmds.Or(reg, tmp, 8))
+
+
+def store_part(spot, reg, size, asm_code):
+    """Emit code to store an eightbyte of `size` bytes in `reg` to `spot`.
+
+    If the size is not one of 1, 2, 4, or 8, the eightbyte is stored in
+    pieces, shifting each piece out of `reg`, so `reg` is clobbered. No bytes
+    past the end of the eightbyte are written.
+    """
+    if size in {1, 2, 4, 8} or not isinstance(spot, MemSpot):
+        if spot != reg:
+            asm_code.add(asm_cmds.Mov(spot, reg, size))
+        return
+
+    pieces = _pieces(size)
+    for n, (shift, piece) in enumerate(pieces):
+        asm_code.add(asm_cmds.Mov(spot.shift(shift), reg, piece))
+        if n + 1 < len(pieces):
+            asm_code.add(asm_cmds.Shr(reg, LiteralSpot(8 * piece), 8, 1))
@@ -1,10 +1,15 @@
 """This module defines and implements classes representing assembly commands.
 
 The _ASMCommand object is the base class for most ASM commands. Some commands
-inherit from _ASMCommandMultiSize or _JumpCommand instead.
+inherit from _ASMCommandMultiSize or _JumpCommand instead. Commands store
+their operands as Spot objects, and are only converted to text when the
+final assembly code is produced, so later passes like the peephole optimizer
+can inspect them.
 
 """
 
+from shivyc.spots import RegSpot, XMMSpot
+
 
 class _ASMCommand:
     """Base class for a standard ASMCommand, like `add` or `imul`.
@@ -16,16 +21,16 @@ class _ASMCommand:
     name = None
 
     def __init__(self, dest=None, source=None, size=None):
-        self.dest = dest.asm_str(size) if dest else None
-        self.source = source.asm_str(size) if source else None
+        self.dest = dest
+        self.source = source
         self.size = size
 
     def __str__(self):
         s = "\t" + self.name
         if self.dest:
-            s += " " + self.dest
+            s += " " + self.dest.asm_str(self.size)
         if self.source:
-            s += ", " + self.source
+            s += ", " + self.source.asm_str(self.size)
         return s
 
 
@@ -38,20 +43,89 @@ class _ASMCommandMultiSize:
     name = None
 
     def __init__(self, dest, source, source_size, dest_size):
-        self.dest = dest.asm_str(source_size)
-        self.source = source.asm_str(dest_size)
+        self.dest = dest
+        self.source = source
         self.source_size = source_size
         self.dest_size = dest_size
 
     def __str__(self):
         s = "\t" + self.name
         if self.dest:
-            s += " " + self.dest
+            s += " " + self.dest.asm_str(self.source_size)
         if self.source:
-            s += ", " + self.source
+            s += ", " + self.source.asm_str(self.dest_size)
+        return s
+
+
+class _VectorCommand:
+    """Base class for a command on SSE or AVX vector registers.
+
+    With a `size` of 16 this is the SSE form of the command, on 128-bit
+    registers. With a size of 32 it is the AVX form, on 256-bit registers,
+    named with a "v" prefix. A command computing dest from two operands
+    computes it from dest and source in the SSE form and from `first` and
+    source in the AVX form, where `first` is a register. Commands such as
+    pshufd take an immediate byte `imm` as their last operand.
+    """
+
+    name = None
+
+    def __init__(self, dest, source, size=16, first=None, imm=None):
+        self.dest = dest
+        self.source = source
+        self.size = size or 16
+        self.first = first
+        self.imm = imm
+
+    def __str__(self):
+        name = ("v" if self.size == 32 else "") + self.name
+        operands = [self.dest, self.first, self.source]
+        s = "\t" + name + " " + ", ".join(
+            spot.asm_str(self.size) for spot in operands if spot)
+        if self.imm is not None:
+            s += f", {self.imm}"
         return s
 
 
+class _ScalarCommand(_ASMCommand):
+    """Base class for a command on a scalar floating value, like `addsd`.
+
+    The value is a float of 4 bytes or a double of 8 bytes, by `size`, and
+    the command is named for it from `names`. The dest is an SSE register,
+    and the source is an SSE register or memory.
+    """
+
+    names = {}
+
+    def __str__(self):
+        return (f"\t{self.names[self.size]} {self.dest.asm_str(self.size)}, "
+                f"{self.source.asm_str(self.size)}")
+
+
+class _Convert:
+    """Base class for a conversion between a floating value and an integer
+    or another floating value, like `cvtsi2sd xmm0, eax`.
+
+    The command converts the value of `source_size` bytes at source to a
+    value of `dest_size` bytes at dest, and is named for the sizes by
+    `name`. Each operand is written at its own size.
+    """
+
+    def __init__(self, dest, source, dest_size, source_size):
+        self.dest = dest
+        self.source = source
+        self.dest_size = dest_size
+        self.source_size = source_size
+
+    def name(self):
+        """Return the name of the command, for the sizes converted."""
+        raise NotImplementedError
+
+    def __str__(self):
+        return (f"\t{self.name()} {self.dest.asm_str(self.dest_size)}, "
+                f"{self.source.asm_str(self.source_size)}")
+
+
 class _JumpCommand:
     """Base class for jump commands."""
 
@@ -75,6 +149,64 @@ class Comment:
         return "\t// " + self.msg
 
 
+class Loc(Comment):
+    """Class for a directive giving the source line of the code after it.
+
+    It is a Comment to the passes over the ASM code, so it stays just ahead
+    of the command after it when they rewrite or reorder commands. Files
+    are numbered as the ASM code is written; see ASMCode.write_lines.
+
+    file (str) - Name of the source file.
+    line (int) - Line number in the source file.
+    """
+
+    def __init__(self, file, line):  # noqa: D102
+        super().__init__(f"{file}:{line}")
+        self.file = file
+        self.line = line
+
+
+class Cfi:
+    """Class for a call frame information directive, like .cfi_offset.
+
+    name (str) - Name of the directive, without the .cfi_ prefix.
+    args (List[int]) - Arguments of the directive, with each register given
+    by its DWARF number.
+    """
+
+    def __init__(self, name, *args):  # noqa: D102
+        self.name = name
+        self.args = args
+
+    def __str__(self):  # noqa: D102
+        args = ", ".join(map(str, self.args))
+        return f"\t.cfi_{self.name} {args}".rstrip()
+
+
+class InlineAsm:
+    """Class for the instructions of an asm statement.
+
+    The passes over the ASM code do not look into the text, so the
+    scheduler treats it as a barrier, and the integrated assembler has `as`
+    encode it. The text is in AT&T syntax, so in the output it is put
+    between directives which switch to that syntax and back.
+
+    text (str) - The instructions, the template of the asm with its
+    operands put in.
+    regs (List[RegSpot]) - Registers the instructions may write.
+    r (Range) - Range of the asm statement in the source.
+    """
+
+    def __init__(self, text, regs, r):  # noqa: D102
+        self.text = text
+        self.regs = regs
+        self.r = r
+
+    def __str__(self):  # noqa: D102
+        return (f"\t.att_syntax prefix\n\t{self.text}\n"
+                "\t.intel_syntax noprefix")
+
+
 class Label:
     """Class for label."""
 
@@ -85,6 +217,95 @@ class Label:
         return self.label + ":"
 
 
+class Align:
+    """Class for a directive aligning the next data or code to `align` bytes.
+
+    align (int) - The alignment, a power of two.
+    max_skip (int) - If given, the most bytes of padding to add. If more
+    would be needed, the directive adds none.
+    """
+
+    def __init__(self, align, max_skip=None):  # noqa: D102
+        self.align = align
+        self.max_skip = max_skip
+
+    def padding(self, offset):
+        """Return the bytes of padding needed at the given offset."""
+        pad = -offset % self.align
+        return 0 if self.max_skip is not None and pad > self.max_skip else pad
+
+    def __str__(self):  # noqa: D102
+        power = self.align.bit_length() - 1
+        if self.max_skip is None:
+            return f"\t.p2align {power}"
+        return f"\t.p2align {power},,{self.max_skip}"
+
+
+class Zero:
+    """Class for a directive storing `size` zero bytes."""
+
+    def __init__(self, size):  # noqa: D102
+        self.size = size
+
+    def __str__(self):  # noqa: D102
+        return f"\t.zero {self.size}"
+
+
+class Value:
+    """Class for a directive storing an integer of `size` bytes.
+
+    The value is a Python integer, or the name of a label to store the
+    address of. The address stored is `addend` bytes past the label, less
+    the address of the label `base` if one is given.
+    """
+
+    size_strs = {1: "byte", 2: "word", 4: "int", 8: "quad"}
+
+    def __init__(self, value, size, addend=0, base=None):  # noqa: D102
+        self.value = value
+        self.size = size
+        self.addend = addend
+        self.base = base
+
+    def __str__(self):  # noqa: D102
+        value = self.value
+        if self.addend:
+            value = f"{value}{self.addend:+}"
+        if self.base:
+            value = f"{value}-{self.base}"
+        return f"\t.{self.size_strs[self.size]} {value}"
+
+
+class Ascii:
+    """Class for a directive storing a list of character codes.
+
+    If the only null character is the last one, this is emitted as .asciz.
+    """
+
+    escapes = {ord("\n"): "\\n", ord("\t"): "\\t", ord('"'): '\\"',
+               ord("\\"): "\\\\"}
+
+    def __init__(self, chars):  # noqa: D102
+        self.chars = chars
+
+    def __str__(self):  # noqa: D102
+        if self.chars and self.chars[-1] == 0 and 0 not in self.chars[:-1]:
+            return f'\t.asciz "{self._escape(self.chars[:-1])}"'
+        return f'\t.ascii "{self._escape(self.chars)}"'
+
+    def _escape(self, chars):
+        """Return the given characters as the text of a GAS string."""
+        text = ""
+        for char in chars:
+            if char in self.escapes:
+                text += self.escapes[char]
+            elif 32 <= char < 127:
+                text += chr(char)
+            else:
+                text += f"\\{char:03o}"
+        return text
+
+
 class Lea:
     """Class for lea command."""
 
@@ -99,6 +320,18 @@ class Lea:
                 "" + self.source.asm_str(0))
 
 
+class JmpAt:
+    """Class for a jump to the address stored at a memory spot."""
+
+    name = "jmp"
+
+    def __init__(self, source):  # noqa: D102
+        self.source = source
+
+    def __str__(self):  # noqa: D102
+        return "\t" + self.name + " " + self.source.asm_str(8)
+
+
 class Je(_JumpCommand): name = "je"  # noqa: D101
 
 
@@ -129,16 +362,289 @@ class Jb(_JumpCommand): name = "jb"  # noqa: D101
 class Jbe(_JumpCommand): name = "jbe"  # noqa: D101
 
 
+class Jp(_JumpCommand): name = "jp"  # noqa: D101
+
+
+class Jnp(_JumpCommand): name = "jnp"  # noqa: D101
+
+
+class Js(_JumpCommand): name = "js"  # noqa: D101
+
+
 class Jmp(_JumpCommand): name = "jmp"  # noqa: D101
 
 
+# Conditional jump taken exactly when each conditional jump is not taken.
+inverse_jump = {Je: Jne, Jne: Je, Jl: Jge, Jge: Jl, Jg: Jle, Jle: Jg,
+                Jb: Jae, Jae: Jb, Ja: Jbe, Jbe: Ja, Jp: Jnp, Jnp: Jp}
+
+
+class Setcc:
+    """Class for a command setting a byte to 1 if a condition holds, and to
+    0 otherwise, like `setl al`.
+
+    The condition is that of the conditional jump class `cond`, like Jl.
+    """
+
+    def __init__(self, cond, dest):  # noqa: D102
+        self.cond = cond
+        self.dest = dest
+
+    def __str__(self):  # noqa: D102
+        return f"\tset{self.cond.name[1:]} {self.dest.asm_str(1)}"
+
+
+class Cmov:
+    """Class for a move done only if a condition holds, like `cmovl eax, ecx`.
+
+    The condition is that of the conditional jump class `cond`, like Jl.
+    The source is a register or memory spot, and the size is 2, 4, or 8.
+    """
+
+    def __init__(self, cond, dest, source, size):  # noqa: D102
+        self.cond = cond
+        self.dest = dest
+        self.source = source
+        self.size = size
+
+    def __str__(self):  # noqa: D102
+        return (f"\tcmov{self.cond.name[1:]} {self.dest.asm_str(self.size)}, "
+                f"{self.source.asm_str(self.size)}")
+
+
 class Movsx(_ASMCommandMultiSize): name = "movsx"  # noqa: D101
 
 
 class Movzx(_ASMCommandMultiSize): name = "movzx"  # noqa: D101
 
 
-class Mov(_ASMCommand): name = "mov"  # noqa: D101
+class Mov(_ASMCommand):
+    """Class for a move, like `mov eax, ecx`.
+
+    A move of a 4 or 8-byte floating value to or from an SSE register is a
+    movss or movsd with memory, a movd or movq with a general register, or
+    a movaps between two SSE registers.
+    """
+
+    name = "mov"
+
+    def sse_name(self):
+        """Return the name of this move if it is to or from an SSE register,
+        or else None.
+        """
+        dest_sse = isinstance(self.dest, XMMSpot)
+        source_sse = isinstance(self.source, XMMSpot)
+        if not dest_sse and not source_sse:
+            return None
+        if dest_sse and source_sse:
+            return "movaps"
+        if isinstance(self.dest, RegSpot) or isinstance(self.source, RegSpot):
+            return "movq" if self.size == 8 else "movd"
+        return "movsd" if self.size == 8 else "movss"
+
+    def __str__(self):  # noqa: D102
+        name = self.sse_name()
+        if not name:
+            return super().__str__()
+        return (f"\t{name} {self.dest.asm_str(self.size)}, "
+                f"{self.source.asm_str(self.size)}")
+
+
+class AtomicMov(_ASMCommand):
+    """Class for a move to or from memory made by an atomic load or store,
+    or by an access of a volatile object.
+
+    It is a mov which the passes over the ASM code do not know, so the
+    scheduler treats it as a barrier, and the peephole optimizer neither
+    removes it nor forwards a value across it. It only moves between memory
+    and a general register or an immediate.
+    """
+
+    name = "mov"
+
+    def sse_name(self):  # noqa: D102
+        return None
+
+
+class Movdqu(_VectorCommand): name = "movdqu"  # noqa: D101
+
+
+class Movdqa(_VectorCommand): name = "movdqa"  # noqa: D101
+
+
+class Movntdq(_VectorCommand): name = "movntdq"  # noqa: D101
+
+
+class Movd(_ASMCommand):
+    """Class for a move of a 4 or 8-byte integer into an SSE register.
+
+    A move of 8 bytes is named movq.
+    """
+
+    def __str__(self):  # noqa: D102
+        name = "movq" if self.size == 8 else "movd"
+        return (f"\t{name} {self.dest.asm_str(16)}, "
+                f"{self.source.asm_str(self.size)}")
+
+
+class Vpbroadcast:
+    """Class for an AVX2 copy of the low lane of an SSE register to all.
+
+    The lanes of the 256-bit dest are `width` bytes each.
+    """
+
+    suffixes = {1: "b", 2: "w", 4: "d", 8: "q"}
+
+    def __init__(self, dest, source, width):  # noqa: D102
+        self.dest = dest
+        self.source = source
+        self.width = width
+
+    def __str__(self):  # noqa: D102
+        return (f"\tvpbroadcast{self.suffixes[self.width]} "
+                f"{self.dest.asm_str(32)}, {self.source.asm_str(16)}")
+
+
+class Vzeroupper(_ASMCommand): name = "vzeroupper"  # noqa: D101
+
+
+class Xchg(_ASMCommand): name = "xchg"  # noqa: D101
+
+
+# The atomic read-modify-write commands, with a lock prefix. An xchg with
+# memory is atomic without one.
+class LockXadd(_ASMCommand): name = "lock xadd"  # noqa: D101
+
+
+class LockCmpxchg(_ASMCommand): name = "lock cmpxchg"  # noqa: D101
+
+
+class Mfence(_ASMCommand): name = "mfence"  # noqa: D101
+
+
+class Sfence(_ASMCommand): name = "sfence"  # noqa: D101
+
+
+# The prefetches of the byte at dest into each level of the cache, and
+# into a buffer which keeps it out of the cache as much as it can.
+class Prefetcht0(_ASMCommand): name = "prefetcht0"  # noqa: D101
+
+
+class Prefetcht1(_ASMCommand): name = "prefetcht1"  # noqa: D101
+
+
+class Prefetcht2(_ASMCommand): name = "prefetcht2"  # noqa: D101
+
+
+class Prefetchnta(_ASMCommand): name = "prefetchnta"  # noqa: D101
+
+
+# A store of a general register which goes around the cache.
+class Movnti(_ASMCommand): name = "movnti"  # noqa: D101
+
+
+class RepMovsb(_ASMCommand): name = "rep movsb"  # noqa: D101
+
+
+class RepStosq(_ASMCommand): name = "rep stosq"  # noqa: D101
+
+
+class Pxor(_VectorCommand): name = "pxor"  # noqa: D101
+
+
+class Paddb(_VectorCommand): name = "paddb"  # noqa: D101
+
+
+class Paddw(_VectorCommand): name = "paddw"  # noqa: D101
+
+
+class Paddd(_VectorCommand): name = "paddd"  # noqa: D101
+
+
+class Paddq(_VectorCommand): name = "paddq"  # noqa: D101
+
+
+class Psubb(_VectorCommand): name = "psubb"  # noqa: D101
+
+
+class Psubw(_VectorCommand): name = "psubw"  # noqa: D101
+
+
+class Psubd(_VectorCommand): name = "psubd"  # noqa: D101
+
+
+class Psubq(_VectorCommand): name = "psubq"  # noqa: D101
+
+
+class Pmullw(_VectorCommand): name = "pmullw"  # noqa: D101
+
+
+class Pmulld(_VectorCommand): name = "pmulld"  # noqa: D101
+
+
+class Punpcklbw(_VectorCommand): name = "punpcklbw"  # noqa: D101
+
+
+class Punpcklwd(_VectorCommand): name = "punpcklwd"  # noqa: D101
+
+
+class Punpcklqdq(_VectorCommand): name = "punpcklqdq"  # noqa: D101
+
+
+class Pshufd(_VectorCommand): name = "pshufd"  # noqa: D101
+
+
+class Adds(_ScalarCommand): names = {4: "addss", 8: "addsd"}  # noqa: D101
+
+
+class Subs(_ScalarCommand): names = {4: "subss", 8: "subsd"}  # noqa: D101
+
+
+class Muls(_ScalarCommand): names = {4: "mulss", 8: "mulsd"}  # noqa: D101
+
+
+class Divs(_ScalarCommand): names = {4: "divss", 8: "divsd"}  # noqa: D101
+
+
+class Ucomis(_ScalarCommand):
+    """Class for an unordered comparison of two floating values.
+
+    This sets ZF, PF, and CF as an unsigned comparison sets ZF and CF, and
+    sets all three if either value is a NaN, so the values are unordered.
+    """
+
+    names = {4: "ucomiss", 8: "ucomisd"}
+
+
+class Xorp(_ScalarCommand):
+    """Class for a bitwise xor of all of two SSE registers, named for the
+    size of the floating values they hold.
+    """
+
+    names = {4: "xorps", 8: "xorpd"}
+
+
+class Cvtsi2s(_Convert):
+    """Class for a conversion of a signed integer to a floating value."""
+
+    def name(self):  # noqa: D102
+        return "cvtsi2sd" if self.dest_size == 8 else "cvtsi2ss"
+
+
+class Cvtts2si(_Convert):
+    """Class for a conversion of a floating value to a signed integer, by
+    truncation toward zero.
+    """
+
+    def name(self):  # noqa: D102
+        return "cvttsd2si" if self.source_size == 8 else "cvttss2si"
+
+
+class Cvts2s(_Convert):
+    """Class for a conversion between a float and a double."""
+
+    def name(self):  # noqa: D102
+        return "cvtss2sd" if self.dest_size == 8 else "cvtsd2ss"
 
 
 class Add(_ASMCommand): name = "add"  # noqa: D101
@@ -147,18 +653,45 @@ class Add(_ASMCommand): name = "add"  # noqa: D101
 class Sub(_ASMCommand): name = "sub"  # noqa: D101
 
 
+class Inc(_ASMCommand): name = "inc"  # noqa: D101
+
+
+class Dec(_ASMCommand): name = "dec"  # noqa: D101
+
+
 class Neg(_ASMCommand): name = "neg"  # noqa: D101
 
 
 class Not(_ASMCommand): name = "not"  # noqa: D101
 
 
+class Popcnt(_ASMCommand): name = "popcnt"  # noqa: D101
+
+
+class Tzcnt(_ASMCommand): name = "tzcnt"  # noqa: D101
+
+
+class Lzcnt(_ASMCommand): name = "lzcnt"  # noqa: D101
+
+
+class Bsf(_ASMCommand): name = "bsf"  # noqa: D101
+
+
+class Bsr(_ASMCommand): name = "bsr"  # noqa: D101
+
+
+class Bswap(_ASMCommand): name = "bswap"  # noqa: D101
+
+
 class Div(_ASMCommand): name = "div"  # noqa: D101
 
 
 class Imul(_ASMCommand): name = "imul"  # noqa: D101
 
 
+class Mul(_ASMCommand): name = "mul"  # noqa: D101
+
+
 class Idiv(_ASMCommand): name = "idiv"  # noqa: D101
 
 
@@ -171,9 +704,18 @@ class Cqo(_ASMCommand): name = "cqo"  # noqa: D101
 class Xor(_ASMCommand): name = "xor"  # noqa: D101
 
 
+class Or(_ASMCommand): name = "or"  # noqa: D101
+
+
+class And(_ASMCommand): name = "and"  # noqa: D101
+
+
 class Cmp(_ASMCommand): name = "cmp"  # noqa: D101
 
 
+class Test(_ASMCommand): name = "test"  # noqa: D101
+
+
 class Pop(_ASMCommand): name = "pop"  # noqa: D101
 
 
@@ -183,10 +725,45 @@ class Push(_ASMCommand): name = "push"  # noqa: D101
 class Call(_ASMCommand): name = "call"  # noqa: D101
 
 
+class DirectCall(Call):
+    """Class for a call of a function by its label.
+
+    If `plt` is set, the call goes through the entry of the function in the
+    procedure linkage table, since another module may define it.
+    """
+
+    def __init__(self, target, plt=False):  # noqa: D102
+        super().__init__()
+        self.target = target
+        self.plt = plt
+
+    def __str__(self):  # noqa: D102
+        return f"\tcall {self.target}{'@PLT' if self.plt else ''}"
+
+
 class Ret(_ASMCommand): name = "ret"  # noqa: D101
 
 
+# Jump to the address in a register for a tail call. Like a Ret, it is
+# preceded by the function epilogue.
+class TailJmp(_ASMCommand): name = "jmp"  # noqa: D101
+
+
 class Sar(_ASMCommandMultiSize): name = "sar"  # noqa: D101
 
 
 class Sal(_ASMCommandMultiSize): name = "sal"  # noqa: D101
+
+
+class Shr(_ASMCommandMultiSize): name = "shr"  # noqa: D101
+
+
+class Rol(_ASMCommandMultiSize): name = "rol"  # noqa: D101
+
+
+class Ror(_ASMCommandMultiSize): name = "ror"  # noqa: D101
+
+
+def first_label(lines):
+    """Return the name of the first label of the given ASM code lines."""
+    return next(line.label for line in lines if isinstance(line, Label))
@@ -1,28 +1,96 @@
 """Objects for the IL->ASM stage of the compiler."""
 
+import hashlib
+import heapq
+import io
 import itertools
+import os
 
+import shivyc.abi as abi
 import shivyc.asm_cmds as asm_cmds
+import shivyc.ctypes as ctypes
+import shivyc.dwarf as dwarf
+import shivyc.lto as lto
 import shivyc.spots as spots
-from shivyc.spots import Spot, RegSpot, MemSpot, LiteralSpot
+from shivyc.cfg import CFG
+from shivyc.errors import CompilerError, error_collector
+from shivyc.il_gen import FunctionLabel, number_values
+from shivyc.peephole import Peephole
+from shivyc.schedule import Scheduler, effects
+from shivyc.opt.pic import through_got
+from shivyc.spots import (Spot, RegSpot, XMMSpot, MemSpot, LiteralSpot,
+                          RipSpot, GOTSpot, TLSSpot, TLSGOTSpot)
+from shivyc.timing import timer
+
+
+# The x86-64 extensions whose instructions the code may use, each enabled by
+# the -m flag of the same name, like -mpopcnt.
+extensions = ["popcnt", "bmi", "lzcnt"]
+
+# Registers which ASM commands write without naming them.
+implicit_writes = {
+    asm_cmds.Div: [spots.RAX, spots.RDX],
+    asm_cmds.Idiv: [spots.RAX, spots.RDX],
+    asm_cmds.Mul: [spots.RAX, spots.RDX],
+    asm_cmds.Imul: [spots.RAX, spots.RDX],
+    asm_cmds.Cdq: [spots.RDX],
+    asm_cmds.Cqo: [spots.RDX],
+    asm_cmds.RepMovsb: [spots.RDI, spots.RSI, spots.RCX],
+    asm_cmds.RepStosq: [spots.RDI, spots.RCX],
+    asm_cmds.LockCmpxchg: [spots.RAX],
+}
 
 
 class ASMCode:
     """Stores the ASM code generated from the IL code.
 
-    lines (List) - Lines of ASM code recorded. The commands are stored as
-    tuples in this list, where the first value is the name of the command and
-    the next values are the command arguments.
+    lines (List) - Lines of ASM code recorded, as objects of asm_cmds. Each
+    keeps its operands as Spots and its sizes, so the peephole optimizer and
+    the encoder can inspect it, and is only formatted as text by write.
+
+    Static data is emitted to .data, or .rodata if it is const. String
+    literals are emitted once for each distinct string, to a section which
+    the linker merges identical strings in. With -flto, the serialized IL
+    code of the file is emitted to a section the program does not load.
+
+    With -fdata-sections, each object in .data or .rodata is emitted to a
+    section of its own, named after it, so that the linker can drop the
+    objects nothing refers to.
+
+    Each global name is typed as a function, or as an object of the size
+    of its data, so that the dynamic linker can copy an object of a shared
+    object into the program.
 
     """
 
-    def __init__(self):
-        """Initialize ASMCode."""
+    def __init__(self, func="", data_sections=False, features=()):
+        """Initialize ASMCode.
+
+        func (str) - Name of the function this is the code of, if it has
+        the code of a single function. Its labels are named after it.
+        data_sections (bool) - Whether to emit each object to its own section
+        features (Set[str]) - The x86-64 extensions, like "popcnt", whose
+        instructions the code may use
+        """
+        self.func = func
+        self.data_sections = data_sections
+        self.features = set(features)
+        self.label_num = 0
+        self.il_labels = {}
         self.lines = []
         self.comm = []
         self.globals = []
         self.data = []
         self.string_literals = []
+        self.string_names = {}
+        self.float_names = {}
+        self.rodata = []
+        self.tdata = []
+        self.tbss = []
+        self.il = []
+
+        # Size of the data of each object added with add_data.
+        self.sizes = {}
 
     def add(self, cmd):
         """Add a command to the code.
@@ -32,13 +100,42 @@ class ASMCode:
         """
         self.lines.append(cmd)
 
-    label_num = 0
+        # The address of an object is taken by a lea of its spot, or by
+        # loading its entry of the global offset table. For a thread-local
+        # object, either gives its offset from the thread pointer, which is
+        # added to make the address.
+        if (isinstance(cmd, asm_cmds.Lea) and isinstance(cmd.source, TLSSpot)
+              or isinstance(cmd, asm_cmds.Mov)
+              and isinstance(cmd.source, TLSGOTSpot)):
+            self.lines.append(
+                asm_cmds.Add(cmd.dest, spots.THREAD_POINTER, 8))
+
+    def get_label(self):
+        """Return a unique label string.
+
+        The labels of each function are named apart from those of the other
+        functions, so the code of functions can be generated separately.
+        """
+        self.label_num += 1
+        return f"__shivyc_label_{self.func}_{self.label_num}"
+
+    def label(self, il_label):
+        """Return the ASM label of the given IL label.
+
+        The IL labels of a function are numbered along with its other
+        labels in the order they are first used, so the ASM code of a
+        function does not depend on how many IL labels precede it.
+        """
+        if il_label not in self.il_labels:
+            self.il_labels[il_label] = self.get_label()
+        return self.il_labels[il_label]
 
     @staticmethod
-    def get_label():
-        """Return a unique label string."""
-        ASMCode.label_num += 1
-        return f"__shivyc_label{ASMCode.label_num}"
+    def label_symbol(func, name):
+        """Return the symbol of the label named `name` in function `func`,
+        for a label whose address is held by static data.
+        """
+        return f"{func}.label.{name}"
 
     def add_global(self, name):
         """Add a name to the code as global.
@@ -46,122 +143,340 @@ class ASMCode:
         name (str) - The name to add.
 
         """
-        self.globals.append(f"\t.global {name}")
+        self.globals.append(name)
 
-    def add_data(self, name, size, init):
+    def add_data(self, name, size, image, const=False, align=1,
+                 thread_local=False):
         """Add static data to the code.
 
-        init - the value to initialize `name` to
+        image - list of (offset, size, value) triples in order of offset,
+        for the values stored in the data, where each value is an integer
+        or a (label, addend) pair for the address `addend` bytes past a
+        label; the bytes not covered are zero
+        const - whether the data is never written, so it is read-only
+        align - the alignment of the data, in bytes
+        thread_local - whether each thread has its own copy of the data,
+        which is then in .tdata, or in .tbss if it is all zero
         """
-        self.data.append(f"{name}:")
-        size_strs = {1: "byte",
-                     2: "word",
-                     4: "int",
-                     8: "quad"}
+        data = self.rodata if const else self.data
+        if thread_local:
+            data = self.tdata if any(value for _, _, value in image) else (
+                self.tbss)
+        if align > 1:
+            data.append(asm_cmds.Align(align))
+        data.append(asm_cmds.Label(name))
+        self.sizes[name] = size
+
+        end = 0
+        for offset, value_size, value in image:
+            if offset > end:
+                data.append(asm_cmds.Zero(offset - end))
+            if isinstance(value, tuple):
+                data.append(asm_cmds.Value(value[0], value_size, value[1]))
+            else:
+                data.append(asm_cmds.Value(value, value_size))
+            end = offset + value_size
 
-        if init:
-            self.data.append(f"\t.{size_strs[size]} {init}")
-        else:
-            self.data.append(f"\t.zero {size}")
+        if size > end:
+            data.append(asm_cmds.Zero(size - end))
 
     def add_comm(self, name, size, local):
-        """Add a common symbol to the code."""
-        if local:
-            self.comm.append(f"\t.local {name}")
-        self.comm.append(f"\t.comm {name} {size}")
+        """Add a common symbol to the code.
+
+        local (bool) - whether the symbol has internal linkage
+        """
+        self.comm.append((name, size, local))
 
     def add_string_literal(self, name, chars):
-        """Add a string literal to the ASM code."""
-        self.string_literals.append(f"{name}:")
-        data = ",".join(str(char) for char in chars)
-        self.string_literals.append(f"\t.byte {data}")
+        """Add a string literal to the ASM code.
+
+        If an identical string literal was already added, it is not added
+        again.
+
+        chars (List(int)) - Null-terminated list of character codes.
+        returns - the name of the literal, which is that of the identical
+        literal if there is one
+        """
+        if tuple(chars) in self.string_names:
+            return self.string_names[tuple(chars)]
+        self.string_names[tuple(chars)] = name
+
+        # The linker splits a mergeable string section at each null
+        # character, so a string containing one is stored apart.
+        data = self.rodata if 0 in chars[:-1] else self.string_literals
+        data.append(asm_cmds.Label(name))
+        data.append(asm_cmds.Ascii(chars))
+        return name
+
+    def add_float_literal(self, name, val, size):
+        """Add a floating literal of `size` bytes to the ASM code.
+
+        An instruction cannot take a floating immediate operand, so each
+        floating literal is read from read-only data. If an identical
+        literal was already added, it is not added again.
+
+        returns - the name of the literal, which is that of the identical
+        literal if there is one
+        """
+        bits = ctypes.float_bits(val, size)
+        if (bits, size) in self.float_names:
+            return self.float_names[(bits, size)]
+        self.float_names[(bits, size)] = name
+
+        self.rodata.append(asm_cmds.Align(size))
+        self.rodata.append(asm_cmds.Label(name))
+        self.rodata.append(asm_cmds.Value(bits, size))
+        return name
+
+    def add_il(self, data):
+        """Add the serialized IL code of the file, as made by lto.py."""
+        for start in range(0, len(data), 4096):
+            self.il.append(asm_cmds.Ascii(data[start:start + 4096]))
+
+    def add_jump_table(self, name, labels, relative=False):
+        """Add a table of the addresses of the given labels to the code.
+
+        relative (bool) - whether each entry is instead the 32-bit offset of
+        its label from the table, which needs no relocation wherever the
+        code is loaded
+        """
+        if relative:
+            self.rodata.append(asm_cmds.Align(4))
+            self.rodata.append(asm_cmds.Label(name))
+            self.rodata.extend(asm_cmds.Value(label, 4, base=name)
+                               for label in labels)
+            return
+
+        self.rodata.append(asm_cmds.Align(8))
+        self.rodata.append(asm_cmds.Label(name))
+        self.rodata.extend(asm_cmds.Value(label, 8) for label in labels)
+
+    def sections(self):
+        """Return the name and list of contents of each data section."""
+        sections = [(".data", self.data), (".rodata", self.rodata),
+                     (".tdata", self.tdata), (".tbss", self.tbss)]
+        if self.data_sections:
+            sections = [split for name, lines in sections
+                        for split in _split_at_labels(name, lines)]
+        return sections + [(".rodata.str1.1", self.string_literals),
+                           (lto.SECTION, self.il)]
+
+    def write(self, out):
+        """Write the full assembly code to the given text file.
+
+        Each section is streamed to the file as it is formatted, rather than
+        first joined into one string.
+        """
+        self.write_start(out)
+        self.write_lines(out, self.lines)
+        self.write_end(out)
+
+    @staticmethod
+    def write_start(out):
+        """Write the start of the assembly code, up to the text section.
+
+        The ASM code of each function can then be written with write_lines
+        as soon as it is made, and the rest with write_end once all are.
+        """
+        out.write("\t.intel_syntax noprefix\n")
+        out.write("\t.section .text\n")
+
+    def write_end(self, out):
+        """Write the global names and static data after the text section."""
+        for name in self.globals:
+            out.write(f"\t.global {name}\n")
+            if name in self.sizes:
+                out.write(f"\t.type {name}, @object\n")
+                out.write(f"\t.size {name}, {self.sizes[name]}\n")
+            else:
+                out.write(f"\t.type {name}, @function\n")
+        for name, size, local in self.comm:
+            if local:
+                out.write(f"\t.local {name}\n")
+            out.write(f"\t.comm {name} {size}\n")
+
+        for section, lines in self.sections():
+            if lines:
+                if section == ".rodata.str1.1":
+                    section += ',"aMS",@progbits,1'
+                elif section == lto.SECTION:
+                    section += ',"",@progbits'
+                elif section.startswith(".data."):
+                    section += ',"aw",@progbits'
+                elif section.startswith(".rodata."):
+                    section += ',"a",@progbits'
+                elif section.startswith(".tdata"):
+                    section += ',"awT",@progbits'
+                elif section.startswith(".tbss"):
+                    section += ',"awT",@nobits'
+                out.write(f"\t.section {section}\n")
+                self.write_lines(out, lines)
+                out.write("\n")
+        out.write("\t.att_syntax noprefix\n")
+
+    @staticmethod
+    def write_lines(out, lines, files=None):
+        """Write each of the given lines to the given text file.
 
-    def full_code(self):  # noqa: D202
+        files (Dict[str, int]) - With -g, the number given so far to each
+        source file named by a Loc. Each Loc is written as a .loc directive,
+        after a .file directive numbering its file if it is new. Without
+        -g, None, and a Loc is written as a comment.
+        """
+        if files is None:
+            out.writelines(f"{line}\n" for line in lines)
+            return
+        for line in lines:
+            if isinstance(line, asm_cmds.Loc):
+                if line.file not in files:
+                    files[line.file] = len(files) + 1
+                    out.write(f'\t.file {files[line.file]} "{line.file}"\n')
+                out.write(f"\t.loc {files[line.file]} {line.line}\n")
+            else:
+                out.write(f"{line}\n")
+
+    def full_code(self):
         """Produce the full assembly code.
 
         return (str) - The assembly code, ready for saving to disk and
         assembling.
 
         """
-        header = ["\t.intel_syntax noprefix"]
-        header += self.comm
-        if self.string_literals or self.data:
-            header += ["\t.section .data"]
-            header += self.data
-            header += self.string_literals
-            header += [""]
+        out = io.StringIO()
+        self.write(out)
+        return out.getvalue()
+
 
-        header += ["\t.section .text"] + self.globals
-        header += [str(line) for line in self.lines]
+def _split_at_labels(name, lines):
+    """Split the contents of a data section at each label.
+
+    returns - a list of the name and contents of a section for each label,
+    named after the label, in which the alignment before the label goes
+    """
+    sections = [(name, [])]
+    align = []
+    for line in lines:
+        if isinstance(line, asm_cmds.Align):
+            align.append(line)
+            continue
+        if isinstance(line, asm_cmds.Label):
+            sections.append((f"{name}.{line.label}", []))
+        sections[-1][1].extend(align + [line])
+        align = []
+    return [(name, lines) for name, lines in sections if lines]
+
+
+def _touches(line, regs):
+    """Return whether ASM command `line` may read or write any of `regs`.
+
+    A jump to a label touches no register, and a command whose effects are
+    not known is taken to touch every one.
+    """
+    if isinstance(line, asm_cmds._JumpCommand):
+        return False
+    elif isinstance(line, asm_cmds.JmpAt):
+        spot = line.source
+        used = ([spot.base, spot.count] if isinstance(spot, MemSpot)
+                else [spot])
+        return any(reg in regs for reg in used)
 
-        return "\n".join(header + ["\t.att_syntax noprefix", ""])
+    e = effects(line)
+    return e is None or any(reg in regs for reg in e.reads | e.writes)
+
+
+def live_points(values, live_vars):
+    """Return the program points at which each of the given values is live.
+
+    Command i contributes three points: 3i on entry, 3i + 1 while the command
+    executes, and 3i + 2 on exit. A value live both entering and exiting a
+    command holds all three. Two values may share a spot iff their sets of
+    points are disjoint.
+
+    values - list of ILValues
+    live_vars - live range information from ASMGen._get_live_vars
+    returns - dictionary mapping each value to its points as an integer bitset
+    """
+    points = dict.fromkeys(values, 0)
+    for i, (live_in, live_out) in enumerate(live_vars):
+        live_out = set(live_out)
+        for v in live_in:
+            if v in points:
+                points[v] |= 1 << (3 * i)
+                if v in live_out:
+                    points[v] |= 1 << (3 * i + 1)
+        for v in live_out:
+            if v in points:
+                points[v] |= 1 << (3 * i + 2)
+    return points
 
 
 class NodeGraph:
     """Graph storing conflict and preference information.
 
-    self._real_nodes - list of all real nodes in this graph
-    self._all_nodes - list of all nodes in this graph, including precolored
-    self.conf - dictionary mapping each node to nodes with which it
-    has a conflict edge
-    self._pref - dictionary mapping each node to nodes with which it
-    has a preference edge
+    self._real_nodes - ordered set of all real nodes in this graph
+    self._all_nodes - ordered set of all nodes in this graph, including
+    precolored
+    self._dummy_nodes - ordered set of the precolored nodes in this graph
+    self._conf - dictionary mapping each node to the set of nodes with which
+    it has a conflict edge
+    self._pref - dictionary mapping each node to the set of nodes with which
+    it has a preference edge
+
+    Each ordered set is a dictionary whose values are all None, so that
+    membership tests are constant time but iteration order (and therefore
+    the generated code) does not depend on object hashes.
 
     The conflict and preference relations are symmetric. That is,
-    if `n1 in self.conf[n2]`, then `n2 in self._conf[n1]` and vice versa.
+    if `n1 in self._conf[n2]`, then `n2 in self._conf[n1]` and vice versa.
     """
 
     def __init__(self, nodes=None):
         """Initialize NodeGraph."""
-        self._real_nodes = nodes or []
-        self._all_nodes = self._real_nodes[:]
-        self._conf = {n: [] for n in self._all_nodes}
-        self._pref = {n: [] for n in self._all_nodes}
+        self._real_nodes = dict.fromkeys(nodes or [])
+        self._all_nodes = dict.fromkeys(self._real_nodes)
+        self._dummy_nodes = {}
+        self._conf = {n: {} for n in self._all_nodes}
+        self._pref = {n: {} for n in self._all_nodes}
 
     def is_node(self, n):
         """Check whether given node is in the graph."""
-        return n in self._conf and n in self._pref
+        return n in self._conf
+
+    def is_real(self, n):
+        """Check whether given node is a real node, not a pseudonode."""
+        return n in self._real_nodes
 
     def add_dummy_node(self, v):
         """Add a dummy node to graph."""
-        self._all_nodes.append(v)
-        self._conf[v] = []
-        self._pref[v] = []
+        self._all_nodes[v] = None
+        self._conf[v] = {}
+        self._pref[v] = {}
 
         # Dummy nodes must mutually conflict
-        for n in self._all_nodes:
-            if n not in self._real_nodes and n != v:
-                self.add_conflict(n, v)
+        for n in self._dummy_nodes:
+            self.add_conflict(n, v)
+        self._dummy_nodes[v] = None
 
     def add_conflict(self, n1, n2):
         """Add a conflict edge between n1 and n2."""
-        if n2 not in self._conf[n1]:
-            self._conf[n1].append(n2)
-        if n1 not in self._conf[n2]:
-            self._conf[n2].append(n1)
+        self._conf[n1][n2] = None
+        self._conf[n2][n1] = None
 
     def add_pref(self, n1, n2):
         """Add a preference edge between n1 and n2."""
-        if n2 not in self._pref[n1]:
-            self._pref[n1].append(n2)
-        if n1 not in self._pref[n2]:
-            self._pref[n2].append(n1)
+        self._pref[n1][n2] = None
+        self._pref[n2][n1] = None
 
     def pop(self, n):
         """Remove and return node n from this graph."""
-        del self._conf[n]
-        del self._pref[n]
-
-        if n in self._real_nodes:
-            self._real_nodes.remove(n)
-        self._all_nodes.remove(n)
-
-        for v in self._conf:
-            if n in self._conf[v]:
-                self._conf[v].remove(n)
-        for v in self._pref:
-            if n in self._pref[v]:
-                self._pref[v].remove(n)
+        for v in self._conf.pop(n):
+            del self._conf[v][n]
+        for v in self._pref.pop(n):
+            del self._pref[v][n]
+
+        self._real_nodes.pop(n, None)
+        self._dummy_nodes.pop(n, None)
+        del self._all_nodes[n]
         return n
 
     def merge(self, n1, n2):
@@ -171,83 +486,665 @@ class NodeGraph:
         graph and n1 gets the preference neighbors and conflict neighbors
         that n2 previously had.
         """
+        for c in self._conf.pop(n2):
+            del self._conf[c][n2]
+            self.add_conflict(n1, c)
 
-        # Merge conflict lists
-        total_conf = self._conf[n1][:]
-        for c in self._conf[n2]:
-            if c not in total_conf:
-                total_conf.append(c)
-
-        self._conf[n1] = total_conf
-
-        # Restore symmetric invariant
-        for c in self._conf[n1]:
-            if n2 in self._conf[c]:
-                self._conf[c].remove(n2)
-            if n1 not in self._conf[c]:
-                self._conf[c].append(n1)
+        for p in self._pref.pop(n2):
+            del self._pref[p][n2]
+            if p != n1:
+                self.add_pref(n1, p)
 
-        # Merge preference lists
-        total_pref = self._pref[n1][:]
-        for p in self._pref[n2]:
-            if p not in total_pref:
-                total_pref.append(p)
-
-        if n1 in total_pref: total_pref.remove(n1)
-        if n2 in total_pref: total_pref.remove(n2)
-        self._pref[n1] = total_pref
-
-        # Restore symmetric invariant
-        for c in self._pref[n1]:
-            if n2 in self._pref[c]:
-                self._pref[c].remove(n2)
-            if n1 not in self._pref[c]:
-                self._pref[c].append(n1)
-
-        del self._conf[n2]
-        del self._pref[n2]
-        self._real_nodes.remove(n2)
-        self._all_nodes.remove(n2)
+        del self._real_nodes[n2]
+        del self._all_nodes[n2]
 
     def remove_pref(self, n1, n2):
         """Remove the preference edge between n1 and n2."""
-        self._pref[n1].remove(n2)
-        self._pref[n2].remove(n1)
+        del self._pref[n1][n2]
+        del self._pref[n2][n1]
 
     def prefs(self, n):
-        """Return the list of nodes to which n has a preference edge."""
+        """Return the set of nodes to which n has a preference edge."""
         return self._pref[n]
 
     def confs(self, n):
-        """Return the list of nodes with which n has a conflict edge."""
+        """Return the set of nodes with which n has a conflict edge."""
         return self._conf[n]
 
+    def degree(self, n):
+        """Return the number of conflict edges of n."""
+        return len(self._conf[n])
+
     def nodes(self):
-        """Return the real nodes currently in this graph."""
-        return self._real_nodes
+        """Return a list of the real nodes currently in this graph."""
+        return list(self._real_nodes)
+
+    def num_conflicts(self):
+        """Return the number of conflict edges in this graph."""
+        return sum(len(confs) for confs in self._conf.values()) // 2
 
     def all_nodes(self):
-        """Return all nodes in this graph, including pseudonodes."""
-        return self._all_nodes
+        """Return a list of all nodes in this graph, including pseudonodes."""
+        return list(self._all_nodes)
 
     def copy(self):
         """Return a deep copy of this graph, but with same ILValue objects."""
         g = NodeGraph()
 
-        g._real_nodes = self._real_nodes[:]
-        g._all_nodes = self._all_nodes[:]
-        for n in self._all_nodes:
-            g._conf[n] = self._conf[n][:]
-            g._pref[n] = self._pref[n][:]
+        g._real_nodes = self._real_nodes.copy()
+        g._all_nodes = self._all_nodes.copy()
+        g._dummy_nodes = self._dummy_nodes.copy()
+        g._conf = {n: self._conf[n].copy() for n in self._all_nodes}
+        g._pref = {n: self._pref[n].copy() for n in self._all_nodes}
 
         return g
 
+    def to_dot(self, name, labels, spotmap):  # pragma: no cover
+        """Return this graph in the DOT language of Graphviz.
+
+        Conflicts are drawn as solid edges and preferences as dashed edges.
+        Each real node is labeled with its label and the register it was
+        given, or drawn in red if it was spilled, and precolored nodes are
+        drawn as boxes.
+
+        name (str) - name of the graph
+        labels (Dict[ILValue, str]) - label of each real node
+        spotmap (Dict[ILValue, Spot]) - spot each real node was given
+        """
+        ids = {n: i for i, n in enumerate(self._all_nodes)}
+        lines = [f'graph "{name}" {{']
+        for n, i in ids.items():
+            if not self.is_real(n):
+                attrs = f'label="{n.name}", shape=box'
+            elif isinstance(spotmap.get(n), RegSpot):
+                attrs = f'label="{labels[n]}\\n{spotmap[n].name}"'
+            else:
+                attrs = f'label="{labels[n]}", color=red, fontcolor=red'
+            lines.append(f"  n{i} [{attrs}];")
+
+        dashed = " [style=dashed]"
+        for edges, style in [(self._conf, ""), (self._pref, dashed)]:
+            for n1, i1 in ids.items():
+                for n2 in edges[n1]:
+                    if i1 < ids[n2]:
+                        lines.append(f"  n{i1} -- n{ids[n2]}{style};")
+        lines.append("}")
+        return "\n".join(lines) + "\n"
+
     def __str__(self):  # pragma: no cover
         """Return this graph as a string for debugging purposes."""
         return ("Conf\n" +
-                "\n".join(str((v, self._conf[v])) for v in self._all_nodes)
+                "\n".join(str((v, list(self._conf[v])))
+                          for v in self._all_nodes)
                 + "\nPref\n" +
-                "\n".join(str((v, self._pref[v])) for v in self._all_nodes))
+                "\n".join(str((v, list(self._pref[v])))
+                          for v in self._all_nodes))
+
+
+class IteratedCoalescer:
+    """Iterated register coalescing over a NodeGraph.
+
+    This is the worklist formulation of George & Appel's algorithm. Each
+    real node of the graph sits on exactly one of the simplify, freeze, or
+    spill worklists, or on the select stack, or in the set of coalesced
+    nodes. Preference edges play the role of moves. Degrees are maintained
+    incrementally as nodes are simplified and coalesced, so no step ever
+    needs to rescan or rebuild the graph.
+
+    When no node can be simplified, coalesced, or frozen, a spill
+    candidate is chosen and pushed on the select stack optimistically. It
+    is only actually spilled if no register is free for it once its
+    neighbors have been colored.
+
+    g (NodeGraph) - Conflict and preference graph. It is not modified.
+    registers (List[RegSpot]) - Registers available, sorted preferred-first.
+    spill_costs (Dict[ILValue, float]) - Estimated cost of keeping each real
+    node in memory instead of a register. The spill candidate chosen is
+    the node on the spill worklist with the lowest cost per conflict,
+    where the cost of a coalesced node is the sum of the costs of the
+    nodes merged into it.
+    """
+
+    def __init__(self, g, registers, spill_costs):
+        """Initialize IteratedCoalescer."""
+        self.registers = registers
+        self.K = len(registers)
+        self.spill_costs = dict(spill_costs)
+
+        self.precolored = set(n for n in g.all_nodes() if not g.is_real(n))
+        self.adj = {n: dict.fromkeys(g.confs(n)) for n in g.all_nodes()}
+        self.neighbors = {n: list(self.adj[n]) for n in g.all_nodes()}
+        self.degree = {n: len(self.adj[n]) for n in g.nodes()}
+
+        # Moves are preference edges, stored once as ordered pairs.
+        self.move_list = {n: [] for n in g.all_nodes()}
+        self.worklist_moves = {}
+        for n1 in g.all_nodes():
+            for n2 in g.prefs(n1):
+                if (n2, n1) not in self.worklist_moves:
+                    move = (n1, n2)
+                    self.worklist_moves[move] = None
+                    self.move_list[n1].append(move)
+                    self.move_list[n2].append(move)
+        self.active_moves = {}
+
+        self.simplify_worklist = {}
+        self.freeze_worklist = {}
+        # Heap of the degree, order of insertion, and node of each node put
+        # on the freeze worklist, pushed again whenever its degree changes.
+        # An entry is stale if it no longer matches its node.
+        self.freeze_heap = []
+        self.freeze_order = {}
+        self.freeze_count = itertools.count()
+        self.spill_worklist = {}
+        self.select_stack = []
+        self.on_stack = set()
+        self.coalesced = set()
+        self.alias = {}
+
+        # Count of moves coalesced, for diagnostics.
+        self.coalesced_moves = 0
+        # Count of spill candidates selected, for diagnostics.
+        self.spill_rounds = 0
+
+        for n in g.nodes():
+            if self.degree[n] >= self.K:
+                self.spill_worklist[n] = None
+            elif self._move_related(n):
+                self._add_freeze(n)
+            else:
+                self.simplify_worklist[n] = None
+
+    def allocate(self):
+        """Run the allocator.
+
+        returns - tuple of a dictionary mapping each node that received a
+        register (including precolored nodes) to that register, and a list
+        of lists of spilled nodes. The nodes in each of these lists were
+        coalesced together, so they may share one memory spot.
+        """
+        while True:
+            if self.simplify_worklist:
+                self._simplify()
+            elif self.worklist_moves:
+                self._coalesce()
+            elif self.freeze_worklist:
+                self._freeze()
+            elif self.spill_worklist:
+                self._select_spill()
+            else:
+                break
+
+        return self._assign_colors()
+
+    def _adjacent(self, n):
+        """Return the current conflict neighbors of n.
+
+        A node stays on the select stack or coalesced until colors are
+        assigned, so it is dropped from the neighbors of n once found, as
+        moves are by _node_moves.
+        """
+        adjacent = [m for m in self.neighbors[n]
+                    if m not in self.on_stack and m not in self.coalesced]
+        self.neighbors[n] = adjacent
+        return list(adjacent)
+
+    def _node_moves(self, n):
+        """Return the moves of n which may still be coalesced.
+
+        A move which has been coalesced, constrained, or frozen never may
+        be again, so it is dropped from the move list of n once found. The
+        list of a node which many others are coalesced into would otherwise
+        grow with each of them, and be scanned again on every change.
+        """
+        moves = [m for m in self.move_list[n]
+                 if m in self.active_moves or m in self.worklist_moves]
+        self.move_list[n] = moves
+        return moves
+
+    def _move_related(self, n):
+        """Return whether n has a move which may still be coalesced."""
+        return bool(self._node_moves(n))
+
+    def _get_alias(self, n):
+        """Return the node into which n has been coalesced."""
+        while n in self.coalesced:
+            n = self.alias[n]
+        return n
+
+    def _simplify(self):
+        """Push a low-degree node that is not move-related onto the stack."""
+        n = next(iter(self.simplify_worklist))
+        del self.simplify_worklist[n]
+        self.select_stack.append(n)
+        self.on_stack.add(n)
+        for m in self._adjacent(n):
+            self._decrement_degree(m)
+
+    def _decrement_degree(self, m):
+        """Decrement the degree of m, updating worklists as it drops."""
+        if m in self.precolored:
+            return
+
+        d = self.degree[m]
+        self.degree[m] = d - 1
+        self._push_freeze(m)
+        if d == self.K:
+            self._enable_moves([m] + self._adjacent(m))
+            self.spill_worklist.pop(m, None)
+            if self._move_related(m):
+                self._add_freeze(m)
+            else:
+                self.simplify_worklist[m] = None
+
+    def _enable_moves(self, nodes):
+        """Make the moves of the given nodes candidates for coalescing."""
+        for n in nodes:
+            for m in self._node_moves(n):
+                if m in self.active_moves:
+                    del self.active_moves[m]
+                    self.worklist_moves[m] = None
+
+    def _add_worklist(self, u):
+        """Move u to the simplify worklist if it can now be simplified."""
+        if (u not in self.precolored and not self._move_related(u)
+              and self.degree[u] < self.K):
+            self.freeze_worklist.pop(u, None)
+            self.simplify_worklist[u] = None
+
+    def _ok(self, t, r):
+        """George's test for coalescing a node into precolored node r."""
+        return (t in self.precolored or self.degree[t] < self.K
+                or r in self.adj[t])
+
+    def _conservative(self, nodes):
+        """Briggs' test: coalescing is safe if few neighbors are high-degree.
+        """
+        k = 0
+        for n in nodes:
+            if n in self.precolored or self.degree[n] >= self.K:
+                k += 1
+        return k < self.K
+
+    def _coalesce(self):
+        """Attempt to coalesce one move from the move worklist."""
+        move = next(iter(self.worklist_moves))
+        del self.worklist_moves[move]
+
+        x = self._get_alias(move[0])
+        y = self._get_alias(move[1])
+        if y in self.precolored:
+            u, v = y, x
+        else:
+            u, v = x, y
+
+        if u == v:
+            self.coalesced_moves += 1
+            self._add_worklist(u)
+        elif v in self.precolored or v in self.adj[u]:
+            self._add_worklist(u)
+            self._add_worklist(v)
+        elif ((u in self.precolored
+               and all(self._ok(t, u) for t in self._adjacent(v)))
+              or (u not in self.precolored
+                  and self._conservative(
+                      dict.fromkeys(self._adjacent(u) + self._adjacent(v))))):
+            self.coalesced_moves += 1
+            self._combine(u, v)
+            self._add_worklist(u)
+        else:
+            self.active_moves[move] = None
+
+    def _combine(self, u, v):
+        """Coalesce node v into node u."""
+        if v in self.freeze_worklist:
+            del self.freeze_worklist[v]
+        else:
+            del self.spill_worklist[v]
+
+        self.coalesced.add(v)
+        self.alias[v] = u
+        if u not in self.precolored:
+            self.spill_costs[u] += self.spill_costs[v]
+        self.move_list[u].extend(self._node_moves(v))
+        self._enable_moves([v])
+
+        for t in self._adjacent(v):
+            self._add_edge(t, u)
+            self._decrement_degree(t)
+
+        if (u not in self.precolored and self.degree[u] >= self.K
+              and u in self.freeze_worklist):
+            del self.freeze_worklist[u]
+            self.spill_worklist[u] = None
+
+    def _add_edge(self, u, v):
+        """Add a conflict edge between u and v, if not already present."""
+        if u != v and v not in self.adj[u]:
+            self.adj[u][v] = None
+            self.adj[v][u] = None
+            self.neighbors[u].append(v)
+            self.neighbors[v].append(u)
+            if u not in self.precolored:
+                self.degree[u] += 1
+                self._push_freeze(u)
+            if v not in self.precolored:
+                self.degree[v] += 1
+                self._push_freeze(v)
+
+    def _add_freeze(self, n):
+        """Put n on the freeze worklist."""
+        self.freeze_worklist[n] = None
+        self.freeze_order[n] = next(self.freeze_count)
+        self._push_freeze(n)
+
+    def _push_freeze(self, n):
+        """Push n on the freeze heap with its degree, if it is on the freeze
+        worklist.
+        """
+        if n in self.freeze_worklist:
+            heapq.heappush(self.freeze_heap,
+                           (self.degree[n], self.freeze_order[n], n))
+
+    def _freeze(self):
+        """Give up coalescing the moves of a low-degree node.
+
+        The node frozen is the one of least degree, the first put on the
+        worklist among those, found on the heap so that each freeze does
+        not scan the whole worklist.
+        """
+        while True:
+            degree, order, u = heapq.heappop(self.freeze_heap)
+            if (u in self.freeze_worklist and self.degree[u] == degree
+                  and self.freeze_order[u] == order):
+                break
+        del self.freeze_worklist[u]
+        self.simplify_worklist[u] = None
+        self._freeze_moves(u)
+
+    def _freeze_moves(self, u):
+        """Discard all coalescing candidates involving u."""
+        for move in self._node_moves(u):
+            x, y = move
+            if self._get_alias(y) == self._get_alias(u):
+                v = self._get_alias(x)
+            else:
+                v = self._get_alias(y)
+
+            self.active_moves.pop(move, None)
+            self.worklist_moves.pop(move, None)
+
+            if (v in self.freeze_worklist and not self._move_related(v)
+                  and self.degree[v] < self.K):
+                del self.freeze_worklist[v]
+                self.simplify_worklist[v] = None
+
+    def _select_spill(self):
+        """Optimistically push a high-degree node onto the select stack."""
+        m = min(self.spill_worklist,
+                key=lambda n: self.spill_costs[n] / self.degree[n])
+        del self.spill_worklist[m]
+        self.spill_rounds += 1
+        self.simplify_worklist[m] = None
+        self._freeze_moves(m)
+
+    def _assign_colors(self):
+        """Pop nodes off the select stack and give each a register."""
+        colors = {n: n for n in self.precolored}
+        spilled = []
+
+        while self.select_stack:
+            n = self.select_stack.pop()
+            self.on_stack.discard(n)
+
+            used = set()
+            for w in self.adj[n]:
+                a = self._get_alias(w)
+                if a in colors:
+                    used.add(colors[a])
+
+            ok_colors = [r for r in self.registers if r not in used]
+            if not ok_colors:
+                spilled.append(n)
+                continue
+
+            # Prefer the register of a node this one has a move with.
+            color = ok_colors[0]
+            for x, y in self.move_list[n]:
+                other = self._get_alias(y if self._get_alias(x) == n else x)
+                if other in colors and colors[other] in ok_colors:
+                    color = colors[other]
+                    break
+            colors[n] = color
+
+        spill_groups = {n: [n] for n in spilled}
+        for n in self.coalesced:
+            a = self._get_alias(n)
+            if a in colors:
+                colors[n] = colors[a]
+            else:
+                spill_groups[a].append(n)
+
+        return colors, list(spill_groups.values())
+
+
+class LinearScan:
+    """Linear scan register allocator.
+
+    Each value is modeled as the set of program points where it is live,
+    as computed by live_points. These sets are integer bitsets, so the
+    holes in a live range are kept and two values may share a register
+    whenever their live points are disjoint (binpacking).
+
+    Values are visited in order of their first live point. Each is given
+    the first register free over its whole range, trying the registers it
+    prefers first. If none is free, either it is spilled or, if a value
+    already holding a register has a lower spill cost and its removal
+    would free that register, that value is evicted and spilled instead.
+    There is no live range splitting, so a spilled value stays in memory
+    for its whole lifetime.
+
+    commands - list of IL commands of the function
+    free_values - list of values to allocate
+    live_vars - live range information from ASMGen._get_live_vars
+    registers (List[RegSpot]) - registers available, sorted preferred-first
+    spill_costs (Dict[ILValue, float]) - estimated cost of spilling each value
+    """
+
+    def __init__(self, commands, free_values, live_vars, registers,
+                 spill_costs):
+        """Initialize LinearScan."""
+        self.registers = registers
+        self.spill_costs = spill_costs
+
+        self.points = live_points(free_values, live_vars)
+
+        # Points at which each register is taken, by an allocated value or
+        # by a command which clobbers it.
+        self.taken = {r: 0 for r in registers}
+        self.owners = {r: [] for r in registers}
+
+        self.abs_conf = {v: set() for v in free_values}
+        self.rel_conf = {v: set() for v in free_values}
+        self.abs_pref = {v: [] for v in free_values}
+        self.rel_pref = {v: [] for v in free_values}
+
+        for i, command in enumerate(commands):
+            for r in command.clobber():
+                if r in self.taken:
+                    self.taken[r] |= 1 << (3 * i + 1)
+
+            for v, confs in command.abs_spot_conf().items():
+                if v in self.abs_conf:
+                    self.abs_conf[v].update(confs)
+            for v1, confs in command.rel_spot_conf().items():
+                for v2 in confs:
+                    if v1 in self.rel_conf and v2 in self.rel_conf:
+                        self.rel_conf[v1].add(v2)
+                        self.rel_conf[v2].add(v1)
+            for v, prefs in command.abs_spot_pref().items():
+                if v in self.abs_pref:
+                    self.abs_pref[v] += prefs
+            for v1, prefs in command.rel_spot_pref().items():
+                for v2 in prefs:
+                    if v1 in self.rel_pref and v2 in self.rel_pref:
+                        self.rel_pref[v1].append(v2)
+                        self.rel_pref[v2].append(v1)
+
+    def allocate(self):
+        """Run the allocator.
+
+        returns - tuple of a dictionary mapping each value that received a
+        register to that register, and a list of lists of spilled values
+        in the same format as IteratedCoalescer.allocate.
+        """
+        def first_point(v):
+            bits = self.points[v]
+            return (bits & -bits).bit_length()
+
+        spotmap = {}
+        spilled = []
+        for v in sorted(self.points, key=first_point):
+            reg = self._find_reg(v, spotmap)
+            if reg:
+                self._assign(v, reg, spotmap)
+                continue
+
+            victim = self._find_victim(v, spotmap)
+            if victim:
+                reg = spotmap.pop(victim)
+                self.owners[reg].remove(victim)
+                self.taken[reg] &= ~self.points[victim]
+                spilled.append([victim])
+                self._assign(v, reg, spotmap)
+            else:
+                spilled.append([v])
+
+        return spotmap, spilled
+
+    def _assign(self, v, reg, spotmap):
+        """Give register reg to value v."""
+        spotmap[v] = reg
+        self.owners[reg].append(v)
+        self.taken[reg] |= self.points[v]
+
+    def _allowed(self, v, reg, spotmap):
+        """Return whether reg satisfies the spot conflicts of v."""
+        if reg in self.abs_conf[v]:
+            return False
+        return all(spotmap.get(v2) != reg for v2 in self.rel_conf[v])
+
+    def _find_reg(self, v, spotmap):
+        """Return a register free over all live points of v, or None."""
+        candidates = (self.abs_pref[v]
+                      + [spotmap[v2] for v2 in self.rel_pref[v]
+                         if v2 in spotmap]
+                      + self.registers)
+        for reg in candidates:
+            if (reg in self.taken and not self.taken[reg] & self.points[v]
+                  and self._allowed(v, reg, spotmap)):
+                return reg
+        return None
+
+    def _find_victim(self, v, spotmap):
+        """Find the cheapest allocated value whose eviction frees a register.
+
+        Returns None if every candidate costs at least as much as v.
+        """
+        best = None
+        best_cost = self.spill_costs[v]
+        for reg in self.registers:
+            if not self._allowed(v, reg, spotmap):
+                continue
+
+            # The register must be free of clobbers and of every owner other
+            # than the victim. Owners never overlap each other or a clobber,
+            # so removing the victim's points leaves exactly those.
+            for victim in self.owners[reg]:
+                blocked = self.taken[reg] & ~self.points[victim]
+                if (blocked & self.points[v]
+                      or self.spill_costs[victim] >= best_cost):
+                    continue
+                best = victim
+                best_cost = self.spill_costs[victim]
+        return best
+
+
+class RegisterContext:
+    """Hands out scratch registers to the commands of a function.
+
+    One context serves every command of a function. ASMGen calls start
+    before generating the code of each command, which computes once the
+    spots the command may not clobber, and then passes the context to
+    make_asm of the command as its get_reg function.
+
+    registers (List[RegSpot]) - registers which may be handed out
+    spotmap - map from each value of the function to its spot
+    live_vars - live range information from ASMGen._get_live_vars
+    borrowed (List[RegSpot]) - registers holding live values handed out
+    for the current command, which must be saved around its code
+    """
+
+    def __init__(self, registers, spotmap, live_vars):
+        """Initialize RegisterContext."""
+        self.registers = registers
+        self.spotmap = spotmap
+        self.live_vars = live_vars
+        self.borrowed = []
+        self._register_set = set(registers)
+        self._bad_spots = set()
+        self._used_spots = set()
+
+    def start(self, i, command):
+        """Start handing out registers to command `command` at index `i`."""
+        self.borrowed = []
+
+        # A spot is bad if it holds a variable that is live both entering
+        # and exiting the command, unless an output is stored there.
+        # A rematerialized value has no spot of its own.
+        live_in, live_out = self.live_vars[i]
+        bad_vars = set(live_in).intersection(live_out)
+        self._bad_spots = {self.spotmap.get(v) for v in bad_vars}
+        for v in command.outputs():
+            self._bad_spots.discard(self.spotmap.get(v))
+
+        # Spots the command itself reads or writes, which are never
+        # borrowed.
+        self._used_spots = {self.spotmap.get(v) for v in
+                            command.inputs() + command.outputs() if v}
+
+    def reserve(self, reg):
+        """Keep the given register from being handed out for the rest of
+        the current command, because it holds a value the command reads.
+        """
+        self._bad_spots.add(reg)
+        self._used_spots.add(reg)
+
+    def __call__(self, pref=None, conf=None):
+        """Return a register the current command may clobber.
+
+        pref - list of spots to return if one may be clobbered
+        conf - list of spots not to return
+        """
+        if not pref: pref = []
+        if not conf: conf = []
+
+        # Take a preferred register if one is free, or else any free
+        # register which is not a conflicting spot.
+        for s in (pref + self.registers):
+            if (s in self._register_set and s not in self._bad_spots
+                  and s not in conf):
+                return s
+
+        # Every register is in use, so borrow one which holds a value the
+        # command does not touch.
+        for s in self.registers:
+            if (s not in self._used_spots and s not in conf
+                  and s not in self.borrowed):
+                self.borrowed.append(s)
+                return s
+
+        raise NotImplementedError("spill required for get_reg")
 
 
 class ASMGen:
@@ -256,15 +1153,31 @@ class ASMGen:
     il_code (ILCode) - IL code to convert to ASM.
     asm_code (ASMCode) - ASMCode object to populate with ASM.
     arguments - Arguments passed via command line.
-    offset (int) - Current offset from RBP for allocating on stack
 
+    The ASM code of each function is made on its own, so functions can be
+    generated as soon as their IL code is ready. The static data of the
+    file is added to the ASM code by finish, after the last function.
+
+    A function is made in three steps, so that the code of functions may be
+    generated in other processes. function_job assigns the spots of the
+    values a function shares with other functions, generate makes the code
+    of the function without changing any state of the ASMGen, and
+    add_function adds the results back in.
     """
 
-    # List of registers used for allocation, sorted preferred-first
-    alloc_registers = spots.registers
+    # Map from each register class to the registers its values are
+    # allocated to, sorted preferred-first
+    alloc_registers = spots.class_registers
 
     # List of registers used by the get_reg function.
-    all_registers = alloc_registers
+    all_registers = alloc_registers[spots.GENERAL]
+
+    # Alignment of the entry point of each function, and of each loop header
+    # with -falign-loops. A loop header is only padded if that takes at most
+    # loop_max_skip bytes of no-ops, which run each time the loop is entered.
+    function_align = 16
+    loop_align = 16
+    loop_max_skip = 10
 
     def __init__(self, il_code, symbol_table, asm_code, arguments):
         """Initialize ASMGen."""
@@ -273,331 +1186,883 @@ class ASMGen:
         self.asm_code = asm_code
         self.arguments = arguments
 
-        self.offset = 0
-
-    def make_asm(self):
-        """Generate ASM code."""
-        global_spotmap = self._get_global_spotmap()
-        for func in self.il_code.commands:
-            self.asm_code.add(asm_cmds.Label(func))
-            self._make_asm(self.il_code.commands[func], global_spotmap)
+        # Spots of the values which are not specific to a single function,
+        # assigned as functions first reference them.
+        self.global_spotmap = {}
 
-    def _make_asm(self, commands, global_spotmap):
-        """Generate ASM code for given command list."""
+        self.peephole = Peephole() if arguments.peephole else None
+        self.scheduler = Scheduler(arguments.tune) if arguments.tune else None
 
-        # Get free values
-        free_values = self._get_free_values(commands, global_spotmap)
+    def function_job(self, func):
+        """Return the arguments to generate the code of function `func`.
 
-        # If any variable may have its address referenced, assign it a
-        # permanent memory spot if it doesn't yet have one.
-        move_to_mem = []
+        returns - the name of the function, its IL commands, a map from
+        each value it uses which is not specific to it to the spot of the
+        value, and a map from each label of the function with a count in
+        the profile to the count
+        """
+        commands = self.il_code.commands[func]
+        global_spotmap = {}
+        counts = {}
         for command in commands:
-            refs = command.references().values()
-            for line in refs:
-                for v in line:
-                    if v not in refs:
-                        move_to_mem.append(v)
+            for value in command.inputs() + command.outputs():
+                if value and value not in global_spotmap:
+                    spot = self._global_spot(value)
+                    if spot:
+                        global_spotmap[value] = spot
+            if command.label_name() in self.il_code.counts:
+                counts[command.label_name()] = self.il_code.counts[
+                    command.label_name()]
+        return func, commands, global_spotmap, counts
+
+    def use_globals(self, uses):
+        """Make the spots of the values not specific to a function which the
+        ASM code of a function uses, as generating it would.
+
+        This is done for a function whose ASM code is taken from the cache,
+        so the static data it refers to is still added.
+
+        uses - list of the values, in the order the function first uses
+        them, along with a (value, size) pair for each floating literal made
+        as the function was optimized
+        """
+        for use in uses:
+            if isinstance(use, tuple):
+                self._add_float_literal(*use)
+            else:
+                self._global_spot(use)
 
-        # In addition, move all IL values of strange size to memory because
-        # they won't fit in a register.
-        for v in free_values:
-            if v.ctype.size not in {1, 2, 4, 8}:
-                move_to_mem.append(v)
-
-        # TODO: All non-free IL values are automatically assigned distinct
-        # memory spots. However, this is very inoptimal for structs.
-        # Consider the following C code, where S is already declared:
-        #
-        #   struct S array[10];
-        #   s = array[1];
-        #
-        # This code compiles to the following IL:
-        #
-        #   READAT(array, 1) -> X
-        #   SET(X) -> s
-        #
-        # However, X is an unnecessary copy of `s` in memory. Ideally,
-        # the register allocator will recognize that X is just a temporary
-        # and assign X to the same memory location as s to avoid additional
-        # copy operations and memory usage. This also requires that the
-        # relevant IL commands check whether the two arguments are in the
-        # same spot before trying to do a copy.
-        for v in move_to_mem:
-            if v in free_values:
-                self.offset += v.ctype.size
-                global_spotmap[v] = MemSpot(spots.RBP, -self.offset)
-                free_values.remove(v)
+    def generate(self, func, commands, global_spotmap, counts):
+        """Generate the ASM code of a function, as by function_job.
 
-        # Perform liveliness analysis
-        live_vars = self._get_live_vars(commands, free_values)
+        This only reads the arguments of the ASMGen, so it may be called on
+        an ASMGen with no IL code, symbol table, or ASM code.
 
-        # Generate conflict and preference graph
-        g_bak = self._generate_graph(commands, free_values, live_vars)
+        returns - the lines of the ASM code of the function, the lines of
+        the read-only data it adds, and the caller-saved registers it may
+        change
+        """
+        asm_code = ASMCode(func, features={
+            name for name in extensions if getattr(self.arguments, name)})
+        asm_code.add(asm_cmds.Label(func))
+        with timer.phase("regalloc"):
+            self._make_asm(func, commands, global_spotmap, counts, asm_code)
+
+        lines = asm_code.lines
+        if self.peephole:
+            with timer.phase("emit"):
+                lines = self.peephole.optimize(lines)
+        if self.scheduler:
+            with timer.phase("emit"):
+                lines = self.scheduler.schedule(lines)
+        lines = self._align(lines)
+        if timer.enabled:
+            timer.count("instructions", sum(
+                1 for line in lines if not isinstance(line, (
+                    asm_cmds.Label, asm_cmds.Comment, asm_cmds.Align))))
+        if self.arguments.debug:
+            lines = dwarf.add_cfi(lines)
+        return lines, asm_code.rodata, self._changed_registers(commands,
+                                                               lines)
+
+    def _align(self, lines):
+        """Return the lines of a function with its alignment directives.
+
+        The entry point is aligned, and with -falign-loops so is each label a
+        later jump targets, which is the header of a loop.
+        """
+        headers = set()
+        if self.arguments.align_loops:
+            seen = set()
+            for line in lines:
+                if isinstance(line, asm_cmds.Label):
+                    seen.add(line.label)
+                elif (isinstance(line, asm_cmds._JumpCommand)
+                      and line.target in seen):
+                    headers.add(line.target)
+
+        aligned = [asm_cmds.Align(self.function_align)]
+        for line in lines:
+            if isinstance(line, asm_cmds.Label) and line.label in headers:
+                aligned.append(
+                    asm_cmds.Align(self.loop_align, self.loop_max_skip))
+            aligned.append(line)
+        return aligned
+
+    def add_function(self, result):
+        """Add the results of generate to the ASM code.
+
+        returns - the lines of the ASM code of the function
+        """
+        lines, rodata, _ = result
+        self.asm_code.rodata.extend(rodata)
+        return lines
 
-        spilled_nodes = []
+    def finish(self):
+        """Add the static data and global names of the file to the ASM code.
 
-        while True:
-            g = g_bak.copy()
+        This is done once every function is generated, since a tentative
+        definition may be completed by a definition after the functions
+        which use it. Only the static data in live_statics is added.
+        """
+        EXTERNAL = self.symbol_table.EXTERNAL
+        INTERNAL = self.symbol_table.INTERNAL
+        TENTATIVE = self.symbol_table.TENTATIVE
+        DEFINED = self.symbol_table.DEFINED
 
-            # Remove all nodes that have been spilled for this iteration
-            for n in spilled_nodes:
-                g.pop(n)
+        live = self.live_statics()
+        for v, storage in self.symbol_table.storage.items():
+            if storage != self.symbol_table.STATIC or v not in live:
+                continue
+            name = self._global_spot(v).base
+            # A thread-local object cannot be a common symbol, so a
+            # tentative definition of one is defined as zeroed data.
+            thread_local = v in self.symbol_table.thread_locals
+            if (self.symbol_table.def_state.get(v) == TENTATIVE
+                  and not thread_local):
+                local = (self.symbol_table.linkage_type[v] == INTERNAL)
+                self.asm_code.add_comm(name, v.ctype.size, local)
+            else:
+                image = [(offset, size, self._data_value(value))
+                         for offset, size, value
+                         in self.il_code.static_inits.get(v, [])]
+
+                # Addresses in position-independent data are filled in by
+                # the dynamic linker, so the data must be writable.
+                const = self._is_const(v.ctype) and not (
+                    self.arguments.pic and any(
+                        isinstance(value, tuple) for _, _, value in image))
+                self.asm_code.add_data(name, v.ctype.size, image, const,
+                                       v.ctype.align, thread_local)
+                if (thread_local and self.symbol_table.linkage_type.get(v)
+                        == EXTERNAL and self.symbol_table.def_state.get(v)
+                        == TENTATIVE):
+                    self.asm_code.add_global(name)
+
+        externs = self.symbol_table.linkages[EXTERNAL].values()
+        for v in externs:
+            if self.symbol_table.def_state.get(v) == DEFINED:
+                self.asm_code.add_global(self.symbol_table.names[v])
 
-            removed_nodes = []
-            merged_nodes = {}
+        if self.peephole and self.arguments.show_peephole_hits:
+            self.peephole.show_hits()  # pragma: no cover
 
-            # Repeat simplification, coalescing, and freeze until freeze
-            # does not work.
-            while True:
-                # Repeat simplification and coalescing until nothing
-                # happens.
-                while True:
-                    simplified = self._simplify_all(removed_nodes, g)
-                    merged = self._coalesce_all(merged_nodes, g)
+    def live_statics(self):
+        """Return the set of values not specific to a function which the
+        program may reach.
 
-                    if not simplified and not merged: break
+        These are the values the functions generated so far use and the
+        objects with external linkage, along with the values the static data
+        of each of these refers to, in turn.
+        """
+        live = set(self.global_spotmap)
+        live.update(v for v, linkage in self.symbol_table.linkage_type.items()
+                    if linkage == self.symbol_table.EXTERNAL)
+        work = list(live)
+        while work:
+            for _, _, value in self.il_code.static_inits.get(work.pop(), []):
+                if isinstance(value, tuple) and value[0] not in live:
+                    live.add(value[0])
+                    work.append(value[0])
+        return live
+
+    def _make_asm(self, func, commands, global_spotmap, counts, asm_code):
+        """Generate ASM code for the command list of function `func`."""
 
-                if not self._freeze(g):
-                    break
+        # Get free values
+        free_values = self._get_free_values(commands, global_spotmap)
 
-            # If no nodes remain, we are done
-            if not g.nodes():
-                break
-            # If nodes do remain, spill one of them and retry
-            else:
-                # Spill node with highest number of conflicts. This node
-                # will never be a merged node because we merge nodes
-                # conservatively, so any recently merged node can be
-                # simplified immediately.
-                n = max(g.nodes(), key=lambda n: len(g.confs(n)))
-                spilled_nodes.append(n)
-
-        # Move any remaining nodes from graph into removed_nodes
-        # This accounts for pseudonodes which cannot be removed in the
-        # simplify phase.
-        while g.all_nodes():
-            removed_nodes.append(g.pop(g.all_nodes()[0]))
-
-        # Pop values off the stack to generate spot assignments.
-        spotmap = self._generate_spotmap(removed_nodes, merged_nodes, g_bak)
-
-        # Assign stack values to the spilled nodes
-        for v in spilled_nodes:
-            self.offset += v.ctype.size
-            spotmap[v] = MemSpot(spots.RBP, -self.offset)
-
-        # Merge global spotmap into this spotmap
-        for v in global_spotmap:
-            spotmap[v] = global_spotmap[v]
+        # Values whose address may escape are kept in memory, each in a
+        # stack slot of its own, because a pointer to them may be used
+        # anywhere. Values which are only referenced internally to a
+        # command, like the base of a SetRel, are kept in memory but may
+        # share a slot with any value not live at the same time.
+        escaping = set()
+        in_memory = set()
+        for command in commands:
+            for ref_by, values in command.references().items():
+                for v in values:
+                    in_memory.add(v)
+                    if ref_by is not None:
+                        escaping.add(v)
 
-        if self.arguments.show_reg_alloc_perf:  # pragma: no cover
-            total_prefs = 0
-            matched_prefs = 0
+        # In addition, move all IL values of strange size to memory because
+        # they won't fit in a register.
+        for v in free_values:
+            if v.ctype.size not in {1, 2, 4, 8}:
+                in_memory.add(v)
+
+        mem_values = [v for v in free_values if v in in_memory]
+        free_values = [v for v in free_values if v not in in_memory]
+        shared_mem = [v for v in mem_values if v not in escaping]
 
-            for n1, n2 in itertools.combinations(g_bak.all_nodes(), 2):
-                if n2 in g_bak.prefs(n1):
-                    total_prefs += 1
-                    if spotmap[n1] == spotmap[n2]:
-                        matched_prefs += 1
+        # Perform liveliness analysis
+        flow = CFG(commands)
+        live_vars = self._get_live_vars(flow, free_values)
+        mem_live_vars = self._get_live_vars(flow, shared_mem)
+
+        remat = self._get_remat_candidates(commands, free_values)
+        spill_costs = self._get_spill_costs(flow, free_values, counts, remat)
+
+        # Each value is kept in the registers of its class. Values of two
+        # classes never share a register, so each class is allocated on its
+        # own, over the liveness of its values alone.
+        classes = {}
+        for v in free_values:
+            classes.setdefault(spots.register_class(v.ctype), []).append(v)
 
-            print("total prefs", total_prefs)
-            print("matched prefs", matched_prefs)
+        spotmap = {}
+        spill_groups = []
+        graphs = {}
+        allocators = []
+        for reg_class, values in classes.items():
+            registers = self.alloc_registers[reg_class]
+            if len(classes) == 1:
+                class_live_vars = live_vars
+            else:
+                class_live_vars = self._get_live_vars(flow, values)
 
-            print("total ILValues", len(g_bak.nodes()))
-            print("register ILValues", len(g_bak.nodes()) - len(spilled_nodes))
+            if self.arguments.reg_alloc == "linear":
+                allocator = LinearScan(commands, values, class_live_vars,
+                                       registers, spill_costs)
+            else:
+                # Generate conflict and preference graph
+                g = self._generate_graph(flow, values, class_live_vars,
+                                         registers)
+                graphs[reg_class] = g
+                timer.count("graph_nodes", len(g.all_nodes()))
+                timer.count("graph_edges", g.num_conflicts())
+                allocator = IteratedCoalescer(g, registers, spill_costs)
+            class_spotmap, class_spill_groups = allocator.allocate()
+            spotmap.update(class_spotmap)
+            spill_groups += class_spill_groups
+            allocators.append(allocator)
+            if isinstance(allocator, IteratedCoalescer):
+                timer.count("spill_rounds", allocator.spill_rounds)
+                timer.count("coalesced_moves", allocator.coalesced_moves)
+
+        # A spilled value which is cheap to recompute gets no stack slot,
+        # and is recomputed into a scratch register before each use.
+        spilled = {v for group in spill_groups for v in group}
+        remat = {v: c for v, c in remat.items() if v in spilled}
+        spill_groups = [[v for v in group if v not in remat]
+                        for group in spill_groups]
+        spill_groups = [group for group in spill_groups if group]
+        timer.count("rematerialized", len(remat))
+
+        # Assign stack slots to everything kept in memory. Nodes coalesced
+        # together never conflict, so each group can share a single spot.
+        spilled_nodes = [v for group in spill_groups for v in group]
+        points = live_points(spilled_nodes, live_vars)
+        points.update(live_points(shared_mem, mem_live_vars))
+
+        shareable = []
+        for group in spill_groups:
+            group_points = 0
+            for v in group:
+                group_points |= points[v]
+            shareable.append((group, group_points))
+        shareable += self._coalesce_mem(commands, shared_mem, points)
+        own_slot = [v for v in mem_values if v in escaping]
+        spotmap.update(self._assign_stack_slots(own_slot, shareable))
+
+        if self.arguments.show_spills:  # pragma: no cover
+            self._show_spills(func, spill_groups, spill_costs)
+
+        # Merge the spots of the global values used into this spotmap
+        spotmap.update(global_spotmap)
 
         # Generate assembly code
-        self._generate_asm(commands, live_vars, spotmap)
+        with timer.phase("emit"):
+            frame_size = self._generate_asm(
+                commands, live_vars, spotmap, remat, asm_code)
 
-    def _get_global_spotmap(self):
-        """Generate global spotmap and add global values to ASM.
+        if self.arguments.show_reg_alloc_perf:  # pragma: no cover
+            values = [v for v in free_values if v not in remat] + mem_values
+            self._show_reg_alloc_perf(func, self._reg_alloc_report(
+                commands, values, graphs, allocators, spotmap, spilled_nodes,
+                remat, escaping, in_memory, frame_size))
 
-        This function generates a spotmap for variables which are not
-        specific to a single function. This includes literals and variables
-        with static storage duration.
-        """
-        global_spotmap = {}
+        if self.arguments.reg_alloc_graph_dir:  # pragma: no cover
+            for reg_class, g in graphs.items():
+                self._write_graph(func, reg_class, g, spotmap, spill_costs)
 
-        EXTERNAL = self.symbol_table.EXTERNAL
-        DEFINED = self.symbol_table.DEFINED
+    @staticmethod
+    def _changed_registers(commands, lines):
+        """Return the caller-saved registers the code of a function may
+        change, of both register classes.
 
-        num = 0
+        These are the registers the ASM code writes, the registers its calls
+        may change, and the registers values are returned in.
+        """
+        regs = set(abi.ret_regs + abi.sse_ret_regs)
+        for command in commands:
+            regs.update(command.clobber())
+        for line in lines:
+            regs.update(implicit_writes.get(type(line), []))
+            written = [getattr(line, "dest", None)]
+            if isinstance(line, (asm_cmds.Xchg, asm_cmds.LockXadd)):
+                written.append(line.source)
+            elif isinstance(line, asm_cmds.InlineAsm):
+                written += line.regs
+            regs.update(spot for spot in written
+                        if isinstance(spot, (RegSpot, XMMSpot)))
+        return [r for r in spots.call_clobbered if r in regs]
 
-        for value in (set(self.il_code.literals.keys()) |
-                      set(self.il_code.string_literals.keys()) |
-                      set(self.symbol_table.storage.keys())):
-            num += 1
-            spot = self._get_nondynamic_spot(value, num)
-            if spot: global_spotmap[value] = spot
+    @staticmethod
+    def _reg_alloc_report(commands, values, graphs, allocators, spotmap,
+                          spilled_nodes, remat, escaping, in_memory,
+                          frame_size):  # pragma: no cover
+        """Return a report of how the registers of a function were allocated.
+
+        values - the values of the function given a spot, in registers or
+        in memory
+        graphs - map from each register class to the graph allocated over,
+        empty under linear scan
+        allocators - the allocator of each register class
+        returns - a dict with the size of the graphs of all classes, the
+        number of spill candidates selected, the number of values kept in
+        memory for each reason, the number of spilled values recomputed at
+        each use instead, how many preferences were honoured, and the frame
+        size
+        """
+        report = {}
+        if graphs:
+            degrees = [g.degree(n) for g in graphs.values()
+                       for n in g.nodes()]
+            report["nodes"] = len(degrees)
+            report["edges"] = sum(g.num_conflicts() for g in graphs.values())
+            report["max degree"] = max(degrees, default=0)
+            report["spill rounds"] = sum(
+                allocator.spill_rounds for allocator in allocators)
+            report["coalesced moves"] = sum(
+                allocator.coalesced_moves for allocator in allocators)
+
+        # Each value kept in memory is counted under the first reason that
+        # applies to it.
+        spills = {"address taken": 0, "referenced": 0, "size": 0,
+                  "pressure": len(spilled_nodes)}
+        for v in values:
+            if v in escaping:
+                spills["address taken"] += 1
+            elif v in in_memory and v.ctype.size in {1, 2, 4, 8}:
+                spills["referenced"] += 1
+            elif v in in_memory:
+                spills["size"] += 1
+        report["spills"] = spills
+        report["rematerialized"] = len(remat)
+
+        values = set(values)
+        prefs = {}
+        for command in commands:
+            for v1, pref_list in command.rel_spot_pref().items():
+                for v2 in pref_list:
+                    if v1 in values and v2 in values and v1 != v2:
+                        prefs[frozenset((v1, v2))] = spotmap[v1], spotmap[v2]
+            for v, pref_list in command.abs_spot_pref().items():
+                for s in pref_list:
+                    if v in values:
+                        prefs[frozenset((v, s))] = spotmap[v], s
+        report["prefs"] = len(prefs)
+        report["prefs honoured"] = sum(1 for s1, s2 in prefs.values()
+                                       if s1 == s2)
+        report["frame size"] = frame_size
+        return report
 
-        externs = self.symbol_table.linkages[EXTERNAL].values()
-        for v in externs:
-            if self.symbol_table.def_state.get(v) == DEFINED:
-                self.asm_code.add_global(self.symbol_table.names[v])
+    @staticmethod
+    def _show_reg_alloc_perf(func, report):  # pragma: no cover
+        """Print the report of _reg_alloc_report for function `func`."""
+        spills = report.pop("spills")
+        fields = [f"{name} {value}" for name, value in report.items()]
+        fields += [f"spilled for {reason} {n}"
+                   for reason, n in spills.items()]
+        print(f"{func}: " + ", ".join(fields))
+
+    def _write_graph(self, func, reg_class, g, spotmap,
+                     spill_costs):  # pragma: no cover
+        """Write the graph of register class `reg_class` of function `func`
+        as a Graphviz file, named for the function in the directory given by
+        -z-reg-alloc-graph. The graph of a class other than the general
+        registers has the name of the class appended, like func.sse.dot.
+
+        Each real node is labeled with its name, or a number if it is a
+        temporary, and its spill cost.
+        """
+        names = self.symbol_table.names if self.symbol_table else {}
+        labels = {}
+        for n, v in enumerate(g.nodes()):
+            name = names.get(v, f"t{n}")
+            labels[v] = f"{name} ({spill_costs[v]:g})"
+
+        name = func if reg_class == spots.GENERAL else f"{func}.{reg_class}"
+        path = os.path.join(self.arguments.reg_alloc_graph_dir, f"{name}.dot")
+        try:
+            with open(path, "w") as dot_file:
+                dot_file.write(g.to_dot(func, labels, spotmap))
+        except IOError:
+            descrip = f"could not write graph file '{path}'"
+            error_collector.add(CompilerError(descrip, warning=True))
+
+    def _global_spot(self, v):
+        """Return the spot of a value not specific to a single function.
+
+        These are literals, string literals, variables with no storage, and
+        variables with static storage. The spot is made the first time it is
+        asked for. Returns None if v is not one of these values, so it goes
+        in a dynamic spot like a register.
+        """
+        if v in self.global_spotmap:
+            return self.global_spotmap[v]
 
-        return global_spotmap
+        spot = self._get_nondynamic_spot(v)
+        if spot:
+            self.global_spotmap[v] = spot
+        return spot
 
-    def _get_nondynamic_spot(self, v, num):
+    def _get_nondynamic_spot(self, v):
         """Get a spot for non-dynamic values.
 
         In particular, assigns a spot to all literals, string literals,
-        variables with no storage, and variables with static storage.
+        variables with no storage, and variables with static storage. The
+        static data of variables is added by finish.
+
+        Each label is named by what is stored there, or by the number of the
+        object among those of its name, rather than by the order in which
+        the values are first used. So the code of a function does not
+        depend on the functions before it.
 
         v - value to get a spot for, or None if the value goes in a dynamic
         spot like a register
-        nnum - positive integer guaranteed never to be the same for two
-        distinct calls to this function
         """
         EXTERNAL = self.symbol_table.EXTERNAL
-        INTERNAL = self.symbol_table.INTERNAL
-        TENTATIVE = self.symbol_table.TENTATIVE
 
-        if v in self.il_code.literals:
+        if v in self.il_code.literals and v.ctype.is_floating():
+            name = self._add_float_literal(self.il_code.literals[v],
+                                           v.ctype.size)
+            return self._label_spot(v, name)
+
+        elif v in self.il_code.literals:
             return LiteralSpot(self.il_code.literals[v])
 
         elif v in self.il_code.string_literals:
-            name = f"__strlit{num}"
-            self.asm_code.add_string_literal(
-                name, self.il_code.string_literals[v])
-            return MemSpot(name)
+            chars = self.il_code.string_literals[v]
+            digest = hashlib.sha1(repr(chars).encode()).hexdigest()
+            name = self.asm_code.add_string_literal(
+                f"__strlit_{digest[:16]}", chars)
+            return self._label_spot(v, name)
 
         # Values with no storage can be referenced directly by name
         elif not self.symbol_table.storage.get(v, True):
-            return MemSpot(self.symbol_table.names[v])
+            return self._label_spot(v, self.symbol_table.names[v])
 
         elif self.symbol_table.storage.get(v) == self.symbol_table.STATIC:
             name = self.symbol_table.names[v]
             if self.symbol_table.linkage_type.get(v) != EXTERNAL:
-                name = f"{name}.{num}"
+                self.symbol_table.number_static(v)
+                name = f"{name}.{self.symbol_table.static_numbers[v]}"
+            return self._label_spot(v, name)
+
+    def _add_float_literal(self, val, size):
+        """Add a floating literal to the ASM code, and return its label."""
+        bits = ctypes.float_bits(val, size)
+        return self.asm_code.add_float_literal(
+            f"__floatlit{size}_{bits:x}", val, size)
+
+    def _label_spot(self, v, name):
+        """Return the spot of value `v`, stored at the given label.
+
+        Position-independent code addresses the value relative to RIP, or
+        through the global offset table if another module may define it.
+        A thread-local object is addressed relative to the thread pointer,
+        or through the global offset table as well.
+        """
+        pic = self.arguments.pic
+        if v in self.symbol_table.thread_locals:
+            if through_got(self.symbol_table, v, pic):
+                return TLSGOTSpot(name)
+            return TLSSpot(name)
+        elif not pic:
+            return MemSpot(name)
+        elif through_got(self.symbol_table, v, pic):
+            return GOTSpot(name)
+        return RipSpot(name)
 
-            if self.symbol_table.def_state.get(v) == TENTATIVE:
-                local = (self.symbol_table.linkage_type[v] == INTERNAL)
-                self.asm_code.add_comm(name, v.ctype.size, local)
-            else:
-                init_val = self.il_code.static_inits.get(v, 0)
-                self.asm_code.add_data(name, v.ctype.size, init_val)
+    def _data_value(self, value):
+        """Return a value of a static initializer as add_data takes it.
 
-            return MemSpot(name)
+        An address is given by the label of the object addressed, or by the
+        symbol of the label of a function.
+        """
+        if isinstance(value, tuple) and isinstance(value[0], FunctionLabel):
+            label, addend = value
+            func = self.symbol_table.names[label.func]
+            return ASMCode.label_symbol(func, label.name), addend
+        elif isinstance(value, tuple):
+            base, addend = value
+            return self._global_spot(base).base, addend
+        return value
+
+    def _is_const(self, ctype):
+        """Return whether an object of given type is never written.
+
+        An array is const if its elements are.
+        """
+        while ctype.is_array():
+            ctype = ctype.el
+        return ctype.const
 
     def _get_free_values(self, commands, global_spotmap):
         """Generate list of free values.
 
         Returns a list of the free values, the variables which need
-        allocation on the stack.
+        allocation on the stack. Every value used by the commands is given
+        an ID first, by which the analyses below index their bitsets.
         """
-        free_values = []
-        for command in commands:
-            for value in command.inputs() + command.outputs():
-                if (value and value not in free_values
-                      and value not in global_spotmap):
-                    free_values.append(value)
+        return [v for v in number_values(commands)
+                if v not in global_spotmap]
 
-        return free_values
-
-    def _get_live_vars(self, commands, free_values):
+    def _get_live_vars(self, flow, free_values):
         """Given a set of free ILValues, find when those ILValues are live.
 
+        Liveness is solved over
+        the block graph with a worklist, so a block is only reprocessed when
+        the live-in set of one of its successors changes. Live sets are
+        stored as integer bitsets, where bit i is set iff the free value with
+        ID i is live.
+
+        flow (CFG) - control flow graph of the function
         free_values - list of ILValues for which to perform liveliness analysis
         returns - array mapping command indices to a tuple where first
         element is a list of variables live coming into the command and the
         second is a list of the variables live exiting the command
         """
-        # Preprocess all commands to get a mapping from labels to command
-        # number.
-        labels = {c.label_name(): i for i, c in enumerate(commands)
-                  if c.label_name()}
+        mask = 0
+        by_id = {}
+        for v in free_values:
+            mask |= 1 << v.id
+            by_id[v.id] = v
+
+        def to_bits(values):
+            bits = 0
+            for v in values:
+                if v:
+                    bits |= 1 << v.id
+            return bits & mask
+
+        commands = flow.commands
+        uses = [to_bits(c.inputs()) for c in commands]
+        defs = [to_bits(c.outputs()) for c in commands]
+
+        # Compute the upward-exposed uses and the definitions of each block.
+        blocks = flow.blocks
+        gen = []
+        kill = []
+        for block in blocks:
+            block_gen = 0
+            block_kill = 0
+            for i in range(block.end - 1, block.start - 1, -1):
+                block_gen = (block_gen & ~defs[i]) | uses[i]
+                block_kill |= defs[i]
+            gen.append(block_gen)
+            kill.append(block_kill)
+
+        live_in = [0] * len(blocks)
+        live_out = [0] * len(blocks)
+
+        # Blocks are popped from the end, so process later blocks first.
+        worklist = blocks[:]
+        in_worklist = [True] * len(blocks)
+        while worklist:
+            block = worklist.pop()
+            in_worklist[block.index] = False
+
+            out_bits = 0
+            for succ in block.succs:
+                out_bits |= live_in[succ.index]
+            live_out[block.index] = out_bits
+
+            in_bits = gen[block.index] | (out_bits & ~kill[block.index])
+            if in_bits != live_in[block.index]:
+                live_in[block.index] = in_bits
+                for pred in block.preds:
+                    if not in_worklist[pred.index]:
+                        in_worklist[pred.index] = True
+                        worklist.append(pred)
+
+        def to_list(bits):
+            values = []
+            while bits:
+                low = bits & -bits
+                values.append(by_id[low.bit_length() - 1])
+                bits ^= low
+            return values
+
+        # Walk each block backwards to recover per-command live sets.
+        live_vars = [None] * len(commands)
+        for block in blocks:
+            cur_live = live_out[block.index]
+            for i in range(block.end - 1, block.start - 1, -1):
+                # A variable defined in this command is live on output from
+                # it, even if the variable is never used afterward. Such
+                # outputs are mostly removed by dead code elimination
+                # already, so only commands with side effects remain.
+                out_live = cur_live | defs[i]
+                cur_live = (cur_live & ~defs[i]) | uses[i]
+                live_vars[i] = (to_list(cur_live), to_list(out_live))
 
-        # Last iteration of live variables
-        prev_live_vars = None
+        return live_vars
 
-        # This iteration of live variables
-        live_vars = [([], []) for i in range(len(commands))]
+    def _coalesce_mem(self, commands, values, points):
+        """Group memory values connected by spot preferences.
 
-        while live_vars != prev_live_vars:
-            prev_live_vars = live_vars[:]
+        Consider the following C code, where S is already declared:
 
-            # List of currently live variables
-            cur_live = []
+          struct S array[10];
+          s = array[1];
 
-            # Iterate through commands in backwards order
-            for i, command in list(enumerate(commands))[::-1]:
-                # If current command is a jump, add the live inputs of all
-                # possible targets to the current live list.
-                for label in command.targets():
-                    i2 = labels[label]
-                    for v in prev_live_vars[i2][0]:
-                        if v not in cur_live:
-                            cur_live.append(v)
+        This code compiles to the following IL:
 
-                # Variables live on output from this command
-                out_live = cur_live[:]
+          READREL(array, 1) -> X
+          SET(X) -> s
 
-                # Add variables used in this command to current live variables
-                for v in command.inputs():
-                    if v in free_values and v not in cur_live:
-                        cur_live.append(v)
+        X is just a temporary, so it should live in the same memory as `s`,
+        which lets the SET skip its copy. Values of this kind are merged
+        into one group whenever a command prefers they share a spot, they
+        have the same size, and no value in one group is live at the same
+        time as a value in the other.
 
-                # Remove variables defined in this command to live variables
-                for v in command.outputs():
-                    if v in free_values:
-                        if v in cur_live:
-                            cur_live.remove(v)
-                        else:
-                            # If variable is defined in command but was not
-                            # live, make it live on output from this command.
+        values - list of memory values which may share slots
+        points - dictionary mapping each value to its live points
+        returns - list of (group, points) tuples, as taken by
+        _assign_stack_slots
+        """
+        parent = {v: v for v in values}
+        group_points = {v: points[v] for v in values}
 
-                            # TODO: Deal with this more efficiently.
-                            # If the output is not live, then we don't actually
-                            # need to perform this computation.
-                            out_live.append(v)
+        def find(v):
+            while parent[v] != v:
+                parent[v] = parent[parent[v]]
+                v = parent[v]
+            return v
 
-                # Variables live on input from this command
-                in_live = cur_live[:]
+        for command in commands:
+            for v1, prefs in command.rel_spot_pref().items():
+                for v2 in prefs:
+                    if (v1 not in parent or v2 not in parent
+                          or v1.ctype.size != v2.ctype.size):
+                        continue
+
+                    g1, g2 = find(v1), find(v2)
+                    if g1 != g2 and not group_points[g1] & group_points[g2]:
+                        parent[g2] = g1
+                        group_points[g1] |= group_points.pop(g2)
+
+        groups = {}
+        for v in values:
+            groups.setdefault(find(v), []).append(v)
+        return [(group, group_points[root]) for root, group in groups.items()]
+
+    def _assign_stack_slots(self, own_slot, shareable):
+        """Lay out the stack frame of the current function.
+
+        Each value in own_slot gets a slot of its own. Then, largest first,
+        each group of values in shareable is packed into an existing slot
+        that is large enough and holds no value live at the same time, or
+        into a new slot if there is none. Every slot is aligned to the
+        alignment of the types of the values it holds, and one of 16 bytes
+        or more to 8 bytes, like an array of that size is in the ABI. The
+        callee-saved registers pushed above the slots leave RBP only 8-byte
+        aligned with them, so no slot is aligned to more.
+
+        own_slot - list of ILValues
+        shareable - list of (group, points) tuples, where group is a list of
+        ILValues that may share a slot, and points is the union of their
+        live points as computed by live_points
+        returns - dictionary mapping each value to its MemSpot
+        """
+        def alignment(ctype):
+            return min(8, max(ctype.align, 8 if ctype.size >= 16 else 1))
 
-                live_vars[i] = (in_live, out_live)
+        offset = 0
 
-        return live_vars
+        def new_slot(size, align):
+            nonlocal offset
+            offset = ctypes.align_up(offset + size, align)
+            return MemSpot(spots.RBP, -offset)
+
+        spotmap = {}
+        for v in own_slot:
+            spotmap[v] = new_slot(v.ctype.size, alignment(v.ctype))
+
+        # Each slot is a list of [spot, size, points of values it holds,
+        # alignment].
+        slots = []
+
+        def group_size(item):
+            return max(v.ctype.size for v in item[0])
+
+        for group, points in sorted(shareable, key=group_size, reverse=True):
+            size = group_size((group, points))
+            align = max(alignment(v.ctype) for v in group)
+            for slot in slots:
+                if (slot[1] >= size and not slot[2] & points
+                      and slot[3] % align == 0):
+                    slot[2] |= points
+                    break
+            else:
+                slot = [new_slot(size, align), size, points, align]
+                slots.append(slot)
+
+            for v in group:
+                spotmap[v] = slot[0]
+
+        return spotmap
 
-    def _generate_graph(self, commands, free_values, live_vars):
+    def _get_remat_candidates(self, commands, free_values):
+        """Return the values which are cheap to recompute if spilled.
+
+        These are the values defined only by a command for which
+        rematerializable is true, or only by a copy of such a value, like a
+        local variable set once to the address of an array.
+
+        returns - map from each such value to the command which computes it
+        """
+        defs = {}
+        for command in commands:
+            for v in command.outputs():
+                defs.setdefault(v, []).append(command)
+
+        candidates = {}
+        for v in free_values:
+            if (len(defs.get(v, [])) == 1 and defs[v][0].rematerializable()
+                  and spots.register_class(v.ctype) == spots.GENERAL):
+                candidates[v] = defs[v][0]
+
+        # Follow chains of copies, in any order.
+        changed = True
+        while changed:
+            changed = False
+            for v in free_values:
+                if v in candidates or len(defs.get(v, [])) != 1:
+                    continue
+                source = defs[v][0].copy_of()
+                if source in candidates:
+                    candidates[v] = candidates[source]
+                    changed = True
+        return candidates
+
+    def _get_spill_costs(self, flow, free_values, counts, remat):
+        """Estimate the cost of spilling each free value.
+
+        Each use or definition of a value costs 10**d, where d is the loop
+        nesting depth of the command, so values used in inner loops are the
+        last to be spilled. If the function ran in the profile, each costs
+        one more than the number of times its block ran instead. A block
+        with no count of its own, made after the profile was given, runs as
+        often as the block before it.
+
+        A value in `remat` is recomputed at each use if spilled, with no
+        load from memory, and its definition then costs nothing. So each of
+        its uses costs half as much, and it is spilled before other values.
+        """
+        costs = dict.fromkeys(free_values, 0)
+        profiled = any(counts.values())
+        count = 0
+        for block in flow.blocks:
+            weight = 10 ** min(flow.depths[block.index], 6)
+            if profiled:
+                count = counts.get(
+                    flow.commands[block.start].label_name(), count)
+                weight = count + 1
+            for command in flow.commands[block.start:block.end]:
+                for v in command.inputs():
+                    if v in costs:
+                        costs[v] += weight / 2 if v in remat else weight
+                for v in command.outputs():
+                    if v in costs and v not in remat:
+                        costs[v] += weight
+
+        # A value with no uses costs nothing to spill, but keep the cost
+        # positive so that lower degree still means higher cost per degree.
+        for v in costs:
+            costs[v] = max(costs[v], 0.5)
+        return costs
+
+    def _show_spills(self, func, spill_groups, spill_costs):
+        """Print the values spilled in function `func`."""
+        names = self.symbol_table.names
+        for group in spill_groups:
+            desc = ", ".join(names.get(v, f"temporary {v}") for v in group)
+            cost = sum(spill_costs[v] for v in group)
+            print(f"{func}: spilled {desc} (cost {cost:g})")
+
+    def _generate_graph(self, flow, free_values, live_vars, registers):
         """Generate the conflict/preference graph.
 
+        flow (CFG) - control flow graph of the function
         free_values - List of ILValues to include in the graph
         live_vars - Live range information from _get_live_vars
+        registers - Registers the values are allocated to. Only these are
+        added as precolored nodes.
 
         """
         g = NodeGraph(free_values)
-        for i, command in enumerate(commands):
-            # Variables active during input
-            for n1, n2 in itertools.combinations(live_vars[i][0], 2):
-                g.add_conflict(n1, n2)
 
-            # Variables active during output
-            for n1, n2 in itertools.combinations(live_vars[i][1], 2):
-                g.add_conflict(n1, n2)
+        # Whether each value is in the graph, indexed by ID.
+        is_free = bytearray(max((v.id for v in free_values), default=-1) + 1)
+        for v in free_values:
+            is_free[v.id] = 1
+
+        def free(v):
+            return v is not None and v.id < len(is_free) and is_free[v.id]
+
+        # Two variables conflict iff one is live at a point where the other
+        # is defined, or both are live on entry to a block with no
+        # predecessors. Adding edges only at definitions keeps graph
+        # construction proportional to the number of edges.
+        commands = flow.commands
+        for block in flow.blocks:
+            if not block.preds:
+                entry_live = live_vars[block.start][0]
+                for n1, n2 in itertools.combinations(entry_live, 2):
+                    g.add_conflict(n1, n2)
+
+        for i, command in enumerate(commands):
+            # The output of a copy holds the same value as its source, so
+            # the two may share a spot even if the source remains live.
+            source = command.copy_of()
+            for n1 in command.outputs():
+                if g.is_node(n1):
+                    for n2 in live_vars[i][1]:
+                        if n1 != n2 and n2 != source:
+                            g.add_conflict(n1, n2)
 
             # Relative conflict set of this command
             for n1 in command.rel_spot_conf():
                 for n2 in command.rel_spot_conf()[n1]:
-                    if n1 in free_values and n2 in free_values:
+                    if free(n1) and free(n2):
                         g.add_conflict(n1, n2)
 
             # Absolute conflict set of this command
             for n in command.abs_spot_conf():
                 for s in command.abs_spot_conf()[n]:
-                    if n in free_values:
-                        if s not in g.all_nodes():
+                    if free(n) and s in registers:
+                        if not g.is_node(s):
                             g.add_dummy_node(s)
                         g.add_conflict(n, s)
 
             # Clobber set of this command
+            live_out = set(live_vars[i][1])
             for s in command.clobber():
-                if s not in g.all_nodes():
+                if s not in registers:
+                    continue
+                if not g.is_node(s):
                     g.add_dummy_node(s)
 
                 # Add a conflict with dummy node for every variable live
                 # during both entry and exit from this command.
                 for n in live_vars[i][0]:
-                    if n in live_vars[i][1]:
+                    if n in live_out:
                         g.add_conflict(n, s)
 
             # Form preferences based on rel_spot_pref
@@ -609,217 +2074,246 @@ class ASMGen:
             # Form preferences based on abs_spot_pref
             for v in command.abs_spot_pref():
                 for s in command.abs_spot_pref()[v]:
-                    if v in free_values:
-                        if s not in g.all_nodes():
+                    if free(v) and s in registers:
+                        if not g.is_node(s):
                             g.add_dummy_node(s)
                         g.add_pref(v, s)
         return g
 
-    def _simplify_all(self, removed_nodes, g):
-        """Repeat the Simplify step until no more can be done.
-
-        Returns False iff no simplification is done.
-
-        removed_nodes - stack of removed nodes to which this function adds
-        the nodes it removes
-        """
-
-        # Get nodes without preference edges
-        no_pref = [v for v in g.nodes() if not g.prefs(v)]
-
-        # Repeat simplification until no more nodes can be removed
-        did_something = False
-        while True:
-            rem = self._simplify_once(no_pref, g)
-            if rem:
-                removed_nodes.append(rem)
-                no_pref.remove(rem)
-                did_something = True
-            else:
-                break
-
-        return did_something
-
-    def _simplify_once(self, nodes, g):
-        """Remove and return a node in nodes if it has low conflict degree."""
-        for v in nodes:
-            # If the node has low conflict degree remove it from the graph
-            if len(g.confs(v)) < len(self.alloc_registers):
-                return g.pop(v)
-
-    def _coalesce_all(self, merged_nodes, g):
-        """Repeat the coalesce step until no more can be done.
+    def _generate_asm(self, commands, live_vars, spotmap, remat, asm_code):
+        """Generate assembly code.
 
-        Returns False iff no simplification is done.
+        remat - map from each value recomputed at each use rather than kept
+        to the command which computes it. The code of that command is made
+        into a scratch register before each command that reads the value,
+        in place of its own code. That register is the only one it gets.
 
-        merged_nodes - Mapping from node to list of nodes. Every node in the
-        list of nodes has been merged into the key node.
-        """
-        did_something = False
-        while True:
-            merge = self._coalesce_once(g)
-            if merge:
-                if merge[0] not in merged_nodes:
-                    merged_nodes[merge[0]] = []
-
-                merged_nodes[merge[0]].append(merge[1])
-                did_something = True
-            else:
-                break
+        By default, stack values are addressed off RBP, which the prologue
+        points at the frame of the function. With -fomit-frame-pointer,
+        they are addressed off RSP instead. Then a leaf function, which makes
+        no calls, needs no prologue at all if it has no stack values, and
+        keeps a small frame in the red zone below RSP without moving RSP.
 
-        return did_something
+        With -g, the code of each command is preceded by a Loc naming its
+        source line, if that differs from the line before. The prologue is
+        given the line of the first command, that of the function.
 
-    def _coalesce_once(self, g):
-        """Perform one iteration of the coalesce step.
-
-        Returns the merged pair if a merge was successfully completed. The
-        first element is the preserved node, and the second element is the
-        removed node.
+        returns - the size in bytes of the frame, counting the callee-saved
+        registers saved but not the return address or alignment
         """
-        for v1 in g.nodes():
-            for v2 in g.prefs(v1):
-                # If the two nodes conflict, automatically continue.
-                if v1 in g.confs(v2):
-                    continue
-
-                total_confs = len(set(g.confs(v1)) | set(g.confs(v2)))
-
-                # If one is a spot, use a special heuristic.
-                # (described on section 6, page 311 of George & Appel)
-                if isinstance(v1, Spot):
-                    v1, v2 = v2, v1
-                if isinstance(v2, Spot):
-                    for T in g.confs(v1):
-                        if v2 in g.confs(T):
-                            continue
-                        if len(g.confs(T)) < len(self.alloc_registers):
-                            continue
-                        break
-                    else:
-                        # We can merge v1 into v2.
-                        g.merge(v2, v1)
-                        return v2, v1
-
-                # Otherwise, apply regular merging rules.
-                elif total_confs < len(self.alloc_registers):
-                    g.merge(v1, v2)
-                    return v1, v2
-
-    def _freeze(self, g):
-        """Remove one preference edge.
-
-        This function finds two nodes, preferably of low conflict degree,
-        that are connected by a preference edge. Then, this preference edge
-        is removed from the graph. Returns false iff nothing is done.
-        """
-
-        # Sort a list of nodes by conflict degree
-        nodes = sorted(g.all_nodes(), key=lambda n: len(g.confs(n)))
-        index_pairs = list(itertools.combinations(list(enumerate(nodes)), 2))
-
-        # Sort pairs to prioritize nodes which appear earlier in `nodes`
-        index_pairs.sort(key=lambda p: p[0][0] + p[1][0])
-
-        # Extract just the node pairs
-        pairs = [(p[0][1], p[1][1]) for p in index_pairs]
-
-        # Now, the earlier pairs in `pairs` have lower conflict degree and
-        # are thus superior candidates for freezing.
-        for n1, n2 in pairs:
-                if n1 in g.prefs(n2):
-                    g.remove_pref(n1, n2)
-                    return True
-
-        return False
-
-    def _generate_spotmap(self, removed_nodes, merged_nodes, g):
-        """Pop values off stack to generate spot assignments."""
-
-        # Get a set of nodes which interfere with n or anything merged into it
-        def get_conflicts(n):
-            conflicts = set(g.confs(n))
-            for n1 in merged_nodes.get(n, []):
-                conflicts |= get_conflicts(n1)
-            return conflicts
-
-        # Get a set of nodes which are merged into `n`
-        def get_merged(n):
-            merged = {n}
-            for n1 in merged_nodes.get(n, []):
-                merged |= get_merged(n1)
-            return merged
-
-        # Build up spotmap
-        spotmap = {}
-        i = 0
-        while removed_nodes:
-            i += 1
-
-            # Allocate register to node `n`
-            n1 = removed_nodes.pop()
-            regs = self.alloc_registers[::-1]
-
-            # If n1 is a Spot (i.e. dummy node), immediately assign it a
-            # register.
-            if n1 in regs:
-                reg = n1
-            else:
-                # Don't chose any conflicting spots
-                for n2 in get_conflicts(n1):
-                    # If n2 is a physical spot
-                    if n2 in regs:
-                        regs.remove(n2)
-                    if n2 in spotmap and spotmap[n2] in regs:
-                        regs.remove(spotmap[n2])
-
-                # Based on algorithm, there should always be register remaining
-                reg = regs.pop()
-
-            # Assign this register to every node merged into n1
-            for n2 in get_merged(n1):
-                spotmap[n2] = reg
+        omit = self.arguments.omit_frame_pointer
 
-        return spotmap
-
-    def _generate_asm(self, commands, live_vars, spotmap):
-        """Generate assembly code."""
-
-        # This is kinda hacky...
-        max_offset = max(spot.rbp_offset() for spot in spotmap.values())
-        if max_offset % 16 != 0:
-            max_offset += 16 - max_offset % 16
-
-        # Back up rbp and move rsp
-        self.asm_code.add(asm_cmds.Push(spots.RBP, None, 8))
-        self.asm_code.add(asm_cmds.Mov(spots.RBP, spots.RSP, 8))
-
-        offset_spot = LiteralSpot(str(max_offset))
-        self.asm_code.add(asm_cmds.Sub(spots.RSP, offset_spot, 8))
+        # Callee-saved registers this function uses, which the prologue
+        # pushes and every epilogue pops. An asm statement may clobber one.
+        used = set(spotmap.values())
+        for command in commands:
+            used.update(command.clobber())
+        saved_regs = [r for r in spots.callee_saved if r in used]
+        save_size = 8 * len(saved_regs)
+
+        values_size = max([0] + [spot.rbp_offset()
+                                 for spot in spotmap.values()])
+        values_size += -values_size % 8
+
+        # Stack values are addressed below the saved registers.
+        if saved_regs:
+            for v, spot in spotmap.items():
+                if isinstance(spot, MemSpot) and spot.base == spots.RBP:
+                    spotmap[v] = MemSpot(spots.RBP, spot.offset - save_size,
+                                         spot.chunk, spot.count)
+
+        # A register borrowed by a command is saved in a slot below the stack
+        # values rather than pushed, since pushing would move the values
+        # addressed off RSP and the stack arguments of calls.
+        borrow_size = 0
+
+        # The get_reg function may only hand out callee-saved registers that
+        # the prologue saves.
+        scratch_regs = [r for r in self.all_registers
+                        if r in spots.caller_saved or r in saved_regs]
+        get_reg = RegisterContext(scratch_regs, spotmap, live_vars)
+
+        line = None
+        if self.arguments.debug:
+            line = next((c.line for c in commands if c.line), None)
+            if line:
+                asm_code.add(asm_cmds.Loc(*line))
 
         # Generate code for each command
+        body_start = len(asm_code.lines)
         for i, command in enumerate(commands):
-            self.asm_code.add(asm_cmds.Comment(type(command).__name__.upper()))
-
-            def get_reg(pref=None, conf=None):
-                if not pref: pref = []
-                if not conf: conf = []
-
-                # Spot is bad if it is containing a variable that is live both
-                # entering and exiting this command.
-                bad_vars = set(live_vars[i][0]) & set(live_vars[i][1])
-                bad_spots = set(spotmap[var] for var in bad_vars)
-
-                # Spot is free if it is where an output is stored.
-                for v in command.outputs():
-                    bad_spots.discard(spotmap[v])
+            if self.arguments.verbose_asm:
+                asm_code.add(
+                    asm_cmds.Comment(type(command).__name__.upper()))
+
+            if any(v in remat for v in command.outputs()):
+                continue
+
+            if line and command.line and command.line != line:
+                line = command.line
+                asm_code.add(asm_cmds.Loc(*line))
+            command_start = len(asm_code.lines)
+
+            get_reg.start(i, command)
+            used = [v for v in command.inputs() if v in remat]
+            for v in dict.fromkeys(used):
+                # The register must also be one the allocator could have
+                # given v, so not one the command conflicts v with, like RAX
+                # and RDX for the divisor of a Div. A register the command
+                # clobbers is allowed, as for any input which dies there, so
+                # a call which clobbers every scratch register still has
+                # one for each argument.
+                conf = [spotmap[w] for w in command.inputs()
+                        + command.outputs() if w in spotmap]
+                conf += command.abs_spot_conf().get(v, [])
+                reg = get_reg(conf=conf)
+                source = remat[v]
+                source.make_asm({**spotmap, source.outputs()[0]: reg},
+                                spotmap, lambda pref=None, conf=None: reg,
+                                asm_code)
+                spotmap[v] = reg
+                get_reg.reserve(reg)
+            command.make_asm(spotmap, spotmap, get_reg, asm_code)
+            for v in used:
+                spotmap.pop(v, None)
+            borrowed = get_reg.borrowed
+
+            # The borrowed registers are restored after the code of the
+            # command, or for a jump, just before its first jump, since a
+            # Mov does not change the flags the jump tests. The registers
+            # are then restored on every exit, as long as no command after
+            # the first jump uses one.
+            restore_at = len(asm_code.lines)
+            if borrowed and command.targets():
+                restore_at = next(
+                    n for n in range(command_start, len(asm_code.lines))
+                    if isinstance(asm_code.lines[n], asm_cmds._JumpCommand))
+                if any(_touches(line, borrowed)
+                       for line in asm_code.lines[restore_at:]):
+                    raise NotImplementedError("spill required for get_reg")
+
+            restores = []
+            for n, reg in enumerate(borrowed):
+                slot = MemSpot(spots.RBP,
+                               -(save_size + values_size + 8 * (n + 1)))
+                asm_code.lines.insert(
+                    command_start, asm_cmds.Mov(slot, reg, 8))
+                restores.append(asm_cmds.Mov(reg, slot, 8))
+            restore_at += len(borrowed)
+            asm_code.lines[restore_at:restore_at] = restores
+            borrow_size = max(borrow_size, 8 * len(borrowed))
+
+        # Arguments of calls passed on the stack are stored off RSP, at the
+        # bottom of the frame.
+        args_size = 0
+        for line in asm_code.lines[body_start:]:
+            for spot in [getattr(line, "dest", None),
+                         getattr(line, "source", None)]:
+                if isinstance(spot, MemSpot) and spot.base == spots.RSP:
+                    args_size = max(args_size, spot.offset + 8)
+
+        frame_size = values_size + borrow_size + args_size
+        if omit:
+            prologue, epilogue = self._omit_frame_pointer(
+                asm_code, body_start, saved_regs, frame_size)
+        else:
+            prologue, epilogue = self._frame(saved_regs, frame_size)
+        asm_code.lines[body_start:body_start] = prologue
+        body_start += len(prologue)
+
+        # Insert the epilogue before every return and tail call, after an
+        # sfence if the function stores around the cache.
+        if any(isinstance(line, (asm_cmds.Movnti, asm_cmds.Movntdq))
+               for line in asm_code.lines[body_start:]):
+            epilogue = [asm_cmds.Sfence()] + epilogue
+        body = []
+        for line in asm_code.lines[body_start:]:
+            if isinstance(line, (asm_cmds.Ret, asm_cmds.TailJmp)):
+                body += epilogue
+            body.append(line)
+        asm_code.lines[body_start:] = body
+        return save_size + frame_size
+
+    def _frame(self, saved_regs, values_size):
+        """Return the prologue and epilogue of a function with RBP as frame.
+
+        saved_regs - callee-saved registers to save
+        values_size - bytes of the frame below the saved registers, for stack
+        values addressed off RBP and stack arguments addressed off RSP
+        """
+        save_size = 8 * len(saved_regs)
+        frame_size = save_size + values_size
+        frame_size += -frame_size % 16
+        frame_size -= save_size
 
-                # Spot is bad if it is listed as a conflicting spot.
-                bad_spots |= set(conf)
+        # Back up rbp and move rsp
+        prologue = [asm_cmds.Push(spots.RBP, None, 8),
+                    asm_cmds.Mov(spots.RBP, spots.RSP, 8)]
+        for reg in saved_regs:
+            prologue.append(asm_cmds.Push(reg, None, 8))
+        if frame_size:
+            offset_spot = LiteralSpot(str(frame_size))
+            prologue.append(asm_cmds.Sub(spots.RSP, offset_spot, 8))
+
+        epilogue = []
+        if saved_regs:
+            restore_spot = MemSpot(spots.RBP, -save_size)
+            epilogue.append(asm_cmds.Lea(spots.RSP, restore_spot))
+            for reg in reversed(saved_regs):
+                epilogue.append(asm_cmds.Pop(reg, None, 8))
+        else:
+            epilogue.append(asm_cmds.Mov(spots.RSP, spots.RBP, 8))
+        epilogue.append(asm_cmds.Pop(spots.RBP, None, 8))
+        return prologue, epilogue
 
-                for s in (pref + self.all_registers):
-                    if isinstance(s, RegSpot) and s not in bad_spots:
-                        return s
+    def _omit_frame_pointer(self, asm_code, body_start, saved_regs,
+                            values_size):
+        """Return the prologue and epilogue of a function without RBP.
 
-                raise NotImplementedError("spill required for get_reg")
+        The function body starting at `body_start` of `asm_code` was
+        generated with stack values addressed off RBP, as if RBP pointed
+        just above the saved registers. These are readdressed off RSP.
 
-            command.make_asm(spotmap, spotmap, get_reg, self.asm_code)
+        saved_regs - callee-saved registers to save
+        values_size - bytes of the frame below the saved registers
+        """
+        save_size = 8 * len(saved_regs)
+        lines = asm_code.lines[body_start:]
+        leaf = not any(isinstance(line, asm_cmds.Call) for line in lines)
+
+        # A leaf function may keep its values in the 128-byte red zone below
+        # RSP, which signal handlers leave alone. Otherwise RSP is moved past
+        # the values, and kept 16-byte aligned for calls.
+        if leaf and values_size <= 128:
+            frame_size = 0
+        else:
+            frame_size = values_size
+            frame_size += -(8 + save_size + frame_size) % 16
+
+        def readdress(spot):
+            if not isinstance(spot, MemSpot) or spot.base != spots.RBP:
+                return spot
+
+            # Arguments on the stack are addressed as if RBP had been pushed
+            # below the return address, like with a frame pointer.
+            offset = spot.offset
+            if offset > 0:
+                offset -= 8
+            return MemSpot(spots.RSP, offset + save_size + frame_size,
+                           spot.chunk, spot.count)
+
+        for line in lines:
+            if hasattr(line, "dest"):
+                line.dest = readdress(line.dest)
+            if hasattr(line, "source"):
+                line.source = readdress(line.source)
+
+        prologue = [asm_cmds.Push(reg, None, 8) for reg in saved_regs]
+        epilogue = []
+        if frame_size:
+            offset_spot = LiteralSpot(str(frame_size))
+            prologue.append(asm_cmds.Sub(spots.RSP, offset_spot, 8))
+            epilogue.append(asm_cmds.Add(spots.RSP, offset_spot, 8))
+        for reg in reversed(saved_regs):
+            epilogue.append(asm_cmds.Pop(reg, None, 8))
+        return prologue, epilogue
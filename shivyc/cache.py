@@ -0,0 +1,319 @@
+"""Cache of compiled object files, addressed by the content compiled.
+
+Each object file is stored under a hash of the preprocessed tokens of its
+source, the compiler version, and the flags which affect the code
+generated. A file whose hash is already in the cache is not compiled
+again; its object file is copied out of the cache instead.
+
+The cache directory holds one file per object, in a subdirectory named by
+the first two digits of the hash, and a log with a line for each hit and
+miss. Objects are written to a temporary file and renamed into place, and
+log lines are appended whole, so several compilers can share the cache.
+
+The cache also saves the paths of the files the driver links with, such as
+crt1.o, so that they are not searched for on every link.
+
+When a file changes, the ASM code of each of its functions which did not
+is taken from the cache instead. A function is stored under a hash of its
+IL code once calls are inlined and before it is optimized, along with all
+the IL code depends on from outside the function: what the symbol table
+knows of each value it uses, the summaries of the functions it calls, and
+how often its blocks run. Labels are hashed by their order in the function,
+since their names count up through the file.
+"""
+
+import hashlib
+import json
+import os
+import pickle
+import shutil
+import tempfile
+import types
+
+import shivyc
+import shivyc.token_kinds as token_kinds
+from shivyc.il_gen import ILValue
+
+# Name of the file logging each hit and miss.
+STATS_FILE = "stats"
+
+# Name of the file saving the paths of the files the driver links with.
+PATHS_FILE = "paths.json"
+
+# Flags which decide the code generated for a file.
+code_flags = ["reg_alloc", "omit_frame_pointer", "peephole", "verbose_asm",
+              "integrated_as", "vectorize", "avx2", "unroll_loops",
+              "unroll_factor", "profile_generate", "profile_file",
+              "strict_aliasing", "opt_level", "lto", "function_sections",
+              "data_sections", "pic", "tune", "align_loops", "debug",
+              "popcnt", "bmi", "lzcnt"]
+
+# Name of each token kind, to hash them by.
+kind_names = {kind: name for name, kind in vars(token_kinds).items()
+              if isinstance(kind, token_kinds.TokenKind)}
+
+
+def key(tokens, args):
+    """Return the cache key of the given preprocessed tokens and flags."""
+    digest = hashlib.sha256()
+    digest.update(f"shivyc {shivyc.__version__}\n".encode())
+    for flag in code_flags:
+        digest.update(f"{flag}={getattr(args, flag)!r}\n".encode())
+    # The debugging information of -g names the directory compiled in.
+    if args.debug:
+        digest.update(f"{os.getcwd()}\n".encode())
+    hash_tokens(digest, tokens, args.debug)
+    return digest.hexdigest()
+
+
+def hash_tokens(digest, tokens, lines=False):
+    """Add the kind and content of each of the tokens to a hash.
+
+    lines (bool) - Whether to add the file and line of each token as well,
+    for code made with -g, which records them.
+    """
+    for token in tokens:
+        digest.update(f"{kind_names[token.kind]} {token.content!r}\n"
+                      .encode())
+        if lines:
+            pos = token.r.start
+            digest.update(f"{pos.file!r} {pos.line}\n".encode())
+
+
+def fetch(cache_dir, key, obj_file):
+    """Copy the cached object of `key` to `obj_file`, if there is one.
+
+    returns - whether the object was in the cache
+    """
+    try:
+        shutil.copyfile(_path(cache_dir, key), obj_file)
+    except FileNotFoundError:
+        _log(cache_dir, "miss")
+        return False
+    _log(cache_dir, "hit")
+    return True
+
+
+def store(cache_dir, key, obj_file):
+    """Save a copy of `obj_file` in the cache under `key`."""
+    path = _path(cache_dir, key)
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    fd, temp = tempfile.mkstemp(dir=os.path.dirname(path))
+    os.close(fd)
+    shutil.copyfile(obj_file, temp)
+    os.replace(temp, path)
+
+
+def function_key(func, commands, il_code, symbol_table, args):
+    """Return the cache key of the code of function `func`, or None if the
+    IL commands hold something which cannot be hashed.
+    """
+    digest = hashlib.sha256()
+    digest.update(f"shivyc {shivyc.__version__}\n".encode())
+    for flag in code_flags:
+        digest.update(f"{flag}={getattr(args, flag)!r}\n".encode())
+    digest.update(f"function {func!r}\n".encode())
+
+    labels = {}
+    for command in commands:
+        for label in [command.label_name()] + command.targets():
+            if label and label not in labels:
+                labels[label] = len(labels)
+    for label in labels:
+        digest.update(f"{label in il_code.cold_labels} "
+                      f"{il_code.counts.get(label)!r}\n".encode())
+
+    try:
+        _Hasher(digest, labels, il_code, symbol_table).add(commands)
+    except TypeError:
+        return None
+    return digest.hexdigest()
+
+
+class _Hasher:
+    """Adds IL commands to a hash, along with the facts outside of them that
+    the code generated for them depends on.
+
+    Objects are hashed by their content, so the hash does not depend on
+    their addresses. Each IL value is hashed in full once, and then by the
+    order in which it was first hashed, so that the uses of the same value
+    are told apart from those of equal values. An object reached again
+    from within itself, like a struct type with a pointer to itself, is
+    hashed by how far up it was reached. Private attributes are not hashed,
+    since they hold state derived from the rest or memos which depend on
+    what was compiled before.
+    """
+
+    def __init__(self, digest, labels, il_code, symbol_table):
+        """Initialize _Hasher."""
+        self.digest = digest
+        self.labels = labels
+        self.il_code = il_code
+        self.symbol_table = symbol_table
+        self.values = {}
+        self.stack = {}
+
+    def add(self, obj):
+        """Add an object to the hash."""
+        write = self.digest.update
+        if obj is None or isinstance(obj, (bool, int, float, bytes)):
+            write(f"{obj!r} ".encode())
+        elif isinstance(obj, str):
+            write(f"label {self.labels[obj]} ".encode()
+                  if obj in self.labels else f"{obj!r} ".encode())
+        elif isinstance(obj, type):
+            write(f"type {obj.__module__}.{obj.__qualname__} ".encode())
+        elif isinstance(obj, (types.FunctionType, types.BuiltinFunctionType)):
+            write(f"function {obj.__module__}.{obj.__qualname__} ".encode())
+        elif isinstance(obj, ILValue) and obj in self.values:
+            write(f"seen {self.values[obj]} ".encode())
+        elif id(obj) in self.stack:
+            write(f"up {len(self.stack) - self.stack[id(obj)]} ".encode())
+        else:
+            if isinstance(obj, ILValue):
+                self.values[obj] = len(self.values)
+            self.stack[id(obj)] = len(self.stack)
+            self._add_content(obj)
+            del self.stack[id(obj)]
+
+    def _add_content(self, obj):
+        """Add the content of an object to the hash."""
+        write = self.digest.update
+        if isinstance(obj, (list, tuple)):
+            write(f"{type(obj).__name__} {len(obj)} ".encode())
+            for item in obj:
+                self.add(item)
+        elif isinstance(obj, dict):
+            write(f"dict {len(obj)} ".encode())
+            for k, v in obj.items():
+                self.add(k)
+                self.add(v)
+        elif isinstance(obj, (set, frozenset)):
+            write(f"set {len(obj)} ".encode())
+            for item in obj:
+                self.add(item)
+        elif isinstance(obj, ILValue):
+            write(b"value ")
+            self.add(obj.ctype)
+            self.add(self._facts(obj))
+        elif hasattr(obj, "__dict__") or hasattr(obj, "__slots__"):
+            self.add(type(obj))
+            attrs = dict(getattr(obj, "__dict__", {}))
+            for cls in type(obj).__mro__:
+                for name in getattr(cls, "__slots__", []):
+                    if hasattr(obj, name):
+                        attrs[name] = getattr(obj, name)
+            for name in sorted(attrs):
+                if name.startswith("_"):
+                    continue
+                write(f"{name}= ".encode())
+                self.add(attrs[name])
+        else:
+            raise TypeError(f"cannot hash {type(obj).__name__}")
+
+    def _facts(self, v):
+        """Return what the code generated for a use of value `v` may depend
+        on besides its type.
+        """
+        symbol_table = self.symbol_table
+        name = symbol_table.names.get(v)
+        summary = None
+        if v.ctype.is_function():
+            summary = self.il_code.summaries.get(name)
+        return [name, symbol_table.storage.get(v),
+                symbol_table.linkage_type.get(v),
+                symbol_table.def_state.get(v),
+                symbol_table.static_numbers.get(v),
+                v in symbol_table.thread_locals,
+                self.il_code.literals.get(v),
+                self.il_code.string_literals.get(v), summary]
+
+
+def fetch_function(cache_dir, key):
+    """Return what was stored for a function under `key`, or None."""
+    try:
+        with open(_function_path(cache_dir, key), "rb") as file:
+            entry = pickle.load(file)
+    except (OSError, pickle.UnpicklingError, EOFError):
+        _log(cache_dir, "function miss")
+        return None
+    _log(cache_dir, "function hit")
+    return entry
+
+
+def store_function(cache_dir, key, entry):
+    """Save what was made for a function in the cache under `key`."""
+    path = _function_path(cache_dir, key)
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    fd, temp = tempfile.mkstemp(dir=os.path.dirname(path))
+    with os.fdopen(fd, "wb") as file:
+        pickle.dump(entry, file, pickle.HIGHEST_PROTOCOL)
+    os.replace(temp, path)
+
+
+def fetch_paths(cache_dir):
+    """Return the paths of files to link with saved in the cache, as a dict
+    from the name of each file to its path.
+    """
+    try:
+        with open(os.path.join(cache_dir, PATHS_FILE)) as file:
+            return json.load(file)
+    except (OSError, ValueError):
+        return {}
+
+
+def store_paths(cache_dir, paths):
+    """Save the given dict of the paths of files to link with in the cache.
+
+    Paths which cannot be saved are searched for again next time, so errors
+    writing are ignored.
+    """
+    try:
+        os.makedirs(cache_dir, exist_ok=True)
+        fd, temp = tempfile.mkstemp(dir=cache_dir)
+        with os.fdopen(fd, "w") as file:
+            json.dump(paths, file)
+        os.replace(temp, os.path.join(cache_dir, PATHS_FILE))
+    except OSError:
+        pass
+
+
+def stats(cache_dir):
+    """Return the statistics of the cache.
+
+    returns - a dict of the hits and misses of objects and of functions,
+    the number of objects and of functions stored, and the bytes they take
+    """
+    counts = dict.fromkeys(["hit", "miss", "function hit", "function miss",
+                            "objects", "functions", "size"], 0)
+    try:
+        with open(os.path.join(cache_dir, STATS_FILE)) as log:
+            for line in log:
+                if line[:-1] in counts:
+                    counts[line[:-1]] += 1
+    except FileNotFoundError:
+        pass
+
+    for root, _, files in os.walk(cache_dir):
+        for file in files:
+            if file.endswith((".o", ".fn")):
+                counts["objects" if file.endswith(".o") else "functions"] += 1
+                counts["size"] += os.path.getsize(os.path.join(root, file))
+    return counts
+
+
+def _path(cache_dir, key):
+    """Return the path of the cached object of `key`."""
+    return os.path.join(cache_dir, key[:2], key[2:] + ".o")
+
+
+def _function_path(cache_dir, key):
+    """Return the path of the cached function of `key`."""
+    return os.path.join(cache_dir, key[:2], key[2:] + ".fn")
+
+
+def _log(cache_dir, event):
+    """Append a line recording a hit or miss to the log of the cache."""
+    os.makedirs(cache_dir, exist_ok=True)
+    with open(os.path.join(cache_dir, STATS_FILE), "a") as log:
+        log.write(event + "\n")
@@ -0,0 +1,284 @@
+"""Control flow graph over the IL commands of a single function."""
+
+import bisect
+
+
+class BasicBlock:
+    """A maximal run of IL commands with one entry point and one exit.
+
+    start (int) - Index of the first command of this block.
+    end (int) - Index one past the last command of this block.
+    succs (List[BasicBlock]) - Blocks to which control may pass after this
+    block finishes executing.
+    preds (List[BasicBlock]) - Blocks from which control may pass into this
+    block.
+    index (int) - Position of this block in the list returned by
+    make_blocks.
+    """
+
+    def __init__(self, start, end, index):
+        """Initialize BasicBlock."""
+        self.start = start
+        self.end = end
+        self.index = index
+        self.succs = []
+        self.preds = []
+
+    def add_succ(self, block):
+        """Add a control flow edge from this block to given block."""
+        if block not in self.succs:
+            self.succs.append(block)
+            block.preds.append(self)
+
+
+def make_blocks(commands):
+    """Partition the given list of IL commands into basic blocks.
+
+    A new block starts at the first command, at every label, and after
+    every command that may jump. Control flows from a block to the block
+    starting at each label its last command may jump to, and to the
+    following block unless its last command never falls through.
+
+    returns - list of BasicBlock objects, in the order their commands appear
+    in the command list.
+    """
+    leaders = {0}
+    labels = {}
+    for i, command in enumerate(commands):
+        if command.label_name():
+            leaders.add(i)
+            labels[command.label_name()] = i
+        if command.targets() or not command.falls_through():
+            leaders.add(i + 1)
+
+    starts = sorted(i for i in leaders if i < len(commands))
+    blocks = []
+    block_at = {}
+    for index, start in enumerate(starts):
+        end = starts[index + 1] if index + 1 < len(starts) else len(commands)
+        block = BasicBlock(start, end, index)
+        blocks.append(block)
+        block_at[start] = block
+
+    for block in blocks:
+        last = commands[block.end - 1]
+        for label in last.targets():
+            block.add_succ(block_at[labels[label]])
+        if last.falls_through() and block.end in block_at:
+            block.add_succ(block_at[block.end])
+
+    return blocks
+
+
+class Loop:
+    """A natural loop in a control flow graph.
+
+    header (BasicBlock) - The single entry block of the loop, which
+    dominates every block in the loop.
+    latches (List[BasicBlock]) - Sources of the back edges to the header.
+    body (Set[int]) - Indices of the blocks in the loop, including the
+    header.
+    parent (Loop) - Innermost loop strictly containing this one, or None.
+    depth (int) - Loop nesting depth, which is 1 for an outermost loop.
+    """
+
+    def __init__(self, header, latches, body):
+        """Initialize Loop."""
+        self.header = header
+        self.latches = latches
+        self.body = body
+        self.parent = None
+        self.depth = 1
+
+    def contains(self, block):
+        """Return whether the given block is in this loop."""
+        return block.index in self.body
+
+
+class CFG:
+    """Control flow graph of the IL commands of a single function.
+
+    commands (List[ILCommand]) - Commands the graph was built from. The
+    graph is invalid once this list is changed.
+    blocks (List[BasicBlock]) - Basic blocks, in command order. The first
+    block is the function entry.
+    rpo (List[BasicBlock]) - Blocks reachable from the entry, in reverse
+    postorder.
+    idom (List[BasicBlock]) - Maps the index of each block to its immediate
+    dominator. This is None for the entry and for unreachable blocks.
+    dom_children (List[List[BasicBlock]]) - Maps the index of each block to
+    the blocks it immediately dominates.
+    loops (List[Loop]) - Natural loops of the graph, outer loops first.
+    depths (List[int]) - Maps the index of each block to its loop nesting
+    depth.
+    """
+
+    def __init__(self, commands):
+        """Build the graph and its dominator tree and loops."""
+        self.commands = commands
+        self.blocks = make_blocks(commands)
+        self._starts = [block.start for block in self.blocks]
+        self._frontiers = None
+
+        self.rpo = self._reverse_postorder()
+        self.idom = self._dominators()
+        self.dom_children = [[] for _ in self.blocks]
+        for block in self.rpo[1:]:
+            self.dom_children[self.idom[block.index].index].append(block)
+
+        self.loops = self._find_loops()
+        self.depths = [0] * len(self.blocks)
+        for loop in self.loops:
+            for index in loop.body:
+                self.depths[index] += 1
+
+    def block_of(self, i):
+        """Return the block containing the command at index i."""
+        return self.blocks[bisect.bisect_right(self._starts, i) - 1]
+
+    def reachable(self, block):
+        """Return whether the given block is reachable from the entry."""
+        return block.index == 0 or self.idom[block.index] is not None
+
+    def dominates(self, a, b):
+        """Return whether block `a` dominates block `b`.
+
+        Every block dominates itself. Unreachable blocks are dominated by
+        every block and dominate nothing but themselves.
+        """
+        if not self.reachable(b):
+            return True
+        while b is not None:
+            if b is a:
+                return True
+            b = self.idom[b.index]
+        return False
+
+    def dominance_frontiers(self):
+        """Return the dominance frontier of each block.
+
+        The frontier of block b is the set of blocks where the dominance of
+        b ends: blocks which b does not strictly dominate but which have a
+        predecessor that b dominates.
+
+        returns - list mapping the index of each block to a list of blocks
+        """
+        if self._frontiers is None:
+            frontiers = [[] for _ in self.blocks]
+            for block in self.rpo:
+                preds = [p for p in block.preds if self.reachable(p)]
+                if len(preds) < 2:
+                    continue
+                for pred in preds:
+                    runner = pred
+                    while runner is not self.idom[block.index]:
+                        if block not in frontiers[runner.index]:
+                            frontiers[runner.index].append(block)
+                        runner = self.idom[runner.index]
+            self._frontiers = frontiers
+        return self._frontiers
+
+    def _reverse_postorder(self):
+        """Return the blocks reachable from the entry in reverse postorder."""
+        if not self.blocks:
+            return []
+
+        order = []
+        visited = [False] * len(self.blocks)
+        visited[0] = True
+        stack = [(self.blocks[0], iter(self.blocks[0].succs))]
+        while stack:
+            block, succs = stack[-1]
+            for succ in succs:
+                if not visited[succ.index]:
+                    visited[succ.index] = True
+                    stack.append((succ, iter(succ.succs)))
+                    break
+            else:
+                order.append(block)
+                stack.pop()
+
+        order.reverse()
+        return order
+
+    def _dominators(self):
+        """Compute immediate dominators.
+
+        This is the iterative algorithm of Cooper, Harvey, and Kennedy,
+        which walks up the partially built dominator tree to intersect the
+        dominators of each predecessor.
+        """
+        idom = [None] * len(self.blocks)
+        if not self.rpo:
+            return idom
+
+        order = {block.index: i for i, block in enumerate(self.rpo)}
+        entry = self.rpo[0]
+        idom[entry.index] = entry
+
+        def intersect(a, b):
+            while a is not b:
+                while order[a.index] > order[b.index]:
+                    a = idom[a.index]
+                while order[b.index] > order[a.index]:
+                    b = idom[b.index]
+            return a
+
+        changed = True
+        while changed:
+            changed = False
+            for block in self.rpo[1:]:
+                new_idom = None
+                for pred in block.preds:
+                    if idom[pred.index] is None:
+                        continue
+                    if new_idom is None:
+                        new_idom = pred
+                    else:
+                        new_idom = intersect(pred, new_idom)
+                if idom[block.index] is not new_idom:
+                    idom[block.index] = new_idom
+                    changed = True
+
+        idom[entry.index] = None
+        return idom
+
+    def _find_loops(self):
+        """Find the natural loops of this graph.
+
+        A loop is found for every back edge, an edge from a block to a block
+        that dominates it. The body of the loop is the header and every
+        block that can reach the source of the back edge without passing
+        through the header. Loops that share a header are merged into one.
+        Edges which return to an earlier block that does not dominate
+        their source, as in irreducible control flow, form no loop.
+        """
+        latches = {}
+        for block in self.rpo:
+            for succ in block.succs:
+                if self.dominates(succ, block):
+                    latches.setdefault(succ, []).append(block)
+
+        loops = []
+        for header, sources in latches.items():
+            body = {header.index}
+            worklist = [s for s in sources if s.index not in body]
+            while worklist:
+                block = worklist.pop()
+                if block.index not in body:
+                    body.add(block.index)
+                    worklist.extend(
+                        p for p in block.preds if self.reachable(p))
+            loops.append(Loop(header, sources, body))
+
+        # Sorting by size puts every loop after the loops containing it, so
+        # the parent of a loop is the last earlier loop containing it.
+        loops.sort(key=lambda loop: -len(loop.body))
+        for i, loop in enumerate(loops):
+            for outer in reversed(loops[:i]):
+                if loop.header.index in outer.body:
+                    loop.parent = outer
+                    loop.depth = outer.depth + 1
+                    break
+
+        return loops
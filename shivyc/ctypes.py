@@ -1,20 +1,65 @@
-"""This module defines all of the C types recognized by the compiler."""
+"""This module defines all of the C types recognized by the compiler.
+
+Pointer, array, and function types are interned, so that building the same
+derived type twice returns the same object, and the qualified and unsigned
+versions of each type are made once. Most compatibility checks are then
+identity comparisons. The rest are saved in a memo table, which is sound
+because a type never changes once made, except that a struct or union is
+completed; their compatibility does not depend on their members.
+"""
 
 import copy
+import math
+import struct
+import weakref
 
 import shivyc.token_kinds as token_kinds
 
+# Map from (method name, type, other type) to the result of checking
+# compatibility of the two types by that method.
+_compat_memo = {}
+
+
+class _Interned(type):
+    """Metaclass of the C types of which identical types are one object.
+
+    Each such class defines a _key static method, which takes the same
+    arguments as the constructor and returns the key identifying the type
+    they make.
+    """
+
+    def __init__(cls, name, bases, namespace):
+        """Initialize the table of the types of the class made so far."""
+        super().__init__(name, bases, namespace)
+        cls._interned = weakref.WeakValueDictionary()
+
+    def __call__(cls, *args, **kwargs):
+        """Return the type with the given arguments, made once per key."""
+        key = cls._key(*args, **kwargs)
+        ctype = cls._interned.get(key)
+        if ctype is None:
+            ctype = super().__call__(*args, **kwargs)
+            cls._interned[key] = ctype
+        return ctype
+
 
 class CType:
     """Represents a C type, like `int` or `double` or a struct or union.
 
     size (int) - The result of sizeof on this type.
+    align (int) - The result of _Alignof on this type. A scalar is aligned
+    to its size, as the System V ABI lays it out.
+    const, volatile, restrict (bool) - Whether the type has each qualifier.
+    Only a pointer type may be restrict-qualified.
     """
 
-    def __init__(self, size, const=False):
+    def __init__(self, size, const=False, volatile=False, restrict=False):
         """Initialize type."""
         self.size = size
+        self.align = size
         self.const = const
+        self.volatile = volatile
+        self.restrict = restrict
 
         # Required because casting to bool is special in C11.
         self._bool = False
@@ -23,12 +68,25 @@ class CType:
         # function for the struct.
         self._orig = self
 
+        # Map from each change of attributes to the version of this type
+        # with those changed, for the versions made so far.
+        self._variants = {}
+
     def weak_compat(self, other):
         """Check for weak compatibility with `other` ctype.
 
         Two types are "weakly compatible" if their unqualified version are
         compatible.
         """
+        if self is other:
+            return True
+        key = ("weak_compat", self, other)
+        if key not in _compat_memo:
+            _compat_memo[key] = self._weak_compat(other)
+        return _compat_memo[key]
+
+    def _weak_compat(self, other):
+        """Check for weak compatibility, for a type not identical to self."""
         raise NotImplementedError
 
     def is_complete(self):
@@ -54,6 +112,10 @@ class CType:
         """Check whether this is an integral type."""
         return False
 
+    def is_floating(self):
+        """Check whether this is a real floating type."""
+        return False
+
     def is_pointer(self):
         """Check whether this is a pointer type."""
         return False
@@ -84,7 +146,18 @@ class CType:
 
     def compatible(self, other):
         """Check whether given `other` C type is compatible with self."""
-        return self.weak_compat(other) and self.const == other.const
+        if self is other:
+            return True
+        key = ("compatible", self, other)
+        if key not in _compat_memo:
+            _compat_memo[key] = self._compatible(other)
+        return _compat_memo[key]
+
+    def _compatible(self, other):
+        """Check for compatibility, for a type not identical to self."""
+        return (self.weak_compat(other) and self.const == other.const
+                and self.volatile == other.volatile
+                and self.restrict == other.restrict)
 
     def is_scalar(self):
         """Check whether this has scalar type."""
@@ -96,15 +169,52 @@ class CType:
 
     def make_const(self):
         """Return a const version of this type."""
-        const_self = copy.copy(self)
-        const_self.const = True
-        return const_self
+        return self._variant(const=True)
+
+    def is_volatile(self):
+        """Check whether this is a volatile type."""
+        return self.volatile
+
+    def make_volatile(self):
+        """Return a volatile version of this type."""
+        return self._variant(volatile=True)
+
+    def is_restrict(self):
+        """Check whether this is a restrict-qualified pointer type."""
+        return self.restrict
+
+    def make_restrict(self):
+        """Return a restrict-qualified version of this pointer type."""
+        return self._variant(restrict=True)
 
     def make_unqual(self):
         """Return an unqualified version of this type."""
-        unqual_self = copy.copy(self)
-        unqual_self.const = False
-        return unqual_self
+        return self._variant(const=False, volatile=False, restrict=False)
+
+    def has_quals_of(self, other):
+        """Check whether this type has every qualifier the `other` has."""
+        return ((self.const or not other.const)
+                and (self.volatile or not other.volatile)
+                and (self.restrict or not other.restrict))
+
+    def _variant(self, **changes):
+        """Return a copy of this type with the given attributes changed.
+
+        The copy is made the first time it is asked for, and given back each
+        time after. Changing the attributes of the copy back gives this type.
+        """
+        if all(getattr(self, name) == value
+               for name, value in changes.items()):
+            return self
+
+        key = tuple(sorted(changes.items()))
+        if key not in self._variants:
+            new = copy.copy(self)
+            new.__dict__.update(changes)
+            new._variants = {
+                tuple((name, getattr(self, name)) for name, _ in key): self}
+            self._variants[key] = new
+        return self._variants[key]
 
 
 class IntegerCType(CType):
@@ -122,7 +232,7 @@ class IntegerCType(CType):
         self.signed = signed
         super().__init__(size)
 
-    def weak_compat(self, other):
+    def _weak_compat(self, other):
         """Check whether two types are compatible."""
 
         # TODO: _orig stuff is hacky...
@@ -148,9 +258,40 @@ class IntegerCType(CType):
 
     def make_unsigned(self):
         """Return an unsigned version of this type."""
-        unsig_self = copy.copy(self)
-        unsig_self.signed = False
-        return unsig_self
+        return self._variant(signed=False)
+
+
+class FloatCType(CType):
+    """Represents a real floating C type, `float` or `double`.
+
+    This class must be instantiated only once for each floating C type. A
+    value of the type is an IEEE 754 binary floating number of `size` bytes.
+    """
+
+    def __init__(self, size):
+        """Initialize type."""
+        self.signed = True
+        super().__init__(size)
+
+    def _weak_compat(self, other):
+        """Check whether two types are compatible."""
+        return other._orig == self._orig
+
+    def is_complete(self):
+        """Check if this is a complete type."""
+        return True
+
+    def is_object(self):
+        """Check if this is an object type."""
+        return True
+
+    def is_arith(self):
+        """Check whether this is an arithmetic type."""
+        return True
+
+    def is_floating(self):
+        """Check whether this is a real floating type."""
+        return True
 
 
 class VoidCType(CType):
@@ -164,7 +305,7 @@ class VoidCType(CType):
         """Initialize type."""
         super().__init__(1)
 
-    def weak_compat(self, other):
+    def _weak_compat(self, other):
         """Return True iff other is a compatible type to self."""
         return other.is_void()
 
@@ -180,19 +321,30 @@ class VoidCType(CType):
         return True
 
 
-class PointerCType(CType):
+class PointerCType(CType, metaclass=_Interned):
     """Represents a pointer C type.
 
     arg (CType) - Type pointed to.
 
     """
 
-    def __init__(self, arg, const=False):
+    def __init__(self, arg, const=False, volatile=False, restrict=False):
         """Initialize type."""
         self.arg = arg
-        super().__init__(8, const)
+        super().__init__(8, const, volatile, restrict)
 
-    def weak_compat(self, other):
+    @staticmethod
+    def _key(arg, const=False, volatile=False, restrict=False):
+        return arg, const, volatile, restrict
+
+    def _variant(self, **changes):
+        """Return the interned pointer type with the given qualifiers."""
+        quals = {"const": self.const, "volatile": self.volatile,
+                 "restrict": self.restrict}
+        quals.update(changes)
+        return PointerCType(self.arg, **quals)
+
+    def _weak_compat(self, other):
         """Return True iff other is a compatible type to self."""
         return other.is_pointer() and self.arg.compatible(other.arg)
 
@@ -209,7 +361,7 @@ class PointerCType(CType):
         return True
 
 
-class ArrayCType(CType):
+class ArrayCType(CType, metaclass=_Interned):
     """Represents an array C type.
 
     el (CType) - Type of each element in array.
@@ -222,8 +374,13 @@ class ArrayCType(CType):
         self.el = el
         self.n = n
         super().__init__((n or 1) * self.el.size)
+        self.align = el.align
 
-    def compatible(self, other):
+    @staticmethod
+    def _key(el, n):
+        return el, n
+
+    def _compatible(self, other):
         """Return True iff other is a compatible type to self."""
         return (other.is_array() and self.el.compatible(other.el) and
                 (self.n is None or other.n is None or self.n == other.n))
@@ -244,7 +401,7 @@ class ArrayCType(CType):
         return True
 
 
-class FunctionCType(CType):
+class FunctionCType(CType, metaclass=_Interned):
     """Represents a function C type.
 
     args (List(CType)) - List of the argument ctypes, from left to right, or
@@ -262,7 +419,11 @@ class FunctionCType(CType):
         self.no_info = no_info
         super().__init__(1)
 
-    def weak_compat(self, other):
+    @staticmethod
+    def _key(args, ret, no_info):
+        return tuple(args), ret, no_info
+
+    def _weak_compat(self, other):
         """Return True iff other is a compatible type to self."""
 
         if not other.is_function():
@@ -272,8 +433,10 @@ class FunctionCType(CType):
         elif not self.no_info and not other.no_info:
             if len(self.args) != len(other.args):
                 return False
-            elif any(not a1.compatible(a2) for a1, a2 in
-                     zip(self.args, other.args)):
+            # The qualifiers of a parameter are not part of the type of
+            # the function.
+            elif any(not a1.make_unqual().compatible(a2.make_unqual())
+                     for a1, a2 in zip(self.args, other.args)):
                 return False
 
         # TODO: There are special rules for compatibility between a function
@@ -296,15 +459,18 @@ class _UnionStructCType(CType):
     a tuple (str, ctype) where `str` is the string of the identifier used to
     access that member and ctype is the ctype of that member.
     complete - Boolean indicating whether this type is complete
+    packed - Whether the members are laid out with no padding, as by
+    __attribute__((packed)), so that the type is aligned to 1 byte
     """
 
     def __init__(self, tag, members=None):
         self.tag = tag
         self.members = members
         self.offsets = {}
+        self.packed = False
         super().__init__(1)
 
-    def weak_compat(self, other):
+    def _weak_compat(self, other):
         """Return True if other is a compatible type to self.
 
         Within a single translation unit, two structs are compatible if
@@ -334,7 +500,7 @@ class _UnionStructCType(CType):
         """
         return self.offsets.get(member, (None, None))
 
-    def set_members(self, members):
+    def set_members(self, members, packed=False):
         """Add the given members to this type.
 
         The members list is given in the format as described in the class
@@ -342,19 +508,34 @@ class _UnionStructCType(CType):
         """
         raise NotImplementedError
 
+    def _member_align(self, ctype):
+        """Return the alignment of a member of given type in this type."""
+        return 1 if self.packed else ctype.align
+
 
 class StructCType(_UnionStructCType):
-    """Represents a struct ctype."""
+    """Represents a struct ctype.
+
+    Each member is placed at the first offset past the previous member
+    which is a multiple of its alignment. The struct is aligned to its most
+    aligned member, and padded at the end to a multiple of that alignment,
+    so the members of each element of an array of it are aligned too.
+    """
 
-    def set_members(self, members):
+    def set_members(self, members, packed=False):
         self.members = members
+        self.packed = packed
 
         cur_offset = 0
+        self.align = 1
         for member, ctype in members:
+            align = self._member_align(ctype)
+            cur_offset = align_up(cur_offset, align)
             self.offsets[member] = cur_offset, ctype
             cur_offset += ctype.size
+            self.align = max(self.align, align)
 
-        self.size = cur_offset
+        self.size = align_up(cur_offset, self.align)
 
 
 class UnionCType(_UnionStructCType):
@@ -363,13 +544,54 @@ class UnionCType(_UnionStructCType):
     Similar to struct type, but different offset is used.
     """
 
-    def set_members(self, members):
+    def set_members(self, members, packed=False):
         self.members = members
-        self.size = max([ctype.size for _, ctype in members], default=0)
+        self.packed = packed
+        self.align = max([self._member_align(ctype) for _, ctype in members],
+                         default=1)
+        self.size = align_up(
+            max([ctype.size for _, ctype in members], default=0), self.align)
         for member, ctype in members:
             self.offsets[member] = 0, ctype
 
 
+def align_up(offset, align):
+    """Return the least multiple of `align` which is at least `offset`."""
+    return -(-offset // align) * align
+
+
+def in_range(val, ctype):
+    """Wrap the integer val into the range of the given scalar ctype.
+
+    This is the value converting val to ctype gives for integral types.
+    Pointers are treated as unsigned integers. For a floating type, val is
+    rounded to the nearest value of the type, and a floating val converted
+    to an integral type is first truncated toward zero.
+    """
+    if ctype.is_floating():
+        val = float(val)
+        if ctype.size == 4:
+            try:
+                val = struct.unpack("<f", struct.pack("<f", val))[0]
+            except OverflowError:
+                val = math.copysign(math.inf, val)
+        return val
+    val = int(val)
+    bits = ctype.size * 8
+    val %= 1 << bits
+    if ctype.is_integral() and ctype.signed and val >= 1 << (bits - 1):
+        val -= 1 << bits
+    return val
+
+
+def float_bits(val, size):
+    """Return the bits representing floating val in `size` bytes, as an
+    unsigned integer.
+    """
+    return int.from_bytes(struct.pack("<f" if size == 4 else "<d", val),
+                          "little")
+
+
 # These definitions are here to permit convenient creation of new integer,
 # char, etc. types. However, DO NOT test whether a ctype is one of these by
 # checking equality. That is, do not use `ctype == ctypes.integer` to check
@@ -400,10 +622,15 @@ unsig_longint = IntegerCType(8, False)
 long_max = 9223372036854775807
 long_min = -9223372036854775808
 
+float_t = FloatCType(4)
+double = FloatCType(8)
+
 
 simple_types = {token_kinds.void_kw: void,
                 token_kinds.bool_kw: bool_t,
                 token_kinds.char_kw: char,
                 token_kinds.short_kw: short,
                 token_kinds.int_kw: integer,
-                token_kinds.long_kw: longint}
+                token_kinds.long_kw: longint,
+                token_kinds.float_kw: float_t,
+                token_kinds.double_kw: double}
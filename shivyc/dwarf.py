@@ -0,0 +1,385 @@
+"""Debugging information for profilers and debuggers, made with -g.
+
+With -g, the ASM code made for each IL command is preceded by a Loc
+directive naming the source line the command was made from, and the ASM
+code of each function is given CFI directives describing its frame, so
+that the return address and the registers saved can be found at each
+instruction. Profilers like perf then attribute samples to source lines
+and unwind the stack through the functions ShivyC compiled.
+
+When the ASM code is written out as text, `as` makes the DWARF sections
+from the directives. For the integrated assembler, this module makes them:
+the line number program in .debug_line, a compile unit in .debug_info
+which points to it, the ranges of the functions in .debug_aranges, and the
+frame of each function in .eh_frame, which the unwinder reads at run time.
+"""
+
+import os
+import struct
+
+import shivyc
+import shivyc.asm_cmds as asm_cmds
+import shivyc.spots as spots
+from shivyc.encoder import R_X86_64_32, R_X86_64_64, R_X86_64_PC32
+
+# DWARF number of each general register.
+reg_nums = {"rax": 0, "rdx": 1, "rcx": 2, "rbx": 3, "rsi": 4, "rdi": 5,
+            "rbp": 6, "rsp": 7, "r8": 8, "r9": 9, "r10": 10, "r11": 11,
+            "r12": 12, "r13": 13, "r14": 14, "r15": 15}
+
+# DWARF number of the column of the return address.
+RETURN_ADDRESS = 16
+
+# Opcodes of the call frame instructions, and of those named by the Cfi
+# directives.
+DW_CFA_advance_loc = 0x40
+DW_CFA_offset = 0x80
+DW_CFA_advance_loc1 = 0x02
+DW_CFA_advance_loc2 = 0x03
+DW_CFA_advance_loc4 = 0x04
+cfa_ops = {"def_cfa": 0x0C, "def_cfa_register": 0x0D,
+           "def_cfa_offset": 0x0E, "remember_state": 0x0A,
+           "restore_state": 0x0B}
+
+# Standard and extended opcodes of the line number program.
+DW_LNS_copy = 0x01
+DW_LNS_advance_pc = 0x02
+DW_LNS_advance_line = 0x03
+DW_LNS_set_file = 0x04
+DW_LNE_end_sequence = 0x01
+DW_LNE_set_address = 0x02
+
+
+def add_cfi(lines):
+    """Return the ASM code of a function with its CFI directives.
+
+    The canonical frame address (CFA), the value of RSP before the call, is
+    followed through the commands which make and tear down the frame: the
+    pushes and pops, the moves of RSP, and the move of RSP into RBP, after
+    which the CFA is kept relative to RBP. Each epilogue, which tears down
+    the frame before a return or tail call, is bracketed by
+    .cfi_remember_state and .cfi_restore_state, so the code after it, which
+    is reached by a jump, is again described as within the frame.
+
+    lines - the ASM code of the function, whose first label is the entry
+    """
+    new_lines = []
+    started = False
+
+    # Register the CFA is kept relative to, and the distance from RSP and
+    # from RBP to the CFA.
+    base = spots.RSP
+    depth = 8
+    frame_depth = None
+
+    saved = set()
+    body_state = None
+    for line in lines:
+        change = _stack_change(line, depth, frame_depth)
+        if change is not None and change < depth and body_state is None:
+            body_state = base, depth, frame_depth
+            new_lines.append(asm_cmds.Cfi("remember_state"))
+        new_lines.append(line)
+
+        if isinstance(line, asm_cmds.Label) and not started:
+            new_lines.append(asm_cmds.Cfi("startproc"))
+            started = True
+        elif isinstance(line, (asm_cmds.Ret, asm_cmds.TailJmp)):
+            if body_state:
+                base, depth, frame_depth = body_state
+                body_state = None
+                new_lines.append(asm_cmds.Cfi("restore_state"))
+        elif (isinstance(line, asm_cmds.Mov) and line.dest == spots.RBP
+              and line.source == spots.RSP and base == spots.RSP):
+            base = spots.RBP
+            frame_depth = depth
+            new_lines.append(asm_cmds.Cfi("def_cfa_register",
+                                          reg_nums["rbp"]))
+        elif (isinstance(line, asm_cmds.Pop) and line.dest == spots.RBP
+              and base == spots.RBP):
+            base = spots.RSP
+            depth = change
+            new_lines.append(asm_cmds.Cfi("def_cfa", reg_nums["rsp"],
+                                          depth))
+        elif change is not None:
+            depth = change
+            if base == spots.RSP:
+                new_lines.append(asm_cmds.Cfi("def_cfa_offset", depth))
+            if (isinstance(line, asm_cmds.Push) and body_state is None
+                  and line.dest not in saved):
+                saved.add(line.dest)
+                new_lines.append(asm_cmds.Cfi(
+                    "offset", reg_nums[line.dest.detail], -depth))
+
+    new_lines.append(asm_cmds.Cfi("endproc"))
+    return new_lines
+
+
+def _stack_change(line, depth, frame_depth):
+    """Return the distance from RSP to the CFA after the given command, if
+    the command moves RSP, or else None.
+
+    depth - the distance before the command
+    frame_depth - the distance from RBP to the CFA, if RBP is the frame
+    pointer
+    """
+    if isinstance(line, asm_cmds.Push):
+        return depth + 8
+    elif isinstance(line, asm_cmds.Pop):
+        return depth - 8
+    elif line.__class__ in (asm_cmds.Sub, asm_cmds.Add) and (
+            line.dest == spots.RSP):
+        sign = 1 if isinstance(line, asm_cmds.Sub) else -1
+        return depth + sign * int(line.source.value)
+    elif (isinstance(line, asm_cmds.Mov) and line.dest == spots.RSP
+          and line.source == spots.RBP):
+        return frame_depth
+    elif isinstance(line, asm_cmds.Lea) and line.dest == spots.RSP:
+        return frame_depth - line.source.offset
+    return None
+
+
+def sections(source, functions):
+    """Return the DWARF sections of the given functions, for an object
+    file.
+
+    source (str) - Name of the C file compiled.
+    functions - list of the name of each function, its size in bytes, and
+    the list of its Loc and Cfi directives, each with its offset from the
+    start of the function
+    returns - list of the name, contents, and relocations of each section,
+    where each relocation is a tuple of its offset, type, symbol name, and
+    addend. A relocation refers to the start of a section by a symbol named
+    after the section.
+    """
+    return [_Builder(".debug_line").line_program(functions),
+            _Builder(".debug_abbrev").abbrevs(),
+            _Builder(".debug_info").compile_unit(source),
+            _Builder(".debug_aranges").ranges(functions),
+            _Builder(".eh_frame").frames(functions)]
+
+
+class _Builder:
+    """Contents and relocations of a DWARF section, as it is made."""
+
+    def __init__(self, name):
+        """Initialize _Builder for the section named."""
+        self.name = name
+        self.data = bytearray()
+        self.relocs = []
+
+    def section(self):
+        """Return the section as `sections` does."""
+        return self.name, self.data, self.relocs
+
+    def pack(self, fmt, *values):
+        """Add the values packed little-endian in the given format."""
+        self.data.extend(struct.pack("<" + fmt, *values))
+
+    def uleb(self, value):
+        """Add an unsigned LEB128 number."""
+        while True:
+            byte = value & 0x7F
+            value >>= 7
+            self.data.append(byte | (0x80 if value else 0))
+            if not value:
+                return
+
+    def sleb(self, value):
+        """Add a signed LEB128 number."""
+        while True:
+            byte = value & 0x7F
+            value >>= 7
+            done = (value == 0 and not byte & 0x40) or (
+                value == -1 and byte & 0x40)
+            self.data.append(byte | (0 if done else 0x80))
+            if done:
+                return
+
+    def string(self, text):
+        """Add a null-terminated string."""
+        self.data.extend(text.encode() + b"\0")
+
+    def address(self, symbol, size, kind, addend=0):
+        """Add a field of `size` bytes which the linker fills in with the
+        address of `symbol`, or its offset for a section name.
+        """
+        self.relocs.append((len(self.data), kind, symbol, addend))
+        self.data.extend(bytes(size))
+
+    def start_unit(self):
+        """Add the length field of a unit, to be filled in by end_unit.
+
+        returns - the offset of the length field
+        """
+        start = len(self.data)
+        self.pack("I", 0)
+        return start
+
+    def end_unit(self, start):
+        """Fill in the length field added by start_unit."""
+        struct.pack_into("<I", self.data, start, len(self.data) - start - 4)
+
+    def line_program(self, functions):
+        """Make the line number program, with a sequence per function."""
+        files = {}
+        for _, _, directives in functions:
+            for _, line in directives:
+                if isinstance(line, asm_cmds.Loc):
+                    files.setdefault(line.file, len(files) + 1)
+
+        unit = self.start_unit()
+        self.pack("H", 4)
+        header = self.start_unit()
+        # Instruction length, operations per instruction, default is_stmt,
+        # line base, and line range, then the number of operands of each
+        # standard opcode before the first special opcode, 13.
+        self.pack("BBBbBB", 1, 1, 1, -5, 14, 13)
+        self.data.extend(bytes([0, 1, 1, 1, 1, 0, 0, 0, 1, 0, 0, 1]))
+        self.data.append(0)
+        for file in files:
+            self.string(file)
+            self.data.extend(bytes(3))
+        self.data.append(0)
+        self.end_unit(header)
+
+        for name, size, directives in functions:
+            rows = {}
+            for offset, line in directives:
+                if isinstance(line, asm_cmds.Loc):
+                    rows[offset] = files[line.file], line.line
+
+            self.data.extend(bytes([0, 9, DW_LNE_set_address]))
+            self.address(name, 8, R_X86_64_64)
+            address, file, line = 0, 1, 1
+            for offset, (row_file, row_line) in rows.items():
+                if row_file != file:
+                    self.data.append(DW_LNS_set_file)
+                    self.uleb(row_file)
+                if row_line != line:
+                    self.data.append(DW_LNS_advance_line)
+                    self.sleb(row_line - line)
+                if offset != address:
+                    self.data.append(DW_LNS_advance_pc)
+                    self.uleb(offset - address)
+                self.data.append(DW_LNS_copy)
+                address, file, line = offset, row_file, row_line
+            self.data.append(DW_LNS_advance_pc)
+            self.uleb(size - address)
+            self.data.extend(bytes([0, 1, DW_LNE_end_sequence]))
+
+        self.end_unit(unit)
+        return self.section()
+
+    def abbrevs(self):
+        """Make the abbreviation of the compile unit."""
+        # Code 1, DW_TAG_compile_unit, with no children, and its attributes:
+        # producer and name as strings, the language as two bytes, the
+        # directory as a string, and the offset of the line program.
+        self.data.extend(bytes([1, 0x11, 0,
+                                0x25, 0x08, 0x13, 0x05, 0x03, 0x08,
+                                0x1B, 0x08, 0x10, 0x17, 0, 0, 0]))
+        return self.section()
+
+    def compile_unit(self, source):
+        """Make the compile unit of the C file `source`."""
+        unit = self.start_unit()
+        self.pack("H", 4)
+        self.address(".debug_abbrev", 4, R_X86_64_32)
+        self.pack("B", 8)
+
+        # The compile unit, written in C99.
+        self.uleb(1)
+        self.string(f"ShivyC {shivyc.__version__}")
+        self.pack("H", 0x0C)
+        self.string(source)
+        self.string(os.getcwd())
+        self.address(".debug_line", 4, R_X86_64_32)
+        self.end_unit(unit)
+        return self.section()
+
+    def ranges(self, functions):
+        """Make the table of the address range of each function."""
+        unit = self.start_unit()
+        self.pack("H", 2)
+        self.address(".debug_info", 4, R_X86_64_32)
+        # Address and segment selector sizes, then padding to a multiple of
+        # the size of a range.
+        self.pack("BB", 8, 0)
+        self.data.extend(bytes(4))
+        for name, size, _ in functions:
+            self.address(name, 8, R_X86_64_64)
+            self.pack("Q", size)
+        self.pack("QQ", 0, 0)
+        self.end_unit(unit)
+        return self.section()
+
+    def frames(self, functions):
+        """Make the call frame information of the functions.
+
+        A common information entry (CIE) gives the state at the entry of
+        every function: the CFA is 8 bytes above RSP, at which the return
+        address is saved. Each function then has a frame description entry
+        (FDE) with the changes its CFI directives make.
+        """
+        cie = self.start_unit()
+        self.pack("IB", 0, 1)
+        # Augmentation "zR", since the FDEs address their functions by
+        # 4-byte offsets relative to the field, code and data alignments,
+        # and the return address column.
+        self.string("zR")
+        self.uleb(1)
+        self.sleb(-8)
+        self.uleb(RETURN_ADDRESS)
+        self.uleb(1)
+        self.data.append(0x1B)
+        self.data.extend(bytes([cfa_ops["def_cfa"], reg_nums["rsp"], 8,
+                                DW_CFA_offset | RETURN_ADDRESS, 1]))
+        self._end_entry(cie)
+
+        for name, size, directives in functions:
+            fde = self.start_unit()
+            self.pack("I", len(self.data) - cie)
+            self.address(name, 4, R_X86_64_PC32)
+            self.pack("I", size)
+            self.uleb(0)
+
+            address = 0
+            for offset, line in directives:
+                if not isinstance(line, asm_cmds.Cfi):
+                    continue
+                op = cfa_ops.get(line.name)
+                if op is None and line.name != "offset":
+                    continue
+                self._advance(offset - address)
+                address = offset
+                if line.name == "offset":
+                    reg, cfa_offset = line.args
+                    self.data.append(DW_CFA_offset | reg)
+                    self.uleb(cfa_offset // -8)
+                else:
+                    self.data.append(op)
+                    for arg in line.args:
+                        self.uleb(arg)
+            self._end_entry(fde)
+        return self.section()
+
+    def _advance(self, delta):
+        """Add an instruction advancing the location by `delta` bytes."""
+        if not delta:
+            return
+        elif delta < 0x40:
+            self.data.append(DW_CFA_advance_loc | delta)
+        elif delta < 0x100:
+            self.pack("BB", DW_CFA_advance_loc1, delta)
+        elif delta < 0x10000:
+            self.pack("BH", DW_CFA_advance_loc2, delta)
+        else:
+            self.pack("BI", DW_CFA_advance_loc4, delta)
+
+    def _end_entry(self, start):
+        """Pad a CIE or FDE with no-ops to a multiple of 8 bytes, and fill in
+        its length.
+        """
+        self.data.extend(bytes(-len(self.data) % 8))
+        self.end_unit(start)
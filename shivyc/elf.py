@@ -0,0 +1,483 @@
+"""Writing of ASM code to an ELF64 relocatable object file.
+
+This is the integrated assembler, used in place of running `as` on the ASM
+code written out as text. Each command is encoded by encoder.py, static
+data is laid out in the same sections the text would declare, and the
+references to symbols are recorded as relocations for the linker. With -g,
+the DWARF sections made by dwarf.py from the Loc and Cfi directives of each
+function are added as well.
+
+A jump to a label is first assumed to fit in the 2-byte form, with an 8-bit
+offset. Jumps which do not fit are grown to the longer form, and the code is
+laid out again until every jump fits, as `as` does.
+
+The instructions of an asm statement may be any text `as` accepts, so they
+are encoded by assembling the text alone with `as`. Since their code is
+then copied in without relocations, they may not refer to any symbol.
+"""
+
+import os
+import struct
+import subprocess
+import tempfile
+
+import shivyc.asm_cmds as asm_cmds
+import shivyc.dwarf as dwarf
+import shivyc.encoder as encoder
+from shivyc.errors import CompilerError, error_collector
+
+# Section types.
+SHT_PROGBITS = 1
+SHT_SYMTAB = 2
+SHT_STRTAB = 3
+SHT_RELA = 4
+SHT_NOBITS = 8
+SHT_X86_64_UNWIND = 0x70000001
+
+# Section flags.
+SHF_WRITE = 0x1
+SHF_ALLOC = 0x2
+SHF_EXECINSTR = 0x4
+SHF_MERGE = 0x10
+SHF_STRINGS = 0x20
+SHF_INFO_LINK = 0x40
+SHF_TLS = 0x400
+
+# Symbol bindings and special section indices.
+STB_LOCAL = 0
+STB_GLOBAL = 1
+STT_OBJECT = 1
+STT_FUNC = 2
+STT_TLS = 6
+SHN_UNDEF = 0
+SHN_COMMON = 0xFFF2
+
+
+class _Section:
+    """One section of the object file.
+
+    data (bytearray) - Contents of the section, or its zeros if the section
+    has type SHT_NOBITS.
+    relocs (List) - Tuples of the offset in the section, relocation type,
+    symbol name, and addend of each relocation in the section.
+    """
+
+    def __init__(self, name, kind, flags, entsize=0):
+        """Initialize _Section."""
+        self.name = name
+        self.kind = kind
+        self.flags = flags
+        self.entsize = entsize
+        self.align = 1
+        self.data = bytearray()
+        self.relocs = []
+        self.link = 0
+        self.info = 0
+        self.index = None
+
+    def pad(self, align):
+        """Pad the section with zeros to a multiple of `align` bytes."""
+        self.align = max(self.align, align)
+        self.data.extend(bytes(-len(self.data) % align))
+
+
+class ObjectWriter:
+    """Object file to which the ASM code of each function is added in turn.
+
+    The text of each function is encoded as soon as it is added, so its ASM
+    commands need not be kept. The static data and symbols are added when
+    the object file is written.
+
+    function_sections (bool) - Whether to encode each function into a text
+    section of its own, named after it, rather than into .text
+    source (str) - Name of the C file compiled, if the debugging information
+    of -g is to be written
+    """
+
+    def __init__(self, function_sections=False, source=None):
+        """Initialize ObjectWriter."""
+        self.text = _Section(".text", SHT_PROGBITS,
+                             SHF_ALLOC | SHF_EXECINSTR)
+        self.function_sections = function_sections
+
+        # Text sections of each function, with function_sections.
+        self.texts = []
+
+        # Map from each symbol defined to its section and offset.
+        self.symbols = {}
+
+        # Name, size, and directives of each function, with -g.
+        self.source = source
+        self.functions = []
+
+    def add_text(self, lines):
+        """Encode the given ASM commands of a function into the object file.
+
+        The first label of the lines is that of the function. Jumps to
+        labels may only target labels within the same lines.
+        """
+        section = self.text
+        if self.function_sections:
+            name = asm_cmds.first_label(lines)
+            section = _Section(f".text.{name}", SHT_PROGBITS,
+                               SHF_ALLOC | SHF_EXECINSTR)
+            self.texts.append(section)
+        start = len(section.data)
+        directives = _lay_out_text(lines, section, self.symbols)
+        if self.source:
+            name = asm_cmds.first_label(lines)
+            entry = self.symbols[name][1]
+            self.functions.append(
+                (name, len(section.data) - entry,
+                 [(start + offset - entry, line)
+                  for offset, line in directives]))
+
+    def write(self, asm_code, out):
+        """Write the object file, with the static data of `asm_code`."""
+        text = self.text
+        symbols = self.symbols
+        data = _Section(".data", SHT_PROGBITS, SHF_ALLOC | SHF_WRITE)
+        bss = _Section(".bss", SHT_NOBITS, SHF_ALLOC | SHF_WRITE)
+        rodata = _Section(".rodata", SHT_PROGBITS, SHF_ALLOC)
+        strings = _Section(".rodata.str1.1", SHT_PROGBITS,
+                           SHF_ALLOC | SHF_MERGE | SHF_STRINGS, 1)
+        note = _Section(".note.GNU-stack", SHT_PROGBITS, 0)
+        sections = [text] + self.texts + [data, bss, rodata, strings, note]
+        if self.source:
+            for name, contents, relocs in dwarf.sections(self.source,
+                                                         self.functions):
+                # The frames of .eh_frame are loaded with the program, for
+                # the unwinder, while the rest is only read by debuggers.
+                section = _Section(name, SHT_PROGBITS, 0)
+                if name == ".eh_frame":
+                    section = _Section(name, SHT_X86_64_UNWIND, SHF_ALLOC)
+                    section.align = 8
+                section.data = contents
+                section.relocs = relocs
+                symbols[name] = (section, 0)
+                sections.append(section)
+
+        # The sections split off with -fdata-sections, and that of the IL
+        # code with -flto, are only added if they have contents.
+        named = {section.name: section for section in sections}
+        for name, lines in asm_code.sections():
+            if name not in named and lines:
+                named[name] = _data_section(name)
+                sections.append(named[name])
+            if name in named:
+                _lay_out_data(lines, named[name], symbols)
+
+        common = []
+        for name, size, local in asm_code.comm:
+            align = min(16, 1 << (size - 1).bit_length())
+            if local:
+                bss.pad(align)
+                symbols[name] = (bss, len(bss.data))
+                bss.data.extend(bytes(size))
+            else:
+                common.append((name, size, align))
+
+        symtab = _Section(".symtab", SHT_SYMTAB, 0, 24)
+        strtab = _Section(".strtab", SHT_STRTAB, 0)
+        shstrtab = _Section(".shstrtab", SHT_STRTAB, 0)
+        symtab.align = 8
+
+        rela_sections = []
+        for section in sections:
+            if section.relocs:
+                rela = _Section(".rela" + section.name, SHT_RELA,
+                                SHF_INFO_LINK, 24)
+                rela.align = 8
+                rela.target = section
+                rela_sections.append(rela)
+
+        sections += [symtab, strtab, shstrtab] + rela_sections
+        for index, section in enumerate(sections, 1):
+            section.index = index
+
+        symbol_nums = _make_symtab(asm_code, symbols, common, sections,
+                                   symtab, strtab)
+        for rela in rela_sections:
+            rela.link = symtab.index
+            rela.info = rela.target.index
+            for offset, kind, name, addend in rela.target.relocs:
+                info = symbol_nums[name] << 32 | kind
+                rela.data.extend(struct.pack("<QQq", offset, info, addend))
+
+        shstrtab.data.extend(b"\0")
+        names = {}
+        for section in sections:
+            names[section] = len(shstrtab.data)
+            shstrtab.data.extend(section.name.encode() + b"\0")
+
+        _write_file(out, sections, names, shstrtab.index)
+
+
+def _data_section(name):
+    """Return a new section for the data section of the ASM code named."""
+    if name.startswith(".data."):
+        return _Section(name, SHT_PROGBITS, SHF_ALLOC | SHF_WRITE)
+    elif name.startswith(".rodata."):
+        return _Section(name, SHT_PROGBITS, SHF_ALLOC)
+    elif name.startswith(".tdata"):
+        return _Section(name, SHT_PROGBITS, SHF_ALLOC | SHF_WRITE | SHF_TLS)
+    elif name.startswith(".tbss"):
+        return _Section(name, SHT_NOBITS, SHF_ALLOC | SHF_WRITE | SHF_TLS)
+    return _Section(name, SHT_PROGBITS, 0)
+
+
+def _lay_out_data(lines, section, symbols):
+    """Store the given static data directives into a section."""
+    for line in lines:
+        if isinstance(line, asm_cmds.Label):
+            symbols[line.label] = (section, len(section.data))
+        elif isinstance(line, asm_cmds.Align):
+            section.pad(line.align)
+        elif isinstance(line, asm_cmds.Zero):
+            section.data.extend(bytes(line.size))
+        elif isinstance(line, asm_cmds.Ascii):
+            section.data.extend(bytes(line.chars))
+        elif isinstance(line.value, str) and line.base:
+            # The offset of the label from a base label earlier in the
+            # section is its offset from here, plus the distance back.
+            _, start = symbols[line.base]
+            section.relocs.append((len(section.data), encoder.R_X86_64_PC32,
+                                   line.value, line.addend
+                                   + len(section.data) - start))
+            section.data.extend(bytes(line.size))
+        elif isinstance(line.value, str):
+            section.relocs.append((len(section.data), encoder.R_X86_64_64,
+                                   line.value, line.addend))
+            section.data.extend(bytes(line.size))
+        else:
+            section.data.extend(encoder.imm(line.value, line.size))
+
+
+def _lay_out_text(lines, section, symbols):
+    """Encode the given ASM commands at the end of the text section.
+
+    returns - the offset from the start of the commands of each Loc and Cfi
+    directive among them, along with the directive
+    """
+    base = len(section.data)
+    items = []
+    directives = []
+    for line in lines:
+        if isinstance(line, (asm_cmds.Loc, asm_cmds.Cfi)):
+            directives.append((len(items), line))
+        if isinstance(line, (asm_cmds.Comment, asm_cmds.Cfi)):
+            continue
+        if isinstance(line, asm_cmds.Align):
+            section.align = max(section.align, line.align)
+            items.append((line, None))
+        elif isinstance(line, asm_cmds.Label) or encoder.is_jump(line):
+            items.append((line, None))
+        elif isinstance(line, asm_cmds.InlineAsm):
+            items.append((line, _assemble(line.text, line.r)))
+        else:
+            items.append((line, encoder.encode(line)))
+
+    # Jumps which need the long form, since their target is too far away.
+    long_jumps = set()
+    while True:
+        offsets, labels = _offsets(items, long_jumps, base)
+        grown = False
+        for i, (line, code) in enumerate(items):
+            if encoder.is_jump(line) and i not in long_jumps:
+                end = offsets[i] + encoder.jump_size(line, True)
+                if not encoder.fits(labels[line.target] - end, 1):
+                    long_jumps.add(i)
+                    grown = True
+        if not grown:
+            break
+
+    for i, (line, code) in enumerate(items):
+        if isinstance(line, asm_cmds.Label):
+            symbols[line.label] = (section, base + offsets[i])
+            continue
+        if isinstance(line, asm_cmds.Align):
+            section.data.extend(encoder.nops(line.padding(base + offsets[i])))
+            continue
+        if encoder.is_jump(line):
+            short = i not in long_jumps
+            end = offsets[i] + encoder.jump_size(line, short)
+            code = encoder.encode_jump(line, labels[line.target] - end, short)
+        for pos, kind, name, addend in code.relocs:
+            section.relocs.append((base + offsets[i] + pos, kind, name,
+                                   addend))
+        section.data.extend(code.data)
+
+    offsets.append(len(section.data) - base)
+    return [(offsets[i], line) for i, line in directives]
+
+
+def _offsets(items, long_jumps, base):
+    """Return the offset of each item of code, and of each label.
+
+    base - offset in the section of the first item, which the padding of
+    each alignment depends on
+    """
+    offsets = []
+    labels = {}
+    offset = 0
+    for i, (line, code) in enumerate(items):
+        offsets.append(offset)
+        if isinstance(line, asm_cmds.Label):
+            labels[line.label] = offset
+        elif isinstance(line, asm_cmds.Align):
+            offset += line.padding(base + offset)
+        elif code:
+            offset += len(code.data)
+        else:
+            offset += encoder.jump_size(line, i not in long_jumps)
+    return offsets, labels
+
+
+def _make_symtab(asm_code, symbols, common, sections, symtab, strtab):
+    """Fill in the symbol table and return the index of each symbol.
+
+    Symbols which are not global are listed first, as ELF requires. Every
+    symbol used by a relocation but not defined is an undefined global.
+    A symbol in a thread-local section, or undefined and used by the
+    relocation of a thread-local object, is a thread-local symbol.
+    """
+    global_names = set(asm_code.globals) | {name for name, _, _ in common}
+    used = {name for section in sections for _, _, name, _ in section.relocs}
+    undefined = [name for name in sorted(used - set(symbols))
+                 if name not in global_names]
+    tls_used = {name for section in sections
+                for _, kind, name, _ in section.relocs
+                if kind in encoder.tls_relocs}
+
+    entries = []
+    for name, (section, value) in symbols.items():
+        if name not in global_names:
+            kind = STT_TLS if section.flags & SHF_TLS else 0
+            entries.append((name, STB_LOCAL, kind, section.index, value, 0))
+    first_global = len(entries) + 1
+
+    for name in dict.fromkeys(asm_code.globals):
+        if name in symbols:
+            section, value = symbols[name]
+            kind = STT_OBJECT if name in asm_code.sizes else STT_FUNC
+            if section.flags & SHF_TLS:
+                kind = STT_TLS
+            entries.append((name, STB_GLOBAL, kind, section.index, value,
+                            asm_code.sizes.get(name, 0)))
+        elif name not in {name for name, _, _ in common}:
+            kind = STT_TLS if name in tls_used else 0
+            entries.append((name, STB_GLOBAL, kind, SHN_UNDEF, 0, 0))
+    for name, size, align in common:
+        entries.append(
+            (name, STB_GLOBAL, STT_OBJECT, SHN_COMMON, align, size))
+    for name in undefined:
+        kind = STT_TLS if name in tls_used else 0
+        entries.append((name, STB_GLOBAL, kind, SHN_UNDEF, 0, 0))
+
+    symtab.link = strtab.index
+    symtab.info = first_global
+    symtab.data.extend(bytes(24))
+    strtab.data.extend(b"\0")
+
+    symbol_nums = {}
+    for num, (name, bind, kind, shndx, value, size) in enumerate(entries, 1):
+        symbol_nums[name] = num
+        symtab.data.extend(struct.pack("<IBBHQQ", len(strtab.data),
+                                       bind << 4 | kind, 0, shndx, value,
+                                       size))
+        strtab.data.extend(name.encode() + b"\0")
+    return symbol_nums
+
+
+def _write_file(out, sections, names, shstrndx):
+    """Write the ELF header, sections, and section headers to a file."""
+    offset = 64
+    placed = []
+    for section in sections:
+        if section.kind != SHT_NOBITS:
+            offset += -offset % section.align
+        placed.append(offset)
+        if section.kind != SHT_NOBITS:
+            offset += len(section.data)
+    shoff = offset + -offset % 8
+
+    ident = b"\x7fELF" + bytes([2, 1, 1, 0]) + bytes(8)
+    out.write(ident + struct.pack("<HHIQQQIHHHHHH", 1, 62, 1, 0, 0, shoff,
+                                  0, 64, 0, 0, 64, len(sections) + 1,
+                                  shstrndx))
+
+    position = 64
+    for section, start in zip(sections, placed):
+        if section.kind == SHT_NOBITS:
+            continue
+        out.write(bytes(start - position))
+        out.write(section.data)
+        position = start + len(section.data)
+    out.write(bytes(shoff - position))
+
+    out.write(bytes(64))
+    for section, start in zip(sections, placed):
+        out.write(struct.pack("<IIQQQQIIQQ", names[section], section.kind,
+                              section.flags, 0, start, len(section.data),
+                              section.link, section.info, section.align,
+                              section.entsize))
+
+
+def _assemble(text, r):
+    """Return the Code of the given instructions, as assembled by `as`.
+
+    text (str) - The instructions of an asm statement, in AT&T syntax.
+    r (Range) - Range of the asm statement in the source.
+
+    If `as` fails or the code needs relocations, an error is added at the
+    asm statement and no code is returned.
+    """
+    with tempfile.TemporaryDirectory(prefix="shivyc-") as temp:
+        obj_name = os.path.join(temp, "asm.o")
+        result = subprocess.run(["as", "-64", "-o", obj_name],
+                                input=text + "\n", stderr=subprocess.PIPE,
+                                universal_newlines=True)
+        if result.returncode:
+            # Each message of `as` looks like "{standard input}:1: Error:
+            # no such instruction: `foo'", and the first one is reported.
+            messages = [line.split("Error: ", 1)[1]
+                        for line in result.stderr.splitlines()
+                        if "Error: " in line]
+            err = "assembler error in 'asm'"
+            if messages:
+                err += ": " + messages[0]
+            error_collector.add(CompilerError(err, r))
+            return encoder.Code(b"")
+
+        if read_section(obj_name, ".rela.text"):
+            err = ("asm statement refers to a symbol, which needs "
+                   "-fno-integrated-as")
+            error_collector.add(CompilerError(err, r))
+            return encoder.Code(b"")
+        return encoder.Code(read_section(obj_name, ".text") or b"")
+
+
+def read_section(name, section_name):
+    """Return the contents of a section of an ELF64 object file.
+
+    name (str) - Name of the object file
+    section_name (str) - Name of the section
+    returns - the contents of the section, or None if the file has no such
+    section or is not an ELF64 file
+    """
+    with open(name, "rb") as o_file:
+        data = o_file.read()
+    if data[:5] != b"\x7fELF\x02":
+        return None
+
+    shoff, = struct.unpack_from("<Q", data, 0x28)
+    shnum, shstrndx = struct.unpack_from("<HH", data, 0x3C)
+    headers = [struct.unpack_from("<IIQQQQIIQQ", data, shoff + 64 * i)
+               for i in range(shnum)]
+    names_offset = headers[shstrndx][4]
+    for header in headers:
+        start = names_offset + header[0]
+        end = data.index(b"\0", start)
+        if data[start:end].decode() == section_name:
+            return data[header[4]:header[4] + header[5]]
+    return None
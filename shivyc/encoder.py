@@ -0,0 +1,773 @@
+"""Encoding of ASM commands into x86-64 machine code.
+
+Each command of asm_cmds is encoded with the same instruction form the GNU
+assembler picks for its text, so the integrated assembler and `as` produce
+the same code. Operands are registers, literals, and memory spots addressed
+off a register or a symbol. A memory spot addressed off a symbol gets a
+32-bit absolute address, filled in by the linker from a relocation, as
+usual for code which is not position independent. Position-independent
+code instead addresses a symbol, or its entry in the global offset table,
+by its offset from the end of the instruction, and calls a function by its
+offset or its entry in the procedure linkage table.
+
+A jump to a label is encoded once its distance is known. See elf.py for
+how jumps are sized.
+"""
+
+import shivyc.asm_cmds as asm_cmds
+from shivyc.spots import (GOTSpot, LiteralSpot, MemSpot, RegSpot, RipSpot,
+                          TLSGOTSpot, TLSSpot, XMMSpot)
+
+# Relocation types used in the code and its debugging information.
+R_X86_64_64 = 1
+R_X86_64_PC32 = 2
+R_X86_64_PLT32 = 4
+R_X86_64_GOTPCREL = 9
+R_X86_64_32 = 10
+R_X86_64_32S = 11
+R_X86_64_GOTTPOFF = 22
+R_X86_64_TPOFF32 = 23
+
+# Relocation types of addresses relative to the end of the instruction.
+pc_relative = {R_X86_64_PC32, R_X86_64_PLT32, R_X86_64_GOTPCREL,
+               R_X86_64_GOTTPOFF}
+
+# Relocation types of thread-local objects.
+tls_relocs = {R_X86_64_GOTTPOFF, R_X86_64_TPOFF32}
+
+# Number of each register in the instruction encoding.
+reg_nums = {"rax": 0, "rcx": 1, "rdx": 2, "rbx": 3, "rsp": 4, "rbp": 5,
+            "rsi": 6, "rdi": 7, "r8": 8, "r9": 9, "r10": 10, "r11": 11,
+            "r12": 12, "r13": 13, "r14": 14, "r15": 15}
+
+# Registers whose low byte can only be used with a REX prefix, because
+# without one the encoding names AH, CH, DH, or BH.
+rex_byte_regs = {"rsp", "rbp", "rsi", "rdi"}
+
+# Condition code of each conditional jump.
+condition_codes = {asm_cmds.Je: 0x4, asm_cmds.Jne: 0x5, asm_cmds.Jl: 0xC,
+                   asm_cmds.Jge: 0xD, asm_cmds.Jle: 0xE, asm_cmds.Jg: 0xF,
+                   asm_cmds.Jb: 0x2, asm_cmds.Jae: 0x3, asm_cmds.Jbe: 0x6,
+                   asm_cmds.Ja: 0x7, asm_cmds.Jp: 0xA, asm_cmds.Jnp: 0xB,
+                   asm_cmds.Js: 0x8}
+
+# The /digit opcode extension of each arithmetic command.
+alu_exts = {asm_cmds.Add: 0, asm_cmds.Or: 1, asm_cmds.And: 4,
+            asm_cmds.Sub: 5, asm_cmds.Xor: 6, asm_cmds.Cmp: 7}
+
+# The /digit opcode extension of each command on one operand.
+unary_exts = {asm_cmds.Not: 2, asm_cmds.Neg: 3, asm_cmds.Mul: 4,
+              asm_cmds.Div: 6, asm_cmds.Idiv: 7}
+
+# The /digit opcode extension of inc and dec.
+step_exts = {asm_cmds.Inc: 0, asm_cmds.Dec: 1}
+
+# The /digit opcode extension of each shift.
+shift_exts = {asm_cmds.Sal: 4, asm_cmds.Shr: 5, asm_cmds.Sar: 7,
+              asm_cmds.Rol: 0, asm_cmds.Ror: 1}
+
+# The /digit opcode extension of each prefetch.
+prefetch_exts = {asm_cmds.Prefetchnta: 0, asm_cmds.Prefetcht0: 1,
+                 asm_cmds.Prefetcht1: 2, asm_cmds.Prefetcht2: 3}
+
+# The opcode and mandatory prefix of each command counting or scanning the
+# bits of its source into a register.
+bit_ops = {asm_cmds.Popcnt: (b"\x0F\xB8", b"\xF3"),
+           asm_cmds.Tzcnt: (b"\x0F\xBC", b"\xF3"),
+           asm_cmds.Lzcnt: (b"\x0F\xBD", b"\xF3"),
+           asm_cmds.Bsf: (b"\x0F\xBC", b""),
+           asm_cmds.Bsr: (b"\x0F\xBD", b"")}
+
+# The opcode of each command on packed integers after the 0F escape byte,
+# including the 38 of the three-byte opcodes. Each has a 66 prefix.
+packed_ops = {asm_cmds.Paddb: b"\xFC", asm_cmds.Paddw: b"\xFD",
+              asm_cmds.Paddd: b"\xFE", asm_cmds.Paddq: b"\xD4",
+              asm_cmds.Psubb: b"\xF8", asm_cmds.Psubw: b"\xF9",
+              asm_cmds.Psubd: b"\xFA", asm_cmds.Psubq: b"\xFB",
+              asm_cmds.Pmullw: b"\xD5", asm_cmds.Pmulld: b"\x38\x40",
+              asm_cmds.Punpcklbw: b"\x60", asm_cmds.Punpcklwd: b"\x61",
+              asm_cmds.Punpcklqdq: b"\x6C", asm_cmds.Pshufd: b"\x70",
+              asm_cmds.Pxor: b"\xEF", asm_cmds.Movdqa: b"\x6F"}
+
+# The opcode of each command on scalar floating values after the 0F escape
+# byte. Each has an F3 prefix for a float and an F2 prefix for a double.
+scalar_ops = {asm_cmds.Adds: b"\x58", asm_cmds.Muls: b"\x59",
+              asm_cmds.Subs: b"\x5C", asm_cmds.Divs: b"\x5E"}
+
+# The mandatory prefix of a scalar floating command, for each size.
+scalar_prefixes = {4: b"\xF3", 8: b"\xF2"}
+
+# The opcode of vpbroadcast for each lane width, in the 0F 38 map.
+broadcast_ops = {1: 0x78, 2: 0x79, 4: 0x58, 8: 0x59}
+
+
+class Code:
+    """Machine code of one ASM command.
+
+    data (bytes) - The encoded instruction.
+    relocs (List) - Tuples of the offset into `data` of a field the linker
+    fills in, the relocation type, the symbol name, and the addend.
+    """
+
+    def __init__(self, data, relocs=None):
+        """Initialize Code."""
+        self.data = data
+        self.relocs = relocs or []
+
+
+def encode(cmd):
+    """Return the Code of given ASM command, other than a label or jump.
+
+    Raises NotImplementedError for a command or operand form that ShivyC
+    never emits.
+    """
+    encoder = _encoders.get(type(cmd))
+    if not encoder:
+        raise NotImplementedError(f"cannot encode '{cmd}'")
+    code = encoder(cmd)
+
+    # An operand relative to the thread pointer takes the FS segment
+    # prefix, which `as` puts before any other. A lea ignores the segment.
+    if not isinstance(cmd, asm_cmds.Lea) and any(
+            isinstance(spot, TLSSpot) for spot in vars(cmd).values()):
+        code = Code(b"\x64" + code.data,
+                    [(pos + 1, kind, symbol, addend)
+                     for pos, kind, symbol, addend in code.relocs])
+    return code
+
+
+def encode_jump(cmd, offset, short):
+    """Return the Code of a jump to a label at `offset` bytes from its end.
+
+    short (bool) - Whether to use the 2-byte form, with an 8-bit offset.
+    """
+    if isinstance(cmd, asm_cmds.Jmp):
+        if short:
+            return Code(bytes([0xEB]) + imm(offset, 1))
+        return Code(bytes([0xE9]) + imm(offset, 4))
+
+    cc = condition_codes[type(cmd)]
+    if short:
+        return Code(bytes([0x70 + cc]) + imm(offset, 1))
+    return Code(bytes([0x0F, 0x80 + cc]) + imm(offset, 4))
+
+
+def is_jump(cmd):
+    """Return whether given ASM command is a jump to a label."""
+    return isinstance(cmd, (asm_cmds.Jmp,) + tuple(condition_codes))
+
+
+def jump_size(cmd, short):
+    """Return the size in bytes of given jump to a label."""
+    if short:
+        return 2
+    return 5 if isinstance(cmd, asm_cmds.Jmp) else 6
+
+
+def nops(size):
+    """Return `size` bytes of no-op instructions, for padding in code.
+
+    The padding uses the multi-byte forms of nop, so it takes as few
+    instructions as possible to run through.
+    """
+    out = b""
+    while size > 0:
+        n = min(size, len(_nops))
+        out += _nops[n - 1]
+        size -= n
+    return out
+
+
+# The no-op instruction of each size from 1 to 9 bytes.
+_nops = [b"\x90", b"\x66\x90", b"\x0F\x1F\x00", b"\x0F\x1F\x40\x00",
+         b"\x0F\x1F\x44\x00\x00", b"\x66\x0F\x1F\x44\x00\x00",
+         b"\x0F\x1F\x80\x00\x00\x00\x00",
+         b"\x0F\x1F\x84\x00\x00\x00\x00\x00",
+         b"\x66\x0F\x1F\x84\x00\x00\x00\x00\x00"]
+
+
+def imm(val, size):
+    """Return the little-endian bytes of an immediate of `size` bytes.
+
+    Raises ValueError if `val` is not a signed or unsigned integer of that
+    size, rather than keep only its low bytes.
+    """
+    val = int(val)
+    if not -(1 << (8 * size - 1)) <= val < 1 << (8 * size):
+        raise ValueError(f"immediate {val} does not fit in {size} bytes")
+    return (val % (1 << (8 * size))).to_bytes(size, "little")
+
+
+def _signed(val, size):
+    """Return the value of the `size`-byte two's complement of `val`."""
+    val = int(val) % (1 << (8 * size))
+    return val - (1 << (8 * size)) if val >> (8 * size - 1) else val
+
+
+def fits(val, size):
+    """Return whether `val` fits in a signed immediate of `size` bytes."""
+    return -(1 << (8 * size - 1)) <= val < 1 << (8 * size - 1)
+
+
+def _operand_imm(val, size):
+    """Return the bytes of the immediate of an operation on `size` bytes.
+
+    An operation on 8 bytes takes an immediate of 4 bytes, which the
+    processor sign extends, so NotImplementedError is raised for a value
+    which does not fit in it. ShivyC moves such a value into a register
+    first.
+    """
+    val = _signed(val, size)
+    if not fits(val, min(size, 4)):
+        raise NotImplementedError(
+            f"cannot encode immediate {val} of a {size}-byte operation")
+    return imm(val, min(size, 4))
+
+
+def _num(spot):
+    """Return the number of a register or SSE register spot."""
+    if isinstance(spot, XMMSpot):
+        return int(spot.name[3:])
+    return reg_nums[spot.name]
+
+
+def _inst(opcode, reg, rm, size, tail=b"", prefix=b"", byte_spots=None):
+    """Return the Code of an instruction with a ModRM byte.
+
+    opcode (bytes) - Opcode of the instruction.
+    reg - Register spot or opcode extension number for the reg field.
+    rm - Register or memory spot for the r/m field.
+    size (int) - Operand size in bytes, or 0 if the instruction has no
+    operand size prefix.
+    tail (bytes) - Immediate following the operand bytes.
+    prefix (bytes) - Mandatory prefix, placed before any REX prefix.
+    byte_spots (List) - Operands used as bytes, which are both operands if
+    not given and the size is 1.
+    """
+    rex = 0x48 if size == 8 else 0
+    if size == 2:
+        prefix = b"\x66" + prefix
+
+    reg_num = reg if isinstance(reg, int) else _num(reg)
+    if reg_num >= 8:
+        rex |= 0x44
+
+    # The low byte of these registers needs a REX prefix, even if empty.
+    if byte_spots is None:
+        byte_spots = [reg, rm] if size == 1 else []
+    if any(isinstance(spot, RegSpot) and spot.name in rex_byte_regs
+           for spot in byte_spots):
+        rex |= 0x40
+
+    relocs = []
+    if isinstance(rm, (RegSpot, XMMSpot)):
+        if _num(rm) >= 8:
+            rex |= 0x41
+        operand = bytes([0xC0 | (reg_num & 7) << 3 | (_num(rm) & 7)])
+    else:
+        operand, rex_bits, reloc = _mem_operand(reg_num, rm)
+        rex |= rex_bits
+        if reloc:
+            relocs.append(reloc)
+
+    head = prefix + (bytes([rex | 0x40]) if rex else b"") + opcode
+    return Code(head + operand + tail, _place(relocs, head, tail))
+
+
+def _vex(opcode, reg, first, rm, prefix, size, wide=False, tail=b""):
+    """Return the Code of an AVX instruction, with a VEX prefix.
+
+    opcode (bytes) - Opcode of the instruction after the 0F escape byte,
+    starting with 38 for the three-byte opcodes.
+    reg - Register spot for the reg field.
+    first - Register spot of the first source operand, or None.
+    rm - Register or memory spot for the r/m field.
+    prefix (int) - The mandatory prefix the instruction implies, which is
+    0, 0x66, or 0xF3.
+    size (int) - 32 for an instruction on 256-bit registers, else 16.
+    wide (bool) - Whether the VEX.W bit is set.
+
+    The two-byte VEX prefix is used whenever the instruction can be encoded
+    with it, as the GNU assembler does.
+    """
+    reg_num = _num(reg)
+    relocs = []
+    if isinstance(rm, (RegSpot, XMMSpot)):
+        rex = 0x41 if _num(rm) >= 8 else 0
+        operand = bytes([0xC0 | (reg_num & 7) << 3 | (_num(rm) & 7)])
+    else:
+        operand, rex, reloc = _mem_operand(reg_num, rm)
+        if reloc:
+            relocs.append(reloc)
+
+    opcode_map = 1
+    if opcode[:1] == b"\x38":
+        opcode_map, opcode = 2, opcode[1:]
+    pp = {0: 0, 0x66: 1, 0xF3: 2}[prefix]
+    tail_bits = ((~_num(first) if first else ~0) & 15) << 3 | pp
+    if size == 32:
+        tail_bits |= 4
+
+    r_bit = 0 if reg_num >= 8 else 0x80
+    if opcode_map == 1 and not wide and not rex & 3:
+        head = bytes([0xC5, r_bit | tail_bits])
+    else:
+        x_bit = 0 if rex & 2 else 0x40
+        b_bit = 0 if rex & 1 else 0x20
+        head = bytes([0xC4, r_bit | x_bit | b_bit | opcode_map,
+                      (0x80 if wide else 0) | tail_bits])
+    head += opcode
+    return Code(head + operand + tail, _place(relocs, head, tail))
+
+
+def _place(relocs, head, tail):
+    """Return the relocations of the operand bytes of an instruction, placed
+    after the `head` bytes. An address relative to RIP is relative to the
+    end of the instruction, so past the `tail` bytes too.
+    """
+    return [(len(head) + pos, kind, symbol,
+             addend - len(tail) if kind in pc_relative else addend)
+            for pos, kind, symbol, addend in relocs]
+
+
+def _mem_operand(reg_num, spot):
+    """Return the ModRM and following bytes addressing a memory spot.
+
+    returns - the bytes, the REX bits for the registers used, and a tuple of
+    the offset of the address in the bytes, the relocation type, the symbol
+    name, and the addend, or None if no relocation is needed
+    """
+    if isinstance(spot.count, LiteralSpot):
+        disp = spot.offset + spot.chunk * int(spot.count.value)
+        index = None
+        scale = 0
+    elif spot.count:
+        disp = spot.offset
+        index = spot.count
+        scale = {1: 0, 2: 1, 4: 2, 8: 3}[spot.chunk]
+    else:
+        disp = spot.offset + spot.chunk
+        index = None
+        scale = 0
+
+    rex = 0
+    index_num = 4
+    if index:
+        index_num = _num(index)
+        if index_num >= 8:
+            rex |= 0x42
+
+    reg_bits = (reg_num & 7) << 3
+
+    # An address relative to RIP is a displacement from the end of the
+    # instruction, past the 4 bytes of the displacement itself.
+    if isinstance(spot, RipSpot):
+        kind = R_X86_64_PC32
+        if isinstance(spot, TLSGOTSpot):
+            kind = R_X86_64_GOTTPOFF
+        elif isinstance(spot, GOTSpot):
+            kind = R_X86_64_GOTPCREL
+        return bytes([reg_bits | 5]) + bytes(4), rex, (1, kind, spot.base,
+                                                       disp - 4)
+
+    # A symbol address is absolute, through a SIB byte with no base, since
+    # the ModRM form without one is relative to RIP. That of a thread-local
+    # object is its offset from the thread pointer.
+    if not isinstance(spot.base, RegSpot):
+        sib = scale << 6 | (index_num & 7) << 3 | 5
+        if spot.base is None:
+            return bytes([reg_bits | 4, sib]) + imm(disp, 4), rex, None
+        kind = R_X86_64_TPOFF32 if isinstance(spot, TLSSpot) else (
+            R_X86_64_32S)
+        data = bytes([reg_bits | 4, sib]) + bytes(4)
+        return data, rex, (2, kind, spot.base, disp)
+
+    base_num = _num(spot.base)
+    if base_num >= 8:
+        rex |= 0x41
+
+    # RBP and R13 as a base always take a displacement.
+    if disp == 0 and base_num & 7 != 5:
+        mod, disp_bytes = 0, b""
+    elif fits(disp, 1):
+        mod, disp_bytes = 1, imm(disp, 1)
+    else:
+        mod, disp_bytes = 2, imm(disp, 4)
+
+    # RSP and R12 as a base always take a SIB byte.
+    if index or base_num & 7 == 4:
+        sib = scale << 6 | (index_num & 7) << 3 | (base_num & 7)
+        data = bytes([mod << 6 | reg_bits | 4, sib]) + disp_bytes
+    else:
+        data = bytes([mod << 6 | reg_bits | (base_num & 7)]) + disp_bytes
+    return data, rex, None
+
+
+def _short_reg(opcode, spot, size, tail=b""):
+    """Return the Code of an instruction with the register in the opcode."""
+    rex = 0x48 if size == 8 else 0
+    if _num(spot) >= 8:
+        rex |= 0x41
+    if size == 1 and spot.name in rex_byte_regs:
+        rex |= 0x40
+    prefix = b"\x66" if size == 2 else b""
+    rex_bytes = bytes([rex | 0x40]) if rex else b""
+    return Code(prefix + rex_bytes + bytes([opcode + (_num(spot) & 7)]) + tail)
+
+
+def _mov(cmd):
+    """Encode a mov."""
+    dest, source, size = cmd.dest, cmd.source, cmd.size
+    if cmd.sse_name():
+        return _sse_mov(cmd)
+    byte = size == 1
+    if isinstance(source, LiteralSpot):
+        val = _signed(source.value, size)
+        if isinstance(dest, RegSpot):
+            if size == 8 and not fits(val, 4):
+                return _short_reg(0xB8, dest, 8, imm(val, 8))
+            if size != 8:
+                opcode = 0xB0 if byte else 0xB8
+                return _short_reg(opcode, dest, size, imm(val, size))
+        opcode = bytes([0xC6 if byte else 0xC7])
+        return _inst(opcode, 0, dest, size, _operand_imm(val, size))
+
+    if isinstance(source, RegSpot):
+        return _inst(bytes([0x88 if byte else 0x89]), source, dest, size)
+    return _inst(bytes([0x8A if byte else 0x8B]), dest, source, size)
+
+
+def _sse_mov(cmd):
+    """Encode a movaps, movss, movsd, movd, or movq of a floating value."""
+    dest, source, size = cmd.dest, cmd.source, cmd.size
+    if isinstance(dest, XMMSpot) and isinstance(source, XMMSpot):
+        return _inst(b"\x0F\x28", dest, source, 0)
+    if isinstance(source, RegSpot):
+        return _inst(b"\x0F\x6E", dest, source, size, prefix=b"\x66",
+                     byte_spots=[])
+    if isinstance(dest, RegSpot):
+        return _inst(b"\x0F\x7E", source, dest, size, prefix=b"\x66",
+                     byte_spots=[])
+    if isinstance(dest, XMMSpot):
+        return _inst(b"\x0F\x10", dest, source, 0,
+                     prefix=scalar_prefixes[size])
+    return _inst(b"\x0F\x11", source, dest, 0, prefix=scalar_prefixes[size])
+
+
+def _scalar(cmd):
+    """Encode an add, sub, mul, or div of scalar floating values."""
+    return _inst(b"\x0F" + scalar_ops[type(cmd)], cmd.dest, cmd.source, 0,
+                 prefix=scalar_prefixes[cmd.size])
+
+
+def _ucomis(cmd):
+    """Encode a ucomiss or ucomisd."""
+    prefix = b"\x66" if cmd.size == 8 else b""
+    return _inst(b"\x0F\x2E", cmd.dest, cmd.source, 0, prefix=prefix)
+
+
+def _xorp(cmd):
+    """Encode a xorps or xorpd."""
+    prefix = b"\x66" if cmd.size == 8 else b""
+    return _inst(b"\x0F\x57", cmd.dest, cmd.source, 0, prefix=prefix)
+
+
+def _convert(cmd):
+    """Encode a cvtsi2ss, cvtsi2sd, cvttss2si, cvttsd2si, cvtss2sd, or
+    cvtsd2ss.
+
+    The integer operand gives the operand size, so a conversion of a 64-bit
+    integer has a REX.W prefix.
+    """
+    if isinstance(cmd, asm_cmds.Cvtsi2s):
+        return _inst(b"\x0F\x2A", cmd.dest, cmd.source, cmd.source_size,
+                     prefix=scalar_prefixes[cmd.dest_size], byte_spots=[])
+    if isinstance(cmd, asm_cmds.Cvtts2si):
+        return _inst(b"\x0F\x2C", cmd.dest, cmd.source, cmd.dest_size,
+                     prefix=scalar_prefixes[cmd.source_size], byte_spots=[])
+    return _inst(b"\x0F\x5A", cmd.dest, cmd.source, 0,
+                 prefix=scalar_prefixes[cmd.source_size])
+
+
+def _alu(cmd):
+    """Encode an add, or, and, sub, xor, or cmp."""
+    dest, source, size = cmd.dest, cmd.source, cmd.size
+    ext = alu_exts[type(cmd)]
+    byte = size == 1
+    if isinstance(source, LiteralSpot):
+        val = _signed(source.value, size)
+        accumulator = isinstance(dest, RegSpot) and dest.name == "rax"
+        if byte:
+            if accumulator:
+                return _short_accumulator(ext * 8 + 4, size, imm(val, 1))
+            return _inst(b"\x80", ext, dest, size, imm(val, 1))
+        if fits(val, 1):
+            return _inst(b"\x83", ext, dest, size, imm(val, 1))
+        data = _operand_imm(val, size)
+        if accumulator:
+            return _short_accumulator(ext * 8 + 5, size, data)
+        return _inst(b"\x81", ext, dest, size, data)
+
+    if isinstance(source, RegSpot):
+        return _inst(bytes([ext * 8 + (0 if byte else 1)]), source, dest,
+                     size)
+    return _inst(bytes([ext * 8 + (2 if byte else 3)]), dest, source, size)
+
+
+def _test(cmd):
+    """Encode a test of a register or memory spot with a register or an
+    immediate.
+    """
+    if isinstance(cmd.source, LiteralSpot):
+        data = _operand_imm(cmd.source.value, cmd.size)
+        if isinstance(cmd.dest, RegSpot) and cmd.dest.name == "rax":
+            return _short_accumulator(0xA8 if cmd.size == 1 else 0xA9,
+                                      cmd.size, data)
+        opcode = b"\xF6" if cmd.size == 1 else b"\xF7"
+        return _inst(opcode, 0, cmd.dest, cmd.size, data)
+    opcode = b"\x84" if cmd.size == 1 else b"\x85"
+    return _inst(opcode, cmd.source, cmd.dest, cmd.size)
+
+
+def _short_accumulator(opcode, size, data):
+    """Return the Code of an instruction with AL, AX, EAX, or RAX implied."""
+    prefix = {1: b"", 2: b"\x66", 4: b"", 8: b"\x48"}[size]
+    return Code(prefix + bytes([opcode]) + data)
+
+
+def _unary(cmd):
+    """Encode a not, neg, mul, div, or idiv."""
+    opcode = b"\xF6" if cmd.size == 1 else b"\xF7"
+    return _inst(opcode, unary_exts[type(cmd)], cmd.dest, cmd.size)
+
+
+def _step(cmd):
+    """Encode an inc or dec."""
+    opcode = b"\xFE" if cmd.size == 1 else b"\xFF"
+    return _inst(opcode, step_exts[type(cmd)], cmd.dest, cmd.size)
+
+
+def _imul(cmd):
+    """Encode an imul of one or two operands, or with an immediate."""
+    dest, source, size = cmd.dest, cmd.source, cmd.size
+    if not source:
+        return _inst(b"\xF6" if size == 1 else b"\xF7", 5, dest, size)
+    if isinstance(source, LiteralSpot):
+        val = _signed(source.value, size)
+        if fits(val, 1):
+            return _inst(b"\x6B", dest, dest, size, imm(val, 1))
+        return _inst(b"\x69", dest, dest, size, _operand_imm(val, size))
+    return _inst(b"\x0F\xAF", dest, source, size)
+
+
+def _bits(cmd):
+    """Encode a popcnt, tzcnt, lzcnt, bsf, or bsr."""
+    opcode, prefix = bit_ops[type(cmd)]
+    return _inst(opcode, cmd.dest, cmd.source, cmd.size, prefix=prefix)
+
+
+def _bswap(cmd):
+    """Encode a bswap of a 32-bit or 64-bit register."""
+    rex = 0x48 if cmd.size == 8 else 0
+    if _num(cmd.dest) >= 8:
+        rex |= 0x41
+    rex_bytes = bytes([rex | 0x40]) if rex else b""
+    return Code(rex_bytes + bytes([0x0F, 0xC8 + (_num(cmd.dest) & 7)]))
+
+
+def _shift(cmd):
+    """Encode a sal, shr, sar, rol, or ror."""
+    # The first size of a multi-size command is that of the destination.
+    dest, source, size = cmd.dest, cmd.source, cmd.source_size
+    ext = shift_exts[type(cmd)]
+    byte = size == 1
+    if isinstance(source, LiteralSpot):
+        count = int(source.value) & 0xFF
+        if count == 1:
+            return _inst(b"\xD0" if byte else b"\xD1", ext, dest, size)
+        return _inst(b"\xC0" if byte else b"\xC1", ext, dest, size,
+                     imm(count, 1))
+    return _inst(b"\xD2" if byte else b"\xD3", ext, dest, size)
+
+
+def _extend(cmd):
+    """Encode a movsx or movzx."""
+    dest, source = cmd.dest, cmd.source
+    dest_size, source_size = cmd.source_size, cmd.dest_size
+    if isinstance(cmd, asm_cmds.Movsx):
+        opcode = {1: b"\x0F\xBE", 2: b"\x0F\xBF", 4: b"\x63"}[source_size]
+    else:
+        opcode = {1: b"\x0F\xB6", 2: b"\x0F\xB7"}[source_size]
+
+    byte_spots = [source] if source_size == 1 else []
+    return _inst(opcode, dest, source, dest_size, byte_spots=byte_spots)
+
+
+def _xchg(cmd):
+    """Encode an xchg."""
+    dest, source, size = cmd.dest, cmd.source, cmd.size
+    opcode = b"\x86" if size == 1 else b"\x87"
+    if isinstance(dest, RegSpot) and isinstance(source, RegSpot):
+        names = {dest.name, source.name}
+        if size != 1 and "rax" in names and len(names) == 2:
+            other = source if dest.name == "rax" else dest
+            return _short_reg(0x90, other, size)
+        return _inst(opcode, source, dest, size)
+
+    # The register goes in the reg field, in whichever order it is given.
+    if isinstance(dest, RegSpot):
+        dest, source = source, dest
+    return _inst(opcode, source, dest, size)
+
+
+def _locked(cmd):
+    """Encode a lock xadd or lock cmpxchg of memory with a register."""
+    opcode = 0xC0 if isinstance(cmd, asm_cmds.LockXadd) else 0xB0
+    if cmd.size != 1:
+        opcode += 1
+    return _inst(bytes([0x0F, opcode]), cmd.source, cmd.dest, cmd.size,
+                 prefix=b"\xF0")
+
+
+def _prefetch(cmd):
+    """Encode a prefetch of memory."""
+    return _inst(b"\x0F\x18", prefetch_exts[type(cmd)], cmd.dest, 0)
+
+
+def _movnti(cmd):
+    """Encode a movnti of a register to memory."""
+    return _inst(b"\x0F\xC3", cmd.source, cmd.dest, cmd.size)
+
+
+def _lea(cmd):
+    """Encode a lea."""
+    return _inst(b"\x8D", cmd.dest, cmd.source, 8)
+
+
+def _push_pop(cmd):
+    """Encode a push or pop of a register."""
+    opcode = 0x50 if isinstance(cmd, asm_cmds.Push) else 0x58
+    return _short_reg(opcode, cmd.dest, 0)
+
+
+def _indirect(cmd):
+    """Encode a call or jump to the address in a register or memory."""
+    ext = 2 if isinstance(cmd, asm_cmds.Call) else 4
+    target = cmd.source if isinstance(cmd, asm_cmds.JmpAt) else cmd.dest
+    return _inst(b"\xFF", ext, target, 0)
+
+
+def _movdqu(cmd):
+    """Encode a movdqu between a vector register and memory."""
+    if isinstance(cmd.dest, XMMSpot):
+        opcode, reg, rm = b"\x6F", cmd.dest, cmd.source
+    else:
+        opcode, reg, rm = b"\x7F", cmd.source, cmd.dest
+    if cmd.size == 32:
+        return _vex(opcode, reg, None, rm, 0xF3, 32)
+    return _inst(b"\x0F" + opcode, reg, rm, 0, prefix=b"\xF3")
+
+
+def _movntdq(cmd):
+    """Encode a movntdq of a vector register to memory."""
+    if cmd.size == 32:
+        return _vex(b"\xE7", cmd.source, None, cmd.dest, 0x66, 32)
+    return _inst(b"\x0F\xE7", cmd.source, cmd.dest, 0, prefix=b"\x66")
+
+
+def _packed(cmd):
+    """Encode a command on packed integers in vector registers."""
+    opcode = packed_ops[type(cmd)]
+    tail = b"" if cmd.imm is None else imm(cmd.imm, 1)
+    if cmd.size == 32:
+        return _vex(opcode, cmd.dest, cmd.first, cmd.source, 0x66, 32,
+                    tail=tail)
+    return _inst(b"\x0F" + opcode, cmd.dest, cmd.source, 0, tail,
+                 prefix=b"\x66")
+
+
+def _movd(cmd):
+    """Encode a movd or movq of an integer into an SSE register."""
+    if cmd.size == 8 and isinstance(cmd.source, MemSpot):
+        return _inst(b"\x0F\x7E", cmd.dest, cmd.source, 0, prefix=b"\xF3")
+    return _inst(b"\x0F\x6E", cmd.dest, cmd.source, cmd.size,
+                 prefix=b"\x66", byte_spots=[])
+
+
+def _broadcast(cmd):
+    """Encode a vpbroadcast of an SSE register to an AVX register."""
+    opcode = bytes([0x38, broadcast_ops[cmd.width]])
+    return _vex(opcode, cmd.dest, None, cmd.source, 0x66, 32)
+
+
+def _setcc(cmd):
+    """Encode a setcc of a byte register or memory spot."""
+    opcode = bytes([0x0F, 0x90 + condition_codes[cmd.cond]])
+    return _inst(opcode, 0, cmd.dest, 0, byte_spots=[cmd.dest])
+
+
+def _cmov(cmd):
+    """Encode a cmovcc."""
+    opcode = bytes([0x0F, 0x40 + condition_codes[cmd.cond]])
+    return _inst(opcode, cmd.dest, cmd.source, cmd.size)
+
+
+def _direct_call(cmd):
+    """Encode a call of a function by its label, through the procedure
+    linkage table unless the linker finds the function in the same module.
+    """
+    return Code(b"\xE8" + bytes(4), [(1, R_X86_64_PLT32, cmd.target, -4)])
+
+
+def _fixed(data):
+    """Return an encoder for a command which is always the given bytes."""
+    return lambda cmd: Code(data)
+
+
+_encoders = {
+    asm_cmds.Mov: _mov,
+    asm_cmds.AtomicMov: _mov,
+    asm_cmds.Movsx: _extend,
+    asm_cmds.Movzx: _extend,
+    asm_cmds.Movdqu: _movdqu,
+    asm_cmds.Xchg: _xchg,
+    asm_cmds.LockXadd: _locked,
+    asm_cmds.LockCmpxchg: _locked,
+    asm_cmds.Mfence: _fixed(b"\x0F\xAE\xF0"),
+    asm_cmds.Sfence: _fixed(b"\x0F\xAE\xF8"),
+    asm_cmds.Movnti: _movnti,
+    asm_cmds.Movntdq: _movntdq,
+    asm_cmds.Lea: _lea,
+    asm_cmds.Setcc: _setcc,
+    asm_cmds.Cmov: _cmov,
+    asm_cmds.Imul: _imul,
+    asm_cmds.Bswap: _bswap,
+    asm_cmds.Test: _test,
+    asm_cmds.Push: _push_pop,
+    asm_cmds.Pop: _push_pop,
+    asm_cmds.Call: _indirect,
+    asm_cmds.DirectCall: _direct_call,
+    asm_cmds.TailJmp: _indirect,
+    asm_cmds.JmpAt: _indirect,
+    asm_cmds.Ret: _fixed(b"\xC3"),
+    asm_cmds.Cdq: _fixed(b"\x99"),
+    asm_cmds.Cqo: _fixed(b"\x48\x99"),
+    asm_cmds.RepMovsb: _fixed(b"\xF3\xA4"),
+    asm_cmds.RepStosq: _fixed(b"\xF3\x48\xAB"),
+    asm_cmds.Movd: _movd,
+    asm_cmds.Vpbroadcast: _broadcast,
+    asm_cmds.Vzeroupper: _fixed(b"\xC5\xF8\x77"),
+    asm_cmds.Ucomis: _ucomis,
+    asm_cmds.Xorp: _xorp,
+    asm_cmds.Cvtsi2s: _convert,
+    asm_cmds.Cvtts2si: _convert,
+    asm_cmds.Cvts2s: _convert,
+}
+_encoders.update(dict.fromkeys(scalar_ops, _scalar))
+_encoders.update(dict.fromkeys(packed_ops, _packed))
+_encoders.update(dict.fromkeys(alu_exts, _alu))
+_encoders.update(dict.fromkeys(unary_exts, _unary))
+_encoders.update(dict.fromkeys(step_exts, _step))
+_encoders.update(dict.fromkeys(shift_exts, _shift))
+_encoders.update(dict.fromkeys(bit_ops, _bits))
+_encoders.update(dict.fromkeys(prefetch_exts, _prefetch))
@@ -3,6 +3,7 @@
 The main executable catches an exception and prints it for the user.
 
 """
+import bisect
 
 
 class ErrorCollector:
@@ -12,29 +13,70 @@ class ErrorCollector:
     access it and add errors to it. This is kind of janky, but it's much easier
     than passing an instance to every function that could potentially fail.
 
+    The issues are kept in the order they were added, and only sorted by
+    position when shown. They are read from `issues`, but only changed with
+    the methods here, which keep count of the errors among them.
+
+    issues (List[CompilerError]) - The warnings and errors, in the order
+    they were added.
+    errors (int) - The number of errors among the issues.
+    max_errors (int) - The number of errors after which compiling stops,
+    by TooManyErrors raised from add, or 0 for no limit.
     """
 
     def __init__(self):
         """Initialize the ErrorCollector with no issues to report."""
         self.issues = []
+        self.errors = 0
+        self.max_errors = 0
 
     def add(self, issue):
         """Add the given error or warning (CompilerError) to list of errors."""
         self.issues.append(issue)
-        self.issues.sort()
+        if not issue.warning:
+            self.errors += 1
+            if self.max_errors and self.errors >= self.max_errors:
+                raise TooManyErrors(self.max_errors)
+
+    def extend(self, issues):
+        """Add each of the given errors and warnings, with no limit."""
+        self.issues += issues
+        self.errors += sum(not issue.warning for issue in issues)
+
+    def truncate(self, count):
+        """Remove all but the first `count` errors and warnings added."""
+        self.errors -= sum(not issue.warning for issue in self.issues[count:])
+        del self.issues[count:]
 
     def ok(self):
         """Return True iff there are no errors."""
-        return not any(not issue.warning for issue in self.issues)
+        return not self.errors
 
     def show(self):  # pragma: no cover
-        """Display all warnings and errors."""
+        """Display all warnings and errors, in order of position."""
+        self.issues.sort()
         for issue in self.issues:
             print(issue)
 
     def clear(self):
-        """Clear all warnings and errors. Intended only for testing use."""
+        """Clear all warnings and errors."""
         self.issues = []
+        self.errors = 0
+
+
+class TooManyErrors(Exception):
+    """Raised when as many errors are found as -fmax-errors allows.
+
+    max_errors (int) - The limit which was reached.
+    """
+
+    def __init__(self, max_errors):
+        """Initialize TooManyErrors."""
+        self.max_errors = max_errors
+
+    def __str__(self):
+        """Return the note shown when compiling stops."""
+        return f"compilation terminated due to -fmax-errors={self.max_errors}"
 
 
 error_collector = ErrorCollector()
@@ -50,6 +92,8 @@ class Position:
     Specifically, full_line[col + 1] should be this position.
     """
 
+    __slots__ = ("file", "line", "col", "full_line")
+
     def __init__(self, file, line, col, full_line):
         """Initialize Position object."""
         self.file = file
@@ -62,6 +106,79 @@ class Position:
         return Position(self.file, self.line, self.col + 1, self.full_line)
 
 
+class Source:
+    """Class representing the text of a source file.
+
+    The start of each line is only found when a position first needs a line
+    number, which is usually only when an error is shown.
+
+    file (str) - Name of the file.
+    text (str) - Full text of the file.
+    """
+
+    __slots__ = ("file", "text", "_line_starts")
+
+    def __init__(self, file, text):
+        """Initialize Source object."""
+        self.file = file
+        self.text = text
+        self._line_starts = None
+
+    def line_col(self, index):
+        """Return the line and column numbers of the character at `index`."""
+        if self._line_starts is None:
+            self._line_starts = [0] + [
+                i + 1 for i, c in enumerate(self.text) if c == "\n"]
+        line = bisect.bisect_right(self._line_starts, index)
+        return line, index - self._line_starts[line - 1] + 1
+
+    def full_line(self, line):
+        """Return the text of the given line, without the line break."""
+        start = self._line_starts[line - 1]
+        end = self.text.find("\n", start)
+        return self.text[start:end if end != -1 else None].rstrip("\r")
+
+
+class SourcePosition:
+    """Class representing a position as an index into a Source.
+
+    This has the same attributes as Position, but the line, column, and text
+    of the line are computed from the index when read. It does not subclass
+    Position, so it does not carry the unused slots of one.
+    """
+
+    __slots__ = ("source", "index")
+
+    def __init__(self, source, index):
+        """Initialize SourcePosition object."""
+        self.source = source
+        self.index = index
+
+    @property
+    def file(self):  # noqa D102
+        return self.source.file
+
+    @property
+    def line(self):  # noqa D102
+        return self.source.line_col(self.index)[0]
+
+    @property
+    def col(self):  # noqa D102
+        return self.source.line_col(self.index)[1]
+
+    @property
+    def full_line(self):  # noqa D102
+        return self.source.full_line(self.line)
+
+    def __add__(self, other):
+        """Increment Position column by one."""
+        return SourcePosition(self.source, self.index + 1)
+
+    def __reduce__(self):
+        """Pickle as a plain Position, without the text of the file."""
+        return Position, (self.file, self.line, self.col, self.full_line)
+
+
 class Range:
     """Class representing a continuous range between two positions.
 
@@ -69,6 +186,8 @@ class Range:
     end (Position) - end position, inclusive
     """
 
+    __slots__ = ("start", "end")
+
     def __init__(self, start, end=None):
         """Initialize Range objects."""
         self.start = start
@@ -101,6 +220,14 @@ class CompilerError(Exception):
         self.range = range
         self.warning = warning
 
+    def __reduce__(self):
+        """Pickle the error, to pass it back from a compiling process.
+
+        Errors of a subclass, like ParserError, are unpickled as plain
+        CompilerError objects.
+        """
+        return CompilerError, (self.descrip, self.range, self.warning)
+
     def __str__(self):  # pragma: no cover
         """Return a pretty-printable statement of the error.
 
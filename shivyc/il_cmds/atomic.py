@@ -0,0 +1,279 @@
+"""IL commands for atomic accesses of memory, made by the __atomic builtins
+and, with relaxed order, by the reads and writes of volatile objects.
+
+Each command accesses the integer or pointer at address `addr` as a whole,
+so that other threads see it either before or after the access. On x86-64
+an aligned load or store is already atomic, and every load has acquire and
+every store release semantics, so those are plain moves, which the passes
+over the ASM code leave in place. Only a store with sequentially consistent
+order is followed by an mfence, so that no later load is done before it. A
+read-modify-write is a lock xadd, lock cmpxchg, or xchg, which are full
+barriers themselves.
+
+The optimizer treats every atomic command as a barrier: it may read and
+write any memory which code outside the function may reach, like a call,
+so no access of memory is moved across it, merged with another across it,
+or removed because of it.
+"""
+
+import shivyc.asm_cmds as asm_cmds
+import shivyc.spots as spots
+from shivyc.il_cmds.base import ILCommand
+from shivyc.spots import MemSpot, RegSpot
+
+# The memory orders, as the values of the __ATOMIC macros of <stdatomic.h>.
+RELAXED, CONSUME, ACQUIRE, RELEASE, ACQ_REL, SEQ_CST = range(6)
+
+
+class _AtomicCmd(ILCommand):
+    """Base class for the atomic commands.
+
+    order (int) - Memory order of the command, one of those above.
+    """
+
+    def indir_read(self):  # noqa D102
+        return [self.addr]
+
+    def indir_write(self):  # noqa D102
+        return [self.addr]
+
+    def clobbers_memory(self):  # noqa D102
+        return True
+
+    def _memory(self, spotmap, get_reg, conf, asm_code):
+        """Return the memory spot at `addr`.
+
+        The address is moved into a register which is not in `conf`, if
+        it is not in a register already.
+        """
+        spot = spotmap[self.addr]
+        if not isinstance(spot, RegSpot) or spot in conf:
+            r = get_reg([], conf + [spotmap[v] for v in self.inputs()])
+            asm_code.add(asm_cmds.Mov(r, spot, 8))
+            spot = r
+        return MemSpot(spot)
+
+
+class AtomicLoad(_AtomicCmd):
+    """Loads the value at `addr` into `output`."""
+
+    def __init__(self, output, addr, order):  # noqa D102
+        self.output = output
+        self.addr = addr
+        self.order = order
+
+    def inputs(self):  # noqa D102
+        return [self.addr]
+
+    def outputs(self):  # noqa D102
+        return [self.output]
+
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "addr")
+
+    def replace_outputs(self, mapping):  # noqa D102
+        self._replace(mapping, "output")
+
+    def indir_write(self):  # noqa D102
+        return []
+
+    def make_asm(self, spotmap, home_spots, get_reg, asm_code):  # noqa D102
+        size = self.output.ctype.size
+        out_spot = spotmap[self.output]
+        mem = self._memory(spotmap, get_reg, [], asm_code)
+
+        r = out_spot if isinstance(out_spot, RegSpot) else get_reg(
+            [], [mem.base])
+        asm_code.add(asm_cmds.AtomicMov(r, mem, size))
+        if r != out_spot:
+            asm_code.add(asm_cmds.Mov(out_spot, r, size))
+
+
+class AtomicStore(_AtomicCmd):
+    """Stores `val` to the memory at `addr`."""
+
+    def __init__(self, addr, val, order):  # noqa D102
+        self.addr = addr
+        self.val = val
+        self.order = order
+
+    def inputs(self):  # noqa D102
+        return [self.addr, self.val]
+
+    def outputs(self):  # noqa D102
+        return []
+
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "addr", "val")
+
+    def indir_read(self):  # noqa D102
+        return []
+
+    def make_asm(self, spotmap, home_spots, get_reg, asm_code):  # noqa D102
+        size = self.val.ctype.size
+        val_spot = spotmap[self.val]
+        mem = self._memory(spotmap, get_reg, [], asm_code)
+
+        if not (isinstance(val_spot, RegSpot) or self._is_imm(val_spot)):
+            r = get_reg([], [mem.base, val_spot])
+            asm_code.add(asm_cmds.Mov(r, val_spot, size))
+            val_spot = r
+        asm_code.add(asm_cmds.AtomicMov(mem, val_spot, size))
+        if self.order == SEQ_CST:
+            asm_code.add(asm_cmds.Mfence())
+
+
+class _AtomicUpdate(_AtomicCmd):
+    """Base class for the commands which update the value at `addr` with
+    `val`, and set `output` to the value it had before.
+    """
+
+    def __init__(self, output, addr, val, order):  # noqa D102
+        self.output = output
+        self.addr = addr
+        self.val = val
+        self.order = order
+
+    def inputs(self):  # noqa D102
+        return [self.addr, self.val]
+
+    def outputs(self):  # noqa D102
+        return [self.output]
+
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "addr", "val")
+
+    def replace_outputs(self, mapping):  # noqa D102
+        self._replace(mapping, "output")
+
+    def make_asm(self, spotmap, home_spots, get_reg, asm_code):  # noqa D102
+        size = self.val.ctype.size
+        out_spot = spotmap[self.output]
+        mem = self._memory(spotmap, get_reg, [], asm_code)
+
+        # The value is taken into a register, which the command swaps with
+        # the value in memory.
+        r = get_reg([out_spot], [mem.base])
+        asm_code.add(asm_cmds.Mov(r, spotmap[self.val], size))
+        self._update(mem, r, size, asm_code)
+        if r != out_spot:
+            asm_code.add(asm_cmds.Mov(out_spot, r, size))
+
+    def _update(self, mem, r, size, asm_code):
+        """Emit the update of `mem` with the value in register `r`."""
+        raise NotImplementedError
+
+
+class AtomicExchange(_AtomicUpdate):
+    """Sets the value at `addr` to `val`."""
+
+    def _update(self, mem, r, size, asm_code):
+        asm_code.add(asm_cmds.Xchg(mem, r, size))
+
+
+class AtomicFetchAdd(_AtomicUpdate):
+    """Adds `val` to the integer at `addr`."""
+
+    def _update(self, mem, r, size, asm_code):
+        asm_code.add(asm_cmds.LockXadd(mem, r, size))
+
+
+class AtomicFetchSub(_AtomicUpdate):
+    """Subtracts `val` from the integer at `addr`."""
+
+    def _update(self, mem, r, size, asm_code):
+        asm_code.add(asm_cmds.Neg(r, None, size))
+        asm_code.add(asm_cmds.LockXadd(mem, r, size))
+
+
+class AtomicCompareExchange(_AtomicCmd):
+    """Compares the value at `addr` with that at `expected`, and if they
+    are equal sets it to `desired`, or else copies it to `expected`.
+
+    The _Bool `output` is set to whether the values were equal. The memory
+    at `expected` is only accessed by the thread, so it need not be
+    accessed atomically.
+
+    failure_order (int) - Memory order of the command if they were not.
+    """
+
+    def __init__(self, output, addr, expected, desired, order,
+                 failure_order):  # noqa D102
+        self.output = output
+        self.addr = addr
+        self.expected = expected
+        self.desired = desired
+        self.order = order
+        self.failure_order = failure_order
+
+    def inputs(self):  # noqa D102
+        return [self.addr, self.expected, self.desired]
+
+    def outputs(self):  # noqa D102
+        return [self.output]
+
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "addr", "expected", "desired")
+
+    def replace_outputs(self, mapping):  # noqa D102
+        self._replace(mapping, "output")
+
+    def indir_read(self):  # noqa D102
+        return [self.addr, self.expected]
+
+    def indir_write(self):  # noqa D102
+        return [self.addr, self.expected]
+
+    def clobber(self):  # noqa D102
+        return [spots.RAX]
+
+    def make_asm(self, spotmap, home_spots, get_reg, asm_code):  # noqa D102
+        size = self.desired.ctype.size
+        conf = [spots.RAX]
+        mem = self._memory(spotmap, get_reg, conf, asm_code)
+        conf.append(mem.base)
+
+        spot = spotmap[self.expected]
+        if not isinstance(spot, RegSpot) or spot in conf:
+            r = get_reg([], conf + [spotmap[self.desired]])
+            asm_code.add(asm_cmds.Mov(r, spot, 8))
+            spot = r
+        expected = MemSpot(spot)
+        conf.append(spot)
+
+        desired = spotmap[self.desired]
+        if not isinstance(desired, RegSpot) or desired in conf:
+            r = get_reg([], conf)
+            asm_code.add(asm_cmds.Mov(r, desired, size))
+            desired = r
+
+        done = asm_code.get_label()
+        asm_code.add(asm_cmds.Mov(spots.RAX, expected, size))
+        asm_code.add(asm_cmds.LockCmpxchg(mem, desired, size))
+        asm_code.add(asm_cmds.Je(done))
+        asm_code.add(asm_cmds.Mov(expected, spots.RAX, size))
+        asm_code.add(asm_cmds.Label(done))
+        asm_code.add(asm_cmds.Setcc(asm_cmds.Je, spotmap[self.output]))
+
+
+class AtomicFence(_AtomicCmd):
+    """Orders the accesses of memory before it with those after it."""
+
+    def __init__(self, order):  # noqa D102
+        self.order = order
+
+    def inputs(self):  # noqa D102
+        return []
+
+    def outputs(self):  # noqa D102
+        return []
+
+    def indir_read(self):  # noqa D102
+        return []
+
+    def indir_write(self):  # noqa D102
+        return []
+
+    def make_asm(self, spotmap, home_spots, get_reg, asm_code):  # noqa D102
+        if self.order == SEQ_CST:
+            asm_code.add(asm_cmds.Mfence())
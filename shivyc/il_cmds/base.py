@@ -1,11 +1,18 @@
 """Base ILCommand interface definition."""
 
+import shivyc.asm_cmds as asm_cmds
 import shivyc.ctypes as ctypes
-from shivyc.spots import LiteralSpot
+from shivyc.spots import LiteralSpot, RegSpot
 
 
 class ILCommand:
-    """Base interface for all IL commands."""
+    """Base interface for all IL commands.
+
+    line (Tuple[str, int]) - File and line of the source the command was
+    made from, set by ILCode.add with -g, or None.
+    """
+
+    line = None
 
     def inputs(self):
         """Return list of ILValues used as input for this command."""
@@ -20,6 +27,36 @@ class ILCommand:
         """
         raise NotImplementedError
 
+    def replace_inputs(self, mapping):
+        """Replace the input ILValues of this command.
+
+        Each input of this command which is a key of the dictionary
+        `mapping` is replaced by the ILValue it maps to. Every command with
+        inputs must override this function, and likewise replace_outputs,
+        so that optimization passes can rename values.
+        """
+        pass
+
+    def replace_outputs(self, mapping):
+        """Replace the output ILValues of this command.
+
+        See replace_inputs.
+        """
+        pass
+
+    def _replace(self, mapping, *names):
+        """Replace the ILValues in the given attributes of this command.
+
+        Each name is the name of an attribute holding an ILValue, None, or a
+        list of ILValues.
+        """
+        for name in names:
+            value = getattr(self, name)
+            if isinstance(value, list):
+                setattr(self, name, [mapping.get(v, v) for v in value])
+            else:
+                setattr(self, name, mapping.get(value, value))
+
     def clobber(self):
         """Return list of Spots this command may clobber, other than outputs.
 
@@ -89,6 +126,65 @@ class ILCommand:
         """
         return {}
 
+    def has_side_effects(self):
+        """Return whether this command does anything but set its outputs.
+
+        A command without side effects may be removed if none of its
+        outputs are used. This is conservatively True by default.
+        """
+        return True
+
+    def evaluate(self, values):
+        """Compute the output of this command at compile time.
+
+        values - Dictionary mapping each input ILValue whose value is known
+        at compile time to that value, as a Python integer in the range of
+        the ILValue's type.
+
+        Returns the value of the only output of this command, as a Python
+        integer in the range of its type, or None if it cannot be computed
+        from the known inputs. Only commands whose sole effect is setting
+        their output may return a value.
+        """
+        return None
+
+    def simplify(self, values):
+        """Return an input equal to the output of this command, or None.
+
+        For example, the output of x + 0 is always x. The values argument
+        is as for evaluate. The returned ILValue has the same type as the
+        output.
+        """
+        return None
+
+    def _same_type(self, value):
+        """Return value if it has the type of the only output, else None."""
+        if value.ctype.weak_compat(self.outputs()[0].ctype):
+            return value
+        return None
+
+    def copy_of(self):
+        """If this command only copies an input to its output, return it.
+
+        The output must be left with exactly the bits of the returned input
+        ILValue. The register allocator does not consider the output to
+        conflict with this input, even if the input remains live, because
+        the two hold the same value until one of them is written again.
+        """
+        return None
+
+    def rematerializable(self):
+        """Return whether the output of this command is cheap to recompute.
+
+        Such a command has a single output in a general register, and
+        computes it in one instruction from inputs which hold the same value
+        wherever the output is used, like a literal or the address of a
+        value in memory. It needs no scratch register but that of its
+        output. If the output is spilled, it is recomputed before each use
+        rather than stored to the stack and reloaded.
+        """
+        return False
+
     def indir_write(self):
         """Return list of values that may be dereferenced for indirect write.
 
@@ -107,6 +203,24 @@ class ILCommand:
         """
         return []
 
+    def clobbers_memory(self):
+        """Return whether this command may read and write any memory which
+        code outside the function may reach.
+
+        That is any variable with static storage, any memory reached only
+        through pointers, and any local variable whose address escapes, but
+        not the other local variables. A function call does.
+        """
+        return False
+
+    def reads_memory(self):
+        """Return whether this command may read any memory which code
+        outside the function may reach, as for clobbers_memory.
+
+        A command which may write such memory may read it too.
+        """
+        return self.clobbers_memory()
+
     def label_name(self):
         """If this command is a label, return its name."""
         return None
@@ -115,6 +229,14 @@ class ILCommand:
         """Return list of any labels to which this command may jump."""
         return []
 
+    def falls_through(self):
+        """Return False iff control never continues to the next command.
+
+        Unconditional jumps and returns override this, so that the
+        control flow graph does not add an edge to the command after them.
+        """
+        return True
+
     def make_asm(self, spotmap, home_spots, get_reg, asm_code):
         """Generate assembly code for this command.
 
@@ -124,10 +246,11 @@ class ILCommand:
         self.references().values() to a memory spot. This is used for
         commands which need the address of an ILValue.
 
-        get_reg - Function to get a usable register. Accepts two arguments,
-        first is a list of Spot preferences, and second is a list of
-        unacceptable spots. This function returns a register which is not
-        in the list of unacceptable spots and can be clobbered. Note this
+        get_reg - Callable to get a usable register, the RegisterContext of
+        the function. Accepts two arguments, first is a list of Spot
+        preferences, and second is a list of unacceptable spots. It returns
+        a register which is not in the list of unacceptable spots and can
+        be clobbered. Note this
         could be one of the registers the input is stored in, if the input
         ILValues are not being used after this command executes.
 
@@ -148,3 +271,14 @@ class ILCommand:
         return (isinstance(spot, LiteralSpot) and
                 (int(spot.detail) > ctypes.int_max or
                  int(spot.detail) < ctypes.int_min))
+
+    def _cmp_zero(self, spot, size, asm_code):
+        """Emit code setting the flags to compare the spot with zero.
+
+        A register is compared with `test r, r`, which has a shorter
+        encoding than `cmp r, 0` and sets the flags the same way.
+        """
+        if isinstance(spot, RegSpot):
+            asm_code.add(asm_cmds.Test(spot, spot, size))
+        else:
+            asm_code.add(asm_cmds.Cmp(spot, LiteralSpot(0), size))
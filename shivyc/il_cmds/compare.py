@@ -1,8 +1,11 @@
 """IL commands for comparisons."""
 
+import operator
+
 import shivyc.asm_cmds as asm_cmds
 from shivyc.il_cmds.base import ILCommand
-from shivyc.spots import MemSpot, LiteralSpot
+import shivyc.spots as spots
+from shivyc.spots import LiteralSpot, MemSpot, RegSpot, XMMSpot
 
 
 class _GeneralCmp(ILCommand):
@@ -12,10 +15,39 @@ class _GeneralCmp(ILCommand):
     be compared for equality bit-by-bit. No type conversion or promotion is
     done here.
 
+    test (bool) - Whether this compares the bitwise and of arg1 and arg2
+    with zero rather than arg1 with arg2, which is one `test`. Only
+    EqualCmp and NotEqualCmp are made into such a comparison, by
+    shivyc.opt.branches.
+
+    Floating arguments are compared by `ucomis`, which sets the flags as an
+    unsigned comparison does, or sets ZF, PF, and CF if either argument is
+    a NaN. So, a < b is tested as b > a, which fails for a NaN as it must,
+    and a comparison for equality also tests PF.
     """
     signed_cmp_cmd = None
     unsigned_cmp_cmd = None
 
+    # For a comparison of floating arguments for equality, the jump command
+    # on the parity flag whose result is combined with that of the jump
+    # command on the other flags, and the ASM command combining them.
+    # Override this value in EqualCmp and NotEqualCmp.
+    parity_cmd = None
+
+    # The Python function computing this comparison. Override this value in
+    # subclasses.
+    op = None
+
+    test = False
+
+    # Jump command to use for each jump command when the operands of the
+    # comparison are swapped.
+    swapped_cmd = {asm_cmds.Je: asm_cmds.Je, asm_cmds.Jne: asm_cmds.Jne,
+                   asm_cmds.Jl: asm_cmds.Jg, asm_cmds.Jg: asm_cmds.Jl,
+                   asm_cmds.Jle: asm_cmds.Jge, asm_cmds.Jge: asm_cmds.Jle,
+                   asm_cmds.Jb: asm_cmds.Ja, asm_cmds.Ja: asm_cmds.Jb,
+                   asm_cmds.Jbe: asm_cmds.Jae, asm_cmds.Jae: asm_cmds.Jbe}
+
     def __init__(self, output, arg1, arg2): # noqa D102
         self.output = output
         self.arg1 = arg1
@@ -27,9 +59,24 @@ class _GeneralCmp(ILCommand):
     def outputs(self): # noqa D102
         return [self.output]
 
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "arg1", "arg2")
+
+    def replace_outputs(self, mapping):  # noqa D102
+        self._replace(mapping, "output")
+
     def rel_spot_conf(self):  # noqa D102
         return {self.output: [self.arg1, self.arg2]}
 
+    def has_side_effects(self):  # noqa D102
+        return False
+
+    def evaluate(self, values):  # noqa D102
+        if self.arg1 in values and self.arg2 in values:
+            if self.test:
+                return int(self.op(values[self.arg1] & values[self.arg2], 0))
+            return int(self.op(values[self.arg1], values[self.arg2]))
+
     def _fix_both_literal_or_mem(self, arg1_spot, arg2_spot, regs,
                                  get_reg, asm_code):
         """Fix arguments if both are literal or memory.
@@ -73,41 +120,117 @@ class _GeneralCmp(ILCommand):
             return arg1_spot, arg2_spot
 
     def _fix_literal_wrong_order(self, arg1_spot, arg2_spot):
-        """If the first operand is a literal, swap the operands."""
+        """If the first operand is a literal, swap the operands.
+
+        Returns a tuple of the new spots of arg1 and arg2 and whether they
+        were swapped.
+        """
         if self._is_imm(arg1_spot):
-            return arg2_spot, arg1_spot
+            return arg2_spot, arg1_spot, True
         else:
-            return arg1_spot, arg2_spot
+            return arg1_spot, arg2_spot, False
 
     def make_asm(self, spotmap, home_spots, get_reg, asm_code):  # noqa D102
-        regs = []
-
+        # The result is set from the flags, without a branch.
         result = get_reg([spotmap[self.output]],
                          [spotmap[self.arg1], spotmap[self.arg2]])
-        regs.append(result)
 
         out_size = self.output.ctype.size
-        eq_val_spot = LiteralSpot(1)
-        asm_code.add(asm_cmds.Mov(result, eq_val_spot, out_size))
+        cmp_command = self.compare(spotmap, [result], get_reg, asm_code)
+        asm_code.add(asm_cmds.Setcc(cmp_command, result))
+        if not self.fusable():
+            parity_jump, Combine = self.parity_cmd
+            r = get_reg([], [result])
+            asm_code.add(asm_cmds.Setcc(parity_jump, r))
+            asm_code.add(Combine(result, r, 1))
+        if out_size > 1:
+            asm_code.add(asm_cmds.Movzx(result, result, out_size, 1))
+
+        if result != spotmap[self.output]:
+            asm_code.add(asm_cmds.Mov(spotmap[self.output], result, out_size))
+
+    def compare(self, spotmap, regs, get_reg, asm_code):
+        """Emit the `cmp` of the two arguments.
+
+        regs - List of registers which must not be used as scratch
+        returns - the jump command which jumps if the comparison holds
+        """
+        if self.test:
+            self._test(spotmap, regs, get_reg, asm_code)
+            return self.cmp_command()
+        if self.arg1.ctype.is_floating():
+            return self._compare_floating(spotmap, asm_code)
 
         arg1_spot, arg2_spot = self._fix_both_literal_or_mem(
             spotmap[self.arg1], spotmap[self.arg2], regs, get_reg, asm_code)
         arg1_spot, arg2_spot = self._fix_either_literal64(
             arg1_spot, arg2_spot, regs, get_reg, asm_code)
-        arg1_spot, arg2_spot = self._fix_literal_wrong_order(
+        arg1_spot, arg2_spot, swapped = self._fix_literal_wrong_order(
             arg1_spot, arg2_spot)
 
         arg_size = self.arg1.ctype.size
-        neq_val_spot = LiteralSpot(0)
-        label = asm_code.get_label()
+        if isinstance(arg2_spot, LiteralSpot) and not int(arg2_spot.value):
+            self._cmp_zero(arg1_spot, arg_size, asm_code)
+        else:
+            asm_code.add(asm_cmds.Cmp(arg1_spot, arg2_spot, arg_size))
+        cmp_command = self.cmp_command()
+        if swapped:
+            cmp_command = self.swapped_cmd[cmp_command]
+        return cmp_command
+
+    def fusable(self):
+        """Return whether the comparison holds exactly when the jump
+        command `compare` returns is taken, so that it may be fused into a
+        CmpJump or a Select.
+
+        A comparison of floating arguments for equality is not, since it
+        also tests the parity flag.
+        """
+        return not (self.parity_cmd and self.arg1.ctype.is_floating())
 
-        asm_code.add(asm_cmds.Cmp(arg1_spot, arg2_spot, arg_size))
-        asm_code.add(self.cmp_command()(label))
-        asm_code.add(asm_cmds.Mov(result, neq_val_spot, out_size))
-        asm_code.add(asm_cmds.Label(label))
+    def _compare_floating(self, spotmap, asm_code):
+        """Emit the `ucomis` of two floating arguments.
 
-        if result != spotmap[self.output]:
-            asm_code.add(asm_cmds.Mov(spotmap[self.output], result, out_size))
+        The first operand must be an SSE register, so it is moved to XMM15
+        if it is not one.
+        """
+        first, second = self.arg1, self.arg2
+        cmp_command = self.unsigned_cmp_cmd
+        if cmp_command in (asm_cmds.Jb, asm_cmds.Jbe):
+            first, second = second, first
+            cmp_command = self.swapped_cmd[cmp_command]
+
+        size = self.arg1.ctype.size
+        first_spot = spotmap[first]
+        if not isinstance(first_spot, XMMSpot):
+            asm_code.add(asm_cmds.Mov(spots.XMM15, first_spot, size))
+            first_spot = spots.XMM15
+        asm_code.add(asm_cmds.Ucomis(first_spot, spotmap[second], size))
+        return cmp_command
+
+    def _test(self, spotmap, regs, get_reg, asm_code):
+        """Emit the `test` of the two arguments.
+
+        The operands of `test` may be swapped, but the first must be a
+        register or memory and the second a register or a 32-bit immediate.
+        """
+        size = self.arg1.ctype.size
+        arg1_spot, arg2_spot = spotmap[self.arg1], spotmap[self.arg2]
+        if (isinstance(arg1_spot, LiteralSpot)
+              or isinstance(arg2_spot, MemSpot)):
+            arg1_spot, arg2_spot = arg2_spot, arg1_spot
+
+        conf = regs + [arg1_spot, arg2_spot]
+        if isinstance(arg1_spot, LiteralSpot):
+            r = get_reg([], conf)
+            asm_code.add(asm_cmds.Mov(r, arg1_spot, size))
+            arg1_spot = r
+        if isinstance(arg2_spot, MemSpot) or self._is_imm64(arg2_spot):
+            r = get_reg([], conf + [arg1_spot])
+            asm_code.add(asm_cmds.Mov(r, arg2_spot, size))
+            arg2_spot = r
+
+        asm_code.add(asm_cmds.Test(arg1_spot, arg2_spot, size))
 
     def cmp_command(self):
         ctype = self.arg1.ctype
@@ -126,6 +249,8 @@ class NotEqualCmp(_GeneralCmp):
     """
     signed_cmp_cmd = asm_cmds.Jne
     unsigned_cmp_cmd = asm_cmds.Jne
+    parity_cmd = (asm_cmds.Jp, asm_cmds.Or)
+    op = operator.ne
 
 
 class EqualCmp(_GeneralCmp):
@@ -137,23 +262,165 @@ class EqualCmp(_GeneralCmp):
     """
     signed_cmp_cmd = asm_cmds.Je
     unsigned_cmp_cmd = asm_cmds.Je
+    parity_cmd = (asm_cmds.Jnp, asm_cmds.And)
+    op = operator.eq
 
 
 class LessCmp(_GeneralCmp):
     signed_cmp_cmd = asm_cmds.Jl
     unsigned_cmp_cmd = asm_cmds.Jb
+    op = operator.lt
 
 
 class GreaterCmp(_GeneralCmp):
     signed_cmp_cmd = asm_cmds.Jg
     unsigned_cmp_cmd = asm_cmds.Ja
+    op = operator.gt
 
 
 class LessOrEqCmp(_GeneralCmp):
     signed_cmp_cmd = asm_cmds.Jle
     unsigned_cmp_cmd = asm_cmds.Jbe
+    op = operator.le
 
 
 class GreaterOrEqCmp(_GeneralCmp):
     signed_cmp_cmd = asm_cmds.Jge
     unsigned_cmp_cmd = asm_cmds.Jae
+    op = operator.ge
+
+
+class CmpJump(ILCommand):
+    """Jumps to a label depending on a comparison.
+
+    This fuses a comparison with a conditional jump on its result, so the
+    result is never stored as a 0 or 1 value.
+
+    cmp (_GeneralCmp) - Comparison to make. Its output is not set.
+    label - Label to jump to.
+    negate (bool) - If True, jump if the comparison does not hold rather
+    than if it holds.
+    """
+
+    def __init__(self, cmp, label, negate):  # noqa D102
+        self.cmp = cmp
+        self.label = label
+        self.negate = negate
+
+    def inputs(self):  # noqa D102
+        return self.cmp.inputs()
+
+    def outputs(self):  # noqa D102
+        return []
+
+    def replace_inputs(self, mapping):  # noqa D102
+        self.cmp.replace_inputs(mapping)
+
+    def targets(self):  # noqa D102
+        return [self.label]
+
+    def make_asm(self, spotmap, home_spots, get_reg, asm_code):  # noqa D102
+        jump = self.cmp.compare(spotmap, [], get_reg, asm_code)
+        if self.negate:
+            jump = asm_cmds.inverse_jump[jump]
+        asm_code.add(jump(asm_code.label(self.label)))
+
+
+class Select(ILCommand):
+    """Sets output to arg1 if a condition holds, and to arg2 otherwise.
+
+    This is made by if-conversion, in shivyc.opt.ifconv, in place of a
+    branch choosing between two values, and is emitted as a conditional
+    move, so it never mispredicts.
+
+    output, arg1, arg2 - ILValues of the same scalar type.
+    cond - ILValue which holds if it is not zero, or a comparison
+    (_GeneralCmp) which holds if it is true, whose output is not set. A
+    comparison is fused in by shivyc.opt.branches.
+    """
+
+    def __init__(self, output, cond, arg1, arg2):  # noqa D102
+        self.output = output
+        self.cond = cond
+        self.arg1 = arg1
+        self.arg2 = arg2
+
+    def inputs(self):  # noqa D102
+        if isinstance(self.cond, _GeneralCmp):
+            return self.cond.inputs() + [self.arg1, self.arg2]
+        return [self.cond, self.arg1, self.arg2]
+
+    def outputs(self):  # noqa D102
+        return [self.output]
+
+    def replace_inputs(self, mapping):  # noqa D102
+        if isinstance(self.cond, _GeneralCmp):
+            self.cond.replace_inputs(mapping)
+        else:
+            self._replace(mapping, "cond")
+        self._replace(mapping, "arg1", "arg2")
+
+    def replace_outputs(self, mapping):  # noqa D102
+        self._replace(mapping, "output")
+
+    def has_side_effects(self):  # noqa D102
+        return False
+
+    def evaluate(self, values):  # noqa D102
+        arg = self._chosen(values)
+        return values.get(arg) if arg else None
+
+    def simplify(self, values):  # noqa D102
+        if self.arg1 is self.arg2:
+            return self.arg1
+        return self._chosen(values)
+
+    def _chosen(self, values):
+        """Return the argument chosen, if the condition is known."""
+        if isinstance(self.cond, _GeneralCmp):
+            holds = self.cond.evaluate(values)
+        else:
+            holds = values.get(self.cond)
+        if holds is None:
+            return None
+        return self.arg1 if holds else self.arg2
+
+    def make_asm(self, spotmap, home_spots, get_reg, asm_code):  # noqa D102
+        arg1_spot = spotmap[self.arg1]
+        arg2_spot = spotmap[self.arg2]
+
+        # The arguments may be in registers no longer live after this
+        # command, so the comparison must not use them as scratch.
+        regs = [arg1_spot, arg2_spot]
+        if isinstance(self.cond, _GeneralCmp):
+            holds = self.cond.compare(spotmap, regs, get_reg, asm_code)
+        else:
+            cond_spot = spotmap[self.cond]
+            if isinstance(cond_spot, LiteralSpot):
+                r = get_reg([], regs)
+                asm_code.add(asm_cmds.Mov(r, cond_spot, self.cond.ctype.size))
+                cond_spot = r
+            self._cmp_zero(cond_spot, self.cond.ctype.size, asm_code)
+            holds = asm_cmds.Jne
+
+        # Neither the moves nor cmov change the flags. The smaller types
+        # are moved as 32 bits in registers, since cmov has no byte form
+        # and a memory operand of 32 bits would read past the value.
+        size = self.output.ctype.size
+        cmov_size = max(size, 4)
+        out_spot = spotmap[self.output]
+        r = get_reg([out_spot, arg2_spot], [arg1_spot])
+        if r != arg2_spot:
+            asm_code.add(asm_cmds.Mov(r, arg2_spot, size))
+        if (isinstance(arg1_spot, LiteralSpot)
+              or (size < 4 and not isinstance(arg1_spot, RegSpot))):
+            s = get_reg([], [r])
+            if isinstance(arg1_spot, LiteralSpot):
+                asm_code.add(asm_cmds.Mov(s, arg1_spot, cmov_size))
+            else:
+                asm_code.add(asm_cmds.Movzx(s, arg1_spot, 4, size))
+            arg1_spot = s
+        asm_code.add(asm_cmds.Cmov(holds, r, arg1_spot, cmov_size))
+
+        if r != out_spot:
+            asm_code.add(asm_cmds.Mov(out_spot, r, size))
@@ -2,16 +2,25 @@
 
 import shivyc.asm_cmds as asm_cmds
 import shivyc.spots as spots
+import shivyc.abi as abi
 from shivyc.il_cmds.base import ILCommand
-from shivyc.spots import LiteralSpot
+from shivyc.spots import (GOTSpot, LiteralSpot, MemSpot, RegSpot, RipSpot,
+                          XMMSpot)
 
 
 class Label(ILCommand):
-    """Label - Analogous to an ASM label."""
+    """Label - Analogous to an ASM label.
 
-    def __init__(self, label): # noqa D102
-        """The label argument is an string label name unique to this label."""
+    label (str) - Label name unique to this label.
+    name (str) - Name of the label in the source, given for a label whose
+    address is held by static data. The label then also has the symbol
+    ASMCode.label_symbol makes from the name, which the data refers to,
+    so it must not be copied into another function or another place.
+    """
+
+    def __init__(self, label, name=None): # noqa D102
         self.label = label
+        self.name = name
 
     def inputs(self): # noqa D102
         return []
@@ -23,7 +32,10 @@ class Label(ILCommand):
         return self.label
 
     def make_asm(self, spotmap, home_spots, get_reg, asm_code): # noqa D102
-        asm_code.add(asm_cmds.Label(self.label))
+        asm_code.add(asm_cmds.Label(asm_code.label(self.label)))
+        if self.name:
+            asm_code.add(asm_cmds.Label(
+                asm_code.label_symbol(asm_code.func, self.name)))
 
 
 class Jump(ILCommand):
@@ -41,8 +53,11 @@ class Jump(ILCommand):
     def targets(self): # noqa D102
         return [self.label]
 
+    def falls_through(self): # noqa D102
+        return False
+
     def make_asm(self, spotmap, home_spots, get_reg, asm_code): # noqa D102
-        asm_code.add(asm_cmds.Jmp(self.label))
+        asm_code.add(asm_cmds.Jmp(asm_code.label(self.label)))
 
 
 class _GeneralJump(ILCommand):
@@ -62,6 +77,9 @@ class _GeneralJump(ILCommand):
     def outputs(self): # noqa D102
         return []
 
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "cond")
+
     def targets(self): # noqa D102
         return [self.label]
 
@@ -75,9 +93,8 @@ class _GeneralJump(ILCommand):
         else:
             cond_spot = spotmap[self.cond]
 
-        zero_spot = LiteralSpot("0")
-        asm_code.add(asm_cmds.Cmp(cond_spot, zero_spot, size))
-        asm_code.add(self.command(self.label))
+        self._cmp_zero(cond_spot, size, asm_code)
+        asm_code.add(self.command(asm_code.label(self.label)))
 
 
 class JumpZero(_GeneralJump):
@@ -92,12 +109,172 @@ class JumpNotZero(_GeneralJump):
     command = asm_cmds.Jne
 
 
+class JumpTable(ILCommand):
+    """Jumps to a label looked up in a table by the value of arg.
+
+    If arg is between low and low + len(labels) - 1, jumps to
+    labels[arg - low]. Otherwise, jumps to label. The table of addresses is
+    stored in read-only data.
+
+    arg - ILValue of integral type, at least 4 bytes in size.
+    low (int) - Value of arg for the first label in the table. It must fit
+    in a 32-bit immediate.
+    labels (List[str]) - Labels in the table.
+    label (str) - Label to jump to if arg is out of range of the table.
+    relative (bool) - Whether the table holds the offsets of the labels from
+    the table rather than their addresses, for position-independent code.
+    The jump then needs a second register, so R10 is clobbered as well.
+
+    The index is computed in R11, which is clobbered, so that no value live
+    across the command is in it. The register is read by the last jump, so
+    it could not be one borrowed from such a value, which would have to be
+    restored before the first.
+    """
+
+    def __init__(self, arg, low, labels, label):  # noqa D102
+        self.arg = arg
+        self.low = low
+        self.labels = labels
+        self.label = label
+        self.relative = False
+
+    def inputs(self):  # noqa D102
+        return [self.arg]
+
+    def outputs(self):  # noqa D102
+        return []
+
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "arg")
+
+    def targets(self):  # noqa D102
+        return list(dict.fromkeys(self.labels + [self.label]))
+
+    def clobber(self):  # noqa D102
+        return [spots.R10, spots.R11] if self.relative else [spots.R11]
+
+    def falls_through(self):  # noqa D102
+        return False
+
+    def target(self, val):
+        """Return the label jumped to when arg has the given value."""
+        if 0 <= val - self.low < len(self.labels):
+            return self.labels[val - self.low]
+        return self.label
+
+    def make_asm(self, spotmap, home_spots, get_reg, asm_code):  # noqa D102
+        size = self.arg.ctype.size
+        arg_spot = spotmap[self.arg]
+
+        # An operation on the 32-bit register clears its upper half, so the
+        # full register can be the index.
+        r = spots.R11
+        if r != arg_spot or size == 4:
+            asm_code.add(asm_cmds.Mov(r, arg_spot, size))
+        if self.low:
+            asm_code.add(asm_cmds.Sub(r, LiteralSpot(self.low), size))
+
+        # Values below low wrap around to above the table, so one unsigned
+        # comparison checks both ends of the range.
+        last = LiteralSpot(len(self.labels) - 1)
+        asm_code.add(asm_cmds.Cmp(r, last, size))
+        asm_code.add(asm_cmds.Ja(asm_code.label(self.label)))
+
+        table = asm_code.get_label()
+        labels = [asm_code.label(label) for label in self.labels]
+        asm_code.add_jump_table(table, labels, self.relative)
+        if not self.relative:
+            asm_code.add(asm_cmds.JmpAt(MemSpot(table, 0, 8, r)))
+            return
+
+        base = spots.R10
+        asm_code.add(asm_cmds.Lea(base, RipSpot(table)))
+        asm_code.add(asm_cmds.Movsx(r, MemSpot(base, 0, 4, r), 8, 4))
+        asm_code.add(asm_cmds.Add(r, base, 8))
+        asm_code.add(asm_cmds.JmpAt(r))
+
+
+class LabelAddr(ILCommand):
+    """Sets output to the address of a label of the function.
+
+    output - ILValue of pointer type.
+    label (str) - Label whose address is taken. It is kept even where no
+    jump targets it, since a computed goto may reach it.
+    """
+
+    def __init__(self, output, label):  # noqa D102
+        self.output = output
+        self.label = label
+
+    def inputs(self):  # noqa D102
+        return []
+
+    def outputs(self):  # noqa D102
+        return [self.output]
+
+    def replace_outputs(self, mapping):  # noqa D102
+        self._replace(mapping, "output")
+
+    def has_side_effects(self):  # noqa D102
+        return False
+
+    def rematerializable(self):  # noqa D102
+        return True
+
+    def make_asm(self, spotmap, home_spots, get_reg, asm_code):  # noqa D102
+        output_spot = spotmap[self.output]
+        r = get_reg([output_spot])
+        asm_code.add(asm_cmds.Lea(r, RipSpot(asm_code.label(self.label))))
+        if r != output_spot:
+            asm_code.add(asm_cmds.Mov(output_spot, r, 8))
+
+
+class IndirectJump(ILCommand):
+    """Jumps to the address in addr, for a computed goto.
+
+    addr - ILValue of pointer type, which holds the address of one of the
+    labels given, as set by LabelAddr.
+    labels (List[str]) - Labels which may be jumped to, which are all the
+    labels whose address is taken in the function.
+    """
+
+    def __init__(self, addr, labels):  # noqa D102
+        self.addr = addr
+        self.labels = labels
+
+    def inputs(self):  # noqa D102
+        return [self.addr]
+
+    def outputs(self):  # noqa D102
+        return []
+
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "addr")
+
+    def targets(self):  # noqa D102
+        return list(dict.fromkeys(self.labels))
+
+    def falls_through(self):  # noqa D102
+        return False
+
+    def make_asm(self, spotmap, home_spots, get_reg, asm_code):  # noqa D102
+        asm_code.add(asm_cmds.JmpAt(spotmap[self.addr]))
+
+
 class Return(ILCommand):
     """RETURN - returns the given value from function.
 
     If arg is None, then returns from the function without putting any value
-    in the return register. Today, only supports values that fit in one
-    register.
+    in the return register. A floating value is returned in XMM0, and a
+    struct or union of at most 16 bytes in RAX and RDX, or XMM0 and XMM1 for
+    the eightbytes holding only floating values. For a larger one, the
+    function must instead
+    store it at the address passed in by the caller, and return that address
+    here, as described in shivyc.abi.
+
+    This command emits only the final `ret`; ASMGen inserts the function
+    epilogue before every `ret` once it knows which callee-saved registers
+    the function uses.
     """
 
     def __init__(self, arg=None): # noqa D102
@@ -110,19 +287,29 @@ class Return(ILCommand):
     def outputs(self): # noqa D102
         return []
 
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "arg")
+
     def clobber(self):  # noqa D102
-        return [spots.RAX]
+        return abi.ret_regs + abi.sse_ret_regs
 
     def abs_spot_pref(self):  # noqa D102
+        if self.arg and self.arg.ctype.is_floating():
+            return {self.arg: [spots.XMM0]}
         return {self.arg: [spots.RAX]}
 
+    def falls_through(self): # noqa D102
+        return False
+
     def make_asm(self, spotmap, home_spots, get_reg, asm_code): # noqa D102
-        if self.arg and spotmap[self.arg] != spots.RAX:
-            size = self.arg.ctype.size
-            asm_code.add(asm_cmds.Mov(spots.RAX, spotmap[self.arg], size))
+        if self.arg:
+            spot = spotmap[self.arg]
+            parts = abi.parts(self.arg.ctype)
+            regs = abi.ret_locations(self.arg.ctype)
+            for reg, (shift, size) in zip(regs, parts):
+                abi.load_part(reg, spot.shift(shift), size,
+                              lambda: get_reg([], abi.ret_regs), asm_code)
 
-        asm_code.add(asm_cmds.Mov(spots.RSP, spots.RBP, 8))
-        asm_code.add(asm_cmds.Pop(spots.RBP, None, 8))
         asm_code.add(asm_cmds.Ret())
 
 
@@ -134,68 +321,278 @@ class Call(ILCommand):
     parameter types the function expects.
     ret - If function has non-void return type, IL value to save the return
     value. Its type must match the function return value.
-    """
 
-    arg_regs = [spots.RDI, spots.RSI, spots.RDX, spots.RCX, spots.R8, spots.R9]
+    The arguments and return value are passed as described in shivyc.abi.
+    Arguments passed on the stack are stored at the bottom of the frame of
+    the calling function, which ASMGen makes room for. A function with no
+    prototype is called with the number of SSE registers used in AL, in
+    case it takes a variable number of arguments.
+
+    summary - What the called function may do, as a Summary from
+    shivyc.opt.ipa, or None if it is not known.
+
+    direct - The function value called by its label in place of `func`,
+    which is then unused, or None. See shivyc.opt.pic.
+    """
 
     def __init__(self, func, args, ret): # noqa D102
         self.func = func
         self.args = args
         self.ret = ret
         self.void_return = self.func.ctype.arg.ret.is_void()
-
-        if len(self.args) > len(self.arg_regs):
-            raise NotImplementedError("too many arguments")
+        self.summary = None
+        self.direct = None
 
     def inputs(self): # noqa D102
-        return [self.func] + self.args
+        return [self.direct or self.func] + self.args
 
     def outputs(self): # noqa D102
         return [] if self.void_return else [self.ret]
 
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "func", "args", "direct")
+
+    def replace_outputs(self, mapping):  # noqa D102
+        self._replace(mapping, "ret")
+
     def clobber(self): # noqa D102
-        # All caller-saved registers are clobbered by function call
-        return [spots.RAX, spots.RCX, spots.RDX, spots.RSI, spots.RDI,
-                spots.R8, spots.R9, spots.R10, spots.R11]
+        # All caller-saved registers of both classes are clobbered by
+        # function call, but the callee-saved registers survive it. With a
+        # summary, only those the callee may change are, besides the
+        # argument registers.
+        if self.summary and self.summary.regs is not None:
+            regs = self._arg_regs()
+            return [r for r in spots.call_clobbered
+                    if r in self.summary.regs or r in regs]
+        return spots.call_clobbered
 
     def abs_spot_pref(self): # noqa D102
-        prefs = {} if self.void_return else {self.ret: [spots.RAX]}
-        for arg, reg in zip(self.args, self.arg_regs):
-            prefs[arg] = [reg]
+        prefs = {}
+        if self.outputs() and not self._ret_in_memory():
+            prefs[self.ret] = abi.ret_locations(self.ret.ctype)[:1]
+        locations, _ = self.locations()
+        for arg, location in zip(self.args, locations):
+            if len(location.regs) == 1:
+                prefs[arg] = location.regs
 
         return prefs
 
     def abs_spot_conf(self): # noqa D102
         # We don't want the function pointer to be in the same register as
         # an argument will be placed into.
-        return {self.func: self.arg_regs[0:len(self.args)]}
+        return {} if self.direct else {self.func: self._arg_regs()}
+
+    def has_side_effects(self): # noqa D102
+        return not (self.pure() and self.summary.finite)
 
     def indir_write(self): # noqa D102
-        return self.args
+        return [] if self.pure() else self.args
 
     def indir_read(self): # noqa D102
-        return self.args
+        return [] if self._const() else self.args
+
+    def clobbers_memory(self): # noqa D102
+        return not self.pure()
+
+    def reads_memory(self): # noqa D102
+        return not self._const()
+
+    def pure(self):
+        """Return whether the call does nothing but compute its output,
+        from its arguments and the memory it reads.
+        """
+        return bool(self.summary and not self.summary.writes)
+
+    def _const(self):
+        """Return whether the call reads no memory."""
+        return self.pure() and not self.summary.reads
+
+    def locations(self):
+        """Return where each argument is passed, as from abi.arg_locations.
+        """
+        return abi.arg_locations([arg.ctype for arg in self.args],
+                                 self.func.ctype.arg.ret)
+
+    def _ret_in_memory(self):
+        """Return whether the return value is stored through RDI."""
+        return abi.in_memory(self.func.ctype.arg.ret)
+
+    def _arg_regs(self):
+        """Return the registers which the arguments are passed in.
+
+        This includes RAX when AL is set for a function with no prototype.
+        """
+        regs = [spots.RDI] if self._ret_in_memory() else []
+        locations, _ = self.locations()
+        for location in locations:
+            regs += location.regs
+        if self._sse_count():
+            regs.append(spots.RAX)
+        return regs
+
+    def _sse_count(self):
+        """Return the number of SSE registers to pass in AL, or 0 if AL is
+        not set, since the function has a prototype or no SSE arguments.
+        """
+        if not self.func.ctype.arg.no_info:
+            return 0
+        locations, _ = self.locations()
+        return abi.sse_count(locations)
 
     def make_asm(self, spotmap, home_spots, get_reg, asm_code): # noqa D102
-        func_spot = spotmap[self.func]
+        if self.direct:
+            spot = spotmap[self.direct]
+            self._move_args(spotmap, None, get_reg, asm_code)
+            asm_code.add(asm_cmds.DirectCall(
+                spot.base, plt=isinstance(spot, GOTSpot)))
+        else:
+            func_spot = self._move_func(spotmap, get_reg, asm_code)
+            self._move_args(spotmap, func_spot, get_reg, asm_code)
+            asm_code.add(asm_cmds.Call(func_spot, None, self.func.ctype.size))
 
-        func_size = self.func.ctype.size
-        ret_size = self.func.ctype.arg.ret.size
+        if not self.void_return and not self._ret_in_memory():
+            spot = spotmap[self.ret]
+            for reg, (shift, size) in zip(abi.ret_locations(self.ret.ctype),
+                                          abi.parts(self.ret.ctype)):
+                abi.store_part(spot.shift(shift), reg, size, asm_code)
 
-        # Check if function pointer spot will be clobbered by moving the
-        # arguments into the correct registers.
-        if spotmap[self.func] in self.arg_regs[0:len(self.args)]:
-            # Get a register which isn't one of the unallowed registers.
-            r = get_reg([], self.arg_regs[0:len(self.args)])
-            asm_code.add(asm_cmds.Mov(r, spotmap[self.func], func_size))
+    def _move_func(self, spotmap, get_reg, asm_code):
+        """Move the function pointer out of the argument registers.
+
+        returns - the spot of the function pointer
+        """
+        func_spot = spotmap[self.func]
+        arg_regs = self._arg_regs()
+        if func_spot in arg_regs:
+            arg_spots = [spotmap[arg] for arg in self.args]
+            r = get_reg([], arg_regs + arg_spots)
+            asm_code.add(asm_cmds.Mov(r, func_spot, self.func.ctype.size))
             func_spot = r
+        return func_spot
+
+    def _move_args(self, spotmap, func_spot, get_reg, asm_code):
+        """Move the arguments to where the function expects them.
+
+        The arguments passed on the stack are stored first, while the
+        argument registers still hold the arguments. Next, arguments in
+        registers are moved into the argument registers. An argument may be
+        in the register of another argument, so a register is only written
+        once every argument in it has been moved out. Registers which all
+        wait on each other are swapped, or for SSE registers, which have no
+        xchg, one is saved in XMM15 first. Last, the remaining arguments are
+        loaded from memory, and AL is set if the function has no prototype.
+        """
+        locations, _ = self.locations()
+
+        # Registers which get_reg must not hand out as a scratch register.
+        busy = ([spotmap[arg] for arg in self.args] + self._arg_regs()
+                + [func_spot])
+
+        moves = {}
+        sizes = {}
+        loads = []
+        for arg, location in zip(self.args, locations):
+            spot = spotmap[arg]
+            parts = abi.parts(arg.ctype)
+            if not location.regs:
+                self._store_stack_arg(location.offset, spot, parts, busy,
+                                      get_reg, asm_code)
+            elif isinstance(spot, (RegSpot, XMMSpot)):
+                if spot != location.regs[0]:
+                    moves[location.regs[0]] = spot
+                    sizes[location.regs[0]] = arg.ctype.size
+            else:
+                for reg, (shift, size) in zip(location.regs, parts):
+                    loads.append((reg, spot.shift(shift), size))
+
+        while moves:
+            ready = [reg for reg in moves if reg not in moves.values()]
+            for reg in ready:
+                asm_code.add(asm_cmds.Mov(reg, moves.pop(reg), sizes[reg]))
+            if ready:
+                continue
 
-        for arg, reg in zip(self.args, self.arg_regs):
-            if spotmap[arg] == reg:
+            # Every remaining move waits on another, so swap the registers
+            # of one and redirect the moves reading either of them.
+            reg, source = moves.popitem()
+            if isinstance(reg, XMMSpot):
+                asm_code.add(asm_cmds.Mov(spots.XMM15, reg, 8))
+                asm_code.add(asm_cmds.Mov(reg, source, sizes[reg]))
+                moves = {r: spots.XMM15 if s == reg else s
+                         for r, s in moves.items()}
                 continue
-            asm_code.add(asm_cmds.Mov(reg, spotmap[arg], arg.ctype.size))
+            asm_code.add(asm_cmds.Xchg(reg, source, 8))
+            swap = {reg: source, source: reg}
+            moves = {r: swap.get(s, s) for r, s in moves.items()
+                     if swap.get(s, s) != r}
+
+        for reg, spot, size in loads:
+            abi.load_part(reg, spot, size, lambda: get_reg([], busy),
+                          asm_code)
+
+        if self._sse_count():
+            asm_code.add(asm_cmds.Mov(spots.RAX,
+                                      LiteralSpot(self._sse_count()), 4))
+
+        if self._ret_in_memory():
+            asm_code.add(asm_cmds.Lea(spots.RDI, spotmap[self.ret]))
+
+    def _store_stack_arg(self, offset, spot, parts, busy, get_reg, asm_code):
+        """Store an argument at the given offset from RSP."""
+        for shift, size in parts:
+            target = MemSpot(spots.RSP, offset + shift)
+            source = spot.shift(shift)
+            if (isinstance(source, (RegSpot, XMMSpot)) or
+                  (isinstance(source, LiteralSpot)
+                   and not self._is_imm64(source))):
+                asm_code.add(asm_cmds.Mov(target, source, size))
+            else:
+                r = get_reg([], busy)
+                abi.load_part(r, source, size,
+                              lambda: get_reg([], busy + [r]), asm_code)
+                asm_code.add(asm_cmds.Mov(target, r, 8))
+
+
+class TailCall(Call):
+    """Call a given function in tail position, and return its result.
+
+    The frame of the current function is torn down before jumping to the
+    function, which then returns straight to the caller of the current
+    function. So, the current function must not have given out a pointer
+    into its frame, and no argument may be passed on the stack nor the
+    return value stored through RDI, since these need the frame of the
+    current function.
+
+    func - Pointer to function
+    args - Arguments of the function, as for Call.
+    """
+
+    def __init__(self, func, args): # noqa D102
+        super().__init__(func, args, None)
 
-        asm_code.add(asm_cmds.Call(func_spot, None, self.func.ctype.size))
+    def outputs(self): # noqa D102
+        return []
 
-        if not self.void_return and spotmap[self.ret] != spots.RAX:
-            asm_code.add(asm_cmds.Mov(spotmap[self.ret], spots.RAX, ret_size))
+    def replace_outputs(self, mapping):  # noqa D102
+        pass
+
+    def has_side_effects(self): # noqa D102
+        return True
+
+    def falls_through(self): # noqa D102
+        return False
+
+    def make_asm(self, spotmap, home_spots, get_reg, asm_code): # noqa D102
+        func_spot = self._move_func(spotmap, get_reg, asm_code)
+        self._move_args(spotmap, func_spot, get_reg, asm_code)
+
+        # The epilogue restores the stack and the callee-saved registers, so
+        # the function pointer must be in some other register, which must
+        # not be RAX if it holds AL.
+        if (not isinstance(func_spot, RegSpot)
+              or func_spot in spots.callee_saved):
+            reg = spots.R11 if self._sse_count() else spots.RAX
+            asm_code.add(asm_cmds.Mov(reg, func_spot, self.func.ctype.size))
+            func_spot = reg
+
+        asm_code.add(asm_cmds.TailJmp(func_spot, None, self.func.ctype.size))
@@ -0,0 +1,353 @@
+"""IL commands for floating values.
+
+A floating value is computed in an SSE register by the scalar SSE2
+commands, like `addsd`. The register allocator never gives a value XMM14 or
+XMM15, so the commands here use them as scratch registers.
+"""
+
+import math
+import operator
+
+import shivyc.asm_cmds as asm_cmds
+import shivyc.ctypes as ctypes
+import shivyc.spots as spots
+from shivyc.il_cmds.base import ILCommand
+from shivyc.spots import LiteralSpot, XMMSpot
+
+
+class _FloatArith(ILCommand):
+    """Base class for FloatAdd, FloatSub, FloatMult, and FloatDiv.
+
+    IL values output, arg1, and arg2 must all have the same floating type.
+    """
+
+    # Whether the operation is commutative, the ASM instruction to generate
+    # for it, and the Python function computing it. Override these values in
+    # subclasses.
+    comm = False
+    Inst = None
+    op = None
+
+    def __init__(self, output, arg1, arg2):  # noqa D102
+        self.output = output
+        self.arg1 = arg1
+        self.arg2 = arg2
+
+    def inputs(self):  # noqa D102
+        return [self.arg1, self.arg2]
+
+    def outputs(self):  # noqa D102
+        return [self.output]
+
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "arg1", "arg2")
+
+    def replace_outputs(self, mapping):  # noqa D102
+        self._replace(mapping, "output")
+
+    def rel_spot_pref(self):  # noqa D102
+        return {self.output: [self.arg1, self.arg2]}
+
+    def has_side_effects(self):  # noqa D102
+        return False
+
+    def evaluate(self, values):  # noqa D102
+        # A division by zero is left to run, so that it gives an infinity
+        # or a NaN with the sign the hardware gives it.
+        if self.arg1 in values and self.arg2 in values:
+            try:
+                val = self.op(values[self.arg1], values[self.arg2])
+            except ZeroDivisionError:
+                return None
+            return ctypes.in_range(val, self.output.ctype)
+
+    def make_asm(self, spotmap, home_spots, get_reg, asm_code):  # noqa D102
+        size = self.output.ctype.size
+        out_spot = spotmap[self.output]
+        arg1_spot = spotmap[self.arg1]
+        arg2_spot = spotmap[self.arg2]
+        if self.comm and out_spot == arg2_spot:
+            arg1_spot, arg2_spot = arg2_spot, arg1_spot
+
+        # The instruction overwrites its first operand, which must be a
+        # register, so the result is computed in XMM15 if the output is in
+        # memory or holds arg2, which is read after it is overwritten.
+        if (isinstance(out_spot, XMMSpot)
+              and (out_spot != arg2_spot or out_spot == arg1_spot)):
+            temp = out_spot
+        else:
+            temp = spots.XMM15
+
+        if temp != arg1_spot:
+            asm_code.add(asm_cmds.Mov(temp, arg1_spot, size))
+        asm_code.add(self.Inst(temp, arg2_spot, size))
+        if temp != out_spot:
+            asm_code.add(asm_cmds.Mov(out_spot, temp, size))
+
+
+class FloatAdd(_FloatArith):
+    """Adds floating values arg1 and arg2, then saves to output."""
+    comm = True
+    Inst = asm_cmds.Adds
+    op = operator.add
+
+
+class FloatSub(_FloatArith):
+    """Subtracts floating value arg2 from arg1, then saves to output."""
+    Inst = asm_cmds.Subs
+    op = operator.sub
+
+
+class FloatMult(_FloatArith):
+    """Multiplies floating values arg1 and arg2, then saves to output."""
+    comm = True
+    Inst = asm_cmds.Muls
+    op = operator.mul
+
+
+class FloatDiv(_FloatArith):
+    """Divides floating value arg1 by arg2, then saves to output."""
+    Inst = asm_cmds.Divs
+    op = operator.truediv
+
+
+class FloatNeg(ILCommand):
+    """Negates floating value arg, then saves to output.
+
+    The sign bit is flipped by a xor with a mask of it, so that the
+    negation of 0.0 is -0.0, which a subtraction from 0.0 would not give.
+    """
+
+    def __init__(self, output, arg):  # noqa D102
+        self.output = output
+        self.arg = arg
+
+    def inputs(self):  # noqa D102
+        return [self.arg]
+
+    def outputs(self):  # noqa D102
+        return [self.output]
+
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "arg")
+
+    def replace_outputs(self, mapping):  # noqa D102
+        self._replace(mapping, "output")
+
+    def rel_spot_pref(self):  # noqa D102
+        return {self.output: [self.arg]}
+
+    def has_side_effects(self):  # noqa D102
+        return False
+
+    def evaluate(self, values):  # noqa D102
+        if self.arg in values:
+            return -values[self.arg]
+
+    def make_asm(self, spotmap, home_spots, get_reg, asm_code):  # noqa D102
+        size = self.output.ctype.size
+        out_spot = spotmap[self.output]
+        arg_spot = spotmap[self.arg]
+
+        r = get_reg()
+        mask = -(1 << (size * 8 - 1))
+        asm_code.add(asm_cmds.Mov(r, LiteralSpot(mask), size))
+        asm_code.add(asm_cmds.Mov(spots.XMM15, r, size))
+
+        temp = out_spot if isinstance(out_spot, XMMSpot) else spots.XMM14
+        if temp != arg_spot:
+            asm_code.add(asm_cmds.Mov(temp, arg_spot, size))
+        asm_code.add(asm_cmds.Xorp(temp, spots.XMM15, size))
+        if temp != out_spot:
+            asm_code.add(asm_cmds.Mov(out_spot, temp, size))
+
+
+class Convert(ILCommand):
+    """Converts arg to the type of output, then saves to output.
+
+    One of output and arg has a floating type, and the other has another
+    floating type or an integral type. An integral type is converted to and
+    from through the signed 32 or 64-bit integer `cvtsi2sd` and `cvttsd2si`
+    take, and a conversion to _Bool compares the value with 0.0.
+    """
+
+    # Bits of 2 ** 63 as a float and as a double, by size.
+    _two_63 = {4: 0x5F000000, 8: 0x43E0000000000000}
+
+    def __init__(self, output, arg):  # noqa D102
+        self.output = output
+        self.arg = arg
+
+    def inputs(self):  # noqa D102
+        return [self.arg]
+
+    def outputs(self):  # noqa D102
+        return [self.output]
+
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "arg")
+
+    def replace_outputs(self, mapping):  # noqa D102
+        self._replace(mapping, "output")
+
+    def has_side_effects(self):  # noqa D102
+        return False
+
+    def evaluate(self, values):  # noqa D102
+        if self.arg not in values:
+            return None
+        val = values[self.arg]
+        ctype = self.output.ctype
+        if ctype.weak_compat(ctypes.bool_t):
+            return int(val != 0)
+        if ctype.is_floating():
+            return ctypes.in_range(val, ctype)
+
+        # A value out of the range of the integral type is left to the
+        # hardware, whose result is not the one shift_into_range gives.
+        if not math.isfinite(val) or ctypes.in_range(val, ctype) != int(val):
+            return None
+        return int(val)
+
+    def make_asm(self, spotmap, home_spots, get_reg, asm_code):  # noqa D102
+        out_type = self.output.ctype
+        arg_type = self.arg.ctype
+        if out_type.weak_compat(ctypes.bool_t):
+            self._to_bool(spotmap, get_reg, asm_code)
+        elif not arg_type.is_floating():
+            self._from_int(spotmap, get_reg, asm_code)
+        elif not out_type.is_floating():
+            self._to_int(spotmap, get_reg, asm_code)
+        else:
+            out_spot = spotmap[self.output]
+            temp = out_spot if isinstance(out_spot, XMMSpot) else spots.XMM15
+            asm_code.add(asm_cmds.Cvts2s(temp, spotmap[self.arg],
+                                         out_type.size, arg_type.size))
+            if temp != out_spot:
+                asm_code.add(asm_cmds.Mov(out_spot, temp, out_type.size))
+
+    def _to_bool(self, spotmap, get_reg, asm_code):
+        """Emit the conversion of a floating value to _Bool.
+
+        The value is 1 unless it equals 0.0, and a NaN equals nothing, so
+        the result is set if ucomis finds the values not equal or unordered.
+        """
+        size = self.arg.ctype.size
+        out_spot = spotmap[self.output]
+        asm_code.add(asm_cmds.Xorp(spots.XMM15, spots.XMM15, size))
+        asm_code.add(asm_cmds.Ucomis(spots.XMM15, spotmap[self.arg], size))
+
+        r = get_reg([out_spot])
+        s = get_reg([], [r])
+        asm_code.add(asm_cmds.Setcc(asm_cmds.Jne, r))
+        asm_code.add(asm_cmds.Setcc(asm_cmds.Jp, s))
+        asm_code.add(asm_cmds.Or(r, s, 1))
+        if r != out_spot:
+            asm_code.add(asm_cmds.Mov(out_spot, r, 1))
+
+    def _from_int(self, spotmap, get_reg, asm_code):
+        """Emit the conversion of an integral value to a floating value.
+
+        A value of less than 32 bits is extended to 32 bits, and an unsigned
+        32-bit value to 64 bits, which convert as signed. An unsigned 64-bit
+        value with its top bit set is halved, keeping the low bit so the
+        result rounds as the value would, and the result doubled.
+        """
+        out_size = self.output.ctype.size
+        arg_type = self.arg.ctype
+        out_spot = spotmap[self.output]
+        arg_spot = spotmap[self.arg]
+        temp = out_spot if isinstance(out_spot, XMMSpot) else spots.XMM15
+
+        if isinstance(arg_spot, LiteralSpot):
+            r = get_reg()
+            asm_code.add(asm_cmds.Mov(r, arg_spot, 8))
+            arg_spot, size = r, 8
+        elif arg_type.size < 4:
+            r = get_reg()
+            extend = asm_cmds.Movsx if arg_type.signed else asm_cmds.Movzx
+            asm_code.add(extend(r, arg_spot, 4, arg_type.size))
+            arg_spot, size = r, 4
+        elif arg_type.size == 4 and not arg_type.signed:
+            r = get_reg()
+            asm_code.add(asm_cmds.Mov(r, arg_spot, 4))
+            arg_spot, size = r, 8
+        else:
+            size = arg_type.size
+
+        if arg_type.size == 8 and not arg_type.signed:
+            self._from_uint64(temp, arg_spot, get_reg, asm_code)
+        else:
+            asm_code.add(asm_cmds.Cvtsi2s(temp, arg_spot, out_size, size))
+
+        if temp != out_spot:
+            asm_code.add(asm_cmds.Mov(out_spot, temp, out_size))
+
+    def _from_uint64(self, temp, arg_spot, get_reg, asm_code):
+        """Emit the conversion of an unsigned 64-bit integer to `temp`."""
+        out_size = self.output.ctype.size
+        big = asm_code.get_label()
+        done = asm_code.get_label()
+
+        r = get_reg([arg_spot])
+        if r != arg_spot:
+            asm_code.add(asm_cmds.Mov(r, arg_spot, 8))
+        asm_code.add(asm_cmds.Test(r, r, 8))
+        asm_code.add(asm_cmds.Js(big))
+        asm_code.add(asm_cmds.Cvtsi2s(temp, r, out_size, 8))
+        asm_code.add(asm_cmds.Jmp(done))
+
+        asm_code.add(asm_cmds.Label(big))
+        s = get_reg([], [r])
+        asm_code.add(asm_cmds.Mov(s, r, 8))
+        asm_code.add(asm_cmds.Shr(s, LiteralSpot(1), 8, 1))
+        asm_code.add(asm_cmds.And(r, LiteralSpot(1), 8))
+        asm_code.add(asm_cmds.Or(s, r, 8))
+        asm_code.add(asm_cmds.Cvtsi2s(temp, s, out_size, 8))
+        asm_code.add(asm_cmds.Adds(temp, temp, out_size))
+        asm_code.add(asm_cmds.Label(done))
+
+    def _to_int(self, spotmap, get_reg, asm_code):
+        """Emit the conversion of a floating value to an integral value.
+
+        The value is truncated to a signed integer of 32 bits, or of 64
+        bits if the result is unsigned and may not fit in 32. A value of at
+        least 2 ** 63 converted to an unsigned 64-bit integer is reduced by
+        2 ** 63 first, and the top bit of the result set.
+        """
+        out_type = self.output.ctype
+        arg_size = self.arg.ctype.size
+        out_spot = spotmap[self.output]
+        arg_spot = spotmap[self.arg]
+
+        r = get_reg([out_spot])
+        if out_type.size == 8 and not out_type.signed:
+            self._to_uint64(r, arg_spot, get_reg, asm_code)
+        else:
+            size = 8 if out_type.size == 8 or not out_type.signed else 4
+            asm_code.add(asm_cmds.Cvtts2si(r, arg_spot, size, arg_size))
+
+        if r != out_spot:
+            asm_code.add(asm_cmds.Mov(out_spot, r, out_type.size))
+
+    def _to_uint64(self, r, arg_spot, get_reg, asm_code):
+        """Emit the conversion to an unsigned 64-bit integer in `r`."""
+        size = self.arg.ctype.size
+        big = asm_code.get_label()
+        done = asm_code.get_label()
+
+        s = get_reg([], [r])
+        asm_code.add(asm_cmds.Mov(s, LiteralSpot(self._two_63[size]), size))
+        asm_code.add(asm_cmds.Mov(spots.XMM14, s, size))
+        asm_code.add(asm_cmds.Mov(spots.XMM15, arg_spot, size))
+        asm_code.add(asm_cmds.Ucomis(spots.XMM15, spots.XMM14, size))
+        asm_code.add(asm_cmds.Jae(big))
+        asm_code.add(asm_cmds.Cvtts2si(r, spots.XMM15, 8, size))
+        asm_code.add(asm_cmds.Jmp(done))
+
+        asm_code.add(asm_cmds.Label(big))
+        asm_code.add(asm_cmds.Subs(spots.XMM15, spots.XMM14, size))
+        asm_code.add(asm_cmds.Cvtts2si(r, spots.XMM15, 8, size))
+        asm_code.add(asm_cmds.Mov(s, LiteralSpot(-(1 << 63)), 8))
+        asm_code.add(asm_cmds.Xor(r, s, 8))
+        asm_code.add(asm_cmds.Label(done))
@@ -0,0 +1,419 @@
+"""IL command for a GNU extended asm statement.
+
+An asm statement runs the instructions of its template, ASM code in the
+AT&T syntax GCC takes by default, with its operands put in. Each
+operand is an expression in a register, in memory, or an integer constant,
+as its constraint allows:
+
+    r q          any general register
+    a b c d S D  the register rax, rbx, rcx, rdx, rsi, or rdi
+    m o          memory, the object the expression designates
+    i n          an integer constant
+    g            any of these, a constant if the expression is one
+    0-9          for an input, the register of the output of that number
+
+The constraint of an output starts with "=" if the asm only writes it, or
+with "+" if the asm reads it too. Every register operand gets a register
+of its own, which no other operand uses and the clobber list does not
+name, so the asm may write an output before it reads all of its inputs.
+
+The constraints map onto the interface of the register allocator: the
+register an operand is fixed to is an absolute spot preference of its
+value, an input which matches an output is a relative preference of the
+two, and the fixed and clobbered registers are the clobber list of the
+command, which keeps values live across the asm out of them. When the
+allocator honors the preferences, the operands are already in place, and
+no moves are made around the instructions.
+
+In the template, %N or %[name] is replaced by operand N or the operand
+named `name`: a register by its name at the size of the operand, like
+%eax, memory by its address, like (%rax), and a constant by its value
+after a $. A modifier letter after the % sets the size of a register
+operand, b, w, k, or q for 1, 2, 4, or 8 bytes, and c prints a constant
+bare. %= is replaced by a number which differs for each asm of the
+function, and %% by %. Of a dialect alternative like {att|intel}, the
+AT&T text is kept.
+
+The optimizer sees an asm read and write its memory operands, and if its
+clobber list has "memory", all memory which code outside the function may
+reach. Every asm is kept and run where it is written, as if volatile.
+"""
+
+import shivyc.asm_cmds as asm_cmds
+import shivyc.spots as spots
+from shivyc.il_cmds.base import ILCommand
+from shivyc.spots import RegSpot
+
+# The kinds of operand.
+REG, MEM, IMM = "reg", "mem", "imm"
+
+# The register each constraint letter which names one fixes an operand to.
+fixed_regs = {"a": spots.RAX, "b": spots.RBX, "c": spots.RCX,
+              "d": spots.RDX, "S": spots.RSI, "D": spots.RDI}
+
+# The size in bytes each operand modifier of a template prints an operand
+# at, or None for a modifier which does not change the size.
+modifiers = {"b": 1, "w": 2, "k": 4, "q": 8, "c": None}
+
+
+class Constraint:
+    """The forms an operand of an asm statement may take.
+
+    kinds (Set[str]) - Which of REG, MEM, and IMM the operand may be.
+    reg (RegSpot) - The register a register operand is fixed to, or None.
+    tie (int) - Number of the output an input matches, or None.
+    output (bool) - Whether this is the constraint of an output.
+    read (bool) - Whether the asm reads an output, as well as writing it.
+    """
+
+    def __init__(self, kinds, reg, tie, output, read):
+        """Initialize Constraint."""
+        self.kinds = kinds
+        self.reg = reg
+        self.tie = tie
+        self.output = output
+        self.read = read
+
+
+def parse_constraint(text):
+    """Return the Constraint of a constraint string.
+
+    The & of an output written before the inputs are read is dropped,
+    since no register operand shares a register anyway, and so is the %
+    of an operand which commutes with the next.
+
+    Raises ValueError with a message if the constraint is not supported.
+    """
+    output = text[:1] in ("=", "+")
+    read = text[:1] == "+"
+    letters = (text[1:] if output else text).replace("&", "")
+    letters = letters.replace("%", "")
+    if not letters:
+        raise ValueError("empty constraint in 'asm'")
+    if letters.isdigit():
+        return Constraint({REG}, None, int(letters), output, read)
+
+    kinds = set()
+    regs = []
+    for letter in letters:
+        if letter in "rq":
+            kinds.add(REG)
+        elif letter in fixed_regs:
+            regs.append(fixed_regs[letter])
+        elif letter in "mo":
+            kinds.add(MEM)
+        elif letter in "in":
+            kinds.add(IMM)
+        elif letter == "g":
+            kinds.update({REG, MEM, IMM})
+        else:
+            raise ValueError(f"unsupported constraint '{letter}' in 'asm'")
+
+    # A register operand is only fixed if it may be in no other register.
+    reg = None
+    if regs and REG not in kinds:
+        kinds.add(REG)
+        reg = regs[0]
+    return Constraint(kinds, reg, None, output, read)
+
+
+def parse_template(template):
+    """Split the template of an asm statement into text and operands.
+
+    Returns a list whose items are strings of text, or pairs of a modifier
+    letter, or "" for none, and the operand printed there, given by its
+    number or its name. The pair for %= has an operand of None.
+
+    Raises ValueError with a message if the template is malformed.
+    """
+    pieces = []
+    text = ""
+    alternative = skip = False
+    i = 0
+    while i < len(template):
+        char = template[i]
+        i += 1
+
+        # The text after the | of a dialect alternative is for Intel syntax.
+        if char == "{":
+            alternative = True
+            continue
+        elif char == "|" and alternative:
+            skip = True
+            continue
+        elif char == "}":
+            alternative = skip = False
+            continue
+
+        if char != "%":
+            if not skip:
+                text += char
+            continue
+
+        after = template[i:i + 1]
+        if after and after in "%{|}":
+            if not skip:
+                text += after
+            i += 1
+            continue
+        elif skip:
+            continue
+        elif after == "=":
+            pieces += [text, ("", None)]
+            text = ""
+            i += 1
+            continue
+
+        modifier = ""
+        if after.isalpha():
+            modifier = after
+            if modifier not in modifiers:
+                err = f"invalid operand modifier '{modifier}' in 'asm'"
+                raise ValueError(err)
+            i += 1
+
+        if template[i:i + 1] == "[":
+            end = template.find("]", i)
+            if end < 0:
+                raise ValueError("missing ']' after operand name in 'asm'")
+            operand = template[i + 1:end]
+            i = end + 1
+        elif template[i:i + 1].isdigit():
+            start = i
+            while template[i:i + 1].isdigit():
+                i += 1
+            operand = int(template[start:i])
+        else:
+            raise ValueError("operand number missing after % in 'asm'")
+        pieces += [text, (modifier, operand)]
+        text = ""
+
+    pieces.append(text)
+    return [piece for piece in pieces if piece != ""]
+
+
+class Operand:
+    """An operand of an asm statement.
+
+    kind (str) - Whether the operand is in a register, in memory, or a
+    constant, one of REG, MEM, and IMM.
+    index (int) - For a register operand, the index of its value in the
+    outputs of the command if it is an output, or else in the inputs. For a
+    memory operand, the index of its address in the inputs.
+    val (int) - Value of a constant operand.
+    size (int) - Size in bytes of the type of the operand, which is the
+    size of a register or memory operand in the template.
+    reg (RegSpot) - Register a register operand is fixed to, or None.
+    tie (int) - Number of the output an input shares its register with, or
+    None.
+    output (bool) - Whether the asm writes the operand.
+    name (str) - Name of the operand, for %[name], or None.
+    """
+
+    def __init__(self, kind, index, val, size, reg, tie, output, name):
+        """Initialize Operand."""
+        self.kind = kind
+        self.index = index
+        self.val = val
+        self.size = size
+        self.reg = reg
+        self.tie = tie
+        self.output = output
+        self.name = name
+
+
+class InlineAsm(ILCommand):
+    """Runs the instructions of an asm statement.
+
+    template (str) - The template of the asm.
+    operands (List[Operand]) - Its operands, numbered as in the template:
+    the outputs, then the inputs. An output read as well as written is
+    followed after the inputs by a hidden input which matches it.
+    ins (List[ILValue]) - Values read by register inputs, and addresses of
+    memory operands.
+    outs (List[ILValue]) - Values written by register outputs.
+    clobbers (List[RegSpot]) - Registers in the clobber list.
+    memory (bool) - Whether "memory" is in the clobber list.
+    r (Range) - Range of the asm statement in the source, where an error
+    of the assembler in its instructions is reported.
+    """
+
+    def __init__(self, template, operands, ins, outs, clobbers, memory, r):
+        """Initialize InlineAsm."""
+        self.template = template
+        self.operands = operands
+        self.ins = ins
+        self.outs = outs
+        self.clobbers = clobbers
+        self.memory = memory
+        self.r = r
+
+    def inputs(self):  # noqa D102
+        return list(self.ins)
+
+    def outputs(self):  # noqa D102
+        return list(self.outs)
+
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "ins")
+
+    def replace_outputs(self, mapping):  # noqa D102
+        self._replace(mapping, "outs")
+
+    def clobber(self):  # noqa D102
+        regs = [op.reg for op in self.operands if op.reg]
+        return list(dict.fromkeys(regs + self.clobbers))
+
+    def rel_spot_conf(self):  # noqa D102
+        # Each output is written, so none may share a spot with another.
+        return {out: [v for v in self.outs if v is not out]
+                for out in self.outs if len(self.outs) > 1}
+
+    def abs_spot_pref(self):  # noqa D102
+        prefs = {}
+        for op in self.operands:
+            reg = op.reg
+            if op.tie is not None:
+                reg = self.operands[op.tie].reg
+            if op.kind == REG and reg:
+                prefs[self._value(op)] = [reg]
+        return prefs
+
+    def rel_spot_pref(self):  # noqa D102
+        return {self._value(self.operands[op.tie]): [self._value(op)]
+                for op in self.operands if op.tie is not None}
+
+    def indir_read(self):  # noqa D102
+        return [self.ins[op.index] for op in self.operands
+                if op.kind == MEM]
+
+    def indir_write(self):  # noqa D102
+        return [self.ins[op.index] for op in self.operands
+                if op.kind == MEM and op.output]
+
+    def clobbers_memory(self):  # noqa D102
+        return self.memory
+
+    def make_asm(self, spotmap, home_spots, get_reg, asm_code):  # noqa D102
+        regs = self._assign_regs(spotmap, get_reg)
+
+        # Move the inputs into their registers, in parallel.
+        moves = {}
+        loads = []
+        for n, op in enumerate(self.operands):
+            if op.kind == IMM or op.kind == REG and op.output:
+                continue
+            spot = spotmap[self.ins[op.index]]
+            size = 8 if op.kind == MEM else op.size
+            if isinstance(spot, RegSpot):
+                if spot != regs[n]:
+                    moves[regs[n]] = spot
+            else:
+                loads.append((regs[n], spot, size))
+        _move_regs(moves, asm_code)
+        for reg, spot, size in loads:
+            asm_code.add(asm_cmds.Mov(reg, spot, size))
+
+        asm_code.add(asm_cmds.InlineAsm(self._text(regs, asm_code),
+                                        list(regs.values()) + self.clobber(),
+                                        self.r))
+
+        # Move the outputs from their registers to their spots. The stores
+        # to memory read the registers before any is written.
+        moves = {}
+        for n, op in enumerate(self.operands):
+            if op.kind != REG or not op.output:
+                continue
+            spot = spotmap[self.outs[op.index]]
+            if isinstance(spot, RegSpot):
+                if spot != regs[n]:
+                    moves[spot] = regs[n]
+            else:
+                asm_code.add(asm_cmds.Mov(spot, regs[n], op.size))
+        _move_regs(moves, asm_code)
+
+    def _value(self, op):
+        """Return the value of the given register or memory operand."""
+        return (self.outs if op.kind == REG and op.output
+                else self.ins)[op.index]
+
+    def _assign_regs(self, spotmap, get_reg):
+        """Return a map from the number of each register or memory operand
+        to the register it, or its address, is in for the instructions.
+
+        An operand which is not fixed to a register stays in the register
+        its value is in, if no other operand has taken it, so the outputs
+        are assigned first. Otherwise it gets a register which holds no
+        value of the command.
+        """
+        taken = set(self.clobber())
+        conf = [spotmap[v] for v in self.ins + self.outs]
+        regs = {}
+        for n, op in enumerate(self.operands):
+            if op.kind == IMM:
+                continue
+            elif op.tie is not None:
+                regs[n] = regs[op.tie]
+                continue
+
+            spot = spotmap[self._value(op)]
+            if op.reg:
+                reg = op.reg
+            elif isinstance(spot, RegSpot) and spot not in taken:
+                reg = spot
+            else:
+                reg = get_reg([], conf + list(taken))
+            taken.add(reg)
+            regs[n] = reg
+        return regs
+
+    def _text(self, regs, asm_code):
+        """Return the template with the operands put in."""
+        names = {op.name: n for n, op in enumerate(self.operands)
+                 if op.name}
+        label = None
+        text = ""
+        for piece in parse_template(self.template):
+            if isinstance(piece, str):
+                text += piece
+                continue
+
+            modifier, operand = piece
+            if operand is None:
+                label = label or asm_code.get_label().rsplit("_", 1)[1]
+                text += label
+                continue
+
+            n = names[operand] if isinstance(operand, str) else operand
+            op = self.operands[n]
+            size = modifiers.get(modifier) or op.size
+            if op.kind == IMM:
+                text += ("" if modifier == "c" else "$") + str(op.val)
+            elif op.kind == REG:
+                text += "%" + regs[n].asm_str(size)
+            else:
+                text += f"(%{regs[n].asm_str(8)})"
+        return text
+
+
+def _move_regs(moves, asm_code):
+    """Make the given moves between general registers, in parallel.
+
+    moves (Dict[RegSpot, RegSpot]) - Map from each register to write to the
+    register whose value it gets.
+
+    A register is only written once every move out of it is made. When
+    the remaining moves all wait on each other, two registers are swapped.
+    """
+    while moves:
+        ready = [reg for reg in moves if reg not in moves.values()]
+        for reg in ready:
+            asm_code.add(asm_cmds.Mov(reg, moves.pop(reg), 8))
+        if ready:
+            continue
+
+        reg, source = moves.popitem()
+        asm_code.add(asm_cmds.Xchg(reg, source, 8))
+        swap = {reg: source, source: reg}
+        moves = {r: swap.get(s, s) for r, s in moves.items()
+                 if swap.get(s, s) != r}
@@ -1,6 +1,9 @@
 """IL commands for mathematical operations."""
 
+import operator
+
 import shivyc.asm_cmds as asm_cmds
+import shivyc.ctypes as ctypes
 import shivyc.spots as spots
 from shivyc.il_cmds.base import ILCommand
 
@@ -17,6 +20,19 @@ class _AddMult(ILCommand):
     # in subclasses.
     Inst = None
 
+    # The Python function computing this operation, and the value of arg2
+    # for which the output equals arg1. Override these values in subclasses.
+    op = None
+    identity = None
+
+    # Whether the ASM instruction can write its result to memory, so that
+    # an output in memory in the spot of an argument is updated in place,
+    # like `add [rbp-8], 2`, and the one-operand ASM instruction to generate
+    # for each literal arg2, like `inc` for adding 1. Override these values
+    # in subclasses.
+    in_place = False
+    inc_dec = {}
+
     def __init__(self, output, arg1, arg2): # noqa D102
         self.output = output
         self.arg1 = arg1
@@ -28,9 +44,29 @@ class _AddMult(ILCommand):
     def outputs(self): # noqa D102
         return [self.output]
 
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "arg1", "arg2")
+
+    def replace_outputs(self, mapping):  # noqa D102
+        self._replace(mapping, "output")
+
     def rel_spot_pref(self): # noqa D102
         return {self.output: [self.arg1, self.arg2]}
 
+    def has_side_effects(self):  # noqa D102
+        return False
+
+    def evaluate(self, values):  # noqa D102
+        if self.arg1 in values and self.arg2 in values:
+            val = self.op(values[self.arg1], values[self.arg2])
+            return ctypes.in_range(val, self.output.ctype)
+
+    def simplify(self, values):  # noqa D102
+        if values.get(self.arg2) == self.identity:
+            return self._same_type(self.arg1)
+        if self.comm and values.get(self.arg1) == self.identity:
+            return self._same_type(self.arg2)
+
     def make_asm(self, spotmap, home_spots, get_reg, asm_code): # noqa D102
         """Make the ASM for ADD, MULT, and SUB."""
         ctype = self.arg1.ctype
@@ -39,6 +75,9 @@ class _AddMult(ILCommand):
         arg1_spot = spotmap[self.arg1]
         arg2_spot = spotmap[self.arg2]
 
+        if self._update(spotmap, get_reg, asm_code):
+            return
+
         # Get temp register for computation.
         temp = get_reg([spotmap[self.output],
                         arg1_spot,
@@ -46,7 +85,7 @@ class _AddMult(ILCommand):
 
         if temp == arg1_spot:
             if not self._is_imm64(arg2_spot):
-                asm_code.add(self.Inst(temp, arg2_spot, size))
+                self._emit(temp, arg2_spot, size, asm_code)
             else:
                 temp2 = get_reg([], [temp])
                 asm_code.add(asm_cmds.Mov(temp2, arg2_spot, size))
@@ -66,7 +105,7 @@ class _AddMult(ILCommand):
             if (not self._is_imm64(arg1_spot) and
                  not self._is_imm64(arg2_spot)):
                 asm_code.add(asm_cmds.Mov(temp, arg1_spot, size))
-                asm_code.add(self.Inst(temp, arg2_spot, size))
+                self._emit(temp, arg2_spot, size, asm_code)
             elif (self._is_imm64(arg1_spot) and
                   not self._is_imm64(arg2_spot)):
                 asm_code.add(asm_cmds.Mov(temp, arg1_spot, size))
@@ -85,6 +124,48 @@ class _AddMult(ILCommand):
         if temp != spotmap[self.output]:
             asm_code.add(asm_cmds.Mov(spotmap[self.output], temp, size))
 
+    def _update(self, spotmap, get_reg, asm_code):
+        """Emit the operation on an output in memory in place, if possible.
+
+        This applies when the output is in memory in the spot of arg1, or of
+        arg2 if the operation is commutative, as for `x = x + y` where x
+        is on the stack. The other argument is moved to a register only if
+        it is also in memory or is a 64-bit immediate.
+
+        returns - whether the code was emitted
+        """
+        out_spot = spotmap[self.output]
+        if not self.in_place or not isinstance(out_spot, spots.MemSpot):
+            return False
+
+        args = [(self.arg1, self.arg2)]
+        if self.comm:
+            args.append((self.arg2, self.arg1))
+
+        size = self.arg1.ctype.size
+        for arg, other in args:
+            if spotmap[arg] != out_spot:
+                continue
+
+            other_spot = spotmap[other]
+            if (isinstance(other_spot, spots.MemSpot)
+                  or self._is_imm64(other_spot)):
+                r = get_reg()
+                asm_code.add(asm_cmds.Mov(r, other_spot, size))
+                other_spot = r
+            self._emit(out_spot, other_spot, size, asm_code)
+            return True
+        return False
+
+    def _emit(self, dest, source, size, asm_code):
+        """Emit the instruction computing `dest = dest op source`."""
+        if isinstance(source, spots.LiteralSpot):
+            step = self.inc_dec.get(_signed(int(source.value), size * 8))
+            if step:
+                asm_code.add(step(dest, None, size))
+                return
+        asm_code.add(self.Inst(dest, source, size))
+
 
 class Add(_AddMult):
     """Adds arg1 and arg2, then saves to output.
@@ -94,6 +175,10 @@ class Add(_AddMult):
     """
     comm = True
     Inst = asm_cmds.Add
+    op = operator.add
+    identity = 0
+    in_place = True
+    inc_dec = {1: asm_cmds.Inc, -1: asm_cmds.Dec}
 
 
 class Subtr(_AddMult):
@@ -103,6 +188,72 @@ class Subtr(_AddMult):
     """
     comm = False
     Inst = asm_cmds.Sub
+    op = operator.sub
+    identity = 0
+    in_place = True
+    inc_dec = {1: asm_cmds.Dec, -1: asm_cmds.Inc}
+
+class AddScaled(ILCommand):
+    """Adds arg1, arg2 times a factor, and an offset, then saves to output.
+
+    This is address arithmetic done by the addressing mode of one lea, like
+    [rax+rdx*4+8]. arg1 is a pointer, arg2 and the output have 8-byte
+    types, the factor is a Python integer, one of 1, 2, 4, or 8, and the
+    offset is a Python integer which fits in 32 bits. If arg2 is None, only
+    the offset is added. These commands are made by the instruction
+    selector in shivyc.opt.select.
+    """
+
+    def __init__(self, output, arg1, arg2, factor, offset=0):  # noqa D102
+        self.output = output
+        self.arg1 = arg1
+        self.arg2 = arg2
+        self.factor = factor
+        self.offset = offset
+
+    def inputs(self):  # noqa D102
+        return [self.arg1, self.arg2] if self.arg2 else [self.arg1]
+
+    def outputs(self):  # noqa D102
+        return [self.output]
+
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "arg1", "arg2")
+
+    def replace_outputs(self, mapping):  # noqa D102
+        self._replace(mapping, "output")
+
+    def rel_spot_pref(self):  # noqa D102
+        return {self.output: self.inputs()}
+
+    def has_side_effects(self):  # noqa D102
+        return False
+
+    def make_asm(self, spotmap, home_spots, get_reg, asm_code):  # noqa D102
+        out_spot = spotmap[self.output]
+        regs = []
+        for arg in self.inputs():
+            spot = spotmap[arg]
+            if not isinstance(spot, spots.RegSpot):
+                conf = [spotmap[v] for v in self.inputs()] + regs
+                r = get_reg([out_spot], conf)
+                asm_code.add(asm_cmds.Mov(r, spot, 8))
+                spot = r
+            regs.append(spot)
+
+        if isinstance(out_spot, spots.RegSpot):
+            temp = out_spot
+        else:
+            temp = get_reg(regs)
+
+        if self.arg2:
+            address = spots.MemSpot(regs[0], self.offset, self.factor,
+                                    regs[1])
+        else:
+            address = spots.MemSpot(regs[0], self.offset)
+        asm_code.add(asm_cmds.Lea(temp, address))
+        if temp != out_spot:
+            asm_code.add(asm_cmds.Mov(out_spot, temp, 8))
 
 
 class Mult(_AddMult):
@@ -110,17 +261,140 @@ class Mult(_AddMult):
 
     IL values output, arg1, arg2 must all have the same type. No type
     conversion or promotion is done here.
+
+    Multiplying by a literal does not use the slow `imul` if the literal is
+    a power of two, or a power of two times one of the products of 3, 5,
+    and 9 below, negated or not. Multiplying by 2^k is a shift left by k,
+    and multiplying by 3, 5, or 9 is a lea like [rax+rax*2].
     """
     comm = True
     Inst = asm_cmds.Imul
+    op = operator.mul
+    identity = 1
+
+    # Factors of each odd multiplier which is made of leas.
+    lea_factors = {1: [], 3: [3], 5: [5], 9: [9], 15: [3, 5], 25: [5, 5],
+                   27: [3, 9], 45: [5, 9], 81: [9, 9]}
+
+    def evaluate(self, values):  # noqa D102
+        if values.get(self.arg1) == 0 or values.get(self.arg2) == 0:
+            return 0
+        return super().evaluate(values)
+
+    def make_asm(self, spotmap, home_spots, get_reg, asm_code):  # noqa D102
+        size = self.arg1.ctype.size
+        for arg, other in [(self.arg1, self.arg2), (self.arg2, self.arg1)]:
+            if other.literal and not arg.literal:
+                factor = _signed(int(other.literal.val), size * 8)
+                steps = self._steps(factor)
+                if steps:
+                    self._by_literal(arg, factor, steps, spotmap, get_reg,
+                                     asm_code)
+                    return
+
+        super().make_asm(spotmap, home_spots, get_reg, asm_code)
+
+    def _steps(self, factor):
+        """Return the lea factors and shift to multiply by given literal.
+
+        returns - the tuple of the list of factors and the shift, or None if
+        the literal is not made of leas and a shift
+        """
+        if not factor:
+            return None
+
+        shift = 0
+        odd = abs(factor)
+        while not odd % 2:
+            odd //= 2
+            shift += 1
+        if odd not in self.lea_factors:
+            return None
+        return self.lea_factors[odd], shift
+
+    def _by_literal(self, arg, factor, steps, spotmap, get_reg, asm_code):
+        """Emit code to multiply `arg` by a literal of the given steps."""
+        size = self.arg1.ctype.size
+        out_spot = spotmap[self.output]
+        factors, shift = steps
+
+        temp = get_reg([out_spot, spotmap[arg]])
+        if temp != spotmap[arg]:
+            asm_code.add(asm_cmds.Mov(temp, spotmap[arg], size))
+
+        # Only the low bits of a lea are used for a smaller value, so it
+        # does not matter that it computes all 64 bits.
+        for n in factors:
+            asm_code.add(asm_cmds.Lea(temp, spots.MemSpot(temp, 0, n - 1,
+                                                          temp)))
+        if shift:
+            asm_code.add(asm_cmds.Sal(temp, _lit(shift), size, 1))
+        if factor < 0:
+            asm_code.add(asm_cmds.Neg(temp, None, size))
+
+        if temp != out_spot:
+            asm_code.add(asm_cmds.Mov(out_spot, temp, size))
+
+
+class BitAnd(_AddMult):
+    """Bitwise ands arg1 and arg2, then saves to output.
+
+    IL values output, arg1, arg2 must all have the same integral type. No
+    type conversion or promotion is done here.
+    """
+    comm = True
+    Inst = asm_cmds.And
+    op = operator.and_
+    in_place = True
+
+    def evaluate(self, values):  # noqa D102
+        if values.get(self.arg1) == 0 or values.get(self.arg2) == 0:
+            return 0
+        return super().evaluate(values)
+
+    def simplify(self, values):  # noqa D102
+        # The identity has all bits set, which is -1 or the largest value
+        # of the type, as values are kept in the range of their type.
+        ones = ctypes.in_range(-1, self.output.ctype)
+        if values.get(self.arg2) == ones:
+            return self._same_type(self.arg1)
+        if values.get(self.arg1) == ones:
+            return self._same_type(self.arg2)
+
+
+class BitOr(_AddMult):
+    """Bitwise ors arg1 and arg2, then saves to output.
+
+    IL values output, arg1, arg2 must all have the same integral type. No
+    type conversion or promotion is done here.
+    """
+    comm = True
+    Inst = asm_cmds.Or
+    op = operator.or_
+    identity = 0
+    in_place = True
+
+
+class BitXor(_AddMult):
+    """Bitwise xors arg1 and arg2, then saves to output.
+
+    IL values output, arg1, arg2 must all have the same integral type. No
+    type conversion or promotion is done here.
+    """
+    comm = True
+    Inst = asm_cmds.Xor
+    op = operator.xor
+    identity = 0
+    in_place = True
 
 
 class _BitShiftCmd(ILCommand):
     """Base class for bitwise shift commands."""
 
-    # The ASM instruction to generate for this command. Override this value
-    # in subclasses.
+    # The ASM instruction to generate for this command, and the Python
+    # function computing it. Override these values in subclasses.
     Inst = None
+    op = None
 
     def __init__(self, output, arg1, arg2): # noqa D102
         self.output = output
@@ -133,6 +407,12 @@ class _BitShiftCmd(ILCommand):
     def outputs(self): # noqa D102
         return [self.output]
 
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "arg1", "arg2")
+
+    def replace_outputs(self, mapping):  # noqa D102
+        self._replace(mapping, "output")
+
     def clobber(self):  # noqa D102
         return [spots.RCX]
 
@@ -142,6 +422,22 @@ class _BitShiftCmd(ILCommand):
     def rel_spot_pref(self): # noqa D102
         return {self.output: [self.arg1]}
 
+    def has_side_effects(self):  # noqa D102
+        return False
+
+    def evaluate(self, values):  # noqa D102
+        if self.arg1 in values and self.arg2 in values:
+            # Shifting by a negative amount or by at least the width of the
+            # type is undefined, so it is left to run time.
+            shift = values[self.arg2]
+            if 0 <= shift < self.arg1.ctype.size * 8:
+                val = self.op(values[self.arg1], shift)
+                return ctypes.in_range(val, self.output.ctype)
+
+    def simplify(self, values):  # noqa D102
+        if values.get(self.arg2) == 0:
+            return self._same_type(self.arg1)
+
     def make_asm(self, spotmap, home_spots, get_reg, asm_code): # noqa D102
         arg1_spot = spotmap[self.arg1]
         arg1_size = self.arg1.ctype.size
@@ -161,17 +457,22 @@ class _BitShiftCmd(ILCommand):
             asm_code.add(asm_cmds.Mov(spots.RCX, arg2_spot, arg2_size))
             arg2_spot = spots.RCX
 
+        Inst = self._inst()
         if spotmap[self.output] == arg1_spot:
-            asm_code.add(self.Inst(arg1_spot, arg2_spot, arg1_size, 1))
+            asm_code.add(Inst(arg1_spot, arg2_spot, arg1_size, 1))
         else:
             out_spot = spotmap[self.output]
             temp_spot = get_reg([out_spot, arg1_spot], [arg2_spot])
             if arg1_spot != temp_spot:
                 asm_code.add(asm_cmds.Mov(temp_spot, arg1_spot, arg1_size))
-            asm_code.add(self.Inst(temp_spot, arg2_spot, arg1_size, 1))
+            asm_code.add(Inst(temp_spot, arg2_spot, arg1_size, 1))
             if temp_spot != out_spot:
                 asm_code.add(asm_cmds.Mov(out_spot, temp_spot, arg1_size))
 
+    def _inst(self):
+        """Return the ASM instruction to generate for this command."""
+        return self.Inst
+
 
 class RBitShift(_BitShiftCmd):
     """Right bitwise shift operator for IL value.
@@ -179,6 +480,15 @@ class RBitShift(_BitShiftCmd):
     indicated by right operand."""
 
     Inst = asm_cmds.Sar
+    op = operator.rshift
+
+    def _inst(self):
+        """Return the ASM instruction to generate for this command.
+
+        An unsigned value is shifted logically, so zeros are shifted in
+        rather than copies of the sign bit.
+        """
+        return asm_cmds.Sar if self.arg1.ctype.signed else asm_cmds.Shr
 
 
 class LBitShift(_BitShiftCmd):
@@ -187,10 +497,93 @@ class LBitShift(_BitShiftCmd):
     indicated by right operand."""
 
     Inst = asm_cmds.Sal
+    op = operator.lshift
+
+
+class _RotateCmd(_BitShiftCmd):
+    """Base class for bitwise rotate commands.
+
+    The value rotated is unsigned and of 4 or 8 bytes. As with the rol and
+    ror instructions, the count is taken modulo the width of its type.
+    """
+
+    def evaluate(self, values):  # noqa D102
+        if self.arg1 in values and self.arg2 in values:
+            bits = self.arg1.ctype.size * 8
+            val = values[self.arg1] % (1 << bits)
+            shift = self._left_count(values[self.arg2] % bits, bits)
+            return (val << shift | val >> (bits - shift)) % (1 << bits)
+
+    def _left_count(self, count, bits):
+        """Return the count of the left rotate equal to this rotate."""
+        raise NotImplementedError
+
+
+class RotateLeft(_RotateCmd):
+    """Rotates the bits of arg1 to the left by arg2 positions, so that the
+    bits shifted out of the top come back in at the bottom.
+    """
+
+    Inst = asm_cmds.Rol
+
+    def _left_count(self, count, bits):
+        return count
+
+
+class RotateRight(_RotateCmd):
+    """Rotates the bits of arg1 to the right by arg2 positions, so that the
+    bits shifted out of the bottom come back in at the top.
+    """
+
+    Inst = asm_cmds.Ror
+
+    def _left_count(self, count, bits):
+        return (bits - count) % bits
+
+
+def _magic(divisor, bits, signed):
+    """Return a multiplier and shift for dividing by a literal.
+
+    For every `bits`-bit value x, x / divisor is (x * M) >> p rounded down,
+    or for signed x which is negative, that plus one. Here divisor is
+    positive and not a power of two, and M = ceil(2^p / divisor) for the
+    smallest p for which the rounding error of M never reaches the next
+    quotient. M may have one bit more than the values divided.
+
+    returns - the tuple (M, p)
+    """
+    p = bits - 1 if signed else bits
+    while True:
+        M = -(-(1 << p) // divisor)
+        error = M * divisor - (1 << p)
+        if signed and error << (bits - 1) < 1 << p:
+            return M, p
+        if not signed and error << bits <= 1 << p:
+            return M, p
+        p += 1
+
+
+def _signed(val, bits):
+    """Return the value of the `bits`-bit two's complement of given value."""
+    val %= 1 << bits
+    return val - (1 << bits) if val >> (bits - 1) else val
+
+
+def _lit(val):
+    """Return a LiteralSpot for given value."""
+    return spots.LiteralSpot(val)
 
 
 class _DivMod(ILCommand):
-    """Base class for ILCommand Div and Mod."""
+    """Base class for ILCommand Div and Mod.
+
+    Dividing by a literal does not use the slow `div` or `idiv`. Division by
+    a power of two is a shift, adjusted to round toward zero for signed
+    values, and modulus by one is a mask. Division by another literal is a
+    multiply by a magic number, which for 64-bit values takes the high half
+    of a `mul` or `imul` in RDX, and a modulus by a literal then subtracts
+    the quotient times the divisor.
+    """
 
     # Register which contains the value we want after the x86 div or idiv
     # command is executed. For the Div IL command, this is spots.RAX,
@@ -208,17 +601,62 @@ class _DivMod(ILCommand):
     def outputs(self):  # noqa D102
         return [self.output]
 
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "arg1", "arg2")
+
+    def replace_outputs(self, mapping):  # noqa D102
+        self._replace(mapping, "output")
+
     def clobber(self):  # noqa D102
+        if self._divisor() and not self._wide_magic():
+            return []
         return [spots.RAX, spots.RDX]
 
     def abs_spot_conf(self): # noqa D102
+        if self._divisor():
+            return {}
         return {self.arg2: [spots.RDX, spots.RAX]}
 
     def abs_spot_pref(self): # noqa D102
+        if self._divisor():
+            return {self.output: [spots.RDX]} if self._wide_magic() else {}
         return {self.output: [self.return_reg],
                 self.arg1: [spots.RAX]}
 
+    def rel_spot_pref(self): # noqa D102
+        if self._divisor() and not self._wide_magic():
+            return {self.output: [self.arg1]}
+        return {}
+
+    def has_side_effects(self):  # noqa D102
+        return False
+
+    def evaluate(self, values):  # noqa D102
+        if self.arg1 not in values or self.arg2 not in values:
+            return None
+
+        # Division by zero and signed overflow trap at run time, so they
+        # are not folded.
+        arg1, arg2 = values[self.arg1], values[self.arg2]
+        quot = abs(arg1) // abs(arg2) if arg2 else None
+        if quot is None or quot != ctypes.in_range(quot, self.output.ctype):
+            return None
+
+        # C division truncates toward zero.
+        if (arg1 < 0) != (arg2 < 0):
+            quot = -quot
+        return quot if self.return_reg == spots.RAX else arg1 - arg2 * quot
+
+    def simplify(self, values):  # noqa D102
+        if self.return_reg == spots.RAX and values.get(self.arg2) == 1:
+            return self._same_type(self.arg1)
+
     def make_asm(self, spotmap, home_spots, get_reg, asm_code): # noqa D102
+        divisor = self._divisor()
+        if divisor:
+            self._by_literal(divisor, spotmap, get_reg, asm_code)
+            return
+
         ctype = self.arg1.ctype
         size = ctype.size
 
@@ -262,6 +700,213 @@ class _DivMod(ILCommand):
             asm_code.add(asm_cmds.Mov(output_spot, self.return_reg, size))
 
 
+    def _divisor(self):
+        """Return the divisor if it is a nonzero literal, or else None."""
+        if not self.arg2.literal:
+            return None
+
+        bits = 8 * self.arg1.ctype.size
+        val = self.arg2.literal.val % (1 << bits)
+        if self.arg1.ctype.signed:
+            val = _signed(val, bits)
+        return val or None
+
+    def _wide_magic(self):
+        """Return whether the literal divisor needs a multiply in RDX:RAX."""
+        divisor = abs(self._divisor())
+        return self.arg1.ctype.size == 8 and divisor & (divisor - 1)
+
+    def _by_literal(self, divisor, spotmap, get_reg, asm_code):
+        """Emit code for dividing by a nonzero literal."""
+        size = self.arg1.ctype.size
+        out_spot = spotmap[self.output]
+        arg1_spot = spotmap[self.arg1]
+
+        d = abs(divisor)
+        if not d & (d - 1):
+            result = self._by_power_of_two(divisor, out_spot, arg1_spot,
+                                           get_reg, asm_code)
+        elif size == 4:
+            result = self._by_magic(divisor, out_spot, arg1_spot, get_reg,
+                                    asm_code)
+        else:
+            result = self._by_wide_magic(divisor, arg1_spot, get_reg,
+                                         asm_code)
+
+        if result != out_spot:
+            asm_code.add(asm_cmds.Mov(out_spot, result, size))
+
+    def _by_power_of_two(self, divisor, out_spot, arg1_spot, get_reg,
+                         asm_code):
+        """Emit code for dividing by a power of two, or its negative.
+
+        returns - the register holding the result
+        """
+        ctype = self.arg1.ctype
+        size = ctype.size
+        bits = 8 * size
+        d = abs(divisor)
+        k = d.bit_length() - 1
+        div = self.return_reg == spots.RAX
+
+        a = get_reg([out_spot, arg1_spot])
+        if a != arg1_spot:
+            asm_code.add(asm_cmds.Mov(a, arg1_spot, size))
+
+        if d == 1:
+            if not div:
+                asm_code.add(asm_cmds.Mov(a, _lit(0), size))
+            elif divisor < 0:
+                asm_code.add(asm_cmds.Neg(a, None, size))
+        elif ctype.signed:
+            # A negative value is biased by d - 1 before it is shifted, so
+            # the quotient rounds toward zero.
+            b = get_reg([], [a])
+            asm_code.add(asm_cmds.Mov(b, a, size))
+            if k > 1:
+                asm_code.add(asm_cmds.Sar(b, _lit(bits - 1), size, 1))
+            asm_code.add(asm_cmds.Shr(b, _lit(bits - k), size, 1))
+
+            if div:
+                asm_code.add(asm_cmds.Add(a, b, size))
+                asm_code.add(asm_cmds.Sar(a, _lit(k), size, 1))
+                if divisor < 0:
+                    asm_code.add(asm_cmds.Neg(a, None, size))
+            else:
+                asm_code.add(asm_cmds.Add(b, a, size))
+                asm_code.add(asm_cmds.Sar(b, _lit(k), size, 1))
+                asm_code.add(asm_cmds.Sal(b, _lit(k), size, 1))
+                asm_code.add(asm_cmds.Sub(a, b, size))
+        elif div:
+            asm_code.add(asm_cmds.Shr(a, _lit(k), size, 1))
+        elif k < 32:
+            asm_code.add(asm_cmds.And(a, _lit(d - 1), size))
+        else:
+            # The mask does not fit in an immediate.
+            asm_code.add(asm_cmds.Sal(a, _lit(bits - k), size, 1))
+            asm_code.add(asm_cmds.Shr(a, _lit(bits - k), size, 1))
+        return a
+
+    def _by_magic(self, divisor, out_spot, arg1_spot, get_reg, asm_code):
+        """Emit code for dividing a 32-bit value by a literal.
+
+        The value is widened to 64 bits, so the product with the magic
+        number fits in one register.
+
+        returns - the register holding the result
+        """
+        signed = self.arg1.ctype.signed
+        div = self.return_reg == spots.RAX
+        M, p = _magic(abs(divisor), 32, signed)
+
+        # A modulus needs the dividend again at the end.
+        a = get_reg([out_spot, arg1_spot] if div else [out_spot],
+                    [] if div else [arg1_spot])
+        b = get_reg([], [a, arg1_spot])
+
+        if not signed:
+            asm_code.add(asm_cmds.Mov(a, arg1_spot, 4))
+        elif isinstance(arg1_spot, spots.LiteralSpot):
+            asm_code.add(asm_cmds.Mov(a, arg1_spot, 8))
+        else:
+            asm_code.add(asm_cmds.Movsx(a, arg1_spot, 8, 4))
+
+        if M >= 1 << 32:
+            # The multiplier has 33 bits, so x * M is computed as
+            # x * (M - 2^32) + x * 2^32.
+            asm_code.add(asm_cmds.Mov(b, _lit(M - (1 << 32)), 8))
+            asm_code.add(asm_cmds.Imul(b, a, 8))
+            asm_code.add(asm_cmds.Shr(b, _lit(32), 8, 1))
+            asm_code.add(asm_cmds.Add(a, b, 8))
+            asm_code.add(asm_cmds.Shr(a, _lit(p - 32), 8, 1))
+        else:
+            if M > ctypes.int_max:
+                asm_code.add(asm_cmds.Mov(b, _lit(M), 8))
+                asm_code.add(asm_cmds.Imul(a, b, 8))
+            else:
+                asm_code.add(asm_cmds.Imul(a, _lit(M), 8))
+
+            if signed:
+                asm_code.add(asm_cmds.Sar(a, _lit(p), 8, 1))
+                asm_code.add(asm_cmds.Mov(b, a, 8))
+                asm_code.add(asm_cmds.Shr(b, _lit(63), 8, 1))
+                asm_code.add(asm_cmds.Add(a, b, 8))
+                if divisor < 0:
+                    asm_code.add(asm_cmds.Neg(a, None, 4))
+            else:
+                asm_code.add(asm_cmds.Shr(a, _lit(p), 8, 1))
+
+        if not div:
+            self._remainder(a, divisor, arg1_spot, b, asm_code)
+        return a
+
+    def _by_wide_magic(self, divisor, arg1_spot, get_reg, asm_code):
+        """Emit code for dividing a 64-bit value by a literal.
+
+        The high half of the 128-bit product with the magic number is taken
+        from RDX.
+
+        returns - the register holding the result
+        """
+        signed = self.arg1.ctype.signed
+        M, p = _magic(abs(divisor), 64, signed)
+
+        x = arg1_spot
+        if x in [spots.RAX, spots.RDX] or isinstance(x, spots.LiteralSpot):
+            x = get_reg([], [spots.RAX, spots.RDX])
+            asm_code.add(asm_cmds.Mov(x, arg1_spot, 8))
+
+        asm_code.add(asm_cmds.Mov(spots.RAX, _lit(_signed(M, 64)), 8))
+        if signed:
+            asm_code.add(asm_cmds.Imul(x, None, 8))
+
+            # A multiplier of at least 2^63 was taken as 2^64 less.
+            if M >= 1 << 63:
+                asm_code.add(asm_cmds.Add(spots.RDX, x, 8))
+            if p > 64:
+                asm_code.add(asm_cmds.Sar(spots.RDX, _lit(p - 64), 8, 1))
+            asm_code.add(asm_cmds.Mov(spots.RAX, spots.RDX, 8))
+            asm_code.add(asm_cmds.Shr(spots.RAX, _lit(63), 8, 1))
+            asm_code.add(asm_cmds.Add(spots.RDX, spots.RAX, 8))
+            if divisor < 0:
+                asm_code.add(asm_cmds.Neg(spots.RDX, None, 8))
+            result, other = spots.RDX, spots.RAX
+        elif M < 1 << 64:
+            asm_code.add(asm_cmds.Mul(x, None, 8))
+            if p > 64:
+                asm_code.add(asm_cmds.Shr(spots.RDX, _lit(p - 64), 8, 1))
+            result, other = spots.RDX, spots.RAX
+        else:
+            # The multiplier has 65 bits, so with t the high half of
+            # x * (M - 2^64), the quotient is ((x - t) / 2 + t) >> (p - 65).
+            asm_code.add(asm_cmds.Mul(x, None, 8))
+            asm_code.add(asm_cmds.Mov(spots.RAX, x, 8))
+            asm_code.add(asm_cmds.Sub(spots.RAX, spots.RDX, 8))
+            asm_code.add(asm_cmds.Shr(spots.RAX, _lit(1), 8, 1))
+            asm_code.add(asm_cmds.Add(spots.RAX, spots.RDX, 8))
+            asm_code.add(asm_cmds.Shr(spots.RAX, _lit(p - 65), 8, 1))
+            result, other = spots.RAX, spots.RDX
+
+        if self.return_reg == spots.RDX:
+            self._remainder(result, divisor, x, other, asm_code)
+        return result
+
+    def _remainder(self, quot, divisor, arg1_spot, temp, asm_code):
+        """Replace the quotient in `quot` with the remainder.
+
+        temp - a register which may be clobbered
+        """
+        size = self.arg1.ctype.size
+        d = _signed(divisor, 8 * size)
+        if ctypes.int_min <= d <= ctypes.int_max:
+            asm_code.add(asm_cmds.Imul(quot, _lit(d), size))
+        else:
+            asm_code.add(asm_cmds.Mov(temp, _lit(d), size))
+            asm_code.add(asm_cmds.Imul(quot, temp, size))
+        asm_code.add(asm_cmds.Neg(quot, None, size))
+        asm_code.add(asm_cmds.Add(quot, arg1_spot, size))
+
+
 class Div(_DivMod):
     """Divides given IL values.
 
@@ -287,9 +932,10 @@ class Mod(_DivMod):
 class _NegNot(ILCommand):
     """Base class for NEG and NOT."""
 
-    # The ASM instruction to generate for this command. Override this value
-    # in subclasses.
+    # The ASM instruction to generate for this command, and the Python
+    # function computing it. Override these values in subclasses.
     Inst = None
+    op = None
 
     def __init__(self, output, arg):  # noqa D102
         self.output = output
@@ -301,15 +947,41 @@ class _NegNot(ILCommand):
     def outputs(self):  # noqa D102
         return [self.output]
 
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "arg")
+
+    def replace_outputs(self, mapping):  # noqa D102
+        self._replace(mapping, "output")
+
     def rel_spot_pref(self):  # noqa D102
         return {self.output: [self.arg]}
 
+    def has_side_effects(self):  # noqa D102
+        return False
+
+    def evaluate(self, values):  # noqa D102
+        if self.arg in values:
+            return ctypes.in_range(self.op(values[self.arg]),
+                                  self.output.ctype)
+
     def make_asm(self, spotmap, home_spots, get_reg, asm_code): # noqa D102
         size = self.arg.ctype.size
 
         output_spot = spotmap[self.output]
         arg_spot = spotmap[self.arg]
 
+        # An output in memory in the spot of the argument is negated in
+        # place. One in another memory spot is computed in a register, since
+        # there is no move from memory to memory.
+        if (isinstance(output_spot, spots.MemSpot)
+              and output_spot != arg_spot):
+            r = get_reg([arg_spot])
+            if r != arg_spot:
+                asm_code.add(asm_cmds.Mov(r, arg_spot, size))
+            asm_code.add(self.Inst(r, None, size))
+            asm_code.add(asm_cmds.Mov(output_spot, r, size))
+            return
+
         if output_spot != arg_spot:
             asm_code.add(asm_cmds.Mov(output_spot, arg_spot, size))
         asm_code.add(self.Inst(output_spot, None, size))
@@ -323,6 +995,7 @@ class Neg(_NegNot):
     """
 
     Inst = asm_cmds.Neg
+    op = operator.neg
 
 
 class Not(_NegNot):
@@ -333,3 +1006,203 @@ class Not(_NegNot):
     """
 
     Inst = asm_cmds.Not
+    op = operator.invert
+
+
+class _BitCount(ILCommand):
+    """Base class for commands counting the bits of an integer.
+
+    The output is an int, and arg is an unsigned integer of 4 or 8 bytes.
+    The instruction of an x86-64 extension, like popcnt, is only used if
+    the extension is among asm_code.features, and otherwise the same is
+    computed with baseline instructions.
+    """
+
+    # The extension, the instruction computing this command with it, and
+    # the instruction computing it without. Override these values in
+    # subclasses.
+    feature = None
+    Native = None
+    Baseline = None
+
+    def __init__(self, output, arg):  # noqa D102
+        self.output = output
+        self.arg = arg
+
+    def inputs(self):  # noqa D102
+        return [self.arg]
+
+    def outputs(self):  # noqa D102
+        return [self.output]
+
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "arg")
+
+    def replace_outputs(self, mapping):  # noqa D102
+        self._replace(mapping, "output")
+
+    def has_side_effects(self):  # noqa D102
+        return False
+
+    def evaluate(self, values):  # noqa D102
+        if self.arg in values:
+            bits = self.arg.ctype.size * 8
+            return self._count(values[self.arg] % (1 << bits), bits)
+
+    def _count(self, val, bits):
+        """Return the result for an argument of `val`, or None if it is
+        undefined.
+        """
+        raise NotImplementedError
+
+    def make_asm(self, spotmap, home_spots, get_reg, asm_code):  # noqa D102
+        size = self.arg.ctype.size
+        out_spot = spotmap[self.output]
+        arg_spot = spotmap[self.arg]
+
+        # The result is computed into a register, from a register or memory.
+        r = get_reg([out_spot, arg_spot])
+        if isinstance(arg_spot, spots.LiteralSpot):
+            asm_code.add(asm_cmds.Mov(r, arg_spot, size))
+            arg_spot = r
+
+        if self.feature in asm_code.features:
+            asm_code.add(self.Native(r, arg_spot, size))
+        else:
+            self._baseline(r, arg_spot, size, get_reg, asm_code)
+        if r != out_spot:
+            asm_code.add(asm_cmds.Mov(out_spot, r, 4))
+
+    def _baseline(self, r, arg_spot, size, get_reg, asm_code):
+        """Emit code computing this command into `r` without the extension.
+        """
+        asm_code.add(self.Baseline(r, arg_spot, size))
+
+
+class PopCount(_BitCount):
+    """Counts the bits of arg which are set.
+
+    Without popcnt, the bits are counted by adding up the counts of ever
+    wider fields of the value, in registers, and then adding up the counts
+    of its bytes with a multiply.
+    """
+
+    feature = "popcnt"
+    Native = asm_cmds.Popcnt
+
+    def _count(self, val, bits):
+        return bin(val).count("1")
+
+    def _baseline(self, r, arg_spot, size, get_reg, asm_code):
+        t = get_reg([], [r, arg_spot])
+        k = get_reg([], [r, t, arg_spot])
+
+        def mask(byte):
+            return _lit(int.from_bytes(bytes([byte]) * size, "little"))
+
+        if r != arg_spot:
+            asm_code.add(asm_cmds.Mov(r, arg_spot, size))
+        for shift, byte in [(1, 0x55), (2, 0x33)]:
+            asm_code.add(asm_cmds.Mov(t, r, size))
+            asm_code.add(asm_cmds.Shr(t, _lit(shift), size, 1))
+            asm_code.add(asm_cmds.Mov(k, mask(byte), size))
+            asm_code.add(asm_cmds.And(t, k, size))
+            if shift == 1:
+                asm_code.add(asm_cmds.Sub(r, t, size))
+            else:
+                asm_code.add(asm_cmds.And(r, k, size))
+                asm_code.add(asm_cmds.Add(r, t, size))
+        asm_code.add(asm_cmds.Mov(t, r, size))
+        asm_code.add(asm_cmds.Shr(t, _lit(4), size, 1))
+        asm_code.add(asm_cmds.Add(r, t, size))
+        asm_code.add(asm_cmds.Mov(k, mask(0x0F), size))
+        asm_code.add(asm_cmds.And(r, k, size))
+        asm_code.add(asm_cmds.Mov(k, mask(0x01), size))
+        asm_code.add(asm_cmds.Imul(r, k, size))
+        asm_code.add(asm_cmds.Shr(r, _lit(size * 8 - 8), size, 1))
+
+
+class CountTrailingZeros(_BitCount):
+    """Counts the zero bits of arg below its lowest set bit.
+
+    The result is undefined if arg is zero. Without tzcnt, it is the index
+    bsf finds of the lowest set bit.
+    """
+
+    feature = "bmi"
+    Native = asm_cmds.Tzcnt
+    Baseline = asm_cmds.Bsf
+
+    def _count(self, val, bits):
+        return (val & -val).bit_length() - 1 if val else None
+
+
+class CountLeadingZeros(_BitCount):
+    """Counts the zero bits of arg above its highest set bit.
+
+    The result is undefined if arg is zero. Without lzcnt, it is the index
+    bsr finds of the highest set bit, subtracted from the width less one.
+    """
+
+    feature = "lzcnt"
+    Native = asm_cmds.Lzcnt
+    Baseline = asm_cmds.Bsr
+
+    def _count(self, val, bits):
+        return bits - val.bit_length() if val else None
+
+    def _baseline(self, r, arg_spot, size, get_reg, asm_code):
+        super()._baseline(r, arg_spot, size, get_reg, asm_code)
+        asm_code.add(asm_cmds.Xor(r, _lit(size * 8 - 1), size))
+
+
+class ByteSwap(ILCommand):
+    """Reverses the order of the bytes of arg, then saves to output.
+
+    IL values output and arg must have the same unsigned type, of 2, 4, or 8
+    bytes. Two bytes are swapped with a rotate by 8 bits.
+    """
+
+    def __init__(self, output, arg):  # noqa D102
+        self.output = output
+        self.arg = arg
+
+    def inputs(self):  # noqa D102
+        return [self.arg]
+
+    def outputs(self):  # noqa D102
+        return [self.output]
+
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "arg")
+
+    def replace_outputs(self, mapping):  # noqa D102
+        self._replace(mapping, "output")
+
+    def rel_spot_pref(self):  # noqa D102
+        return {self.output: [self.arg]}
+
+    def has_side_effects(self):  # noqa D102
+        return False
+
+    def evaluate(self, values):  # noqa D102
+        if self.arg in values:
+            size = self.arg.ctype.size
+            data = (values[self.arg] % (1 << size * 8)).to_bytes(size,
+                                                               "little")
+            return int.from_bytes(data, "big")
+
+    def make_asm(self, spotmap, home_spots, get_reg, asm_code):  # noqa D102
+        size = self.arg.ctype.size
+        out_spot = spotmap[self.output]
+        arg_spot = spotmap[self.arg]
+
+        r = get_reg([out_spot, arg_spot])
+        if r != arg_spot:
+            asm_code.add(asm_cmds.Mov(r, arg_spot, size))
+        if size == 2:
+            asm_code.add(asm_cmds.Rol(r, _lit(8), 2, 1))
+        else:
+            asm_code.add(asm_cmds.Bswap(r, None, size))
+        if r != out_spot:
+            asm_code.add(asm_cmds.Mov(out_spot, r, size))
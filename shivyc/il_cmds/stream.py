@@ -0,0 +1,113 @@
+"""IL commands for streaming through memory, made by __builtin_prefetch
+and __builtin_nontemporal_store.
+
+A Prefetch asks the processor to bring the memory at an address into the
+cache before it is accessed, and never faults, even if the address is not
+valid. A NontemporalStore writes memory around the cache, so that writing
+a large buffer which is not read again soon does not evict the data the
+program is working on.
+
+The optimizer sees a Prefetch as a read and a NontemporalStore as a write
+of the memory at their address, of any type, so that neither is moved
+across a store or load of memory it may access. Both have side effects, so
+neither is removed. The passes over the ASM code do not know the commands
+they emit, so the scheduler treats them as barriers.
+
+Stores around the cache are weakly ordered with other stores. ASMGen puts
+an sfence before each return and tail call of a function which makes any,
+so that the caller sees them in order with the stores it makes after.
+"""
+
+import shivyc.asm_cmds as asm_cmds
+from shivyc.il_cmds.base import ILCommand
+from shivyc.spots import MemSpot, RegSpot
+
+# The prefetch made for each degree of temporal locality, from 0 for data
+# which is used only once to 3 for data which should stay in every level of
+# the cache.
+prefetch_cmds = {0: asm_cmds.Prefetchnta, 1: asm_cmds.Prefetcht2,
+                 2: asm_cmds.Prefetcht1, 3: asm_cmds.Prefetcht0}
+
+
+def _memory(addr, spotmap, get_reg, conf, asm_code):
+    """Return the memory spot at `addr`, with the address in a register
+    which is not in `conf`.
+    """
+    spot = spotmap[addr]
+    if not isinstance(spot, RegSpot) or spot in conf:
+        r = get_reg([], conf)
+        asm_code.add(asm_cmds.Mov(r, spot, 8))
+        spot = r
+    return MemSpot(spot)
+
+
+class Prefetch(ILCommand):
+    """Prefetches the memory at `addr`.
+
+    locality (int) - Degree of temporal locality of the memory, a key of
+    `prefetch_cmds`.
+    """
+
+    def __init__(self, addr, locality):  # noqa D102
+        self.addr = addr
+        self.locality = locality
+
+    def inputs(self):  # noqa D102
+        return [self.addr]
+
+    def outputs(self):  # noqa D102
+        return []
+
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "addr")
+
+    def indir_read(self):  # noqa D102
+        return [self.addr]
+
+    def make_asm(self, spotmap, home_spots, get_reg, asm_code):  # noqa D102
+        mem = _memory(self.addr, spotmap, get_reg, [], asm_code)
+        asm_code.add(prefetch_cmds[self.locality](mem, None, 1))
+
+
+class NontemporalStore(ILCommand):
+    """Stores the integer or pointer `val` to the memory at `addr`, around
+    the cache.
+
+    A movnti only stores 4 or 8 bytes, so a narrower value is stored with a
+    plain mov.
+    """
+
+    def __init__(self, addr, val):  # noqa D102
+        self.addr = addr
+        self.val = val
+
+    def inputs(self):  # noqa D102
+        return [self.addr, self.val]
+
+    def outputs(self):  # noqa D102
+        return []
+
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "addr", "val")
+
+    def indir_write(self):  # noqa D102
+        return [self.addr]
+
+    def make_asm(self, spotmap, home_spots, get_reg, asm_code):  # noqa D102
+        size = self.val.ctype.size
+        val_spot = spotmap[self.val]
+        mem = _memory(self.addr, spotmap, get_reg, [val_spot], asm_code)
+
+        if size < 4:
+            if not (isinstance(val_spot, RegSpot) or self._is_imm(val_spot)):
+                r = get_reg([], [mem.base, val_spot])
+                asm_code.add(asm_cmds.Mov(r, val_spot, size))
+                val_spot = r
+            asm_code.add(asm_cmds.Mov(mem, val_spot, size))
+            return
+
+        if not isinstance(val_spot, RegSpot):
+            r = get_reg([], [mem.base, val_spot])
+            asm_code.add(asm_cmds.Mov(r, val_spot, size))
+            val_spot = r
+        asm_code.add(asm_cmds.Movnti(mem, val_spot, size))
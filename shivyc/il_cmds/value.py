@@ -1,10 +1,12 @@
 """IL commands for setting/reading values and getting value addresses."""
 
+import shivyc.abi as abi
 import shivyc.asm_cmds as asm_cmds
 import shivyc.ctypes as ctypes
 import shivyc.spots as spots
 from shivyc.il_cmds.base import ILCommand
-from shivyc.spots import RegSpot, MemSpot, LiteralSpot
+from shivyc.spots import (RegSpot, MemSpot, LiteralSpot, RipSpot, GOTSpot,
+                          XMMSpot)
 
 
 class _ValueCmd(ILCommand):
@@ -13,6 +15,25 @@ class _ValueCmd(ILCommand):
     This class defines a helper function for moving data from one location
     to another.
     """
+
+    # Copies of at least this many bytes are done with `rep movsb`. This
+    # needs RDI, RSI, and RCX, so commands which may do such a copy clobber
+    # those registers and keep their operands out of them.
+    rep_movsb_min = 256
+    rep_regs = [spots.RDI, spots.RSI, spots.RCX]
+
+    def _copy_regs(self, size):
+        """Return the registers a copy of `size` bytes needs to itself."""
+        return self.rep_regs if size >= self.rep_movsb_min else []
+
+    def _copy_conf(self, size):
+        """Return an abs_spot_conf keeping operands out of the copy registers.
+        """
+        regs = self._copy_regs(size)
+        if not regs:
+            return {}
+        return {v: regs for v in self.inputs() + self.outputs() if v}
+
     def move_data(self, target_spot, start_spot, size, reg, asm_code):
         """Emits code to move data from start to target.
 
@@ -27,24 +48,58 @@ class _ValueCmd(ILCommand):
         for `reg` to be one of these two, and in fact it is recommended
         that if either of target_spot or start_spot is a register then
         `reg` be equal to that.
+
+        Copies from memory to memory move 16 bytes at a time through XMM15,
+        or use `rep movsb` when there are at least rep_movsb_min bytes to
+        copy (in which case the caller must have reserved the registers
+        from _copy_regs). A tail smaller than the chunk size is copied with
+        one more chunk that overlaps the previous one, instead of with a
+        sequence of narrower moves.
+
+        If the start and target spots are the same, nothing is emitted.
         """
-        # TODO: consider padding everything to 8 bytes to reduce the
-        # number of mov operations emitted for struct copying.
-        shift = 0
-        while shift < size:
-            reg_size = self._reg_size(size - shift)
-            start_spot = start_spot.shift(shift)
-            target_spot = target_spot.shift(shift)
+        if start_spot == target_spot:
+            return
 
-            if isinstance(start_spot, LiteralSpot):
-                reg = start_spot
-            elif reg != start_spot:
-                asm_code.add(asm_cmds.Mov(reg, start_spot, reg_size))
+        if (not isinstance(start_spot, MemSpot)
+              or not isinstance(target_spot, MemSpot)):
+            self._move_chunks(target_spot, start_spot, size, reg,
+                              self._reg_size(size), asm_code)
+        elif size >= self.rep_movsb_min:
+            asm_code.add(asm_cmds.Lea(spots.RSI, start_spot))
+            asm_code.add(asm_cmds.Lea(spots.RDI, target_spot))
+            asm_code.add(asm_cmds.Mov(spots.RCX, LiteralSpot(size), 8))
+            asm_code.add(asm_cmds.RepMovsb())
+        elif size >= 16:
+            self._move_chunks(target_spot, start_spot, size, spots.XMM15,
+                              16, asm_code)
+        else:
+            self._move_chunks(target_spot, start_spot, size, reg,
+                              self._reg_size(size), asm_code)
+
+    def _move_chunks(self, target_spot, start_spot, size, reg, chunk,
+                     asm_code):
+        """Move `size` bytes in moves of `chunk` bytes through `reg`.
 
-            if reg != target_spot:
-                asm_code.add(asm_cmds.Mov(target_spot, reg, reg_size))
+        If `size` is not a multiple of `chunk`, the last move overlaps the
+        one before it. This requires both spots be in memory. A 64-bit
+        immediate can only be moved into a register, so one is moved into
+        memory through `reg`.
+        """
+        mov = asm_cmds.Movdqu if chunk == 16 else asm_cmds.Mov
+        for shift in _chunk_shifts(size, chunk):
+            start = start_spot.shift(shift)
+            target = target_spot.shift(shift)
 
-            shift += reg_size
+            if isinstance(start, LiteralSpot) and (
+                    not self._is_imm64(start)
+                    or isinstance(target, RegSpot)):
+                reg = start
+            elif reg != start:
+                asm_code.add(mov(reg, start, chunk))
+
+            if reg != target:
+                asm_code.add(mov(target, reg, chunk))
 
     def _reg_size(self, size):
         """Return largest register size that does not overfit given size."""
@@ -58,24 +113,33 @@ class LoadArg(ILCommand):
     """Loads a function argument value into an IL value.
 
     output is the IL value to load the function argument value into,
-    and arg_num is the index of the argument to load. For example,
-    at the start of the body of the following function:
+    arg_num is the index of the argument to load, and func_ctype is the type
+    of the function. For example, at the start of the body of the following
+    function:
 
        int func(int a, int b);
 
     the following two LoadArg commands would be appropriate
 
-       LoadArg(a, 0)
-       LoadArg(b, 1)
+       LoadArg(a, 0, func_ctype)
+       LoadArg(b, 1, func_ctype)
 
     in order to load the first function argument into the variable a and
-    the second function argument into the variable b.
+    the second function argument into the variable b. If the function
+    returns a struct or union in memory, LoadArg(addr, None, func_ctype)
+    loads the address the caller passed to store the value at. The
+    arguments are passed as described in shivyc.abi.
     """
-    arg_regs = [spots.RDI, spots.RSI, spots.RDX, spots.RCX, spots.R8, spots.R9]
 
-    def __init__(self, output, arg_num):
+    def __init__(self, output, arg_num, func_ctype):
         self.output = output
-        self.arg_reg = self.arg_regs[arg_num]
+        self.arg_num = arg_num
+
+        if arg_num is None:
+            self.location = abi.ArgLocation([spots.RDI])
+        else:
+            locations, _ = abi.arg_locations(func_ctype.args, func_ctype.ret)
+            self.location = locations[arg_num]
 
     def inputs(self):
         return []
@@ -83,18 +147,40 @@ class LoadArg(ILCommand):
     def outputs(self):
         return [self.output]
 
+    def replace_outputs(self, mapping):
+        self._replace(mapping, "output")
+
     def clobber(self):
-        return [self.arg_reg]
+        return self.location.regs
 
     def abs_spot_pref(self):
-        return {self.output: [self.arg_reg]}
+        if len(self.location.regs) == 1:
+            return {self.output: self.location.regs}
+        return {}
+
+    def has_side_effects(self):
+        return False
 
     def make_asm(self, spotmap, home_spots, get_reg, asm_code):
-        if spotmap[self.output] == self.arg_reg:
+        spot = spotmap[self.output]
+        parts = abi.parts(self.output.ctype)
+        if self.location.regs:
+            for reg, (shift, size) in zip(self.location.regs, parts):
+                abi.store_part(spot.shift(shift), reg, size, asm_code)
             return
-        else:
-            asm_code.add(asm_cmds.Mov(
-                spotmap[self.output], self.arg_reg, self.output.ctype.size))
+
+        # Arguments on the stack are above the return address and the saved
+        # RBP. The argument registers may still hold arguments not loaded
+        # yet, so none of them is used as a scratch register.
+        start = MemSpot(spots.RBP, 16 + self.location.offset)
+        if isinstance(spot, (RegSpot, XMMSpot)):
+            asm_code.add(asm_cmds.Mov(spot, start, self.output.ctype.size))
+            return
+
+        r = get_reg([], abi.arg_regs)
+        for shift, size in parts:
+            asm_code.add(asm_cmds.Mov(r, start.shift(shift), 8))
+            abi.store_part(spot.shift(shift), r, size, asm_code)
 
 
 class Set(_ValueCmd):
@@ -116,6 +202,12 @@ class Set(_ValueCmd):
     def outputs(self): # noqa D102
         return [self.output]
 
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "arg")
+
+    def replace_outputs(self, mapping):  # noqa D102
+        self._replace(mapping, "output")
+
     def rel_spot_pref(self): # noqa D102
         if self.output.ctype.weak_compat(ctypes.bool_t):
             return {}
@@ -128,6 +220,40 @@ class Set(_ValueCmd):
         else:
             return {}
 
+    def copy_of(self):  # noqa D102
+        if (self.output.ctype.weak_compat(ctypes.bool_t)
+              or self.output.ctype.size != self.arg.ctype.size
+              or self.output.ctype.is_floating()
+              != self.arg.ctype.is_floating()):
+            return None
+        return self.arg
+
+    def has_side_effects(self):  # noqa D102
+        return False
+
+    def rematerializable(self):  # noqa D102
+        return (self.arg.literal is not None
+                and self.output.ctype.is_scalar()
+                and not self.output.ctype.is_floating()
+                and not self.arg.ctype.is_floating())
+
+    def evaluate(self, values):  # noqa D102
+        if self.arg not in values or not self.output.ctype.is_scalar():
+            return None
+        elif self.output.ctype.weak_compat(ctypes.bool_t):
+            return int(values[self.arg] != 0)
+        else:
+            return ctypes.in_range(values[self.arg], self.output.ctype)
+
+    def simplify(self, values):  # noqa D102
+        return self._same_type(self.arg)
+
+    def clobber(self):  # noqa D102
+        return self._copy_regs(self.output.ctype.size)
+
+    def abs_spot_conf(self):  # noqa D102
+        return self._copy_conf(self.output.ctype.size)
+
     def make_asm(self, spotmap, home_spots, get_reg, asm_code): # noqa D102
         if self.output.ctype.weak_compat(ctypes.bool_t):
             return self._set_bool(spotmap, get_reg, asm_code)
@@ -136,18 +262,24 @@ class Set(_ValueCmd):
             out_spot = spotmap[self.output]
             arg_spot = spotmap[self.arg]
             size = self.output.ctype.size
+
+            # A 64-bit immediate can only be moved into a register.
+            if self._is_imm64(arg_spot) and not isinstance(out_spot, RegSpot):
+                r = get_reg()
+                asm_code.add(asm_cmds.Mov(r, arg_spot, size))
+                arg_spot = r
             asm_code.add(asm_cmds.Mov(out_spot, arg_spot, size))
 
         elif self.output.ctype.size <= self.arg.ctype.size:
             if spotmap[self.output] == spotmap[self.arg]:
                 return
 
-            if isinstance(spotmap[self.output], RegSpot):
+            if isinstance(spotmap[self.output], (RegSpot, XMMSpot)):
                 r = spotmap[self.output]
-            elif isinstance(spotmap[self.arg], RegSpot):
+            elif isinstance(spotmap[self.arg], (RegSpot, XMMSpot)):
                 r = spotmap[self.arg]
             else:
-                r = get_reg()
+                r = get_reg([], self._copy_regs(self.output.ctype.size))
 
             self.move_data(spotmap[self.output], spotmap[self.arg],
                            self.output.ctype.size, r, asm_code)
@@ -175,29 +307,17 @@ class Set(_ValueCmd):
     def _set_bool(self, spotmap, get_reg, asm_code):
         """Emit code for SET command if arg is boolean type."""
         # When any scalar value is converted to _Bool, the result is 0 if the
-        # value compares equal to 0; otherwise, the result is 1
-
-        # If arg_asm is a LITERAL or conflicts with output, move to register.
-        if (isinstance(spotmap[self.arg], LiteralSpot)
-              or spotmap[self.arg] == spotmap[self.output]):
-            r = get_reg([], [spotmap[self.output]])
-            asm_code.add(
-                asm_cmds.Mov(r, spotmap[self.arg], self.arg.ctype.size))
-            arg_spot = r
-        else:
-            arg_spot = spotmap[self.arg]
-
-        label = asm_code.get_label()
+        # value compares equal to 0; otherwise, the result is 1. The result
+        # is set from the flags, without a branch.
+        arg_spot = spotmap[self.arg]
         output_spot = spotmap[self.output]
+        if isinstance(arg_spot, LiteralSpot):
+            value = LiteralSpot(int(bool(int(arg_spot.value))))
+            asm_code.add(asm_cmds.Mov(output_spot, value, 1))
+            return
 
-        zero = LiteralSpot("0")
-        one = LiteralSpot("1")
-
-        asm_code.add(asm_cmds.Mov(output_spot, zero, self.output.ctype.size))
-        asm_code.add(asm_cmds.Cmp(arg_spot, zero, self.arg.ctype.size))
-        asm_code.add(asm_cmds.Je(label))
-        asm_code.add(asm_cmds.Mov(output_spot, one, self.output.ctype.size))
-        asm_code.add(asm_cmds.Label(label))
+        self._cmp_zero(arg_spot, self.arg.ctype.size, asm_code)
+        asm_code.add(asm_cmds.Setcc(asm_cmds.Jne, output_spot))
 
 
 class AddrOf(ILCommand):
@@ -217,12 +337,29 @@ class AddrOf(ILCommand):
     def outputs(self):  # noqa D102
         return [self.output]
 
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "var")
+
+    def replace_outputs(self, mapping):  # noqa D102
+        self._replace(mapping, "output")
+
     def references(self):  # noqa D102
         return {self.output: [self.var]}
 
+    def has_side_effects(self):  # noqa D102
+        return False
+
+    def rematerializable(self):  # noqa D102
+        return True
+
     def make_asm(self, spotmap, home_spots, get_reg, asm_code):  # noqa D102
+        # The address of a value reached through the global offset table is
+        # loaded from its entry.
         r = get_reg([spotmap[self.output]])
-        asm_code.add(asm_cmds.Lea(r, home_spots[self.var]))
+        if isinstance(home_spots[self.var], GOTSpot):
+            asm_code.add(asm_cmds.Mov(r, home_spots[self.var], 8))
+        else:
+            asm_code.add(asm_cmds.Lea(r, home_spots[self.var]))
 
         if r != spotmap[self.output]:
             size = self.output.ctype.size
@@ -232,38 +369,55 @@ class AddrOf(ILCommand):
 class ReadAt(_ValueCmd):
     """Reads value at given address.
 
-    `addr` must have type pointer to the type of `output`
-
+    `addr` must have type pointer to the type of `output`. The value read
+    is at `addr` plus `offset` bytes plus, if `index` is given, the 64-bit
+    integral ILValue `index` times `factor`, where factor is in
+    {1, 2, 4, 8}. The address is computed by the addressing mode of the
+    move, like [rax+rdx*4+8].
     """
 
-    def __init__(self, output, addr):  # noqa D102
+    def __init__(self, output, addr, offset=0, index=None,
+                 factor=1):  # noqa D102
         self.output = output
         self.addr = addr
+        self.offset = offset
+        self.index = index
+        self.factor = factor
 
     def inputs(self):  # noqa D102
-        return [self.addr]
+        return [self.addr, self.index] if self.index else [self.addr]
 
     def outputs(self):  # noqa D102
         return [self.output]
 
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "addr", "index")
+
+    def replace_outputs(self, mapping):  # noqa D102
+        self._replace(mapping, "output")
+
     def indir_read(self):  # noqa D102
         return [self.addr]
 
+    def has_side_effects(self):  # noqa D102
+        return False
+
+    def clobber(self):  # noqa D102
+        return self._copy_regs(self.output.ctype.size)
+
+    def abs_spot_conf(self):  # noqa D102
+        return self._copy_conf(self.output.ctype.size)
+
     def make_asm(self, spotmap, home_spots, get_reg, asm_code):  # noqa D102
-        addr_spot = spotmap[self.addr]
         output_spot = spotmap[self.output]
+        copy_regs = self._copy_regs(self.output.ctype.size)
 
-        if isinstance(addr_spot, RegSpot):
-            addr_r = addr_spot
-        else:
-            addr_r = get_reg([], [output_spot])
-            asm_code.add(asm_cmds.Mov(addr_r, addr_spot, 8))
-
-        indir_spot = MemSpot(addr_r)
-        if isinstance(output_spot, RegSpot):
+        indir_spot, regs = _indir_spot(self, spotmap, get_reg,
+                                       [output_spot] + copy_regs, asm_code)
+        if isinstance(output_spot, (RegSpot, XMMSpot)):
             temp_reg = output_spot
         else:
-            temp_reg = get_reg([], [addr_r])
+            temp_reg = get_reg([], regs + copy_regs)
 
         self.move_data(output_spot, indir_spot, self.output.ctype.size,
                        temp_reg, asm_code)
@@ -272,43 +426,240 @@ class ReadAt(_ValueCmd):
 class SetAt(_ValueCmd):
     """Sets value at given address.
 
-    `addr` must have type pointer to the type of `val`
-
+    `addr` must have type pointer to the type of `val`. The address set is
+    computed from `addr`, `offset`, `index`, and `factor` as for ReadAt.
     """
 
-    def __init__(self, addr, val):  # noqa D102
+    def __init__(self, addr, val, offset=0, index=None,
+                 factor=1):  # noqa D102
         self.addr = addr
         self.val = val
+        self.offset = offset
+        self.index = index
+        self.factor = factor
 
     def inputs(self):  # noqa D102
+        if self.index:
+            return [self.addr, self.val, self.index]
         return [self.addr, self.val]
 
     def outputs(self):  # noqa D102
         return []
 
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "addr", "val", "index")
+
     def indir_write(self):  # noqa D102
         return [self.addr]
 
+    def clobber(self):  # noqa D102
+        return self._copy_regs(self.val.ctype.size)
+
+    def abs_spot_conf(self):  # noqa D102
+        return self._copy_conf(self.val.ctype.size)
+
     def make_asm(self, spotmap, home_spots, get_reg, asm_code):  # noqa D102
-        addr_spot = spotmap[self.addr]
         value_spot = spotmap[self.val]
+        copy_regs = self._copy_regs(self.val.ctype.size)
 
-        if isinstance(addr_spot, RegSpot):
-            addr_r = addr_spot
-        else:
-            addr_r = get_reg([], [value_spot])
-            asm_code.add(asm_cmds.Mov(addr_r, addr_spot, 8))
-
-        indir_spot = MemSpot(addr_r)
-        if isinstance(value_spot, RegSpot):
+        indir_spot, regs = _indir_spot(self, spotmap, get_reg,
+                                       [value_spot] + copy_regs, asm_code)
+        if isinstance(value_spot, (RegSpot, XMMSpot)):
             temp_reg = value_spot
         else:
-            temp_reg = get_reg([], [addr_r])
+            temp_reg = get_reg([], regs + copy_regs)
 
         self.move_data(indir_spot, value_spot, self.val.ctype.size,
                        temp_reg, asm_code)
 
 
+class CopyAt(_ValueCmd):
+    """Copies `size` bytes from the memory at `source` to that at `dest`.
+
+    This is a call of memcpy or memmove with a literal size, copied as a
+    struct is. With `overlap`, as for memmove, the bytes may overlap, so
+    every byte is read before any is written. That takes the bytes in at
+    most two registers, so the size must be at most overlap_max.
+    """
+
+    # Most bytes copied by a call of memcpy with a literal size which are
+    # copied inline, and most copied by a call of memmove.
+    inline_max = 128
+    overlap_max = 32
+
+    def __init__(self, dest, source, size, overlap=False):  # noqa D102
+        self.dest = dest
+        self.source = source
+        self.size = size
+        self.overlap = overlap
+
+    def inputs(self):  # noqa D102
+        return [self.dest, self.source]
+
+    def outputs(self):  # noqa D102
+        return []
+
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "dest", "source")
+
+    def indir_write(self):  # noqa D102
+        return [self.dest]
+
+    def indir_read(self):  # noqa D102
+        return [self.source]
+
+    def make_asm(self, spotmap, home_spots, get_reg, asm_code):  # noqa D102
+        regs = _addr_regs(self.inputs(), spotmap, get_reg, asm_code)
+        dest, source = (MemSpot(r) for r in regs)
+        if not self.overlap:
+            self.move_data(dest, source, self.size, get_reg([], regs),
+                           asm_code)
+            return
+
+        if self.size >= 16:
+            chunk, temps = 16, spots.xmm_registers[14:16]
+        else:
+            chunk = self._reg_size(self.size)
+            temps = [get_reg([], regs)]
+            temps.append(get_reg([], regs + temps))
+
+        mov = asm_cmds.Movdqu if chunk == 16 else asm_cmds.Mov
+        shifts = _chunk_shifts(self.size, chunk)
+        for shift, temp in zip(shifts, temps):
+            asm_code.add(mov(temp, source.shift(shift), chunk))
+        for shift, temp in zip(shifts, temps):
+            asm_code.add(mov(dest.shift(shift), temp, chunk))
+
+
+class FillAt(_ValueCmd):
+    """Sets each of `size` bytes at `dest` to the low byte of `val`.
+
+    This is a call of memset with a literal size of at most inline_max. The
+    byte is repeated across a register, or across XMM15 for 16-byte
+    stores, and a tail shorter than the stores is set with one more store
+    overlapping the one before it.
+    """
+
+    inline_max = 128
+
+    def __init__(self, dest, val, size):  # noqa D102
+        self.dest = dest
+        self.val = val
+        self.size = size
+
+    def inputs(self):  # noqa D102
+        return [self.dest, self.val]
+
+    def outputs(self):  # noqa D102
+        return []
+
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "dest", "val")
+
+    def indir_write(self):  # noqa D102
+        return [self.dest]
+
+    def make_asm(self, spotmap, home_spots, get_reg, asm_code):  # noqa D102
+        regs = _addr_regs([self.dest], spotmap, get_reg, asm_code)
+        dest = MemSpot(regs[0])
+        chunk = 16 if self.size >= 16 else self._reg_size(self.size)
+        width = min(chunk, 8)
+
+        val_spot = spotmap[self.val]
+        conf = regs + [val_spot]
+        if isinstance(val_spot, LiteralSpot):
+            byte = int(val_spot.value) & 0xFF
+            pattern = int.from_bytes([byte] * width, "little", signed=True)
+            if width < 8 or byte in {0, 0xFF}:
+                # The pattern fits in an immediate, which is sign-extended.
+                fill = LiteralSpot(pattern)
+            else:
+                fill = get_reg([], conf)
+                asm_code.add(asm_cmds.Mov(fill, LiteralSpot(pattern), 8))
+        else:
+            fill = get_reg([], conf)
+            asm_code.add(asm_cmds.Movzx(fill, val_spot, 4, 1))
+            if width > 1:
+                ones = get_reg([], conf + [fill])
+                pattern = int.from_bytes([1] * width, "little")
+                asm_code.add(asm_cmds.Mov(ones, LiteralSpot(pattern), 8))
+                asm_code.add(asm_cmds.Imul(fill, ones, 8))
+
+        if chunk == 16:
+            vec = spots.XMM15
+            if fill == LiteralSpot(0):
+                asm_code.add(asm_cmds.Pxor(vec, vec))
+            else:
+                if isinstance(fill, LiteralSpot):
+                    r = get_reg([], conf)
+                    asm_code.add(asm_cmds.Mov(r, fill, 8))
+                    fill = r
+                asm_code.add(asm_cmds.Movd(vec, fill, 8))
+                asm_code.add(asm_cmds.Punpcklqdq(vec, vec))
+            fill = vec
+
+        mov = asm_cmds.Movdqu if chunk == 16 else asm_cmds.Mov
+        for shift in _chunk_shifts(self.size, chunk):
+            asm_code.add(mov(dest.shift(shift), fill, chunk))
+
+
+def _chunk_shifts(size, chunk):
+    """Return the offsets of the moves of `chunk` bytes covering `size`.
+
+    If `size` is not a multiple of `chunk`, the last move overlaps the one
+    before it.
+    """
+    shifts = list(range(0, size - chunk + 1, chunk))
+    if shifts[-1] + chunk < size:
+        shifts.append(size - chunk)
+    return shifts
+
+
+def _addr_regs(addrs, spotmap, get_reg, asm_code):
+    """Return registers holding the given addresses.
+
+    Each address not in a register already is moved into one which holds
+    none of the others.
+    """
+    conf = [spotmap[v] for v in addrs]
+    regs = []
+    for addr in addrs:
+        spot = spotmap[addr]
+        if not isinstance(spot, RegSpot):
+            r = get_reg([], conf + regs)
+            asm_code.add(asm_cmds.Mov(r, spot, 8))
+            spot = r
+        regs.append(spot)
+    return regs
+
+
+def _indir_spot(command, spotmap, get_reg, conf, asm_code):
+    """Return the memory spot addressed by a ReadAt or SetAt command.
+
+    The address and index are moved into registers which are not in
+    `conf`, if they are not in registers already.
+
+    returns - the memory spot, and the list of registers it uses
+    """
+    values = [command.addr, command.index]
+    conf = conf + [spotmap[v] for v in values if v]
+
+    regs = []
+    for value in values:
+        spot = spotmap[value] if value else None
+        if value and not isinstance(spot, RegSpot):
+            r = get_reg([], conf + regs)
+            asm_code.add(asm_cmds.Mov(r, spot, 8))
+            spot = r
+        regs.append(spot)
+
+    addr_r, index_r = regs
+    if index_r:
+        spot = MemSpot(addr_r, command.offset, command.factor, index_r)
+        return spot, [addr_r, index_r]
+    return MemSpot(addr_r, command.offset), [addr_r]
+
+
 class _RelCommand(_ValueCmd):
     """Parent class for the relative commands."""
 
@@ -319,15 +670,33 @@ class _RelCommand(_ValueCmd):
         self.count = count
 
         # Keep track of which registers have been used from a call to
-        # get_reg so we don't accidentally reuse them.
-        self._used_regs = []
+        # get_reg so we don't accidentally reuse them. A large copy also
+        # needs the copy registers to itself.
+        self._used_regs = self._copy_regs(val.ctype.size)[:]
+
+    def __copy__(self):
+        """Return a copy of this command with its own list of used registers.
+
+        Optimization passes copy commands when duplicating code.
+        """
+        new = self.__class__.__new__(self.__class__)
+        new.__dict__.update(self.__dict__)
+        new._used_regs = self._used_regs[:]
+        return new
+
+    def clobber(self):  # noqa D102
+        return self._copy_regs(self.val.ctype.size)
+
+    def abs_spot_conf(self):  # noqa D102
+        return self._copy_conf(self.val.ctype.size)
 
     def get_rel_spot(self, spotmap, get_reg, asm_code):
         """Get a relative spot for the relative value."""
+        base_spot = self._get_base_spot(spotmap, get_reg, asm_code)
 
         # If there's no count, we only need to shift by the chunk
         if not self.count:
-            return spotmap[self.base].shift(self.chunk)
+            return base_spot.shift(self.chunk)
 
         # If there is a count in a literal spot, we're good to go. Also,
         # if count is already in a register, we're good to go by just using
@@ -336,7 +705,7 @@ class _RelCommand(_ValueCmd):
         # count).
         if (isinstance(spotmap[self.count], LiteralSpot) or
              isinstance(spotmap[self.count], RegSpot)):
-            return spotmap[self.base].shift(self.chunk, spotmap[self.count])
+            return base_spot.shift(self.chunk, spotmap[self.count])
 
         # Otherwise, move count to a register.
         r = get_reg([], [spotmap[self.val]] + self._used_regs)
@@ -345,16 +714,45 @@ class _RelCommand(_ValueCmd):
         count_size = self.count.ctype.size
         asm_code.add(asm_cmds.Mov(r, spotmap[self.count], count_size))
 
-        return spotmap[self.base].shift(self.chunk, r)
+        return base_spot.shift(self.chunk, r)
+
+    def _get_base_spot(self, spotmap, get_reg, asm_code):
+        """Get the spot of the base object to shift.
+
+        The address of a base reached through the global offset table, or
+        relative to RIP with a count in a register, is loaded into a
+        register first.
+        """
+        base_spot = spotmap[self.base]
+        count_spot = spotmap[self.count] if self.count else None
+        through_got = isinstance(base_spot, GOTSpot)
+        indexed = (isinstance(base_spot, RipSpot) and count_spot
+                   and not isinstance(count_spot, LiteralSpot))
+        if not through_got and not indexed:
+            return base_spot
+
+        conf = [spotmap.get(self.val), count_spot] + self.clobber()
+        r = get_reg([], conf + self._used_regs)
+        self._used_regs.append(r)
+        if through_got:
+            asm_code.add(asm_cmds.Mov(r, base_spot, 8))
+        else:
+            asm_code.add(asm_cmds.Lea(r, base_spot))
+        return MemSpot(r)
 
     def get_reg_spot(self, reg_val, spotmap, get_reg):
-        """Get a register or literal spot for self.reg_val."""
+        """Get a register or literal spot for self.reg_val.
 
-        if (isinstance(spotmap[reg_val], LiteralSpot) or
-             isinstance(spotmap[reg_val], RegSpot)):
-            return spotmap[reg_val]
+        A 64-bit literal gets a register, since it cannot be moved into
+        memory directly.
+        """
+        spot = spotmap[reg_val]
+        if isinstance(spot, (RegSpot, XMMSpot)) or (
+                isinstance(spot, LiteralSpot) and not self._is_imm64(spot)):
+            return spot
 
-        val_spot = get_reg([], [spotmap[self.count]] + self._used_regs)
+        count_spots = [spotmap[self.count]] if self.count else []
+        val_spot = get_reg([], count_spots + self._used_regs)
         self._used_regs.append(val_spot)
         return val_spot
 
@@ -397,6 +795,9 @@ class SetRel(_RelCommand):
     def outputs(self):  # noqa D102
         return []
 
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "val", "base", "count")
+
     def references(self):  # noqa D102
         return {None: [self.base]}
 
@@ -411,6 +812,78 @@ class SetRel(_RelCommand):
         self.move_data(rel_spot, spotmap[self.val], val_size, reg, asm_code)
 
 
+class ZeroRel(SetRel):
+    """Sets `size` bytes at a location relative to given object to zero.
+
+    base - ILValue representing the base object, which is in memory.
+
+    chunk - A Python integer representing the offset in bytes of the
+    location from the start of `base`.
+
+    size - A Python integer representing the number of bytes set.
+
+    This is a SetRel which stores no value, so passes which track the
+    writes of SetRel commands see it as one. Runs of at least
+    rep_stosq_min bytes are zeroed with `rep stosq`, which needs RDI, RCX,
+    and RAX, and shorter runs with 16-byte stores of the zeroed XMM15 or
+    with immediate stores. A tail shorter than the stores is zeroed with
+    one more store overlapping the one before it.
+    """
+
+    rep_stosq_min = 256
+    rep_stosq_regs = [spots.RDI, spots.RCX, spots.RAX]
+
+    def __init__(self, base, chunk, size):  # noqa D102
+        self.val = None
+        self.base = base
+        self.chunk = chunk
+        self.count = None
+        self.size = size
+        self._used_regs = []
+
+    def inputs(self):  # noqa D102
+        return [self.base]
+
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "base")
+
+    def clobber(self):  # noqa D102
+        return self.rep_stosq_regs if self._use_rep() else []
+
+    def abs_spot_conf(self):  # noqa D102
+        return {}
+
+    def _use_rep(self):
+        """Return whether the bytes are zeroed with `rep stosq`."""
+        return self.size >= self.rep_stosq_min
+
+    def make_asm(self, spotmap, home_spots, get_reg, asm_code):  # noqa D102
+        if not isinstance(spotmap[self.base], MemSpot):
+            raise NotImplementedError("expected base in memory spot")
+
+        spot = self.get_rel_spot(spotmap, get_reg, asm_code)
+        if self._use_rep():
+            asm_code.add(asm_cmds.Lea(spots.RDI, spot))
+            asm_code.add(asm_cmds.Xor(spots.RAX, spots.RAX, 4))
+            asm_code.add(asm_cmds.Mov(spots.RCX, LiteralSpot(self.size // 8),
+                                      4))
+            asm_code.add(asm_cmds.RepStosq())
+            if self.size % 8:
+                asm_code.add(asm_cmds.Mov(spot.shift(self.size - 8),
+                                          spots.RAX, 8))
+            return
+
+        if self.size >= 16:
+            zero, chunk = spots.XMM15, 16
+            asm_code.add(asm_cmds.Pxor(zero, zero))
+        else:
+            zero, chunk = LiteralSpot(0), self._reg_size(self.size)
+
+        mov = asm_cmds.Movdqu if chunk == 16 else asm_cmds.Mov
+        for shift in _chunk_shifts(self.size, chunk):
+            asm_code.add(mov(spot.shift(shift), zero, chunk))
+
+
 class AddrRel(_RelCommand):
     """Gets the address of a location relative to a given object.
 
@@ -427,9 +900,22 @@ class AddrRel(_RelCommand):
     def outputs(self):  # noqa D102
         return [self.output]
 
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "base", "count")
+
+    def replace_outputs(self, mapping):  # noqa D102
+        # The output is also stored as self.val by _RelCommand.
+        self._replace(mapping, "output", "val")
+
     def references(self):  # noqa D102
         return {self.output: [self.base]}
 
+    def has_side_effects(self):  # noqa D102
+        return False
+
+    def rematerializable(self):  # noqa D102
+        return self.count is None
+
     def make_asm(self, spotmap, home_spots, get_reg, asm_code):  # noqa D102
         if not isinstance(spotmap[self.base], MemSpot):
             raise NotImplementedError("expected base in memory spot")
@@ -459,9 +945,19 @@ class ReadRel(_RelCommand):
     def outputs(self):  # noqa D102
         return [self.output]
 
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "base", "count")
+
+    def replace_outputs(self, mapping):  # noqa D102
+        # The output is also stored as self.val by _RelCommand.
+        self._replace(mapping, "output", "val")
+
     def references(self):  # noqa D102
         return {None: [self.base]}
 
+    def has_side_effects(self):  # noqa D102
+        return False
+
     def make_asm(self, spotmap, home_spots, get_reg, asm_code):  # noqa D102
         if not isinstance(spotmap[self.base], MemSpot):
             raise NotImplementedError("expected base in memory spot")
@@ -471,3 +967,39 @@ class ReadRel(_RelCommand):
 
         out_size = self.output.ctype.size
         self.move_data(spotmap[self.output], rel_spot, out_size, reg, asm_code)
+
+
+class Phi(ILCommand):
+    """Selects a value according to the block control arrived from.
+
+    output - ILValue to set.
+    args - Dictionary mapping the label of each predecessor block to the
+    ILValue to set `output` to when control arrives from that block.
+
+    Phi commands only exist while the IL is in SSA form, and appear at the
+    start of a block immediately after its label. See shivyc.opt.ssa. They
+    are replaced by copies before code generation.
+    """
+
+    def __init__(self, output, args):  # noqa D102
+        self.output = output
+        self.args = args
+
+    def inputs(self):  # noqa D102
+        return list(self.args.values())
+
+    def outputs(self):  # noqa D102
+        return [self.output]
+
+    def replace_inputs(self, mapping):  # noqa D102
+        self.args = {label: mapping.get(v, v)
+                     for label, v in self.args.items()}
+
+    def has_side_effects(self):  # noqa D102
+        return False
+
+    def replace_outputs(self, mapping):  # noqa D102
+        self._replace(mapping, "output")
+
+    def make_asm(self, spotmap, home_spots, get_reg, asm_code):  # noqa D102
+        raise NotImplementedError("phi command reached code generation")
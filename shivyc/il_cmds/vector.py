@@ -0,0 +1,248 @@
+"""IL commands on vectors of integers, made by the loop vectorizer.
+
+A vector is 16 bytes, the size of an SSE register, or 32 bytes, the size of
+an AVX register, and is split into lanes of 1, 2, 4, or 8 bytes each. The
+register allocator only gives SSE registers to floating values, so a vector
+ILValue is an array kept in memory, and each command works in vector
+registers of its own: a VectorBody clobbers the SSE registers floating
+values are allocated to, and the others use only the scratch XMM15.
+
+AVX commands leave the upper halves of the registers they write in use,
+which makes any later SSE command, like those of the C library, slow. Each
+command on 32-byte vectors therefore ends with a vzeroupper.
+"""
+
+import shivyc.asm_cmds as asm_cmds
+import shivyc.spots as spots
+from shivyc.il_cmds.base import ILCommand
+from shivyc.spots import LiteralSpot, MemSpot, RegSpot
+
+# The ASM command of each operation on lanes of each width.
+packed_cmds = {("add", 1): asm_cmds.Paddb, ("add", 2): asm_cmds.Paddw,
+               ("add", 4): asm_cmds.Paddd, ("add", 8): asm_cmds.Paddq,
+               ("sub", 1): asm_cmds.Psubb, ("sub", 2): asm_cmds.Psubw,
+               ("sub", 4): asm_cmds.Psubd, ("sub", 8): asm_cmds.Psubq,
+               ("mul", 2): asm_cmds.Pmullw, ("mul", 4): asm_cmds.Pmulld}
+
+# Operations which may be done on lanes of each width with vectors of each
+# size. SSE2 has no multiply of 4-byte lanes.
+supported = {16: {key for key in packed_cmds if key != ("mul", 4)},
+             32: set(packed_cmds)}
+
+# Registers the vectors of a VectorBody are computed in. XMM15 is kept for
+# operands loaded from memory.
+vector_regs = spots.xmm_registers[:15]
+
+
+class VectorSplat(ILCommand):
+    """Sets each lane of the vector `output` to the integer `arg`.
+
+    The lanes are `width` bytes each, and are set to the low bytes of `arg`,
+    which is at least as wide.
+    """
+
+    def __init__(self, output, arg, width):  # noqa D102
+        self.output = output
+        self.arg = arg
+        self.width = width
+
+    def inputs(self):  # noqa D102
+        return [self.arg]
+
+    def outputs(self):  # noqa D102
+        return [self.output]
+
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "arg")
+
+    def replace_outputs(self, mapping):  # noqa D102
+        self._replace(mapping, "output")
+
+    def has_side_effects(self):  # noqa D102
+        return False
+
+    def make_asm(self, spotmap, home_spots, get_reg, asm_code):  # noqa D102
+        size = self.output.ctype.size
+        arg_spot = spotmap[self.arg]
+        arg_size = self.arg.ctype.size
+        move_size = 8 if self.width == 8 else 4
+        vec = spots.XMM15
+
+        # A movd from memory reads 4 bytes, so a narrower integer is first
+        # extended into a register.
+        if isinstance(arg_spot, LiteralSpot):
+            r = get_reg([], [])
+            asm_code.add(asm_cmds.Mov(r, arg_spot, move_size))
+            arg_spot = r
+        elif not isinstance(arg_spot, RegSpot) and arg_size < 4:
+            r = get_reg([], [])
+            asm_code.add(asm_cmds.Movzx(r, arg_spot, 4, arg_size))
+            arg_spot = r
+        asm_code.add(asm_cmds.Movd(vec, arg_spot, move_size))
+
+        if size == 32:
+            asm_code.add(asm_cmds.Vpbroadcast(vec, vec, self.width))
+        elif self.width == 8:
+            asm_code.add(asm_cmds.Punpcklqdq(vec, vec))
+        else:
+            if self.width == 1:
+                asm_code.add(asm_cmds.Punpcklbw(vec, vec))
+            if self.width <= 2:
+                asm_code.add(asm_cmds.Punpcklwd(vec, vec))
+            asm_code.add(asm_cmds.Pshufd(vec, vec, imm=0))
+
+        asm_code.add(asm_cmds.Movdqu(spotmap[self.output], vec, size))
+        if size == 32:
+            asm_code.add(asm_cmds.Vzeroupper())
+
+
+class VectorBody(ILCommand):
+    """Runs the body of a loop on `size` // `width` iterations at once.
+
+    Lane k of each vector is the value of the k-th of those iterations. The
+    address of the lanes accessed through a pointer `base` is base plus the
+    64-bit integer `index` times `width`. The steps of the body are each
+    one of
+
+        ("load", n, base) - vector n is the lanes stored at base
+        ("store", base, a) - the lanes of operand a are stored at base
+        ("stream", base, a) - likewise, but around the cache, by a
+            movntdq, which needs base plus the index times `width` to
+            be aligned to `size` bytes
+        (op, n, a, b) - vector n is operand a op operand b, lane by lane,
+            for an operation op of `supported`
+
+    in the order they are run, where each operand is the number of an
+    earlier vector or an ILValue set by a VectorSplat. Vectors are numbered
+    from 0, and at most len(vector_regs) of them are computed.
+    """
+
+    def __init__(self, steps, index, width, size):  # noqa D102
+        self.steps = steps
+        self.index = index
+        self.width = width
+        self.size = size
+
+    def inputs(self):  # noqa D102
+        inputs = [self.index]
+        for step in self.steps:
+            for v in step[1:]:
+                if not isinstance(v, int) and v not in inputs:
+                    inputs.append(v)
+        return inputs
+
+    def outputs(self):  # noqa D102
+        return []
+
+    def replace_inputs(self, mapping):  # noqa D102
+        self._replace(mapping, "index")
+        self.steps = [tuple(v if isinstance(v, (int, str))
+                            else mapping.get(v, v) for v in step)
+                      for step in self.steps]
+
+    def clobber(self):  # noqa D102
+        return spots.float_registers
+
+    def indir_read(self):  # noqa D102
+        return [step[2] for step in self.steps if step[0] == "load"]
+
+    def indir_write(self):  # noqa D102
+        return [step[1] for step in self.steps
+                if step[0] in {"store", "stream"}]
+
+    def make_asm(self, spotmap, home_spots, get_reg, asm_code):  # noqa D102
+        size = self.size
+        conf = [spotmap[v] for v in self.inputs()]
+
+        index = spotmap[self.index]
+        if not isinstance(index, RegSpot):
+            r = get_reg([], conf)
+            asm_code.add(asm_cmds.Mov(r, index, 8))
+            index = r
+        base_reg = None
+
+        # The index of the last step using each vector.
+        last = {}
+        for i, step in enumerate(self.steps):
+            for v in step[2:]:
+                if isinstance(v, int):
+                    last[v] = i
+
+        free = list(vector_regs)
+        regs = {}
+
+        def lanes(base):
+            nonlocal base_reg
+            base_spot = spotmap[base]
+            if not isinstance(base_spot, RegSpot):
+                if not base_reg:
+                    base_reg = get_reg([], conf + [index])
+                asm_code.add(asm_cmds.Mov(base_reg, base_spot, 8))
+                base_spot = base_reg
+            return MemSpot(base_spot, 0, self.width, index)
+
+        def register(v):
+            if isinstance(v, int):
+                return regs[v]
+            asm_code.add(asm_cmds.Movdqu(spots.XMM15, spotmap[v], size))
+            return spots.XMM15
+
+        def dies(v, i):
+            return isinstance(v, int) and last.get(v) == i
+
+        def release(i, *operands):
+            for v in set(operands):
+                if dies(v, i):
+                    free.insert(0, regs[v])
+
+        for i, step in enumerate(self.steps):
+            if step[0] == "load":
+                regs[step[1]] = free.pop(0)
+                asm_code.add(asm_cmds.Movdqu(regs[step[1]], lanes(step[2]),
+                                             size))
+                continue
+            elif step[0] in {"store", "stream"}:
+                Inst = asm_cmds.Movdqu
+                if step[0] == "stream":
+                    Inst = asm_cmds.Movntdq
+                reg = register(step[2])
+                asm_code.add(Inst(lanes(step[1]), reg, size))
+                release(i, step[2])
+                continue
+
+            op, n, a, b = step
+            Inst = packed_cmds[(op, self.width)]
+
+            # A splat operand is the source if it can be, since only the
+            # source may be in memory. SSE commands take operands in memory
+            # only if they are aligned, so there it is loaded first.
+            if op != "sub" and not isinstance(a, int):
+                a, b = b, a
+
+            if size == 32:
+                first = register(a)
+                source = regs[b] if isinstance(b, int) else spotmap[b]
+                release(i, a, b)
+                regs[n] = free.pop(0)
+                asm_code.add(Inst(regs[n], source, 32, first))
+                continue
+
+            # The SSE form computes in place, so it is done in the register
+            # of an operand which dies here, or else in a copy of one.
+            if op != "sub" and dies(b, i) and not dies(a, i):
+                a, b = b, a
+            source = register(b)
+            if dies(a, i):
+                regs[n] = regs[a]
+            else:
+                regs[n] = free.pop(0)
+                if isinstance(a, int):
+                    asm_code.add(asm_cmds.Movdqa(regs[n], regs[a]))
+                else:
+                    asm_code.add(asm_cmds.Movdqu(regs[n], spotmap[a]))
+            asm_code.add(Inst(regs[n], source))
+            if b != a:
+                release(i, b)
+
+        if size == 32:
+            asm_code.add(asm_cmds.Vzeroupper())
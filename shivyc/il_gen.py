@@ -1,8 +1,9 @@
 """Objects used for the AST -> IL phase of the compiler."""
 
-from collections import namedtuple
 from copy import copy
 
+from shivyc.cfg import CFG
+from shivyc.scope import ScopedTable
 from shivyc.ctypes import CType
 import shivyc.il_cmds.control as control_cmds
 from shivyc.errors import CompilerError
@@ -12,16 +13,35 @@ class ILCode:
     """Stores the IL code generated from the AST.
 
     commands - Dictionary mapping function name to list of IL commands for
-    that function.
+    that function. Replace a command list with set_commands, so the control
+    flow graph cached for it is rebuilt.
     cur_func (str) - Name of the function current commands are for
-    label_num (int) - Unique identifier returned by get_label
+    label_num (int) - Number of labels returned by get_label
+    cold_labels (Set[str]) - Labels of blocks which are expected to run
+    rarely, as told by __builtin_expect or a profile.
+    counts (Dict[str, int]) - Map from the label of each block with a count
+    in the profile given by -fprofile-use to the number of times it ran.
+    taken_labels (Set[str]) - Labels whose address is taken by `&&label`.
+    summaries (Dict[str, Summary]) - Map from the name of each function
+    compiled so far to what a call of it may do, as made by opt/ipa.py.
+    debug (bool) - Whether each command added is given the source line it
+    was made from, for -g.
+    line (Tuple[str, int]) - File and line given to the commands added, as
+    set by `at`.
     """
     def __init__(self):
         """Initialize IL code."""
         self.commands = {}
+        self.cfgs = {}
         self.cur_func = None
+        self.debug = False
+        self.line = None
 
         self.label_num = 0
+        self.cold_labels = set()
+        self.counts = {}
+        self.taken_labels = set()
+        self.summaries = {}
 
         self.static_inits = {}
         self.literals = {}
@@ -37,8 +57,14 @@ class ILCode:
         new = ILCode()
         new.commands = {name: self.commands[name].copy()
                         for name in self.commands}
+        new.cfgs = self.cfgs.copy()
         new.cur_func = self.cur_func
-        self.label_num = self.label_num
+        new.debug = self.debug
+        new.label_num = self.label_num
+        new.cold_labels = self.cold_labels.copy()
+        new.counts = self.counts.copy()
+        new.taken_labels = self.taken_labels.copy()
+        new.summaries = self.summaries.copy()
         self.static_inits = self.static_inits.copy()
         self.literals = self.literals.copy()
         self.string_literals = self.string_literals.copy()
@@ -58,8 +84,77 @@ class ILCode:
         command (ILCommand) - command to be added
 
         """
+        if self.line:
+            command.line = self.line
         self.commands[self.cur_func].append(command)
 
+    def at(self, token):
+        """Give the commands added from now on the source line of `token`.
+
+        This does nothing without -g, or if `token` is None, as for a node
+        the parser did not give tokens.
+        """
+        if self.debug and token:
+            pos = token.r.start
+            self.line = (pos.file, pos.line)
+
+    def cfg(self, func):
+        """Return the control flow graph of function `func`.
+
+        The graph is built on first request and kept until the commands of
+        the function are replaced with set_commands.
+        """
+        if func not in self.cfgs:
+            self.cfgs[func] = CFG(self.commands[func])
+        return self.cfgs[func]
+
+    def set_commands(self, func, commands):
+        """Replace the list of IL commands of function `func`."""
+        self.commands[func] = commands
+        self.cfgs.pop(func, None)
+
+    def release(self, func):
+        """Drop the IL commands of function `func` once it is compiled."""
+        del self.commands[func]
+        self.cfgs.pop(func, None)
+
+    def dump(self, func, names):  # pragma: no cover
+        """Return the IL commands of function `func` as text, for debugging.
+
+        Each command is written as its name followed by its public fields. A
+        value is written as its name in `names`, a map from ILValue to name,
+        or as its literal value, or else as a number unique within the
+        function. Labels are written on lines of their own.
+        """
+        numbers = {}
+
+        def value_str(value):
+            if isinstance(value, ILValue):
+                if value in names:
+                    return names[value]
+                if value in self.literals:
+                    return f"${self.literals[value]}"
+                if value in self.string_literals:
+                    chars = bytes(self.string_literals[value][:-1])
+                    return repr(chars.decode(errors="replace"))
+                return "%" + str(numbers.setdefault(value, len(numbers)))
+            if isinstance(value, (list, tuple)):
+                return "[" + ", ".join(value_str(v) for v in value) + "]"
+            if value is None or isinstance(value, (bool, int, str)):
+                return str(value)
+            return type(value).__name__
+
+        lines = []
+        for command in self.commands[func]:
+            if isinstance(command, control_cmds.Label):
+                lines.append(f"{command.label}:")
+                continue
+            fields = " ".join(f"{name}={value_str(value)}"
+                              for name, value in vars(command).items()
+                              if not name.startswith("_"))
+            lines.append(f"    {type(command).__name__} {fields}")
+        return "\n".join(lines)
+
     def always_returns(self):
         """Return true if this function ends in a return command."""
         return (self.commands[self.cur_func] and
@@ -70,9 +165,13 @@ class ILCode:
         """Register a literal IL value.
 
         il_value - ILValue object that has a literal value
-        value - Literal value to store in the ILValue
+        value - Literal value to store in the ILValue, a float if the value
+        has floating type
         """
-        il_value.literal = IntegerLiteral(value)
+        if il_value.ctype.is_floating():
+            il_value.literal = FloatLiteral(value)
+        else:
+            il_value.literal = IntegerLiteral(value)
         self.literals[il_value] = value
 
     def register_string_literal(self, il_value, chars):
@@ -85,23 +184,50 @@ class ILCode:
         il_value.literal = StringLiteral(chars)
         self.string_literals[il_value] = chars
 
-    def static_initialize(self, il_value, init_val):
+    def static_initialize(self, il_value, image):
         """Initialize given value statically before program execution begins.
 
         il_value - ILValue object to initialize
-        init_val - Numeric value to initialize `il_value` to
+        image - List of (offset, size, value) triples in order of offset,
+        for the values stored in the object. Each value is a number, or an
+        (ILValue, addend) pair for the address `addend` bytes past the
+        object or function of the ILValue. The bytes not covered are zero.
         """
-        self.static_inits[il_value] = init_val
+        self.static_inits[il_value] = image
 
     def get_label(self):
-        """Return a unique label identifier string."""
-        # Kind of hacky. Ideally, we would return labels here that were unique
-        # to the ILCode, and then when generating the ASM code, assign each
-        # ILCode label to an ASM code label.
+        """Return a unique label identifier string.
+
+        These labels are only names within the IL code. When the ASM code
+        of a function is generated, each IL label it uses is given an ASM
+        label of that function.
+        """
+        self.label_num += 1
+        return f"L{self.label_num}"
+
+    def copy_label(self, label):
+        """Return a new label for a copy of the block labelled `label`.
+
+        The copy is as cold as the original, has the same count, and has
+        its address taken if the original does.
+        """
+        new = self.get_label()
+        if label in self.cold_labels:
+            self.cold_labels.add(new)
+        if label in self.taken_labels:
+            self.taken_labels.add(new)
+        if label in self.counts:
+            self.counts[new] = self.counts[label]
+        return new
+
+    def kept_labels(self):
+        """Return the labels to keep even where nothing jumps to them.
 
-        # Import is here to prevent circular import.
-        from shivyc.asm_gen import ASMCode
-        return ASMCode.get_label()
+        These are the labels which tell the passes after SSA form and the
+        code generator how often their blocks run, and the labels whose
+        address is taken.
+        """
+        return self.cold_labels | self.counts.keys() | self.taken_labels
 
 
 class ILValue:
@@ -111,12 +237,19 @@ class ILValue:
     literal_val - the value of this IL value if it represents a literal
     value. Do not set this value directly; it is set by the
     ILCode.register_literal_var function.
+    id (int) - Dense integer ID of this value among the values of the
+    function whose code is generated, as given by number_values, or None.
+
+    Values are made by the thousand, so they have slots rather than a dict.
     """
 
+    __slots__ = ["ctype", "literal", "id"]
+
     def __init__(self, ctype):
         """Initialize IL value."""
         self.ctype = ctype
         self.literal = None
+        self.id = None
 
     def __str__(self):  # pragma: no cover
         return f'{id(self) % 1000:03}'
@@ -125,6 +258,48 @@ class ILValue:
         return str(self)
 
 
+class FunctionLabel:
+    """Address of a label of a function, as a value of static data.
+
+    func (ILValue) - The function.
+    name (str) - Name of the label in the function. The Label command of
+    the label has this name too, so that its address is given a symbol.
+    """
+
+    def __init__(self, func, name):
+        """Initialize FunctionLabel."""
+        self.func = func
+        self.name = name
+
+    def __eq__(self, other):
+        """Test equality by comparing the function and the name."""
+        return (isinstance(other, FunctionLabel)
+                and (self.func, self.name) == (other.func, other.name))
+
+    def __hash__(self):
+        """Hash based on the function and the name."""
+        return hash((self.func, self.name))
+
+
+def number_values(commands):
+    """Give each value used by the given commands a dense integer ID.
+
+    The values are numbered from 0 in the order they are first used, so
+    analyses of the code of a function may keep arrays and bitsets indexed
+    by the IDs. The IDs are only valid until the commands of another
+    function are numbered, since a value like a global may be used by both.
+
+    returns - list of the values, indexed by ID
+    """
+    values = {}
+    for command in commands:
+        for v in command.inputs() + command.outputs():
+            if v and v not in values:
+                v.id = len(values)
+                values[v] = None
+    return list(values)
+
+
 class _Literal:
     """Base class for integer literals, string literals, etc."""
     def __init__(self, val):
@@ -137,6 +312,12 @@ class IntegerLiteral(_Literal):
         super().__init__(int(val))
 
 
+class FloatLiteral(_Literal):
+    """Class for floating literals."""
+    def __init__(self, val):
+        super().__init__(float(val))
+
+
 class StringLiteral(_Literal):
     """Class for string literals."""
     def __init__(self, val):
@@ -149,7 +330,6 @@ class SymbolTable:
     This object stores variable names, types, typedefs, and maintains
     information on the variable linkages and storage durations.
     """
-    Tables = namedtuple('Tables', ['vars', 'structs'])
 
     # Definition statuses
     UNDEFINED = 1
@@ -167,11 +347,13 @@ class SymbolTable:
     def __init__(self):
         """Initialize symbol table.
 
-        `tables` is a list of namedtuples of dictionaries. Each dictionary
-        in the namedtuple is the symbol table for a different namespace.
+        `vars` and `structs` are the scoped tables of the namespace of
+        variables and typedefs, and of the namespace of struct and union
+        tags.
 
         """
-        self.tables = []
+        self.vars = ScopedTable()
+        self.structs = ScopedTable()
 
         # Store variable linkages
         # ILValue -> INTERNAL / EXTERNAL
@@ -192,15 +374,30 @@ class SymbolTable:
         # ILValue -> name
         self.names = {}
 
-        self.new_scope()
+        # Functions declared with the `inline` specifier, which the inliner
+        # takes as a hint.
+        self.inline_hints = set()
+
+        # Objects with static storage declared with `_Thread_local`, of
+        # which each thread has its own copy.
+        self.thread_locals = set()
+
+        # Number of each object with static storage and no external
+        # linkage, which names it apart from the other such objects of the
+        # same name in the ASM code.
+        # ILValue -> int
+        self.static_numbers = {}
+        self.static_counts = {}
 
     def new_scope(self):
         """Initialize a new scope for the symbol table."""
-        self.tables.append(self.Tables(dict(), dict()))
+        self.vars.new_scope()
+        self.structs.new_scope()
 
     def end_scope(self):
         """End the most recently started scope."""
-        self.tables.pop()
+        self.vars.end_scope()
+        self.structs.end_scope()
 
     def _lookup_raw(self, name):
         """Look up the identifier or ctype with the given name.
@@ -209,9 +406,7 @@ class SymbolTable:
 
         name (str) - Identifier name to search for.
         """
-        for table, _ in self.tables[::-1]:
-            if name in table:
-                return table[name]
+        return self.vars.lookup(name)
 
     def lookup_variable(self, identifier):
         """Look up the given identifier.
@@ -236,7 +431,8 @@ class SymbolTable:
         """
         return self.linkage_type.get(self._lookup_raw(identifier.content))
 
-    def add_variable(self, identifier, ctype, defined, linkage, storage):
+    def add_variable(self, identifier, ctype, defined, linkage, storage,
+                     thread_local=False):
         """Add an identifier with the given name and type to the symbol table.
 
         identifier (Token) - Identifier to add, for error purposes.
@@ -244,14 +440,16 @@ class SymbolTable:
         defined - one of DEFINED, UNDEFINED, or TENTATIVE
         linkage - one of INTERNAL, EXTERNAL, or None
         storage - STATIC, AUTOMATIC, or None
+        thread_local (bool) - whether it is declared with `_Thread_local`,
+        which every declaration of the object must be if any is
 
         return (ILValue) - the ILValue added
         """
         name = identifier.content
 
         # if it's already declared in this scope
-        if name in self.tables[-1].vars:
-            var = self.tables[-1].vars[name]
+        var = self.vars.lookup_local(name)
+        if var is not None:
             if isinstance(var, CType):
                 err = f"redeclared type definition '{name}' as variable"
                 raise CompilerError(err, identifier.r)
@@ -274,7 +472,17 @@ class SymbolTable:
             # completed an object type)
             var.ctype = ctype
 
-        self.tables[-1].vars[name] = var
+        if var in self.names and (var in self.thread_locals) != thread_local:
+            kinds = ["non-thread-local", "thread-local"]
+            if not thread_local:
+                kinds.reverse()
+            err = (f"{kinds[1]} declaration of '{name}' follows {kinds[0]} "
+                   "declaration")
+            raise CompilerError(err, identifier.r)
+        if thread_local:
+            self.thread_locals.add(var)
+
+        self.vars.bind(name, var)
 
         # Set this variable's linkage if it has one
         if linkage:
@@ -289,16 +497,45 @@ class SymbolTable:
             self.storage[var] = storage
 
         self.names[var] = name
+        if (self.storage[var] == self.STATIC
+              and self.linkage_type.get(var) != self.EXTERNAL):
+            self.number_static(var)
+        return var
+
+    def add_static_object(self, ctype, name):
+        """Add an object with static storage which no identifier names.
+
+        name (str) - Name of the object in the ASM code, which is made
+        unique there since the object has no linkage.
+        return (ILValue) - the ILValue added
+        """
+        var = ILValue(ctype)
+        self.def_state[var] = self.DEFINED
+        self.storage[var] = self.STATIC
+        self.names[var] = name
+        self.number_static(var)
         return var
 
+    def number_static(self, var):
+        """Number an object with static storage and no external linkage.
+
+        The objects of each name are numbered in the order they are
+        declared, so the name of an object in the ASM code does not depend
+        on which function uses it first, and the code of a function which
+        did not change can be reused from the cache.
+        """
+        if var not in self.static_numbers:
+            name = self.names[var]
+            self.static_counts[name] = self.static_counts.get(name, 0) + 1
+            self.static_numbers[var] = self.static_counts[name]
+
     def lookup_struct_union(self, tag):
         """Looks up for struct or union by tag name and returns
         its ctype object.
 
         If not found, returns None.
         """
-        for _, structs in self.tables[::-1]:
-            if tag in structs: return structs[tag]
+        return self.structs.lookup(tag)
 
     def add_struct_union(self, tag, ctype):
         """Add struct or union to the symbol table and return it.
@@ -308,17 +545,19 @@ class SymbolTable:
         Otherwise, this function adds this type to the topmost scope and
         returns it.
         """
-        if tag not in self.tables[-1].structs:
-            self.tables[-1].structs[tag] = ctype
+        old_ctype = self.structs.lookup_local(tag)
+        if old_ctype is not None:
+            return old_ctype
 
-        return self.tables[-1].structs[tag]
+        self.structs.bind(tag, ctype)
+        return ctype
 
     def add_typedef(self, identifier, ctype):
         """Add a type definition to the symbol table."""
 
         name = identifier.content
-        if name in self.tables[-1].vars:
-            old_ctype = self.tables[-1].vars[name]
+        old_ctype = self.vars.lookup_local(name)
+        if old_ctype is not None:
             if isinstance(old_ctype, ILValue):
                 err = f"'{name}' redeclared as type definition in same scope"
                 raise CompilerError(err, identifier.r)
@@ -328,7 +567,7 @@ class SymbolTable:
             else:
                 return
 
-        self.tables[-1].vars[name] = ctype
+        self.vars.bind(name, ctype)
 
     def lookup_typedef(self, identifier):
         """Look up a typedef from the symbol table.
@@ -365,16 +604,27 @@ class Context:
     would jump.
     continue_label - Label to which a `continue` statment in the current
     position would jump.
+    true_label - Label to which a condition being branched on jumps if it
+    is nonzero, or None if control should fall through in that case.
+    false_label - As above, for when the condition is zero.
+    return_type - Return type of the current function.
+    return_addr - If the current function returns a struct in memory, the
+    ILValue of the address to store the returned value at.
     is_global - Whether the current scope is global or within a function.
     Used by declarations to modify emitted code.
+    labels - FunctionLabels of the goto statements of the current function.
     """
 
     def __init__(self):
         """Initialize Context."""
         self.break_label = None
         self.continue_label = None
+        self.true_label = None
+        self.false_label = None
         self.return_type = None
+        self.return_addr = None
         self.is_global = False
+        self.labels = None
 
     def set_global(self, val):
         """Return copy of self with is_global set to given value."""
@@ -394,8 +644,22 @@ class Context:
         c.continue_label = lab
         return c
 
-    def set_return(self, ctype):
-        """Return copy of self with return_type set to given value."""
+    def set_branch(self, true_label, false_label):
+        """Return copy of self with the branch labels set to given values."""
+        c = copy(self)
+        c.true_label = true_label
+        c.false_label = false_label
+        return c
+
+    def set_return(self, ctype, addr=None):
+        """Return copy of self with return_type and return_addr set."""
         c = copy(self)
         c.return_type = ctype
+        c.return_addr = addr
+        return c
+
+    def set_labels(self, labels):
+        """Return copy of self with labels set to given value."""
+        c = copy(self)
+        c.labels = labels
         return c
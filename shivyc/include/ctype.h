@@ -1,3 +1,6 @@
+#ifndef __SHIVYC_CTYPE_H
+#define __SHIVYC_CTYPE_H
+
 int   isalnum(int);
 int   isalpha(int);
 int   isascii(int);
@@ -13,3 +16,66 @@ int   isxdigit(int);
 int   toascii(int);
 int   tolower(int);
 int   toupper(int);
+
+// Each function above is also a macro, so that a character test is a
+// masked lookup in the table of the classes of each character below, and a
+// conversion a range compare, rather than a call which clobbers every
+// caller-saved register. The classes are those of the "C" locale, where no
+// character above 127 is in any class and EOF is in none. The functions
+// remain for taking their address, or calling as (isdigit)(c).
+
+#define __SHIVYC_UPPER 1
+#define __SHIVYC_LOWER 2
+#define __SHIVYC_DIGIT 4
+#define __SHIVYC_XDIGIT 8
+#define __SHIVYC_SPACE 16
+#define __SHIVYC_PUNCT 32
+#define __SHIVYC_CNTRL 64
+// The space character, which is printing but not graphic.
+#define __SHIVYC_BLANK 128
+
+static const unsigned char __shivyc_ctype[256] = {
+  64, 64, 64, 64, 64, 64, 64, 64, 64, 80, 80, 80, 80, 80, 64, 64,
+  64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
+  144, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32, 32,
+  12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 32, 32, 32, 32, 32, 32,
+  32, 9, 9, 9, 9, 9, 9, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 32, 32, 32, 32, 32,
+  32, 10, 10, 10, 10, 10, 10, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+  2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 32, 32, 32, 32, 64,
+};
+
+#define __shivyc_isctype(c, classes) \
+  (__shivyc_ctype[(unsigned char) (c)] & (classes))
+
+#define isalnum(c) __shivyc_isctype(c, __SHIVYC_UPPER | __SHIVYC_LOWER \
+                                    | __SHIVYC_DIGIT)
+#define isalpha(c) __shivyc_isctype(c, __SHIVYC_UPPER | __SHIVYC_LOWER)
+#define iscntrl(c) __shivyc_isctype(c, __SHIVYC_CNTRL)
+#define isdigit(c) __shivyc_isctype(c, __SHIVYC_DIGIT)
+#define isgraph(c) __shivyc_isctype(c, __SHIVYC_UPPER | __SHIVYC_LOWER \
+                                    | __SHIVYC_DIGIT | __SHIVYC_PUNCT)
+#define islower(c) __shivyc_isctype(c, __SHIVYC_LOWER)
+#define isprint(c) __shivyc_isctype(c, __SHIVYC_UPPER | __SHIVYC_LOWER \
+                                    | __SHIVYC_DIGIT | __SHIVYC_PUNCT \
+                                    | __SHIVYC_BLANK)
+#define ispunct(c) __shivyc_isctype(c, __SHIVYC_PUNCT)
+#define isspace(c) __shivyc_isctype(c, __SHIVYC_SPACE)
+#define isupper(c) __shivyc_isctype(c, __SHIVYC_UPPER)
+#define isxdigit(c) __shivyc_isctype(c, __SHIVYC_XDIGIT)
+
+#define isascii(c) (((c) & ~127) == 0)
+#define toascii(c) ((c) & 127)
+
+static inline int __shivyc_tolower(int c) {
+  return (unsigned) c - 'A' < 26 ? c + ('a' - 'A') : c;
+}
+
+static inline int __shivyc_toupper(int c) {
+  return (unsigned) c - 'a' < 26 ? c - ('a' - 'A') : c;
+}
+
+#define tolower(c) __shivyc_tolower(c)
+#define toupper(c) __shivyc_toupper(c)
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef __SHIVYC_STDATOMIC_H
+#define __SHIVYC_STDATOMIC_H
+
+#define __ATOMIC_RELAXED 0
+#define __ATOMIC_CONSUME 1
+#define __ATOMIC_ACQUIRE 2
+#define __ATOMIC_RELEASE 3
+#define __ATOMIC_ACQ_REL 4
+#define __ATOMIC_SEQ_CST 5
+
+typedef int memory_order;
+#define memory_order_relaxed __ATOMIC_RELAXED
+#define memory_order_consume __ATOMIC_CONSUME
+#define memory_order_acquire __ATOMIC_ACQUIRE
+#define memory_order_release __ATOMIC_RELEASE
+#define memory_order_acq_rel __ATOMIC_ACQ_REL
+#define memory_order_seq_cst __ATOMIC_SEQ_CST
+
+#define atomic_thread_fence(order) __atomic_thread_fence(order)
+
+#define atomic_load_explicit(obj, order) __atomic_load_n(obj, order)
+#define atomic_load(obj) __atomic_load_n(obj, __ATOMIC_SEQ_CST)
+#define atomic_store_explicit(obj, val, order) \
+  __atomic_store_n(obj, val, order)
+#define atomic_store(obj, val) __atomic_store_n(obj, val, __ATOMIC_SEQ_CST)
+#define atomic_exchange_explicit(obj, val, order) \
+  __atomic_exchange_n(obj, val, order)
+#define atomic_exchange(obj, val) \
+  __atomic_exchange_n(obj, val, __ATOMIC_SEQ_CST)
+
+#define atomic_fetch_add_explicit(obj, val, order) \
+  __atomic_fetch_add(obj, val, order)
+#define atomic_fetch_add(obj, val) \
+  __atomic_fetch_add(obj, val, __ATOMIC_SEQ_CST)
+#define atomic_fetch_sub_explicit(obj, val, order) \
+  __atomic_fetch_sub(obj, val, order)
+#define atomic_fetch_sub(obj, val) \
+  __atomic_fetch_sub(obj, val, __ATOMIC_SEQ_CST)
+
+#define atomic_compare_exchange_strong_explicit(obj, exp, val, succ, fail) \
+  __atomic_compare_exchange_n(obj, exp, val, 0, succ, fail)
+#define atomic_compare_exchange_strong(obj, exp, val) \
+  __atomic_compare_exchange_n(obj, exp, val, 0, __ATOMIC_SEQ_CST, \
+                              __ATOMIC_SEQ_CST)
+#define atomic_compare_exchange_weak_explicit(obj, exp, val, succ, fail) \
+  __atomic_compare_exchange_n(obj, exp, val, 1, succ, fail)
+#define atomic_compare_exchange_weak(obj, exp, val) \
+  __atomic_compare_exchange_n(obj, exp, val, 1, __ATOMIC_SEQ_CST, \
+                              __ATOMIC_SEQ_CST)
+
+#endif
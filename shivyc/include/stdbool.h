@@ -1,2 +1,9 @@
-// TODO: define bool, true, and false as macros
-typedef _Bool bool;
+#ifndef __SHIVYC_STDBOOL_H
+#define __SHIVYC_STDBOOL_H
+
+#define bool _Bool
+#define true 1
+#define false 0
+#define __bool_true_false_are_defined 1
+
+#endif
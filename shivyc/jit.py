@@ -0,0 +1,327 @@
+"""Running compiled code in the process of the compiler, without linking.
+
+The object files of a program are loaded into memory here as the linker and
+the dynamic loader would lay out an executable: the sections each object
+file allocates are copied into a single mapping, the common symbols are
+given zeroed space after them, and each relocation is applied. The mapping
+is made writable and not executable, and once the program is loaded, the
+pages of its code are made executable and not writable, so no page may be
+both at once. A symbol no object file defines is looked up with dlsym in the C
+library and the other libraries loaded into the process.
+
+Code is compiled for the JIT as position-independent code for an
+executable, so the objects it does not define are reached through entries
+of a global offset table made in the mapping, and the functions it does not
+define are called through stubs made there, which jump to the address found
+by dlsym. The mapping is made in the low 2 GiB of the address space where
+possible, so that objects compiled without -fPIE, which address data by
+absolute 32-bit addresses, can be loaded as well.
+"""
+
+import ctypes
+import mmap
+import os
+import struct
+
+from shivyc.encoder import (R_X86_64_64, R_X86_64_PC32, R_X86_64_PLT32,
+                            R_X86_64_GOTPCREL, R_X86_64_32S)
+from shivyc.elf import (SHF_ALLOC, SHF_EXECINSTR, SHF_TLS, SHN_COMMON,
+                        SHN_UNDEF, SHT_NOBITS, SHT_RELA, SHT_SYMTAB, STB_LOCAL)
+from shivyc.errors import error_collector, CompilerError
+
+# Relocations of a load from the global offset table which `as` may emit in
+# place of R_X86_64_GOTPCREL, so that the linker can relax them.
+R_X86_64_GOTPCRELX = 41
+R_X86_64_REX_GOTPCRELX = 42
+got_relocs = {R_X86_64_GOTPCREL, R_X86_64_GOTPCRELX, R_X86_64_REX_GOTPCRELX}
+
+# Flag of mmap for a mapping in the low 2 GiB of the address space on
+# x86-64 Linux, which the mmap module does not name.
+MAP_32BIT = 0x40
+
+# Size of the stub which jumps to a function, as `jmp [rip+0]` followed by
+# the address of the function.
+STUB_SIZE = 16
+
+
+def compile_string(source, flags=(), name="string.c"):
+    """Compile C source code and load it to be run.
+
+    flags (List[str]) - Flags as the compiler takes them on the command
+    line, like ["-O1"]
+    returns - the Program, or None if there was an error, which is left in
+    the error collector
+    """
+    import shivyc.main
+
+    obj = shivyc.main.compile_string(source, ["-fPIE"] + list(flags), name)
+    return obj and load([obj])
+
+
+def load(objects):
+    """Load the given object files into memory to be run.
+
+    objects (List[bytes]) - The contents of each ELF64 relocatable object
+    returns - the Program, or None if a symbol could not be resolved, which
+    is reported to the error collector
+    """
+    objects = [_Object(data) for data in objects]
+
+    # The blocks of thread-local objects of each thread are made by the
+    # C library from those of the modules it loads, so the JIT cannot add
+    # to them.
+    if any(section["flags"] & SHF_TLS for obj in objects
+           for section in obj.sections):
+        descrip = "cannot load thread-local objects"
+        error_collector.add(CompilerError(descrip))
+        return None
+
+    relocated = [(obj, reloc) for obj in objects for reloc in obj.relocs]
+
+    # Lay out the code the objects allocate and the stubs of the functions
+    # on their own pages, and then the other sections, the common symbols
+    # not defined by any object, and the global offset table.
+    size = 0
+    for executable in (True, False):
+        for obj in objects:
+            for section in obj.sections:
+                if (section["flags"] & SHF_ALLOC and executable
+                      == bool(section["flags"] & SHF_EXECINSTR)):
+                    size = _align(size, section["align"])
+                    section["start"] = size
+                    size += section["size"]
+        if executable:
+            stub_start = size = _align(size, 16)
+            size += STUB_SIZE * len(relocated)
+            code_size = size = _align(size, mmap.PAGESIZE)
+
+    defined = {}
+    for obj in objects:
+        for symbol in obj.symbols:
+            if (symbol["global"] and symbol["shndx"] not in (SHN_UNDEF,
+                                                             SHN_COMMON)):
+                defined.setdefault(symbol["name"], (obj, symbol))
+
+    common = {}
+    for obj in objects:
+        for symbol in obj.symbols:
+            if (symbol["shndx"] == SHN_COMMON
+                  and symbol["name"] not in defined):
+                align, length = common.get(symbol["name"], (1, 0))
+                common[symbol["name"]] = (max(align, symbol["value"]),
+                                          max(length, symbol["size"]))
+    common_starts = {}
+    for name, (align, length) in common.items():
+        size = _align(size, align)
+        common_starts[name] = size
+        size += length
+
+    # Entries of the global offset table, made as the relocations ask for
+    # them, as the stubs are.
+    got_start = size = _align(size, 16)
+    size += 8 * len(relocated)
+
+    program = Program(max(size, 1))
+    base = program.base
+    for obj in objects:
+        for section in obj.sections:
+            if (section["flags"] & SHF_ALLOC
+                  and section["kind"] != SHT_NOBITS):
+                start = section["start"]
+                program.memory[start:start + section["size"]] = (
+                    obj.data[section["offset"]:
+                             section["offset"] + section["size"]])
+
+    libc = ctypes.CDLL(None)
+
+    def address(obj, symbol):
+        """Return the address of a symbol, and whether it is outside the
+        program.
+        """
+        name = symbol["name"]
+        if symbol["global"] or symbol["shndx"] == SHN_UNDEF:
+            if name in defined:
+                obj, symbol = defined[name]
+            elif name in common_starts:
+                return base + common_starts[name], False
+            else:
+                try:
+                    found = ctypes.c_char.in_dll(libc, name)
+                except ValueError:
+                    descrip = f"undefined reference to '{name}'"
+                    error_collector.add(CompilerError(descrip))
+                    return None, True
+                return ctypes.addressof(found), True
+        section = obj.sections[symbol["shndx"]]
+        return base + section["start"] + symbol["value"], False
+
+    tables = {"got": {}, "stub": {}}
+    next_entry = {"got": got_start, "stub": stub_start}
+
+    def entry(kind, key, contents, entry_size):
+        table = tables[kind]
+        if key not in table:
+            table[key] = next_entry[kind]
+            program.memory[table[key]:table[key] + entry_size] = contents
+            next_entry[kind] += entry_size
+        return base + table[key]
+
+    ok = True
+    for obj, (section, offset, kind, symbol, addend) in relocated:
+        place = section["start"] + offset
+        target, outside = address(obj, obj.symbols[symbol])
+        if target is None:
+            ok = False
+            continue
+
+        if kind == R_X86_64_64:
+            struct.pack_into("<Q", program.memory, place,
+                             (target + addend) % (1 << 64))
+            continue
+        elif kind in got_relocs:
+            target = entry("got", target, struct.pack("<Q", target), 8)
+        elif kind == R_X86_64_PLT32 and outside:
+            target = entry("stub", target, b"\xFF\x25\x00\x00\x00\x00"
+                           + struct.pack("<Q", target) + bytes(2),
+                           STUB_SIZE)
+        elif kind not in (R_X86_64_PC32, R_X86_64_PLT32, R_X86_64_32S):
+            descrip = f"cannot load relocation of type {kind}"
+            error_collector.add(CompilerError(descrip))
+            ok = False
+            continue
+
+        value = target + addend
+        if kind != R_X86_64_32S:
+            value -= base + place
+        if not -(1 << 31) <= value < 1 << 31:
+            descrip = (f"relocation of '{obj.symbols[symbol]['name']}' "
+                       "out of range; compile it with -fPIE")
+            error_collector.add(CompilerError(descrip))
+            ok = False
+            continue
+        struct.pack_into("<i", program.memory, place, value)
+
+    if not ok:
+        return None
+    program.protect_code(code_size)
+    program.symbols = {name: address(obj, symbol)[0]
+                       for name, (obj, symbol) in defined.items()}
+    return program
+
+
+class Program:
+    """Program loaded into memory by load, whose functions may be called.
+
+    memory (mmap) - The mapping the program is loaded into, which is kept
+    for as long as the Program is.
+    base (int) - Address of the mapping.
+    symbols (Dict[str, int]) - Address of each global symbol the program
+    defines.
+    """
+
+    def __init__(self, size):
+        """Map writable memory of the given size for the program."""
+        prot = mmap.PROT_READ | mmap.PROT_WRITE
+        flags = mmap.MAP_PRIVATE | mmap.MAP_ANONYMOUS
+        try:
+            self.memory = mmap.mmap(-1, size, flags | MAP_32BIT, prot)
+        except OSError:
+            self.memory = mmap.mmap(-1, size, flags, prot)
+        self.base = ctypes.addressof(ctypes.c_char.from_buffer(self.memory))
+        self.symbols = {}
+
+    def protect_code(self, size):
+        """Make the first `size` bytes of the mapping, a multiple of the
+        page size, executable and not writable.
+        """
+        if not size:
+            return
+        libc = ctypes.CDLL(None, use_errno=True)
+        libc.mprotect.argtypes = [ctypes.c_void_p, ctypes.c_size_t,
+                                  ctypes.c_int]
+        if libc.mprotect(self.base, size, mmap.PROT_READ | mmap.PROT_EXEC):
+            errno = ctypes.get_errno()
+            raise OSError(errno, os.strerror(errno))
+
+    def function(self, name, restype=ctypes.c_int, argtypes=()):
+        """Return a function of the program, to be called from Python.
+
+        restype, argtypes - The ctypes types of the return value and of
+        each argument, as CFUNCTYPE takes them
+        """
+        prototype = ctypes.CFUNCTYPE(restype, *argtypes)
+        return prototype(self.symbols[name])
+
+    def run(self, argv):
+        """Call main with the given list of arguments, as strings.
+
+        The output the program buffered in the C library is flushed once
+        main returns.
+
+        returns - the value main returned
+        """
+        main = self.function("main", ctypes.c_int,
+                             [ctypes.c_int, ctypes.POINTER(ctypes.c_char_p)])
+        args = (ctypes.c_char_p * (len(argv) + 1))(
+            *[arg.encode() for arg in argv], None)
+        status = main(len(argv), args)
+        ctypes.CDLL(None).fflush(None)
+        return status & 0xFF
+
+
+class _Object:
+    """The parts of an ELF64 relocatable object which the JIT loads.
+
+    sections (List[dict]) - The header of each section, by index.
+    symbols (List[dict]) - Each symbol of the symbol table, by index.
+    relocs (List[tuple]) - The section, offset in the section, type, index
+    of the symbol, and addend of each relocation of an allocated section.
+    """
+
+    def __init__(self, data):
+        """Read the sections, symbols, and relocations of the object."""
+        self.data = data
+        shoff, = struct.unpack_from("<Q", data, 0x28)
+        shnum, = struct.unpack_from("<H", data, 0x3C)
+
+        self.sections = []
+        for i in range(shnum):
+            (_, kind, flags, _, offset, size, link, info, align,
+             _) = struct.unpack_from("<IIQQQQIIQQ", data, shoff + 64 * i)
+            self.sections.append({"kind": kind, "flags": flags,
+                                  "offset": offset, "size": size,
+                                  "link": link, "info": info,
+                                  "align": max(align, 1), "start": 0})
+
+        self.symbols = []
+        self.relocs = []
+        for section in self.sections:
+            if section["kind"] == SHT_SYMTAB:
+                self._read_symbols(section)
+        for section in self.sections:
+            if section["kind"] != SHT_RELA:
+                continue
+            target = self.sections[section["info"]]
+            if target["flags"] & SHF_ALLOC:
+                for i in range(section["size"] // 24):
+                    offset, info, addend = struct.unpack_from(
+                        "<QQq", data, section["offset"] + 24 * i)
+                    self.relocs.append((target, offset, info & 0xFFFFFFFF,
+                                        info >> 32, addend))
+
+    def _read_symbols(self, symtab):
+        """Read the symbols of the given symbol table section."""
+        names = self.sections[symtab["link"]]["offset"]
+        for i in range(symtab["size"] // 24):
+            name, info, _, shndx, value, size = struct.unpack_from(
+                "<IBBHQQ", self.data, symtab["offset"] + 24 * i)
+            end = self.data.index(b"\0", names + name)
+            self.symbols.append({
+                "name": self.data[names + name:end].decode(),
+                "global": info >> 4 != STB_LOCAL, "shndx": shndx,
+                "value": value, "size": size})
+
+
+def _align(offset, align):
+    """Return the offset rounded up to a multiple of `align`."""
+    return -(-offset // align) * align
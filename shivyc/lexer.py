@@ -3,124 +3,253 @@
 The lexing phase takes the entire contents of a raw input file and
 generates a flat list of tokens present in that input file.
 
+The input is scanned once, as a string. Characters are referred to by
+their index into the string, and a token records the Position of its first
+and last characters as an index into the Source of the file, so the line
+and column of a token are only computed if an error about it is shown.
+
+The preprocessor reads a file through Lines, which tokenizes each line only
+when it is first asked for, so the lines skipped by a conditional directive
+are never tokenized.
+
 """
+import bisect
 import re
+import sys
 
 import shivyc.token_kinds as token_kinds
-from shivyc.errors import CompilerError, Position, Range, error_collector
+from shivyc.errors import (CompilerError, Range, Source, SourcePosition,
+                           error_collector)
+from shivyc.timing import timer
 from shivyc.tokens import Token
 from shivyc.token_kinds import symbol_kinds, keyword_kinds
 
 
-class Tagged:
-    """Class representing tagged characters.
+def make_token_pattern():
+    """Return a regular expression matching the next piece of a line.
 
-    c (char) - the character that is tagged
-    p (Position) - position of the tagged character
-    r (Range) - a length-one range for the character
+    The expression has one named group for each kind of piece: space, the
+    start of a comment, a number, a symbol, or a word. A number is a
+    preprocessing number, which starts with a digit or with a period and a
+    digit, so the `.` of `1.5` does not start a symbol and the `+` of `1e+5`
+    does not end the number. A word is a run of characters which are not
+    space and do not start a symbol, so it is a keyword or identifier, or
+    else an unrecognized token. Symbols are tried longest first, so the
+    longest symbol at a position is matched.
     """
-
-    def __init__(self, c, p):
-        """Initialize object."""
-        self.c = c
-        self.p = p
-        self.r = Range(p, p)
-
-
-def tokenize(code, filename):
-    """Convert given code into a flat list of Tokens.
-
-    lines - List of list of Tagged objects, where each embedded list is a
-    separate line in the input program.
-    return - List of Token objects.
+    symbols = sorted((kind.text_repr for kind in symbol_kinds),
+                     key=lambda text: -len(text))
+    singles = {text for text in symbols if len(text) == 1}
+
+    word_char = "[^\\s" + "".join(re.escape(c) for c in sorted(singles)) + "]"
+
+    # A character which starts only longer symbols, like the `|` of `||`,
+    # is part of a word when it does not start one of those symbols.
+    for first in sorted({text[0] for text in symbols} - singles):
+        longer = "|".join(re.escape(text) for text in symbols
+                          if text[0] == first)
+        word_char = f"(?:{word_char}|(?!{longer}){re.escape(first)})"
+
+    return re.compile(
+        "(?P<space>\\s+)|(?P<comment>/\\*)|(?P<line_comment>//)"
+        "|(?P<number>\\.?[0-9](?:[eE][+-]|[0-9A-Za-z_.])*)"
+        f"|(?P<symbol>{'|'.join(re.escape(text) for text in symbols)})"
+        f"|(?P<word>{word_char}+)")
+
+
+token_pattern = make_token_pattern()
+identifier_pattern = re.compile(r"[_a-zA-Z][_a-zA-Z0-9]*")
+float_pattern = re.compile(
+    r"(?:[0-9]+\.[0-9]*|\.[0-9]+)(?:[eE][+-]?[0-9]+)?[fFlL]?"
+    r"|[0-9]+[eE][+-]?[0-9]+[fFlL]?")
+directive_pattern = re.compile(
+    r"[ \t\f\v]*#[ \t\f\v]*([_a-zA-Z][_a-zA-Z0-9]*)?")
+symbols_by_text = {kind.text_repr: kind for kind in symbol_kinds}
+keywords_by_text = {kind.text_repr: kind for kind in keyword_kinds}
+
+
+class Text:
+    """Class representing the input text with escaped newlines removed.
+
+    text (str) - Text with each backslash-newline pair removed, so the lines
+    split by them are joined into one.
+    source (Source) - Source of the original input text.
+    splices (List[int]) - Index in `text` of each place a backslash-newline
+    was removed.
+    lengths (List[int]) - Total number of characters removed up to and
+    including each splice.
     """
-    # Store tokens as they are generated
-    tokens = []
 
-    lines = split_to_tagged_lines(code, filename)
-    join_extended_lines(lines)
+    def __init__(self, code, filename):
+        """Initialize the text, joining lines which end in a backslash."""
+        self.source = Source(filename, code)
+        self.splices = []
+        self.lengths = []
+
+        # TODO: GCC supports \ followed by whitespace. Should ShivyC do this
+        # too?
+        pieces = []
+        last = 0
+        removed = 0
+        for match in re.finditer(r"\\(\r?\n|\r?$)", code):
+            pieces.append(code[last:match.start()])
+            removed += match.end() - match.start()
+            self.splices.append(match.start() - self.lengths[-1]
+                                if self.lengths else match.start())
+            self.lengths.append(removed)
+            last = match.end()
+        pieces.append(code[last:])
+        self.text = "".join(pieces)
+
+    def p(self, index):
+        """Return the Position of the character at `index` in the text."""
+        n = bisect.bisect_right(self.splices, index)
+        return SourcePosition(self.source,
+                              index + (self.lengths[n - 1] if n else 0))
+
+    def r(self, start, end=None):
+        """Return the Range of the characters from `start` to `end`.
+
+        Both ends are included. If `end` is not given, the range is the one
+        character at `start`, and its ends share one Position.
+        """
+        start_p = self.p(start)
+        if end is None or end == start:
+            return Range(start_p, start_p)
+        return Range(start_p, self.p(end))
+
+
+class Lines:
+    """Class representing the lines of an input file.
+
+    Each line is tokenized when it is first asked for, and its tokens are
+    kept for the next time, so a header included many times is tokenized
+    once. The issues found tokenizing a line are kept too, and added to the
+    error collector again each time the line is asked for.
+
+    text (Text) - Text of the file.
+    starts (List[int]) - Index in the text of the start of each line.
+    """
 
-    in_comment = False
-    for line in lines:
+    def __init__(self, code, filename):
+        """Initialize the lines, splitting the text at each newline."""
+        self.text = Text(code, filename)
+        self.starts = [0]
+        index = self.text.text.find("\n")
+        while index != -1:
+            self.starts.append(index + 1)
+            index = self.text.text.find("\n", index + 1)
+
+        # Map from a line number, and whether the line starts in a comment,
+        # to its tokens, whether the next line starts in a comment, and the
+        # issues found tokenizing it.
+        self._lines = {}
+
+    def __len__(self):
+        """Return the number of lines."""
+        return len(self.starts)
+
+    def _end(self, n):
+        """Return the index just past the last character of line n."""
+        if n + 1 < len(self.starts):
+            return self.starts[n + 1] - 1
+        return len(self.text.text)
+
+    def tokens(self, n, in_comment):
+        """Return the tokens of line n, counting from 0.
+
+        in_comment - Whether the line starts inside a C-style comment.
+        return - List of Token objects, and boolean indicating whether the
+        next line starts inside a comment.
+        """
+        line = self._lines.get((n, in_comment))
+        if line:
+            tokens, next_comment, issues = line
+            error_collector.extend(issues)
+            return tokens, next_comment
+
+        count = len(error_collector.issues)
         try:
-            line_tokens, in_comment = tokenize_line(line, in_comment)
-            tokens += line_tokens
+            with timer.phase("lex"):
+                tokens, next_comment = tokenize_line(
+                    self.text, self.starts[n], self._end(n), in_comment)
         except CompilerError as e:
             error_collector.add(e)
+            tokens, next_comment = [], in_comment
+
+        issues = error_collector.issues[count:]
+        self._lines[(n, in_comment)] = tokens, next_comment, issues
+        return tokens, next_comment
+
+    def scan(self, n, in_comment):
+        """Scan line n without tokenizing it.
+
+        Only comments are found, and not strings, so this is only for lines
+        which are being skipped.
+
+        in_comment - Whether the line starts inside a C-style comment.
+        return - The name of the directive on the line, or None if it is not
+        a directive or the directive has no name, and boolean indicating
+        whether the next line starts inside a comment.
+        """
+        line = self.text.text
+        i, end = self.starts[n], self._end(n)
+
+        directive = None
+        if not in_comment:
+            match = directive_pattern.match(line, i, end)
+            if match:
+                directive = match.group(1)
+
+        while i < end:
+            if in_comment:
+                i = line.find("*/", i, end)
+                if i == -1:
+                    break
+                in_comment = False
+                i += 2
+            else:
+                i = line.find("/", i, end)
+                if i == -1 or line.startswith("//", i):
+                    break
+                if line.startswith("/*", i):
+                    in_comment = True
+                    i += 1
+                i += 1
 
-    return tokens
-
+        return directive, in_comment
 
-def split_to_tagged_lines(text, filename):
-    """Split the input text into tagged lines.
 
-    No newline escaping or other preprocessing is done by this function.
+def tokenize(code, filename):
+    """Convert given code into a flat list of Tokens.
 
-    text (str) - Input file contents as a string.
-    filename (str) - Input file name.
-    return - Tagged lines. List of list of Tagged objects, where each second
-    order list is a separate line in the input progam. No newline characters.
+    return - List of Token objects.
     """
-    lines = text.splitlines()
-    tagged_lines = []
-    for line_num, line in enumerate(lines):
-        tagged_line = []
-        for col, char in enumerate(line):
-            p = Position(filename, line_num + 1, col + 1, line)
-            tagged_line.append(Tagged(char, p))
-        tagged_lines.append(tagged_line)
-
-    return tagged_lines
-
-
-def join_extended_lines(lines):
-    """Join together any lines which end in an escaped newline.
-
-    This function modifies the given lines object in place.
+    lines = Lines(code, filename)
 
-    lines - List of list of Tagged objects, where each embedded list is a
-    separate line in the input program.
-    """
-    # TODO: GCC supports \ followed by whitespace. Should ShivyC do this too?
-
-    i = 0
-    while i < len(lines):
-        if lines[i] and lines[i][-1].c == "\\":
-            # There is a next line to collapse into this one
-            if i + 1 < len(lines):
-                del lines[i][-1]  # remove trailing backslash
-                lines[i] += lines[i + 1]  # concatenate with next line
-                del lines[i + 1]  # remove next line
-
-                # Decrement i, so this line is checked for a new trailing
-                # backslash.
-                i -= 1
-
-            # There is no next line to collapse into this one
-            else:
-                # TODO: print warning?
-                del lines[i][-1]  # remove trailing backslash
+    tokens = []
+    in_comment = False
+    for n in range(len(lines)):
+        line_tokens, in_comment = lines.tokens(n, in_comment)
+        tokens += line_tokens
 
-        i += 1
+    return tokens
 
 
-def tokenize_line(line, in_comment):
-    """Tokenize the given single line.
+def tokenize_line(text, start, end, in_comment):
+    """Tokenize the single line from `start` to `end` in the text.
 
-    line - List of Tagged objects.
+    text (Text) - Text to tokenize.
+    start (int) - Index of the first character of the line.
+    end (int) - Index just past the last character of the line.
     in_comment - Whether the first character in this line is part of a
     C-style comment body.
     return - List of Token objects, and boolean indicating whether the next
     character is part of a comment body.
     """
     tokens = []
-
-    # line[chunk_start:chunk_end] is the section of the line currently
-    # being considered for conversion into a token; this string will be
-    # called the 'chunk'. Everything before the chunk has already been
-    # tokenized, and everything after has not yet been examined
-    chunk_start = 0
-    chunk_end = 0
+    line = text.text
+    i = start
 
     # Flag that is set True if the line begins with `#` and `include`,
     # perhaps with comments and whitespace in between.
@@ -129,44 +258,32 @@ def tokenize_line(line, in_comment):
     # filename has been seen and succesfully parsed.
     seen_filename = False
 
-    while chunk_end < len(line):
-        symbol_kind = match_symbol_kind_at(line, chunk_end)
-        next_symbol_kind = match_symbol_kind_at(line, chunk_end + 1)
+    while i < end:
+        if in_comment:
+            # Skip to the end of the comment, or of the line.
+            comment_end = line.find("*/", i, end)
+            if comment_end == -1:
+                break
+            in_comment = False
+            i = comment_end + 2
+            continue
 
         # Set include_line flag True as soon as a `#include` is detected.
         if match_include_command(tokens):
             include_line = True
 
-        if in_comment:
-            # If next characters end the comment...
-            if (symbol_kind == token_kinds.star and
-                    next_symbol_kind == token_kinds.slash):
-                in_comment = False
-                chunk_start = chunk_end + 2
-                chunk_end = chunk_start
-            # Otherwise, just skip one character.
-            else:
-                chunk_start = chunk_end + 1
-                chunk_end = chunk_start
-
-        # If next characters start a comment, process previous chunk and set
-        # in_comment to true.
-        elif (symbol_kind == token_kinds.slash and
-                next_symbol_kind == token_kinds.star):
-            add_chunk(line[chunk_start:chunk_end], tokens)
+        match = token_pattern.match(line, i, end)
+        group = match.lastgroup
+
+        if group == "space":
+            pass
+        elif group == "comment":
             in_comment = True
 
         # If next two characters are //, we skip the rest of this line.
-        elif (symbol_kind == token_kinds.slash and
-                next_symbol_kind == token_kinds.slash):
+        elif group == "line_comment":
             break
 
-        # Skip spaces and process previous chunk.
-        elif line[chunk_end].c.isspace():
-            add_chunk(line[chunk_start:chunk_end], tokens)
-            chunk_start = chunk_end + 1
-            chunk_end = chunk_start
-
         # If this is an include line, and not a comment or whitespace,
         # expect the line to match an include filename.
         elif include_line:
@@ -175,30 +292,31 @@ def tokenize_line(line, in_comment):
             # tokens.
             if seen_filename:
                 descrip = "extra tokens at end of include directive"
-                raise CompilerError(descrip, line[chunk_end].r)
+                raise CompilerError(descrip, text.r(i))
 
-            filename, end = read_include_filename(line, chunk_end)
+            filename, close = read_include_filename(text, i, end)
             tokens.append(Token(token_kinds.include_file, filename,
-                                r=Range(line[chunk_end].p, line[end].p)))
-
-            chunk_start = end + 1
-            chunk_end = chunk_start
+                                r=text.r(i, close)))
             seen_filename = True
+            i = close + 1
+            continue
+
+        elif group == "word" or group == "number":
+            add_word(text, i, match.end(), tokens)
 
         # If next character is a quote, we read the whole string as a token.
-        elif symbol_kind in {token_kinds.dquote, token_kinds.squote}:
-            if symbol_kind == token_kinds.dquote:
-                quote_str = '"'
+        elif match.group() in {'"', "'"}:
+            if match.group() == '"':
                 kind = token_kinds.string
                 add_null = True
             else:
-                quote_str = "'"
                 kind = token_kinds.char_string
                 add_null = False
 
-            chars, end = read_string(line, chunk_end + 1, quote_str, add_null)
-            rep = chunk_to_str(line[chunk_end:end + 1])
-            r = Range(line[chunk_end].p, line[end].p)
+            chars, close = read_string(text, i + 1, end, match.group(),
+                                       add_null)
+            rep = line[i:close + 1]
+            r = text.r(i, close)
 
             if kind == token_kinds.char_string and len(chars) == 0:
                 err = "empty character constant"
@@ -208,70 +326,22 @@ def tokenize_line(line, in_comment):
                 error_collector.add(CompilerError(err, r))
 
             tokens.append(Token(kind, chars, rep, r=r))
+            i = close + 1
+            continue
 
-            chunk_start = end + 1
-            chunk_end = chunk_start
-
-        # If next character is another symbol, add previous chunk and then
-        # add the symbol.
-        elif symbol_kind:
-            symbol_start_index = chunk_end
-            symbol_end_index = chunk_end + len(symbol_kind.text_repr) - 1
-
-            r = Range(line[symbol_start_index].p, line[symbol_end_index].p)
-            symbol_token = Token(symbol_kind, r=r)
-
-            add_chunk(line[chunk_start:chunk_end], tokens)
-            tokens.append(symbol_token)
-
-            chunk_start = chunk_end + len(symbol_kind.text_repr)
-            chunk_end = chunk_start
-
-        # Include another character in the chunk.
         else:
-            chunk_end += 1
+            symbol_kind = symbols_by_text[match.group()]
+            tokens.append(Token(symbol_kind, r=text.r(i, match.end() - 1)))
 
-    # Flush out anything that is left in the chunk to the output
-    add_chunk(line[chunk_start:chunk_end], tokens)
+        i = match.end()
 
     # Catch a `#include` on a line by itself.
     if (include_line or match_include_command(tokens)) and not seen_filename:
-        read_include_filename(line, chunk_end)
+        read_include_filename(text, end, end)
 
     return tokens, in_comment
 
 
-def chunk_to_str(chunk):
-    """Convert the given chunk to a string.
-
-    chunk - list of Tagged characters.
-    return - string representation of the list of Tagged characters
-    """
-    return "".join(c.c for c in chunk)
-
-
-def match_symbol_kind_at(content, start):
-    """Return the longest matching symbol token kind.
-
-    content - List of Tagged objects in which to search for match.
-    start (int) - Index, inclusive, at which to start searching for a match.
-    returns (TokenType or None) - Symbol token found, or None if no token
-    is found.
-
-    """
-    for symbol_kind in symbol_kinds:
-        try:
-            for i, c in enumerate(symbol_kind.text_repr):
-                if content[start + i].c != c:
-                    break
-            else:
-                return symbol_kind
-        except IndexError:
-            pass
-
-    return None
-
-
 def match_include_command(tokens):
     """Check if end of `tokens` is a `#include` directive."""
     return (len(tokens) == 2 and
@@ -280,7 +350,7 @@ def match_include_command(tokens):
             tokens[-1].content == "include")
 
 
-def read_string(line, start, delim, null):
+def read_string(text, start, end, delim, null):
     """Return a lexed string list in input characters.
 
     Also returns the index of the string end quote.
@@ -295,11 +365,13 @@ def read_string(line, start, delim, null):
     ASCII value (between 0 and 128) of the corresponding character in
     the string. The returned lexed string includes a null-terminator.
 
-    line - List of Tagged objects for each character in the line.
+    text (Text) - Text containing the string.
     start - Index at which to start reading the string.
+    end - Index of the end of the line containing the string.
     delim - Delimiter with which the string ends, like `"` or `'`
     null - Whether to add a null-terminator to the returned character list
     """
+    line = text.text
     i = start
     chars = []
 
@@ -318,44 +390,44 @@ def read_string(line, start, delim, null):
     hexdigits = "0123456789abcdefABCDEF"
 
     while True:
-        if i >= len(line):
+        if i >= end:
             descrip = "missing terminating quote"
-            raise CompilerError(descrip, line[start - 1].r)
-        elif line[i].c == delim:
+            raise CompilerError(descrip, text.r(start - 1))
+        elif line[i] == delim:
             if null: chars.append(0)
             return chars, i
-        elif (i + 1 < len(line)
-              and line[i].c == "\\"
-              and line[i + 1].c in escapes):
-            chars.append(escapes[line[i + 1].c])
+        elif (i + 1 < end
+              and line[i] == "\\"
+              and line[i + 1] in escapes):
+            chars.append(escapes[line[i + 1]])
             i += 2
-        elif (i + 1 < len(line)
-              and line[i].c == "\\"
-              and line[i + 1].c in octdigits):
-            octal = line[i + 1].c
+        elif (i + 1 < end
+              and line[i] == "\\"
+              and line[i + 1] in octdigits):
+            octal = line[i + 1]
             i += 2
-            while (i < len(line)
+            while (i < end
                    and len(octal) < 3
-                   and line[i].c in octdigits):
-                octal += line[i].c
+                   and line[i] in octdigits):
+                octal += line[i]
                 i += 1
             chars.append(int(octal, 8))
-        elif (i + 2 < len(line)
-              and line[i].c == "\\"
-              and line[i + 1].c == "x"
-              and line[i + 2].c in hexdigits):
-            hexa = line[i + 2].c
+        elif (i + 2 < end
+              and line[i] == "\\"
+              and line[i + 1] == "x"
+              and line[i + 2] in hexdigits):
+            hexa = line[i + 2]
             i += 3
-            while i < len(line) and line[i].c in hexdigits:
-                hexa += line[i].c
+            while i < end and line[i] in hexdigits:
+                hexa += line[i]
                 i += 1
             chars.append(int(hexa, 16))
         else:
-            chars.append(ord(line[i].c))
+            chars.append(ord(line[i]))
             i += 1
 
 
-def read_include_filename(line, start):
+def read_include_filename(text, start, end):
     """Read a filename that follows a #include directive.
 
     Expects line[start] to be one of `<` or `"`, then reads characters until a
@@ -363,99 +435,48 @@ def read_include_filename(line, start):
     read including the initial and final symbol markers. The index returned
     is that of the closing token in the filename.
     """
-    if start < len(line) and line[start].c == '"':
-        end = '"'
-    elif start < len(line) and line[start].c == "<":
-        end = ">"
+    line = text.text
+    if start < end and line[start] == '"':
+        close = '"'
+    elif start < end and line[start] == "<":
+        close = ">"
     else:
         descrip = "expected \"FILENAME\" or <FILENAME> after include directive"
-        if start < len(line):
-            char = line[start]
-        else:
-            char = line[-1]
-
-        raise CompilerError(descrip, char.r)
+        raise CompilerError(descrip, text.r(min(start, end - 1)))
 
-    i = start + 1
-    try:
-        while line[i].c != end:
-            i += 1
-    except IndexError:
+    i = line.find(close, start + 1, end)
+    if i == -1:
         descrip = "missing terminating character for include filename"
-        raise CompilerError(descrip, line[start].r)
+        raise CompilerError(descrip, text.r(start))
 
-    return chunk_to_str(line[start:i + 1]), i
+    return line[start:i + 1], i
 
 
-def add_chunk(chunk, tokens):
-    """Convert chunk into a token if possible and add to tokens.
+def add_word(text, start, end, tokens):
+    """Convert a word into a token and add it to tokens.
 
-    If chunk is non-empty but cannot be made into a token, this function
-    records a compiler error. We don't need to check for symbol kind tokens
-    here because they are converted before they are shifted into the chunk.
+    A word is a preprocessing number, or a run of characters which neither
+    are whitespace nor start a symbol. If the word is not a keyword, an
+    integer or floating number, or an identifier, this function raises a
+    compiler error.
 
-    chunk - Chunk to convert into a token, as list of Tagged characters.
+    text (Text) - Text containing the word.
+    start, end (int) - Index of the start of the word, and just past its
+    end.
     tokens (List[Token]) - List of the tokens thusfar parsed.
 
     """
-    if chunk:
-        range = Range(chunk[0].p, chunk[-1].p)
-
-        keyword_kind = match_keyword_kind(chunk)
-        if keyword_kind:
-            tokens.append(Token(keyword_kind, r=range))
-            return
-
-        number_string = match_number_string(chunk)
-        if number_string:
-            tokens.append(Token(token_kinds.number, number_string, r=range))
-            return
-
-        identifier_name = match_identifier_name(chunk)
-        if identifier_name:
-            tokens.append(Token(
-                token_kinds.identifier, identifier_name, r=range))
-            return
-
-        descrip = f"unrecognized token at '{chunk_to_str(chunk)}'"
-        raise CompilerError(descrip, range)
-
-
-def match_keyword_kind(token_repr):
-    """Find the longest keyword token kind with representation token_repr.
-
-    token_repr - Token representation to match exactly, as list of Tagged
-    characters.
-    returns (TokenKind, or None) - Keyword token kind that matched.
-
-    """
-    token_str = chunk_to_str(token_repr)
-    for keyword_kind in keyword_kinds:
-        if keyword_kind.text_repr == token_str:
-            return keyword_kind
-    return None
-
-
-def match_number_string(token_repr):
-    """Return a string that represents the given constant number.
-
-    token_repr - List of Tagged characters.
-    returns (str, or None) - String representation of the number.
-
-    """
-    token_str = chunk_to_str(token_repr)
-    return token_str if token_str.isdigit() else None
-
-
-def match_identifier_name(token_repr):
-    """Return a string that represents the name of an identifier.
-
-    token_repr - List of Tagged characters.
-    returns (str, or None) - String name of the identifier.
-
-    """
-    token_str = chunk_to_str(token_repr)
-    if re.match(r"[_a-zA-Z][_a-zA-Z0-9]*$", token_str):
-        return token_str
+    word = text.text[start:end]
+    range = text.r(start, end - 1)
+
+    keyword_kind = keywords_by_text.get(word)
+    if keyword_kind:
+        tokens.append(Token(keyword_kind, r=range))
+    elif word.isdigit() or float_pattern.fullmatch(word):
+        tokens.append(Token(token_kinds.number, word, r=range))
+    elif identifier_pattern.fullmatch(word):
+        tokens.append(Token(token_kinds.identifier, sys.intern(word),
+                            r=range))
     else:
-        return None
+        descrip = f"unrecognized token at '{word}'"
+        raise CompilerError(descrip, range)
@@ -0,0 +1,269 @@
+"""Serialized IL code, for reuse across builds and link-time optimization.
+
+The IL code of a file is saved as a unit: the IL commands of each function
+as it is made, before it is instrumented, inlined, or optimized, then the
+rest of the ILCode and the SymbolTable once the file is done. The unit is a
+stream of pickles made by one pickler, so an ILValue used by several
+functions is saved once and loaded as a single ILValue, and the stream is
+compressed with zlib.
+
+A unit is used in two ways. With -fcache-dir, it is cached under a hash of
+the preprocessed tokens of the file, so that a file compiled again with
+other flags is not parsed again. With -flto, it is stored in a section of
+the object file the program does not load, and at link time the units of
+all the objects are merged into one, so that calls are inlined across files
+and the functions nothing calls are dropped before the program is compiled
+as a whole.
+"""
+
+import hashlib
+import io
+import os
+import tempfile
+import zlib
+
+import shivyc
+import shivyc.cache as cache
+import shivyc.pch as pch
+from shivyc.il_cmds.value import AddrOf
+from shivyc.il_gen import ILCode, SymbolTable
+
+# Name of the section of an object file which holds its unit.
+SECTION = ".shivyc.il"
+
+
+class UnitWriter:
+    """Writer of the unit of a file, as each of its functions is made."""
+
+    def __init__(self):
+        """Initialize UnitWriter."""
+        self.out = io.BytesIO()
+        self.pickler = pch.Pickler(self.out)
+
+        # The unit as bytes, once it is finished.
+        self.data = None
+
+    def add(self, func, commands):
+        """Save the IL commands of function `func`, as they are now."""
+        self.pickler.dump((func, commands))
+
+    def finish(self, il_code, symbol_table):
+        """Save the rest of the IL code and the symbol table of the file.
+
+        What the IL code knows of a profile or of the functions compiled is
+        not saved, since it depends on how the file is compiled.
+
+        returns - the unit, as bytes
+        """
+        rest = ILCode()
+        rest.label_num = il_code.label_num
+        rest.cold_labels = il_code.cold_labels - il_code.counts.keys()
+        rest.taken_labels = il_code.taken_labels
+        rest.static_inits = il_code.static_inits
+        rest.literals = il_code.literals
+        rest.string_literals = il_code.string_literals
+        self.pickler.dump(None)
+        self.pickler.dump((rest, symbol_table))
+        self.data = zlib.compress(self.out.getvalue())
+        return self.data
+
+
+def read_unit(data):
+    """Return the IL code, the symbol table, and the list of functions in
+    the order they were made, of the unit given as bytes.
+    """
+    unpickler = pch.Unpickler(io.BytesIO(zlib.decompress(data)))
+    commands = {}
+    while True:
+        item = unpickler.load()
+        if item is None:
+            break
+        func, func_commands = item
+        commands[func] = func_commands
+
+    il_code, symbol_table = unpickler.load()
+    il_code.commands = commands
+    return il_code, symbol_table, list(commands)
+
+
+def key(tokens, lines=False):
+    """Return the key under which the unit of the given tokens is cached.
+
+    lines (bool) - Whether the IL code records the source line of each
+    command, as with -g.
+    """
+    digest = hashlib.sha256()
+    digest.update(f"shivyc {shivyc.__version__} il {lines}\n".encode())
+    cache.hash_tokens(digest, tokens, lines)
+    return digest.hexdigest()
+
+
+def fetch(cache_dir, key):
+    """Return the unit cached under `key`, read by read_unit, or None."""
+    try:
+        with open(_path(cache_dir, key), "rb") as file:
+            return read_unit(file.read())
+    except OSError:
+        return None
+
+
+def store(cache_dir, key, data):
+    """Save the unit `data` in the cache under `key`.
+
+    A unit which cannot be saved is made again next time, so errors writing
+    are ignored.
+    """
+    path = _path(cache_dir, key)
+    try:
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        fd, temp = tempfile.mkstemp(dir=os.path.dirname(path))
+        with os.fdopen(fd, "wb") as file:
+            file.write(data)
+        os.replace(temp, path)
+    except OSError:
+        pass
+
+
+def _path(cache_dir, key):
+    """Return the path of the unit of `key` in the cache directory."""
+    return os.path.join(cache_dir, "il", key + ".il")
+
+
+def merge(units):
+    """Merge the units of several files into one, as if one file.
+
+    The values of each unit with external linkage are replaced by the
+    values of the same name in the units before it, if any, so every
+    reference to a name is to one value. Functions with internal linkage
+    are renamed for the unit they come from, and the labels of each unit
+    are renumbered past those of the units before it.
+
+    units - list of units, each as returned by read_unit
+    returns - a unit, as returned by read_unit
+    """
+    il_code = ILCode()
+    symbol_table = SymbolTable()
+    EXTERNAL = symbol_table.EXTERNAL
+    INTERNAL = symbol_table.INTERNAL
+    funcs = []
+
+    for n, (unit_code, unit_table, unit_funcs) in enumerate(units):
+        mapping = {}
+        externals = symbol_table.linkages[EXTERNAL]
+        for name, var in unit_table.linkages[EXTERNAL].items():
+            if name in externals:
+                old = externals[name]
+                mapping[var] = old
+                if var.ctype.is_complete() and not old.ctype.is_complete():
+                    old.ctype = var.ctype
+                symbol_table.def_state[old] = max(
+                    symbol_table.def_state.get(old, 0),
+                    unit_table.def_state.get(var, 0))
+                if not symbol_table.storage.get(old):
+                    symbol_table.storage[old] = unit_table.storage.get(var)
+            else:
+                externals[name] = var
+
+        for table in ["linkage_type", "def_state", "storage", "names"]:
+            entries = getattr(symbol_table, table)
+            for var, value in getattr(unit_table, table).items():
+                if var not in mapping:
+                    entries[var] = value
+
+        # Objects with internal linkage are numbered apart from those of the
+        # same name in the files before.
+        for var in unit_table.static_numbers:
+            if var not in mapping:
+                symbol_table.number_static(var)
+        symbol_table.inline_hints.update(
+            mapping.get(var, var) for var in unit_table.inline_hints)
+        symbol_table.thread_locals.update(
+            mapping.get(var, var) for var in unit_table.thread_locals)
+
+        # Every function with internal linkage is renamed apart from those
+        # of the same name in other files, which it is emitted alongside.
+        renames = {}
+        for name, var in unit_table.linkages[INTERNAL].items():
+            if var.ctype.is_function():
+                renames[name] = f"{name}.lto{n}"
+                symbol_table.names[var] = renames[name]
+                symbol_table.linkages[INTERNAL][renames[name]] = var
+
+        offset = il_code.label_num
+        labels = {f"L{i}": f"L{i + offset}"
+                  for i in range(1, unit_code.label_num + 1)}
+        il_code.label_num += unit_code.label_num
+        il_code.cold_labels.update(labels.get(label, label)
+                                   for label in unit_code.cold_labels)
+        il_code.taken_labels.update(labels.get(label, label)
+                                    for label in unit_code.taken_labels)
+
+        for func in unit_funcs:
+            commands = unit_code.commands[func]
+            for command in commands:
+                command.replace_inputs(mapping)
+                command.replace_outputs(mapping)
+                if hasattr(command, "label"):
+                    command.label = labels.get(command.label, command.label)
+                if hasattr(command, "labels"):
+                    command.labels = [labels.get(label, label)
+                                      for label in command.labels]
+            il_code.commands[renames.get(func, func)] = commands
+            funcs.append(renames.get(func, func))
+
+        for var, image in unit_code.static_inits.items():
+            var = mapping.get(var, var)
+            if var in il_code.static_inits and not image:
+                continue
+            il_code.static_inits[var] = [
+                (start, size, (mapping.get(value[0], value[0]), value[1])
+                 if isinstance(value, tuple) else value)
+                for start, size, value in image]
+        il_code.literals.update(unit_code.literals)
+        il_code.string_literals.update(unit_code.string_literals)
+
+    return il_code, symbol_table, funcs
+
+
+def remove_dead_functions(il_code, symbol_table, funcs, closed):
+    """Drop the functions which nothing left may call.
+
+    A function is kept if its address is taken by a function kept or by
+    static data. If the program is closed, the only other function kept is
+    main; otherwise, every function with external linkage is kept too.
+
+    closed (bool) - whether the functions of the IL code are the whole
+    program, apart from the C library
+    returns - the list of functions kept, in the order of `funcs`
+    """
+    from shivyc.opt.inline import function_values
+
+    functions = function_values(il_code, symbol_table)
+    names = {v: name for name, v in functions.items()}
+
+    EXTERNAL = symbol_table.EXTERNAL
+    if closed and "main" in functions:
+        live = ["main"]
+    else:
+        live = [name for name, v in functions.items()
+                if symbol_table.linkage_type.get(v) == EXTERNAL]
+    for image in il_code.static_inits.values():
+        for _, _, value in image:
+            if isinstance(value, tuple) and value[0] in names:
+                live.append(names[value[0]])
+
+    kept = set()
+    while live:
+        func = live.pop()
+        if func in kept:
+            continue
+        kept.add(func)
+        for command in il_code.commands[func]:
+            if isinstance(command, AddrOf) and command.var in names:
+                live.append(names[command.var])
+
+    for func in funcs:
+        if func not in kept:
+            il_code.release(func)
+            symbol_table.def_state.pop(functions[func], None)
+    return [func for func in funcs if func in kept]
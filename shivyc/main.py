@@ -1,18 +1,41 @@
 """Main executable for ShivyC compiler."""
 
 import argparse
+import collections
+import copy
+import io
+import json
+import multiprocessing
+import os
 import pathlib
 import platform
 import subprocess
 import sys
+import tempfile
 
+import shivyc.asm_cmds as asm_cmds
+import shivyc.cache as cache
+import shivyc.elf as elf
+import shivyc.jit as jit
 import shivyc.lexer as lexer
+import shivyc.lto as lto
+import shivyc.pch as pch
 import shivyc.preproc as preproc
+import shivyc.schedule as schedule
+import shivyc.server as server
 
-from shivyc.errors import error_collector, CompilerError
+from shivyc.errors import error_collector, CompilerError, TooManyErrors
 from shivyc.parser.parser import parse
-from shivyc.il_gen import ILCode, SymbolTable, Context
+from shivyc.il_gen import ILCode, SymbolTable, Context, number_values
 from shivyc.asm_gen import ASMCode, ASMGen
+from shivyc.opt import PassManager, passes, pipelines
+from shivyc.opt.inline import Inliner, function_value
+from shivyc.opt.profile import (apply_profile, default_file, instrument,
+                                profile_name, read_profile)
+from shivyc.timing import counters, timer
+
+# Source of the runtime linked with programs built with -fprofile-generate.
+runtime_file = pathlib.Path(__file__).parent.joinpath("runtime", "profile.c")
 
 
 def main():
@@ -24,27 +47,257 @@ def main():
         return 1
 
     arguments = get_arguments()
+    if arguments.show_cache_stats:
+        return 0 if show_cache_stats(arguments.cache_dir) else 1
+    if arguments.serve:
+        return server.serve(arguments.serve)
 
-    objs = []
-    for file in arguments.files:
-        objs.append(process_file(file, arguments))
+    if arguments.time_report:
+        timer.enabled = True
+    status = compile_and_link(arguments)
+    if arguments.time_report:
+        show_time_report(arguments.time_report)
+    return status
 
-    error_collector.show()
-    if any(not obj for obj in objs):
-        return 1
-    else:
-        if not link("out", objs):
+
+def compile_and_link(arguments):
+    """Compile the files given, and link them unless -c or -S is given, or
+    run them with --run.
+
+    returns - the exit status of the compiler
+    """
+    # When linking, the object files of the C files are only temporary.
+    with tempfile.TemporaryDirectory(prefix="shivyc-") as temp_dir:
+        objs = process_files(arguments, temp_dir)
+        linking = not (arguments.compile_only or arguments.asm_only)
+        if arguments.profile_generate and all(objs) and linking:
+            objs.append(compile_runtime(arguments, temp_dir))
+        if arguments.lto and all(objs) and linking:
+            objs = optimize_at_link(objs, arguments, temp_dir)
+
+        error_collector.show()
+        if any(not obj for obj in objs):
+            return 1
+        elif arguments.compile_only or arguments.asm_only:
+            return 0
+        elif arguments.run:
+            return run(objs, arguments)
+
+        # The errors of finding the files to link with are shown here,
+        # since those of compiling were shown above.
+        shown = len(error_collector.issues)
+        if not link(arguments.output or "out", objs, arguments):
+            for issue in error_collector.issues[shown:]:
+                print(issue)
             err = "linker returned non-zero status"
             print(CompilerError(err))
             return 1
         return 0
 
 
-def process_file(file, args):
-    """Process single file into object file and return the object file name."""
+def run(objs, args):
+    """Load the given object files into this process and run their main.
+
+    returns - the exit status of the program, or 1 if it could not be loaded
+    """
+    shown = len(error_collector.issues)
+    contents = []
+    for obj in objs:
+        if obj[-3:] == ".so":
+            err = f"cannot load shared object '{obj}' with --run"
+            error_collector.add(CompilerError(err))
+            continue
+        with open(obj, "rb") as file:
+            contents.append(file.read())
+
+    program = jit.load(contents) if len(contents) == len(objs) else None
+    for issue in error_collector.issues[shown:]:
+        print(issue)
+    if not program:
+        return 1
+
+    sys.stdout.flush()
+    sys.stderr.flush()
+    return program.run([args.files[0]] + args.run_args)
+
+
+def show_time_report(style):
+    """Print the time of each phase and the counters to stderr.
+
+    style - "text" for a table, or "json" for a single JSON object with the
+    report of the timer under "phases", the counters under "counters", and
+    the time and change in IL commands of each pass under "passes"
+    """
+    phases = timer.report()
+    counts = timer.report_counts()
+    pass_times = timer.report_passes()
+    if style == "json":
+        print(json.dumps({"phases": phases, "counters": counts,
+                          "passes": pass_times}), file=sys.stderr)
+        return
+
+    total = sum(phase["time"] for phase in phases.values())
+    print(f"{'phase':<12}{'time (s)':>10}{'%':>7}{'peak RSS (kB)':>15}",
+          file=sys.stderr)
+    for name, phase in phases.items():
+        percent = 100 * phase["time"] / total if total else 0
+        rss = phase["peak_rss_kb"] or ""
+        print(f"{name:<12}{phase['time']:>10.3f}{percent:>7.1f}{rss:>15}",
+              file=sys.stderr)
+    print(f"{'total':<12}{total:>10.3f}", file=sys.stderr)
+
+    for name, n in counts.items():
+        descrip = counters.get(name, name)
+        print(f"{descrip:<34}{n:>10}", file=sys.stderr)
+
+    if pass_times:
+        print(f"{'pass':<16}{'time (s)':>10}{'commands':>10}",
+              file=sys.stderr)
+    for name, result in pass_times.items():
+        print(f"{name:<16}{result['time']:>10.3f}{result['commands']:>+10}",
+              file=sys.stderr)
+
+
+def output_name(file, n, args, temp_dir):
+    """Return the name of the file to write for the `n`th file given.
+
+    With -c or -S, this is the name given by -o, or else the name of the
+    file with the suffix changed, in the current directory. Otherwise, this
+    is the name of a temporary object file to link.
+    """
+    stem = pathlib.Path(file).stem
+    if args.asm_only:
+        return args.output or stem + ".s"
+    if args.compile_only:
+        return args.output or stem + ".o"
+    return str(pathlib.Path(temp_dir, f"{n}_{stem}.o"))
+
+
+def process_files(args, temp_dir):
+    """Process each file into an output file and return the output names.
+
+    If more than one job is allowed, the files are compiled in a pool of
+    processes. Either way, the warnings and errors of each file are
+    collected apart and then saved to the error collector in the order the
+    files were given, so output does not depend on which finishes first.
+    """
+    jobs = min(args.jobs, len(args.files))
+    tasks = [(file, output_name(file, n, args, temp_dir), args)
+             for n, file in enumerate(args.files)]
+    if jobs > 1:
+        with multiprocessing.Pool(jobs) as pool:
+            results = pool.starmap(process_file_apart, tasks)
+    else:
+        results = [process_file_apart(*task) for task in tasks]
+
+    error_collector.clear()
+    objs = []
+    for obj, issues, timer_state in results:
+        objs.append(obj)
+        error_collector.extend(issues)
+        if timer_state:
+            timer.merge(timer_state)
+    return objs
+
+
+def compile_runtime(args, temp_dir):
+    """Compile the runtime which programs built with -fprofile-generate are
+    linked with, as the program itself is compiled but not instrumented.
+
+    returns - the name of the object file, or None on error
+    """
+    runtime_args = argparse.Namespace(**vars(args))
+    runtime_args.profile_generate = False
+    runtime_args.profile_use = False
+    runtime_args.dep_file = False
+    runtime_args.jobs = 1
+    return process_c_file(str(runtime_file), str(pathlib.Path(
+        temp_dir, "profile.o")), runtime_args)
+
+
+def optimize_at_link(objs, args, temp_dir):
+    """Compile the units of IL code in the given objects as one program.
+
+    The units are merged, the functions nothing calls are dropped, and the
+    program is compiled into one object file, with calls inlined across
+    files. This object takes the place of the objects which had units. If
+    every object had a unit, only the functions main may call are kept.
+
+    returns - the list of objects to link, with None for an error
+    """
+    units = []
+    rest = []
+    for obj in objs:
+        try:
+            data = elf.read_section(obj, lto.SECTION)
+        except OSError:
+            data = None
+        if data:
+            with timer.phase("parse"):
+                units.append(lto.read_unit(data))
+        else:
+            rest.append(obj)
+    if not units:
+        return objs
+
+    il_code, symbol_table, funcs = lto.merge(units)
+    funcs = lto.remove_dead_functions(il_code, symbol_table, funcs,
+                                      closed=not rest and not args.shared)
+    lto_args = copy.copy(args)
+    lto_args.lto = False
+    lto_obj = str(pathlib.Path(temp_dir, "lto.o"))
+    if not generate_code([funcs], il_code, symbol_table, lto_obj, lto_obj,
+                         lto_args):
+        return [None]
+    return [lto_obj] + rest
+
+
+def process_file_apart(file, out_file, args):
+    """Process a single file with a new error collector.
+
+    In a worker process, the timer is cleared first and its state is
+    returned, so that it can be merged into the timer of the main process.
+
+    returns - the output file name, or None on error, the list of
+    warnings and errors found in the file, and the state of the timer if
+    this runs in a worker process, or else None
+    """
+    worker = multiprocessing.parent_process() is not None
+    if worker:
+        timer.clear()
+    error_collector.clear()
+    obj = compile_limited(process_file, file, out_file, args)
+    issues = error_collector.issues
+    error_collector.clear()
+    return obj, issues, timer.state() if worker else None
+
+
+def compile_limited(compile_func, *args):
+    """Call `compile_func` with -fmax-errors in effect.
+
+    The last argument is that of the command line. If compiling stops at
+    the limit, a note saying so is added after the errors.
+
+    returns - the result of compile_func, or None if compiling stopped
+    """
+    error_collector.max_errors = args[-1].max_errors
+    try:
+        return compile_func(*args)
+    except TooManyErrors as e:
+        error_collector.extend([CompilerError(str(e))])
+        return None
+    finally:
+        error_collector.max_errors = 0
+
+
+def process_file(file, out_file, args):
+    """Process single file into output file and return the output file name.
+
+    An object file or shared object is passed on to the linker as it is.
+    """
     if file[-2:] == ".c":
-        return process_c_file(file, args)
-    elif file[-2:] == ".o":
+        return process_c_file(file, out_file, args)
+    elif file[-2:] == ".o" or file[-3:] == ".so":
         return file
     else:
         err = f"unknown file type: '{file}'"
@@ -52,59 +305,515 @@ def process_file(file, args):
         return None
 
 
-def process_c_file(file, args):
-    """Compile a C file into an object file and return the object file name."""
+def process_c_file(file, out_file, args):
+    """Compile a C file and return the name of the output file.
+
+    The output is an object file, or an ASM file if -S is given.
+    """
     code = read_file(file)
     if not error_collector.ok():
         return None
 
-    token_list = lexer.tokenize(code, file)
+    included = []
+    with timer.phase("preproc"):
+        token_list = list(preproc.process(lexer.Lines(code, file), file,
+                                          included))
+    timer.count("tokens", len(token_list))
     if not error_collector.ok():
         return None
 
-    token_list = preproc.process(token_list, file)
-    if not error_collector.ok():
+    # The code compiled with a profile depends on the profile as well, so
+    # it is not cached.
+    use_cache = (args.cache_dir and not args.asm_only
+                 and not args.profile_use)
+    if use_cache:
+        cache_key = cache.key(token_list, args)
+
+    if not (use_cache and fetch_cached(args.cache_dir, cache_key, out_file)):
+        if not compile_tokens(token_list, out_file, file, args):
+            return None
+
+        # An object compiled with warnings is not cached, so that the
+        # warnings are shown each time the file is compiled.
+        if use_cache and not error_collector.issues:
+            store_cached(args.cache_dir, cache_key, out_file)
+
+    if args.dep_file:
+        write_deps(file, out_file, included, args)
+    return out_file
+
+
+def compile_string(source, flags=(), name="string.c"):
+    """Compile C source code in memory, and return the output.
+
+    No file is written, unless the ASM code is assembled with `as` by
+    -fno-integrated-as. Bundled headers and those included with quotes from
+    the directory of `name` are read as usual.
+
+    flags (List[str]) - Flags as the compiler takes them on the command
+    line, like ["-O1"]. With -S, the ASM code is returned rather than an
+    object file.
+    name (str) - Name of the C file the source code is compiled as
+    returns - the object file as bytes, or the ASM code as a str, or None if
+    there was an error, which is left in the error collector
+    """
+    error_collector.clear()
+    args = get_arguments(list(flags) + [name])
+    output = io.StringIO() if args.asm_only else io.BytesIO()
+    if not compile_limited(_compile_source, source, output, name, args):
         return None
+    return output.getvalue()
+
+
+def _compile_source(source, output, name, args):
+    """Compile source code into the given output, as compile_string does.
+
+    returns - whether the output was written
+    """
+    with timer.phase("preproc"):
+        token_list = list(preproc.process(lexer.Lines(source, name), name))
+    timer.count("tokens", len(token_list))
+    if not error_collector.ok():
+        return False
+    return compile_tokens(token_list, output, name, args)
+
+
+def compile_tokens(token_list, out_file, file, args):
+    """Compile preprocessed tokens of `file` into an object file or ASM file.
+
+    With -fcache-dir, the unit of IL code of the file is cached, and if it
+    was cached before, the file is not parsed again. With -flto, the unit
+    is also stored in the object file.
+
+    returns - whether the output file was written
+    """
+    # A unit is only made without a profile, which changes the IL code as
+    # each function is made.
+    profiled = args.profile_generate or args.profile_use
+    il_key = None
+    if args.cache_dir and not profiled:
+        il_key = lto.key(token_list, args.debug)
+        unit = lto.fetch(args.cache_dir, il_key)
+        if unit:
+            il_code, symbol_table, funcs = unit
+            writer = lto.UnitWriter() if args.lto else None
+            return generate_code([funcs], il_code, symbol_table, out_file,
+                                 file, args, writer)
+
+    # The bundled headers the file starts with are loaded precompiled, and
+    # only the tokens after them are parsed.
+    state, start = None, 0
+    if args.pch:
+        state, start = pch.load(token_list, args.cache_dir)
+    if state:
+        symbols, il_code, symbol_table = state
+    else:
+        symbols, il_code, symbol_table = None, ILCode(), SymbolTable()
+    il_code.debug = args.debug
 
     # If parse() can salvage the input into a parse tree, it may emit an
     # ast_root even when there are errors saved to the error_collector. In this
     # case, we still want to continue the compiler stages.
-    ast_root = parse(token_list)
+    with timer.phase("parse"):
+        ast_root = parse(token_list[start:], symbols, args.parse_memo)
     if not ast_root:
-        return None
+        return False
 
-    il_code = ILCode()
-    symbol_table = SymbolTable()
-    ast_root.make_il(il_code, symbol_table, Context())
-    if not error_collector.ok():
-        return None
+    writer = None
+    if il_key or (args.lto and not profiled):
+        writer = lto.UnitWriter()
+    written = generate_code(
+        make_functions(ast_root, il_code, symbol_table), il_code,
+        symbol_table, out_file, file, args, writer)
 
-    asm_code = ASMCode()
-    ASMGen(il_code, symbol_table, asm_code, args).make_asm()
-    asm_source = asm_code.full_code()
-    if not error_collector.ok():
-        return None
+    # A unit made with warnings is not cached, so that the warnings are
+    # shown each time the file is compiled.
+    if written and il_key and not error_collector.issues:
+        lto.store(args.cache_dir, il_key, writer.data)
+    return written
 
-    asm_file = file[:-2] + ".s"
-    obj_file = file[:-2] + ".o"
 
-    write_asm(asm_source, asm_file)
-    if not error_collector.ok():
-        return None
+def make_functions(ast_root, il_code, symbol_table):
+    """Make the IL code of the functions of a file in turn.
+
+    Yields the list of names of the functions made since the last list,
+    which may include some loaded with the precompiled headers.
+    """
+    added = set()
+    for _ in ast_root.make_il_each(il_code, symbol_table, Context()):
+        funcs = [func for func in il_code.commands if func not in added]
+        added.update(funcs)
+        yield funcs
+
+
+def generate_code(batches, il_code, symbol_table, out_file, file, args,
+                  writer=None):
+    """Compile the functions of the IL code into an object file or ASM file.
+
+    batches - iterable of lists of the names of the functions to compile,
+    as their IL code is made
+    file (str) - Name of the C file compiled, which names the functions in
+    a profile
+    out_file - Name of the output file, or a stream to write it to, which
+    is binary for an object file and text for an ASM file
+    writer (UnitWriter) - Writer to save the unit of the IL code to, as each
+    function is made, or None. With -flto, the unit is stored in the object
+    file.
+    returns - whether the output file was written
+    """
+    source = file if args.debug else None
+    assembler = None
+    if args.asm_only:
+        output = ASMFile(out_file, args.function_sections, source)
+    elif args.integrated_as:
+        output = ObjectFile(out_file, args.function_sections, source)
+    elif args.pipe or not isinstance(out_file, str):
+        assembler = Assembler(out_file)
+        output = ASMFile(assembler.stdin, args.function_sections, source)
+    else:
+        output = ASMFile(out_file[:-2] + ".s", args.function_sections,
+                         source)
 
-    assemble(asm_file, obj_file)
+    # Each function is compiled and written out as soon as its IL code is
+    # made, unless it is kept to be inlined later, and its IL code is then
+    # dropped. Once there is an error, the IL code of the rest of the file
+    # is still made to report its errors, but nothing more is compiled.
+    # With a profile, each function is instrumented or given its counts as
+    # soon as it is made, so that its blocks are the same either way.
+    profile = None
+    if args.profile_use:
+        profile = read_profile(args.profile_file) or {}
+
+    generator = CodeGenerator(il_code, symbol_table, output, args)
+    inliner = Inliner(il_code, symbol_table) if args.opt_level >= 2 else None
+    for funcs in batches:
+        for func in funcs:
+            if not error_collector.ok():
+                continue
+            if writer:
+                writer.add(func, il_code.commands[func])
+            name = profile_name(file, func)
+            if args.profile_generate:
+                instrument(il_code, symbol_table, func, name,
+                           args.profile_file)
+            elif profile is not None:
+                apply_profile(il_code, func, profile.get(name))
+            timer.count("il_commands", len(il_code.commands[func]))
+            if inliner:
+                with timer.phase("optimize"):
+                    funcs = inliner.add(func)
+                generator.add(funcs)
+            else:
+                generator.add([func])
+
+    if error_collector.ok():
+        if inliner:
+            with timer.phase("optimize"):
+                funcs = inliner.finish()
+            generator.add(funcs)
+        if writer:
+            writer.finish(il_code, symbol_table)
+            if args.lto:
+                generator.asm_code.add_il(writer.data)
+        generator.finish()
     if not error_collector.ok():
-        return None
+        generator.discard()
+        if assembler:
+            assembler.discard()
+        return False
+
+    if assembler:
+        assembler.finish()
+    elif not (args.asm_only or args.integrated_as):
+        assemble(output, out_file)
+    return error_collector.ok()
+
+
+class CodeGenerator:
+    """Generator of the ASM code of each function, written to an output.
+
+    With -j and a single file to compile, code is generated for several
+    functions at once in a pool of processes, after the functions are
+    optimized here. The IL commands of each function are sent to a worker
+    along with the spots of the global values they use, and the ASM code of
+    the functions is written out in the order they were added.
+    """
 
-    return obj_file
+    def __init__(self, il_code, symbol_table, output, args):
+        """Initialize CodeGenerator."""
+        self.il_code = il_code
+        self.symbol_table = symbol_table
+        self.output = output
+        self.args = args
+        self.asm_code = ASMCode(data_sections=args.data_sections)
+        self.asm_gen = ASMGen(il_code, symbol_table, self.asm_code, args)
 
+        # Size in bytes of the vectors loops are vectorized with, if any.
+        vector_size = 0
+        if args.avx2:
+            vector_size = 32
+        elif args.vectorize:
+            vector_size = 16
 
-def get_arguments():
+        # Most copies of a loop body to unroll loops by, if they are.
+        unroll_factor = args.unroll_factor if args.unroll_loops else 0
+
+        self.pass_manager = PassManager(
+            il_code, symbol_table, args.opt_level, vector_size,
+            unroll_factor, args.strict_aliasing, args.pic,
+            args.dump_il_after)
+
+        # The -z flags which print as each function is generated need it
+        # to be generated here.
+        self.pool = None
+        if (args.jobs > 1 and len(args.files) == 1
+              and not (args.show_spills or args.show_reg_alloc_perf
+                       or args.reg_alloc_graph_dir
+                       or args.show_peephole_hits)):
+            self.pool = multiprocessing.Pool(args.jobs)
+
+        # Results of the functions being generated in the pool, in order,
+        # each with what to store of the function in the cache.
+        self.pending = collections.deque()
+
+        # With -fcache-dir, the ASM code of each function which is unchanged
+        # is taken from the cache. The flags which instrument the code or
+        # print as each function is generated need it to be generated.
+        self.cache_dir = None
+        if (args.cache_dir
+              and not (args.profile_generate or args.profile_use
+                       or args.dump_il_after or args.show_spills
+                       or args.show_reg_alloc_perf
+                       or args.reg_alloc_graph_dir
+                       or args.show_peephole_hits)):
+            self.cache_dir = args.cache_dir
+
+        # A static function is only generated once a function generated
+        # refers to it, and those still deferred at the end are dropped. A
+        # function is generated after the static functions it refers to, so
+        # it is optimized with their summaries.
+        self.deferred = {}
+        self.referenced = set()
+
+    def add(self, funcs):
+        """Optimize and generate the given functions, and write them out."""
+        for func in funcs:
+            var = function_value(self.symbol_table, func)
+            if (self.symbol_table.linkage_type.get(var)
+                  == self.symbol_table.INTERNAL
+                  and var not in self.referenced):
+                self.deferred[var] = func
+            else:
+                self._generate(func)
+        self._write_done(wait=False)
+
+    def finish(self):
+        """Write out the rest of the functions and the static data.
+
+        The static functions deferred which the static data the program may
+        reach refers to are generated, and the rest are dropped.
+        """
+        while True:
+            live = self.asm_gen.live_statics()
+            funcs = [self.deferred.pop(var) for var in list(self.deferred)
+                     if var in live]
+            if not funcs:
+                break
+            for func in funcs:
+                self._generate(func)
+        for func in self.deferred.values():
+            self.il_code.release(func)
+        timer.count("dead_functions", len(self.deferred))
+
+        self._write_done(wait=True)
+        self._close_pool()
+        self.asm_gen.finish()
+        self.output.finish(self.asm_code)
+
+    def discard(self):
+        """Stop generating code, and drop the output."""
+        if self.pool:
+            self.pool.terminate()
+            self._close_pool()
+        self.output.discard()
+
+    def _generate(self, func):
+        """Optimize and generate function `func`, after the deferred static
+        functions it refers to.
+        """
+        for command in self.il_code.commands[func]:
+            for var in command.inputs():
+                if var and var.ctype.is_function():
+                    self.referenced.add(var)
+                    if var in self.deferred:
+                        self._generate(self.deferred.pop(var))
+
+        store = None
+        if self.cache_dir:
+            commands = self.il_code.commands[func]
+            values = number_values(commands)
+            key = cache.function_key(func, commands, self.il_code,
+                                     self.symbol_table, self.args)
+            entry = key and fetch_cached_function(self.cache_dir, key)
+            if entry:
+                self._reuse(func, entry, values)
+                self.il_code.release(func)
+                return
+            store = key and (key, values, len(error_collector.issues))
+
+        with timer.phase("optimize"):
+            self.pass_manager.run(func)
+        job = self.asm_gen.function_job(func)
+        if store:
+            store = self._cache_entry(store, job[2])
+        if self.pool:
+            pickled = pch.dumps((self.args, job))
+            self.pending.append((func, store, self.pool.apply_async(
+                generate_apart, (pickled,))))
+        else:
+            lines, rodata, regs = self.asm_gen.generate(*job)
+            summary = self.il_code.summaries.get(func)
+            if summary:
+                summary.regs = regs
+            self._add_function(func, (lines, rodata, regs), store)
+        self.il_code.release(func)
+
+    def _cache_entry(self, store, global_spotmap):
+        """Return what to store of a function in the cache, or None if it
+        cannot be stored.
+
+        store - the key of the function, the values its IL code used before
+        it was optimized, and the number of issues before it was
+        global_spotmap - the spots of the values not specific to the
+        function its optimized IL code uses
+        """
+        key, values, issues = store
+        index = {v: i for i, v in enumerate(values)}
+        literals = self.il_code.literals
+        uses = []
+        for v in global_spotmap:
+            if v in index:
+                uses.append(index[v])
+            elif v in literals and v.ctype.is_floating():
+                uses.append((literals[v], v.ctype.size))
+            elif v not in literals:
+                return None
+        return key, uses, issues
+
+    def _reuse(self, func, entry, values):
+        """Write out the ASM code of a function taken from the cache."""
+        result, summary, uses = entry
+        if summary:
+            # Functions generated in the pool never give their callers the
+            # registers they change.
+            summary.regs = None if self.pool else result[2]
+            self.il_code.summaries[func] = summary
+        self.asm_gen.use_globals(
+            [use if isinstance(use, tuple) else values[use] for use in uses])
+        if self.pool:
+            self.pending.append((func, None, _Reused(result)))
+        else:
+            self.output.add(self.asm_gen.add_function(result))
+
+    def _add_function(self, func, result, store):
+        """Write out the ASM code of a function generated, and store it in
+        the cache if asked and if it was made without warnings.
+        """
+        if store:
+            key, uses, issues = store
+            if len(error_collector.issues) == issues:
+                entry = (result, self.il_code.summaries.get(func), uses)
+                store_cached_function(self.cache_dir, key, entry)
+        self.output.add(self.asm_gen.add_function(result))
+
+    def _write_done(self, wait):
+        """Write out the functions done in order, waiting for all if asked."""
+        while self.pending and (wait or self.pending[0][2].ready()):
+            func, store, done = self.pending.popleft()
+            result, timer_state = done.get()
+            if timer_state:
+                timer.merge(timer_state)
+            self._add_function(func, result, store)
+
+    def _close_pool(self):
+        """Close the pool of processes, if there is one."""
+        if self.pool:
+            self.pool.close()
+            self.pool.join()
+            self.pool = None
+
+
+class _Reused:
+    """Result of a function taken from the cache, which waits in the pending
+    results of the pool like those of the functions generated there.
+    """
+
+    def __init__(self, result):
+        """Initialize _Reused."""
+        self.result = result
+
+    def ready(self):
+        """Return whether the result is ready, which it always is."""
+        return True
+
+    def get(self):
+        """Return the result, with no state of the timer."""
+        return self.result, None
+
+
+def generate_apart(job):
+    """Generate the ASM code of a function in a worker process.
+
+    job - the arguments and the result of ASMGen.function_job, pickled by
+    pch.dumps
+    returns - the result of ASMGen.generate, and the state of the timer
+    while generating it
+    """
+    args, (func, commands, global_spotmap, counts) = pch.loads(job)
+    timer.clear()
+    result = ASMGen(None, None, None, args).generate(
+        func, commands, global_spotmap, counts)
+    return result, timer.state()
+
+
+def write_deps(file, out_file, included, args):
+    """Write a make rule listing the files the output depends on.
+
+    The rule is written to the file named by -MF, or else to the name of the
+    output file with the suffix changed to .d.
+    """
+    if args.dep_file_name:
+        dep_name = args.dep_file_name
+    elif args.compile_only or args.asm_only:
+        dep_name = str(pathlib.Path(out_file).with_suffix(".d"))
+    else:
+        dep_name = pathlib.Path(file).stem + ".d"
+
+    # The rule names the object file which a build system would ask for.
+    target = out_file
+    if not (args.compile_only or args.asm_only):
+        target = pathlib.Path(file).stem + ".o"
+
+    deps = [file] + list(dict.fromkeys(included))
+    rule = f"{target}:" + "".join(
+        " \\\n " + dep.replace(" ", "\\ ") for dep in deps) + "\n"
+    try:
+        with open(dep_name, "w") as d_file:
+            d_file.write(rule)
+    except IOError:
+        descrip = f"could not write dependency file '{dep_name}'"
+        error_collector.add(CompilerError(descrip))
+
+
+def get_arguments(flags=None):
     """Get the command-line arguments.
 
     This function sets up the argument parser. Returns a tuple containing
     an object storing the argument values and a list of the file names
     provided on command line.
+
+    flags (List[str]) - The arguments to parse, rather than those the
+    compiler was run with.
     """
     desc = """Compile, assemble, and link C files. Option flags starting
     with `-z` are primarily for debugging or diagnostic purposes."""
@@ -112,14 +821,336 @@ def get_arguments():
         description=desc, usage="shivyc [-h] [options] files...")
 
     # Files to compile
-    parser.add_argument("files", metavar="files", nargs="+")
+    parser.add_argument("files", metavar="files", nargs="*")
+
+    # Stop after compiling, or after generating ASM, and name the output
+    parser.add_argument("-c", help="compile to object files, but do not link",
+                        dest="compile_only", action="store_true")
+    parser.add_argument("-S", help="generate ASM files, but do not assemble",
+                        dest="asm_only", action="store_true")
+    parser.add_argument("-o", metavar="FILE", dest="output",
+                        help="name of the output file (default: out when "
+                        "linking)")
+
+    # Write make rules for the files each output depends on
+    parser.add_argument("-MD", help="write the files each C file includes "
+                        "to a .d file, as a make rule",
+                        dest="dep_file", action="store_true")
+    parser.add_argument("-MF", metavar="FILE", dest="dep_file_name",
+                        help="write the rule of -MD to FILE, rather than "
+                        "to the name of the output with suffix .d")
+
+    # Number of files to compile at once
+    parser.add_argument("-j", type=int, default=1, dest="jobs",
+                        metavar="N", help="compile up to N files at once, "
+                        "or generate code for up to N functions at once "
+                        "when compiling one file")
+
+    # Optimization level, and the pass after which to print the IL code
+    parser.add_argument("-O", type=int, choices=sorted(pipelines),
+                        default=2, dest="opt_level", metavar="LEVEL",
+                        help="optimize the IL code with the passes of LEVEL: "
+                        "0 for none, 1 for the cheapest, or 2 for all, with "
+                        "inlining (default: 2)")
+
+    # Debugging information for debuggers and profilers
+    parser.add_argument("-g", dest="debug", action="store_true",
+                        help="record the source line of the code and how "
+                        "to unwind the frame of each function")
+
+    parser.add_argument("-fdump-il-after", metavar="PASS",
+                        choices=["make_il", "all"] + list(passes),
+                        dest="dump_il_after",
+                        help="print the IL code of each function after PASS "
+                        "runs, or as made with make_il, or after each pass "
+                        "with all; the passes are " + ", ".join(passes))
 
     # Boolean flag for whether to print register allocator performance info
     parser.add_argument("-z-reg-alloc-perf",
-                        help="display register allocator performance info",
+                        help="display the graph size, spills, preferences "
+                        "honoured, and frame size of each function",
                         dest="show_reg_alloc_perf", action="store_true")
 
-    return parser.parse_args()
+    # Directory to write the graph of each function allocated over to
+    parser.add_argument("-z-reg-alloc-graph", metavar="DIR",
+                        dest="reg_alloc_graph_dir",
+                        help="write the conflict and preference graph of "
+                        "each function to DIR as a Graphviz file")
+
+    # Register allocator to use
+    parser.add_argument("-freg-alloc", choices=["graph", "linear"],
+                        default="graph", dest="reg_alloc",
+                        help="register allocator: graph coloring (default) "
+                        "or the faster linear scan")
+
+    # Boolean flag for whether to print the values the allocator spills
+    parser.add_argument("-z-show-spills",
+                        help="display the values spilled to the stack",
+                        dest="show_spills", action="store_true")
+
+    # Boolean flag for whether to address stack values off RSP, not RBP
+    parser.add_argument("-fomit-frame-pointer",
+                        help="do not keep a frame pointer in RBP, and skip "
+                        "the frame of leaf functions where possible",
+                        dest="omit_frame_pointer", action="store_true")
+
+    # Boolean flag for whether to comment the ASM with the IL commands
+    parser.add_argument("-fverbose-asm",
+                        help="precede the ASM of each IL command with a "
+                        "comment naming the command",
+                        dest="verbose_asm", action="store_true")
+
+    # Boolean flag for whether to write ASM text and run `as` on it
+    parser.add_argument("-fno-integrated-as",
+                        help="write the ASM to a .s file and assemble it "
+                        "with `as`, rather than writing the object directly",
+                        dest="integrated_as", action="store_false")
+
+    parser.add_argument("-pipe",
+                        help="with -fno-integrated-as, pipe the ASM of each "
+                        "function to `as` as it is generated, rather than "
+                        "writing a .s file",
+                        dest="pipe", action="store_true")
+
+    # Directory of the cache of object files
+    parser.add_argument("-fcache-dir", metavar="DIR", dest="cache_dir",
+                        default=os.environ.get("SHIVYC_CACHE_DIR"),
+                        help="reuse object files, precompiled headers, and "
+                        "the code of functions cached in DIR for files "
+                        "compiled before (default: $SHIVYC_CACHE_DIR)")
+
+    # Number of errors after which to stop compiling a file
+    parser.add_argument("-fmax-errors", metavar="N", type=int, default=0,
+                        dest="max_errors",
+                        help="stop compiling a file once N errors are "
+                        "found, or never with 0 (default: 0)")
+
+    # Boolean flag for whether to load the bundled headers precompiled
+    parser.add_argument("-fno-pch",
+                        help="parse the bundled headers a file includes "
+                        "each time, rather than loading them precompiled",
+                        dest="pch", action="store_false")
+
+    # Boolean flag for whether to reuse productions parsed again
+    parser.add_argument("-fno-parse-memo",
+                        help="parse each production again on every "
+                        "speculative parse path that reaches it, for "
+                        "debugging the parser",
+                        dest="parse_memo", action="store_false")
+
+    # Whether to print the time of each phase and counters of the work done
+    parser.add_argument("-ftime-report", action="store_const", const="text",
+                        dest="time_report",
+                        help="display the time spent in each phase and "
+                        "counts of the tokens, nodes, commands, and "
+                        "instructions handled, on stderr")
+
+    parser.add_argument("-ftime-report-json", action="store_const",
+                        const="json", dest="time_report",
+                        help="display the report of -ftime-report as a "
+                        "single line of JSON, to aggregate across a build")
+
+    # Boolean flag for whether to optimize the program as a whole at link time
+    parser.add_argument("-flto",
+                        help="store the IL code of each file in its object "
+                        "file, and when linking, inline calls across files "
+                        "and drop the functions nothing calls",
+                        dest="lto", action="store_true")
+
+    # Boolean flags for whether to emit each function or object to its own
+    # section, so the linker can drop those nothing refers to
+    parser.add_argument("-ffunction-sections",
+                        help="emit each function to a text section of its "
+                        "own, so the linker drops the functions nothing "
+                        "calls",
+                        dest="function_sections", action="store_true")
+
+    parser.add_argument("-fdata-sections",
+                        help="emit each object to a data section of its own, "
+                        "so the linker drops the objects nothing refers to",
+                        dest="data_sections", action="store_true")
+
+    # Whether to generate position-independent code, for a shared object or
+    # for an executable loaded at any address
+    parser.add_argument("-fPIC", "-fpic",
+                        help="generate position-independent code for a "
+                        "shared object, which reaches the objects and "
+                        "functions with external linkage through the "
+                        "global offset table",
+                        dest="pic", action="store_const", const="pic")
+
+    parser.add_argument("-fPIE", "-fpie",
+                        help="generate position-independent code for an "
+                        "executable, which reaches only the objects and "
+                        "functions it does not define through the global "
+                        "offset table",
+                        dest="pic", action="store_const", const="pie")
+
+    # How to link the binary
+    parser.add_argument("-shared",
+                        help="link a shared object rather than an "
+                        "executable; the files must be compiled with -fPIC",
+                        dest="shared", action="store_true")
+
+    parser.add_argument("-pie",
+                        help="link an executable which may be loaded at any "
+                        "address; the files must be compiled with -fPIE",
+                        dest="pie", action="store_true")
+
+    parser.add_argument("-static",
+                        help="link the C library into the binary, so that "
+                        "it starts without the dynamic loader",
+                        dest="static", action="store_true")
+
+    parser.add_argument("-fuse-ld", choices=["bfd", "gold", "lld"],
+                        dest="linker", metavar="LINKER",
+                        help="link with ld.LINKER, which is one of bfd, "
+                        "gold, or lld, rather than ld")
+
+    # Options passed through to the linker. Since argparse does not split
+    # "-Wl,OPTIONS", it is given "-Wl=OPTIONS" instead.
+    parser.add_argument("-Wl", metavar="OPTIONS", action="append",
+                        default=[], dest="linker_args",
+                        help="pass OPTIONS, separated by commas, to the "
+                        "linker, as in -Wl,-Map,out.map")
+
+    # Boolean flag for whether to run the program rather than link it
+    parser.add_argument("--run",
+                        help="load the program into the compiler and run "
+                        "it, without linking, passing it the arguments "
+                        "after --; exit with the status of the program",
+                        dest="run", action="store_true")
+
+    # Unix socket to serve the requests of shivyc-client on
+    parser.add_argument("--serve", metavar="SOCKET", dest="serve",
+                        help="keep the compiler loaded, and compile the "
+                        "requests shivyc-client sends to the Unix socket "
+                        "SOCKET, which it is given by $SHIVYC_SERVER")
+
+    # Boolean flag for whether to print the statistics of the cache
+    parser.add_argument("-z-cache-stats",
+                        help="display the hits, misses, and size of the "
+                        "cache given by -fcache-dir, and exit",
+                        dest="show_cache_stats", action="store_true")
+
+    # Boolean flags for whether to vectorize loops, and with which vectors
+    parser.add_argument("-ftree-vectorize",
+                        help="run counted loops over arrays of integers on "
+                        "several elements at once with SSE2",
+                        dest="vectorize", action="store_true")
+
+    parser.add_argument("-mavx2",
+                        help="vectorize loops with the 256-bit vectors of "
+                        "AVX2, which the machine running the code must "
+                        "support",
+                        dest="avx2", action="store_true")
+
+    # Boolean flags for which instructions on bits the code may use
+    parser.add_argument("-mpopcnt",
+                        help="count set bits with popcnt, which the machine "
+                        "running the code must support",
+                        dest="popcnt", action="store_true")
+
+    parser.add_argument("-mbmi",
+                        help="count trailing zero bits with tzcnt, which the "
+                        "machine running the code must support",
+                        dest="bmi", action="store_true")
+
+    parser.add_argument("-mlzcnt",
+                        help="count leading zero bits with lzcnt, which the "
+                        "machine running the code must support",
+                        dest="lzcnt", action="store_true")
+
+    # Microarchitecture whose latencies the ASM code is scheduled for
+    parser.add_argument("-mtune", choices=sorted(schedule.latencies),
+                        dest="tune", metavar="CPU",
+                        help="schedule the ASM code of each block for the "
+                        "latencies of CPU: "
+                        + ", ".join(sorted(schedule.latencies)))
+
+    parser.add_argument("-falign-loops",
+                        help="align the header of each loop to 16 bytes, if "
+                        "at most 10 bytes of padding do",
+                        dest="align_loops", action="store_true")
+
+    # Flags for whether to unroll loops, and by how many copies of the body
+    parser.add_argument("-funroll-loops",
+                        help="unroll counted loops, fully if they run only a "
+                        "few times",
+                        dest="unroll_loops", action="store_true")
+
+    parser.add_argument("-funroll-factor", metavar="N", type=int, default=4,
+                        help="unroll loops by at most N copies of the body, "
+                        "with -funroll-loops",
+                        dest="unroll_factor")
+
+    # Boolean flag for whether accesses of different types may alias
+    parser.add_argument("-fno-strict-aliasing",
+                        help="do not assume that pointers to different types "
+                        "point to different objects",
+                        dest="strict_aliasing", action="store_false")
+
+    # Boolean flags for whether to write a profile or use one, and its file
+    parser.add_argument("-fprofile-generate",
+                        help="count how often each basic block runs, and "
+                        "add the counts to the profile file when the program "
+                        "exits",
+                        dest="profile_generate", action="store_true")
+
+    parser.add_argument("-fprofile-use",
+                        help="lay out blocks, allocate registers, and inline "
+                        "calls by the counts in the profile file",
+                        dest="profile_use", action="store_true")
+
+    parser.add_argument("-fprofile-file", metavar="FILE",
+                        default=default_file, dest="profile_file",
+                        help="name of the profile file of -fprofile-generate "
+                        f"and -fprofile-use (default: {default_file})")
+
+    # Boolean flag for whether to run the peephole optimizer
+    parser.add_argument("-fno-peephole",
+                        help="do not run the peephole optimizer on the ASM",
+                        dest="peephole", action="store_false")
+
+    # Boolean flag for whether to print how often each peephole pattern hit
+    parser.add_argument("-z-peephole-hits",
+                        help="display the number of times each peephole "
+                        "pattern was applied",
+                        dest="show_peephole_hits", action="store_true")
+
+    given = list(sys.argv[1:] if flags is None else flags)
+    run_args = []
+    if "--" in given:
+        run_args = given[given.index("--") + 1:]
+        given = given[:given.index("--")]
+
+    argv = []
+    for arg in given:
+        if arg.startswith("-Wl,"):
+            argv.append("-Wl=" + arg[len("-Wl,"):])
+        else:
+            argv.append(arg)
+    args = parser.parse_args(argv)
+    if not args.files and not (args.show_cache_stats or args.serve):
+        parser.error("the following arguments are required: files")
+    if ((args.compile_only or args.asm_only) and args.output
+          and len(args.files) > 1):
+        parser.error("cannot specify -o with -c or -S with multiple files")
+    if run_args and not args.run:
+        parser.error("the arguments after -- are only taken with --run")
+    if args.run and (args.compile_only or args.asm_only or args.shared):
+        parser.error("cannot specify --run with -c, -S, or -shared")
+
+    # Code to be run by the JIT is compiled for an executable, unless it
+    # is to be position-independent anyway.
+    args.run_args = run_args
+    if args.run and not args.pic:
+        args.pic = "pie"
+
+    # The instrumented program writes its profile by absolute path, so it
+    # may be run from anywhere.
+    args.profile_file = os.path.abspath(args.profile_file)
+    return args
 
 
 def read_file(file):
@@ -132,25 +1163,263 @@ def read_file(file):
         error_collector.add(CompilerError(descrip))
 
 
-def write_asm(asm_source, asm_filename):
-    """Save the given assembly source to disk at asm_filename.
+def fetch_cached(cache_dir, key, obj_file):
+    """Copy the object file cached under `key` to `obj_file`, if any.
 
-    asm_source (str) - Full assembly source code.
-    asm_filename (str) - Filename to which to save the generated assembly.
+    returns - whether the object file was found in the cache
+    """
+    try:
+        return cache.fetch(cache_dir, key, obj_file)
+    except OSError:
+        descrip = f"could not read cache directory '{cache_dir}'"
+        error_collector.add(CompilerError(descrip, warning=True))
+        return False
 
+
+def store_cached(cache_dir, key, obj_file):
+    """Save a copy of the object file in the cache under `key`."""
+    try:
+        cache.store(cache_dir, key, obj_file)
+    except OSError:
+        descrip = f"could not write cache directory '{cache_dir}'"
+        error_collector.add(CompilerError(descrip, warning=True))
+
+
+def fetch_cached_function(cache_dir, key):
+    """Return what was stored in the cache for a function under `key`, or
+    None.
     """
     try:
-        with open(asm_filename, "w") as s_file:
-            s_file.write(asm_source)
-    except IOError:
-        descrip = f"could not write output file '{asm_filename}'"
+        return cache.fetch_function(cache_dir, key)
+    except OSError:
+        descrip = f"could not read cache directory '{cache_dir}'"
+        error_collector.add(CompilerError(descrip, warning=True))
+        return None
+
+
+def store_cached_function(cache_dir, key, entry):
+    """Save what was made for a function in the cache under `key`."""
+    try:
+        cache.store_function(cache_dir, key, entry)
+    except OSError:
+        descrip = f"could not write cache directory '{cache_dir}'"
+        error_collector.add(CompilerError(descrip, warning=True))
+
+
+def show_cache_stats(cache_dir):
+    """Print the statistics of the cache in the given directory.
+
+    returns - whether a cache directory was given
+    """
+    if not cache_dir:
+        print(CompilerError("no cache directory given with -fcache-dir"))
+        return False
+
+    def rate(hits, misses):
+        total = hits + misses
+        return f"{100 * hits / total:.1f}%" if total else "n/a"
+
+    stats = cache.stats(cache_dir)
+    print(f"cache directory  {cache_dir}")
+    print(f"hits             {stats['hit']}")
+    print(f"misses           {stats['miss']}")
+    print(f"hit rate         {rate(stats['hit'], stats['miss'])}")
+    print(f"function hits    {stats['function hit']}")
+    print(f"function misses  {stats['function miss']}")
+    print(f"function rate    "
+          f"{rate(stats['function hit'], stats['function miss'])}")
+    print(f"objects          {stats['objects']}")
+    print(f"functions        {stats['functions']}")
+    print(f"size             {stats['size']} bytes")
+    return True
+
+
+class ASMFile:
+    """Assembly file to which the ASM code of each function is written.
+
+    name (str) - Filename to which to save the generated assembly, or a
+    text stream to write it to, which is left open.
+    function_sections (bool) - Whether to write each function to a text
+    section of its own, named after it.
+    source (str) - Name of the C file compiled, if the source lines of the
+    code are to be written for -g.
+
+    """
+
+    def __init__(self, name, function_sections=False, source=None):
+        """Open the file and write the start of the assembly code."""
+        self.name = name
+        self.function_sections = function_sections
+        self.file = None
+
+        # Number of each source file named by the source lines written.
+        self.files = {} if source else None
+        try:
+            self.file = open(name, "w") if isinstance(name, str) else name
+            if source:
+                self.file.write(f'\t.file "{source}"\n')
+            ASMCode.write_start(self.file)
+        except IOError:
+            self._fail()
+
+    def add(self, lines):
+        """Write the ASM code of a function to the file."""
+        if self.file:
+            try:
+                with timer.phase("emit"):
+                    if self.function_sections:
+                        name = asm_cmds.first_label(lines)
+                        self.file.write(f"\t.section .text.{name}"
+                                        ',"ax",@progbits\n')
+                    ASMCode.write_lines(self.file, lines, self.files)
+            except IOError:
+                self._fail()
+
+    def finish(self, asm_code):
+        """Write the static data of the ASM code, and close the file."""
+        if self.file:
+            try:
+                with timer.phase("emit"):
+                    asm_code.write_end(self.file)
+                if isinstance(self.name, str):
+                    self.file.close()
+            except IOError:
+                self._fail()
+
+    def discard(self):
+        """Close and remove the file, if it was written."""
+        if self.file and isinstance(self.name, str):
+            self.file.close()
+            os.remove(self.name)
+        self.file = None
+
+    def _fail(self):
+        """Report that the file could not be written."""
+        descrip = f"could not write output file '{self.name}'"
         error_collector.add(CompilerError(descrip))
 
 
-def assemble(asm_name, obj_name):
-    """Assemble the given assembly file into an object file."""
+class ObjectFile:
+    """Object file to which the ASM code of each function is assembled.
+
+    name (str) - Filename to which to save the object file, or a binary
+    stream to write it to.
+    function_sections (bool) - Whether to assemble each function into a text
+    section of its own, named after it.
+    source (str) - Name of the C file compiled, if the debugging information
+    of -g is to be written.
+
+    The object file is written once the static data is known, by finish.
+    """
+
+    def __init__(self, name, function_sections=False, source=None):
+        """Initialize ObjectFile."""
+        self.name = name
+        self.writer = elf.ObjectWriter(function_sections, source)
+
+    def add(self, lines):
+        """Assemble the ASM code of a function into the object file."""
+        with timer.phase("as"):
+            self.writer.add_text(lines)
+
+    def finish(self, asm_code):
+        """Write the object file, with the static data of the ASM code."""
+        try:
+            with timer.phase("as"):
+                if isinstance(self.name, str):
+                    with open(self.name, "wb") as o_file:
+                        self.writer.write(asm_code, o_file)
+                else:
+                    self.writer.write(asm_code, self.name)
+        except IOError:
+            descrip = f"could not write output file '{self.name}'"
+            error_collector.add(CompilerError(descrip))
+
+    def discard(self):
+        """Drop the object file, which is not written to disk until finish."""
+        self.writer = None
+
+
+class Assembler:
+    """Process of `as` which assembles ASM code as it is piped in, for
+    -pipe.
+
+    `as` is started before the first function is generated, and the ASM
+    code of each function is written to its standard input as soon as the
+    function is, so the assembler reads and parses it while later functions
+    are still being generated. No .s file is written. With -j, each file is
+    compiled in a process of its own, and so has an `as` of its own running
+    alongside its code generation.
+
+    obj_file - Name of the object file, or a binary stream to write it to.
+    Since `as` can only write to a file, an object file to be written to a
+    stream is read back from a temporary file.
+    """
+
+    def __init__(self, obj_file):
+        """Start `as`, reading ASM code from the pipe `stdin`."""
+        self.obj_file = obj_file
+        self.temp_dir = None
+        if isinstance(obj_file, str):
+            self.obj_name = obj_file
+        else:
+            self.temp_dir = tempfile.TemporaryDirectory(prefix="shivyc-")
+            self.obj_name = os.path.join(self.temp_dir.name, "out.o")
+
+        self.process = subprocess.Popen(
+            ["as", "-64", "-o", self.obj_name], stdin=subprocess.PIPE,
+            universal_newlines=True)
+        self.stdin = self.process.stdin
+
+    def finish(self):
+        """Close the pipe and wait for `as` to write the object file.
+
+        returns - whether it was written
+        """
+        with timer.phase("as"):
+            try:
+                self.stdin.close()
+            except BrokenPipeError:
+                pass
+            status = self.process.wait()
+            if not status and self.temp_dir:
+                with open(self.obj_name, "rb") as o_file:
+                    self.obj_file.write(o_file.read())
+        self._clean_up()
+
+        if status:
+            err = "assembler returned non-zero status"
+            error_collector.add(CompilerError(err))
+            return False
+        return True
+
+    def discard(self):
+        """Stop `as`, and remove any object file it began to write."""
+        self.process.kill()
+        try:
+            self.stdin.close()
+        except BrokenPipeError:
+            pass
+        self.process.wait()
+        if not self.temp_dir and os.path.exists(self.obj_name):
+            os.remove(self.obj_name)
+        self._clean_up()
+
+    def _clean_up(self):
+        """Remove the temporary directory of the object file, if any."""
+        if self.temp_dir:
+            self.temp_dir.cleanup()
+
+
+def assemble(asm_file, obj_file):
+    """Assemble the given ASMFile into an object file with `as`.
+
+    obj_file (str) - Name of the object file
+    """
     try:
-        subprocess.check_call(["as", "-64", "-o", obj_name, asm_name])
+        with timer.phase("as"):
+            subprocess.run(["as", "-64", asm_file.name, "-o", obj_file],
+                           check=True)
         return True
     except subprocess.CalledProcessError:
         err = "assembler returned non-zero status"
@@ -158,29 +1427,87 @@ def assemble(asm_name, obj_name):
         return False
 
 
-def link(binary_name, obj_names):
-    """Assemble the given object files into a binary."""
+def link(binary_name, obj_names, args):
+    """Link the given object files into a binary.
+
+    The linker drops the sections nothing in the program refers to, which
+    are each function and object with -ffunction-sections and
+    -fdata-sections. With -static, the C library is linked into the binary,
+    so it starts without the dynamic loader. With -shared, a shared object
+    is linked, which needs none of the startup files, and with -pie, the
+    executable is started by the startup file for one loaded at any
+    address.
+
+    The paths of the files linked with are searched for once, and with
+    -fcache-dir, saved in the cache for the links after.
+    """
+    if args.shared:
+        return _run_linker(binary_name, obj_names, ["-shared"], ["-lc"], args)
+
+    if args.cache_dir:
+        found_paths.update(cache.fetch_paths(args.cache_dir))
+    known = dict(found_paths)
 
     try:
-        crtnum = find_crtnum()
+        crtnum = find_library_or_err("Scrt1.o") if args.pie else (
+            find_crtnum())
         if not crtnum: return
 
         crti = find_library_or_err("crti.o")
         if not crti: return
 
-        linux_so = find_library_or_err("ld-linux-x86-64.so.2")
-        if not linux_so: return
-
         crtn = find_library_or_err("crtn.o")
         if not crtn: return
 
-        # find files to link
-        subprocess.check_call(
-            ["ld", "-dynamic-linker", linux_so, crtnum, crti, "-lc"]
-            + obj_names + [crtn, "-o", binary_name])
+        if args.static:
+            # The static C library needs the unwinder of libgcc, which is
+            # installed under the directory of the version of gcc.
+            libs = [find_library_or_err("libc.a"),
+                    find_gcc_library_or_err("libgcc.a"),
+                    find_gcc_library_or_err("libgcc_eh.a")]
+            if not all(libs): return
+            start = ["-static", crtnum, crti]
+            end = ["--start-group"] + libs + ["--end-group", crtn]
+        else:
+            linux_so = find_library_or_err("ld-linux-x86-64.so.2")
+            if not linux_so: return
+            start = ["-dynamic-linker", linux_so, crtnum, crti, "-lc"]
+            if args.pie:
+                start = ["-pie"] + start
+            end = [crtn]
+    finally:
+        if args.cache_dir and found_paths != known:
+            cache.store_paths(args.cache_dir, found_paths)
+
+    return _run_linker(binary_name, obj_names, start, end, args)
+
+
+def _run_linker(binary_name, obj_names, start, end, args):
+    """Run the linker on the given object files, with the arguments `start`
+    before them and `end` after.
+
+    returns - whether the binary was linked
+    """
+    linker = f"ld.{args.linker}" if args.linker else "ld"
+
+    # With -g, the unwinder finds the frame of each function through a table
+    # of them the linker makes.
+    if args.debug:
+        start = ["--eh-frame-hdr"] + start
+    try:
+        with timer.phase("ld"):
+            subprocess.check_call(
+                [linker, "--gc-sections"] + start
+                + [arg for opts in args.linker_args for arg in opts.split(",")]
+                + obj_names + end + ["-o", binary_name])
 
         return True
 
+    except FileNotFoundError:
+        err = f"could not run the linker '{linker}'"
+        error_collector.add(CompilerError(err))
+        return False
+
     except subprocess.CalledProcessError:
         return False
 
@@ -214,11 +1541,48 @@ def find_library_or_err(file):
         return path
 
 
+def find_gcc_library_or_err(file):
+    """Search the given library file of gcc and return path if found.
+
+    The file is searched for in the directory of each version of gcc
+    installed, newest first. If not found, add an error to the error
+    collector and return None.
+    """
+    path = found_paths.get(file)
+    if path and os.path.isfile(path):
+        return path
+
+    def version(path):
+        return [int(part) for part in path.name.split(".") if part.isdigit()]
+
+    for triple in ["x86_64-linux-gnu", "x86_64-pc-linux-gnu"]:
+        gcc_dir = pathlib.Path("/usr/lib/gcc", triple)
+        if gcc_dir.is_dir():
+            for path in sorted(gcc_dir.iterdir(), key=version, reverse=True):
+                if path.joinpath(file).is_file():
+                    found_paths[file] = str(path.joinpath(file))
+                    return found_paths[file]
+
+    err = f"could not find {file} of gcc, for linking with -static"
+    error_collector.add(CompilerError(err))
+    return None
+
+
+# Map from the name of each file found by find_library or
+# find_gcc_library_or_err to its path. The paths are checked to still exist
+# before they are reused.
+found_paths = {}
+
+
 def find_library(file):
     """Search the given library file by searching in common directories.
 
     If found, returns the path. Otherwise, returns None.
     """
+    path = found_paths.get(file)
+    if path and os.path.isfile(path):
+        return path
+
     search_paths = [pathlib.Path("/usr/local/lib/x86_64-linux-gnu"),
                     pathlib.Path("/lib/x86_64-linux-gnu"),
                     pathlib.Path("/usr/lib/x86_64-linux-gnu"),
@@ -234,7 +1598,8 @@ def find_library(file):
     for path in search_paths:
         full = path.joinpath(file)
         if full.is_file():
-            return str(full)
+            found_paths[file] = str(full)
+            return found_paths[file]
     return None
 
 
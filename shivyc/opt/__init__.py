@@ -0,0 +1,199 @@
+"""Optimization passes over the IL code of each function.
+
+Each pass is registered in `passes` by name, and runs over one function at
+a time. The passes run at each optimization level given by -O are listed
+in `pipelines`, in the order they run, and a PassManager runs them. The
+calls in a function are inlined beforehand, by an Inliner, at -O2.
+
+At -O2, the tail calls of the function are eliminated, the calls left are
+given the summaries of the functions compiled before, local structs which
+do not escape are replaced with their members, and the function is put in
+SSA form, optimized, summarized, and taken back out of SSA form before code
+generation. Rotates written as the or of two shifts are made rotate
+commands. Memory which loops write is promoted to values kept in
+registers, where alias analysis shows nothing else in the loop accesses it.
+Integer operations whose upper bits are never observed, as on chars
+promoted to int, are computed at a narrower width without the extensions.
+Before it is taken out of SSA form, the local variables whose address is
+taken are kept in registers except around the commands which may access
+them through a pointer. Small branches which only choose between values are
+made into conditional moves before dead code is eliminated. Finally,
+instructions are selected for trees of address arithmetic, comparisons are
+fused with the jumps and conditional moves on their results, and the blocks
+are laid out so that fewer jumps are taken. At -O1, only the cheapest of
+these run, and at -O0 none do. The pic pass, which rewrites the accesses
+made through the global offset table by position-independent code and of
+thread-local objects, runs last at every level.
+"""
+
+import time
+
+from shivyc.opt.branches import fuse_compare_jumps
+from shivyc.opt.dce import eliminate_dead_code
+from shivyc.opt.gvn import number_values
+from shivyc.opt.ifconv import convert_branches
+from shivyc.opt.ipa import annotate_calls, summarize
+from shivyc.opt.layout import lay_out_blocks
+from shivyc.opt.licm import hoist_invariants
+from shivyc.opt.narrow import narrow_values
+from shivyc.opt.pic import make_position_independent
+from shivyc.opt.sccp import propagate_constants
+from shivyc.opt.select import select_instructions
+from shivyc.opt.promote import promote_scalars
+from shivyc.opt.rotate import recognize_rotates
+from shivyc.opt.split import split_live_ranges
+from shivyc.opt.sroa import replace_aggregates
+from shivyc.opt.ssa import from_ssa, to_ssa
+from shivyc.opt.strength import reduce_strength
+from shivyc.opt.tail import eliminate_tail_calls
+from shivyc.opt.unroll import unroll_loops
+from shivyc.opt.vectorize import vectorize_loops
+from shivyc.timing import timer
+
+
+class PassContext:
+    """The function a pipeline runs over, and the options of its passes.
+
+    il_code (ILCode) - IL code of the function
+    symbol_table (SymbolTable) - Symbol table of the IL code
+    func (str) - Name of the function
+    vector_size (int) - Size in bytes of the vectors to vectorize loops
+    with, or 0 not to vectorize them.
+    unroll_factor (int) - Most copies of a loop body to unroll loops by, or
+    0 not to unroll them.
+    strict_aliasing (bool) - Whether value numbering, code motion, and dead
+    store elimination may assume accesses of different types do not alias.
+    pic (str) - "pic" or "pie" if the code is position independent, as
+    by -fPIC or -fpie, or None.
+    unrolled (bool) - Whether any loop of the function was unrolled.
+    """
+
+    def __init__(self, il_code, symbol_table, func, vector_size,
+                 unroll_factor, strict_aliasing, pic=None):
+        """Initialize PassContext."""
+        self.il_code = il_code
+        self.symbol_table = symbol_table
+        self.func = func
+        self.vector_size = vector_size
+        self.unroll_factor = unroll_factor
+        self.strict_aliasing = strict_aliasing
+        self.pic = pic
+        self.unrolled = False
+
+
+def _unroll(c):
+    """Unroll loops, and note whether any was unrolled."""
+    if c.unroll_factor:
+        c.unrolled = unroll_loops(c.il_code, c.symbol_table, c.func,
+                                  c.unroll_factor)
+
+
+def _propagate_unrolled(c):
+    """Propagate constants again through the copies of unrolled loops, and
+    the values strength reduction starts their induction variables from.
+    """
+    if c.unrolled:
+        propagate_constants(c.il_code, c.symbol_table, c.func)
+
+
+# Map from the name of each pass to the function running it on a
+# PassContext.
+passes = {
+    "tail": lambda c: eliminate_tail_calls(c.il_code, c.symbol_table,
+                                           c.func),
+    "ipa-annotate": lambda c: annotate_calls(c.il_code, c.symbol_table,
+                                             c.func),
+    "sroa": lambda c: replace_aggregates(c.il_code, c.symbol_table, c.func),
+    "ssa": lambda c: to_ssa(c.il_code, c.symbol_table, c.func),
+    "sccp": lambda c: propagate_constants(c.il_code, c.symbol_table, c.func),
+    "rotate": lambda c: recognize_rotates(c.il_code, c.symbol_table,
+                                          c.func),
+    "gvn": lambda c: number_values(c.il_code, c.symbol_table, c.func,
+                                   c.strict_aliasing),
+    "licm": lambda c: hoist_invariants(c.il_code, c.symbol_table, c.func,
+                                       c.strict_aliasing),
+    "promote": lambda c: promote_scalars(c.il_code, c.symbol_table, c.func,
+                                         c.strict_aliasing),
+    "vectorize": lambda c: c.vector_size and vectorize_loops(
+        c.il_code, c.symbol_table, c.func, c.vector_size),
+    "unroll": _unroll,
+    "strength": lambda c: reduce_strength(c.il_code, c.symbol_table, c.func),
+    "sccp-unrolled": _propagate_unrolled,
+    "narrow": lambda c: narrow_values(c.il_code, c.symbol_table, c.func),
+    "ifconv": lambda c: convert_branches(c.il_code, c.symbol_table, c.func),
+    "dce": lambda c: eliminate_dead_code(c.il_code, c.symbol_table, c.func,
+                                         c.strict_aliasing),
+    "ipa-summarize": lambda c: summarize(c.il_code, c.symbol_table, c.func,
+                                         c.strict_aliasing),
+    "split": lambda c: split_live_ranges(c.il_code, c.symbol_table, c.func,
+                                         c.strict_aliasing),
+    "out-of-ssa": lambda c: from_ssa(c.il_code, c.symbol_table, c.func),
+    "select": lambda c: select_instructions(c.il_code, c.func),
+    "fuse-jumps": lambda c: fuse_compare_jumps(c.il_code, c.func),
+    "layout": lambda c: lay_out_blocks(c.il_code, c.func),
+    "pic": lambda c: make_position_independent(c.il_code, c.symbol_table,
+                                               c.func, c.pic),
+}
+
+# Names of the passes run at each optimization level, in order.
+pipelines = {
+    0: [],
+    1: ["tail", "ssa", "sccp", "rotate", "narrow", "ifconv", "dce",
+        "out-of-ssa", "fuse-jumps", "layout"],
+    2: ["tail", "ipa-annotate", "sroa", "ssa", "sccp", "gvn", "rotate",
+        "licm", "promote", "vectorize", "unroll", "strength",
+        "sccp-unrolled", "narrow", "ifconv", "dce", "ipa-summarize", "split",
+        "out-of-ssa", "select", "fuse-jumps", "layout"],
+}
+
+
+class PassManager:
+    """Runner of the pipeline of an optimization level over each function.
+
+    While the timer is enabled, the time of each pass and the change in
+    the number of IL commands it makes are added to the timer.
+
+    il_code (ILCode) - IL code of the functions optimized
+    symbol_table (SymbolTable) - Symbol table of the IL code
+    level (int) - Optimization level, a key of `pipelines`
+    vector_size, unroll_factor, strict_aliasing, pic - as in PassContext
+    dump_after (str) - Name of the pass after which to print the IL code of
+    each function, "make_il" to print it before any pass, "all" to print
+    it then and after every pass, or None.
+    """
+
+    def __init__(self, il_code, symbol_table, level=2, vector_size=0,
+                 unroll_factor=0, strict_aliasing=True, pic=None,
+                 dump_after=None):
+        """Initialize PassManager."""
+        self.il_code = il_code
+        self.symbol_table = symbol_table
+        self.pipeline = pipelines[level] + ["pic"]
+        self.vector_size = vector_size
+        self.unroll_factor = unroll_factor
+        self.strict_aliasing = strict_aliasing
+        self.pic = pic
+        self.dump_after = dump_after
+
+    def run(self, func):
+        """Run the pipeline over function `func`."""
+        c = PassContext(self.il_code, self.symbol_table, func,
+                        self.vector_size, self.unroll_factor,
+                        self.strict_aliasing, self.pic)
+        self._dump(func, "make_il")
+        for name in self.pipeline:
+            if timer.enabled:
+                size = len(self.il_code.commands[func])
+                start = time.perf_counter()
+                passes[name](c)
+                timer.count_pass(name, time.perf_counter() - start,
+                                 len(self.il_code.commands[func]) - size)
+            else:
+                passes[name](c)
+            self._dump(func, name)
+
+    def _dump(self, func, name):
+        """Print the IL code of `func` if it is dumped after pass `name`."""
+        if self.dump_after in (name, "all"):  # pragma: no cover
+            print(f";; IL of {func} after {name}")
+            print(self.il_code.dump(func, self.symbol_table.names))
@@ -0,0 +1,295 @@
+"""Alias analysis over IL code in SSA form.
+
+Each command may read and write some parts of memory, as Access objects.
+An access is of a variable when the variable is read or written by name,
+or through a pointer known to point into it, as found by pointee.
+Otherwise it is of memory not known, through a pointer of a given type.
+
+Two accesses of the same variable may alias, and two accesses of different
+variables do not. An access of a variable may alias an access of memory not
+known only if the variable is exposed: it has static storage, or it is a
+local whose address escapes. The address of a local escapes when a pointer
+into it is used in any way but as the address of a load or store or to
+compute another pointer into it, like when it is passed to a function or is
+stored. A function call may read and write any exposed variable, but no
+other, unless its summary from ipa.py tells it writes or reads none.
+
+Two accesses through pointers based on different restrict-qualified
+parameters do not alias. A pointer is based on a parameter if it is
+computed from the value the function was passed by copies, pointer
+arithmetic, and Phis of such pointers. C promises more, that memory written
+through one such pointer is accessed through no pointer not based on it,
+but only this is used, since a call may be passed a pointer based on it.
+
+With strict aliasing, as C requires, an access through a pointer to one type
+does not alias an access of another type, unless either type is a character
+type or is not a scalar. Integer types of the same size are the same type
+here, and so are all pointer types.
+"""
+
+from shivyc.il_cmds.math import Add, Subtr
+from shivyc.il_cmds.value import (AddrOf, AddrRel, LoadArg, Phi, ReadAt,
+                                  ReadRel, Set, SetAt, SetRel)
+from shivyc.opt.ssa import ssa_values
+
+
+class Access:
+    """A part of memory which a command may read or write.
+
+    var (ILValue) - The variable accessed, or None if the memory accessed
+    is not known.
+    ctype (CType) - Type of the value accessed, or None if it may be any.
+    restrict (ILValue) - The restrict-qualified parameter the pointer the
+    access is through is based on, or None.
+    """
+
+    __slots__ = ["var", "ctype", "restrict"]
+
+    def __init__(self, var, ctype, restrict=None):
+        """Initialize Access."""
+        self.var = var
+        self.ctype = ctype
+        self.restrict = restrict
+
+
+class Memory:
+    """The memory accesses of the commands of a function.
+
+    values (Set) - The SSA values of the function.
+    defs (Dict) - Map from each SSA value to the index of its definition.
+    strict (bool) - Whether accesses of different types do not alias.
+    """
+
+    def __init__(self, il_code, symbol_table, commands, strict=True):
+        """Initialize Memory."""
+        self.il_code = il_code
+        self.symbol_table = symbol_table
+        self.commands = commands
+        self.strict = strict
+        self.values = ssa_values(il_code, symbol_table, commands)
+        self.defs = {}
+        for i, command in enumerate(commands):
+            for v in command.outputs():
+                if v in self.values:
+                    self.defs[v] = i
+        self.escaped = self._escaped()
+
+    def reads(self, command):
+        """Return the list of accesses the given command may read."""
+        accesses = self.indirect_reads(command)
+
+        # The address of a variable does not depend on its value, and a
+        # SetRel only writes its base.
+        address_of = None
+        if isinstance(command, AddrOf):
+            address_of = command.var
+        elif isinstance(command, (AddrRel, SetRel)):
+            address_of = command.base
+
+        for v in command.inputs():
+            if v is not address_of and self._in_memory(v):
+                ctype = command.output.ctype if isinstance(
+                    command, ReadRel) else v.ctype
+                accesses.append(Access(v, ctype))
+        return accesses
+
+    def writes(self, command):
+        """Return the list of accesses the given command may write."""
+        accesses = self.indirect_writes(command)
+        if isinstance(command, SetRel):
+            accesses.append(Access(command.base, command.val and
+                                   command.val.ctype))
+        for v in command.outputs():
+            if self._in_memory(v):
+                accesses.append(Access(v, v.ctype))
+        return accesses
+
+    def indirect_reads(self, command):
+        """Return the list of accesses the given command may read other than
+        by the name of a variable, through a pointer or by a call.
+        """
+        accesses = []
+        if command.reads_memory():
+            accesses.append(Access(None, None))
+        for addr in command.indir_read():
+            accesses.append(self._through(addr, command))
+        return accesses
+
+    def indirect_writes(self, command):
+        """Return the list of accesses the given command may write other
+        than by the name of a variable, through a pointer or by a call.
+        """
+        accesses = []
+        if command.clobbers_memory():
+            accesses.append(Access(None, None))
+        for addr in command.indir_write():
+            accesses.append(self._through(addr, command))
+        return accesses
+
+    def may_alias(self, a, b):
+        """Return whether the two given accesses may be of the same memory.
+        """
+        if a.var is not None and b.var is not None:
+            return a.var is b.var
+        if (a.restrict is not None and b.restrict is not None
+              and a.restrict is not b.restrict):
+            return False
+        if not (self._exposed(a.var) and self._exposed(b.var)):
+            return False
+        return not self.strict or compatible(a.ctype, b.ctype)
+
+    def conflict(self, accesses, others):
+        """Return whether any of two lists of accesses may alias."""
+        return any(self.may_alias(a, b) for a in accesses for b in others)
+
+    def outside(self, access):
+        """Return whether the given access may be of memory outside the
+        frame of the function.
+        """
+        return access.var is None or not self._automatic(access.var)
+
+    def pointee(self, addr):
+        """Return the variable the SSA value `addr` points into, if known."""
+        return pointee(addr, self.commands, self.defs)
+
+    def through(self, addr, ctype):
+        """Return the access of a value of type `ctype` through the pointer
+        `addr`, or of any type if `ctype` is None.
+        """
+        return Access(self.pointee(addr), ctype,
+                      restrict_base(addr, self.commands, self.defs))
+
+    def _through(self, addr, command):
+        """Return the access of a command through the pointer `addr`."""
+        ctype = None
+        if isinstance(command, ReadAt):
+            ctype = command.output.ctype
+        elif isinstance(command, SetAt):
+            ctype = command.val.ctype
+        return self.through(addr, ctype)
+
+    def _in_memory(self, v):
+        """Return whether `v` is a variable kept in memory."""
+        return (v not in self.values and v not in self.il_code.literals
+                and v not in self.il_code.string_literals)
+
+    def _automatic(self, v):
+        """Return whether `v` has automatic storage."""
+        return (self.symbol_table.storage.get(v, self.symbol_table.AUTOMATIC)
+                == self.symbol_table.AUTOMATIC)
+
+    def _exposed(self, var):
+        """Return whether memory not known may be the given variable.
+
+        A variable of None, for memory not known, is exposed.
+        """
+        return (var is None or not self._automatic(var)
+                or var in self.escaped)
+
+    def _escaped(self):
+        """Return the set of local variables whose address escapes."""
+        escaped = set()
+        pointers = {}
+        for command in self.commands:
+            for pointer, refs in command.references().items():
+                if pointer is None:
+                    continue
+                for var in refs:
+                    if pointer not in self.values:
+                        escaped.add(var)
+        for v in self.defs:
+            var = self.pointee(v)
+            if var is not None and v.ctype.is_pointer():
+                pointers[v] = var
+
+        for command in self.commands:
+            address_uses = command.indir_read() + command.indir_write()
+            inputs = command.inputs()
+            outputs = command.outputs()
+            derived = (isinstance(command, (Set, Add, Subtr)) and outputs
+                       and outputs[0] in pointers)
+            for v in set(inputs):
+                if v not in pointers or derived:
+                    continue
+                if (command.clobbers_memory() or command.reads_memory()
+                      or inputs.count(v) > address_uses.count(v)):
+                    escaped.add(pointers[v])
+        return escaped
+
+
+def pointee(addr, commands, defs):
+    """Return the variable which SSA value `addr` points into, if known."""
+    i = defs.get(addr)
+    if i is None:
+        return None
+
+    command = commands[i]
+    if isinstance(command, AddrOf):
+        return command.var
+    elif isinstance(command, AddrRel):
+        return command.base
+    elif isinstance(command, Set) and command.arg.ctype.is_pointer():
+        return pointee(command.arg, commands, defs)
+    elif (isinstance(command, (Add, Subtr))
+          and command.output.ctype.is_pointer()):
+        # Pointer arithmetic stays within the object pointed to.
+        if command.arg1.ctype.is_pointer():
+            return pointee(command.arg1, commands, defs)
+        elif command.arg2.ctype.is_pointer():
+            return pointee(command.arg2, commands, defs)
+    return None
+
+
+def restrict_base(addr, commands, defs):
+    """Return the restrict-qualified parameter which SSA value `addr` is
+    based on, if known.
+    """
+    # Marks a pointer which is based on whatever the Phi being traced
+    # through is, like the pointer incremented on each trip of a loop.
+    cycle = object()
+
+    def base(v, phis):
+        i = defs.get(v)
+        if i is None:
+            return None
+
+        command = commands[i]
+        if isinstance(command, LoadArg):
+            return v if v.ctype.is_restrict() else None
+        elif isinstance(command, Set) and command.arg.ctype.is_pointer():
+            return base(command.arg, phis)
+        elif (isinstance(command, (Add, Subtr))
+              and command.output.ctype.is_pointer()):
+            if command.arg1.ctype.is_pointer():
+                return base(command.arg1, phis)
+            elif command.arg2.ctype.is_pointer():
+                return base(command.arg2, phis)
+        elif isinstance(command, Phi):
+            if v in phis:
+                return cycle
+            bases = {base(arg, phis | {v}) for arg in command.args.values()}
+            bases.discard(cycle)
+            if len(bases) == 1:
+                return bases.pop()
+            return cycle if not bases else None
+        return None
+
+    found = base(addr, frozenset())
+    return None if found is cycle else found
+
+
+def compatible(a, b):
+    """Return whether values of types `a` and `b` may be in the same memory
+    under strict aliasing.
+
+    A type of None may be any type.
+    """
+    if a is None or b is None:
+        return True
+    for ctype in [a, b]:
+        if not ctype.is_scalar() or (ctype.is_integral()
+                                     and ctype.size == 1):
+            return True
+    if a.is_pointer() or b.is_pointer():
+        return a.is_pointer() and b.is_pointer()
+    return a.size == b.size and a.is_integral() == b.is_integral()
@@ -0,0 +1,137 @@
+"""Fusion of comparisons with the conditional jumps that test them.
+
+An `if(a < b)` or a loop condition is made into a comparison storing 0 or 1
+in a temporary, followed by a conditional jump on that temporary. When the
+temporary is not used anywhere else, the pair is replaced with a CmpJump,
+which jumps on the flags set by the comparison directly. In the same way,
+a comparison whose result is only the condition of a Select, as made by
+if-conversion, becomes the condition of the Select itself, so the
+conditional move uses its flags.
+
+Before that, a bitwise and whose result is only compared with zero, like
+`(x & mask) == 0`, or only branched or selected on, is made into a
+comparison which is one `test` of its arguments, rather than an `and`
+into a register and a comparison of that register.
+"""
+
+from collections import Counter
+
+import shivyc.ctypes as ctypes
+from shivyc.il_cmds.compare import (CmpJump, EqualCmp, NotEqualCmp, Select,
+                                    _GeneralCmp)
+from shivyc.il_cmds.control import JumpNotZero, JumpZero
+from shivyc.il_cmds.math import BitAnd
+from shivyc.il_gen import ILValue
+
+
+def fuse_compare_jumps(il_code, func):
+    """Fuse comparisons with the jumps on their result in function `func`.
+
+    Unlike the other passes, this runs after the code is out of SSA form.
+    """
+    commands = _fuse_masks(il_code.commands[func])
+    uses = Counter()
+    defs = Counter()
+    for command in commands:
+        uses.update(command.inputs())
+        defs.update(command.outputs())
+
+    new_commands = []
+    fused = set()
+    for i, command in enumerate(commands):
+        if i in fused:
+            continue
+        if not isinstance(command, _GeneralCmp):
+            new_commands.append(command)
+            continue
+
+        # Leaving SSA form may put copies between the comparison and the
+        # jump, and if-conversion puts the commands of both sides of the
+        # branch between it and the Select. The comparison can be moved
+        # after them, unless they change one of its arguments.
+        j = _user(commands, i)
+        user = commands[j] if j < len(commands) else None
+        if (uses[command.output] != 1 or defs[command.output] != 1
+              or not command.fusable()):
+            new_commands.append(command)
+            continue
+
+        if (isinstance(user, (JumpZero, JumpNotZero))
+              and user.cond is command.output):
+            negate = isinstance(user, JumpZero)
+            new_commands.extend(commands[i + 1:j])
+            new_commands.append(CmpJump(command, user.label, negate))
+            fused.update(range(i + 1, j + 1))
+        elif isinstance(user, Select) and user.cond is command.output:
+            user.cond = command
+            new_commands.extend(commands[i + 1:j])
+            fused.update(range(i + 1, j))
+        else:
+            new_commands.append(command)
+
+    if new_commands != il_code.commands[func]:
+        il_code.set_commands(func, new_commands)
+
+
+def _fuse_masks(commands):
+    """Return the commands with each bitwise and whose result is only
+    tested made into a comparison by `test`.
+    """
+    uses = Counter()
+    defs = Counter()
+    for command in commands:
+        uses.update(command.inputs())
+        defs.update(command.outputs())
+
+    new_commands = []
+    for i, command in enumerate(commands):
+        if (not isinstance(command, BitAnd) or uses[command.output] != 1
+              or defs[command.output] != 1):
+            new_commands.append(command)
+            continue
+
+        user = commands[_user(commands, i)]
+        args = [command.arg1, command.arg2]
+        if (isinstance(user, (EqualCmp, NotEqualCmp))
+              and _is_zero_test(user, command.output)):
+            user.arg1, user.arg2 = args
+            user.test = True
+        elif (isinstance(user, (JumpZero, JumpNotZero, Select))
+              and user.cond is command.output):
+            user.cond = ILValue(ctypes.integer)
+            test = NotEqualCmp(user.cond, *args)
+            test.test = True
+            new_commands.append(test)
+        else:
+            new_commands.append(command)
+    return new_commands
+
+
+def _is_zero_test(command, v):
+    """Return whether comparison `command` compares `v` with zero."""
+    for arg, other in [(command.arg1, command.arg2),
+                       (command.arg2, command.arg1)]:
+        if arg is v and getattr(other.literal, "val", None) == 0:
+            return True
+    return False
+
+
+def _user(commands, i):
+    """Return the index of the first command after commands[i] which uses
+    its output, if commands[i] can be moved just before it.
+
+    The commands in between must not change the inputs of commands[i].
+    """
+    command = commands[i]
+    j = i + 1
+    while (j < len(commands) and _movable(commands[j])
+           and not set(commands[j].outputs()) & set(command.inputs())
+           and command.output not in commands[j].inputs()):
+        j += 1
+    return j
+
+
+def _movable(command):
+    """Return whether a comparison may be moved past `command`."""
+    return (not command.has_side_effects() and not command.label_name()
+            and not command.targets() and command.falls_through())
@@ -0,0 +1,166 @@
+"""Recognition of counted loops over IL code in SSA form.
+
+A counted loop is an innermost loop like
+
+    for(i = start; i < n; i++) ...
+
+which runs while a basic induction variable, increased by one at the end
+of each trip, is less than a loop invariant limit. The passes which rewrite
+a counted loop put new code just before its header, so the loop must be
+entered only by falling through from the block before the header. It must
+also be laid out as the header, which only tests whether to leave the loop,
+followed by the blocks of the body, ending with the latch, which jumps back
+to the header. The loop is left only from the header.
+"""
+
+from shivyc.il_cmds.compare import LessCmp
+from shivyc.il_cmds.control import Jump, JumpZero
+from shivyc.il_cmds.math import Add
+from shivyc.il_cmds.value import Phi
+from shivyc.il_gen import IntegerLiteral
+from shivyc.opt.ssa import ssa_values
+
+
+class CountedLoop:
+    """A counted loop of a function.
+
+    loop (Loop) - The loop in the CFG.
+    phis (List[Phi]) - Phi commands of the header, that of the induction
+    variable first.
+    index (ILValue) - The induction variable.
+    limit (ILValue) - The loop invariant value the index is compared with.
+    entry_label, header_label, latch_label, exit_label - Labels of the
+    block the loop is entered from, of the header and latch, and of the
+    block the loop is left to.
+    body (range) - Indices of the commands after the header, to the end of
+    the latch.
+    increment (int) - Index of the command setting the next index.
+    values (Set) - The SSA values of the function.
+    defs (Dict) - Map from each SSA value to the index of its definition.
+    """
+
+    def __init__(self, flow, loop):
+        """Initialize CountedLoop."""
+        self.flow = flow
+        self.loop = loop
+        self.phis = []
+        self.index = None
+        self.limit = None
+        self.entry_label = None
+        self.header_label = None
+        self.latch_label = None
+        self.exit_label = None
+        self.body = None
+        self.increment = None
+        self.values = None
+        self.defs = None
+
+    def invariant(self, v):
+        """Return whether `v` is a literal or computed before the loop."""
+        if isinstance(v.literal, IntegerLiteral):
+            return True
+        return (v in self.defs and not self.loop.contains(
+            self.flow.block_of(self.defs[v])))
+
+    def init(self, phi):
+        """Return the value the output of a header Phi starts from."""
+        return phi.args[self.entry_label]
+
+    def next(self, phi):
+        """Return the value the output of a header Phi takes next trip."""
+        return phi.args[self.latch_label]
+
+
+def counted_loop(il_code, symbol_table, flow, loop):
+    """Return the CountedLoop of the given loop, or None if it is not one.
+    """
+    commands = flow.commands
+    header = loop.header
+    entries = [pred for pred in header.preds if not loop.contains(pred)]
+    if (len(entries) != 1 or entries[0].index != header.index - 1
+          or len(loop.latches) != 1):
+        return None
+    entry, latch = entries[0], loop.latches[0]
+
+    counted = CountedLoop(flow, loop)
+    counted.entry_label = commands[entry.start].label_name()
+    counted.header_label = commands[header.start].label_name()
+    counted.latch_label = commands[latch.start].label_name()
+    if (not counted.entry_label or not counted.latch_label
+          or counted.header_label in commands[entry.end - 1].targets()
+          or loop.body != set(range(header.index, latch.index + 1))
+          or any(other.header.index in loop.body and other is not loop
+                 for other in flow.loops)):
+        return None
+
+    # The loop is left only from the header, and the latch jumps back.
+    for block in flow.blocks[header.index + 1:latch.index + 1]:
+        if any(not loop.contains(succ) for succ in block.succs):
+            return None
+    jump = commands[latch.end - 1]
+    if not isinstance(jump, Jump) or jump.label != counted.header_label:
+        return None
+
+    counted.values = ssa_values(il_code, symbol_table, commands)
+    counted.defs = {}
+    for i, command in enumerate(commands):
+        for v in command.outputs():
+            if v in counted.values:
+                counted.defs[v] = i
+    counted.body = range(header.end, latch.end)
+
+    if not _header_test(commands, header, counted):
+        return None
+
+    increment = counted.defs.get(counted.next(counted.phis[0]))
+    if (increment is None or increment not in counted.body
+          or not _increments(commands[increment], counted.index)):
+        return None
+    counted.increment = increment
+    return counted
+
+
+def _header_test(commands, header, counted):
+    """Find the Phis and test of a header which tests `i < n` to leave.
+
+    The header must be just a label, Phi commands with args from the entry
+    and latch blocks, a LessCmp of the output of one of them with a loop
+    invariant, and a JumpZero on the result of that.
+
+    returns - whether the header is of that form
+    """
+    labels = {counted.entry_label, counted.latch_label}
+    phis = commands[header.start + 1:header.end - 2]
+    cmp, jump = commands[header.end - 2:header.end]
+    if (not phis or any(not isinstance(phi, Phi) or set(phi.args) != labels
+                        for phi in phis)
+          or not isinstance(cmp, LessCmp) or not counted.invariant(cmp.arg2)
+          or not isinstance(jump, JumpZero) or jump.cond is not cmp.output):
+        return False
+
+    index_phis = [phi for phi in phis if phi.output is cmp.arg1]
+    if not index_phis:
+        return False
+    counted.phis = index_phis + [phi for phi in phis
+                                 if phi is not index_phis[0]]
+    counted.index = cmp.arg1
+    counted.limit = cmp.arg2
+    counted.exit_label = jump.label
+
+    ctype = counted.index.ctype
+    return (ctype.is_integral() and not ctype.is_bool()
+            and ctype.size in {4, 8}
+            and cmp.arg2.ctype.weak_compat(ctype)
+            and counted.invariant(counted.init(index_phis[0])))
+
+
+def _increments(command, index):
+    """Return whether given command adds one to `index`."""
+    if not isinstance(command, Add):
+        return False
+    for arg, other in [(command.arg1, command.arg2),
+                       (command.arg2, command.arg1)]:
+        if (arg is index and isinstance(other.literal, IntegerLiteral)
+              and other.literal.val == 1):
+            return True
+    return False
@@ -0,0 +1,155 @@
+"""Dead code and dead store elimination over IL code in SSA form.
+
+A command is dead if it has no side effects and none of its outputs are
+used by a live command. A store is dead if it writes to a local variable
+whose value is never read, either directly or through a pointer, or if a
+later store in its block writes the same memory before any command which
+may read that memory, as told by alias analysis. Live commands are found
+by marking backward from the commands which must run, so a cycle of dead
+commands, like a loop counter which is never read, is removed too.
+"""
+
+from shivyc.il_cmds.value import SetAt, SetRel
+from shivyc.opt.alias import Memory, pointee
+
+
+def eliminate_dead_code(il_code, symbol_table, func, strict_aliasing=True):
+    """Remove dead commands and dead stores from function `func`.
+
+    strict_aliasing (bool) - Whether accesses of different types do not
+    alias.
+    """
+    flow = il_code.cfg(func)
+    commands = flow.commands
+    memory = Memory(il_code, symbol_table, commands, strict_aliasing)
+    values, defs = memory.values, memory.defs
+
+    dead_locals = _dead_locals(il_code, symbol_table, commands, values, defs)
+    overwritten = _overwritten_stores(flow, memory)
+
+    def is_dead_store(i, command):
+        if i in overwritten:
+            return True
+        if isinstance(command, SetRel):
+            return command.base in dead_locals
+        elif isinstance(command, SetAt):
+            return pointee(command.addr, commands, defs) in dead_locals
+        return False
+
+    live = [False] * len(commands)
+    worklist = []
+    for i, command in enumerate(commands):
+        if command.has_side_effects():
+            root = not is_dead_store(i, command)
+        else:
+            root = any(v not in values and v not in dead_locals
+                       for v in command.outputs())
+
+        if root:
+            live[i] = True
+            worklist.append(i)
+
+    while worklist:
+        for v in commands[worklist.pop()].inputs():
+            i = defs.get(v)
+            if i is not None and not live[i]:
+                live[i] = True
+                worklist.append(i)
+
+    il_code.set_commands(
+        func, [command for i, command in enumerate(commands) if live[i]])
+
+
+def _overwritten_stores(flow, memory):
+    """Return the indices of the stores written over before they are read.
+
+    A store is written over by a later store in its block to the same
+    address, of a value of the same size, if no command between them may
+    read the memory it writes.
+    """
+    commands = flow.commands
+    overwritten = set()
+    for block in flow.blocks:
+        # Map from the location of each store not yet read to its index.
+        pending = {}
+        for i in range(block.start, block.end):
+            command = commands[i]
+            reads = memory.reads(command)
+            if reads:
+                pending = {location: j for location, j in pending.items()
+                           if not memory.conflict(
+                               reads, memory.writes(commands[j]))}
+
+            location = _store_location(command)
+            if location in pending:
+                overwritten.add(pending[location])
+            if location:
+                pending[location] = i
+    return overwritten
+
+
+def _store_location(command):
+    """Return a key for the memory a store writes, or None if not a store.
+
+    Stores with the same key write exactly the same bytes.
+    """
+    if type(command) is SetAt:
+        return ("at", command.addr, command.offset, command.index,
+                command.factor, command.val.ctype.size)
+    elif type(command) is SetRel:
+        return ("rel", command.base, command.chunk, command.count,
+                command.val.ctype.size)
+    return None
+
+
+def _dead_locals(il_code, symbol_table, commands, values, defs):
+    """Return the set of local variables which are never read.
+
+    Such a variable may only be written, by a command without side effects
+    or by a SetRel, or have its address taken into an SSA value whose only
+    uses are as the address of a SetAt or in computing another such
+    address. Any other use, like passing the
+    address to a function, might read the variable.
+    """
+    storage = symbol_table.storage
+
+    candidates = set()
+    for command in commands:
+        for v in command.inputs() + command.outputs():
+            if (v not in values
+                  and storage.get(v, symbol_table.AUTOMATIC)
+                    == symbol_table.AUTOMATIC
+                  and v not in il_code.literals
+                  and v not in il_code.string_literals):
+                candidates.add(v)
+
+    # Pointers into a candidate, which may only be used as store addresses.
+    pointers = {}
+    for v in defs:
+        var = pointee(v, commands, defs)
+        if var in candidates:
+            pointers[v] = var
+
+    read = set()
+    for command in commands:
+        for v in command.outputs():
+            if v in candidates and command.has_side_effects():
+                read.add(v)
+
+        for v in command.inputs():
+            if isinstance(command, SetRel) and v is command.base:
+                continue
+            if (command.outputs() and command.outputs()[0] in pointers
+                  and (v is pointers[command.outputs()[0]]
+                       or v in pointers)):
+                continue
+            if (isinstance(command, SetAt) and v is command.addr
+                  and v is not command.val):
+                continue
+
+            if v in pointers:
+                read.add(pointers[v])
+            else:
+                read.add(v)
+
+    return candidates - read
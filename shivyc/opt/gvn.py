@@ -0,0 +1,156 @@
+"""Global value numbering over IL code in SSA form.
+
+Two commands without side effects compute the same value if they are of the
+same kind and have the same inputs. When such a command is dominated by
+another that computes the same value, its output is replaced by the output
+of the dominating command and the command is removed.
+
+A command which depends only on SSA values and literals computes the same
+value wherever it is, so these are numbered across the whole dominator
+tree. A command which reads memory, through a pointer or by reading a
+variable that is not an SSA value, may compute a different value after a
+store or a function call. These are numbered only within a basic block,
+and forgotten at any command which may write the memory they read, as
+told by alias analysis.
+
+A call to a const or pure function, as told by its summary from ipa.py,
+is numbered like any other command which reads memory, or which reads
+none.
+"""
+
+from shivyc.ctypes import float_bits
+from shivyc.il_cmds.control import Call
+from shivyc.il_cmds.value import (AddrOf, AddrRel, LoadArg, Phi, ReadAt,
+                                  ReadRel)
+from shivyc.opt.alias import Memory
+
+
+def number_values(il_code, symbol_table, func, strict_aliasing=True):
+    """Remove commands in function `func` which recompute a known value.
+
+    strict_aliasing (bool) - Whether accesses of different types do not
+    alias.
+    """
+    flow = il_code.cfg(func)
+    commands = flow.commands
+    memory = Memory(il_code, symbol_table, commands, strict_aliasing)
+    values = memory.values
+    if not flow.rpo:
+        return
+
+    replace = {}
+    removed = set()
+
+    def key_of(v):
+        if v in il_code.literals:
+            # A floating literal is keyed by its bits, since 0.0 and -0.0
+            # are equal but differ.
+            val = v.literal.val
+            if v.ctype.is_floating():
+                val = float_bits(val, v.ctype.size)
+            return "literal", val, _type_key(v.ctype)
+        return v
+
+    # Dictionary mapping the key of each available computation to its
+    # output, for computations which depend only on SSA values.
+    available = {}
+
+    # Each entry is a block to visit, or a list of the keys to forget once
+    # all blocks dominated by a block have been visited.
+    walk = [flow.rpo[0]]
+    while walk:
+        block = walk.pop()
+        if isinstance(block, list):
+            for key in block:
+                del available[key]
+            continue
+
+        added = []
+
+        # Map from the key of each computation in the block which reads
+        # memory to its output, and to the memory it reads.
+        local = {}
+        local_reads = {}
+        for i in range(block.start, block.end):
+            command = commands[i]
+            command.replace_inputs(replace)
+
+            writes = memory.writes(command)
+            if writes:
+                for key in [key for key in local if memory.conflict(
+                        writes, local_reads[key])]:
+                    del local[key]
+
+            key = _command_key(command, values, key_of)
+            if key is None:
+                continue
+
+            table = local if _reads_memory(command, values, il_code) \
+                else available
+            output = command.outputs()[0]
+            if key in table:
+                replace[output] = table[key]
+                removed.add(i)
+            else:
+                table[key] = output
+                if table is available:
+                    added.append(key)
+                else:
+                    local_reads[key] = memory.reads(command)
+
+        walk.append(added)
+        walk.extend(reversed(flow.dom_children[block.index]))
+
+    new_commands = []
+    for i, command in enumerate(commands):
+        if i not in removed:
+            command.replace_inputs(replace)
+            new_commands.append(command)
+    il_code.set_commands(func, new_commands)
+
+
+def _type_key(ctype):
+    """Return a hashable key distinguishing types of different values."""
+    return (ctype.size, ctype.is_pointer(), ctype.is_bool(),
+            ctype.is_floating(), getattr(ctype, "signed", False))
+
+
+def _command_key(command, values, key_of):
+    """Return a key for the value computed by given command, if any.
+
+    Commands with equal keys compute equal values, provided memory is not
+    changed between them.
+    """
+    pure_call = isinstance(command, Call) and command.pure()
+    if ((command.has_side_effects() and not pure_call)
+          or isinstance(command, (Phi, LoadArg))
+          or len(command.outputs()) != 1):
+        return None
+
+    output = command.outputs()[0]
+    if output not in values:
+        return None
+
+    inputs = tuple(key_of(v) for v in command.inputs())
+    if getattr(command, "comm", False):
+        inputs = frozenset(inputs)
+
+    return (type(command), _type_key(output.ctype),
+            getattr(command, "chunk", None), getattr(command, "label", None),
+            inputs)
+
+
+def _reads_memory(command, values, il_code):
+    """Return whether the output of given command depends on memory."""
+    if isinstance(command, (ReadAt, ReadRel)) or command.reads_memory():
+        return True
+
+    # The address of a variable does not depend on its value.
+    address_of = None
+    if isinstance(command, AddrOf):
+        address_of = command.var
+    elif isinstance(command, AddrRel):
+        address_of = command.base
+
+    return any(v not in values and v is not address_of
+               and v not in il_code.literals for v in command.inputs())
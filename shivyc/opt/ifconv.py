@@ -0,0 +1,185 @@
+"""If-conversion of small branches over IL code in SSA form.
+
+A branch which only chooses between two values, like
+
+    if(a < b) m = a; else m = b;
+
+is a diamond of blocks: a head ending in a conditional jump, two sides of
+a few cheap commands each, and a join whose Phi commands pick the value
+computed on the side control came through. A triangle, an `if` with no
+`else`, is the same with one side empty. When the branch is hard to
+predict, a mispredicted jump costs far more than running both sides.
+
+So, the commands of both sides are moved into the head, to run on either
+path, and each Phi command of the join is replaced in the head by a Select
+on the condition of the jump, which is emitted as a conditional move. The
+head then jumps straight to the join, and the sides are dropped.
+
+Only sides whose commands cannot fault and only write renamable values are
+moved, and only up to _MAX_SIDE of them, so that running both sides stays
+cheaper than a mispredicted jump. Of nested branches, only the innermost
+is converted, since a branch around it has sides of several blocks.
+"""
+
+from shivyc.il_cmds.compare import Select, _GeneralCmp
+from shivyc.il_cmds.control import Jump, JumpNotZero, JumpZero
+from shivyc.il_cmds.math import AddScaled, _AddMult, _BitShiftCmd, _NegNot
+from shivyc.il_cmds.value import AddrOf, AddrRel, Phi, Set
+from shivyc.opt.ssa import ssa_values
+
+# Most commands each side of a branch may have to be converted, not
+# counting its label and final jump.
+_MAX_SIDE = 2
+
+# Commands which never fault, and so may run on a path which did not run
+# them before.
+_SAFE = (Set, AddrOf, AddrRel, _AddMult, AddScaled, _BitShiftCmd, _NegNot,
+         _GeneralCmp)
+
+
+def convert_branches(il_code, symbol_table, func):
+    """Convert the small branches of function `func` into Selects."""
+    flow = il_code.cfg(func)
+    commands = flow.commands
+    values = ssa_values(il_code, symbol_table, commands)
+
+    # Map from the index of each head block to the commands replacing its
+    # jump, and the indices of the blocks removed or changed.
+    heads = {}
+    dropped = set()
+    joins = set()
+    used = set()
+    for head in flow.rpo:
+        branch = _branch(flow, head, values)
+        if not branch:
+            continue
+        sides, join = branch
+        blocks = {head.index, join.index} | {side.index for side in sides}
+        if blocks & used:
+            continue
+        used |= blocks
+
+        jump = commands[head.end - 1]
+        new = []
+        for side in sides:
+            new.extend(_body(commands, side))
+        new.extend(_selects(commands, head, join, jump))
+        new.append(Jump(commands[join.start].label_name()))
+
+        heads[head.index] = new
+        dropped |= {side.index for side in sides}
+        joins.add(join.index)
+
+    if not heads:
+        return
+
+    new_commands = []
+    for block in flow.blocks:
+        if block.index in dropped:
+            continue
+        block_commands = commands[block.start:block.end]
+        if block.index in heads:
+            block_commands = block_commands[:-1] + heads[block.index]
+        elif block.index in joins:
+            block_commands = [command for command in block_commands
+                              if not isinstance(command, Phi)]
+        new_commands.extend(block_commands)
+    il_code.set_commands(func, new_commands)
+
+
+def _branch(flow, head, values):
+    """Return the sides and the join of the branch at block `head`.
+
+    returns - tuple of the list of blocks of the sides which are not empty
+    and the join block, or None if `head` is not a branch to convert.
+    """
+    commands = flow.commands
+    if (not isinstance(commands[head.end - 1], (JumpZero, JumpNotZero))
+          or len(head.succs) != 2):
+        return None
+
+    first, second = head.succs
+    if _side_of(first, head) and second in first.succs:
+        join = second
+    elif _side_of(second, head) and first in second.succs:
+        join = first
+    elif (_side_of(first, head) and _side_of(second, head)
+          and first.succs == second.succs):
+        join = first.succs[0]
+    else:
+        return None
+
+    sides = [block for block in head.succs if block is not join]
+    if join is head or set(join.preds) != set(sides) | (
+            {head} if len(sides) == 1 else set()):
+        return None
+
+    for side in sides:
+        body = _body(commands, side)
+        if len(body) > _MAX_SIDE or not all(
+                _is_safe(command, values) for command in body):
+            return None
+
+    for command in commands[join.start:join.end]:
+        if isinstance(command, Phi) and not _is_scalar(command.output):
+            return None
+    return sides, join
+
+
+def _side_of(block, head):
+    """Return whether `block` may be a side of a branch at block `head`."""
+    return block.preds == [head] and len(block.succs) == 1
+
+
+def _body(commands, block):
+    """Return the commands of side `block`, but its label and final jump."""
+    body = commands[block.start:block.end]
+    if body and body[0].label_name():
+        body = body[1:]
+    if body and isinstance(body[-1], Jump):
+        body = body[:-1]
+    return body
+
+
+def _is_safe(command, values):
+    """Return whether `command` may run on both paths of a branch."""
+    return (isinstance(command, _SAFE)
+            and all(v in values and _is_scalar(v)
+                    for v in command.outputs()))
+
+
+def _is_scalar(v):
+    """Return whether a Select can choose value `v`."""
+    ctype = v.ctype
+    return ((ctype.is_integral() or ctype.is_pointer())
+            and ctype.size in {1, 2, 4, 8})
+
+
+def _selects(commands, head, join, jump):
+    """Return a Select for each Phi command of block `join`.
+
+    The jump is taken when the Select condition holds for a JumpNotZero,
+    and when it does not hold for a JumpZero, so the first argument of the
+    Select is the value of the path through the jump target in one case and
+    of the path falling through in the other.
+    """
+    labels = {}
+    for block in head.succs:
+        label = commands[block.start].label_name()
+        if block is join:
+            labels[label] = commands[head.start].label_name()
+        else:
+            labels[label] = label
+    taken = labels[jump.label]
+    (fallen,) = set(labels.values()) - {taken}
+    if isinstance(jump, JumpNotZero):
+        holds, fails = taken, fallen
+    else:
+        holds, fails = fallen, taken
+
+    selects = []
+    for command in commands[join.start:join.end]:
+        if isinstance(command, Phi):
+            selects.append(Select(command.output, jump.cond,
+                                  command.args[holds], command.args[fails]))
+    return selects
@@ -0,0 +1,329 @@
+"""Inlining of calls to small functions over IL code.
+
+A call is inlined by replacing the Call command with a copy of the IL code
+of the called function. In the copy, every automatic value of the callee is
+renamed to a new value, every label is renamed to a new label, each
+LoadArg becomes a copy from the argument passed, and each Return becomes a
+copy into the output of the call followed by a jump past the copy.
+
+A call is inlined if the callee is small, is larger but was declared
+`inline`, or is a static function called exactly once so far, in which
+case the function itself is removed once inlined if nothing else refers to
+it. Functions are inlined in the order they are defined, so each function
+has its own calls inlined before it is inlined anywhere, only calls to
+functions defined earlier are inlined, and recursive calls are never
+inlined. A function which may yet be inlined is kept until the end of the
+file; every other function can be compiled as soon as it is defined.
+
+With a profile, a call which ran often is inlined as if the callee were
+declared `inline`, and one which never ran is only inlined if the callee is
+small or is removed once inlined.
+"""
+
+from collections import Counter
+from copy import copy
+
+from shivyc.il_cmds.control import Call, Jump, Label, Return
+from shivyc.il_cmds.value import AddrOf, LoadArg, Set
+from shivyc.il_gen import ILValue
+
+# Largest size of a function which is always inlined. The size of a
+# function is the number of its commands, other than labels.
+SMALL_SIZE = 12
+
+# Largest size of a function declared `inline` which is inlined.
+HINT_SIZE = 40
+
+# Largest size of a static function called once which is inlined.
+ONCE_SIZE = 150
+
+# Size past which no more calls are inlined into a function.
+CALLER_SIZE = 2000
+
+# Least number of times a call ran in the profile given by -fprofile-use for
+# it to be inlined as if the callee were declared `inline`.
+HOT_COUNT = 1000
+
+
+class Inliner:
+    """Inliner of calls to small functions, as each function is made.
+
+    il_code (ILCode) - IL code of the functions added
+    symbol_table (SymbolTable) - Symbol table of the IL code
+    """
+
+    def __init__(self, il_code, symbol_table):
+        """Initialize Inliner."""
+        self.il_code = il_code
+        self.symbol_table = symbol_table
+
+        # Map from the name of each function added to its ILValue.
+        self.functions = {}
+
+        # Names of the functions kept since they may yet be inlined, in the
+        # order they were added.
+        self.kept = {}
+
+        # Names of the functions which have been inlined somewhere.
+        self.inlined = set()
+
+        # Number of direct calls and of references to each function name
+        # from the functions added.
+        self.calls = Counter()
+        self.refs = Counter()
+
+    def add(self, func):
+        """Inline the calls in function `func` to the functions kept.
+
+        returns - the list of the functions which can now be compiled
+        """
+        self.functions[func] = function_value(self.symbol_table, func)
+
+        # The calls in this function are counted while they are inlined, so
+        # that a static function called a second time here is not inlined.
+        calls, refs = self._count(func)
+        self.calls.update(calls)
+        self.refs.update(refs)
+        self.inlined.update(_inline_calls(
+            self.il_code, self.symbol_table, self.functions, func, self.kept,
+            self.calls, self.refs))
+        self.calls.subtract(calls)
+        self.refs.subtract(refs)
+
+        calls, refs = self._count(func)
+        self.calls.update(calls)
+        self.refs.update(refs)
+
+        if _should_inline(self.il_code, self.symbol_table,
+                          self.functions[func], func,
+                          count=_entry_count(self.il_code, func)):
+            self.kept[func] = None
+            return []
+        return [func]
+
+    def finish(self):
+        """Return the kept functions which must still be compiled.
+
+        The static functions which were inlined and are no longer referenced
+        are removed from the IL code. A function whose address initializes
+        static data is referenced by that data.
+        """
+        in_data = {value[0] for image in self.il_code.static_inits.values()
+                   for _, _, value in image if isinstance(value, tuple)}
+        remaining = []
+        for func in self.kept:
+            var = self.functions[func]
+            if (func in self.inlined and not self.refs[func]
+                  and var not in in_data
+                  and self.symbol_table.linkage_type.get(var)
+                  == self.symbol_table.INTERNAL):
+                self.il_code.release(func)
+            else:
+                remaining.append(func)
+        return remaining
+
+    def _count(self, func):
+        """Count the calls and references to each function from `func`.
+
+        A function referenced by its own code only is not counted as
+        referenced. References are counted even to functions not yet
+        defined.
+
+        returns - a counter of the direct calls to each function name, and
+        another of the references to each function name
+        """
+        commands = self.il_code.commands[func]
+        calls = Counter(call_targets(commands, self.functions).values())
+        refs = Counter()
+        for command in commands:
+            if (isinstance(command, AddrOf)
+                  and command.var.ctype.is_function()):
+                name = self.symbol_table.names.get(command.var)
+                if name != func:
+                    refs[name] += 1
+        return calls, refs
+
+
+def function_value(symbol_table, name):
+    """Return the ILValue of the function defined with the given name."""
+    return (symbol_table.linkages[symbol_table.INTERNAL].get(name)
+            or symbol_table.linkages[symbol_table.EXTERNAL][name])
+
+
+def function_values(il_code, symbol_table):
+    """Return a dictionary mapping each function name to its ILValue.
+
+    Only the functions whose IL code is still in `il_code` are included.
+    """
+    return {name: function_value(symbol_table, name)
+            for name in il_code.commands}
+
+
+def call_targets(commands, functions):
+    """Return a dictionary mapping calls in `commands` to functions named.
+
+    Only a call of a function through an address computed by an AddrOf
+    right before it, which is used by nothing but the call, is included.
+    """
+    names = {v: name for name, v in functions.items()}
+
+    addr_of = {}
+    uses = {}
+    for command in commands:
+        for v in command.inputs():
+            uses[v] = uses.get(v, 0) + 1
+        if isinstance(command, AddrOf) and command.var in names:
+            addr_of[command.output] = names[command.var]
+
+    targets = {}
+    for command in commands:
+        if (isinstance(command, Call) and command.func in addr_of
+              and uses[command.func] == 1):
+            targets[command] = addr_of[command.func]
+    return targets
+
+
+def _entry_count(il_code, func):
+    """Return how many times function `func` ran in the profile, or None if
+    that is not known.
+    """
+    for command in il_code.commands[func]:
+        if command.label_name() in il_code.counts:
+            return il_code.counts[command.label_name()]
+    return None
+
+
+def _size(commands):
+    """Return the number of commands other than labels in `commands`."""
+    return sum(1 for command in commands if not command.label_name())
+
+
+def _should_inline(il_code, symbol_table, var, callee, calls=None,
+                   refs=None, count=None):
+    """Return whether calls to the function `callee` should be inlined.
+
+    If no counts of calls and references are given, returns whether any
+    call to `callee` may be inlined.
+
+    count (int) - Number of times the call ran in the profile, or None if
+    that is not known. To ask whether any call may be inlined, this is the
+    number of times `callee` itself ran.
+    """
+    commands = il_code.commands[callee]
+    ctype = var.ctype
+    if not ctype.ret.is_void() and not ctype.ret.is_scalar():
+        return False
+    if not all(arg.is_scalar() for arg in ctype.args):
+        return False
+    # Static data holding the address of a label of the function holds the
+    # one in the function itself, not in a copy.
+    if any(isinstance(command, Label) and command.name
+           for command in commands):
+        return False
+
+    size = _size(commands)
+    if size <= SMALL_SIZE:
+        return True
+    hot = count is not None and count >= HOT_COUNT
+    if ((var in symbol_table.inline_hints or hot) and count != 0
+          and size <= HINT_SIZE):
+        return True
+    return (symbol_table.linkage_type.get(var) == symbol_table.INTERNAL
+            and (calls is None or calls[callee] == 1 and refs[callee] == 1)
+            and size <= ONCE_SIZE)
+
+
+def _inline_calls(il_code, symbol_table, functions, func, done, calls,
+                  refs):
+    """Inline calls in function `func` to the functions in `done`.
+
+    returns - the set of names of functions inlined
+    """
+    commands = il_code.commands[func]
+    targets = call_targets(commands, functions)
+
+    inlined = set()
+    addresses = set()
+    size = _size(commands)
+    count = None
+    new_commands = []
+    for command in commands:
+        count = il_code.counts.get(command.label_name(), count)
+        callee = targets.get(command)
+        if (callee is None or callee == func or callee not in done
+              or command.func.ctype.arg.no_info or size > CALLER_SIZE
+              or not _should_inline(il_code, symbol_table, functions[callee],
+                                    callee, calls, refs, count)):
+            new_commands.append(command)
+            continue
+
+        body = _copy_body(il_code, symbol_table, callee, command, count)
+        new_commands.extend(body)
+        size += _size(body)
+        inlined.add(callee)
+        addresses.add(command.func)
+
+    # The address of each function inlined is no longer used.
+    if inlined:
+        il_code.set_commands(func, [
+            command for command in new_commands
+            if not (isinstance(command, AddrOf)
+                    and command.output in addresses)])
+    return inlined
+
+
+def _copy_body(il_code, symbol_table, callee, call, count):
+    """Return a copy of the code of `callee` to replace the given call.
+
+    count (int) - Number of times the call ran in the profile, the count of
+    the code after the copy, or None if that is not known.
+    """
+    commands = il_code.commands[callee]
+    storage = symbol_table.storage
+
+    mapping = {}
+    for command in commands:
+        for v in command.inputs() + command.outputs():
+            if (v not in mapping and v is not None
+                  and storage.get(v, symbol_table.AUTOMATIC)
+                    == symbol_table.AUTOMATIC
+                  and v not in il_code.literals
+                  and v not in il_code.string_literals):
+                new = ILValue(v.ctype)
+                if v in storage:
+                    storage[new] = storage[v]
+                if v in symbol_table.names:
+                    symbol_table.names[new] = symbol_table.names[v]
+                mapping[v] = new
+
+    labels = {}
+    for command in commands:
+        for label in [command.label_name()] + command.targets():
+            if label and label not in labels:
+                labels[label] = il_code.copy_label(label)
+
+    end = il_code.get_label()
+    if count is not None:
+        il_code.counts[end] = count
+    body = []
+    for command in commands:
+        if isinstance(command, LoadArg):
+            arg = call.args[command.arg_num]
+            body.append(Set(mapping[command.output], arg))
+        elif isinstance(command, Return):
+            if command.arg and not call.void_return:
+                body.append(Set(call.ret, mapping.get(command.arg,
+                                                      command.arg)))
+            body.append(Jump(end))
+        else:
+            new = copy(command)
+            new.replace_inputs(mapping)
+            new.replace_outputs(mapping)
+            if hasattr(new, "label"):
+                new.label = labels[new.label]
+            if hasattr(new, "labels"):
+                new.labels = [labels[label] for label in new.labels]
+            body.append(new)
+
+    body.append(Label(end))
+    return body
@@ -0,0 +1,99 @@
+"""Summaries of the functions of a file, for the calls to them.
+
+Without a summary, a call is assumed to change every caller-saved register
+and any memory which code outside the calling function may reach. Once a
+function of the file is compiled, it is given a summary of what a call of
+it may really do, kept in il_code.summaries, and each direct call to it in
+the functions compiled later is given that summary.
+
+The summary tells the effect of the function on memory. A function is
+const if it neither reads nor writes any memory but its own locals, so its
+result depends only on its arguments, and pure if it reads such memory but
+writes none. A call to a const or pure function is numbered by value
+numbering and moved out of loops by code motion like any other command
+which computes its output from its inputs and memory. The summary also
+tells whether the function surely returns, which is so if it has no loops
+but counted loops, as described in counted.py, no divisions, which may
+fault, and calls only functions which surely return. A call to a pure
+function which surely returns is removed if its result is not used, and a
+call to a const function which surely returns may be moved out of a loop
+from anywhere in the loop.
+
+The summary also lists the caller-saved registers the code of the function
+may change, so that values may stay in the other caller-saved registers
+across calls to it. This is known only once the code of the function is
+generated, so it is left out when code is generated in a pool of
+processes.
+
+Only calls to functions compiled before the calling function are given a
+summary, so no recursive call is. Functions kept to be inlined are compiled
+at the end of the file.
+"""
+
+import shivyc.abi as abi
+from shivyc.il_cmds.control import Call
+from shivyc.il_cmds.math import _DivMod
+from shivyc.opt.alias import Memory
+from shivyc.opt.counted import counted_loop
+from shivyc.opt.inline import call_targets, function_value
+
+
+class Summary:
+    """What a call of a function defined in the file may do.
+
+    writes (bool) - Whether the function may write memory outside its frame.
+    reads (bool) - Whether the function may read memory outside its frame.
+    finite (bool) - Whether the function surely returns, without looping
+    forever or faulting.
+    regs (List[Spot]) - The caller-saved registers the function may change,
+    or None if they are not known.
+    """
+
+    def __init__(self, writes, reads, finite, regs=None):
+        """Initialize Summary."""
+        self.writes = writes
+        self.reads = reads
+        self.finite = finite
+        self.regs = regs
+
+
+def annotate_calls(il_code, symbol_table, func):
+    """Give the direct calls in function `func` the summaries of their
+    callees.
+    """
+    if not il_code.summaries:
+        return
+    functions = {name: function_value(symbol_table, name)
+                 for name in il_code.summaries}
+    targets = call_targets(il_code.commands[func], functions)
+    for call, name in targets.items():
+        call.summary = il_code.summaries[name]
+
+
+def summarize(il_code, symbol_table, func, strict_aliasing=True):
+    """Make the summary of function `func`, which is in SSA form.
+
+    Its registers are filled in once its code is generated.
+    """
+    flow = il_code.cfg(func)
+    commands = flow.commands
+    memory = Memory(il_code, symbol_table, commands, strict_aliasing)
+
+    # A function which stores its return value through a pointer from the
+    # caller writes memory outside its frame.
+    writes = abi.in_memory(function_value(symbol_table, func).ctype.ret)
+    reads = False
+    finite = all(counted_loop(il_code, symbol_table, flow, loop)
+                 for loop in flow.loops)
+    for command in commands:
+        writes = writes or any(memory.outside(access)
+                               for access in memory.writes(command))
+        reads = reads or any(memory.outside(access)
+                             for access in memory.reads(command))
+        if isinstance(command, Call):
+            finite = finite and bool(command.summary
+                                     and command.summary.finite)
+        elif isinstance(command, _DivMod):
+            finite = False
+
+    il_code.summaries[func] = Summary(writes, reads, finite)
@@ -0,0 +1,277 @@
+"""Placement of the basic blocks of a function, so that jumps are rare.
+
+The IL is generated with blocks in source order, which leaves a jump on
+paths that run often. This pass, run last, improves the order in three
+steps.
+
+Loops are rotated. A loop is generated with its test at the top, so every
+trip ends with a jump back to the test and then another jump out of the
+test into the body. When the test is a single small block, each back jump
+is replaced by a copy of the test, which jumps straight to the body while
+the loop goes on. The test at the top is then only run on entry.
+
+Cold blocks are moved to the end of the function. A block is cold if it
+is branched to with a label in il_code.cold_labels, as told by
+__builtin_expect or by a profile, or if all the blocks which lead to it
+are cold, so that the code of an unexpected branch is moved out of the way
+of the expected path as a whole. A block which fell through to a block
+which no longer follows it then jumps there.
+
+Last, jumps to a block which only jumps on are sent straight on, a
+conditional jump over an unconditional jump is replaced by the opposite
+conditional jump, and jumps to the label right after them are removed, as
+are the labels and blocks which are then no longer jumped to.
+
+Unlike most other passes, this runs after the code is out of SSA form, and
+after comparisons are fused with their jumps.
+"""
+
+from copy import copy
+
+from shivyc.il_cmds.compare import CmpJump
+from shivyc.il_cmds.control import Call, Jump, JumpNotZero, JumpZero, Label
+from shivyc.opt.ssa import _remove_jumps_to_next
+
+# Most commands the test of a loop may have, not counting its label and
+# jump, for the test to be copied to the end of each trip.
+rotate_limit = 6
+
+
+def lay_out_blocks(il_code, func):
+    """Place the blocks of function `func` so fewer jumps are taken."""
+    _rotate_loops(il_code, func)
+    _sink_cold_blocks(il_code, func)
+    _remove_jumps(il_code, func)
+
+
+def _conditional(command):
+    """Return whether given command is a conditional jump."""
+    return isinstance(command, (JumpZero, JumpNotZero, CmpJump))
+
+
+def _retarget(jump, label, negate=False):
+    """Return a copy of a conditional jump, jumping to `label` instead.
+
+    negate (bool) - Whether the copy jumps when the original does not.
+    """
+    if isinstance(jump, CmpJump):
+        return CmpJump(copy(jump.cmp), label, jump.negate != negate)
+    if negate:
+        return (JumpNotZero if isinstance(jump, JumpZero)
+                else JumpZero)(jump.cond, label)
+    return type(jump)(jump.cond, label)
+
+
+class _Labels:
+    """The labels of the blocks of a CFG, made for blocks which have none.
+
+    needed (Dict) - Map from the start index of each block given a new
+    label to the label.
+    """
+
+    def __init__(self, il_code, flow):
+        """Initialize _Labels."""
+        self.il_code = il_code
+        self.flow = flow
+        self.needed = {}
+
+    def of(self, block):
+        """Return the label of the given block."""
+        label = self.flow.commands[block.start].label_name()
+        if label:
+            return label
+        if block.start not in self.needed:
+            self.needed[block.start] = self.il_code.get_label()
+        return self.needed[block.start]
+
+    def block(self, block):
+        """Return the commands of the given block, with any new label."""
+        commands = self.flow.commands[block.start:block.end]
+        if block.start in self.needed:
+            return [Label(self.needed[block.start])] + commands
+        return commands
+
+
+def _rotate_loops(il_code, func):
+    """Replace the back jumps of loops with copies of their tests."""
+    flow = il_code.cfg(func)
+    commands = flow.commands
+    labels = _Labels(il_code, flow)
+    blocks = {commands[block.start].label_name(): block
+              for block in flow.blocks}
+
+    # Map from the header label of each loop rotated to the loop, the
+    # commands of its test, its jump, and the label the copies of the jump
+    # go to and whether they are negated, and the label of the exit.
+    tests = {}
+    for loop in flow.loops:
+        header = loop.header
+        label = commands[header.start].label_name()
+        jump = commands[header.end - 1]
+        test = commands[header.start + 1:header.end - 1]
+        if (not label or not _conditional(jump)
+              or header.index + 1 == len(flow.blocks)
+              or len(test) > rotate_limit
+              or any(command.targets() or not command.falls_through()
+                     or isinstance(command, Call) for command in test)):
+            continue
+
+        jumped = blocks[jump.label]
+        fallen = flow.blocks[header.index + 1]
+        if loop.contains(fallen) and not loop.contains(jumped):
+            tests[label] = (loop, test, jump, labels.of(fallen), True,
+                            jump.label)
+        elif loop.contains(jumped) and not loop.contains(fallen):
+            tests[label] = (loop, test, jump, jump.label, False,
+                            labels.of(fallen))
+
+    if not tests:
+        return
+
+    new_commands = []
+    for block in flow.blocks:
+        new = labels.block(block)
+        last = new[-1]
+        if (isinstance(last, Jump) and last.label in tests
+              and tests[last.label][0].contains(block)):
+            _, test, jump, body, negate, exit = tests[last.label]
+            new = (new[:-1] + [copy(command) for command in test]
+                   + [_retarget(jump, body, negate), Jump(exit)])
+        new_commands += new
+    il_code.set_commands(func, new_commands)
+
+
+def _sink_cold_blocks(il_code, func):
+    """Move the cold blocks of a function to its end."""
+    flow = il_code.cfg(func)
+    commands = flow.commands
+    if not il_code.cold_labels or not flow.blocks:
+        return
+
+    # A block with a cold label is cold if it is still reached by a branch.
+    # Once the branch is folded, the label may be left in straight-line
+    # code.
+    starts = set()
+    for block in flow.rpo[1:]:
+        if (commands[block.start].label_name() in il_code.cold_labels
+              and any(_conditional(commands[pred.end - 1])
+                      for pred in block.preds)):
+            starts.add(block.index)
+
+    # Begin with every reachable block cold but the entry, and warm the
+    # blocks led to by warm ones until nothing changes.
+    cold = [flow.reachable(block) and block.index != 0
+            for block in flow.blocks]
+    changed = True
+    while changed:
+        changed = False
+        for block in flow.rpo[1:]:
+            if (cold[block.index] and block.index not in starts
+                  and any(not cold[pred.index] or _forwards(commands, pred)
+                          for pred in block.preds)):
+                cold[block.index] = False
+                changed = True
+
+    if not any(cold):
+        return
+
+    order = ([block for block in flow.blocks if not cold[block.index]]
+             + [block for block in flow.blocks if cold[block.index]])
+    labels = _Labels(il_code, flow)
+    follows = []
+    for i, block in enumerate(order):
+        after = order[i + 1] if i + 1 < len(order) else None
+        falls = commands[block.end - 1].falls_through()
+        if (falls and block.index + 1 < len(flow.blocks)
+              and after is not flow.blocks[block.index + 1]):
+            follows.append(Jump(labels.of(flow.blocks[block.index + 1])))
+        else:
+            follows.append(None)
+
+    new_commands = []
+    for block, follow in zip(order, follows):
+        new_commands += labels.block(block)
+        if follow:
+            new_commands.append(follow)
+    il_code.set_commands(func, new_commands)
+
+
+def _forwards(commands, block):
+    """Return whether a block only jumps on to another.
+
+    Such a block is made by __builtin_expect for an unexpected branch to a
+    label, and the code at that label is not cold just because of it.
+    """
+    return (block.end - block.start == 2
+            and commands[block.start].label_name()
+            and isinstance(commands[block.start + 1], Jump))
+
+
+def _remove_jumps(il_code, func):
+    """Remove the jumps and labels the layout leaves with no use."""
+    commands = il_code.commands[func]
+
+    # A jump to a block which only jumps on goes straight to where that
+    # block jumps.
+    forward = {}
+    for i, command in enumerate(commands):
+        label = command.label_name()
+        j = i + len(_labels_at(commands, i))
+        if label and j < len(commands) and isinstance(commands[j], Jump):
+            forward[label] = commands[j].label
+
+    def final(label):
+        seen = set()
+        while label in forward and label not in seen:
+            seen.add(label)
+            label = forward[label]
+        return label
+
+    # A conditional jump over an unconditional one is replaced by the
+    # opposite conditional jump.
+    threaded = []
+    i = 0
+    while i < len(commands):
+        command = commands[i]
+        if isinstance(command, Jump):
+            command = Jump(final(command.label))
+        elif (_conditional(command) and i + 1 < len(commands)
+              and isinstance(commands[i + 1], Jump)
+              and command.label in _labels_at(commands, i + 2)):
+            command = _retarget(command, final(commands[i + 1].label), True)
+            i += 1
+        elif _conditional(command):
+            command = _retarget(command, final(command.label))
+        threaded.append(command)
+        i += 1
+
+    # Then the labels no longer jumped to are removed, and the commands
+    # which can no longer be reached after a jump or return. The labels
+    # with counts are kept for the code generator where they are reached,
+    # and the labels whose address is taken are always kept.
+    commands = _remove_jumps_to_next(threaded)
+    targets = set(il_code.taken_labels)
+    for command in commands:
+        targets.update(command.targets())
+
+    new_commands = []
+    reached = True
+    for command in commands:
+        label = command.label_name()
+        if label and label not in targets and not (
+                reached and label in il_code.counts):
+            continue
+        reached = reached or bool(label)
+        if reached:
+            new_commands.append(command)
+            reached = command.falls_through()
+    il_code.set_commands(func, new_commands)
+
+
+def _labels_at(commands, i):
+    """Return the labels of the run of Label commands from index i."""
+    labels = set()
+    while i < len(commands) and commands[i].label_name():
+        labels.add(commands[i].label_name())
+        i += 1
+    return labels
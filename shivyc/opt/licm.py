@@ -0,0 +1,169 @@
+"""Loop-invariant code motion over IL code in SSA form.
+
+A command in a loop is invariant if it computes the same value on every
+iteration: it has no side effects, and each of its inputs is defined outside
+the loop or by another invariant command. Invariant commands are moved into
+a preheader, a new block which runs once before the loop is entered.
+
+A command which reads memory is invariant only if nothing in the loop may
+write the memory it reads, as told by alias analysis. Such loads are only
+moved from blocks which run on every iteration, and only if they read from
+a known variable or are in the header, which runs whenever the loop is
+entered, so that moving them cannot introduce a fault. Likewise, a call to
+a const or pure function, as told by its summary from ipa.py, is only moved
+from the header, unless the function is const and surely returns. The
+address of the function is moved along with the call.
+"""
+
+from shivyc.il_cmds.control import Call, Label
+from shivyc.il_cmds.math import _DivMod
+from shivyc.il_cmds.value import AddrOf, LoadArg, Phi, ReadAt
+from shivyc.opt.alias import Memory
+
+
+def hoist_invariants(il_code, symbol_table, func, strict_aliasing=True):
+    """Move loop-invariant commands of function `func` out of their loops.
+
+    Inner loops are handled first, so a command invariant in several nested
+    loops is moved out of all of them.
+
+    strict_aliasing (bool) - Whether accesses of different types do not
+    alias.
+    """
+    flow = il_code.cfg(func)
+    loops = sorted(flow.loops, key=lambda loop: -loop.depth)
+    headers = [flow.commands[loop.header.start].label_name()
+               for loop in loops]
+
+    for header in headers:
+        flow = il_code.cfg(func)
+        for loop in flow.loops:
+            if flow.commands[loop.header.start].label_name() == header:
+                _hoist(il_code, symbol_table, func, flow, loop,
+                       strict_aliasing)
+                break
+
+
+def _hoist(il_code, symbol_table, func, flow, loop, strict_aliasing):
+    """Move the invariant commands of the given loop into a preheader."""
+    commands = flow.commands
+    header = loop.header
+    entry = loop_entry(flow, loop)
+    if not entry:
+        return
+    entry_label = commands[entry.start].label_name()
+
+    memory = Memory(il_code, symbol_table, commands, strict_aliasing)
+    values, defs = memory.values, memory.defs
+
+    blocks = [block for block in flow.rpo if loop.contains(block)]
+    body = [i for block in blocks for i in range(block.start, block.end)]
+    in_body = set(body)
+    writes = [access for i in body for access in memory.writes(commands[i])]
+
+    # Blocks which run on every iteration of the loop.
+    every = {block.index for block in blocks
+             if all(flow.dominates(block, latch) for latch in loop.latches)}
+
+    def reads_ok(command, block):
+        if (isinstance(command, Call) and not command.has_side_effects()
+              and not command.reads_memory()):
+            return True
+        if block is not header and (
+                isinstance(command, Call) or (
+                    isinstance(command, ReadAt)
+                    and memory.pointee(command.addr) is None)):
+            return False
+        reads = memory.reads(command)
+        if not reads:
+            return True
+        return (block.index in every
+                and not memory.conflict(reads, writes))
+
+    hoisted = []
+    hoisted_set = set()
+    changed = True
+    while changed:
+        changed = False
+        for i in body:
+            command = commands[i]
+            if i in hoisted_set or not _movable(command, values):
+                continue
+
+            invariant = True
+            for v in command.inputs():
+                d = defs.get(v)
+                if d is not None and d not in hoisted_set and d in in_body:
+                    invariant = False
+                    break
+
+            if invariant and reads_ok(command, flow.block_of(i)):
+                hoisted.append(command)
+                hoisted_set.add(i)
+                changed = True
+
+    # The address of a function is kept in the loop unless a call moved out
+    # of the loop uses it.
+    used = {v for command in hoisted for v in command.inputs()}
+    for i in list(hoisted_set):
+        command = commands[i]
+        if _function_address(command) and command.output not in used:
+            hoisted.remove(command)
+            hoisted_set.remove(i)
+
+    if not hoisted:
+        return
+
+    preheader = il_code.get_label()
+    new_commands = []
+    for i, command in enumerate(commands):
+        if i == header.start:
+            new_commands.append(Label(preheader))
+            new_commands.extend(hoisted)
+        if i in hoisted_set:
+            continue
+        if isinstance(command, Phi) and entry_label in command.args:
+            command.args[preheader] = command.args.pop(entry_label)
+        new_commands.append(command)
+
+    il_code.set_commands(func, new_commands)
+
+
+def loop_entry(flow, loop):
+    """Return the block from which the given loop is entered, or None.
+
+    A preheader is placed just before the header, so the loop must be
+    entered only by falling through from the block before it.
+    """
+    commands = flow.commands
+    header = loop.header
+    entries = [pred for pred in header.preds if not loop.contains(pred)]
+    if len(entries) != 1 or entries[0].index != header.index - 1:
+        return None
+    entry = entries[0]
+    entry_label = commands[entry.start].label_name()
+    header_label = commands[header.start].label_name()
+    if not entry_label or header_label in commands[entry.end - 1].targets():
+        return None
+    return entry
+
+
+def _movable(command, values):
+    """Return whether given command may be moved, if it is invariant."""
+    # Division may fault, so it must not run unless the loop would run it.
+    pure_call = isinstance(command, Call) and command.pure()
+    if ((command.has_side_effects() and not pure_call)
+          or isinstance(command, (Phi, LoadArg, _DivMod))):
+        return False
+
+    outputs = command.outputs()
+    return len(outputs) == 1 and outputs[0] in values
+
+
+def _function_address(command):
+    """Return whether given command takes the address of a function.
+
+    The address of a function is only used to call it, and moving it out of
+    the loop would just keep it in a register across every call.
+    """
+    return isinstance(command, AddrOf) and command.var.ctype.is_function()
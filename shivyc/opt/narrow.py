@@ -0,0 +1,261 @@
+"""Narrowing of integer operations by their demanded bits, over IL code in
+SSA form.
+
+C promotes char and short operands to int before any arithmetic, so code
+which works on bytes, like
+
+    dst[i] = src[i] + 1;
+
+for char arrays, sign extends the byte it loads to an int, adds to it, and
+truncates the sum back to a char to store it. The upper bits of the sum are
+never observed, so neither the extension nor the int addition is needed.
+
+The bits of each value which some use may observe, its demanded bits, are
+found first. A truncation demands the bits of its argument it keeps, and an
+addition, subtraction, multiplication, negation, or left shift by a literal
+count demands only the bits of its arguments up to the highest bit of its
+result which is demanded, since no carry moves down. The bitwise operations
+demand the same bits of their arguments as of their result, a right shift
+by a literal count demands them shifted up, and a phi passes them on to its
+arguments. Any other use demands every bit.
+
+Then, for each of those operations whose demanded bits all fit in a
+narrower width, the same operation is computed at that width, on the
+arguments the extensions were made from, when each argument is available at
+it. The narrow result equals the wide one in every bit of that width, so a
+truncation of the wide result to at most that width is made a copy of the
+narrow result. The wide operation and the extensions are then left for dead
+code elimination to remove.
+"""
+
+from copy import copy
+
+import shivyc.ctypes as ctypes
+from shivyc.il_cmds.math import (Add, BitAnd, BitOr, BitXor, LBitShift,
+                                 Mult, Neg, Not, RBitShift, Subtr)
+from shivyc.il_cmds.value import Phi, Set
+from shivyc.il_gen import ILValue
+from shivyc.opt.ssa import ssa_values
+
+# The type of the narrow result of an operation of each width.
+narrow_types = {1: ctypes.unsig_char, 2: ctypes.unsig_short,
+                4: ctypes.unsig_int}
+
+# Operations whose result in the low bits of any width depends only on the
+# low bits of that width of their arguments, so they may be narrowed.
+_carry_ops = (Add, Subtr, Mult, Neg)
+_bitwise_ops = (BitAnd, BitOr, BitXor, Not)
+
+
+def narrow_values(il_code, symbol_table, func):
+    """Narrow the integer operations of function `func` to the width of the
+    bits demanded of their results.
+    """
+    commands = il_code.commands[func]
+    values = {v for v in ssa_values(il_code, symbol_table, commands)
+              if _is_int(v)}
+    demanded = _demanded_bits(commands, values)
+
+    narrow = {}
+    literals = {}
+
+    def at_width(v, width):
+        """Return `v` computed at width `width`, or None."""
+        if v.literal:
+            key = (width, v.literal.val & _mask(width))
+            if key not in literals:
+                literals[key] = ILValue(narrow_types[width])
+                il_code.register_literal_var(literals[key], key[1])
+            return literals[key]
+        if v.ctype.size == width and _is_int(v):
+            return v
+        if v in narrow and narrow[v].ctype.size == width:
+            return narrow[v]
+        return None
+
+    new_commands = []
+    changed = False
+    for command in commands:
+        if _is_extension(command) and command.output in values:
+            narrow[command.output] = command.arg
+
+        elif _is_truncation(command):
+            n = narrow.get(command.arg)
+            if n and n.ctype.size >= command.output.ctype.size:
+                command = copy(command)
+                command.replace_inputs({command.arg: n})
+                changed = True
+
+        elif _narrowable(command) and command.output in values:
+            new = _narrowed(command, demanded[command.output], at_width)
+            if new:
+                narrow[command.output] = new.output
+                new_commands.append(new)
+                changed = True
+
+        new_commands.append(command)
+
+    if changed:
+        il_code.set_commands(func, new_commands)
+
+
+def _narrowed(command, demanded, at_width):
+    """Return the command computing `command` at the narrowest width which
+    holds `demanded`, its demanded bits, or None.
+    """
+    output = command.output
+    for width in sorted(narrow_types):
+        if width >= output.ctype.size or demanded & ~_mask(width):
+            continue
+        # There is no two-operand multiplication of bytes.
+        if isinstance(command, Mult) and width == 1:
+            continue
+
+        args = _narrowed_args(command)
+        mapping = {arg: at_width(arg, width) for arg in args}
+        if any(new is None for new in mapping.values()):
+            continue
+        if isinstance(command, LBitShift) and command.arg2.literal.val >= (
+                width * 8):
+            continue
+
+        new = copy(command)
+        new.replace_inputs(mapping)
+        new.replace_outputs({output: ILValue(narrow_types[width])})
+        return new
+    return None
+
+
+def _narrowed_args(command):
+    """Return the arguments of a narrowable command which are narrowed."""
+    if isinstance(command, LBitShift):
+        return [command.arg1]
+    return command.inputs()
+
+
+def _narrowable(command):
+    """Return whether `command` may be computed at a narrower width."""
+    if isinstance(command, LBitShift):
+        return (_is_int(command.output)
+                and _shift_count(command) is not None)
+    return (isinstance(command, _carry_ops + _bitwise_ops)
+            and _is_int(command.output)
+            and all(_is_int(arg) for arg in command.inputs()))
+
+
+def _demanded_bits(commands, values):
+    """Return a map from each value in `values` to its demanded bits.
+
+    The map only grows as the commands are visited, so they are visited in
+    reverse until it stops changing, to reach the uses through phis in
+    loops.
+    """
+    demanded = dict.fromkeys(values, 0)
+
+    changed = True
+    while changed:
+        changed = False
+        for command in reversed(commands):
+            for v, bits in _uses(command, demanded):
+                if v in demanded and bits & ~demanded[v]:
+                    demanded[v] |= bits
+                    changed = True
+    return demanded
+
+
+def _uses(command, demanded):
+    """Return pairs of each argument of `command` and the bits of it
+    which `command` demands.
+    """
+    outputs = command.outputs()
+    if len(outputs) != 1:
+        return _every(command, demanded)
+    output = outputs[0]
+    bits = demanded.get(output, _all(output))
+
+    if _is_extension(command) or _is_truncation(command):
+        arg = command.arg
+        arg_bits = bits & _mask(arg.ctype.size)
+        if arg.ctype.signed and bits & ~_mask(arg.ctype.size):
+            arg_bits |= _sign_bit(arg)
+        return [(arg, arg_bits)]
+
+    elif isinstance(command, Phi):
+        return [(arg, bits) for arg in command.inputs()]
+
+    elif not _is_int(output) or not all(
+            _is_int(arg) for arg in command.inputs()):
+        pass
+
+    elif isinstance(command, _carry_ops):
+        low = (1 << bits.bit_length()) - 1
+        return [(arg, low) for arg in command.inputs()]
+
+    elif isinstance(command, _bitwise_ops):
+        return [(arg, bits) for arg in command.inputs()]
+
+    elif isinstance(command, (LBitShift, RBitShift)):
+        count = _shift_count(command)
+        if count is not None:
+            arg = command.arg1
+            if isinstance(command, LBitShift):
+                arg_bits = bits >> count
+            else:
+                arg_bits = (bits << count) & _mask(arg.ctype.size)
+                if arg.ctype.signed and bits >> (
+                        arg.ctype.size * 8 - count):
+                    arg_bits |= _sign_bit(arg)
+            return [(arg, arg_bits), (command.arg2, _all(command.arg2))]
+
+    return _every(command, demanded)
+
+
+def _every(command, demanded):
+    """Return pairs of each argument of `command` in `demanded` and all
+    its bits.
+    """
+    return [(arg, _all(arg)) for arg in command.inputs() if arg in demanded]
+
+
+def _is_extension(command):
+    """Return whether `command` extends an integer to a wider integer."""
+    return (isinstance(command, Set) and _is_int(command.output)
+            and _is_int(command.arg)
+            and command.output.ctype.size > command.arg.ctype.size)
+
+
+def _is_truncation(command):
+    """Return whether `command` truncates an integer to a narrower integer,
+    not a _Bool.
+    """
+    return (isinstance(command, Set) and _is_int(command.output)
+            and _is_int(command.arg)
+            and command.output.ctype.size < command.arg.ctype.size)
+
+
+def _is_int(v):
+    """Return whether `v` is an integer other than a _Bool."""
+    return v.ctype.is_integral() and not v.ctype.is_bool()
+
+
+def _shift_count(command):
+    """Return the literal count of a shift, if it is in range, or None."""
+    count = command.arg2.literal
+    if count and 0 <= count.val < command.arg1.ctype.size * 8:
+        return count.val
+    return None
+
+
+def _mask(size):
+    """Return the mask of the bits of an integer of `size` bytes."""
+    return (1 << (size * 8)) - 1
+
+
+def _all(v):
+    """Return the mask of every bit of value `v`."""
+    return _mask(v.ctype.size)
+
+
+def _sign_bit(v):
+    """Return the mask of the sign bit of integer value `v`."""
+    return 1 << (v.ctype.size * 8 - 1)
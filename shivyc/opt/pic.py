@@ -0,0 +1,124 @@
+"""Position-independent code, for -fPIC and -fpie.
+
+Code which may be loaded at any address reaches the objects and functions
+it defines relative to RIP, and those another module may define through the
+global offset table, which the dynamic linker fills with their addresses.
+ASMGen gives the first a RipSpot and the second a GOTSpot, by through_got.
+
+A RipSpot is used like any other memory spot, but a GOTSpot holds the
+address of its value rather than the value. So, this pass rewrites each use
+of such a value to go through its address: an input is read through the
+address into a new value before the command, and an output is written into
+a new value which is then stored through the address. Only the AddrOf of
+the value, which loads the address from the table, and the base of a
+relative command, which loads it into a register, use the value as is.
+
+Each call of a function by a pointer computed just for it is made a direct
+call, which ASMGen emits through the procedure linkage table if the
+function goes through the global offset table. Jump tables are made to
+hold offsets from the table rather than absolute addresses.
+
+A thread-local object is reached at a fixed offset from the thread pointer
+if the executable defines it, or else through an entry of the table which
+holds that offset, the initial-exec model, as in every shared object. Such
+objects are rewritten the same way, so this pass also runs without -fPIC
+or -fpie when the code uses a thread-local object another module defines.
+
+This runs last, so no other pass sees the new values.
+"""
+
+from collections import Counter
+
+from shivyc.ctypes import PointerCType
+from shivyc.il_cmds.control import Call, JumpTable, TailCall
+from shivyc.il_cmds.value import AddrOf, ReadAt, SetAt, _RelCommand
+from shivyc.il_gen import ILValue
+
+
+def through_got(symbol_table, v, pic):
+    """Return whether the code reaches value `v` through the global offset
+    table.
+
+    A shared object reaches every object and function with external linkage
+    through it, since one of the same name in the program or in a library
+    loaded earlier takes its place. An executable only reaches those it
+    does not define through it.
+
+    A thread-local object is also reached through it wherever its offset
+    from the thread pointer is not known when the executable is linked.
+
+    pic (str) - "pic" for a shared object, "pie" for an executable, or None
+    for an executable which is not position independent
+    """
+    if v in symbol_table.thread_locals:
+        if pic == "pic":
+            return True
+    elif not pic:
+        return False
+    if symbol_table.linkage_type.get(v) != symbol_table.EXTERNAL:
+        return False
+    return pic == "pic" or symbol_table.def_state.get(v) not in (
+        symbol_table.DEFINED, symbol_table.TENTATIVE)
+
+
+def make_position_independent(il_code, symbol_table, func, pic):
+    """Rewrite function `func` for position-independent code."""
+    commands = il_code.commands[func]
+    got_values = {v for command in commands
+                  for v in command.inputs() + command.outputs()
+                  if v and not v.ctype.is_function()
+                  and through_got(symbol_table, v, pic)}
+    if not pic and not got_values:
+        return
+
+    calls = _direct_calls(commands) if pic else {}
+    addrs = set(calls.values())
+    new_commands = []
+    for command in commands:
+        if command in addrs:
+            continue
+        if command in calls:
+            command.direct = calls[command].var
+        if pic and isinstance(command, JumpTable):
+            command.relative = True
+
+        if isinstance(command, AddrOf):
+            uses = []
+        elif isinstance(command, _RelCommand):
+            uses = [v for v in command.inputs() if v != command.base]
+        else:
+            uses = command.inputs()
+
+        reads = {}
+        for v in dict.fromkeys(uses):
+            if v in got_values:
+                addr = ILValue(PointerCType(v.ctype))
+                reads[v] = ILValue(v.ctype)
+                new_commands += [AddrOf(addr, v), ReadAt(reads[v], addr)]
+        command.replace_inputs(reads)
+        new_commands.append(command)
+
+        writes = {v: ILValue(v.ctype) for v in command.outputs()
+                  if v in got_values}
+        command.replace_outputs(writes)
+        for v, new in writes.items():
+            addr = ILValue(PointerCType(v.ctype))
+            new_commands += [AddrOf(addr, v), SetAt(addr, new)]
+
+    il_code.set_commands(func, new_commands)
+
+
+def _direct_calls(commands):
+    """Return a map from each Call of a function pointer computed only for
+    it to the AddrOf of the function computing the pointer.
+    """
+    defs = Counter(v for command in commands for v in command.outputs())
+    uses = Counter(v for command in commands for v in command.inputs())
+    addrs = {command.output: command for command in commands
+             if isinstance(command, AddrOf)
+             and command.var.ctype.is_function()}
+
+    return {command: addrs[command.func] for command in commands
+            if isinstance(command, Call) and not isinstance(command, TailCall)
+            and command.func in addrs and defs[command.func] == 1
+            and uses[command.func] == 1}
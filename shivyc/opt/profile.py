@@ -0,0 +1,186 @@
+"""Profiles of how often each basic block of a function runs.
+
+With -fprofile-generate, each function is instrumented as it is made, before
+any calls are inlined into it, with a counter for each of its basic blocks.
+The counters of a function are in a static array of unsigned longs, with a
+slot before them set once the array is registered with the runtime in
+runtime/profile.c. The runtime appends the counts of each function to the
+profile file when the program exits, on a line with the name of the
+function, the number of counters, and the count of each block in order.
+
+With -fprofile-use, the counts of each run in the profile file are added up
+and given to the blocks of the function, which is made the same way as when
+it was instrumented. Each block is given a label of its own, and the count
+of the block is kept by label in il_code.counts, so the count follows the
+block through the passes which copy it. The blocks of a function which ran
+but which never ran themselves are cold, as if by __builtin_expect.
+"""
+
+import os
+
+import shivyc.ctypes as ctypes
+from shivyc.errors import CompilerError, error_collector
+from shivyc.il_cmds.control import Call, JumpNotZero, Label
+from shivyc.il_cmds.math import Add
+from shivyc.il_cmds.value import AddrOf, LoadArg, ReadRel, SetRel
+from shivyc.il_gen import ILValue
+
+# Name of the runtime function which registers the counters of a function.
+register_name = "__shivyc_profile_add"
+
+# Profile file written and read when no file is named.
+default_file = "shivyc.prof"
+
+
+def profile_name(file, func):
+    """Return the name the profile gives function `func` of a file."""
+    return f"{os.path.normpath(file)}:{func}"
+
+
+def read_profile(path):
+    """Read the profile file at `path`.
+
+    returns - a map from the name of each function to the total count of
+    each of its blocks, or None if the file cannot be read
+    """
+    profile = {}
+    try:
+        with open(path) as file:
+            lines = file.readlines()
+    except OSError:
+        err = f"could not read profile '{path}'"
+        error_collector.add(CompilerError(err, warning=True))
+        return None
+
+    for line in lines:
+        fields = line.split()
+        try:
+            name, size = fields[0], int(fields[1])
+            counts = [int(field) for field in fields[2:]]
+        except (IndexError, ValueError):
+            continue
+        if len(counts) != size:
+            continue
+        old = profile.setdefault(name, [0] * size)
+        if len(old) == size:
+            profile[name] = [a + b for a, b in zip(old, counts)]
+    return profile
+
+
+def _block_starts(il_code, func):
+    """Return where the count of each basic block of `func` is kept.
+
+    That is the first command of each block, except in the entry block,
+    where it is the command after the LoadArg commands.
+
+    returns - a map from the index of each such command to the number of
+    the block, in order
+    """
+    commands = il_code.commands[func]
+    entry = 0
+    while entry < len(commands) and isinstance(commands[entry], LoadArg):
+        entry += 1
+    starts = {entry}
+    starts.update(block.start for block in il_code.cfg(func).blocks
+                  if block.start > entry)
+    return {start: n for n, start in enumerate(sorted(starts))}
+
+
+def instrument(il_code, symbol_table, func, name, path):
+    """Add a counter for each basic block of function `func`.
+
+    name (str) - Name of the function in the profile.
+    path (str) - Path of the profile file the counts are written to.
+    """
+    commands = il_code.commands[func]
+    starts = _block_starts(il_code, func)
+    size = len(starts)
+
+    ulong = ctypes.unsig_longint
+    counters = symbol_table.add_static_object(
+        ctypes.ArrayCType(ulong, size + 1), f"__profile_{func}")
+
+    def literal(val, ctype=ctypes.longint):
+        v = ILValue(ctype)
+        il_code.register_literal_var(v, val)
+        return v
+
+    def string(text):
+        v = ILValue(ctypes.ArrayCType(ctypes.char, len(text) + 1))
+        il_code.register_string_literal(v, list(text.encode()) + [0])
+        return v
+
+    # The counters are registered on the first run of the function, in a
+    # cold block.
+    register_ctype = ctypes.FunctionCType(
+        [ctypes.PointerCType(ulong), ctypes.PointerCType(ctypes.char),
+         ctypes.longint, ctypes.PointerCType(ctypes.char)],
+        ctypes.void, False)
+    register = ILValue(register_ctype)
+    symbol_table.storage[register] = None
+    symbol_table.names[register] = register_name
+
+    registered, func_addr, counters_addr, name_addr, path_addr = (
+        ILValue(ctype) for ctype in [
+            ulong, ctypes.PointerCType(register_ctype),
+            ctypes.PointerCType(ulong), ctypes.PointerCType(ctypes.char),
+            ctypes.PointerCType(ctypes.char)])
+    cold, done = il_code.get_label(), il_code.get_label()
+    il_code.cold_labels.add(cold)
+    registration = [
+        ReadRel(registered, counters), JumpNotZero(registered, done),
+        Label(cold), AddrOf(func_addr, register),
+        AddrOf(counters_addr, counters), AddrOf(name_addr, string(name)),
+        AddrOf(path_addr, string(path)),
+        Call(func_addr, [counters_addr, name_addr, literal(size),
+                         path_addr], None),
+        Label(done)]
+
+    new_commands = []
+    for i, command in enumerate(commands):
+        if i not in starts:
+            new_commands.append(command)
+            continue
+        if not starts[i]:
+            new_commands += registration
+        if command.label_name():
+            new_commands.append(command)
+
+        count, more = ILValue(ulong), ILValue(ulong)
+        offset = 8 * (starts[i] + 1)
+        new_commands += [ReadRel(count, counters, offset),
+                         Add(more, count, literal(1, ulong)),
+                         SetRel(more, counters, offset)]
+        if not command.label_name():
+            new_commands.append(command)
+    il_code.set_commands(func, new_commands)
+
+
+def apply_profile(il_code, func, counts):
+    """Give the basic blocks of function `func` their counts in a profile.
+
+    counts (List[int]) - Count of each block, or None if the function is
+    not in the profile.
+    """
+    if counts is None:
+        return
+    commands = il_code.commands[func]
+    starts = _block_starts(il_code, func)
+    if len(counts) != len(starts):
+        err = f"profile of function '{func}' does not match its code"
+        error_collector.add(CompilerError(err, warning=True))
+        return
+
+    ran = any(counts)
+    new_commands = []
+    for i, command in enumerate(commands):
+        if i in starts:
+            label = command.label_name()
+            if not label or not starts[i]:
+                label = il_code.get_label()
+                new_commands.append(Label(label))
+            il_code.counts[label] = counts[starts[i]]
+            if ran and not counts[starts[i]]:
+                il_code.cold_labels.add(label)
+        new_commands.append(command)
+    il_code.set_commands(func, new_commands)
@@ -0,0 +1,272 @@
+"""Scalar promotion of memory written in loops, over IL code in SSA form.
+
+A loop which accumulates into a global, or into memory through a pointer
+like p->count, reads and writes memory on every iteration. When alias
+analysis shows that nothing else in the loop may access that memory, it is
+promoted to a new value instead: the value is loaded in a preheader,
+operated on in a register by the loop, and stored back on every exit from
+the loop. The new value is then put into SSA form.
+
+Memory through a pointer is only loaded in the preheader if the pointer
+surely points to valid memory whenever the loop is entered: it points into
+a known variable, or the same memory is accessed in the header or before
+the loop, in a block which dominates the header. Memory only read in the
+loop is left to loop-invariant code motion.
+"""
+
+from shivyc.il_cmds.control import Jump, Label, _GeneralJump
+from shivyc.il_cmds.value import Phi, ReadAt, Set, SetAt, _RelCommand
+from shivyc.il_gen import ILValue
+from shivyc.opt.alias import Access, Memory
+from shivyc.opt.licm import loop_entry
+from shivyc.opt.ssa import to_ssa
+
+
+def promote_scalars(il_code, symbol_table, func, strict_aliasing=True):
+    """Promote memory written in the loops of function `func` to values.
+
+    Inner loops are handled first, so memory promoted out of an inner loop
+    may then be promoted out of the loops around it.
+
+    strict_aliasing (bool) - Whether accesses of different types do not
+    alias.
+    """
+    flow = il_code.cfg(func)
+    loops = sorted(flow.loops, key=lambda loop: -loop.depth)
+    headers = [flow.commands[loop.header.start].label_name()
+               for loop in loops]
+
+    for header in headers:
+        flow = il_code.cfg(func)
+        for loop in flow.loops:
+            if flow.commands[loop.header.start].label_name() == header:
+                _promote(il_code, symbol_table, func, flow, loop,
+                         strict_aliasing)
+                break
+
+
+class _Location:
+    """Memory which may be promoted out of a loop.
+
+    var (ILValue) - The variable accessed by name, or None for memory
+    accessed through a pointer.
+    addr (ILValue), offset (int) - The address of memory accessed through a
+    pointer.
+    ctype (CType) - Type of the value in memory.
+    """
+
+    def __init__(self, var, addr, offset, ctype):
+        """Initialize _Location."""
+        self.var = var
+        self.addr = addr
+        self.offset = offset
+        self.ctype = ctype
+
+    def load(self, output):
+        """Return a command which loads this location into `output`."""
+        if self.var:
+            return Set(output, self.var)
+        return ReadAt(output, self.addr, self.offset)
+
+    def store(self, val):
+        """Return a command which stores `val` into this location."""
+        if self.var:
+            return Set(self.var, val)
+        return SetAt(self.addr, val, self.offset)
+
+
+def _promote(il_code, symbol_table, func, flow, loop, strict_aliasing):
+    """Promote the memory written in the given loop to new values."""
+    commands = flow.commands
+    entry = loop_entry(flow, loop)
+    if not entry:
+        return
+    entry_label = commands[entry.start].label_name()
+
+    blocks = [block for block in flow.rpo if loop.contains(block)]
+    exits = _exits(commands, blocks, loop)
+    if exits is None:
+        return
+
+    memory = Memory(il_code, symbol_table, commands, strict_aliasing)
+    locations = (_variables(il_code, symbol_table, memory, blocks)
+                 + _pointees(memory, flow, loop, blocks))
+    if not locations:
+        return
+
+    promoted = {}
+    for location in locations:
+        promoted[location] = ILValue(location.ctype)
+        if location.var in symbol_table.names:
+            symbol_table.names[promoted[location]] = (
+                symbol_table.names[location.var])
+    by_var = {loc.var: promoted[loc] for loc in locations if loc.var}
+    by_addr = {(loc.addr, loc.offset): promoted[loc]
+               for loc in locations if not loc.var}
+
+    def rewrite(command):
+        if isinstance(command, ReadAt):
+            new = by_addr.get((command.addr, command.offset))
+            if new:
+                return Set(command.output, new)
+        elif isinstance(command, SetAt):
+            new = by_addr.get((command.addr, command.offset))
+            if new:
+                return Set(new, command.val)
+        command.replace_inputs(by_var)
+        command.replace_outputs(by_var)
+        return command
+
+    def stores():
+        return [loc.store(promoted[loc]) for loc in locations]
+
+    # Each exit edge is given a block of its own for the stores. The block
+    # is placed between the edge's ends if the edge falls through, or at
+    # the end of the function if it is a jump.
+    block_label = {block.index: commands[block.start].label_name()
+                   for block in flow.blocks}
+    before = {}
+    appended = []
+    for block, succ in exits:
+        label = il_code.get_label()
+        new_block = [Label(label)] + stores()
+        last = commands[block.end - 1]
+        if block_label[succ.index] in last.targets():
+            last.label = label
+            appended += new_block + [Jump(block_label[succ.index])]
+        else:
+            before.setdefault(succ.start, []).extend(new_block)
+
+        for command in commands[succ.start:succ.end]:
+            if isinstance(command, Phi):
+                pred_label = block_label[block.index]
+                command.args[label] = command.args.pop(pred_label)
+
+    in_body = {i for block in blocks for i in range(block.start, block.end)}
+    returns = {block.end - 1 for block in blocks
+               if not block.succs and not commands[block.end - 1].targets()}
+
+    header_range = range(loop.header.start, loop.header.end)
+    preheader = il_code.get_label()
+    new_commands = []
+    for i, command in enumerate(commands):
+        new_commands.extend(before.get(i, []))
+        if i == loop.header.start:
+            new_commands.append(Label(preheader))
+            new_commands.extend(loc.load(promoted[loc]) for loc in locations)
+        if isinstance(command, Phi) and i in header_range:
+            command.args[preheader] = command.args.pop(entry_label)
+        if i in returns:
+            new_commands.extend(stores())
+        new_commands.append(rewrite(command) if i in in_body else command)
+    new_commands += appended
+
+    il_code.set_commands(func, new_commands)
+    to_ssa(il_code, symbol_table, func, set(promoted.values()))
+
+
+def _exits(commands, blocks, loop):
+    """Return the edges from the given loop blocks to blocks outside it.
+
+    Each edge is a pair of blocks. If an edge cannot be given a block of
+    its own, as when it leaves by a jump table, None is returned.
+    """
+    exits = []
+    for block in blocks:
+        last = commands[block.end - 1]
+        outside = [succ for succ in block.succs if not loop.contains(succ)]
+        if not outside:
+            continue
+        # A block whose jump and fall through both reach the same block
+        # has a single successor for two edges.
+        if (len(outside) > 1 or (last.targets() and not isinstance(
+                last, (Jump, _GeneralJump))) or (
+                    len(block.succs) == 1 and last.targets()
+                    and last.falls_through())):
+            return None
+        exits.append((block, outside[0]))
+    return exits
+
+
+def _variables(il_code, symbol_table, memory, blocks):
+    """Return the locations of the static variables to promote.
+
+    These are the scalar variables with static storage written by name in
+    the loop which no command in the loop may access by any other means.
+    """
+    commands = memory.commands
+    storage = symbol_table.storage
+    written = {}
+    excluded = set()
+    indirect = []
+    for block in blocks:
+        for command in commands[block.start:block.end]:
+            written.update(dict.fromkeys(command.outputs()))
+            if isinstance(command, _RelCommand):
+                excluded.add(command.base)
+            indirect += memory.indirect_reads(command)
+            indirect += memory.indirect_writes(command)
+
+    return [_Location(v, None, 0, v.ctype) for v in written
+            if v not in excluded
+            and v.ctype.is_scalar() and v.ctype.size in {1, 2, 4, 8}
+            and storage.get(v, symbol_table.AUTOMATIC)
+            != symbol_table.AUTOMATIC
+            and v not in il_code.literals
+            and v not in il_code.string_literals
+            and not memory.conflict([Access(v, v.ctype)], indirect)]
+
+
+def _pointees(memory, flow, loop, blocks):
+    """Return the locations of the memory through pointers to promote.
+
+    These are accessed in the loop through an address defined outside it,
+    and written at least once. No other command in the loop may access
+    them, and they must be safe to load in the preheader.
+    """
+    commands = memory.commands
+    header = loop.header
+    body = [i for block in blocks for i in range(block.start, block.end)]
+
+    def key(command):
+        if (isinstance(command, (ReadAt, SetAt)) and command.index is None
+              and command.addr in memory.defs
+              and not loop.contains(
+                  flow.block_of(memory.defs[command.addr]))):
+            return command.addr, command.offset
+        return None
+
+    def ctype(command):
+        return (command.output if isinstance(command, ReadAt)
+                else command.val).ctype
+
+    accesses = {}
+    for i in body:
+        k = key(commands[i])
+        if k:
+            accesses.setdefault(k, []).append(i)
+
+    locations = []
+    for (addr, offset), uses in accesses.items():
+        types = {(ctype(commands[i]).size, ctype(commands[i]).is_floating(),
+                  ctype(commands[i]).is_pointer()) for i in uses}
+        if len(types) != 1 or not any(isinstance(commands[i], SetAt)
+                                      for i in uses):
+            continue
+        location = _Location(None, addr, offset, ctype(commands[uses[0]]))
+        access = memory.through(addr, location.ctype)
+
+        if any(memory.conflict([access], memory.reads(commands[i])
+                               + memory.writes(commands[i]))
+               for i in body if i not in uses):
+            continue
+
+        safe = (access.var is not None
+                or any(flow.block_of(i) is header for i in uses)
+                or any(key(command) == (addr, offset)
+                       and flow.dominates(flow.block_of(j), header)
+                       for j, command in enumerate(commands)
+                       if j not in uses))
+        if safe:
+            locations.append(location)
+    return locations
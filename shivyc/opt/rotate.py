@@ -0,0 +1,98 @@
+"""Recognition of rotates written with shifts, over IL code in SSA form.
+
+C has no rotate operator, so a rotate of an unsigned value is written as
+the or of two shifts of it, like
+
+    (x << n) | (x >> (64 - n))
+
+for a 64-bit x, or with literal counts which add up to its width, like
+(x >> 7) | (x << 25) for a 32-bit x. Such an or, or a xor or addition of
+the same shifts, which is equal since the shifted bits do not overlap, is
+replaced with a RotateLeft or RotateRight command, which is one rol or
+ror. The shifts are left for dead code elimination to remove.
+
+For each count from 1 to the width less one, for which the shifts are
+defined, the rotate computes the same value. The count may be converted
+between integral types on the way to either shift, as `n` is above, since
+a conversion to any type but _Bool keeps the low bits the rotate uses.
+"""
+
+from shivyc.il_cmds.math import (Add, BitOr, BitXor, LBitShift, RBitShift,
+                                 RotateLeft, RotateRight, Subtr)
+from shivyc.il_cmds.value import Set
+from shivyc.opt.ssa import ssa_values
+
+
+def recognize_rotates(il_code, symbol_table, func):
+    """Replace the rotates written with shifts in function `func`."""
+    commands = il_code.commands[func]
+
+    # Only values with a single definition are followed to it, so that
+    # both shifts surely shift the same value by counts computed from the
+    # same value.
+    values = ssa_values(il_code, symbol_table, commands)
+    defs = {}
+    for command in commands:
+        for v in command.outputs():
+            if v in values:
+                defs[v] = command
+
+    new_commands = []
+    changed = False
+    for command in commands:
+        if isinstance(command, (BitOr, BitXor, Add)):
+            rotate = _rotate(command, defs)
+            if rotate:
+                command = rotate
+                changed = True
+        new_commands.append(command)
+
+    if changed:
+        il_code.set_commands(func, new_commands)
+
+
+def _rotate(command, defs):
+    """Return the rotate computing the same as `command`, or None."""
+    left = defs.get(command.arg1)
+    right = defs.get(command.arg2)
+    if isinstance(right, LBitShift):
+        left, right = right, left
+    if not (isinstance(left, LBitShift) and isinstance(right, RBitShift)):
+        return None
+
+    x = left.arg1
+    bits = x.ctype.size * 8
+    if (right.arg1 is not x or x not in defs or x.ctype.signed
+          or x.ctype.size not in {4, 8}
+          or command.output.ctype.size != x.ctype.size):
+        return None
+
+    left_count = _count(left.arg2, defs)
+    right_count = _count(right.arg2, defs)
+    if left_count.literal and right_count.literal:
+        if (0 < left_count.literal.val < bits
+              and left_count.literal.val + right_count.literal.val == bits):
+            return RotateLeft(command.output, x, left.arg2)
+    elif _difference(right_count, left_count, bits, defs):
+        return RotateLeft(command.output, x, left.arg2)
+    elif _difference(left_count, right_count, bits, defs):
+        return RotateRight(command.output, x, right.arg2)
+    return None
+
+
+def _count(v, defs):
+    """Return the value a shift count `v` is converted from, if any."""
+    while (isinstance(defs.get(v), Set) and v.ctype.is_integral()
+           and not v.ctype.is_bool() and defs[v].arg.ctype.is_integral()):
+        v = defs[v].arg
+    return v
+
+
+def _difference(v, count, bits, defs):
+    """Return whether `v` is `bits` less `count`, a value with a single
+    definition.
+    """
+    command = defs.get(v)
+    return (isinstance(command, Subtr) and count in defs
+            and command.arg1.literal and command.arg1.literal.val == bits
+            and _count(command.arg2, defs) is count)
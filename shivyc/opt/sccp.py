@@ -0,0 +1,336 @@
+"""Sparse conditional constant propagation over IL code in SSA form.
+
+This is the algorithm of Wegman and Zadeck. Each SSA value starts out
+undetermined and is lowered to a constant, or to varying, as the commands
+defining it are found to be reachable. Only control flow edges which may be
+taken given the values known so far are followed, so a branch on a constant
+condition makes the other side unreachable, and values which are only set
+to different constants there stay constant.
+"""
+
+import shivyc.ctypes as ctypes
+from shivyc.il_cmds.control import (Jump, JumpTable, Label, LabelAddr,
+                                    _GeneralJump, JumpZero)
+from shivyc.il_cmds.value import Phi, Set
+from shivyc.il_gen import FloatLiteral, IntegerLiteral, ILValue
+from shivyc.opt.ssa import ssa_values
+
+# Lattice value of an SSA value which varies at run time. A value which is
+# not yet determined has no entry in the lattice at all.
+VARYING = object()
+
+
+def propagate_constants(il_code, symbol_table, func):
+    """Fold constants and branches in function `func`.
+
+    Every SSA value found to be constant is replaced by a literal, and every
+    value found to always equal another (like x + 0) is replaced by it. The
+    commands defining those values are removed. Conditional jumps on a
+    constant become unconditional jumps or are removed, and unreachable
+    blocks are deleted. Once no computed goto is reachable, the block of a
+    label whose address is taken may be deleted too, but the label is kept
+    at the end of the function, since its address is still taken, by code
+    or by static data.
+
+    An integer constant too large to be an immediate operand must be moved
+    into a register before each use as an operand. So instead, each such
+    input of a command is set into a new value by a Set before it, which
+    value numbering then shares among the uses of the same constant and
+    code motion hoists out of loops.
+    """
+    flow = il_code.cfg(func)
+    commands = flow.commands
+    values = ssa_values(il_code, symbol_table, commands)
+    solver = _Solver(flow, values)
+    solver.solve()
+
+    def fits_literal(val):
+        # Larger literals may not be usable as an immediate operand. A
+        # floating literal is never an immediate operand, but is read from
+        # memory.
+        return (isinstance(val, float)
+                or ctypes.int_min <= val <= ctypes.int_max)
+
+    # Find the replacement for each value which is constant, or which always
+    # equals another value.
+    reached = solver.visited_commands()
+    replace = {}
+
+    # Commands whose output is a constant too large to be an immediate
+    # operand are replaced by a command setting the output to it.
+    set_literal = {}
+    for i, block_visited in enumerate(reached):
+        if not block_visited:
+            continue
+
+        command = commands[i]
+        for v in command.outputs():
+            if v not in values:
+                continue
+
+            val = solver.lattice.get(v, VARYING)
+            if val is not VARYING:
+                literal = ILValue(v.ctype)
+                il_code.register_literal_var(literal, val)
+                if fits_literal(val):
+                    replace[v] = literal
+                else:
+                    set_literal[i] = Set(v, literal)
+
+        outputs = command.outputs()
+        if (len(outputs) == 1 and outputs[0] in values
+              and outputs[0] not in replace and i not in set_literal):
+            same = solver.same_as(i)
+            if same is not None and (same in values or same.literal):
+                replace[outputs[0]] = same
+
+    def resolve(v):
+        while v in replace:
+            v = replace[v]
+        return v
+
+    replace = {v: resolve(v) for v in replace}
+
+    new_commands = []
+    for i, block_visited in enumerate(reached):
+        command = commands[i]
+        if not block_visited:
+            continue
+        if command.outputs() and command.outputs()[0] in replace:
+            continue
+
+        if isinstance(command, Phi):
+            block = flow.block_of(i)
+            command.args = {
+                label: v for label, v in command.args.items()
+                if solver.executable(solver.block_of_label[label], block)}
+
+        if isinstance(command, _GeneralJump):
+            cond = solver.value(command.cond)
+            if cond is not VARYING and cond is not None:
+                if (cond == 0) == isinstance(command, JumpZero):
+                    new_commands.append(Jump(command.label))
+                continue
+
+        if isinstance(command, JumpTable):
+            val = solver.value(command.arg)
+            if val is not VARYING and val is not None:
+                new_commands.append(Jump(command.target(val)))
+                continue
+
+        command = set_literal.get(i, command)
+        command.replace_inputs(replace)
+        if not isinstance(command, (Set, Phi)):
+            wide = {}
+            for v in command.inputs():
+                if (v in il_code.literals and not v.ctype.is_floating()
+                      and not fits_literal(il_code.literals[v])):
+                    wide[v] = ILValue(v.ctype)
+                    new_commands.append(Set(wide[v], v))
+            command.replace_inputs(wide)
+        new_commands.append(command)
+
+    labels = {command.label_name() for command in new_commands}
+    for command in new_commands:
+        if isinstance(command, LabelAddr) and command.label not in labels:
+            labels.add(command.label)
+            new_commands.append(Label(command.label))
+    for command in commands:
+        if (isinstance(command, Label) and command.name
+              and command.label not in labels):
+            labels.add(command.label)
+            new_commands.append(command)
+
+    il_code.set_commands(func, new_commands)
+
+
+class _Solver:
+    """Solver for the constants of one function.
+
+    flow (CFG) - Graph of the function, in SSA form.
+    values (Set[ILValue]) - SSA values of the function.
+    lattice - Dictionary mapping each SSA value to its constant value, or to
+    VARYING. Undetermined values have no entry.
+    block_of_label - Dictionary mapping the label of each block to it.
+    """
+
+    def __init__(self, flow, values):
+        """Initialize solver."""
+        self.flow = flow
+        self.commands = flow.commands
+        self.values = values
+        self.lattice = {}
+
+        self.block_of_label = {}
+        for block in flow.blocks:
+            label = self.commands[block.start].label_name()
+            if label:
+                self.block_of_label[label] = block
+
+        self.uses = {}
+        for i, command in enumerate(self.commands):
+            for v in command.inputs():
+                if v in values:
+                    self.uses.setdefault(v, []).append(i)
+
+        self._edges = set()
+        self._visited = [False] * len(flow.blocks)
+        self._flow_work = []
+        self._value_work = []
+
+    def solve(self):
+        """Find the constant value of every SSA value."""
+        if not self.flow.blocks:
+            return
+
+        self._flow_work.append((None, self.flow.blocks[0]))
+        while self._flow_work or self._value_work:
+            if self._flow_work:
+                pred, block = self._flow_work.pop()
+                edge = (pred.index if pred else None, block.index)
+                if edge in self._edges:
+                    continue
+                self._edges.add(edge)
+
+                if not self._visited[block.index]:
+                    self._visited[block.index] = True
+                    for i in range(block.start, block.end):
+                        self._visit(i)
+                else:
+                    for i in range(block.start, block.end):
+                        if isinstance(self.commands[i], Phi):
+                            self._visit(i)
+            else:
+                v = self._value_work.pop()
+                for i in self.uses.get(v, []):
+                    if self._visited[self.flow.block_of(i).index]:
+                        self._visit(i)
+
+    def visited_commands(self):
+        """Return a list of whether each command was found reachable."""
+        reached = [False] * len(self.commands)
+        for block in self.flow.blocks:
+            if self._visited[block.index]:
+                for i in range(block.start, block.end):
+                    reached[i] = True
+        return reached
+
+    def executable(self, pred, block):
+        """Return whether control may pass from block pred to block."""
+        return (pred.index, block.index) in self._edges
+
+    def value(self, v):
+        """Return the lattice value of v, or None if undetermined."""
+        if v.literal:
+            if (isinstance(v.literal, (IntegerLiteral, FloatLiteral))
+                  and v.ctype.is_scalar()):
+                return ctypes.in_range(v.literal.val, v.ctype)
+            return VARYING
+        elif v in self.values:
+            return self.lattice.get(v)
+        else:
+            return VARYING
+
+    def same_as(self, i):
+        """Return an ILValue which the output of command i always equals."""
+        command = self.commands[i]
+        if isinstance(command, Phi):
+            block = self.flow.block_of(i)
+            args = {v for label, v in command.args.items()
+                    if self.executable(self.block_of_label[label], block)}
+            args.discard(command.output)
+            return args.pop() if len(args) == 1 else None
+        else:
+            return command.simplify(self._known(command))
+
+    def _known(self, command):
+        """Return the known constant inputs of given command."""
+        known = {}
+        for v in command.inputs():
+            val = self.value(v)
+            if val is not None and val is not VARYING:
+                known[v] = val
+        return known
+
+    def _visit(self, i):
+        """Evaluate the command at index i."""
+        command = self.commands[i]
+        block = self.flow.block_of(i)
+
+        if isinstance(command, Phi):
+            new = None
+            for label, v in command.args.items():
+                if self.executable(self.block_of_label[label], block):
+                    new = self._meet(new, self.value(v))
+            self._lower(command.output, new)
+        else:
+            for v in command.outputs():
+                if v in self.values:
+                    self._lower(v, self._evaluate(command))
+
+        if i == block.end - 1:
+            self._branch(command, block)
+
+    def _evaluate(self, command):
+        """Return the lattice value of the output of given command."""
+        val = command.evaluate(self._known(command))
+        if val is not None:
+            return val
+        elif any(self.value(v) is None for v in command.inputs()):
+            return None
+        else:
+            return VARYING
+
+    def _meet(self, a, b):
+        """Return the meet of two lattice values."""
+        if a is None:
+            return b
+        elif b is None or _same(a, b):
+            return a
+        else:
+            return VARYING
+
+    def _lower(self, v, new):
+        """Lower the lattice value of v to `new`."""
+        old = self.lattice.get(v)
+        new = self._meet(old, new)
+        if new is not None and not _same(new, old):
+            self.lattice[v] = new
+            self._value_work.append(v)
+
+    def _branch(self, command, block):
+        """Mark the edges that may be taken out of the given block."""
+        if isinstance(command, _GeneralJump):
+            cond = self.value(command.cond)
+            if cond is None:
+                return
+            elif cond is not VARYING:
+                taken = (cond == 0) == isinstance(command, JumpZero)
+                target = self.block_of_label[command.label]
+                if taken:
+                    self._flow_work.append((block, target))
+                elif block.index + 1 < len(self.flow.blocks):
+                    self._flow_work.append(
+                        (block, self.flow.blocks[block.index + 1]))
+                return
+
+        if isinstance(command, JumpTable):
+            val = self.value(command.arg)
+            if val is None:
+                return
+            elif val is not VARYING:
+                target = self.block_of_label[command.target(val)]
+                self._flow_work.append((block, target))
+                return
+
+        for succ in block.succs:
+            self._flow_work.append((block, succ))
+
+
+def _same(a, b):
+    """Return whether lattice values a and b are the same.
+
+    The floating values 0.0 and -0.0 are equal but not the same, and a NaN
+    is the same as a NaN though not equal to it.
+    """
+    return a is b or (type(a) is type(b) and repr(a) == repr(b))
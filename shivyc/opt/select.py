@@ -0,0 +1,297 @@
+"""Instruction selection over trees of IL commands.
+
+The make_asm of each IL command lowers that command on its own, so a
+pointer computed by one command and used by the next is computed into a
+register and then dereferenced. This pass instead looks at trees of IL
+commands: a command together with the commands computing its inputs, each
+of which is defined only once, used only by the command, and computed
+earlier in the same block from inputs that have not changed since.
+
+Trees of address arithmetic are matched against the addressing mode of
+x86-64, which computes a base register plus an index register times 1, 2,
+4, or 8 plus a 32-bit displacement for free. Every way a tree can be cut
+into an address of that form together with the subtrees left outside it
+is enumerated, and the cover with the lowest cost, according to `costs`,
+is selected. The root of the tree may be
+
+    a load, ReadAt, which becomes one `mov rax, [rbx+rcx*4+16]`,
+    a store, SetAt, which becomes one `mov [rbx+rcx*4+16], rax`, or
+    a pointer addition, which becomes one lea.
+
+This runs after the code is out of SSA form, because the other passes are
+simpler on commands which do only one thing.
+"""
+
+from collections import Counter
+
+from shivyc.il_cmds.math import Add, AddScaled, Mult, Subtr
+from shivyc.il_cmds.value import ReadAt, SetAt
+from shivyc.il_gen import IntegerLiteral
+
+# Cost in instructions of the commands which may be folded into an address,
+# when lowered on their own. A multiply is only folded if it is by 2, 4, or
+# 8, which is a shift.
+costs = {Add: 1, Subtr: 1, Mult: 1, AddScaled: 1}
+
+# Factors an index may be multiplied by in an address.
+factors = {1, 2, 4, 8}
+
+# Trees deeper than this are not searched for covers, so that the number of
+# covers enumerated stays small.
+max_depth = 4
+
+
+class _Address:
+    """An address of the form base + index * factor + offset.
+
+    base (ILValue) - Pointer value the address is relative to.
+    index (ILValue) - 64-bit integral value, or None.
+    factor (int) - Factor the index is multiplied by.
+    offset (int) - Displacement in bytes.
+    folded (List) - Indices of the commands computed by this address.
+    """
+
+    def __init__(self, base, index=None, factor=1, offset=0, folded=()):
+        self.base = base
+        self.index = index
+        self.factor = factor
+        self.offset = offset
+        self.folded = list(folded)
+
+    def fits(self):
+        """Return whether this address can be an x86-64 addressing mode."""
+        return (self.factor in factors
+                and -(1 << 31) <= self.offset < 1 << 31)
+
+
+def select_instructions(il_code, func):
+    """Select instructions for the trees of IL commands in `func`."""
+    commands = il_code.commands[func]
+
+    uses = Counter()
+    defs = Counter()
+    for command in commands:
+        uses.update(command.inputs())
+        defs.update(command.outputs())
+
+    # `trees` maps each value which may be folded into the command using
+    # it to the index of the command computing it.
+    selector = _Selector(list(commands))
+    trees = selector.trees
+    for i, command in enumerate(commands):
+        if command.label_name():
+            trees.clear()
+
+        command = selector.select(i, command)
+
+        for v in command.outputs():
+            for value, j in list(trees.items()):
+                if value is v or v in selector.new[j].inputs():
+                    del trees[value]
+
+        output = command.outputs()[0] if command.outputs() else None
+        if (type(command) in costs and output.ctype.size == 8
+              and uses[output] == 1 and defs[output] == 1):
+            trees[output] = i
+
+        if command.targets() or not command.falls_through():
+            trees.clear()
+
+    if selector.changed:
+        il_code.set_commands(func, [command for command in selector.new
+                                    if command])
+
+
+class _Selector:
+    """State of instruction selection over the commands of a function.
+
+    new - List of the selected commands, with None for a command folded
+    into another.
+    trees - Map from values to the index of the command computing them, as
+    described in select_instructions.
+    """
+
+    def __init__(self, new):
+        self.new = new
+        self.trees = {}
+        self.changed = False
+
+    def select(self, i, command):
+        """Select the command replacing `command`, at index `i`.
+
+        returns - the selected command
+        """
+        if isinstance(command, ReadAt) and not command.index:
+            address = self._best(command.addr, command.offset)
+            if address:
+                command = ReadAt(command.output, address.base,
+                                 address.offset, address.index,
+                                 address.factor)
+        elif isinstance(command, SetAt) and not command.index:
+            address = self._best(command.addr, command.offset)
+            if address:
+                command = SetAt(address.base, command.val, address.offset,
+                                address.index, address.factor)
+        elif (isinstance(command, (Add, Subtr, AddScaled))
+              and command.output.ctype.is_pointer()):
+            address = self._best_lea(i, command)
+            if address:
+                command = AddScaled(command.output, address.base,
+                                    address.index, address.factor,
+                                    address.offset)
+        else:
+            return command
+
+        if command is not self.new[i]:
+            self.new[i] = command
+            self.changed = True
+        return command
+
+    def _best(self, value, offset):
+        """Return the cheapest address folding commands computing `value`.
+
+        Returns None if no address folds any commands.
+        """
+        best = None
+        for address in self._addresses(value, 0):
+            address.offset += offset
+            if (address.folded and address.fits()
+                  and (not best or self._cost(address) > self._cost(best))):
+                best = address
+
+        if best:
+            for j in best.folded:
+                self._fold(j)
+        return best
+
+    def _best_lea(self, i, command):
+        """Return the address which a pointer addition can be a lea of.
+
+        Returns None if the lea would fold no commands other than the
+        addition itself, which is then lowered on its own.
+        """
+        self.trees[command.output] = i
+        best = None
+        for address in self._addresses(command.output, 0):
+            if (len(address.folded) > 1 and address.fits()
+                  and (not best or self._cost(address) > self._cost(best))):
+                best = address
+        del self.trees[command.output]
+
+        if best:
+            for j in best.folded:
+                if j != i:
+                    self._fold(j)
+        return best
+
+    def _cost(self, address):
+        """Return the cost of the commands an address computes."""
+        return sum(costs[type(self.new[j])] for j in address.folded)
+
+    def _fold(self, j):
+        """Remove the command at index `j`, which is folded into another."""
+        del self.trees[self.new[j].output]
+        self.new[j] = None
+
+    def _addresses(self, value, depth):
+        """Yield each address computing the pointer `value`."""
+        yield _Address(value)
+
+        j = self.trees.get(value)
+        if j is None or depth == max_depth:
+            return
+        command = self.new[j]
+
+        if isinstance(command, AddScaled):
+            for base in self._addresses(command.arg1, depth + 1):
+                if base.index:
+                    continue
+                if not command.arg2:
+                    yield _Address(base.base, None, 1,
+                                   base.offset + command.offset,
+                                   base.folded + [j])
+                    continue
+                for index in self._indices(command.arg2, depth + 1):
+                    yield _combine(base, index, command.factor,
+                                   command.offset, j)
+        elif isinstance(command, (Add, Subtr)):
+            pairs = [(command.arg1, command.arg2)]
+            if isinstance(command, Add):
+                pairs.append((command.arg2, command.arg1))
+
+            for pointer, other in pairs:
+                if not pointer.ctype.is_pointer():
+                    continue
+                sign = -1 if isinstance(command, Subtr) else 1
+                for index in self._indices(other, depth + 1):
+                    if sign == -1 and index[0]:
+                        continue
+                    index = (index[0], index[1], sign * index[2], index[3])
+                    for base in self._addresses(pointer, depth + 1):
+                        if not base.index or not index[0]:
+                            yield _combine(base, index, 1, 0, j)
+
+    def _indices(self, value, depth):
+        """Yield each way to compute `value` as an index.
+
+        Each is a tuple of the index value or None, the factor it is
+        multiplied by, an offset added to the product, and the list of the
+        indices of the commands folded.
+        """
+        if isinstance(value.literal, IntegerLiteral):
+            yield None, 1, _signed(value.literal.val), []
+            return
+        yield value, 1, 0, []
+
+        j = self.trees.get(value)
+        if j is None or depth == max_depth:
+            return
+        command = self.new[j]
+
+        if isinstance(command, Mult):
+            for arg, other in [(command.arg1, command.arg2),
+                               (command.arg2, command.arg1)]:
+                if not isinstance(other.literal, IntegerLiteral):
+                    continue
+                factor = _signed(other.literal.val)
+                for index, inner, offset, folded in self._indices(
+                        arg, depth + 1):
+                    if index and inner * factor in factors:
+                        yield (index, inner * factor, offset * factor,
+                               folded + [j])
+        elif isinstance(command, (Add, Subtr)):
+            pairs = [(command.arg1, command.arg2)]
+            if isinstance(command, Add):
+                pairs.append((command.arg2, command.arg1))
+            sign = -1 if isinstance(command, Subtr) else 1
+
+            for arg, other in pairs:
+                if not isinstance(other.literal, IntegerLiteral):
+                    continue
+                for index, factor, offset, folded in self._indices(
+                        arg, depth + 1):
+                    yield (index, factor,
+                           offset + sign * _signed(other.literal.val),
+                           folded + [j])
+
+
+def _combine(base, index, factor, offset, j):
+    """Return the address of base plus index times factor plus offset.
+
+    base - The _Address of the base, which has no index unless `index`
+    has no index value.
+    index - Tuple of an index as yielded by _Selector._indices.
+    j - Index of the command computing the sum.
+    """
+    value, index_factor, index_offset, folded = index
+    offset += base.offset + index_offset * factor
+    folded = base.folded + folded + [j]
+    if not value:
+        return _Address(base.base, base.index, base.factor, offset, folded)
+    return _Address(base.base, value, index_factor * factor, offset, folded)
+
+
+def _signed(val):
+    """Return the value of a 64-bit literal as a signed integer."""
+    val %= 1 << 64
+    return val - (1 << 64) if val >> 63 else val
@@ -0,0 +1,115 @@
+"""Live-range splitting of local variables whose address is taken.
+
+A local variable whose address is taken is kept in memory, in a stack slot
+of its own, because it may be read or written through a pointer. But most
+of its uses are usually by name, like those of a loop counter whose
+address is passed once to a function. So each such scalar variable is
+split in two: a new value, which the register allocator is free to keep in
+a register, takes the place of the variable in every use by name, and the
+variable itself is left as the memory home its address points to.
+
+The home is only brought up to date around the commands which may read or
+write the variable other than by name, as told by alias analysis. Before
+such a command, the value is stored to the home, unless it is not changed
+since the home was last stored or loaded in the block. After a command
+which may write the variable, the value is loaded back from the home.
+
+This runs in SSA form, after the passes which use alias analysis, since
+the new values have more than one definition.
+"""
+
+from shivyc.il_cmds.math import Add, AddScaled, Subtr
+from shivyc.il_cmds.value import AddrOf, Set, _RelCommand
+from shivyc.il_gen import ILValue
+from shivyc.opt.alias import Access, Memory
+
+
+def split_live_ranges(il_code, symbol_table, func, strict_aliasing=True):
+    """Split the live ranges of the address-taken scalars of function `func`.
+
+    strict_aliasing (bool) - Whether accesses of different types do not
+    alias.
+    """
+    flow = il_code.cfg(func)
+    commands = flow.commands
+    memory = Memory(il_code, symbol_table, commands, strict_aliasing)
+
+    split = {}
+    for v in _candidates(il_code, symbol_table, commands):
+        split[v] = ILValue(v.ctype)
+        if v in symbol_table.names:
+            symbol_table.names[split[v]] = symbol_table.names[v]
+    if not split:
+        return
+    homes = {v: Access(v, v.ctype) for v in split}
+
+    new_commands = []
+    for block in flow.blocks:
+        # Variables whose value was changed since its home was last stored
+        # or loaded in this block.
+        dirty = set(split)
+        for command in commands[block.start:block.end]:
+            reads = memory.indirect_reads(command)
+            writes = memory.indirect_writes(command)
+            touched = [v for v in split
+                       if memory.conflict([homes[v]], reads + writes)]
+            written = [v for v in touched
+                       if memory.conflict([homes[v]], writes)]
+
+            for v in touched:
+                if v in dirty:
+                    new_commands.append(Set(v, split[v]))
+                    dirty.discard(v)
+
+            if not isinstance(command, AddrOf):
+                command.replace_inputs(split)
+                command.replace_outputs(split)
+            dirty.update(v for v in split
+                         if split[v] in command.outputs())
+            new_commands.append(command)
+
+            new_commands += [Set(split[v], v) for v in written]
+
+    il_code.set_commands(func, new_commands)
+
+
+def _candidates(il_code, symbol_table, commands):
+    """Return the variables of the function which may be split.
+
+    These are the local scalar variables whose address is taken by an
+    AddrOf, and which are not otherwise referenced or the base of a
+    relative command. A variable is not split either if arithmetic is done
+    on its address, since the result may be used to reach it from a pointer
+    to its neighbour on the stack, which alias analysis does not see, or
+    if it is volatile, since it is then only accessed through its address.
+    """
+    addressed = {}
+    excluded = set()
+    # Map from each value holding the address of a variable to the variable.
+    addresses = {}
+    for command in commands:
+        for values in command.references().values():
+            if isinstance(command, AddrOf):
+                addressed.update(dict.fromkeys(values))
+            else:
+                excluded.update(values)
+        if isinstance(command, _RelCommand):
+            excluded.add(command.base)
+
+        if isinstance(command, AddrOf):
+            addresses[command.output] = command.var
+        elif isinstance(command, Set) and command.arg in addresses:
+            addresses[command.output] = addresses[command.arg]
+        elif isinstance(command, (Add, Subtr, AddScaled)):
+            excluded.update(addresses[v] for v in command.inputs()
+                            if v in addresses)
+
+    storage = symbol_table.storage
+    return [v for v in addressed
+            if v not in excluded
+            and v.ctype.is_scalar() and v.ctype.size in {1, 2, 4, 8}
+            and not v.ctype.is_volatile()
+            and storage.get(v, symbol_table.AUTOMATIC)
+            == symbol_table.AUTOMATIC
+            and v not in il_code.literals
+            and v not in il_code.string_literals]
@@ -0,0 +1,198 @@
+"""Scalar replacement of aggregates.
+
+A local struct is kept in memory, because its members are read and written
+with ReadRel and SetRel commands relative to it. When each member of a
+struct is itself a scalar, or a struct of scalars, and the struct is only
+ever used by commands which read or write whole members of it, or copy it
+whole to or from another object, its members are replaced with an ILValue
+each. Those values are never referenced, so they are renamed into SSA form
+and may be allocated registers like any other scalar variable.
+
+A struct whose address is taken, which is passed to or returned from a
+function, or which is read or written in part of a member or through a
+computed offset, is left in memory.
+"""
+
+from shivyc.ctypes import StructCType
+from shivyc.il_cmds.value import ReadRel, Set, SetRel, ZeroRel
+from shivyc.il_gen import ILValue
+
+
+def replace_aggregates(il_code, symbol_table, func):
+    """Replace the non-escaping local structs of `func` with their members.
+    """
+    commands = il_code.commands[func]
+    candidates = _candidates(il_code, symbol_table, commands)
+    if not candidates:
+        return
+
+    for v, leaves in candidates.items():
+        members = {offset: _new_value(v, ctype, symbol_table)
+                   for offset, ctype in leaves}
+        new_commands = []
+        for command in commands:
+            split = _split(command, v, members, il_code)
+            new_commands.extend([command] if split is None else split)
+        commands = new_commands
+    il_code.set_commands(func, commands)
+
+
+def _candidates(il_code, symbol_table, commands):
+    """Return the local structs which can be replaced with their members.
+
+    returns - dictionary mapping each such ILValue to the list of the
+    (offset, ctype) pairs of its scalar members
+    """
+    structs = {}
+    rejected = set()
+    for command in commands:
+        for v in command.inputs() + command.outputs():
+            if v is None or v in structs or v in rejected:
+                continue
+            leaves = _leaves(v.ctype, 0)
+            if (leaves and symbol_table.storage.get(
+                    v, symbol_table.AUTOMATIC) == symbol_table.AUTOMATIC
+                  and v not in il_code.literals
+                  and v not in il_code.string_literals):
+                structs[v] = leaves
+            else:
+                rejected.add(v)
+
+    escaped = set()
+    for command in commands:
+        allowed = _allowed_uses(command, structs)
+        for v in command.inputs() + command.outputs():
+            if v in structs and v not in allowed:
+                escaped.add(v)
+        for values in command.references().values():
+            escaped.update(v for v in values
+                           if v in structs and v not in allowed)
+
+    return {v: leaves for v, leaves in structs.items() if v not in escaped}
+
+
+def _leaves(ctype, offset):
+    """Return the (offset, ctype) pairs of the scalars of a struct.
+
+    If the struct has a member which is not a scalar or a struct of
+    scalars, returns None.
+    """
+    if (not isinstance(ctype, StructCType) or not ctype.is_complete()
+          or not ctype.members):
+        return None
+
+    leaves = []
+    for member, _ in ctype.members:
+        member_offset, member_ctype = ctype.get_offset(member)
+        if member_ctype.is_scalar():
+            leaves.append((offset + member_offset, member_ctype))
+            continue
+        inner = _leaves(member_ctype, offset + member_offset)
+        if not inner:
+            return None
+        leaves.extend(inner)
+    return leaves
+
+
+def _allowed_uses(command, structs):
+    """Return the structs `command` uses in a way that can be split."""
+    allowed = set()
+    if isinstance(command, ZeroRel):
+        if _covered(structs.get(command.base), command.chunk, command.size):
+            allowed.add(command.base)
+    elif (isinstance(command, (SetRel, ReadRel)) and not command.count
+            and command.base is not command.val):
+        if _fits(structs.get(command.base), command.chunk,
+                 command.val.ctype):
+            allowed.add(command.base)
+        if command.val in structs:
+            allowed.add(command.val)
+    elif isinstance(command, Set):
+        if (command.output is not command.arg
+              and command.output.ctype.weak_compat(command.arg.ctype)):
+            allowed.update(v for v in (command.output, command.arg)
+                           if v in structs)
+    return allowed
+
+
+def _fits(leaves, offset, ctype):
+    """Return whether a value of `ctype` at `offset` is whole members.
+
+    A scalar value must be exactly one scalar member of the same size,
+    which is a _Bool if and only if the value is.
+    """
+    if not leaves:
+        return False
+    if not ctype.is_scalar():
+        return _covered(leaves, offset, ctype.size)
+
+    for leaf_offset, leaf_ctype in leaves:
+        if leaf_offset == offset:
+            return (leaf_ctype.size == ctype.size
+                    and leaf_ctype.is_bool() == ctype.is_bool())
+    return False
+
+
+def _covered(leaves, offset, size):
+    """Return whether the bytes [offset, offset + size) are whole members.
+    """
+    if not leaves:
+        return False
+    end = offset + size
+    for leaf_offset, leaf_ctype in leaves:
+        leaf_end = leaf_offset + leaf_ctype.size
+        if (leaf_offset < end and leaf_end > offset
+              and (leaf_offset < offset or leaf_end > end)):
+            return False
+    return True
+
+
+def _split(command, v, members, il_code):
+    """Return the commands replacing `command`, which uses the struct `v`.
+
+    Returns None if `command` does not use `v`.
+    """
+    def within(offset, size):
+        return [(leaf_offset, value) for leaf_offset, value in members.items()
+                if offset <= leaf_offset < offset + size]
+
+    if isinstance(command, ZeroRel) and command.base is v:
+        new = []
+        for _, value in within(command.chunk, command.size):
+            zero = ILValue(value.ctype)
+            il_code.register_literal_var(zero, 0)
+            new.append(Set(value, zero))
+        return new
+    elif isinstance(command, SetRel) and command.base is v:
+        if command.val.ctype.is_scalar():
+            return [Set(members[command.chunk], command.val)]
+        return [ReadRel(value, command.val, offset - command.chunk)
+                for offset, value in within(command.chunk,
+                                            command.val.ctype.size)]
+    elif isinstance(command, ReadRel) and command.base is v:
+        if command.output.ctype.is_scalar():
+            return [Set(command.output, members[command.chunk])]
+        return [SetRel(value, command.output, offset - command.chunk)
+                for offset, value in within(command.chunk,
+                                            command.output.ctype.size)]
+    elif isinstance(command, SetRel) and command.val is v:
+        return [SetRel(value, command.base, command.chunk + offset)
+                for offset, value in members.items()]
+    elif isinstance(command, ReadRel) and command.output is v:
+        return [ReadRel(value, command.base, command.chunk + offset)
+                for offset, value in members.items()]
+    elif isinstance(command, Set) and command.output is v:
+        return [ReadRel(value, command.arg, offset)
+                for offset, value in members.items()]
+    elif isinstance(command, Set) and command.arg is v:
+        return [SetRel(value, command.output, offset)
+                for offset, value in members.items()]
+    return None
+
+
+def _new_value(v, ctype, symbol_table):
+    """Return a new ILValue for a member of `v`, named after `v`."""
+    new = ILValue(ctype)
+    if v in symbol_table.names:
+        symbol_table.names[new] = symbol_table.names[v]
+    return new
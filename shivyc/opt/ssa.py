@@ -0,0 +1,265 @@
+"""Conversion of the IL code of a function into and out of SSA form.
+
+In SSA form, each renamable ILValue is the output of exactly one command,
+and that command dominates every use of the value. Where several
+definitions of one variable reach a join point, a Phi command at the join
+point selects between them.
+
+An ILValue is renamable if it has automatic storage, fits in a register,
+and is never referenced by a command, so that it cannot be read or written
+through a pointer. Other values are left unchanged.
+"""
+
+from shivyc.il_cmds.control import Jump, Label
+from shivyc.il_cmds.value import Phi, Set
+from shivyc.il_gen import ILValue
+
+
+def to_ssa(il_code, symbol_table, func, values=None):
+    """Put the IL code of function `func` into SSA form.
+
+    Every block is given a label, so that Phi commands can name their
+    predecessors, and the entry block is given no predecessors. Phi
+    commands are placed at the iterated dominance frontier of the
+    definitions of each value that is live across blocks, and then every
+    definition is renamed with a walk over the dominator tree.
+
+    values (Set) - If given, only these values are renamed. Passes which
+    add values with several definitions to code already in SSA form use
+    this to put just those values into SSA form.
+    """
+    _label_blocks(il_code, func)
+    flow = il_code.cfg(func)
+    commands = flow.commands
+    if values is None:
+        values = ssa_values(il_code, symbol_table, commands)
+
+    # Find the blocks defining each value, and the values which may be
+    # used in a block other than the one defining them.
+    def_blocks = {}
+    nonlocal_values = set()
+    for block in flow.rpo:
+        defined = set()
+        for command in commands[block.start:block.end]:
+            for v in command.inputs():
+                if v in values and v not in defined:
+                    nonlocal_values.add(v)
+            for v in command.outputs():
+                if v in values:
+                    defined.add(v)
+                    def_blocks.setdefault(v, []).append(block)
+
+    # Place Phi commands.
+    frontiers = flow.dominance_frontiers()
+    phis = [[] for _ in flow.blocks]
+    for v in def_blocks:
+        if v not in nonlocal_values:
+            continue
+
+        has_phi = set()
+        worklist = def_blocks[v][:]
+        while worklist:
+            block = worklist.pop()
+            for front in frontiers[block.index]:
+                if front.index not in has_phi:
+                    has_phi.add(front.index)
+                    phis[front.index].append(Phi(v, {}))
+                    worklist.append(front)
+
+    _rename(flow, values, phis, symbol_table)
+
+    new_commands = []
+    for block in flow.blocks:
+        new_commands.append(commands[block.start])
+        new_commands.extend(phis[block.index])
+        new_commands.extend(commands[block.start + 1:block.end])
+    il_code.set_commands(func, new_commands)
+
+
+def from_ssa(il_code, symbol_table, func):
+    """Take the IL code of function `func` out of SSA form.
+
+    Each Phi command `x = phi(a, b)` is replaced by a copy `x = t` from a
+    new value t, and copies `t = a` and `t = b` are added at the end of the
+    predecessor blocks. Because t is used only by the Phi, these copies can
+    never overwrite a value another path needs, so no edges must be split
+    and copies for several Phi commands never need to be ordered. The
+    register allocator coalesces away most of the copies.
+
+    Finally, labels which are not the target of any jump are removed, as
+    are jumps to the label immediately after them. This is only safe once
+    the Phi commands are gone, because removing a jump can change which
+    block is the predecessor of its target. The labels in
+    il_code.kept_labels are kept for the block layout, which removes those
+    of cold blocks, for the code generator, which weighs blocks by their
+    counts, and for the commands which take their address.
+    """
+    flow = il_code.cfg(func)
+    commands = flow.commands
+
+    block_of_label = {}
+    for block in flow.blocks:
+        label = commands[block.start].label_name()
+        if label:
+            block_of_label[label] = block
+
+    replaced = {}
+    inserts = {}
+    for i, command in enumerate(commands):
+        if not isinstance(command, Phi):
+            continue
+
+        temp = _new_value(command.output, symbol_table)
+        replaced[i] = Set(command.output, temp)
+        for label, v in command.args.items():
+            pred = block_of_label[label]
+            last = commands[pred.end - 1]
+            if last.targets() or not last.falls_through():
+                pos = pred.end - 1
+            else:
+                pos = pred.end
+            inserts.setdefault(pos, []).append(Set(temp, v))
+
+    targets = il_code.kept_labels()
+    for command in commands:
+        targets.update(command.targets())
+
+    new_commands = []
+    for i, command in enumerate(commands + [None]):
+        new_commands.extend(inserts.get(i, []))
+        if command is None:
+            break
+        label = command.label_name()
+        if label and label not in targets:
+            continue
+        new_commands.append(replaced.get(i, command))
+    il_code.set_commands(func, _remove_jumps_to_next(new_commands))
+
+
+def _remove_jumps_to_next(commands):
+    """Remove unconditional jumps to a label which immediately follows.
+
+    Folding branches often leaves such a jump to the block after it.
+    """
+    new_commands = []
+    for i, command in enumerate(commands):
+        if isinstance(command, Jump):
+            following = set()
+            j = i + 1
+            while j < len(commands) and commands[j].label_name():
+                following.add(commands[j].label_name())
+                j += 1
+            if command.label in following:
+                continue
+        new_commands.append(command)
+    return new_commands
+
+
+def _label_blocks(il_code, func):
+    """Start every block of function `func` with a label.
+
+    If the entry block may be jumped to, a new entry block is added before
+    it, so the entry block has no predecessors.
+    """
+    flow = il_code.cfg(func)
+    commands = flow.commands
+
+    new_commands = []
+    if flow.blocks and flow.blocks[0].preds:
+        new_commands.append(Label(il_code.get_label()))
+
+    starts = {block.start for block in flow.blocks}
+    for i, command in enumerate(commands):
+        if i in starts and not command.label_name():
+            new_commands.append(Label(il_code.get_label()))
+        new_commands.append(command)
+
+    if len(new_commands) != len(commands):
+        il_code.set_commands(func, new_commands)
+
+
+def ssa_values(il_code, symbol_table, commands):
+    """Return the set of ILValues in `commands` which can be renamed.
+
+    Once the commands are in SSA form, these are exactly the values with a
+    single definition that dominates all their uses.
+    """
+    storage = symbol_table.storage
+
+    referenced = set()
+    values = set()
+    for command in commands:
+        for ref_values in command.references().values():
+            referenced.update(ref_values)
+        for v in command.outputs():
+            if (v.ctype.size in {1, 2, 4, 8}
+                  and storage.get(v, symbol_table.AUTOMATIC)
+                    == symbol_table.AUTOMATIC
+                  and v not in il_code.literals
+                  and v not in il_code.string_literals):
+                values.add(v)
+
+    return values - referenced
+
+
+def _new_value(v, symbol_table):
+    """Return a new ILValue of the same type, and name, as `v`."""
+    new = ILValue(v.ctype)
+    if v in symbol_table.names:
+        symbol_table.names[new] = symbol_table.names[v]
+    return new
+
+
+def _rename(flow, values, phis, symbol_table):
+    """Rename every definition of the given values.
+
+    Blocks are visited in a depth-first walk of the dominator tree. On entry
+    to a block, the latest definition of each value is on top of its stack,
+    so every use is replaced by the definition which dominates it. A use
+    with no dominating definition keeps the original ILValue, which stands
+    for the value being undefined.
+    """
+    commands = flow.commands
+    stacks = {v: [] for v in values}
+    phi_vars = {phi: phi.output for block_phis in phis for phi in block_phis}
+
+    def current(v):
+        return stacks[v][-1] if stacks[v] else v
+
+    def define(v, pushed):
+        new = _new_value(v, symbol_table)
+        stacks[v].append(new)
+        pushed.append(v)
+        return new
+
+    if not flow.rpo:
+        return
+
+    # Each entry is a block to visit, or a list of the values whose stacks
+    # to pop once all blocks dominated by a block have been visited.
+    walk = [flow.rpo[0]]
+    while walk:
+        block = walk.pop()
+        if isinstance(block, list):
+            for v in block:
+                stacks[v].pop()
+            continue
+
+        pushed = []
+        for phi in phis[block.index]:
+            phi.output = define(phi.output, pushed)
+
+        for command in commands[block.start:block.end]:
+            command.replace_inputs(
+                {v: current(v) for v in command.inputs() if v in values})
+            command.replace_outputs(
+                {v: define(v, pushed) for v in command.outputs()
+                 if v in values})
+
+        label = commands[block.start].label_name()
+        for succ in block.succs:
+            for phi in phis[succ.index]:
+                phi.args[label] = current(phi_vars[phi])
+
+        walk.append(pushed)
+        walk.extend(reversed(flow.dom_children[block.index]))
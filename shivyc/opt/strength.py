@@ -0,0 +1,286 @@
+"""Strength reduction of induction variables over IL code in SSA form.
+
+A basic induction variable is a Phi command in a loop header which is
+increased by a constant on each trip around the loop, like `i` in
+
+    for(i = 0; i < n; i++) s += p[i];
+
+A derived induction variable is a linear function of a basic one, like the
+address `p + 4 * (long)i` computed for `p[i]`. Instead of recomputing such
+an address with a multiply on every iteration, the address is given its own
+Phi command. It is computed once before the loop and increased by its own
+constant, here 4, wherever the basic induction variable is increased.
+
+Only derived variables whose computation includes a multiply are reduced.
+Other addresses, like `array + 8 * i` for an array in memory, are already
+just as cheap with scaled-index addressing, like [rbp-80+rax*8].
+"""
+
+from copy import copy
+
+import shivyc.ctypes as ctypes
+from shivyc.il_cmds.math import Add, Mult, Subtr
+from shivyc.il_cmds.value import AddrRel, Phi, Set
+from shivyc.il_gen import ILValue
+from shivyc.opt.ssa import ssa_values
+
+
+def reduce_strength(il_code, symbol_table, func):
+    """Reduce the derived induction variables in loops of function `func`.
+
+    Inner loops are handled first. Commands computing a reduced variable
+    are left for dead code elimination to remove.
+    """
+    flow = il_code.cfg(func)
+    loops = sorted(flow.loops, key=lambda loop: -loop.depth)
+    headers = [flow.commands[loop.header.start].label_name()
+               for loop in loops]
+
+    for header in headers:
+        flow = il_code.cfg(func)
+        for loop in flow.loops:
+            if flow.commands[loop.header.start].label_name() == header:
+                _reduce(il_code, symbol_table, func, flow, loop)
+                break
+
+
+class _Derived:
+    """A linear function of a basic induction variable.
+
+    The value is `scale` times the basic variable `basic`, plus a loop
+    invariant value.
+
+    basic (ILValue) - Output of the Phi command of the basic variable.
+    scale (int) - Factor by which the value changes with `basic`.
+    chain (List[int]) - Indices of the commands which compute this value
+    from `basic`, in order.
+    costly (bool) - Whether the chain includes a multiply.
+    """
+
+    def __init__(self, basic, scale, chain, costly):
+        """Initialize _Derived."""
+        self.basic = basic
+        self.scale = scale
+        self.chain = chain
+        self.costly = costly
+
+
+def _reduce(il_code, symbol_table, func, flow, loop):
+    """Reduce the derived induction variables of the given loop."""
+    commands = flow.commands
+    header = loop.header
+
+    entries = [pred for pred in header.preds if not loop.contains(pred)]
+    if len(entries) != 1 or len(loop.latches) != 1:
+        return
+    entry, latch = entries[0], loop.latches[0]
+    entry_label = commands[entry.start].label_name()
+    latch_label = commands[latch.start].label_name()
+    if not entry_label or not latch_label:
+        return
+
+    values = ssa_values(il_code, symbol_table, commands)
+    defs = {}
+    for i, command in enumerate(commands):
+        for v in command.outputs():
+            if v in values:
+                defs[v] = i
+
+    def invariant(v):
+        if v.literal:
+            return True
+        return v in defs and not loop.contains(flow.block_of(defs[v]))
+
+    # Find the basic induction variables, and the step of each.
+    steps = {}
+    increments = {}
+    for i in range(header.start, header.end):
+        phi = commands[i]
+        if (not isinstance(phi, Phi) or set(phi.args)
+              != {entry_label, latch_label}):
+            continue
+
+        step = _step(commands, defs, phi.output, phi.args[latch_label])
+        if step is not None:
+            steps[phi.output] = step
+            increments[phi.output] = defs[phi.args[latch_label]]
+
+    if not steps:
+        return
+
+    # Find the derived induction variables, visiting definitions before
+    # their uses.
+    derived = {v: _Derived(v, 1, [], False) for v in steps}
+    for block in flow.rpo:
+        if not loop.contains(block):
+            continue
+        for i in range(block.start, block.end):
+            found = _derive(commands[i], derived, invariant)
+            if found and commands[i].outputs()[0] in values:
+                basic, scale, source, costly = found
+                derived[commands[i].outputs()[0]] = _Derived(
+                    basic, scale, derived[source].chain + [i],
+                    costly or derived[source].costly)
+
+    # Commands which compute a derived variable using a multiply.
+    costly_defs = {derived[v].chain[-1] for v in derived
+                   if v not in steps and _is_costly(commands, derived, v)}
+
+    reduce = []
+    for v, info in derived.items():
+        if not info.costly or defs[v] not in costly_defs:
+            continue
+
+        # A value used only to compute another costly value is not reduced
+        # itself, since that value is reduced instead.
+        uses = [i for i, command in enumerate(commands)
+                if v in command.inputs()]
+        if any(i not in costly_defs for i in uses):
+            reduce.append(v)
+
+    before = {}
+    after = {}
+    phis = []
+    replace = {}
+    for v in reduce:
+        info = derived[v]
+        step_val = info.scale * steps[info.basic]
+        if not ctypes.int_min <= step_val <= ctypes.int_max:
+            continue
+
+        # Compute the initial value by copying the chain of commands, with
+        # the initial value of the basic variable.
+        basic_phi = commands[defs[info.basic]]
+        mapping = {info.basic: basic_phi.args[entry_label]}
+        init_cmds = []
+        for i in info.chain:
+            output = commands[i].outputs()[0]
+            mapping[output] = ILValue(output.ctype)
+            init_cmds.append(_clone(commands[i], mapping))
+
+        last = commands[entry.end - 1]
+        if last.targets() or not last.falls_through():
+            pos = entry.end - 1
+        else:
+            pos = entry.end
+        before.setdefault(pos, []).extend(init_cmds)
+
+        step = ILValue(ctypes.longint if v.ctype.is_pointer() else v.ctype)
+        il_code.register_literal_var(step, step_val)
+
+        current = ILValue(v.ctype)
+        following = ILValue(v.ctype)
+        phis.append(Phi(current, {entry_label: mapping[v],
+                                  latch_label: following}))
+        after.setdefault(increments[info.basic], []).append(
+            Add(following, current, step))
+        replace[v] = current
+
+    if not phis:
+        return
+
+    new_commands = []
+    for i, command in enumerate(commands):
+        new_commands.extend(before.get(i, []))
+        new_commands.append(command)
+        if i == header.start:
+            new_commands.extend(phis)
+        new_commands.extend(after.get(i, []))
+    new_commands.extend(before.get(len(commands), []))
+
+    for command in new_commands:
+        command.replace_inputs(replace)
+    il_code.set_commands(func, new_commands)
+
+
+def _clone(command, mapping):
+    """Return a copy of given command with its values renamed."""
+    new = copy(command)
+    new.replace_inputs(mapping)
+    new.replace_outputs(mapping)
+    return new
+
+
+def _step(commands, defs, basic, following):
+    """Return the constant added to `basic` to get `following`, if any."""
+    if following not in defs:
+        return None
+    command = commands[defs[following]]
+    if not isinstance(command, (Add, Subtr)):
+        return None
+    if not command.output.ctype.is_integral():
+        return None
+
+    if command.arg1 is basic and command.arg2.literal:
+        step = command.arg2.literal.val
+    elif (isinstance(command, Add) and command.arg2 is basic
+          and command.arg1.literal):
+        step = command.arg1.literal.val
+    else:
+        return None
+
+    return -step if isinstance(command, Subtr) else step
+
+
+def _derive(command, derived, invariant):
+    """Return how the output of given command derives from a basic variable.
+
+    returns - a tuple of the basic variable, the scale, the derived input,
+    and whether the command is a multiply, or None
+    """
+    if isinstance(command, Set):
+        source = command.arg
+        if source not in derived or command.output.ctype.is_bool():
+            return None
+
+        # Widening an unsigned value is not linear if the value wraps.
+        out_size = command.output.ctype.size
+        in_size = source.ctype.size
+        if out_size < in_size or (
+                out_size > in_size
+                and not getattr(source.ctype, "signed", False)):
+            return None
+        return derived[source].basic, derived[source].scale, source, False
+
+    elif isinstance(command, Mult):
+        for source, other in [(command.arg1, command.arg2),
+                              (command.arg2, command.arg1)]:
+            if source in derived and other.literal:
+                scale = derived[source].scale * other.literal.val
+                return derived[source].basic, scale, source, True
+
+    elif isinstance(command, (Add, Subtr)):
+        for source, other in [(command.arg1, command.arg2),
+                              (command.arg2, command.arg1)]:
+            if source in derived and invariant(other):
+                scale = derived[source].scale
+                if isinstance(command, Subtr):
+                    if source is command.arg2:
+                        scale = -scale
+                    elif command.output.ctype.is_pointer() != \
+                            source.ctype.is_pointer():
+                        return None
+                return derived[source].basic, scale, source, False
+
+    elif isinstance(command, AddrRel):
+        source = command.count
+        if source in derived:
+            scale = derived[source].scale * command.chunk
+            return derived[source].basic, scale, source, False
+
+    return None
+
+
+def _is_costly(commands, derived, v):
+    """Return whether the command defining `v` may not be cheap to keep.
+
+    This is a multiply, or an address computed from a multiply whose only
+    cheap form would be as part of an addressing mode.
+    """
+    command = commands[derived[v].chain[-1]]
+    if isinstance(command, (Mult, AddrRel)):
+        return True
+    if isinstance(command, Add) and command.output.ctype.is_pointer():
+        # Adding a constant to an address is cheap.
+        return not (command.arg1.literal or command.arg2.literal)
+    return False
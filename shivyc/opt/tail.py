@@ -0,0 +1,132 @@
+"""Tail call elimination over IL code.
+
+A call is in tail position if the function returns the value of the call,
+or returns no value, right after it. A call of the function itself in tail
+position becomes a jump back to the start of the function, after the
+arguments are copied into the parameters. Any other call in tail position
+becomes a TailCall, which tears down the frame of the function and jumps to
+the callee, so the callee returns straight to the caller. This is only done
+if the arguments and return value of the call are all passed in registers.
+
+Neither is done in a function which takes the address of a local variable,
+because the callee may be given a pointer into the frame being reused or
+torn down.
+"""
+
+import shivyc.abi as abi
+from shivyc.il_cmds.control import Call, Jump, Label, Return, TailCall
+from shivyc.il_cmds.value import LoadArg, Set
+from shivyc.il_gen import ILValue
+from shivyc.opt.inline import call_targets, function_values
+
+
+def eliminate_tail_calls(il_code, symbol_table, func):
+    """Eliminate the calls in tail position in function `func`."""
+    commands = il_code.commands[func]
+    if _frame_escapes(il_code, symbol_table, commands):
+        return
+
+    targets = call_targets(commands, function_values(il_code, symbol_table))
+    params = {command.arg_num: command.output for command in commands
+              if isinstance(command, LoadArg)}
+    labels = {command.label_name(): i for i, command in enumerate(commands)
+              if command.label_name()}
+
+    # Label at the start of the function body, after the parameters are
+    # loaded, for self-recursive calls to jump to.
+    start = None
+
+    new_commands = []
+    skip = False
+    for i, command in enumerate(commands):
+        if skip:
+            skip = False
+            continue
+        if not isinstance(command, Call) or not _is_tail(commands, i, labels):
+            new_commands.append(command)
+            continue
+
+        self_call = (targets.get(command) == func
+                     and not command.func.ctype.arg.no_info
+                     and len(command.args) == len(params))
+        if not self_call and not _in_registers(command):
+            new_commands.append(command)
+            continue
+
+        # A return right after the call can no longer be reached.
+        skip = isinstance(commands[i + 1], Return)
+
+        if self_call:
+            start = start or il_code.get_label()
+
+            # The arguments may be computed from the parameters, so they are
+            # all copied out before any parameter is changed.
+            temps = [ILValue(arg.ctype) for arg in command.args]
+            for temp, arg in zip(temps, command.args):
+                new_commands.append(Set(temp, arg))
+            for n, temp in enumerate(temps):
+                new_commands.append(Set(params[n], temp))
+            new_commands.append(Jump(start))
+        else:
+            new_commands.append(TailCall(command.func, command.args))
+
+    if start:
+        body = len(params)
+        new_commands[body:body] = [Label(start)]
+    if new_commands != commands:
+        il_code.set_commands(func, new_commands)
+
+
+def _is_tail(commands, i, labels):
+    """Return whether the call at index `i` of `commands` is a tail call."""
+    call = commands[i]
+
+    # Value holding the result of the call, which may be copied on the way
+    # to the return, like after the call is inlined.
+    result = None if call.void_return else call.ret
+
+    followed = set()
+    i += 1
+    while i < len(commands):
+        command = commands[i]
+        if command.label_name():
+            i += 1
+        elif isinstance(command, Jump) and command.label not in followed:
+            followed.add(command.label)
+            i = labels[command.label]
+        elif (isinstance(command, Set) and result
+              and command.arg is result
+              and command.output.ctype.compatible(result.ctype)):
+            result = command.output
+            i += 1
+        elif isinstance(command, Return):
+            return command.arg is None or command.arg is result
+        else:
+            return False
+    return False
+
+
+def _in_registers(call):
+    """Return whether a call passes everything in registers.
+
+    An argument passed on the stack, or a return value stored through RDI,
+    needs the frame of the calling function.
+    """
+    _, stack_size = call.locations()
+    return not stack_size and not abi.in_memory(call.func.ctype.arg.ret)
+
+
+def _frame_escapes(il_code, symbol_table, commands):
+    """Return whether a pointer to a local variable may be computed.
+
+    A string literal is not in the frame, though it has no storage class.
+    """
+    storage = symbol_table.storage
+    for command in commands:
+        for pointer, values in command.references().items():
+            if pointer and any(
+                    storage.get(v, symbol_table.AUTOMATIC)
+                    == symbol_table.AUTOMATIC
+                    and v not in il_code.string_literals for v in values):
+                return True
+    return False
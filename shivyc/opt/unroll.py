@@ -0,0 +1,251 @@
+"""Unrolling of counted loops over IL code in SSA form.
+
+A counted loop, as described in counted.py, pays for a compare and a jump
+on every trip. A loop whose index runs between two integer literals over
+only a few trips is unrolled fully: it is replaced by a copy of its body
+for each trip, with no compare or jump left at all.
+
+Any other counted loop is unrolled by a factor N. A new loop, put before
+the original one, runs N copies of the body on each of its trips, for as
+long as N iterations are left before the limit. The original loop then
+runs the iterations left over, fewer than N of them. In the copies, the
+index of copy k is computed as the index of the trip plus k, so the new
+loop has a basic induction variable increased by N for strength reduction.
+
+Both keep the unrolled code within a budget of IL commands. A copy of the
+body keeps the values not in SSA form as they are, and gives every SSA
+value and label defined in it a new one of its own.
+"""
+
+from copy import copy
+
+import shivyc.ctypes as ctypes
+from shivyc.il_cmds.compare import GreaterOrEqCmp, LessCmp
+from shivyc.il_cmds.control import (IndirectJump, Jump, JumpZero, Label,
+                                    LabelAddr)
+from shivyc.il_cmds.math import Add, Subtr
+from shivyc.il_cmds.value import Phi, Set
+from shivyc.il_gen import ILValue, IntegerLiteral
+from shivyc.opt.counted import counted_loop
+
+# Most IL commands the copies of the body of a loop may add up to.
+budget = 96
+
+# Most trips of a loop which is unrolled fully.
+full_trips = 16
+
+
+def unroll_loops(il_code, symbol_table, func, factor):
+    """Unroll the counted loops of function `func`.
+
+    factor (int) - Most copies of the body of a loop to run on each trip of
+    a partially unrolled loop.
+    returns - whether any loop was unrolled
+    """
+    flow = il_code.cfg(func)
+    headers = [flow.commands[loop.header.start].label_name()
+               for loop in flow.loops]
+
+    unrolled = False
+    for header in headers:
+        flow = il_code.cfg(func)
+        for loop in flow.loops:
+            if flow.commands[loop.header.start].label_name() == header:
+                unrolled |= _unroll(il_code, symbol_table, func, flow, loop,
+                                    factor)
+                break
+    return unrolled
+
+
+def _unroll(il_code, symbol_table, func, flow, loop, factor):
+    """Unroll the given loop, if it is a counted loop which can be.
+
+    returns - whether the loop was unrolled
+    """
+    counted = counted_loop(il_code, symbol_table, flow, loop)
+    if not counted:
+        return False
+    commands = flow.commands
+    body = commands[counted.body.start:counted.body.stop]
+
+    # Phi commands of a body block may not select by arrival from the
+    # header, since the copies after the first are not entered from there.
+    labels = {command.label_name() for command in body}
+    if any(isinstance(command, Phi) and not set(command.args) <= labels
+           for command in body):
+        return False
+
+    # The labels of the copies are not ones a computed goto may jump to,
+    # nor may a label whose address is held by static data be copied.
+    if any(isinstance(command, (LabelAddr, IndirectJump))
+           or isinstance(command, Label) and command.name
+           for command in body):
+        return False
+
+    size = sum(1 for command in body[:-1] if not command.label_name())
+    init = counted.init(counted.phis[0])
+    limit = counted.limit
+    if (isinstance(init.literal, IntegerLiteral)
+          and isinstance(limit.literal, IntegerLiteral)):
+        trips = limit.literal.val - init.literal.val
+        if 0 < trips <= full_trips and trips * size <= budget:
+            _unroll_fully(il_code, symbol_table, func, counted, trips)
+            return True
+
+    copies = min(factor, budget // max(size, 1))
+    if copies < 2:
+        return False
+    _unroll_partly(il_code, symbol_table, func, counted, copies)
+    return True
+
+
+def _unroll_fully(il_code, symbol_table, func, counted, trips):
+    """Replace a loop with a copy of its body for each of its trips."""
+    commands = counted.flow.commands
+    header = counted.loop.header
+    current = {phi.output: counted.init(phi) for phi in counted.phis}
+
+    new = []
+    for _ in range(trips):
+        copied, current = _copy_body(il_code, symbol_table, counted,
+                                     current)
+        new += copied[:-1]
+
+    # The exit block may select by arrival from the header, so the code
+    # leaves through a block with the label of the header.
+    new.append(Label(counted.header_label))
+    new += [Set(phi.output, current[phi.output]) for phi in counted.phis]
+    new.append(Jump(counted.exit_label))
+
+    il_code.set_commands(func, commands[:header.start] + new
+                         + commands[counted.body.stop:])
+
+
+def _unroll_partly(il_code, symbol_table, func, counted, copies):
+    """Put a loop running `copies` copies of the body on each trip before a
+    loop, which is left to run the iterations left over.
+    """
+    commands = counted.flow.commands
+    header = counted.loop.header
+    limit = counted.limit
+    ctype = limit.ctype
+
+    def literal(val):
+        v = ILValue(ctype)
+        il_code.register_literal_var(v, val)
+        return v
+
+    start, ready, head, done = (il_code.get_label() for _ in range(4))
+    new = [Label(start)]
+
+    # The limit less copies - 1 must not overflow. The guard is left out
+    # when the limit is a literal high enough.
+    lowest = 0
+    if ctype.signed:
+        lowest = -(1 << (ctype.size * 8 - 1))
+    guarded = (not isinstance(limit.literal, IntegerLiteral)
+               or limit.literal.val < lowest + copies - 1)
+    if guarded:
+        enough = ILValue(ctypes.integer)
+        new += [GreaterOrEqCmp(enough, limit, literal(lowest + copies - 1)),
+                JumpZero(enough, done)]
+
+    stop = ILValue(ctype)
+    new += [Label(ready), Subtr(stop, limit, literal(copies - 1)),
+            Label(head)]
+
+    trip = {phi.output: _new_value(phi.output, symbol_table)
+            for phi in counted.phis}
+    index = trip[counted.index]
+    current = dict(trip)
+    copied = []
+    for k in range(copies):
+        body, current = _copy_body(il_code, symbol_table, counted, current,
+                                   (index, k + 1))
+        copied += body if k == copies - 1 else body[:-1]
+    tail = copied[-1]
+    tail.label = head
+    tail_label = [command.label_name() for command in copied
+                  if command.label_name()][-1]
+
+    more = ILValue(ctypes.integer)
+    new += [Phi(trip[phi.output], {ready: counted.init(phi),
+                                   tail_label: current[phi.output]})
+            for phi in counted.phis]
+    new += [LessCmp(more, index, stop), JumpZero(more, done)]
+    new += copied
+    new.append(Label(done))
+
+    # The original loop starts from where the new one stopped, or from the
+    # start if the new one was skipped.
+    for phi in counted.phis:
+        resume = _new_value(phi.output, symbol_table)
+        args = {head: trip[phi.output]}
+        if guarded:
+            args[start] = counted.init(phi)
+        new.append(Phi(resume, args))
+        del phi.args[counted.entry_label]
+        phi.args[done] = resume
+
+    il_code.set_commands(
+        func, commands[:header.start] + new + commands[header.start:])
+
+
+def _copy_body(il_code, symbol_table, counted, current, offset=None):
+    """Return a copy of the body of a counted loop.
+
+    current (Dict) - Map from the output of each Phi command of the header
+    to the value it has in the copy.
+    offset - A pair of the index of a partially unrolled loop and the
+    amount the copy sets the next index to that index plus, or None to
+    copy the increment of the index as it is.
+    returns - the copy, which ends with the jump of the latch back to the
+    header, and the map from the output of each Phi command of the header
+    to the value it has next
+    """
+    commands = counted.flow.commands
+    body = [commands[i] for i in counted.body]
+
+    mapping = dict(current)
+    labels = {}
+    for command in body:
+        for v in command.outputs():
+            if v in counted.values:
+                mapping[v] = _new_value(v, symbol_table)
+        label = command.label_name()
+        if label:
+            labels[label] = il_code.copy_label(label)
+
+    copied = []
+    for i in counted.body:
+        command = commands[i]
+        if i == counted.increment and offset:
+            index, amount = offset
+            step = ILValue(index.ctype)
+            il_code.register_literal_var(step, amount)
+            copied.append(Add(mapping[command.output], index, step))
+            continue
+
+        new = copy(command)
+        new.replace_inputs(mapping)
+        new.replace_outputs(mapping)
+        if isinstance(new, Phi):
+            new.args = {labels[label]: v for label, v in new.args.items()}
+        if hasattr(new, "label"):
+            new.label = labels.get(new.label, new.label)
+        if hasattr(new, "labels"):
+            new.labels = [labels.get(label, label) for label in new.labels]
+        copied.append(new)
+
+    following = {phi.output: mapping.get(counted.next(phi),
+                                         counted.next(phi))
+                 for phi in counted.phis}
+    return copied, following
+
+
+def _new_value(v, symbol_table):
+    """Return a new ILValue for a copy of `v`, named after `v`."""
+    new = ILValue(v.ctype)
+    if v in symbol_table.names:
+        symbol_table.names[new] = symbol_table.names[v]
+    return new
@@ -0,0 +1,398 @@
+"""Vectorization of counted loops over IL code in SSA form.
+
+A counted loop, as described in counted.py, like
+
+    for(i = 0; i < n; i++) a[i] = b[i] + c[i] * k;
+
+runs while a basic induction variable `i`, increased by one on each trip,
+is less than a loop invariant `n`. When its body only loads
+and stores elements of width w at p + w * i for loop invariant pointers p,
+and computes only sums, differences, and products of them and of loop
+invariant integers, each lane computed modulo 2**(8*w), the body can be run
+for several values of `i` at once in vector registers. A vector loop running
+VectorBody commands is put before the loop, which then runs the iterations
+left over, fewer than one vector of them.
+
+The vector loop only runs if no two pointers of the loop, at least one of
+which is stored through, are so close that lanes of different iterations
+overlap. Otherwise the order of the loads and stores would differ from that
+of the original loop. These checks are done at run time, just before the
+vector loop, except between pointers based on different restrict-qualified
+parameters, which C promises do not overlap this way.
+
+A NontemporalStore in the body becomes a store of whole vectors around the
+cache, which must be aligned to the size of a vector. The vector loop then
+also only runs if the first vector stored through each such pointer is.
+"""
+
+import shivyc.ctypes as ctypes
+from shivyc.il_cmds.compare import GreaterOrEqCmp, LessCmp
+from shivyc.il_cmds.control import Jump, JumpNotZero, JumpZero, Label
+from shivyc.il_cmds.math import Add, BitAnd, Mult, Subtr
+from shivyc.il_cmds.stream import NontemporalStore
+from shivyc.il_cmds.value import Phi, ReadAt, Set, SetAt
+from shivyc.il_cmds.vector import (VectorBody, VectorSplat, supported,
+                                   vector_regs)
+from shivyc.il_gen import ILValue, IntegerLiteral
+from shivyc.opt.alias import restrict_base
+from shivyc.opt.counted import counted_loop
+
+# Operation of each IL command which may be done on lanes.
+lane_ops = {Add: "add", Subtr: "sub", Mult: "mul"}
+
+# Kinds of the steps of a VectorBody which store lanes.
+store_steps = {"store", "stream"}
+
+# Type of the lanes of the vectors set by a VectorSplat, for each width.
+lane_ctypes = {1: ctypes.char, 2: ctypes.short, 4: ctypes.integer,
+               8: ctypes.longint}
+
+
+def vectorize_loops(il_code, symbol_table, func, size):
+    """Vectorize the counted loops of function `func`.
+
+    size (int) - Size of the vectors in bytes, 16 for SSE2 or 32 for AVX2.
+    """
+    flow = il_code.cfg(func)
+    headers = [flow.commands[loop.header.start].label_name()
+               for loop in flow.loops]
+
+    for header in headers:
+        flow = il_code.cfg(func)
+        for loop in flow.loops:
+            if flow.commands[loop.header.start].label_name() == header:
+                _vectorize(il_code, symbol_table, func, flow, loop, size)
+                break
+
+
+class _Body:
+    """The steps of a VectorBody for the body of a loop.
+
+    index - The basic induction variable of the loop.
+    width (int) - Width in bytes of the elements loaded and stored, or None
+    until one is found.
+    steps (List) - Steps of the VectorBody, as described there, with loop
+    invariant operands as the values themselves.
+    count (int) - Number of vectors computed by the steps.
+    vectors (Dict) - Map from each value computed on lanes to the number of
+    its vector.
+    indices (Set) - Values equal to the induction variable as a 64-bit
+    integer.
+    offsets (Dict) - Map from values equal to the induction variable times
+    a width to that width.
+    addresses (Dict) - Map from values equal to a loop invariant pointer
+    plus an offset to the pointer and the width.
+    """
+
+    def __init__(self, index, size, invariant):
+        """Initialize _Body."""
+        self.index = index
+        self.size = size
+        self.invariant = invariant
+        self.width = None
+        self.steps = []
+        self.count = 0
+        self.vectors = {}
+        self.indices = {index} if index.ctype.size == 8 else set()
+        self.offsets = {}
+        self.addresses = {}
+
+    def add(self, command):
+        """Add the steps of an IL command of the loop body.
+
+        returns - whether the command can be run on lanes
+        """
+        if isinstance(command, Set):
+            return self._add_set(command)
+        elif isinstance(command, Mult) and self._add_offset(command):
+            return True
+        elif (isinstance(command, Add)
+              and command.output.ctype.is_pointer()):
+            return self._add_address(command)
+        elif isinstance(command, ReadAt):
+            return self._add_load(command)
+        elif isinstance(command, (SetAt, NontemporalStore)):
+            return self._add_store(command)
+        elif type(command) in lane_ops:
+            return self._add_op(command)
+        return False
+
+    def _add_set(self, command):
+        """Add a conversion, if it is of the index or of a lane value."""
+        output, arg = command.output, command.arg
+        if not _lane_type(output.ctype):
+            return False
+        if arg is self.index and output.ctype.size == 8:
+            self.indices.add(output)
+            return True
+        if (arg in self.vectors and self.width
+              and output.ctype.size >= self.width):
+            self.vectors[output] = self.vectors[arg]
+            return True
+        return False
+
+    def _add_offset(self, command):
+        """Add a multiply of the 64-bit index by a width."""
+        for arg, other in [(command.arg1, command.arg2),
+                           (command.arg2, command.arg1)]:
+            if (arg in self.indices
+                  and isinstance(other.literal, IntegerLiteral)
+                  and other.literal.val in {1, 2, 4, 8}):
+                self.offsets[command.output] = other.literal.val
+                return True
+        return False
+
+    def _add_address(self, command):
+        """Add a pointer plus the index times the width of its elements."""
+        for pointer, other in [(command.arg1, command.arg2),
+                               (command.arg2, command.arg1)]:
+            if not pointer.ctype.is_pointer() or not self.invariant(pointer):
+                continue
+            width = 1 if other in self.indices else self.offsets.get(other)
+            if width == pointer.ctype.arg.size:
+                self.addresses[command.output] = (pointer, width)
+                return True
+        return False
+
+    def _lanes(self, addr, ctype):
+        """Return the pointer of the lanes at `addr`, of elements of ctype.
+
+        Returns None if the address is not of an element of the width of
+        the other elements of the loop.
+        """
+        if addr not in self.addresses or not _lane_type(ctype):
+            return None
+        pointer, width = self.addresses[addr]
+        if ctype.size != width or (self.width and width != self.width):
+            return None
+        self.width = width
+        return pointer
+
+    def _add_load(self, command):
+        """Add a load of the lanes at an address."""
+        if command.offset or command.index:
+            return False
+        pointer = self._lanes(command.addr, command.output.ctype)
+        if not pointer:
+            return False
+        self.vectors[command.output] = self._new_vector()
+        self.steps.append(("load", self.vectors[command.output], pointer))
+        return True
+
+    def _add_store(self, command):
+        """Add a store of lanes to an address."""
+        kind = "stream"
+        if isinstance(command, SetAt):
+            kind = "store"
+            if command.offset or command.index:
+                return False
+        pointer = self._lanes(command.addr, command.val.ctype)
+        operand = self._operand(command.val)
+        if not pointer or operand is None:
+            return False
+        self.steps.append((kind, pointer, operand))
+        return True
+
+    def _add_op(self, command):
+        """Add an operation on lanes."""
+        output = command.output
+        a = self._operand(command.arg1)
+        b = self._operand(command.arg2)
+        if (a is None or b is None or not self.width
+              or not _lane_type(output.ctype)
+              or output.ctype.size < self.width
+              or not (isinstance(a, int) or isinstance(b, int))):
+            return False
+
+        op = lane_ops[type(command)]
+        if (op, self.width) not in supported[self.size]:
+            return False
+        self.vectors[output] = self._new_vector()
+        self.steps.append((op, self.vectors[output], a, b))
+        return True
+
+    def _operand(self, v):
+        """Return the operand of a step for `v`, or None if there is none.
+
+        A loop invariant operand is returned as the value itself, and made
+        into a splat before the loop.
+        """
+        if v in self.vectors:
+            return self.vectors[v]
+        if (self.invariant(v) and v.ctype.is_integral()
+              and self.width and v.ctype.size >= self.width):
+            return v
+        return None
+
+    def _new_vector(self):
+        """Return the number of a new vector."""
+        self.count += 1
+        return self.count - 1
+
+
+def _lane_type(ctype):
+    """Return whether values of given type may be kept in lanes."""
+    return ctype.is_integral() and not ctype.is_bool()
+
+
+def _vectorize(il_code, symbol_table, func, flow, loop, size):
+    """Vectorize the given loop, if it is a counted loop which can be."""
+    counted = counted_loop(il_code, symbol_table, flow, loop)
+    if not counted or len(counted.phis) != 1:
+        return
+    commands = flow.commands
+    phi = counted.phis[0]
+    values = counted.values
+
+    body = _Body(counted.index, size, counted.invariant)
+    used = set()
+    for i in counted.body:
+        command = commands[i]
+        used.update(command.inputs())
+        if (i in {counted.increment, counted.body[-1]}
+              or command.label_name()):
+            continue
+        if (command.targets() or not body.add(command)
+              or any(v not in values for v in command.outputs())):
+            return
+
+    # The next value of the index may only be used by the Phi. Every other
+    # command of the body was checked by _Body.add.
+    if (not body.width or counted.next(phi) in used
+          or not any(s[0] in store_steps for s in body.steps)
+          or body.count > len(vector_regs)):
+        return
+    lanes = size // body.width
+    limit = counted.limit
+    if (isinstance(limit.literal, IntegerLiteral)
+          and limit.literal.val < lanes):
+        return
+
+    def base(v):
+        return restrict_base(v, commands, counted.defs)
+
+    new, done, start = _vector_loop(il_code, body, counted.init(phi),
+                                    limit, lanes, base)
+    del phi.args[counted.entry_label]
+    phi.args[done] = start
+    header = counted.loop.header
+    il_code.set_commands(
+        func, commands[:header.start] + new + commands[header.start:])
+
+
+def _vector_loop(il_code, body, init, limit, lanes, base):
+    """Return the commands of the vector loop of a counted loop.
+
+    The vector loop runs from `init` for as long as a whole vector of
+    iterations is left before `limit`, and falls through to the original
+    loop for the rest of the iterations.
+
+    base (Function) - Returns the restrict-qualified parameter a pointer is
+    based on, as by restrict_base, or None.
+
+    returns - the commands, the label of the block they end with, and the
+    value the induction variable of the original loop starts from
+    """
+    index_ctype = body.index.ctype
+    long_ctype = ctypes.longint
+    if index_ctype.size == 8 and not index_ctype.signed:
+        long_ctype = ctypes.unsig_longint
+
+    def literal(val, ctype=long_ctype):
+        v = ILValue(ctype)
+        il_code.register_literal_var(v, val)
+        return v
+
+    start, ready, head, loop, done = (il_code.get_label()
+                                      for _ in range(5))
+    begin, end = ILValue(long_ctype), ILValue(long_ctype)
+    enough = ILValue(ctypes.integer)
+    commands = [Label(start), Set(begin, init), Set(end, limit),
+                GreaterOrEqCmp(enough, end, literal(lanes - 1)),
+                JumpZero(enough, done)]
+
+    # The lanes through pointers p and q overlap if q - p is within a
+    # vector of zero, but not zero, unless they are based on different
+    # restrict-qualified parameters.
+    pointers, stored, streamed = [], set(), []
+    for step in body.steps:
+        pointer = step[2] if step[0] == "load" else step[1]
+        if step[0] in store_steps:
+            stored.add(pointer)
+        if step[0] == "stream" and pointer not in streamed:
+            streamed.append(pointer)
+        if ((step[0] == "load" or step[0] in store_steps)
+              and pointer not in pointers):
+            pointers.append(pointer)
+
+    span = lanes * body.width
+    skips = [start]
+
+    # The first vector stored through p around the cache is at
+    # p + begin * width, which must be aligned to the span of a vector.
+    for p in streamed:
+        label = il_code.get_label()
+        skips.append(label)
+        p_long, index, offset, first, low = (ILValue(ctypes.unsig_longint)
+                                             for _ in range(5))
+        commands += [
+            Label(label), Set(p_long, p), Set(index, begin),
+            Mult(offset, index, literal(body.width, ctypes.unsig_longint)),
+            Add(first, p_long, offset),
+            BitAnd(low, first, literal(span - 1, ctypes.unsig_longint)),
+            JumpNotZero(low, done)]
+
+    for i, p in enumerate(pointers):
+        for q in pointers[i + 1:]:
+            if p not in stored and q not in stored:
+                continue
+            if base(p) and base(q) and base(p) is not base(q):
+                continue
+            label = il_code.get_label()
+            skips.append(label)
+            p_long, q_long, diff, shifted = (ILValue(ctypes.unsig_longint)
+                                             for _ in range(4))
+            apart = ILValue(ctypes.integer)
+            commands += [
+                Label(label), Set(p_long, p), Set(q_long, q),
+                Subtr(diff, q_long, p_long),
+                Add(shifted, diff, literal(span - 1, ctypes.unsig_longint)),
+                GreaterOrEqCmp(apart, shifted,
+                               literal(2 * span - 1, ctypes.unsig_longint)),
+                JumpZero(apart, done)]
+
+    stop = ILValue(long_ctype)
+    commands += [Label(ready), Subtr(stop, end, literal(lanes - 1))]
+
+    splats = {}
+
+    def splat(v):
+        if isinstance(v, int):
+            return v
+        if v not in splats:
+            splats[v] = ILValue(ctypes.ArrayCType(lane_ctypes[body.width],
+                                                lanes))
+            commands.append(VectorSplat(splats[v], v, body.width))
+        return splats[v]
+
+    steps = []
+    for step in body.steps:
+        if step[0] == "load":
+            steps.append(step)
+        elif step[0] in store_steps:
+            steps.append(step[:2] + (splat(step[2]),))
+        else:
+            steps.append(step[:2] + (splat(step[2]), splat(step[3])))
+
+    index, next_index = ILValue(long_ctype), ILValue(long_ctype)
+    more = ILValue(ctypes.integer)
+    resume, resumed = ILValue(long_ctype), ILValue(index_ctype)
+    commands += [
+        Label(head), Phi(index, {ready: begin, loop: next_index}),
+        LessCmp(more, index, stop), JumpZero(more, done),
+        Label(loop), VectorBody(steps, index, body.width, body.size),
+        Add(next_index, index, literal(lanes)), Jump(head),
+        Label(done),
+        Phi(resume, {head: index, **{label: begin for label in skips}}),
+        Set(resumed, resume)]
+    return commands, done, resumed
@@ -15,8 +15,12 @@ import shivyc.token_kinds as token_kinds
 import shivyc.tree.decl_nodes as decl_nodes
 import shivyc.tree.nodes as nodes
 from shivyc.parser.expression import parse_expression
-from shivyc.parser.utils import (add_range, ParserError, match_token, token_is,
-                                 raise_error, log_error, token_in)
+from shivyc.parser.utils import (add_range, memoize, ParserError, match_token,
+                                 token_is, raise_error, log_error, token_in)
+
+# Token kinds of the type qualifiers.
+_type_quals = {token_kinds.const_kw, token_kinds.volatile_kw,
+               token_kinds.restrict_kw}
 
 
 @add_range
@@ -48,6 +52,7 @@ def parse_declaration(index):
     return nodes.Declaration(node), index
 
 
+@memoize
 @add_range
 def parse_declarator(index, is_typedef=False):
     """Parse the tokens that comprise a declarator.
@@ -123,10 +128,8 @@ def parse_decls_inits(index, parse_inits=True):
         decls.append(node)
 
         if token_is(index, token_kinds.equals) and parse_inits:
-            # Parse initializer expression
-            from shivyc.parser.expression import parse_assignment
-            expr, index = parse_assignment(index + 1)
-            inits.append(expr)
+            init, index = parse_initializer(index + 1)
+            inits.append(init)
         else:
             inits.append(None)
 
@@ -142,6 +145,34 @@ def parse_decls_inits(index, parse_inits=True):
     return node, index
 
 
+@add_range
+def parse_initializer(index):
+    """Parse an initializer, which may be a braced list of initializers.
+
+    Ex:
+       3
+       {1, {2, 3}, "four",}
+    """
+    if not token_is(index, token_kinds.open_brack):
+        from shivyc.parser.expression import parse_assignment
+        return parse_assignment(index)
+
+    index += 1
+    items = []
+    while not token_is(index, token_kinds.close_brack):
+        item, index = parse_initializer(index)
+        items.append(item)
+
+        # Expect a comma, which may also follow the last initializer
+        if not token_is(index, token_kinds.comma):
+            break
+        index += 1
+
+    index = match_token(index, token_kinds.close_brack, ParserError.GOT)
+    return decl_nodes.InitList(items), index
+
+
+@memoize
 def parse_decl_specifiers(index, _spec_qual=False):
     """Parse a declaration specifier list.
 
@@ -160,10 +191,13 @@ def parse_decl_specifiers(index, _spec_qual=False):
     type_specs = set(ctypes.simple_types.keys())
     type_specs |= {token_kinds.signed_kw, token_kinds.unsigned_kw}
 
-    type_quals = {token_kinds.const_kw}
+    type_quals = _type_quals
 
     storage_specs = {token_kinds.auto_kw, token_kinds.static_kw,
-                     token_kinds.extern_kw, token_kinds.typedef_kw}
+                     token_kinds.extern_kw, token_kinds.typedef_kw,
+                     token_kinds.thread_local_kw, token_kinds.thread_kw}
+
+    func_specs = {token_kinds.inline_kw}
 
     specs = []
 
@@ -218,6 +252,14 @@ def parse_decl_specifiers(index, _spec_qual=False):
                 error_collector.add(CompilerError(err, p.tokens[index].r))
             index += 1
 
+        elif token_in(index, func_specs):
+            if not _spec_qual:
+                specs.append(p.tokens[index])
+            else:
+                err = "function specifier not permitted here"
+                error_collector.add(CompilerError(err, p.tokens[index].r))
+            index += 1
+
         else:
             break
 
@@ -311,19 +353,9 @@ def _find_pair_forward(index,
     close - token kind representing the close parenthesis
     mess - message for error on mismatch
     """
-    depth = 0
-    for i in range(index, len(p.tokens)):
-        if p.tokens[i].kind == open:
-            depth += 1
-        elif p.tokens[i].kind == close:
-            depth -= 1
-
-        if depth == 0:
-            break
-    else:
-        # if loop did not break, no close paren was found
+    if index not in p.pairs:
         raise_error(mess, index, ParserError.AT)
-    return i
+    return p.pairs[index]
 
 
 def _find_pair_backward(index,
@@ -334,19 +366,9 @@ def _find_pair_backward(index,
 
     Same parameters as _find_pair_forward above.
     """
-    depth = 0
-    for i in range(index, -1, -1):
-        if p.tokens[i].kind == close:
-            depth += 1
-        elif p.tokens[i].kind == open:
-            depth -= 1
-
-        if depth == 0:
-            break
-    else:
-        # if loop did not break, no open paren was found
+    if index not in p.pairs:
         raise_error(mess, index, ParserError.AT)
-    return i
+    return p.pairs[index]
 
 
 def _find_decl_end(index):
@@ -358,7 +380,7 @@ def _find_decl_end(index):
     """
     if (token_is(index, token_kinds.star) or
          token_is(index, token_kinds.identifier) or
-         token_is(index, token_kinds.const_kw)):
+         token_in(index, _type_quals)):
         return _find_decl_end(index + 1)
     elif token_is(index, token_kinds.open_paren):
         close = _find_pair_forward(index)
@@ -381,12 +403,12 @@ def _parse_declarator(start, end, is_typedef):
     Prefer to use the parse_declarator function externally over this function.
     """
     decl = _parse_declarator_raw(start, end, is_typedef)
-    decl.r = p.tokens[start].r + p.tokens[end - 1].r
+    decl.start_token, decl.end_token = p.tokens[start], p.tokens[end - 1]
     return decl
 
 
 def _parse_declarator_raw(start, end, is_typedef):
-    """Like _parse_declarator, but doesn't add `.r` range attribute."""
+    """Like _parse_declarator, but doesn't set the range of the node."""
 
     if start == end:
         return decl_nodes.Identifier(None)
@@ -397,9 +419,9 @@ def _parse_declarator_raw(start, end, is_typedef):
         return decl_nodes.Identifier(p.tokens[start])
 
     elif p.tokens[start].kind == token_kinds.star:
-        const, index = _find_const(start + 1)
+        quals, index = _find_quals(start + 1)
         return decl_nodes.Pointer(
-            _parse_declarator(index, end, is_typedef), const)
+            _parse_declarator(index, end, is_typedef), quals)
 
     func_decl = _try_parse_func_decl(start, end, is_typedef)
     if func_decl: return func_decl
@@ -448,18 +470,18 @@ def _try_parse_func_decl(start, end, is_typedef=False):
     return None
 
 
-def _find_const(index):
-    """Check for a continuous sequence of `const`.
+def _find_quals(index):
+    """Find a continuous sequence of type qualifiers, like `const restrict`.
 
-    Returns a tuple containing a boolean for whether any such `const`
-    sequence exists and the first index that is not a `const`. If no
-    `const` is found, returns the index passed in for the second argument.
+    Returns a tuple containing the set of the token kinds of the qualifiers
+    and the first index that is not a qualifier. If no qualifier is found,
+    returns an empty set and the index passed in.
     """
-    has_const = False
-    while token_is(index, token_kinds.const_kw):
+    quals = set()
+    while token_in(index, _type_quals):
+        quals.add(p.tokens[index].kind)
         index += 1
-        has_const = True
-    return has_const, index
+    return quals, index
 
 
 def _parse_struct_union_spec(index, node_type):
@@ -468,10 +490,14 @@ def _parse_struct_union_spec(index, node_type):
     A struct/union specifier includes everything between the `struct`
     keyword to the end of the member list if one exists.
 
+    Attributes may follow the keyword or the member list, like
+
+        struct __attribute__((packed)) S { ... }
+
     index - index right past the type definition keyword.
     node_type - either decl_nodes.Struct or decl_nodes.Union.
     """
-    start_r = p.tokens[index - 1].r
+    attributes, index = parse_attributes(index)
 
     name = None
     if token_is(index, token_kinds.identifier):
@@ -481,10 +507,38 @@ def _parse_struct_union_spec(index, node_type):
     members = None
     if token_is(index, token_kinds.open_brack):
         members, index = parse_struct_union_members(index + 1)
+        more, index = parse_attributes(index)
+        attributes += more
 
     if name is None and members is None:
         err = "expected identifier or member list"
         raise_error(err, index, ParserError.AFTER)
 
-    r = start_r + p.tokens[index - 1].r
-    return node_type(name, members, r), index
+    return node_type(name, members, attributes), index
+
+
+def parse_attributes(index):
+    """Parse any GNU attribute specifiers, like `__attribute__((packed))`.
+
+    The arguments of an attribute, if any, are skipped.
+
+    returns - the list of the identifier tokens naming the attributes, and
+    the index past the last specifier
+    """
+    attributes = []
+    while token_is(index, token_kinds.attribute_kw):
+        index = match_token(index + 1, token_kinds.open_paren,
+                            ParserError.AFTER)
+        index = match_token(index, token_kinds.open_paren, ParserError.AFTER)
+        while not token_is(index, token_kinds.close_paren):
+            match_token(index, token_kinds.identifier, ParserError.AT)
+            attributes.append(p.tokens[index])
+            index += 1
+            if token_is(index, token_kinds.open_paren):
+                index = _find_pair_forward(index) + 1
+            if not token_is(index, token_kinds.comma):
+                break
+            index += 1
+        index = match_token(index, token_kinds.close_paren, ParserError.AT)
+        index = match_token(index, token_kinds.close_paren, ParserError.AT)
+    return attributes, index
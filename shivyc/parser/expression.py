@@ -40,7 +40,10 @@ def parse_assignment(index):
                   token_kinds.minusequals: expr_nodes.MinusEquals,
                   token_kinds.starequals: expr_nodes.StarEquals,
                   token_kinds.divequals: expr_nodes.DivEquals,
-                  token_kinds.modequals: expr_nodes.ModEquals}
+                  token_kinds.modequals: expr_nodes.ModEquals,
+                  token_kinds.ampequals: expr_nodes.AmpEquals,
+                  token_kinds.pipeequals: expr_nodes.PipeEquals,
+                  token_kinds.caretequals: expr_nodes.CaretEquals}
 
     if kind in node_types:
         right, index = parse_assignment(index + 1)
@@ -49,141 +52,170 @@ def parse_assignment(index):
         return left, index
 
 
-@add_range
 def parse_conditional(index):
     """Parse a conditional expression."""
-    # TODO: Parse ternary operator
-    return parse_logical_or(index)
-
-
-@add_range
-def parse_logical_or(index):
-    """Parse logical or expression."""
-    return parse_series(
-        index, parse_logical_and,
-        {token_kinds.bool_or: expr_nodes.BoolOr})
-
-
-@add_range
-def parse_logical_and(index):
-    """Parse logical and expression."""
-    # TODO: Implement bitwise operators here.
-    return parse_series(
-        index, parse_equality,
-        {token_kinds.bool_and: expr_nodes.BoolAnd})
-
-
-@add_range
-def parse_equality(index):
-    """Parse equality expression."""
-    # TODO: Implement relational and shift expressions here.
-    return parse_series(
-        index, parse_relational,
-        {token_kinds.twoequals: expr_nodes.Equality,
-         token_kinds.notequal: expr_nodes.Inequality})
-
-
-@add_range
-def parse_relational(index):
-    """Parse relational expression."""
-    return parse_series(
-        index, parse_bitwise,
-        {token_kinds.lt: expr_nodes.LessThan,
-         token_kinds.gt: expr_nodes.GreaterThan,
-         token_kinds.ltoe: expr_nodes.LessThanOrEq,
-         token_kinds.gtoe: expr_nodes.GreaterThanOrEq})
-
-
-@add_range
-def parse_bitwise(index):
-    return parse_series(
-        index, parse_additive,
-        {token_kinds.lbitshift: expr_nodes.LBitShift,
-         token_kinds.rbitshift: expr_nodes.RBitShift})
-
+    start = index
+    cond, index = parse_binary(index)
+    if not token_is(index, token_kinds.question):
+        return cond, index
+
+    op = p.tokens[index]
+    true_expr, index = parse_expression(index + 1)
+    index = match_token(index, token_kinds.colon, ParserError.AFTER)
+    false_expr, index = parse_conditional(index)
+
+    node = expr_nodes.Conditional(cond, true_expr, false_expr, op)
+    p.set_range(node, start, index)
+    return node, index
+
+
+# Map from each binary operator to its precedence and the node it produces.
+# Operators of higher precedence bind more tightly, and all of them are
+# left-associative.
+binary_ops = {token_kinds.bool_or: (1, expr_nodes.BoolOr),
+              token_kinds.bool_and: (2, expr_nodes.BoolAnd),
+              token_kinds.pipe: (3, expr_nodes.BitOr),
+              token_kinds.caret: (4, expr_nodes.BitXor),
+              token_kinds.amp: (5, expr_nodes.BitAnd),
+              token_kinds.twoequals: (6, expr_nodes.Equality),
+              token_kinds.notequal: (6, expr_nodes.Inequality),
+              token_kinds.lt: (7, expr_nodes.LessThan),
+              token_kinds.gt: (7, expr_nodes.GreaterThan),
+              token_kinds.ltoe: (7, expr_nodes.LessThanOrEq),
+              token_kinds.gtoe: (7, expr_nodes.GreaterThanOrEq),
+              token_kinds.lbitshift: (8, expr_nodes.LBitShift),
+              token_kinds.rbitshift: (8, expr_nodes.RBitShift),
+              token_kinds.plus: (9, expr_nodes.Plus),
+              token_kinds.minus: (9, expr_nodes.Minus),
+              token_kinds.star: (10, expr_nodes.Mult),
+              token_kinds.slash: (10, expr_nodes.Div),
+              token_kinds.mod: (10, expr_nodes.Mod)}
+
+
+def parse_binary(index, min_prec=1):
+    """Parse a binary expression of operators with at least min_prec.
+
+    This is a precedence climbing parser. Rather than descend through one
+    function per precedence level for every operand, it parses a cast
+    expression and then recurses only for the right operand of each
+    operator found, with the precedence that operand's operators must
+    exceed. Each node is given its range as it is made.
+    """
+    start = index
+    cur, index = parse_cast(index)
 
-@add_range
-def parse_additive(index):
-    """Parse additive expression."""
-    return parse_series(
-        index, parse_multiplicative,
-        {token_kinds.plus: expr_nodes.Plus,
-         token_kinds.minus: expr_nodes.Minus})
+    while index < len(p.tokens):
+        op = p.tokens[index]
+        prec, node_type = binary_ops.get(op.kind, (0, None))
+        if prec < min_prec:
+            break
 
+        right, index = parse_binary(index + 1, prec + 1)
+        cur = node_type(cur, right, op)
+        p.set_range(cur, start, index)
 
-@add_range
-def parse_multiplicative(index):
-    """Parse multiplicative expression."""
-    return parse_series(
-        index, parse_cast,
-        {token_kinds.star: expr_nodes.Mult,
-         token_kinds.slash: expr_nodes.Div,
-         token_kinds.mod: expr_nodes.Mod})
+    return cur, index
 
 
-@add_range
 def parse_cast(index):
     """Parse cast expression."""
 
     from shivyc.parser.declaration import (
         parse_abstract_declarator, parse_spec_qual_list)
 
+    if not token_is(index, token_kinds.open_paren):
+        return parse_unary(index)
+
     with log_error():
-        match_token(index, token_kinds.open_paren, ParserError.AT)
+        start = index
         specs, index = parse_spec_qual_list(index + 1)
         node, index = parse_abstract_declarator(index)
         match_token(index, token_kinds.close_paren, ParserError.AT)
 
         decl_node = decl_nodes.Root(specs, [node])
         expr_node, index = parse_cast(index + 1)
-        return expr_nodes.Cast(decl_node, expr_node), index
+        cast = expr_nodes.Cast(decl_node, expr_node)
+        p.set_range(cast, start, index)
+        return cast, index
 
     return parse_unary(index)
 
 
-@add_range
 def parse_unary(index):
     """Parse unary expression."""
-
-    unary_args = {token_kinds.incr: (parse_unary, expr_nodes.PreIncr),
-                  token_kinds.decr: (parse_unary, expr_nodes.PreDecr),
-                  token_kinds.amp: (parse_cast, expr_nodes.AddrOf),
-                  token_kinds.star: (parse_cast, expr_nodes.Deref),
-                  token_kinds.bool_not: (parse_cast, expr_nodes.BoolNot),
-                  token_kinds.plus: (parse_cast, expr_nodes.UnaryPlus),
-                  token_kinds.minus: (parse_cast, expr_nodes.UnaryMinus),
-                  token_kinds.compl: (parse_cast, expr_nodes.Compl)}
-
     if token_in(index, unary_args):
+        start = index
         parse_func, NodeClass = unary_args[p.tokens[index].kind]
         subnode, index = parse_func(index + 1)
-        return NodeClass(subnode), index
+        node = NodeClass(subnode)
+        p.set_range(node, start, index)
+        return node, index
     elif token_is(index, token_kinds.sizeof_kw):
-        with log_error():
-            node, index = parse_unary(index + 1)
-            return expr_nodes.SizeofExpr(node), index
+        return parse_sizeof(index)
+    elif (token_is(index, token_kinds.bool_and)
+          and token_is(index + 1, token_kinds.identifier)):
+        # The GNU extension `&&label` takes the address of a label.
+        node = expr_nodes.LabelAddress(p.tokens[index + 1])
+        p.set_range(node, index, index + 2)
+        return node, index + 2
+    elif token_is(index, token_kinds.alignof_kw):
+        return parse_alignof(index)
+    else:
+        return parse_postfix(index)
 
-        from shivyc.parser.declaration import (
-            parse_abstract_declarator, parse_spec_qual_list)
 
-        match_token(index + 1, token_kinds.open_paren, ParserError.AFTER)
-        specs, index = parse_spec_qual_list(index + 2)
-        node, index = parse_abstract_declarator(index)
-        match_token(index, token_kinds.close_paren, ParserError.AT)
-        decl_node = decl_nodes.Root(specs, [node])
+@add_range
+def parse_sizeof(index):
+    """Parse sizeof expression."""
+    with log_error():
+        node, index = parse_unary(index + 1)
+        return expr_nodes.SizeofExpr(node), index
 
-        return expr_nodes.SizeofType(decl_node), index + 1
-    else:
-        return parse_postfix(index)
+    from shivyc.parser.declaration import (
+        parse_abstract_declarator, parse_spec_qual_list)
+
+    match_token(index + 1, token_kinds.open_paren, ParserError.AFTER)
+    specs, index = parse_spec_qual_list(index + 2)
+    node, index = parse_abstract_declarator(index)
+    match_token(index, token_kinds.close_paren, ParserError.AT)
+    decl_node = decl_nodes.Root(specs, [node])
+
+    return expr_nodes.SizeofType(decl_node), index + 1
 
 
 @add_range
+def parse_alignof(index):
+    """Parse _Alignof expression, whose operand is always a type name."""
+    from shivyc.parser.declaration import (
+        parse_abstract_declarator, parse_spec_qual_list)
+
+    match_token(index + 1, token_kinds.open_paren, ParserError.AFTER)
+    specs, index = parse_spec_qual_list(index + 2)
+    node, index = parse_abstract_declarator(index)
+    match_token(index, token_kinds.close_paren, ParserError.AT)
+    decl_node = decl_nodes.Root(specs, [node])
+
+    return expr_nodes.AlignofType(decl_node), index + 1
+
+
+# Map from each unary operator to the function which parses its operand and
+# the node it produces.
+unary_args = {token_kinds.incr: (parse_unary, expr_nodes.PreIncr),
+              token_kinds.decr: (parse_unary, expr_nodes.PreDecr),
+              token_kinds.amp: (parse_cast, expr_nodes.AddrOf),
+              token_kinds.star: (parse_cast, expr_nodes.Deref),
+              token_kinds.bool_not: (parse_cast, expr_nodes.BoolNot),
+              token_kinds.plus: (parse_cast, expr_nodes.UnaryPlus),
+              token_kinds.minus: (parse_cast, expr_nodes.UnaryMinus),
+              token_kinds.compl: (parse_cast, expr_nodes.Compl)}
+
+
 def parse_postfix(index):
     """Parse postfix expression."""
     cur, index = parse_primary(index)
 
     while True:
-        old_range = cur.r
+        start_token = cur.start_token
 
         if token_is(index, token_kinds.open_sq_brack):
             index += 1
@@ -210,7 +242,9 @@ def parse_postfix(index):
             index += 1
 
             if token_is(index, token_kinds.close_paren):
-                return expr_nodes.FuncCall(cur, args), index + 1
+                cur = _make_call(cur, args)
+                cur.start_token, cur.end_token = start_token, p.tokens[index]
+                return cur, index + 1
 
             while True:
                 arg, index = parse_assignment(index)
@@ -224,7 +258,9 @@ def parse_postfix(index):
             index = match_token(
                 index, token_kinds.close_paren, ParserError.GOT)
 
-            return expr_nodes.FuncCall(cur, args), index
+            cur = _make_call(cur, args)
+            cur.start_token, cur.end_token = start_token, p.tokens[index - 1]
+            return cur, index
 
         elif token_is(index, token_kinds.incr):
             index += 1
@@ -235,7 +271,16 @@ def parse_postfix(index):
         else:
             return cur, index
 
-        cur.r = old_range + p.tokens[index - 1].r
+        cur.start_token, cur.end_token = start_token, p.tokens[index - 1]
+
+
+def _make_call(func, args):
+    """Return the node of a call of `func`, which may be a builtin."""
+    if (isinstance(func, expr_nodes.Identifier)
+          and func.identifier.content in expr_nodes.builtins):
+        builtin = expr_nodes.builtins[func.identifier.content]
+        return builtin(func.identifier, args)
+    return expr_nodes.FuncCall(func, args)
 
 
 @add_range
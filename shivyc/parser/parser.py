@@ -23,20 +23,29 @@ from shivyc.parser.utils import (add_range, log_error, ParserError,
 from shivyc.parser.declaration import parse_declaration, parse_func_definition
 
 
-def parse(tokens_to_parse):
+def parse(tokens_to_parse, symbols=None, memo=True):
     """Parse the given tokens into an AST.
 
     Also, as the entry point for the parser, responsible for setting the
-    tokens global variable.
+    tokens global variable and starting a new symbol table. If `symbols` is
+    given, parsing continues with that symbol table instead, as left by
+    parsing the tokens before these. If `memo` is false, productions parsed
+    again at the same index are not reused from the parse memo.
     """
     p.best_error = None
     p.tokens = tokens_to_parse
+    p.pairs = p.match_pairs(tokens_to_parse)
+    p.symbols = symbols or p.SimpleSymbolTable()
+    p.memo = {} if memo else None
 
-    with log_error():
-        return parse_root(0)[0]
+    try:
+        with log_error():
+            return parse_root(0)[0]
 
-    error_collector.add(p.best_error)
-    return None
+        error_collector.add(p.best_error)
+        return None
+    finally:
+        p.memo = None
 
 
 @add_range
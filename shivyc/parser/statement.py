@@ -6,8 +6,12 @@ import shivyc.parser.utils as p
 
 from shivyc.parser.declaration import parse_declaration
 from shivyc.parser.expression import parse_expression
-from shivyc.parser.utils import (add_range, log_error, match_token, token_is,
-                                 ParserError)
+from shivyc.parser.utils import (add_range, log_error, match_token, token_in,
+                                 token_is, ParserError)
+
+# Stack of the lists of case and default labels of the switch-statements
+# being parsed, innermost last.
+_switches = []
 
 
 @add_range
@@ -19,8 +23,10 @@ def parse_statement(index):
 
     """
     for func in (parse_compound_statement, parse_return, parse_break,
-                 parse_continue, parse_if_statement, parse_while_statement,
-                 parse_for_statement):
+                 parse_continue, parse_goto, parse_asm, parse_if_statement,
+                 parse_while_statement, parse_for_statement,
+                 parse_switch_statement, parse_case_statement,
+                 parse_labeled_statement):
         with log_error():
             return func(index)
 
@@ -92,6 +98,138 @@ def parse_continue(index):
     return nodes.Continue(), index
 
 
+@add_range
+def parse_goto(index):
+    """Parse a goto statement.
+
+    Ex: goto end;
+
+    The GNU extension `goto *expr;` jumps to the label whose address, as
+    taken by `&&label`, is the value of the expression.
+    """
+    index = match_token(index, token_kinds.goto_kw, ParserError.GOT)
+    if token_is(index, token_kinds.star):
+        target, index = parse_expression(index + 1)
+        node = nodes.ComputedGoto(target)
+    else:
+        index = match_token(index, token_kinds.identifier, ParserError.AFTER)
+        node = nodes.Goto(p.tokens[index - 1])
+    index = match_token(index, token_kinds.semicolon, ParserError.AFTER)
+    return node, index
+
+
+@add_range
+def parse_asm(index):
+    """Parse a GNU extended asm statement.
+
+    Ex: asm volatile ("rdtsc" : "=a" (lo), "=d" (hi));
+
+    The template may be followed by up to three lists, each after a colon:
+    the output operands, the input operands, and the clobbered registers.
+    An operand is a constraint string, after its name in brackets if it is
+    named, and then its expression in parentheses. Adjacent strings are
+    joined, as for a template written across several lines.
+    """
+    if not token_in(index, {token_kinds.asm_kw, token_kinds.gnu_asm_kw}):
+        err = "expected asm statement"
+        raise ParserError(err, index, p.tokens, ParserError.GOT)
+    index += 1
+
+    # Every asm is kept where it is written, so the qualifiers which ask
+    # for that or for its size to be guessed small change nothing.
+    while (token_in(index, {token_kinds.volatile_kw, token_kinds.inline_kw})
+           or token_is(index, token_kinds.identifier)
+           and p.tokens[index].content in {"__volatile__", "__inline__"}):
+        index += 1
+
+    index = match_token(index, token_kinds.open_paren, ParserError.AFTER)
+    template, index = _parse_strings(index)
+
+    lists = []
+    while len(lists) < 3 and token_is(index, token_kinds.colon):
+        index += 1
+        if len(lists) < 2:
+            items, index = _parse_asm_operands(index)
+        else:
+            items, index = _parse_list(index, _parse_strings)
+        lists.append(items)
+    outputs, inputs, clobbers = lists + [[]] * (3 - len(lists))
+
+    index = match_token(index, token_kinds.close_paren, ParserError.AFTER)
+    index = match_token(index, token_kinds.semicolon, ParserError.AFTER)
+    return nodes.Asm(template, outputs, inputs, clobbers), index
+
+
+def _parse_strings(index):
+    """Parse one or more adjacent string literals.
+
+    Returns the text of the strings joined, as a pair of the string and its
+    range, and the index after them.
+    """
+    index = match_token(index, token_kinds.string, ParserError.GOT)
+    first = last = p.tokens[index - 1]
+    text = "".join(map(chr, first.content[:-1]))
+    while token_is(index, token_kinds.string):
+        last = p.tokens[index]
+        text += "".join(map(chr, last.content[:-1]))
+        index += 1
+    return (text, first.r + last.r), index
+
+
+def _parse_asm_operands(index):
+    """Parse the list of output or input operands of an asm statement.
+
+    Each operand is returned as a tuple of the identifier token of its
+    name or None, its constraint as returned by _parse_strings, and its
+    expression.
+    """
+    def parse_operand(index):
+        name = None
+        if token_is(index, token_kinds.open_sq_brack):
+            index = match_token(index + 1, token_kinds.identifier,
+                                ParserError.AFTER)
+            name = p.tokens[index - 1]
+            index = match_token(index, token_kinds.close_sq_brack,
+                                ParserError.AFTER)
+        constraint, index = _parse_strings(index)
+        index = match_token(index, token_kinds.open_paren, ParserError.AFTER)
+        expr, index = parse_expression(index)
+        index = match_token(index, token_kinds.close_paren, ParserError.AFTER)
+        return (name, constraint, expr), index
+
+    return _parse_list(index, parse_operand)
+
+
+def _parse_list(index, parse_item):
+    """Parse a list of items separated by commas, which may be empty.
+
+    The list ends at the first token which cannot start an item.
+    """
+    items = []
+    if not token_in(index, {token_kinds.string, token_kinds.open_sq_brack}):
+        return items, index
+
+    item, index = parse_item(index)
+    items.append(item)
+    while token_is(index, token_kinds.comma):
+        item, index = parse_item(index + 1)
+        items.append(item)
+    return items, index
+
+
+@add_range
+def parse_labeled_statement(index):
+    """Parse a statement with a label which goto statements jump to.
+
+    Ex: end: return 4;
+    """
+    index = match_token(index, token_kinds.identifier, ParserError.GOT)
+    label = p.tokens[index - 1]
+    index = match_token(index, token_kinds.colon, ParserError.GOT)
+    statement, index = parse_statement(index)
+    return nodes.LabelStatement(label, statement), index
+
+
 @add_range
 def parse_if_statement(index):
     """Parse an if statement."""
@@ -125,6 +263,46 @@ def parse_while_statement(index):
     return nodes.WhileStatement(conditional, statement), index
 
 
+@add_range
+def parse_switch_statement(index):
+    """Parse a switch statement."""
+    index = match_token(index, token_kinds.switch_kw, ParserError.GOT)
+    index = match_token(index, token_kinds.open_paren, ParserError.AFTER)
+    conditional, index = parse_expression(index)
+    index = match_token(index, token_kinds.close_paren, ParserError.AFTER)
+
+    _switches.append([])
+    try:
+        statement, index = parse_statement(index)
+    finally:
+        cases = _switches.pop()
+
+    return nodes.SwitchStatement(conditional, statement, cases), index
+
+
+@add_range
+def parse_case_statement(index):
+    """Parse a statement with a case or default label.
+
+    The label is recorded with the innermost switch statement, if any.
+    Ex: case 3: return 4;
+    """
+    if token_is(index, token_kinds.default_kw):
+        value = None
+        index += 1
+    else:
+        index = match_token(index, token_kinds.case_kw, ParserError.GOT)
+        value, index = parse_expression(index)
+
+    index = match_token(index, token_kinds.colon, ParserError.AFTER)
+    statement, index = parse_statement(index)
+
+    node = nodes.CaseStatement(value, statement)
+    if _switches:
+        _switches[-1].append(node)
+    return node, index
+
+
 @add_range
 def parse_for_statement(index):
     """Parse a for statement."""
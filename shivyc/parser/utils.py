@@ -1,9 +1,10 @@
 """Utilities for the parser."""
 
 from contextlib import contextmanager
-import copy
 
-from shivyc.errors import CompilerError, Range
+import shivyc.token_kinds as token_kinds
+from shivyc.errors import error_collector, CompilerError, Range
+from shivyc.scope import ScopedTable
 
 
 # This is a little bit messy, but worth the repetition it saves. In the
@@ -12,6 +13,11 @@ from shivyc.errors import CompilerError, Range
 # variable rather than passing around the tokens list everywhere.
 tokens = None
 
+# Map from the index of each parenthesis or square bracket in `tokens` to the
+# index of the one it pairs with, set by the main parse function alongside
+# `tokens`. Unmatched brackets have no entry.
+pairs = {}
+
 
 class SimpleSymbolTable:
     """Table to record every declared symbol.
@@ -19,27 +25,88 @@ class SimpleSymbolTable:
     This is required to parse typedefs in C, because the parser must know
     whether a given identifier denotes a type or a value. For every
     declared identifier, the table records whether or not it is a type
-    defnition.
+    defnition. The scopes are kept in a ScopedTable, like those of the
+    symbol table of IL gen.
+
+    Every change to the table is recorded in an undo log, so that when a
+    speculative parse fails, the table is rolled back to a checkpoint taken
+    before it in time proportional to the changes made since.
+
+    Each distinct state of the table has a version number, which the parse
+    memo uses to tell whether a production can be reused at an index. A
+    table rolled back to a checkpoint returns to the version it had there,
+    and changes made after that get new versions.
     """
+
     def __init__(self):
-        self.symbols = []
-        self.new_scope()
+        self.table = ScopedTable()
+        self.log = []
+        self.version = 0
+        self.versions = 0
 
     def new_scope(self):
-        self.symbols.append({})
+        self.table.new_scope()
+        self._change(("new_scope",))
 
     def end_scope(self):
-        self.symbols.pop()
+        self._change(("end_scope", self.table.end_scope()))
 
     def add_symbol(self, identifier, is_typedef):
-        self.symbols[-1][identifier.content] = is_typedef
+        self._set(identifier.content, is_typedef)
+
+    def _set(self, name, is_typedef):
+        old = self.table.lookup_local(name)
+        if self.table.bind(name, is_typedef):
+            self._change(("replace", name, is_typedef, old))
+        else:
+            self._change(("add", name, is_typedef))
+
+    def _change(self, change):
+        """Record a change to the table in the undo log."""
+        self.log.append(change)
+        self.versions += 1
+        self.version = self.versions
+
+    def checkpoint(self):
+        """Return a checkpoint to which the table can be rolled back."""
+        return len(self.log), self.version
+
+    def rollback(self, checkpoint):
+        """Undo every change made to the table since the checkpoint."""
+        length, self.version = checkpoint
+        while len(self.log) > length:
+            change = self.log.pop()
+            if change[0] == "new_scope":
+                self.table.end_scope()
+            elif change[0] == "end_scope":
+                self.table.new_scope()
+                for name, is_typedef in change[1]:
+                    self.table.bind(name, is_typedef)
+            elif change[0] == "add":
+                self.table.unbind_last()
+            else:
+                self.table.bind(change[1], change[3])
+
+    def changes(self, checkpoint):
+        """Return the changes made to the table since the checkpoint."""
+        return self.log[checkpoint[0]:]
+
+    def replay(self, changes, version):
+        """Make the given changes again, which lead to the given version.
+
+        The table must be in the state the changes were first made in.
+        """
+        for change in changes:
+            if change[0] == "new_scope":
+                self.new_scope()
+            elif change[0] == "end_scope":
+                self.end_scope()
+            else:
+                self._set(change[1], change[2])
+        self.version = version
 
     def is_typedef(self, identifier):
-        name = identifier.content
-        for table in self.symbols[::-1]:
-            if name in table:
-                return table[name]
-        return False
+        return self.table.lookup(identifier.content, False)
 
 
 symbols = SimpleSymbolTable()
@@ -120,6 +187,11 @@ def raise_error(err, index, error_type):
 # Used to store the best error found in the parsing phase.
 best_error = None
 
+# Map from a production, its arguments, and the symbol table version at the
+# index it was parsed at to the result, set by the main parse function. If
+# it is None, the results of productions are not memoized.
+memo = None
+
 
 @contextmanager
 def log_error():
@@ -139,16 +211,64 @@ def log_error():
     The value of e.amount_parsed is used to determine the amount
     successfully parsed before encountering the error.
     """
-    global best_error, symbols
+    global best_error
 
-    # back up the global symbols table, so if parsing fails we can reset it
-    symbols_bak = copy.deepcopy(symbols)
+    # checkpoint the global symbols table, so if parsing fails we can reset it
+    checkpoint = symbols.checkpoint()
     try:
         yield
     except ParserError as e:
         if not best_error or e.amount_parsed >= best_error.amount_parsed:
             best_error = e
-        symbols = symbols_bak
+        symbols.rollback(checkpoint)
+
+
+def memoize(parse_func):
+    """Return a decorated parse_* function that remembers its results.
+
+    Speculative parse paths often parse the same production at the same
+    index, such as the declaration specifiers of a declaration first tried
+    as a function definition. The result of each such parse depends only on
+    the index, the arguments, and the state of the symbol table, so it is
+    saved under those in the memo and reused when parsed again.
+
+    Reusing a parse makes its changes to the symbol table again and offers
+    the best error logged while it was first parsed to best_error again.
+    Only successful parses are saved, because they are the ones which can
+    be long. A ParserError holds on to the frames it was raised through,
+    which would make garbage collection slow with many of them saved, so
+    the best error is saved without them. A parse which adds to the error
+    collector is not saved either, so those issues are added each time just
+    as if there were no memo.
+    """
+    def parse_with_memo(index, *args):
+        global best_error
+        if memo is None:
+            return parse_func(index, *args)
+
+        key = (parse_func, index, args, symbols.version)
+        if key in memo:
+            result, changes, version, error = memo[key]
+            if error and (not best_error or
+                          error.amount_parsed >= best_error.amount_parsed):
+                best_error = error
+            symbols.replay(changes, version)
+            return result
+
+        checkpoint = symbols.checkpoint()
+        old_error = best_error
+        issues = len(error_collector.issues)
+        result = parse_func(index, *args)
+
+        if len(error_collector.issues) == issues:
+            error = None
+            if best_error is not old_error:
+                error = best_error.with_traceback(None)
+            memo[key] = (result, symbols.changes(checkpoint),
+                         symbols.version, error)
+        return result
+
+    return parse_with_memo
 
 
 def token_is(index, kind):
@@ -181,13 +301,41 @@ def match_token(index, kind, message_type, message=None):
         raise ParserError(message, index, tokens, message_type)
 
 
-def token_range(start, end):
-    """Generate a range that encompasses tokens[start] to tokens[end-1]"""
+def set_range(node, start, end):
+    """Tag node with the range that encompasses tokens[start] to tokens[end-1].
+
+    The node keeps only the first and last tokens of the range, from which
+    its Range is made if it is needed.
+    """
     global tokens
 
     start_index = min(start, len(tokens) - 1, end - 1)
     end_index = min(end - 1, len(tokens) - 1)
-    return tokens[start_index].r + tokens[end_index].r
+    node.start_token = tokens[start_index]
+    node.end_token = tokens[end_index]
+
+
+def match_pairs(tokens):
+    """Return the map from each bracket in tokens to the one it pairs with.
+
+    Parentheses and square brackets are matched separately, so that a
+    parenthesis matches the same one it would if square brackets were
+    ignored, and vice versa.
+    """
+    kinds = {token_kinds.open_paren: token_kinds.close_paren,
+             token_kinds.open_sq_brack: token_kinds.close_sq_brack}
+    opens = {kind: [] for kind in kinds}
+    closes = {close: opens[open] for open, close in kinds.items()}
+
+    pairs = {}
+    for i, token in enumerate(tokens):
+        if token.kind in opens:
+            opens[token.kind].append(i)
+        elif token.kind in closes and closes[token.kind]:
+            open_index = closes[token.kind].pop()
+            pairs[open_index] = i
+            pairs[i] = open_index
+    return pairs
 
 
 def add_range(parse_func):
@@ -202,7 +350,7 @@ def add_range(parse_func):
     def parse_with_range(index, *args):
         start_index = index
         node, end_index = parse_func(index, *args)
-        node.r = token_range(start_index, end_index)
+        set_range(node, start_index, end_index)
 
         return node, end_index
 
@@ -0,0 +1,160 @@
+"""Precompiled headers for the headers bundled with ShivyC.
+
+Most files begin by including some of the headers in shivyc/include/, and
+parsing and making the IL of their declarations is the same work for each
+of those files. The state of the parser symbol table, ILCode, and
+SymbolTable after that prefix of bundled header tokens is saved as a
+pickle under a hash of the tokens, and a file which begins with the same
+tokens loads the pickle and is parsed from the first token after them.
+
+Pickles are kept in memory for the rest of the run of the compiler, and in
+the `pch` subdirectory of the cache directory if one is given. The C types
+defined in ctypes.py are compared by identity, so they are pickled by name
+rather than copied.
+"""
+
+import hashlib
+import io
+import os
+import pickle
+import tempfile
+
+import shivyc
+import shivyc.cache as cache
+import shivyc.ctypes as ctypes
+import shivyc.preproc as preproc
+
+from shivyc.errors import error_collector
+from shivyc.parser.parser import parse
+import shivyc.parser.utils as p
+from shivyc.il_gen import ILCode, SymbolTable, Context
+
+# Name under which each C type defined in ctypes.py is pickled.
+ctype_names = {id(ctype): name for name, ctype in vars(ctypes).items()
+               if isinstance(ctype, ctypes.CType)}
+
+# Map from the key of each header prefix to its pickle.
+pickles = {}
+
+
+def load(tokens, cache_dir=None):
+    """Return the state after the bundled header tokens at the start.
+
+    returns - the parser symbol table, ILCode, and SymbolTable after the
+    header tokens, and the number of header tokens, or else None and 0 if
+    the tokens do not begin with a bundled header
+    """
+    count = header_length(tokens)
+    if not count:
+        return None, 0
+
+    key = _key(tokens[:count])
+    data = pickles.get(key) or _read(cache_dir, key)
+    if data is None:
+        data = _compile(tokens[:count])
+        if data is None:
+            return None, 0
+        _write(cache_dir, key, data)
+    pickles[key] = data
+    return loads(data), count
+
+
+def dumps(obj):
+    """Return the pickle of obj, with the C types of ctypes.py by name."""
+    out = io.BytesIO()
+    Pickler(out).dump(obj)
+    return out.getvalue()
+
+
+def loads(data):
+    """Return the object pickled by dumps."""
+    return Unpickler(io.BytesIO(data)).load()
+
+
+def header_length(tokens):
+    """Return the number of tokens at the start from bundled headers."""
+    include_dir = str(preproc.include_dir)
+    count = 0
+    for token in tokens:
+        if os.path.dirname(token.r.start.file) != include_dir:
+            break
+        count += 1
+    return count
+
+
+def _compile(tokens):
+    """Return the pickled state after parsing and making IL of tokens.
+
+    If there is any error or warning in the tokens, they are dropped from
+    the error collector and None is returned, so that they are reported
+    once when the file is compiled whole.
+    """
+    issues = len(error_collector.issues)
+    ast_root = parse(tokens)
+
+    il_code = ILCode()
+    symbol_table = SymbolTable()
+    if ast_root:
+        ast_root.make_il(il_code, symbol_table, Context())
+    if not ast_root or len(error_collector.issues) != issues:
+        error_collector.truncate(issues)
+        return None
+
+    return dumps((p.symbols, il_code, symbol_table))
+
+
+def _key(tokens):
+    """Return the key of the given header tokens."""
+    digest = hashlib.sha256()
+    digest.update(f"shivyc {shivyc.__version__} pch\n".encode())
+    cache.hash_tokens(digest, tokens)
+    return digest.hexdigest()
+
+
+def _path(cache_dir, key):
+    """Return the path of the pickle of `key` in the cache directory."""
+    return os.path.join(cache_dir, "pch", key + ".pch")
+
+
+def _read(cache_dir, key):
+    """Return the pickle of `key` from the cache directory, if there."""
+    if not cache_dir:
+        return None
+    try:
+        with open(_path(cache_dir, key), "rb") as file:
+            return file.read()
+    except OSError:
+        return None
+
+
+def _write(cache_dir, key, data):
+    """Save the pickle of `key` in the cache directory, if one is given.
+
+    A header which cannot be saved is compiled again next time, so errors
+    writing are ignored.
+    """
+    if not cache_dir:
+        return
+    path = _path(cache_dir, key)
+    try:
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        fd, temp = tempfile.mkstemp(dir=os.path.dirname(path))
+        with os.fdopen(fd, "wb") as file:
+            file.write(data)
+        os.replace(temp, path)
+    except OSError:
+        pass
+
+
+class Pickler(pickle.Pickler):
+    """Pickler which saves the C types of ctypes.py by name."""
+
+    def persistent_id(self, obj):  # noqa D102
+        return ctype_names.get(id(obj))
+
+
+class Unpickler(pickle.Unpickler):
+    """Unpickler which loads the C types of ctypes.py by name."""
+
+    def persistent_load(self, pid):  # noqa D102
+        return getattr(ctypes, pid)
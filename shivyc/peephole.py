@@ -0,0 +1,229 @@
+"""Peephole optimization of generated ASM code.
+
+The peephole optimizer slides a window over the ASM commands of the
+program, and replaces any run of commands matching one of the patterns
+below with cheaper commands that have the same effect. Comments are not
+considered part of a run, so a pattern may span the code of several IL
+commands. Each pattern counts how often it is applied, for diagnostics.
+
+To add a pattern, subclass Pattern and add an instance to `patterns`.
+"""
+
+from collections import Counter
+
+import shivyc.asm_cmds as asm_cmds
+from shivyc.spots import MemSpot, RegSpot
+
+
+class Pattern:
+    """A rule for rewriting a run of consecutive ASM commands.
+
+    name (str) - Name of the pattern, shown with its hit count.
+    length (int) - Number of commands in the run this pattern matches.
+    """
+
+    name = None
+    length = None
+
+    def rewrite(self, window, refs):
+        """Rewrite the given run of commands.
+
+        window (List) - The `length` commands to match, not counting
+        comments.
+        refs (Counter) - Number of jumps to each label in the program.
+        returns - list of commands to replace the window with, or None if
+        this pattern does not match
+        """
+        raise NotImplementedError
+
+
+class SelfMove(Pattern):
+    """Remove a move of a spot to itself, like `mov rax, rax`.
+
+    A 32-bit move to a register is kept, because it clears the upper half of
+    the register.
+    """
+
+    name = "self-move"
+    length = 1
+
+    def rewrite(self, window, refs):  # noqa D102
+        mov = window[0]
+        if (isinstance(mov, asm_cmds.Mov) and mov.dest == mov.source
+              and not (mov.size == 4 and isinstance(mov.dest, RegSpot))):
+            return []
+        return None
+
+
+class JumpToNext(Pattern):
+    """Remove an unconditional jump to the label right after it."""
+
+    name = "jump-to-next"
+    length = 2
+
+    def rewrite(self, window, refs):  # noqa D102
+        jump, label = window
+        if (isinstance(jump, asm_cmds.Jmp)
+              and isinstance(label, asm_cmds.Label)
+              and jump.target == label.label):
+            return [label]
+        return None
+
+
+class RedundantReload(Pattern):
+    """Remove a move which copies a value back where it just came from.
+
+    For example, `mov rax, [rbp-8]` followed by `mov [rbp-8], rax`.
+    """
+
+    name = "redundant-reload"
+    length = 2
+
+    def rewrite(self, window, refs):  # noqa D102
+        first, second = window
+        if not (isinstance(first, asm_cmds.Mov)
+                and isinstance(second, asm_cmds.Mov)
+                and first.size == second.size
+                and first.dest == second.source
+                and first.source == second.dest):
+            return None
+
+        # The first move may change an address the second one uses.
+        if first.dest in _address_regs(second.dest):
+            return None
+
+        # A 32-bit move to a register also clears its upper half.
+        if second.size == 4 and isinstance(second.dest, RegSpot):
+            return None
+
+        return [first]
+
+
+class BoolBranch(Pattern):
+    """Branch directly on a comparison whose result is then tested.
+
+    A comparison stores its 0 or 1 result with
+
+        cmp A, B; setCC R8; movzx R, R8
+
+    and a conditional jump on that result then does `test R, R; je T`.
+    Neither setCC nor movzx changes the flags, so the test is dropped and
+    the jump is made on the flags of the comparison. The result is still
+    stored in R, in case it is used again. The comparison may itself be a
+    `test`.
+    """
+
+    name = "bool-branch"
+    length = 5
+
+    def rewrite(self, window, refs):  # noqa D102
+        cmp, setcc, movzx, test, branch = window
+        if not (isinstance(cmp, (asm_cmds.Cmp, asm_cmds.Test))
+                and isinstance(setcc, asm_cmds.Setcc)
+                and isinstance(movzx, asm_cmds.Movzx)
+                and isinstance(test, asm_cmds.Test)
+                and isinstance(branch, (asm_cmds.Je, asm_cmds.Jne))):
+            return None
+
+        result = setcc.dest
+        if not (isinstance(result, RegSpot)
+                and movzx.dest == result and movzx.source == result
+                and test.dest == result and test.source == result
+                and test.size == movzx.source_size):
+            return None
+
+        jump = setcc.cond
+        if isinstance(branch, asm_cmds.Je):
+            jump = asm_cmds.inverse_jump[jump]
+        return [cmp, setcc, movzx, jump(branch.target)]
+
+
+def _address_regs(spot):
+    """Return the registers used to compute the address of a memory spot."""
+    if not isinstance(spot, MemSpot):
+        return []
+    return [s for s in (spot.base, spot.count) if isinstance(s, RegSpot)]
+
+
+patterns = [SelfMove(), JumpToNext(), RedundantReload(), BoolBranch()]
+
+
+class Peephole:
+    """Peephole optimizer.
+
+    hits (Counter) - Number of times each pattern was applied, by name.
+    """
+
+    def __init__(self, patterns=patterns):
+        """Initialize the optimizer with a list of Pattern objects."""
+        self.patterns = patterns
+        self.hits = Counter()
+
+    def optimize(self, lines):
+        """Return the given list of ASM commands, optimized.
+
+        Patterns are applied until none of them matches.
+        """
+        refs = Counter()
+        for line in lines:
+            if isinstance(line, asm_cmds._JumpCommand):
+                refs[line.target] += 1
+
+        changed = True
+        while changed:
+            changed = False
+            for pattern in self.patterns:
+                lines, applied = self._apply(pattern, lines, refs)
+                changed = changed or applied
+        return lines
+
+    def _apply(self, pattern, lines, refs):
+        """Apply one pattern everywhere it matches.
+
+        returns - the new list of lines, and whether the pattern was applied
+        """
+        new_lines = []
+
+        # Indices in new_lines of the commands which are not comments.
+        commands = []
+        applied = False
+        for line in lines:
+            new_lines.append(line)
+            if isinstance(line, asm_cmds.Comment):
+                continue
+            commands.append(len(new_lines) - 1)
+            if len(commands) < pattern.length:
+                continue
+
+            start = commands[-pattern.length]
+            window = [new_lines[i] for i in commands[-pattern.length:]]
+            replacement = pattern.rewrite(window, refs)
+            if replacement is None:
+                continue
+
+            for command in window:
+                if isinstance(command, asm_cmds._JumpCommand):
+                    refs[command.target] -= 1
+            for command in replacement:
+                if isinstance(command, asm_cmds._JumpCommand):
+                    refs[command.target] += 1
+
+            # Keep the comments in the window ahead of its replacement.
+            comments = [line for line in new_lines[start:]
+                        if isinstance(line, asm_cmds.Comment)]
+            del new_lines[start:]
+            del commands[-pattern.length:]
+            new_lines.extend(comments)
+            for command in replacement:
+                new_lines.append(command)
+                commands.append(len(new_lines) - 1)
+
+            self.hits[pattern.name] += 1
+            applied = True
+
+        return new_lines, applied
+
+    def show_hits(self):  # pragma: no cover
+        """Print the number of times each pattern was applied."""
+        for pattern in self.patterns:
+            print(f"peephole: {pattern.name}: {self.hits[pattern.name]}")
@@ -1,66 +1,902 @@
 """Implementation of the ShivyC preprocessor.
 
-Currently, the preprocessor implementation is very simple and only handles
-include directives. Despite this, the implementation is also
-technically incorrect in many ways. For example, it expands #include
-directives wherever they appear, rather than only expanding them when the
-appear at the beginning of a line.
+The preprocessor reads each file by lines. A line starting with `#` is a
+directive, and the other lines are collected until the next directive, when
+the macros in them are expanded. The expanded tokens are generated a
+block of lines at a time, and those of an included file are generated in
+place by a nested generator, so no list of tokens is copied into the list
+of the file which includes it. The lines in a branch of a conditional
+directive which is not taken are only scanned for the directives which end
+the branch, and are never tokenized.
+
+Macros are expanded as in the algorithm of Dave Prosser which the C
+standard describes: each token carries the set of the macros whose
+expansion it came from, its hide set, and a macro name is not expanded
+again inside its own expansion. The expansion of an object-like macro is
+memoized by its name and hide set until the next #define or #undef, unless
+it ends in the name of a function-like macro which could take arguments
+from the tokens after it.
+
+A file containing `#pragma once` is only included once into each
+translation unit. A file whose text is all inside one `#ifndef X` directive
+is recorded as guarded by X, and is not read again while X is defined. The
+lines of each included file are cached for the rest of the run of the
+compiler, so a header included by many files is tokenized once unless it
+changes.
 """
+import os
 import pathlib
 
+import shivyc.ctypes as ctypes
 import shivyc.lexer as lexer
 import shivyc.token_kinds as token_kinds
 
 from shivyc.errors import error_collector, CompilerError
+from shivyc.tokens import Token
+from shivyc.tree.utils import report_err
+
+# Directory of the headers bundled with ShivyC.
+include_dir = pathlib.Path(__file__).parent.joinpath("include")
+
+# Map from the path and modification time of each file included so far to
+# its Lines.
+header_lines = {}
+
+# Deepest nesting of included files allowed, to catch a file which
+# includes itself.
+MAX_DEPTH = 200
+
+# Kinds of the tokens which can name a macro.
+name_kinds = {token_kinds.identifier} | set(token_kinds.keyword_kinds)
+
+# Hide set of the tokens read from a file.
+no_macros = frozenset()
+
+
+def process(lines, this_file, included=None):
+    """Preprocess the given Lines of a file and generate its tokens.
+
+    included (List[str]) - If given, the name of each file included is
+    appended to this list, for listing the dependencies of the file.
+    """
+    for block in Preprocessor(included).process_file(lines, this_file):
+        yield from block
+
+
+class Macro:
+    """A macro defined with #define.
+
+    name (str) - Name of the macro.
+    params (List[str]) - Names of the parameters of a function-like macro,
+    ending with `__VA_ARGS__` if it is variadic, or None if the macro is
+    object-like.
+    variadic (bool) - Whether the macro takes variable arguments.
+    body (List[Token]) - Tokens the macro is replaced with.
+    """
+
+    def __init__(self, name, params, variadic, body):
+        """Initialize Macro."""
+        self.name = name
+        self.params = params
+        self.variadic = variadic
+        self.body = body
+
+    def same(self, other):
+        """Return whether another definition of the macro is the same."""
+        return (self.params == other.params and
+                [(t.kind, t.content) for t in self.body] ==
+                [(t.kind, t.content) for t in other.body])
+
+
+class _Conditional:
+    """An #if, #ifdef, or #ifndef directive whose #endif is not yet read.
+
+    active (bool) - Whether the lines of the current branch are kept.
+    taken (bool) - Whether any branch so far was kept.
+    seen_else (bool) - Whether the #else of the directive was read.
+    branches (int) - Number of branches read so far.
+    r (Range) - Range of the directive, for errors.
+    """
+
+    def __init__(self, active, r):
+        """Initialize _Conditional."""
+        self.active = active
+        self.taken = active
+        self.seen_else = False
+        self.branches = 1
+        self.r = r
+
+
+class Preprocessor:
+    """Preprocessor of a single translation unit.
+
+    macros (Dict[str, Macro]) - Macros defined so far.
+    included (List[str]) - Names of the files included, or None.
+    once (Set[str]) - Real paths of the files containing `#pragma once`.
+    guards (Dict[str, str]) - Map from the real path of each file found to
+    be guarded by an #ifndef directive to the name of its guard macro.
+    memo (Dict) - Map from the name and hide set of each object-like macro
+    expanded to its expansion, or to None if it cannot be memoized.
+    depth (int) - Number of files being included in each other.
+    """
+
+    def __init__(self, included=None):
+        """Initialize Preprocessor."""
+        self.macros = {}
+        self.included = included
+        self.once = set()
+        self.guards = {}
+        self.memo = {}
+        self.depth = 0
+
+    def process_file(self, lines, this_file):
+        """Preprocess the given Lines of a file.
+
+        Generates the lists of tokens expanded from each block of lines
+        between directives, and those of the files included, in order.
+        """
+        text = []
+        conds = []
+        in_comment = False
+
+        # The file is guarded if its first line is an #ifndef with no #elif
+        # or #else, and nothing but comments follows the matching #endif.
+        guard = None
+        guard_cond = None
+        guarded = True
+
+        n = 0
+        while n < len(lines):
+            if conds and not conds[-1].active:
+                n, in_comment = self.skip(lines, n, in_comment, conds)
+                continue
+
+            tokens, in_comment = lines.tokens(n, in_comment)
+            n += 1
+            if not tokens:
+                continue
+
+            if guard_cond not in conds:
+                guarded = (guarded and not guard_cond and
+                           _directive_name(tokens) == "ifndef" and
+                           len(tokens) > 2)
+
+            if tokens[0].kind != token_kinds.pound:
+                text += tokens
+                continue
+
+            if text:
+                yield self.expand(text)
+                text = []
+            include = self.directive(tokens, this_file, conds)
+            if guarded and not guard_cond:
+                guard = tokens[2].content
+                guard_cond = conds[-1]
+
+            if include:
+                self.depth += 1
+                yield from self.process_file(*include)
+                self.depth -= 1
+
+        if text:
+            yield self.expand(text)
+
+        for cond in conds:
+            error_collector.add(CompilerError("unterminated conditional "
+                                              "directive", cond.r))
+
+        if (guarded and guard_cond and guard_cond not in conds and
+              guard_cond.branches == 1):
+            self.guards[os.path.realpath(this_file)] = guard
+
+    def skip(self, lines, n, in_comment, conds):
+        """Skip the lines of a branch not taken, starting at line n.
+
+        Lines are only scanned for the conditional directives in them, until
+        the #elif, #else, or #endif which ends the branch. That directive is
+        tokenized and processed.
+
+        returns - number of the line after the last one skipped, and whether
+        it starts inside a comment
+        """
+        depth = 0
+        while n < len(lines):
+            name, next_comment = lines.scan(n, in_comment)
+            if name in {"if", "ifdef", "ifndef"}:
+                depth += 1
+            elif name in {"elif", "else", "endif"}:
+                if not depth:
+                    tokens, in_comment = lines.tokens(n, in_comment)
+                    if tokens and tokens[0].kind == token_kinds.pound:
+                        with report_err():
+                            self.conditional(tokens, name, conds)
+                    return n + 1, in_comment
+                elif name == "endif":
+                    depth -= 1
+            in_comment = next_comment
+            n += 1
+        return n, in_comment
+
+    def directive(self, tokens, this_file, conds):
+        """Process the directive on one line.
+
+        tokens (List[Token]) - Tokens of the line, starting with `#`.
+        this_file (str) - Name of the file the directive is in.
+        conds (List[_Conditional]) - Open conditionals of the file.
+        returns - the Lines and path of the file to include, for an #include
+        of a file which is read
+        """
+        if len(tokens) == 1:
+            return None
+
+        name = _directive_name(tokens)
+        with report_err():
+            if name in {"if", "ifdef", "ifndef", "elif", "else", "endif"}:
+                self.conditional(tokens, name, conds)
+            elif name == "include":
+                return self.include(tokens, this_file)
+            elif name == "define":
+                self.define(tokens)
+            elif name == "undef":
+                self.undef(tokens)
+            elif name == "pragma":
+                self.pragma(tokens, this_file)
+            elif name in {"error", "warning"}:
+                descrip = f"#{name}" + _spell(tokens[2:], " ")
+                raise CompilerError(descrip, tokens[1].r, name == "warning")
+            else:
+                descrip = f"invalid preprocessing directive '#{tokens[1]}'"
+                raise CompilerError(descrip, tokens[1].r)
+        return None
+
+    def conditional(self, tokens, name, conds):
+        """Process an #if, #ifdef, #ifndef, #elif, #else, or #endif."""
+        r = tokens[0].r + tokens[1].r
+
+        # A condition which cannot be evaluated is taken to be false, after
+        # its error is reported.
+        if name in {"ifdef", "ifndef"}:
+            conds.append(_Conditional(False, r))
+            macro = self.macro_name(tokens, name)
+            active = (macro.content in self.macros) == (name == "ifdef")
+            conds[-1].active = conds[-1].taken = active
+            _check_end(tokens, 3, name)
+            return
+
+        if name == "if":
+            conds.append(_Conditional(False, r))
+            conds[-1].active = conds[-1].taken = self.condition(tokens)
+            return
+
+        if not conds:
+            raise CompilerError(f"#{name} without #if", r)
+        cond = conds[-1]
+        if name == "endif":
+            conds.pop()
+            _check_end(tokens, 2, name)
+        elif cond.seen_else:
+            raise CompilerError(f"#{name} after #else", r)
+        else:
+            cond.branches += 1
+
+        if name == "else":
+            cond.seen_else = True
+            cond.active = not cond.taken
+            cond.taken = True
+            _check_end(tokens, 2, name)
+        elif name == "elif" and cond.taken:
+            cond.active = False
+        elif name == "elif":
+            cond.active = False
+            cond.active = cond.taken = self.condition(tokens)
+
+    def condition(self, tokens):
+        """Return the value of the expression of an #if or #elif."""
+        items = []
+        i = 2
+        while i < len(tokens):
+            token = tokens[i]
+            if (token.kind != token_kinds.identifier or
+                  token.content != "defined"):
+                items.append(token)
+                i += 1
+                continue
+
+            parens = (i + 1 < len(tokens) and
+                      tokens[i + 1].kind == token_kinds.open_paren)
+            name = i + 2 if parens else i + 1
+            if (name >= len(tokens) or tokens[name].kind not in name_kinds
+                  or (parens and (name + 1 >= len(tokens) or
+                                  tokens[name + 1].kind !=
+                                  token_kinds.close_paren))):
+                err = "operator 'defined' requires an identifier"
+                raise CompilerError(err, token.r)
+
+            value = "1" if tokens[name].content in self.macros else "0"
+            items.append(Token(token_kinds.number, value, r=token.r))
+            i = name + 2 if parens else name + 1
+
+        if not items:
+            err = f"#{tokens[1]} with no expression"
+            raise CompilerError(err, tokens[0].r + tokens[1].r)
+        return _Evaluator(self.expand(items)).value() != 0
+
+    def include(self, tokens, this_file):
+        """Process an #include and return the file to include.
+
+        A file is not read again if it contains `#pragma once` or is
+        guarded by a macro which is defined.
+
+        returns - the Lines and path of the file, or None if it is not read
+        """
+        filename = tokens[2]
+        _check_end(tokens, 3, "include")
+
+        path = find_file(filename.content, this_file)
+        if self.included is not None:
+            self.included.append(path)
+
+        real = os.path.realpath(path)
+        if real in self.once or self.guards.get(real) in self.macros:
+            return None
+
+        if self.depth >= MAX_DEPTH:
+            err = f"#include nested more than {MAX_DEPTH} deep"
+            raise CompilerError(err, filename.r)
+
+        try:
+            lines = read_lines(path)
+        except IOError:
+            raise CompilerError("unable to read included file", filename.r)
+        return lines, path
+
+    def define(self, tokens):
+        """Process a #define."""
+        name = self.macro_name(tokens, "define")
+        if name.content == "defined":
+            err = "'defined' cannot be used as a macro name"
+            raise CompilerError(err, name.r)
+
+        params = None
+        variadic = False
+        i = 3
+        if (i < len(tokens) and tokens[i].kind == token_kinds.open_paren
+              and _adjacent(name, tokens[i])):
+            params, variadic, i = _read_params(tokens, i)
+
+        body = tokens[i:]
+        if body and (body[0].kind == token_kinds.pound_pound or
+                     body[-1].kind == token_kinds.pound_pound):
+            token = body[0] if body[0].kind == token_kinds.pound_pound \
+                else body[-1]
+            err = "'##' cannot appear at either end of a macro expansion"
+            raise CompilerError(err, token.r)
+
+        if params is not None:
+            for j, token in enumerate(body):
+                if token.kind == token_kinds.pound and (
+                        j + 1 == len(body) or
+                        body[j + 1].content not in params):
+                    err = "'#' is not followed by a macro parameter"
+                    raise CompilerError(err, token.r)
+
+        macro = Macro(name.content, params, variadic, body)
+        old = self.macros.get(name.content)
+        if old and not old.same(macro):
+            descrip = f"'{name.content}' redefined"
+            error_collector.add(CompilerError(descrip, name.r, True))
+
+        self.macros[name.content] = macro
+        self.memo.clear()
+
+    def undef(self, tokens):
+        """Process an #undef."""
+        name = self.macro_name(tokens, "undef")
+        _check_end(tokens, 3, "undef")
+        if self.macros.pop(name.content, None):
+            self.memo.clear()
+
+    def pragma(self, tokens, this_file):
+        """Process a #pragma. Pragmas other than `once` are ignored."""
+        if (len(tokens) == 3 and tokens[2].kind == token_kinds.identifier
+              and tokens[2].content == "once"):
+            self.once.add(os.path.realpath(this_file))
 
+    def macro_name(self, tokens, directive):
+        """Return the token of the macro name given to a directive."""
+        if len(tokens) < 3:
+            err = f"no macro name given in #{directive} directive"
+            raise CompilerError(err, tokens[0].r + tokens[1].r)
+        if tokens[2].kind not in name_kinds:
+            raise CompilerError("macro names must be identifiers",
+                                tokens[2].r)
+        return tokens[2]
 
-def process(tokens, this_file):
-    """Process the given tokens and return the preprocessed token list."""
+    def expand(self, tokens):
+        """Return the given tokens with the macros in them expanded."""
+        for token in tokens:
+            if token.kind in name_kinds and token.content in self.macros:
+                break
+        else:
+            return tokens
+
+        items = [(token, no_macros) for token in tokens]
+        return [token for token, _ in self._expand(items, False)[0]]
+
+    def _expand(self, items, alone):
+        """Expand the macros in a list of tokens and their hide sets.
 
-    processed = []
-    i = 0
-    while i < len(tokens) - 2:
-        if (tokens[i].kind == token_kinds.pound and
-            tokens[i + 1].kind == token_kinds.identifier and
-            tokens[i + 1].content == "include" and
-             tokens[i + 2].kind == token_kinds.include_file):
+        alone (bool) - Whether the tokens are expanded apart from the tokens
+        after them, as a macro argument or the replacement of an object-like
+        macro is.
+        returns - the expanded tokens and hide sets, and whether the
+        expansion may change given the tokens after them, because the last
+        is the name of a function-like macro
+        """
+        out = []
+        stack = items[::-1]
+        while stack:
+            token, hide = stack.pop()
+            macro = None
+            if token.kind in name_kinds and token.content not in hide:
+                macro = self.macros.get(token.content)
+
+            if not macro:
+                out.append((token, hide))
+                continue
 
-            # Replace tokens[i] -> tokens[i+2] with preprocessed contents of
-            # the included file.
             try:
-                file, filename = read_file(tokens[i + 2].content, this_file)
-                new_tokens = process(lexer.tokenize(file, filename), filename)
-                processed += new_tokens
+                if macro.params is None:
+                    stack += reversed(self._expand_object(macro, token, hide))
+                    continue
+
+                if not stack:
+                    out.append((token, hide))
+                    if alone:
+                        return out, True
+                    continue
+                if stack[-1][0].kind != token_kinds.open_paren:
+                    out.append((token, hide))
+                    continue
+
+                args = self._read_args(macro, token, stack, alone)
+                if args is None:
+                    out.append((token, hide))
+                    out += stack[::-1]
+                    return out, True
+
+                args, close_hide, end = args
+                hide = (hide & close_hide) | {macro.name}
+                replaced = self._replace(macro, token, args, hide)
+                del stack[end:]
+                stack += reversed(replaced)
+
+            except CompilerError as e:
+                error_collector.add(e)
+                out.append((token, hide))
+
+        return out, False
+
+    def _expand_object(self, macro, site, hide):
+        """Return the replacement of an object-like macro, to rescan.
+
+        If it can be, the replacement is returned expanded already, from the
+        memo if it is there.
+        """
+        key = (macro.name, hide)
+        expansion = self.memo.get(key)
+        if expansion is not None:
+            return [(Token(token.kind, token.content, token.rep, site.r),
+                     token_hide) for token, token_hide in expansion]
+
+        replaced = self._replace(macro, site, [], hide | {macro.name})
+        if key in self.memo:
+            return replaced
+
+        # Errors found expanding the replacement alone are found again when
+        # it is rescanned, if it must be, and a replacement with errors is
+        # not memoized, so they are reported again at each use.
+        count = len(error_collector.issues)
+        expansion, depends = self._expand(replaced, True)
+        if depends:
+            error_collector.truncate(count)
+            self.memo[key] = None
+            return replaced
+        if len(error_collector.issues) == count:
+            self.memo[key] = expansion
+        return expansion
+
+    def _read_args(self, macro, site, stack, alone):
+        """Read the arguments of a function-like macro from the stack.
+
+        The top of the stack is the `(` which begins the arguments.
+
+        returns - the list of arguments, each a list of tokens and hide sets,
+        the hide set of the `)` which ends the arguments, and the index of
+        that `)` in the stack, or None if the arguments do not end in the
+        tokens expanded alone
+        """
+        args = [[]]
+        depth = 0
+        nparams = len(macro.params)
+        for index in range(len(stack) - 2, -1, -1):
+            token, hide = stack[index]
+            if token.kind == token_kinds.open_paren:
+                depth += 1
+            elif token.kind == token_kinds.close_paren:
+                if not depth:
+                    break
+                depth -= 1
+            elif (token.kind == token_kinds.comma and not depth and
+                  not (macro.variadic and len(args) == nparams)):
+                args.append([])
+                continue
+            args[-1].append((token, hide))
+        else:
+            if alone:
+                return None
+            err = f"unterminated argument list invoking macro '{macro.name}'"
+            raise CompilerError(err, site.r)
+
+        if nparams == 0 and args == [[]]:
+            args = []
+        elif macro.variadic and len(args) == nparams - 1:
+            args.append([])
+        if len(args) != nparams:
+            plural = "" if nparams == 1 else "s"
+            err = (f"macro '{macro.name}' requires {nparams} argument"
+                   f"{plural}, but {len(args)} given")
+            raise CompilerError(err, site.r)
+        return args, hide, index
+
+    def _replace(self, macro, site, args, hide):
+        """Return the replacement of a macro with the given arguments.
+
+        Each argument is expanded, unless it is an operand of `#` or `##`.
+        The tokens of the replacement which are not from an argument have the
+        range of the macro name `site`, and all have `hide` added to their
+        hide sets.
+        """
+        params = macro.params or []
+        body = macro.body
+        expanded = {}
+
+        # List of lists of tokens and hide sets, and the `##` operators
+        # between them. An empty argument of `##` is a placemarker, `None`.
+        parts = []
+        for i, token in enumerate(body):
+            param = params.index(token.content) \
+                if token.content in params else None
+            pasted = ((i > 0 and
+                       body[i - 1].kind == token_kinds.pound_pound) or
+                      (i + 1 < len(body) and
+                       body[i + 1].kind == token_kinds.pound_pound))
+
+            if token.kind == token_kinds.pound_pound:
+                parts.append(token_kinds.pound_pound)
+            elif i > 0 and body[i - 1].kind == token_kinds.pound and params:
+                continue
+            elif token.kind == token_kinds.pound and params:
+                arg = args[params.index(body[i + 1].content)]
+                parts.append([(_stringize(arg, site), hide)])
+            elif param is not None and pasted:
+                parts.append(args[param] or [(None, hide)])
+            elif param is not None:
+                if param not in expanded:
+                    expanded[param] = self._expand(args[param], True)[0]
+                parts.append(expanded[param])
+            else:
+                parts.append([(Token(token.kind, token.content, token.rep,
+                                     site.r), hide)])
+
+        out = []
+        paste = False
+        for part in parts:
+            if part is token_kinds.pound_pound:
+                paste = True
+                continue
+            if paste:
+                left = out.pop()[0]
+                out.append((_paste(left, part[0][0], site), hide))
+                part = part[1:]
+                paste = False
+            out += part
+        return [(token, token_hide | hide) for token, token_hide in out
+                if token is not None]
+
+
+def _read_params(tokens, i):
+    """Read the parameters of a function-like macro.
+
+    tokens[i] is the `(` which begins the parameters.
+    returns - the list of parameter names, whether the macro is variadic,
+    and the index of the first token after the parameters
+    """
+    params = []
+    variadic = False
+    i += 1
+    while True:
+        if i < len(tokens) and tokens[i].kind == token_kinds.close_paren \
+           and not params:
+            return params, variadic, i + 1
+
+        if i < len(tokens) and tokens[i].kind == token_kinds.ellipsis:
+            params.append("__VA_ARGS__")
+            variadic = True
+        elif (i < len(tokens) and tokens[i].kind in name_kinds and
+              tokens[i].content not in params):
+            params.append(tokens[i].content)
+        else:
+            token = tokens[min(i, len(tokens) - 1)]
+            raise CompilerError("invalid macro parameter list", token.r)
+
+        i += 1
+        if i < len(tokens) and tokens[i].kind == token_kinds.close_paren:
+            return params, variadic, i + 1
+        if (i >= len(tokens) or tokens[i].kind != token_kinds.comma or
+              variadic):
+            token = tokens[min(i, len(tokens) - 1)]
+            raise CompilerError("invalid macro parameter list", token.r)
+        i += 1
+
+
+def _stringize(arg, site):
+    """Return the string token made by `#` from an argument."""
+    text = ""
+    rep = ""
+    for i, (token, _) in enumerate(arg):
+        if i and _spaced(arg[i - 1][0], token):
+            text += " "
+            rep += " "
+        spelled = str(token)
+        text += spelled
+        if token.kind in {token_kinds.string, token_kinds.char_string}:
+            spelled = spelled.replace("\\", "\\\\").replace('"', '\\"')
+        rep += spelled
+
+    chars = [ord(c) for c in text] + [0]
+    return Token(token_kinds.string, chars, '"' + rep + '"', r=site.r)
+
+
+def _paste(left, right, site):
+    """Return the token made by `##` from two tokens.
 
-            except IOError:
-                error_collector.add(CompilerError(
-                    "unable to read included file",
-                    tokens[i + 2].r
-                ))
+    Either token may be None, for an empty argument.
+    """
+    if left is None or right is None:
+        token = right if left is None else left
+        return token and Token(token.kind, token.content, token.rep, site.r)
+
+    text = str(left) + str(right)
+    count = len(error_collector.issues)
+    tokens = lexer.tokenize(text, site.r.start.file)
+    if len(tokens) != 1 or len(error_collector.issues) != count:
+        error_collector.truncate(count)
+        err = f"pasting '{left}' and '{right}' does not give a valid token"
+        raise CompilerError(err, site.r)
+    return Token(tokens[0].kind, tokens[0].content, tokens[0].rep, site.r)
+
+
+def _adjacent(first, second):
+    """Return whether no space separates two tokens read from a file."""
+    end, start = first.r.end, second.r.start
+    return end.source is start.source and start.index == end.index + 1
+
+
+def _spaced(first, second):
+    """Return whether space separates two tokens, as far as is known."""
+    end, start = first.r.end, second.r.start
+    return end.source is not start.source or start.index > end.index + 1
+
+
+def _spell(tokens, space):
+    """Return the text of a list of tokens, each after a space if spaced.
+
+    space (str) - Text to put before the first token.
+    """
+    text = space if tokens else ""
+    for i, token in enumerate(tokens):
+        if i and _spaced(tokens[i - 1], token):
+            text += " "
+        text += str(token)
+    return text
+
+
+def _directive_name(tokens):
+    """Return the name of the directive on a line, or None if it has none.
+
+    tokens (List[Token]) - Tokens of the line.
+    """
+    if (len(tokens) > 1 and tokens[0].kind == token_kinds.pound and
+          tokens[1].kind in name_kinds):
+        return tokens[1].content
+    return None
 
-            i += 3
 
+def _check_end(tokens, end, directive):
+    """Warn if there are tokens after tokens[end - 1] in a directive."""
+    if len(tokens) > end:
+        descrip = f"extra tokens at end of #{directive} directive"
+        error_collector.add(CompilerError(descrip, tokens[end].r, True))
+
+
+class _Evaluator:
+    """Evaluator of the expression of an #if or #elif directive.
+
+    The value is computed as an intmax_t, which for ShivyC is a `long`.
+    Each identifier left after the macros are expanded has the value 0.
+    """
+
+    # Binary operators, by precedence from lowest to highest.
+    binary = [{token_kinds.bool_or},
+              {token_kinds.bool_and},
+              {token_kinds.pipe},
+              {token_kinds.caret},
+              {token_kinds.amp},
+              {token_kinds.twoequals, token_kinds.notequal},
+              {token_kinds.lt, token_kinds.gt, token_kinds.ltoe,
+               token_kinds.gtoe},
+              {token_kinds.lbitshift, token_kinds.rbitshift},
+              {token_kinds.plus, token_kinds.minus},
+              {token_kinds.star, token_kinds.slash, token_kinds.mod}]
+
+    def __init__(self, tokens):
+        """Initialize _Evaluator."""
+        self.tokens = tokens
+        self.index = 0
+
+    def value(self):
+        """Return the value of the expression."""
+        value = self.parse_conditional(True)
+        if self.index < len(self.tokens):
+            token = self.tokens[self.index]
+            err = f"unexpected token '{token}' in preprocessor expression"
+            raise CompilerError(err, token.r)
+        return value
+
+    def next(self):
+        """Return the next token, or raise an error at the end."""
+        if self.index == len(self.tokens):
+            err = "expected value in preprocessor expression"
+            raise CompilerError(err, self.tokens[-1].r)
+        token = self.tokens[self.index]
+        self.index += 1
+        return token
+
+    def parse_conditional(self, live):
+        """Parse a conditional expression, like `a ? b : c`.
+
+        live (bool) - Whether the value is used, as in parse_binary. Only
+        the arm chosen is live.
+        """
+        cond = self.parse_binary(0, live)
+        if (self.index == len(self.tokens) or
+              self.tokens[self.index].kind != token_kinds.question):
+            return cond
+
+        question = self.next()
+        true_value = self.parse_conditional(live and bool(cond))
+        if (self.index == len(self.tokens) or
+              self.tokens[self.index].kind != token_kinds.colon):
+            err = "expected ':' in preprocessor expression"
+            raise CompilerError(err, question.r)
+        self.index += 1
+        false_value = self.parse_conditional(live and not cond)
+        return true_value if cond else false_value
+
+    def parse_binary(self, level, live):
+        """Parse an expression of binary operators from `level` up.
+
+        live (bool) - Whether the value is used. An operand of `&&` or `||`
+        which is not evaluated is not checked for division by zero.
+        """
+        if level == len(self.binary):
+            return self.parse_unary(live)
+
+        left = self.parse_binary(level + 1, live)
+        while (self.index < len(self.tokens) and
+               self.tokens[self.index].kind in self.binary[level]):
+            op = self.tokens[self.index]
+            self.index += 1
+            if op.kind == token_kinds.bool_or:
+                right = self.parse_binary(level + 1, live and not left)
+                left = int(bool(left or right))
+            elif op.kind == token_kinds.bool_and:
+                right = self.parse_binary(level + 1, live and bool(left))
+                left = int(bool(left and right))
+            else:
+                right = self.parse_binary(level + 1, live)
+                left = self.apply(op, left, right, live)
+        return left
+
+    def apply(self, op, left, right, live):
+        """Return the value of a binary operator on two values."""
+        kind = op.kind
+        if kind in {token_kinds.slash, token_kinds.mod} and right == 0:
+            if live:
+                raise CompilerError("division by zero in preprocessor "
+                                    "expression", op.r)
+            return 0
+
+        if kind == token_kinds.slash:
+            value = abs(left) // abs(right)
+            value = -value if (left < 0) != (right < 0) else value
+        elif kind == token_kinds.mod:
+            value = abs(left) % abs(right)
+            value = -value if left < 0 else value
+        elif kind in {token_kinds.lbitshift, token_kinds.rbitshift}:
+            shift = right % 64
+            value = left << shift if kind == token_kinds.lbitshift \
+                else left >> shift
         else:
-            processed.append(tokens[i])
-            i += 1
+            value = {token_kinds.amp: lambda: left & right,
+                     token_kinds.pipe: lambda: left | right,
+                     token_kinds.caret: lambda: left ^ right,
+                     token_kinds.twoequals: lambda: int(left == right),
+                     token_kinds.notequal: lambda: int(left != right),
+                     token_kinds.lt: lambda: int(left < right),
+                     token_kinds.gt: lambda: int(left > right),
+                     token_kinds.ltoe: lambda: int(left <= right),
+                     token_kinds.gtoe: lambda: int(left >= right),
+                     token_kinds.plus: lambda: left + right,
+                     token_kinds.minus: lambda: left - right,
+                     token_kinds.star: lambda: left * right}[kind]()
+        return ctypes.in_range(value, ctypes.longint)
 
-    return processed + tokens[i:]
+    def parse_unary(self, live):
+        """Parse a unary expression."""
+        token = self.next()
+        kind = token.kind
+        if kind == token_kinds.plus:
+            return self.parse_unary(live)
+        elif kind == token_kinds.minus:
+            return ctypes.in_range(-self.parse_unary(live), ctypes.longint)
+        elif kind == token_kinds.compl:
+            return ~self.parse_unary(live)
+        elif kind == token_kinds.bool_not:
+            return int(not self.parse_unary(live))
+        elif kind == token_kinds.open_paren:
+            value = self.parse_conditional(live)
+            if (self.index == len(self.tokens) or
+                  self.tokens[self.index].kind != token_kinds.close_paren):
+                err = "expected ')' in preprocessor expression"
+                raise CompilerError(err, token.r)
+            self.index += 1
+            return value
+        elif kind == token_kinds.number and token.content.isdigit():
+            return ctypes.in_range(int(token.content), ctypes.longint)
+        elif kind == token_kinds.number:
+            err = "floating constant in preprocessor expression"
+            raise CompilerError(err, token.r)
+        elif kind == token_kinds.char_string:
+            return token.content[0] if token.content else 0
+        elif kind in name_kinds:
+            return 0
+        else:
+            err = f"unexpected token '{token}' in preprocessor expression"
+            raise CompilerError(err, token.r)
 
 
-def read_file(include_file, this_file):
-    """Read the text of the given include file.
+def read_lines(path):
+    """Return the Lines of the file at the given path.
 
-    include_file - the header name, including opening and closing quotes or
-    angle brackets.
-    this_file - location of the current file being preprocessed. used for
-    locating quoted headers.
+    The lines are cached by the path and modification time of the file.
     """
+    key = (path, os.stat(path).st_mtime_ns)
+    if key not in header_lines:
+        with open(path) as file:
+            header_lines[key] = lexer.Lines(file.read(), path)
+    return header_lines[key]
 
+
+def find_file(include_file, this_file):
+    """Return the path of the given include file.
+
+    Quoted headers are looked up next to `this_file`, and bracketed headers
+    in the headers bundled with ShivyC.
+    """
     if include_file[0] == '"':
         path = pathlib.Path(this_file).parent.joinpath(include_file[1:-1])
     else:  # path is an include file
-        path = pathlib.Path(__file__).parent\
-            .joinpath("include").joinpath(include_file[1:-1])
-
-    with open(str(path)) as file:
-        return file.read(), str(path)
+        path = include_dir.joinpath(include_file[1:-1])
+    return str(path)
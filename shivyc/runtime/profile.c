@@ -0,0 +1,58 @@
+// Runtime of programs built with -fprofile-generate.
+//
+// Each instrumented function registers its array of counters on its first
+// run. When the program exits, the counts of each function registered are
+// appended to its profile file, on a line with the name of the function,
+// the number of counters, and the count of each block. The first element
+// of an array of counters is set once it is registered, and its counters
+// follow.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The C library has on_exit, but atexit only in a part which is not linked.
+int on_exit(void (*)(int, void*), void*);
+
+struct record {
+  unsigned long* counters;
+  char* name;
+  long size;
+  char* file;
+  struct record* next;
+};
+
+static struct record* records;
+
+static void dump(int status, void* arg) {
+  FILE* out = 0;
+  char* file = 0;
+  for(struct record* r = records; r; r = r->next) {
+    if(!file || strcmp(file, r->file)) {
+      if(out) fclose(out);
+      file = r->file;
+      out = fopen(file, "a");
+    }
+    if(!out) continue;
+
+    fprintf(out, "%s %ld", r->name, r->size);
+    for(long i = 1; i <= r->size; i++) fprintf(out, " %lu", r->counters[i]);
+    fprintf(out, "\n");
+  }
+  if(out) fclose(out);
+}
+
+void __shivyc_profile_add(unsigned long* counters, char* name, long size,
+                          char* file) {
+  struct record* r = malloc(sizeof(struct record));
+  if(!r) return;
+  if(!records) on_exit(dump, 0);
+
+  r->counters = counters;
+  r->name = name;
+  r->size = size;
+  r->file = file;
+  r->next = records;
+  records = r;
+  counters[0] = 1;
+}
@@ -0,0 +1,404 @@
+"""List scheduling of generated ASM code.
+
+The code of each IL command is emitted in order, so a value is often used
+by the command right after the one loading it, and the processor waits for
+the load. The scheduler reorders the commands between two barriers, like a
+label, a jump, or a call, so that the commands using a result are moved
+away from the command computing it where other work can fill the gap.
+
+Each command is given the registers, flags, and memory it reads and writes.
+A command must stay after the last command writing something it reads or
+writes, and after every command reading something it writes. The latency of
+each command is looked up in the table of the microarchitecture chosen with
+-mtune, and the commands are issued one per cycle, each time taking the
+ready command with the longest chain of latencies after it. A block keeps
+its order unless the new order is estimated to take fewer cycles.
+
+Any command the scheduler does not know is treated as a barrier.
+"""
+
+import shivyc.asm_cmds as asm_cmds
+import shivyc.spots as spots
+from shivyc.spots import MemSpot, RegSpot, XMMSpot
+
+# Latencies in cycles of each kind of command, for each microarchitecture
+# -mtune may choose. A command reading memory takes the "load" latency
+# more. The "move" kind is a move between a general and an SSE register.
+latencies = {
+    "generic": {"alu": 1, "load": 5, "imul": 3, "div": 26, "fadd": 4,
+                "fmul": 4, "fdiv": 14, "convert": 5, "move": 3,
+                "vmul": 10},
+    "skylake": {"alu": 1, "load": 5, "imul": 3, "div": 26, "fadd": 4,
+                "fmul": 4, "fdiv": 13, "convert": 5, "move": 2,
+                "vmul": 10},
+    "znver3": {"alu": 1, "load": 4, "imul": 3, "div": 14, "fadd": 3,
+               "fmul": 3, "fdiv": 13, "convert": 4, "move": 3,
+               "vmul": 3},
+}
+
+# Name under which the flags are tracked, like a register.
+FLAGS = "flags"
+
+# Kind of each command whose latency is not that of a simple ALU command.
+_kinds = {asm_cmds.Imul: "imul", asm_cmds.Mul: "imul",
+          asm_cmds.Div: "div", asm_cmds.Idiv: "div",
+          asm_cmds.Adds: "fadd", asm_cmds.Subs: "fadd",
+          asm_cmds.Ucomis: "fadd", asm_cmds.Muls: "fmul",
+          asm_cmds.Divs: "fdiv", asm_cmds.Cvtsi2s: "convert",
+          asm_cmds.Cvtts2si: "convert", asm_cmds.Cvts2s: "convert",
+          asm_cmds.Movd: "move", asm_cmds.Pmullw: "vmul",
+          asm_cmds.Pmulld: "vmul"}
+
+# Commands computing dest from dest and source which set the flags.
+_arith = (asm_cmds.Add, asm_cmds.Sub, asm_cmds.And, asm_cmds.Or,
+          asm_cmds.Xor)
+
+# Commands counting or scanning the bits of source into dest.
+_bit_counts = (asm_cmds.Popcnt, asm_cmds.Tzcnt, asm_cmds.Lzcnt,
+               asm_cmds.Bsf, asm_cmds.Bsr)
+
+# Vector commands whose dest does not depend on its old value.
+_vector_moves = (asm_cmds.Movdqu, asm_cmds.Movdqa, asm_cmds.Pshufd)
+
+
+class _Effects:
+    """What one ASM command reads and writes.
+
+    reads, writes (Set) - Registers and FLAGS read and written.
+    loads, stores (List) - Memory read and written, as tuples of a MemSpot
+    and the number of bytes accessed.
+    """
+
+    def __init__(self):
+        self.reads = set()
+        self.writes = set()
+        self.loads = []
+        self.stores = []
+
+    def read(self, spot, size):
+        """Record that the command reads `size` bytes at `spot`."""
+        if isinstance(spot, (RegSpot, XMMSpot)):
+            self.reads.add(spot)
+        elif isinstance(spot, MemSpot):
+            self.reads.update(_address_regs(spot))
+            self.loads.append((spot, size))
+
+    def write(self, spot, size):
+        """Record that the command writes `size` bytes at `spot`.
+
+        A write of one or two bytes to a general register keeps the rest of
+        it, so the command also reads the register.
+        """
+        if isinstance(spot, RegSpot):
+            self.writes.add(spot)
+            if size in {1, 2}:
+                self.reads.add(spot)
+        elif isinstance(spot, XMMSpot):
+            self.writes.add(spot)
+        elif isinstance(spot, MemSpot):
+            self.reads.update(_address_regs(spot))
+            self.stores.append((spot, size))
+
+
+def _address_regs(spot):
+    """Return the registers used to compute the address of a memory spot."""
+    return [s for s in (spot.base, spot.count) if isinstance(s, RegSpot)]
+
+
+def effects(line):
+    """Return the _Effects of ASM command `line`, or None if it is a
+    barrier, which no command may be moved across.
+    """
+    e = _Effects()
+    if isinstance(line, asm_cmds.Lea):
+        e.reads.update(_address_regs(line.source))
+        e.write(line.dest, 8)
+    elif isinstance(line, asm_cmds.Mov):
+        e.read(line.source, line.size)
+        e.write(line.dest, line.size)
+    elif isinstance(line, (asm_cmds.Movsx, asm_cmds.Movzx)):
+        # The third argument of the command is the size of dest.
+        e.read(line.source, line.dest_size)
+        e.write(line.dest, line.source_size)
+    elif isinstance(line, (asm_cmds.Sal, asm_cmds.Sar, asm_cmds.Shr,
+                           asm_cmds.Rol, asm_cmds.Ror)):
+        # A shift or rotate by zero leaves the flags as they were.
+        e.read(line.dest, line.source_size)
+        e.read(line.source, line.dest_size)
+        e.write(line.dest, line.source_size)
+        e.reads.add(FLAGS)
+        e.writes.add(FLAGS)
+    elif isinstance(line, asm_cmds.Setcc):
+        e.reads.add(FLAGS)
+        e.write(line.dest, 1)
+    elif isinstance(line, asm_cmds.Cmov):
+        e.reads.add(FLAGS)
+        e.read(line.dest, line.size)
+        e.read(line.source, line.size)
+        e.write(line.dest, line.size)
+    elif isinstance(line, (asm_cmds.Cmp, asm_cmds.Test, asm_cmds.Ucomis)):
+        e.read(line.dest, line.size)
+        e.read(line.source, line.size)
+        e.writes.add(FLAGS)
+    elif isinstance(line, _arith) or (isinstance(line, asm_cmds.Imul)
+                                      and line.source):
+        e.read(line.dest, line.size)
+        e.read(line.source, line.size)
+        e.write(line.dest, line.size)
+        e.writes.add(FLAGS)
+    elif isinstance(line, (asm_cmds.Inc, asm_cmds.Dec, asm_cmds.Neg,
+                           asm_cmds.Not)):
+        # An inc or dec keeps the carry flag, and a not keeps all flags.
+        e.read(line.dest, line.size)
+        e.write(line.dest, line.size)
+        if not isinstance(line, asm_cmds.Neg):
+            e.reads.add(FLAGS)
+        if not isinstance(line, asm_cmds.Not):
+            e.writes.add(FLAGS)
+    elif isinstance(line, _bit_counts):
+        # A bsf or bsr of zero leaves dest as it was.
+        if isinstance(line, (asm_cmds.Bsf, asm_cmds.Bsr)):
+            e.read(line.dest, line.size)
+        e.read(line.source, line.size)
+        e.write(line.dest, line.size)
+        e.writes.add(FLAGS)
+    elif isinstance(line, asm_cmds.Bswap):
+        e.read(line.dest, line.size)
+        e.write(line.dest, line.size)
+    elif isinstance(line, (asm_cmds.Mul, asm_cmds.Imul, asm_cmds.Div,
+                           asm_cmds.Idiv)):
+        e.read(line.dest, line.size)
+        e.reads |= {spots.RAX, spots.RDX}
+        e.writes |= {spots.RAX, spots.RDX, FLAGS}
+    elif isinstance(line, (asm_cmds.Cdq, asm_cmds.Cqo)):
+        e.reads.add(spots.RAX)
+        e.writes.add(spots.RDX)
+    elif isinstance(line, asm_cmds.Xchg):
+        # An xchg with memory is atomic, and so a barrier.
+        if any(isinstance(spot, MemSpot)
+               for spot in (line.dest, line.source)):
+            return None
+        for spot in (line.dest, line.source):
+            e.read(spot, line.size)
+            e.write(spot, line.size)
+    elif isinstance(line, asm_cmds._ScalarCommand):
+        e.read(line.dest, line.size)
+        e.read(line.source, line.size)
+        e.write(line.dest, line.size)
+    elif isinstance(line, asm_cmds._Convert):
+        # A conversion to an SSE register keeps the rest of the register.
+        e.read(line.source, line.source_size)
+        if isinstance(line.dest, XMMSpot):
+            e.read(line.dest, line.dest_size)
+        e.write(line.dest, line.dest_size)
+    elif isinstance(line, asm_cmds.Movd):
+        e.read(line.source, line.size)
+        e.write(line.dest, 16)
+    elif isinstance(line, asm_cmds.Vpbroadcast):
+        e.read(line.source, 16)
+        e.write(line.dest, 32)
+    elif isinstance(line, asm_cmds._VectorCommand):
+        e.read(line.source, line.size)
+        if line.first:
+            e.read(line.first, line.size)
+        elif not isinstance(line, _vector_moves):
+            e.read(line.dest, line.size)
+        e.write(line.dest, line.size)
+    else:
+        return None
+    return e
+
+
+def _may_alias(access1, access2):
+    """Return whether two memory accesses may overlap.
+
+    Accesses off the same frame register or label at constant offsets
+    overlap only if their bytes do, and accesses of two different labels
+    never overlap. Any other accesses may.
+    """
+    (spot1, size1), (spot2, size2) = access1, access2
+    base1, base2 = spot1.base, spot2.base
+    if isinstance(base1, str) and isinstance(base2, str) and base1 != base2:
+        return False
+    if base1 != base2 or spot1.count or spot2.count:
+        return True
+    if not (isinstance(base1, str) or base1 in (spots.RBP, spots.RSP)):
+        return True
+    start1 = spot1.offset + spot1.chunk
+    start2 = spot2.offset + spot2.chunk
+    return start1 < start2 + size2 and start2 < start1 + size1
+
+
+class Scheduler:
+    """List scheduler of ASM code.
+
+    tune (str) - Name of the microarchitecture whose latencies are used.
+    """
+
+    def __init__(self, tune):
+        """Initialize the scheduler for the microarchitecture `tune`."""
+        self.latency = latencies[tune]
+
+    def schedule(self, lines):
+        """Return the given list of ASM commands, scheduled."""
+        new_lines = []
+        block = []
+        for line in lines:
+            if isinstance(line, asm_cmds.Comment):
+                block.append(line)
+                continue
+            e = effects(line)
+            if e is None:
+                new_lines += self._schedule_block(block)
+                new_lines.append(line)
+                block = []
+            else:
+                block.append((line, e))
+        new_lines += self._schedule_block(block)
+        return new_lines
+
+    def _schedule_block(self, block):
+        """Return the commands of a block between two barriers, scheduled.
+
+        block - list of the comments and the tuples of each other command
+        and its _Effects. A comment stays just before the command after it.
+        """
+        nodes = []
+        comments = []
+        for item in block:
+            if isinstance(item, asm_cmds.Comment):
+                comments.append(item)
+            else:
+                nodes.append((comments, item[0], item[1]))
+                comments = []
+        if len(nodes) < 3:
+            return _block_lines(block)
+
+        latency = [self._latency(line, e) for _, line, e in nodes]
+        preds = self._dependences(nodes, latency)
+        succs = [[] for _ in nodes]
+        for j, node_preds in enumerate(preds):
+            for i, lat in node_preds.items():
+                succs[i].append((j, lat))
+
+        # Length of the longest chain of latencies from each command to the
+        # end of the block.
+        height = [0] * len(nodes)
+        for i in reversed(range(len(nodes))):
+            height[i] = max([latency[i]] + [lat + height[j]
+                                            for j, lat in succs[i]])
+
+        order = self._list_schedule(preds, succs, height)
+        if (self._cycles(order, preds, latency)
+              >= self._cycles(range(len(nodes)), preds, latency)):
+            return _block_lines(block)
+
+        lines = []
+        for i in order:
+            node_comments, line, _ = nodes[i]
+            lines += node_comments + [line]
+        return lines + comments
+
+    def _latency(self, line, e):
+        """Return the latency of command `line` with _Effects `e`."""
+        latency = self.latency[_kinds.get(type(line), "alu")]
+        if isinstance(line, asm_cmds.Mov) and line.sse_name() in {"movd",
+                                                                 "movq"}:
+            latency = self.latency["move"]
+        if e.loads and not isinstance(line, asm_cmds.Lea):
+            latency += self.latency["load"]
+        return latency
+
+    @staticmethod
+    def _dependences(nodes, latency):
+        """Return a map from the index of each command the command at each
+        index must follow to the cycles it must follow it by.
+        """
+        preds = [{} for _ in nodes]
+        last_write = {}
+        reads_since = {}
+        stores = []
+        loads = []
+
+        def add(i, j, lat):
+            preds[j][i] = max(preds[j].get(i, 0), lat)
+
+        for j, (_, _, e) in enumerate(nodes):
+            for r in e.reads:
+                if r in last_write:
+                    add(last_write[r], j, latency[last_write[r]])
+            for r in e.writes:
+                if r in last_write:
+                    add(last_write[r], j, 0)
+                for i in reads_since.get(r, []):
+                    if i != j:
+                        add(i, j, 0)
+
+            for access in e.loads:
+                for i, other in stores:
+                    if _may_alias(access, other):
+                        add(i, j, latency[i])
+            for access in e.stores:
+                for i, other in stores + loads:
+                    if i != j and _may_alias(access, other):
+                        add(i, j, 0)
+
+            for r in e.reads:
+                reads_since.setdefault(r, []).append(j)
+            for r in e.writes:
+                last_write[r] = j
+                reads_since[r] = []
+            loads += [(j, access) for access in e.loads]
+            stores += [(j, access) for access in e.stores]
+        return preds
+
+    @staticmethod
+    def _list_schedule(preds, succs, height):
+        """Return the order to issue the commands in.
+
+        Each cycle, the ready command with the greatest height whose inputs
+        are available is issued, or if none are available, the cycle is
+        skipped to when the first one is.
+        """
+        waiting = [len(node_preds) for node_preds in preds]
+        earliest = [0] * len(preds)
+        ready = [i for i, n in enumerate(waiting) if not n]
+        order = []
+        cycle = 0
+        while ready:
+            available = [i for i in ready if earliest[i] <= cycle]
+            if not available:
+                cycle = min(earliest[i] for i in ready)
+                continue
+            i = max(available, key=lambda i: (height[i], -i))
+            ready.remove(i)
+            order.append(i)
+            for j, lat in succs[i]:
+                earliest[j] = max(earliest[j], cycle + lat)
+                waiting[j] -= 1
+                if not waiting[j]:
+                    ready.append(j)
+            cycle += 1
+        return order
+
+    @staticmethod
+    def _cycles(order, preds, latency):
+        """Return the estimated cycles to run the commands in given order,
+        issuing at most one per cycle.
+        """
+        issued = {}
+        cycle = 0
+        for j in order:
+            start = max([cycle] + [issued[i] + lat
+                                   for i, lat in preds[j].items()])
+            issued[j] = start
+            cycle = start + 1
+        return max(issued[i] + latency[i] for i in issued)
+
+
+def _block_lines(block):
+    """Return the lines of a block given to Scheduler._schedule_block, in
+    their original order.
+    """
+    return [item if isinstance(item, asm_cmds.Comment) else item[0]
+            for item in block]
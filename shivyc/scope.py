@@ -0,0 +1,80 @@
+"""Table of names bound in nested scopes, for the parser and IL gen.
+
+A name may be bound in several of the open scopes at once, and refers to
+its binding in the innermost of them. Rather than keep a dictionary for
+each scope and search them from the innermost out, the table keeps one
+dictionary mapping each name to its chain of bindings, innermost last, so
+a name is looked up in constant time however deeply scopes are nested.
+Each scope lists the names bound in it, so that ending a scope removes just
+its own bindings from the chains.
+"""
+
+
+class ScopedTable:
+    """Map from names to the values bound to them in the scopes open.
+
+    The table starts with one scope open, the file scope.
+    """
+
+    def __init__(self):
+        """Initialize ScopedTable."""
+        # Map from each name bound to a list of (depth, value) tuples, for
+        # each scope the name is bound in, innermost last.
+        self.chains = {}
+
+        # List of the names bound in each open scope, innermost last.
+        self.scopes = [[]]
+
+    def new_scope(self):
+        """Open a new innermost scope."""
+        self.scopes.append([])
+
+    def end_scope(self):
+        """End the innermost scope.
+
+        returns - list of the (name, value) bindings made in the scope, in
+        the order the names were first bound
+        """
+        bindings = []
+        for name in self.scopes.pop():
+            chain = self.chains[name]
+            bindings.append((name, chain.pop()[1]))
+            if not chain:
+                del self.chains[name]
+        return bindings
+
+    def lookup(self, name, default=None):
+        """Return the value bound to `name` in the innermost scope it is."""
+        chain = self.chains.get(name)
+        return chain[-1][1] if chain else default
+
+    def lookup_local(self, name, default=None):
+        """Return the value bound to `name` in the innermost scope only."""
+        chain = self.chains.get(name)
+        if chain and chain[-1][0] == len(self.scopes):
+            return chain[-1][1]
+        return default
+
+    def bind(self, name, value):
+        """Bind `name` to `value` in the innermost scope.
+
+        returns - whether `name` was already bound in the innermost scope,
+        in which case its value is replaced
+        """
+        depth = len(self.scopes)
+        chain = self.chains.setdefault(name, [])
+        if chain and chain[-1][0] == depth:
+            chain[-1] = (depth, value)
+            return True
+
+        chain.append((depth, value))
+        self.scopes[-1].append(name)
+        return False
+
+    def unbind_last(self):
+        """Remove the binding last added to the innermost scope."""
+        name = self.scopes[-1].pop()
+        chain = self.chains[name]
+        chain.pop()
+        if not chain:
+            del self.chains[name]
@@ -0,0 +1,220 @@
+"""Compile server, which keeps the compiler loaded between compiles.
+
+Each run of shivyc starts Python, imports every module of the compiler,
+lexes the bundled headers the file includes, and searches for the files to
+link with, which takes longer than compiling a small file. Started with
+`shivyc --serve SOCKET`, the server does all that once and listens on the
+Unix socket SOCKET.
+
+The client, shivyc-client, takes the same flags as shivyc. It sends them
+to the server named by $SHIVYC_SERVER, along with its working directory,
+its environment, and its standard streams. The server forks a process for
+each request, which compiles as shivyc would with those, writing to the
+streams of the client directly, and sends back the exit status. Requests
+are thus compiled at once and apart from each other. The client imports
+only modules of the standard library, so it starts quickly, and if no
+server is listening, it compiles by itself.
+
+A request sets the directory and the environment the server compiles in,
+so only the user who started the server may make one. The socket is
+readable and writable only by that user, in a directory which is created
+accessible only to them if it does not exist, and the server drops any
+connection from a process of another user.
+
+Besides the modules, the server loads the lines of each bundled header, the
+precompiled state of each bundled header included first on its own, and the
+paths of the startup files it links with, before it forks.
+"""
+
+import array
+import json
+import os
+import signal
+import socket
+import socketserver
+import struct
+import sys
+
+# Environment variable naming the socket of the server the client sends to.
+SERVER_VAR = "SHIVYC_SERVER"
+
+# Files to link with which are searched for before forking.
+startup_files = ["crt1.o", "Scrt1.o", "crti.o", "crtn.o"]
+
+
+def client_main():
+    """Run the compiler through the server, or else by itself."""
+    path = os.environ.get(SERVER_VAR)
+    if path:
+        status = request(path, sys.argv[1:])
+        if status is not None:
+            return status
+
+    from shivyc.main import main
+    return main()
+
+
+def request(path, argv):
+    """Have the server listening on `path` compile with the given flags.
+
+    returns - the exit status, or None if no server is listening
+    """
+    sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    try:
+        sock.connect(path)
+    except OSError:
+        sock.close()
+        return None
+
+    message = json.dumps({"argv": argv, "cwd": os.getcwd(),
+                          "env": dict(os.environ)}).encode()
+    sys.stdout.flush()
+    sys.stderr.flush()
+    with sock:
+        fds = array.array("i", [0, 1, 2])
+        # A server of another user drops the connection.
+        try:
+            sock.sendmsg([struct.pack("!I", len(message))],
+                         [(socket.SOL_SOCKET, socket.SCM_RIGHTS, fds)])
+            sock.sendall(message)
+            reply = _read_all(sock)
+        except OSError:
+            reply = b""
+
+    try:
+        return int(reply)
+    except ValueError:
+        print("shivyc: error: compile server stopped before replying",
+              file=sys.stderr)
+        return 1
+
+
+def serve(path):
+    """Serve requests to compile on the Unix socket at `path`, until
+    interrupted.
+    """
+    import shivyc.main as main
+    _load(main)
+
+    os.makedirs(os.path.dirname(os.path.abspath(path)), mode=0o700,
+                exist_ok=True)
+    if os.path.exists(path):
+        os.unlink(path)
+    # The socket is created with mode 0600, so no other user may connect
+    # to it between its creation and a chmod.
+    umask = os.umask(0o177)
+    try:
+        server = _Server(path, _Handler)
+    finally:
+        os.umask(umask)
+
+    # The socket is removed however the server is stopped.
+    signal.signal(signal.SIGTERM, lambda signum, frame: sys.exit(0))
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        server.server_close()
+        os.unlink(path)
+    return 0
+
+
+def _load(main):
+    """Load what every compile needs, before the server forks."""
+    import shivyc.lexer as lexer
+    import shivyc.pch as pch
+    import shivyc.preproc as preproc
+    from shivyc.errors import error_collector
+
+    headers = sorted(preproc.include_dir.glob("*.h"))
+    for header in headers:
+        preproc.read_lines(str(header))
+    for header in headers:
+        line = f"#include <{header.name}>\n"
+        tokens = list(preproc.process(lexer.Lines(line, "<server>"),
+                                      "<server>"))
+        pch.load(tokens)
+    for file in startup_files:
+        main.find_library(file)
+    error_collector.clear()
+
+
+class _Server(socketserver.ForkingMixIn, socketserver.UnixStreamServer):
+    """Server which forks a process to compile each request."""
+
+    def verify_request(self, request, client_address):
+        """Accept a request only from a process of the user running the
+        server.
+        """
+        creds = request.getsockopt(socket.SOL_SOCKET, socket.SO_PEERCRED,
+                                   struct.calcsize("3i"))
+        _, uid, _ = struct.unpack("3i", creds)
+        return uid == os.getuid()
+
+
+class _Handler(socketserver.BaseRequestHandler):
+    """Handler of a request, which runs in the forked process."""
+
+    def handle(self):
+        """Compile with the flags, directory, environment, and streams of
+        the client, and send back the exit status.
+        """
+        from shivyc.main import main
+
+        signal.signal(signal.SIGTERM, signal.SIG_DFL)
+        header, fds = _recv_fds(self.request, 4)
+        length, = struct.unpack("!I", header)
+        message = b""
+        while len(message) < length:
+            data = self.request.recv(length - len(message))
+            if not data:
+                return
+            message += data
+        message = json.loads(message)
+
+        for stream, fd in enumerate(fds):
+            os.dup2(fd, stream)
+            os.close(fd)
+        os.chdir(message["cwd"])
+        os.environ.clear()
+        os.environ.update(message["env"])
+        sys.argv = ["shivyc"] + message["argv"]
+
+        try:
+            status = main()
+        except SystemExit as error:
+            status = error.code if isinstance(error.code, int) else (
+                0 if error.code is None else 1)
+        sys.stdout.flush()
+        sys.stderr.flush()
+        self.request.sendall(f"{status}\n".encode())
+
+
+def _recv_fds(sock, size):
+    """Receive `size` bytes along with the file descriptors sent with them.
+
+    returns - the bytes, and the list of file descriptors
+    """
+    fds = array.array("i")
+    data, ancdata, _, _ = sock.recvmsg(
+        size, socket.CMSG_LEN(3 * fds.itemsize))
+    for level, kind, cmsg_data in ancdata:
+        if level == socket.SOL_SOCKET and kind == socket.SCM_RIGHTS:
+            fds.frombytes(cmsg_data[:len(cmsg_data)
+                                    - len(cmsg_data) % fds.itemsize])
+    return data, list(fds)
+
+
+def _read_all(sock):
+    """Return all the bytes received on the socket until it is closed."""
+    chunks = []
+    while True:
+        data = sock.recv(4096)
+        if not data:
+            return b"".join(chunks)
+        chunks.append(data)
+
+
+if __name__ == "__main__":
+    sys.exit(client_main())
@@ -88,6 +88,10 @@ class RegSpot(Spot):
                "r9": ["r9", "r9d", "r9w", "r9b"],
                "r10": ["r10", "r10d", "r10w", "r10b"],
                "r11": ["r11", "r11d", "r11w", "r11b"],
+               "r12": ["r12", "r12d", "r12w", "r12b"],
+               "r13": ["r13", "r13d", "r13w", "r13b"],
+               "r14": ["r14", "r14d", "r14w", "r14b"],
+               "r15": ["r15", "r15d", "r15w", "r15b"],
                "rbp": ["rbp", "", "", ""],
                "rsp": ["rsp", "", "", ""]}
 
@@ -115,6 +119,25 @@ class RegSpot(Spot):
         return self.reg_map[self.name][i]
 
 
+class XMMSpot(Spot):
+    """Spot representing a 128-bit SSE register.
+
+    As an operand of 32 bytes, the spot is the 256-bit AVX register whose
+    low half is the SSE register, like ymm0 for xmm0.
+    """
+
+    def __init__(self, name):
+        """Initialize this spot.
+
+        `name` is the string representation of the register (e.g. "xmm0").
+        """
+        super().__init__(name)
+        self.name = name
+
+    def asm_str(self, size):  # noqa D102
+        return "y" + self.name[1:] if size == 32 else self.name
+
+
 class MemSpot(Spot):
     """Spot representing a region in memory, like on stack or .data section.
 
@@ -126,7 +149,9 @@ class MemSpot(Spot):
     size_map = {1: "BYTE PTR ",
                 2: "WORD PTR ",
                 4: "DWORD PTR ",
-                8: "QWORD PTR "}
+                8: "QWORD PTR ",
+                16: "XMMWORD PTR ",
+                32: "YMMWORD PTR "}
 
     def __init__(self, base, offset=0, chunk=0, count=None):  # noqa D102
         super().__init__((base, offset, chunk, count))
@@ -192,6 +217,87 @@ class MemSpot(Spot):
         return MemSpot(self.base, new_offset, new_chunk, new_count)
 
 
+class RipSpot(MemSpot):
+    """Spot representing memory at a label, addressed relative to RIP.
+
+    Position-independent code addresses the objects it defines this way,
+    like [rip+name+8]. An address relative to RIP takes no register, so
+    the spot can only be shifted by a literal count.
+    """
+
+    def __init__(self, base, offset=0):  # noqa D102
+        super().__init__(base, offset)
+
+    def asm_str(self, size):  # noqa D102
+        offset = f"{self.offset:+}" if self.offset else ""
+        size_desc = self.size_map.get(size, "")
+        return f"{size_desc}[rip+{self.base}{offset}]"
+
+    def shift(self, chunk, count=None):  # noqa D102
+        if isinstance(count, LiteralSpot):
+            chunk *= int(count.value)
+        elif count:
+            raise NotImplementedError("cannot shift by register count")
+        return self.__class__(self.base, self.offset + chunk)
+
+
+class GOTSpot(RipSpot):
+    """Spot representing the entry of the global offset table which holds
+    the address of the object or function at a label.
+
+    Position-independent code reaches through it what another module may
+    define, like QWORD PTR [rip+name@GOTPCREL]. The spot holds the address
+    rather than the value, so it is not shifted.
+    """
+
+    def asm_str(self, size):  # noqa D102
+        return f"QWORD PTR [rip+{self.base}@GOTPCREL]"
+
+    def shift(self, chunk, count=None):  # noqa D102
+        if chunk or count:
+            raise NotImplementedError("cannot shift a GOT entry")
+        return self
+
+
+class TLSSpot(MemSpot):
+    """Spot representing memory of a thread-local object at a label,
+    addressed relative to the thread pointer in the FS segment.
+
+    An executable places the thread-local objects it defines at offsets
+    from the thread pointer which the linker fixes, like
+    DWORD PTR fs:[name@tpoff+8], so they are reached in one instruction.
+    A lea of the spot, which is written without the segment since lea
+    ignores it, gives only the offset. The spot with no label is the first
+    word of the block of the thread, QWORD PTR fs:[0], which holds the
+    thread pointer itself.
+    """
+
+    def asm_str(self, size):  # noqa D102
+        base = f"{self.base}@tpoff" if self.base else "0"
+        spot = MemSpot(base, self.offset, self.chunk, self.count)
+        if not size:
+            return spot.asm_str(0)
+        return f"{self.size_map.get(size, '')}fs:{spot.asm_str(0)}"
+
+    def shift(self, chunk, count=None):  # noqa D102
+        spot = super().shift(chunk, count)
+        return TLSSpot(spot.base, spot.offset, spot.chunk, spot.count)
+
+
+class TLSGOTSpot(GOTSpot):
+    """Spot representing the entry of the global offset table which holds
+    the offset of a thread-local object from the thread pointer.
+
+    Code reaches through it the thread-local objects which another module
+    may define, and all of them in a shared object, like
+    QWORD PTR [rip+name@gottpoff]. The thread pointer is added to the
+    offset to make the address of the object.
+    """
+
+    def asm_str(self, size):  # noqa D102
+        return f"QWORD PTR [rip+{self.base}@gottpoff]"
+
+
 class LiteralSpot(Spot):
     """Spot representing a literal value.
 
@@ -208,10 +314,8 @@ class LiteralSpot(Spot):
         return str(self.value)
 
 
-# RBX is callee-saved, which is still unsupported
-# RBX = RegSpot("rbx")
-
 RAX = RegSpot("rax")
+RBX = RegSpot("rbx")
 RCX = RegSpot("rcx")
 RDX = RegSpot("rdx")
 RSI = RegSpot("rsi")
@@ -220,8 +324,46 @@ R8 = RegSpot("r8")
 R9 = RegSpot("r9")
 R10 = RegSpot("r10")
 R11 = RegSpot("r11")
-
-registers = [RAX, RCX, RDX, RSI, RDI, R8, R9, R10, R11]
+R12 = RegSpot("r12")
+R13 = RegSpot("r13")
+R14 = RegSpot("r14")
+R15 = RegSpot("r15")
+
+# Memory at the thread pointer, the address of the block of thread-local
+# objects of the running thread, which holds the thread pointer itself.
+THREAD_POINTER = TLSSpot(None)
+
+# Registers a called function may clobber, and registers a called function
+# must restore before returning.
+caller_saved = [RAX, RCX, RDX, RSI, RDI, R8, R9, R10, R11]
+callee_saved = [RBX, R12, R13, R14, R15]
+
+# Caller-saved registers come first so that functions only pay to save a
+# callee-saved register when they need one.
+registers = caller_saved + callee_saved
+
+# SSE registers. Floating values are allocated to all but the last two, so
+# IL commands may use XMM14 and XMM15 freely as scratch registers within
+# their own code. Every SSE register is caller-saved.
+xmm_registers = [XMMSpot(f"xmm{i}") for i in range(16)]
+float_registers = xmm_registers[:14]
+XMM0 = xmm_registers[0]
+XMM14 = xmm_registers[14]
+XMM15 = xmm_registers[15]
+
+# Registers a called function may clobber, of both classes.
+call_clobbered = caller_saved + float_registers
+
+# Register classes. Each value is allocated to the registers of its class,
+# and values of different classes never compete for a register.
+GENERAL = "general"
+SSE = "sse"
+class_registers = {GENERAL: registers, SSE: float_registers}
+
+
+def register_class(ctype):
+    """Return the class of the registers a value of given type is kept in."""
+    return SSE if ctype.is_floating() else GENERAL
 
 RBP = RegSpot("rbp")
 RSP = RegSpot("rsp")
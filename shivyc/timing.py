@@ -0,0 +1,169 @@
+"""Objects used for measuring the time each phase of the compiler takes.
+
+Like the error collector, there is a global instance of the timer, so each
+phase can be timed where it runs. A phase is timed by running it under
+`with timer.phase(name)`, which does nothing unless the timer is enabled.
+
+Phases run many times, such as once per function, and one phase may run
+within another, such as the lexing of a line while the file is
+preprocessed. The time of each phase is the total of its runs, less the
+time of any phase run within it, so the times of all phases add up to the
+time spent in phases at all.
+
+The timer also keeps counters of the work done, such as the number of
+tokens lexed or the number of instructions emitted, and the time and the
+change in the number of IL commands of each optimization pass. Files
+compiled and functions generated in a pool of processes with -j are timed
+and counted in the workers, which send their timer state back to be merged
+in here.
+"""
+
+import contextlib
+import resource
+import time
+
+# Phases of the compiler, in the order they first run.
+phases = ["lex", "preproc", "parse", "make_il", "optimize", "regalloc",
+          "emit", "as", "ld"]
+
+# Counters of the work done, in the order they are reported, each with a
+# description.
+counters = {
+    "tokens": "tokens after preprocessing",
+    "ast_nodes": "AST nodes",
+    "il_commands": "IL commands before optimization",
+    "dead_functions": "unreferenced static functions dropped",
+    "graph_nodes": "interference graph nodes",
+    "graph_edges": "interference graph edges",
+    "spill_rounds": "spill candidates selected",
+    "coalesced_moves": "coalesced moves",
+    "instructions": "instructions emitted",
+}
+
+# Context manager run in place of a phase while the timer is disabled.
+_untimed = contextlib.nullcontext()
+
+
+class Timer:
+    """Class that accumulates the time spent in each phase of the compiler.
+
+    enabled (bool) - Whether phases are timed.
+    times (Dict[str, float]) - Total time in seconds spent in each phase.
+    peak_rss (Dict[str, int]) - Peak resident set size of the compiler, or of
+    the largest program it ran, in kilobytes, as of the end of each phase.
+    counts (Dict[str, int]) - Value of each counter of the work done.
+    passes (Dict[str, List]) - Total time in seconds of each optimization
+    pass, and the total change it made in the number of IL commands.
+    """
+
+    def __init__(self):
+        """Initialize the Timer, disabled and with no time counted."""
+        self.enabled = False
+        self.times = {}
+        self.peak_rss = {}
+        self.counts = {}
+        self.passes = {}
+
+        # Stack of the phases running, each with the time it last resumed.
+        self._running = []
+
+    def phase(self, name):
+        """Return a context manager timing the code run under it as `name`.
+        """
+        if not self.enabled:
+            return _untimed
+        return self._phase(name)
+
+    @contextlib.contextmanager
+    def _phase(self, name):
+        """Time the code run under this context manager as `name`."""
+        now = time.perf_counter()
+        if self._running:
+            self._pause(now)
+        self._running.append([name, now])
+        try:
+            yield
+        finally:
+            now = time.perf_counter()
+            self._pause(now)
+            self._running.pop()
+            if self._running:
+                self._running[-1][1] = now
+
+            # Memory is only measured out of nested phases, which may run
+            # too often to make a system call each time.
+            if not self._running:
+                rss = max(
+                    resource.getrusage(resource.RUSAGE_SELF).ru_maxrss,
+                    resource.getrusage(resource.RUSAGE_CHILDREN).ru_maxrss)
+                self.peak_rss[name] = max(self.peak_rss.get(name, 0), rss)
+
+    def count(self, name, n=1):
+        """Add n to the counter `name`, if the timer is enabled."""
+        if self.enabled:
+            self.counts[name] = self.counts.get(name, 0) + n
+
+    def count_pass(self, name, seconds, delta):
+        """Add a run of the optimization pass `name` which took the given
+        time and changed the number of IL commands by `delta`.
+        """
+        total = self.passes.setdefault(name, [0, 0])
+        total[0] += seconds
+        total[1] += delta
+
+    def _pause(self, now):
+        """Count the time of the innermost phase running up to `now`."""
+        name, start = self._running[-1]
+        self.times[name] = self.times.get(name, 0) + now - start
+
+    def report(self):
+        """Return the times and peak memory of each phase run, as a dict.
+
+        The phases are in the order of `phases`, followed by any others.
+        """
+        names = ([name for name in phases if name in self.times]
+                 + [name for name in self.times if name not in phases])
+        return {name: {"time": self.times[name],
+                       "peak_rss_kb": self.peak_rss.get(name)}
+                for name in names}
+
+    def report_counts(self):
+        """Return the value of each counter, as a dict.
+
+        The counters are in the order of `counters`, followed by any others.
+        """
+        names = ([name for name in counters if name in self.counts]
+                 + [name for name in self.counts if name not in counters])
+        return {name: self.counts[name] for name in names}
+
+    def report_passes(self):
+        """Return the time and change in IL commands of each pass, as a dict.
+        """
+        return {name: {"time": seconds, "commands": delta}
+                for name, (seconds, delta) in self.passes.items()}
+
+    def state(self):
+        """Return the times, peak memory, and counts, to pass to merge."""
+        return self.times, self.peak_rss, self.counts, self.passes
+
+    def merge(self, state):
+        """Add in the state of a timer run in another process."""
+        times, peak_rss, counts, passes = state
+        for name, t in times.items():
+            self.times[name] = self.times.get(name, 0) + t
+        for name, rss in peak_rss.items():
+            self.peak_rss[name] = max(self.peak_rss.get(name, 0), rss)
+        for name, n in counts.items():
+            self.counts[name] = self.counts.get(name, 0) + n
+        for name, (seconds, delta) in passes.items():
+            self.count_pass(name, seconds, delta)
+
+    def clear(self):
+        """Clear the time counted for every phase, pass, and counter."""
+        self.times = {}
+        self.peak_rss = {}
+        self.counts = {}
+        self.passes = {}
+
+
+timer = Timer()
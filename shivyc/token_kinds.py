@@ -10,6 +10,8 @@ char_kw = TokenKind("char", keyword_kinds)
 short_kw = TokenKind("short", keyword_kinds)
 int_kw = TokenKind("int", keyword_kinds)
 long_kw = TokenKind("long", keyword_kinds)
+float_kw = TokenKind("float", keyword_kinds)
+double_kw = TokenKind("double", keyword_kinds)
 signed_kw = TokenKind("signed", keyword_kinds)
 unsigned_kw = TokenKind("unsigned", keyword_kinds)
 void_kw = TokenKind("void", keyword_kinds)
@@ -21,15 +23,28 @@ while_kw = TokenKind("while", keyword_kinds)
 for_kw = TokenKind("for", keyword_kinds)
 break_kw = TokenKind("break", keyword_kinds)
 continue_kw = TokenKind("continue", keyword_kinds)
+goto_kw = TokenKind("goto", keyword_kinds)
+switch_kw = TokenKind("switch", keyword_kinds)
+case_kw = TokenKind("case", keyword_kinds)
+default_kw = TokenKind("default", keyword_kinds)
 
 auto_kw = TokenKind("auto", keyword_kinds)
 static_kw = TokenKind("static", keyword_kinds)
 extern_kw = TokenKind("extern", keyword_kinds)
+thread_local_kw = TokenKind("_Thread_local", keyword_kinds)
+thread_kw = TokenKind("__thread", keyword_kinds)
+inline_kw = TokenKind("inline", keyword_kinds)
 struct_kw = TokenKind("struct", keyword_kinds)
 union_kw = TokenKind("union", keyword_kinds)
 const_kw = TokenKind("const", keyword_kinds)
+volatile_kw = TokenKind("volatile", keyword_kinds)
+restrict_kw = TokenKind("restrict", keyword_kinds)
 typedef_kw = TokenKind("typedef", keyword_kinds)
 sizeof_kw = TokenKind("sizeof", keyword_kinds)
+alignof_kw = TokenKind("_Alignof", keyword_kinds)
+attribute_kw = TokenKind("__attribute__", keyword_kinds)
+asm_kw = TokenKind("asm", keyword_kinds)
+gnu_asm_kw = TokenKind("__asm__", keyword_kinds)
 
 plus = TokenKind("+", symbol_kinds)
 minus = TokenKind("-", symbol_kinds)
@@ -44,6 +59,9 @@ minusequals = TokenKind("-=", symbol_kinds)
 starequals = TokenKind("*=", symbol_kinds)
 divequals = TokenKind("/=", symbol_kinds)
 modequals = TokenKind("%=", symbol_kinds)
+ampequals = TokenKind("&=", symbol_kinds)
+pipeequals = TokenKind("|=", symbol_kinds)
+caretequals = TokenKind("^=", symbol_kinds)
 twoequals = TokenKind("==", symbol_kinds)
 notequal = TokenKind("!=", symbol_kinds)
 bool_and = TokenKind("&&", symbol_kinds)
@@ -54,7 +72,10 @@ gt = TokenKind(">", symbol_kinds)
 ltoe = TokenKind("<=", symbol_kinds)
 gtoe = TokenKind(">=", symbol_kinds)
 amp = TokenKind("&", symbol_kinds)
+pipe = TokenKind("|", symbol_kinds)
+caret = TokenKind("^", symbol_kinds)
 pound = TokenKind("#", symbol_kinds)
+pound_pound = TokenKind("##", symbol_kinds)
 lbitshift = TokenKind("<<", symbol_kinds)
 rbitshift = TokenKind(">>", symbol_kinds)
 compl = TokenKind("~", symbol_kinds)
@@ -71,7 +92,10 @@ close_sq_brack = TokenKind("]", symbol_kinds)
 
 comma = TokenKind(",", symbol_kinds)
 semicolon = TokenKind(";", symbol_kinds)
+colon = TokenKind(":", symbol_kinds)
+question = TokenKind("?", symbol_kinds)
 dot = TokenKind(".", symbol_kinds)
+ellipsis = TokenKind("...", symbol_kinds)
 arrow = TokenKind("->", symbol_kinds)
 
 identifier = TokenKind()
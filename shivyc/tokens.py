@@ -3,6 +3,9 @@
 A TokenKind instance represents one of the kinds of tokens recognized (see
 token_kinds.py). A Token instance represents a token as produced by the lexer.
 
+There is one Token for every token of the input, so Token and the other
+classes it refers to use __slots__ to keep each object small.
+
 """
 
 
@@ -14,11 +17,20 @@ class TokenKind:
     There are also token kind instances for each of 'identifier' and
     'number'. See token_kinds.py for a list of token_kinds defined.
 
+    Each kind is a single object, so kinds are compared by identity.
+
     text_repr (str) - The token's representation in text, if it has a fixed
     representation.
+    id (int) - Number of this kind, counting from 0 in the order the kinds
+    are created, for indexing tables by kind.
 
     """
 
+    __slots__ = ("text_repr", "id")
+
+    # Number of token kinds created so far.
+    count = 0
+
     def __init__(self, text_repr="", kinds=[]):
         """Initialize a new TokenKind and add it to `kinds`.
 
@@ -27,8 +39,9 @@ class TokenKind:
 
         """
         self.text_repr = text_repr
+        self.id = TokenKind.count
+        TokenKind.count += 1
         kinds.append(self)
-        kinds.sort(key=lambda kind: -len(kind.text_repr))
 
     def __str__(self):
         """Return the representation of this token kind."""
@@ -49,6 +62,8 @@ class Token:
 
     """
 
+    __slots__ = ("kind", "content", "rep", "r")
+
     def __init__(self, kind, content="", rep="", r=None):
         """Initialize this token."""
         self.kind = kind
@@ -33,9 +33,23 @@ import shivyc.token_kinds as token_kinds
 
 
 class DeclNode:
-    """Base class for all decl_nodes nodes."""
+    """Base class for all decl_nodes nodes.
 
-    pass
+    start_token (Token) - first token of this node, set by the parser
+    end_token (Token) - last token of this node, set by the parser
+    """
+
+    __slots__ = ("start_token", "end_token")
+
+    def __init__(self):
+        """Initialize node."""
+        self.start_token = self.end_token = None
+
+    @property
+    def r(self):
+        """Range from the first to the last token of this node, if any."""
+        if self.start_token:
+            return self.start_token.r + self.end_token.r
 
 
 class Root(DeclNode):
@@ -45,6 +59,8 @@ class Root(DeclNode):
     decls (List(Node)) - list of declarator nodes
     """
 
+    __slots__ = ("specs", "decls", "inits")
+
     def __init__(self, specs, decls, inits=None):
         """Generate root node."""
         self.specs = specs
@@ -61,13 +77,16 @@ class Root(DeclNode):
 class Pointer(DeclNode):
     """Represents a pointer to a type."""
 
-    def __init__(self, child, const):
+    __slots__ = ("child", "quals")
+
+    def __init__(self, child, quals):
         """Generate pointer node.
 
-        const - boolean indicating whether this pointer is const
+        quals - set of the token kinds of the qualifiers of this pointer,
+        like `const` or `restrict`
         """
         self.child = child
-        self.const = const
+        self.quals = quals
         super().__init__()
 
 
@@ -78,6 +97,8 @@ class Array(DeclNode):
 
     """
 
+    __slots__ = ("n", "child")
+
     def __init__(self, n, child):
         """Generate array node."""
         self.n = n
@@ -91,6 +112,8 @@ class Function(DeclNode):
     args (List(Node)) - arguments of the functions
     """
 
+    __slots__ = ("args", "child")
+
     def __init__(self, args, child):
         """Generate array node."""
         self.args = args
@@ -104,6 +127,8 @@ class Identifier(DeclNode):
     If this is a type name and has no identifier, `identifier` is None.
     """
 
+    __slots__ = ("identifier",)
+
     def __init__(self, identifier):
         """Generate identifier node from an identifier token."""
         self.identifier = identifier
@@ -115,33 +140,53 @@ class _StructUnion(DeclNode):
 
     tag (Token) - Token containing the tag of this struct
     members (List(Node)) - List of decl_nodes nodes of members, or None
-    r (Range) - range that the specifier covers
+    attributes (List(Token)) - Tokens naming the GNU attributes given
     """
 
-    def __init__(self, tag, members, r):
+    __slots__ = ("tag", "members", "attributes")
+
+    def __init__(self, tag, members, attributes=()):
         self.tag = tag
         self.members = members
+        self.attributes = attributes
 
-        # These r and kind members are a little hacky. They allow the
+        # The r and kind members are a little hacky. They allow the
         # make_specs_ctype function in tree.nodes.Declaration to treat this
         # as a Token for the purposes of determining the base type of the
         # declaration.
-        self.r = r
-
         super().__init__()
 
 
 class Struct(_StructUnion):
     """Represents a struct C type."""
 
-    def __init__(self, tag, members, r):
+    __slots__ = ("kind",)
+
+    def __init__(self, tag, members, attributes=()):
         self.kind = token_kinds.struct_kw
-        super().__init__(tag, members, r)
+        super().__init__(tag, members, attributes)
 
 
 class Union(_StructUnion):
     """Represents a union C type."""
 
-    def __init__(self, tag, members, r):
+    __slots__ = ("kind",)
+
+    def __init__(self, tag, members, attributes=()):
         self.kind = token_kinds.union_kw
-        super().__init__(tag, members, r)
+        super().__init__(tag, members, attributes)
+
+
+class InitList(DeclNode):
+    """Represents a braced list of initializers, like `{1, {2, 3}}`.
+
+    items (List) - the initializers in the list, each an expression node or
+    another InitList
+    """
+
+    __slots__ = ("items",)
+
+    def __init__(self, items):
+        """Generate initializer list node."""
+        self.items = items
+        super().__init__()
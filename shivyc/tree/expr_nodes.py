@@ -1,10 +1,15 @@
 """Nodes in the AST which represent expression values."""
 
+import operator
+
 import shivyc.ctypes as ctypes
 import shivyc.tree.nodes as nodes
+import shivyc.il_cmds.atomic as atomic_cmds
 import shivyc.il_cmds.compare as compare_cmds
 import shivyc.il_cmds.control as control_cmds
+import shivyc.il_cmds.floating as float_cmds
 import shivyc.il_cmds.math as math_cmds
+import shivyc.il_cmds.stream as stream_cmds
 import shivyc.il_cmds.value as value_cmds
 
 from shivyc.ctypes import ArrayCType, PointerCType
@@ -12,8 +17,9 @@ from shivyc.errors import CompilerError
 from shivyc.il_gen import ILValue
 from shivyc.tree.nodes import Declaration
 from shivyc.tree.utils import (IndirectLValue, DirectLValue, RelativeLValue,
-                               check_cast, set_type, arith_convert,
-                               get_size, report_err, shift_into_range)
+                               Constant, check_cast, set_type, arith_convert,
+                               arith_conversion_type, get_size, report_err,
+                               shift_into_range)
 
 
 class _ExprNode(nodes.Node):
@@ -25,6 +31,9 @@ class _ExprNode(nodes.Node):
     LExprNode. Expression nodes which cannot be used as lvalues derive from
     RExprNode.
     """
+
+    __slots__ = ()
+
     def __init__(self):
         """Initialize this ExprNode."""
         super().__init__()
@@ -49,6 +58,20 @@ class _ExprNode(nodes.Node):
         """As above, but do not decay the result."""
         raise NotImplementedError
 
+    def make_branch_il(self, il_code, symbol_table, c):
+        """Generate IL code which branches on the value of this node.
+
+        The generated code jumps to c.true_label if the value is nonzero and
+        to c.false_label if it is zero, where a label of None means control
+        falls through past the generated code instead. At most one of the
+        labels may be None. A node like && which decides the branch through
+        control flow overrides this to avoid computing a value of 0 or 1.
+
+        return - The ILValue branched on, so the caller can check its type,
+        or None if this node branched without computing a value.
+        """
+        raise NotImplementedError
+
     def lvalue(self, il_code, symbol_table, c):
         """Return the LValue representing this node.
 
@@ -56,15 +79,36 @@ class _ExprNode(nodes.Node):
         """
         raise NotImplementedError
 
+    def const_value(self, il_code, symbol_table, c):
+        """Return the value of this node if it is a constant expression.
+
+        No IL code is generated, so this can evaluate array sizes and the
+        initializers of static variables, where there is no function to add
+        code to. Errors are raised as make_il would raise them.
+
+        return - A Constant, or None if this is not a constant expression.
+        """
+        raise NotImplementedError
+
+    def const_addr(self, il_code, symbol_table, c):
+        """Return the address of this lvalue if it is an address constant.
+
+        return - A Constant of pointer type, or None if this node is not an
+        lvalue or its address is not constant.
+        """
+        raise NotImplementedError
+
 
 class _RExprNode(nodes.Node):
     """Base class for representing an rvalue expression node in the AST.
 
     An RExprNode-derived node implements only the _make_il function.
     """
+
+    __slots__ = ()
+
     def __init__(self):  # noqa D102
         nodes.Node.__init__(self)
-        self._cache_raw_ilvalue = None
 
     def make_il(self, il_code, symbol_table, c):  # noqa D102
         raise NotImplementedError
@@ -72,9 +116,18 @@ class _RExprNode(nodes.Node):
     def make_il_raw(self, il_code, symbol_table, c):  # noqa D102
         return self.make_il(il_code, symbol_table, c)
 
+    def make_branch_il(self, il_code, symbol_table, c):  # noqa D102
+        return _branch_on(self.make_il(il_code, symbol_table, c), il_code, c)
+
     def lvalue(self, il_code, symbol_table, c):  # noqa D102
         return None
 
+    def const_value(self, il_code, symbol_table, c):  # noqa D102
+        return None
+
+    def const_addr(self, il_code, symbol_table, c):  # noqa D102
+        return None
+
 
 class _LExprNode(nodes.Node):
     """Base class for representing an lvalue expression node in the AST.
@@ -88,6 +141,8 @@ class _LExprNode(nodes.Node):
     generate unnecessary or repeated code!
     """
 
+    __slots__ = ("_cache_lvalue",)
+
     def __init__(self):  # noqa D102
         super().__init__()
         self._cache_lvalue = None
@@ -111,12 +166,31 @@ class _LExprNode(nodes.Node):
     def make_il_raw(self, il_code, symbol_table, c):  # noqa D102
         return self.lvalue(il_code, symbol_table, c).val(il_code)
 
+    def make_branch_il(self, il_code, symbol_table, c):  # noqa D102
+        return _branch_on(self.make_il(il_code, symbol_table, c), il_code, c)
+
     def lvalue(self, il_code, symbol_table, c):
         """Return an LValue object representing this node."""
         if not self._cache_lvalue:
             self._cache_lvalue = self._lvalue(il_code, symbol_table, c)
         return self._cache_lvalue
 
+    def const_value(self, il_code, symbol_table, c):
+        """Return the decayed address of an array or function lvalue.
+
+        The value stored in an object is never a constant expression.
+        """
+        addr = self.const_addr(il_code, symbol_table, c)
+        if addr and addr.ctype.arg.is_array():
+            return Constant(PointerCType(addr.ctype.arg.el), addr.val,
+                            addr.base)
+        elif addr and addr.ctype.arg.is_function():
+            return addr
+        return None
+
+    def const_addr(self, il_code, symbol_table, c):  # noqa D102
+        return None
+
     def _lvalue(self, il_code, symbol_table, c):
         """Return an LValue object representing this node.
 
@@ -127,9 +201,58 @@ class _LExprNode(nodes.Node):
         raise NotImplementedError
 
 
+def _branch_on(value, il_code, c):
+    """Branch to the labels of context `c` on the given ILValue.
+
+    return - The given ILValue.
+    """
+    cond = _cond_value(value, il_code)
+    if c.false_label:
+        il_code.add(control_cmds.JumpZero(cond, c.false_label))
+        if c.true_label:
+            il_code.add(control_cmds.Jump(c.true_label))
+    else:
+        il_code.add(control_cmds.JumpNotZero(cond, c.true_label))
+    return value
+
+
+def _cond_value(value, il_code):
+    """Return an ILValue which is zero exactly when scalar `value` is.
+
+    A floating value is converted to _Bool, since -0.0 is not zero in all
+    its bits and a NaN is not equal to zero.
+    """
+    if value.ctype.is_floating():
+        return set_type(value, ctypes.bool_t, il_code)
+    return value
+
+
+# IL command computing each arithmetic operation on floating operands.
+_float_cmds = {math_cmds.Add: float_cmds.FloatAdd,
+               math_cmds.Subtr: float_cmds.FloatSub,
+               math_cmds.Mult: float_cmds.FloatMult,
+               math_cmds.Div: float_cmds.FloatDiv,
+               math_cmds.Neg: float_cmds.FloatNeg}
+
+
+def _arith_cmd(cmd, ctype):
+    """Return the IL command computing the operation of IL command `cmd`
+    on operands of arithmetic type `ctype`, or None if there is none.
+    """
+    return _float_cmds.get(cmd) if ctype.is_floating() else cmd
+
+
+def _trunc_div(left, right):
+    """Return the quotient of two integers rounded toward zero, as in C."""
+    quot = abs(left) // abs(right)
+    return -quot if (left < 0) != (right < 0) else quot
+
+
 class MultiExpr(_RExprNode):
     """Expression that is two expressions joined by comma."""
 
+    __slots__ = ("left", "right", "op")
+
     def __init__(self, left, right, op):
         """Initialize node."""
         self.left = left
@@ -145,6 +268,8 @@ class MultiExpr(_RExprNode):
 class Number(_RExprNode):
     """Expression that is just a single number."""
 
+    __slots__ = ("number",)
+
     def __init__(self, number):
         """Initialize node."""
         super().__init__()
@@ -156,20 +281,35 @@ class Number(_RExprNode):
         This function does not actually make any code in the IL, it just
         returns a LiteralILValue that can be used in IL code by the caller.
         """
-        v = int(str(self.number))
+        const = self.const_value(il_code, symbol_table, c)
+        il_value = ILValue(const.ctype)
+        il_code.register_literal_var(il_value, const.val)
+        return il_value
+
+    def const_value(self, il_code, symbol_table, c):
+        """Return the value of the number.
+
+        A floating constant has type float with an f suffix, and double
+        otherwise. There is no long double, so one with an l suffix is a
+        double too.
+        """
+        text = str(self.number)
+        if not text.isdigit():
+            ctype = ctypes.float_t if text[-1] in "fF" else ctypes.double
+            val = float(text.rstrip("fFlL"))
+            return Constant(ctype, ctypes.in_range(val, ctype))
+
+        v = int(text)
 
         if ctypes.int_min <= v <= ctypes.int_max:
-            il_value = ILValue(ctypes.integer)
+            return Constant(ctypes.integer, v)
         elif ctypes.long_min <= v <= ctypes.long_max:
-            il_value = ILValue(ctypes.longint)
+            return Constant(ctypes.longint, v)
         else:
             err = "integer literal too large to be represented by any " \
                   "integer type"
             raise CompilerError(err, self.number.r)
 
-        il_code.register_literal_var(il_value, v)
-        return il_value
-
 
 class String(_LExprNode):
     """Expression that is a string.
@@ -179,6 +319,8 @@ class String(_LExprNode):
 
     """
 
+    __slots__ = ("chars",)
+
     def __init__(self, chars):
         """Initialize Node."""
         super().__init__()
@@ -189,10 +331,16 @@ class String(_LExprNode):
         il_code.register_string_literal(il_value, self.chars)
         return DirectLValue(il_value)
 
+    def const_addr(self, il_code, symbol_table, c):  # noqa D102
+        il_value = self.lvalue(il_code, symbol_table, c).il_value
+        return Constant(PointerCType(il_value.ctype), 0, il_value)
+
 
 class Identifier(_LExprNode):
     """Expression that is a single identifier."""
 
+    __slots__ = ("identifier",)
+
     def __init__(self, identifier):
         """Initialize node."""
         super().__init__()
@@ -202,6 +350,19 @@ class Identifier(_LExprNode):
         var = symbol_table.lookup_variable(self.identifier)
         return DirectLValue(var)
 
+    def const_addr(self, il_code, symbol_table, c):
+        """Return the address of a variable with static or no storage.
+
+        Variables with no storage are functions and objects defined
+        elsewhere, whose addresses are resolved by the linker. A
+        thread-local object has an address only once its thread runs.
+        """
+        var = symbol_table.lookup_variable(self.identifier)
+        if (symbol_table.storage.get(var) == symbol_table.AUTOMATIC
+              or var in symbol_table.thread_locals):
+            return None
+        return Constant(PointerCType(var.ctype), 0, var)
+
 
 class ParenExpr(nodes.Node):
     """Expression in parentheses.
@@ -212,6 +373,8 @@ class ParenExpr(nodes.Node):
     we simply dispatch to the expression inside.
     """
 
+    __slots__ = ("expr",)
+
     def __init__(self, expr):
         """Initialize node."""
         super().__init__()
@@ -229,6 +392,18 @@ class ParenExpr(nodes.Node):
         """Make raw IL code for this expression."""
         return self.expr.make_il_raw(il_code, symbol_table, c)
 
+    def make_branch_il(self, il_code, symbol_table, c):
+        """Make IL code which branches on this expression."""
+        return self.expr.make_branch_il(il_code, symbol_table, c)
+
+    def const_value(self, il_code, symbol_table, c):
+        """Return the constant value of this expression."""
+        return self.expr.const_value(il_code, symbol_table, c)
+
+    def const_addr(self, il_code, symbol_table, c):
+        """Return the constant address of this expression."""
+        return self.expr.const_addr(il_code, symbol_table, c)
+
 
 class _ArithBinOp(_RExprNode):
     """Base class for some binary operators.
@@ -238,6 +413,8 @@ class _ArithBinOp(_RExprNode):
     nodes of those types of operators.
     """
 
+    __slots__ = ("left", "right", "op")
+
     def __init__(self, left, right, op):
         """Initialize node."""
         super().__init__()
@@ -261,7 +438,7 @@ class _ArithBinOp(_RExprNode):
                         shift_into_range(left.literal.val, left.ctype),
                         shift_into_range(right.literal.val, right.ctype),
                         left.ctype)
-                    out = ILValue(left.ctype)
+                    out = ILValue(self._result_ctype(left.ctype))
                     il_code.register_literal_var(out, val)
                     return out
 
@@ -273,8 +450,30 @@ class _ArithBinOp(_RExprNode):
         else:
             return self._nonarith(left, right, il_code)
 
+    def const_value(self, il_code, symbol_table, c):  # noqa D102
+        left = self.left.const_value(il_code, symbol_table, c)
+        right = self.right.const_value(il_code, symbol_table, c)
+        if not left or not right:
+            return None
+
+        if not left.base and not right.base and self._check_type(left, right):
+            ctype = arith_conversion_type(left.ctype, right.ctype)
+            try:
+                val = self._arith_const(shift_into_range(left.val, ctype),
+                                        shift_into_range(right.val, ctype),
+                                        ctype)
+            except NotImplementedError:
+                return None
+            return Constant(self._result_ctype(ctype), val)
+
+        return self._nonarith_const(left, right)
+
     default_il_cmd = None
 
+    def _result_ctype(self, ctype):
+        """Return the type of the result on operands of converted `ctype`."""
+        return ctype
+
     def _check_type(self, left, right):
         """Returns True if both arguments has arithmetic type.
 
@@ -296,7 +495,8 @@ class _ArithBinOp(_RExprNode):
         right - ILValue for right operand
         """
         out = ILValue(left.ctype)
-        il_code.add(self.default_il_cmd(out, left, right))
+        il_code.add(_arith_cmd(self.default_il_cmd, left.ctype)(
+            out, left, right))
         return out
 
     def _arith_const(self, left, right, ctype):
@@ -328,6 +528,15 @@ class _ArithBinOp(_RExprNode):
         """
         raise NotImplementedError
 
+    def _nonarith_const(self, left, right):
+        """Return the result on constant nonarithmetic operands.
+
+        left - Constant for left operand
+        right - Constant for right operand
+        return - A Constant, or None if the result is not constant
+        """
+        return None
+
 
 class Plus(_ArithBinOp):
     """Expression that is sum of two expressions.
@@ -337,6 +546,8 @@ class Plus(_ArithBinOp):
     op (Token) - Plus operator token
     """
 
+    __slots__ = ()
+
     def __init__(self, left, right, op):
         """Initialize node."""
         super().__init__(left, right, op)
@@ -346,6 +557,17 @@ class Plus(_ArithBinOp):
     def _arith_const(self, left, right, ctype):
         return shift_into_range(left + right, ctype)
 
+    def _nonarith_const(self, left, right):
+        """Add an integer constant to an address constant."""
+        if right.ctype.is_pointer() and left.ctype.is_integral():
+            left, right = right, left
+        if not left.ctype.is_pointer() or not right.ctype.is_integral():
+            return None
+        if not left.ctype.arg.is_complete():
+            return None
+        return Constant(left.ctype, left.val + right.val * left.ctype.arg.size,
+                        left.base)
+
     def _nonarith(self, left, right, il_code):
         """Make addition code if either operand is non-arithmetic type."""
 
@@ -378,6 +600,8 @@ class Minus(_ArithBinOp):
     op (Token) - Plus operator token
     """
 
+    __slots__ = ()
+
     def __init__(self, left, right, op):
         """Initialize node."""
         super().__init__(left, right, op)
@@ -387,6 +611,19 @@ class Minus(_ArithBinOp):
     def _arith_const(self, left, right, ctype):
         return shift_into_range(left - right, ctype)
 
+    def _nonarith_const(self, left, right):
+        """Subtract an integer or an address into the same object."""
+        if not left.ctype.is_pointer() or not left.ctype.arg.is_complete():
+            return None
+        size = left.ctype.arg.size
+        if right.ctype.is_integral():
+            return Constant(left.ctype, left.val - right.val * size,
+                            left.base)
+        elif (right.ctype.is_pointer() and left.base is right.base
+              and left.ctype.compatible(right.ctype)):
+            return Constant(ctypes.longint, (left.val - right.val) // size)
+        return None
+
     def _nonarith(self, left, right, il_code):
         """Make subtraction code if both operands are non-arithmetic type."""
 
@@ -406,7 +643,7 @@ class Minus(_ArithBinOp):
             # Divide by size of object
             out = ILValue(ctypes.longint)
             size = ILValue(ctypes.longint)
-            il_code.register_literal_var(size, str(left.ctype.arg.size))
+            il_code.register_literal_var(size, left.ctype.arg.size)
             il_code.add(math_cmds.Div(out, raw, size))
 
             return out
@@ -431,6 +668,8 @@ class Minus(_ArithBinOp):
 class Mult(_ArithBinOp):
     """Expression that is product of two expressions."""
 
+    __slots__ = ()
+
     def __init__(self, left, right, op):
         """Initialize node."""
         super().__init__(left, right, op)
@@ -448,6 +687,8 @@ class Mult(_ArithBinOp):
 class _IntBinOp(_ArithBinOp):
     """Base class for operations that works with integral type operands."""
 
+    __slots__ = ()
+
     def _check_type(self, left, right):
         """Performs additional type check for operands.
 
@@ -460,6 +701,8 @@ class _IntBinOp(_ArithBinOp):
 class Div(_ArithBinOp):
     """Expression that is quotient of two expressions."""
 
+    __slots__ = ()
+
     def __init__(self, left, right, op):
         """Initialize node."""
         super().__init__(left, right, op)
@@ -467,7 +710,11 @@ class Div(_ArithBinOp):
     default_il_cmd = math_cmds.Div
 
     def _arith_const(self, left, right, ctype):
-        return shift_into_range(int(left / right), ctype)
+        if not right:
+            raise NotImplementedError
+        if ctype.is_floating():
+            return shift_into_range(left / right, ctype)
+        return shift_into_range(_trunc_div(left, right), ctype)
 
     def _nonarith(self, left, right, il_code):
         err = "invalid operand types for division"
@@ -477,22 +724,78 @@ class Div(_ArithBinOp):
 class Mod(_IntBinOp):
     """Expression that is modulus of two expressions."""
 
+    __slots__ = ()
+
     def __init__(self, left, right, op):
         """Initialize node."""
         super().__init__(left, right, op)
 
     default_il_cmd = math_cmds.Mod
 
+    def _arith_const(self, left, right, ctype):
+        if not right:
+            raise NotImplementedError
+        return shift_into_range(left - _trunc_div(left, right) * right, ctype)
+
     def _nonarith(self, left, right, il_code):
         err = "invalid operand types for modulus"
         raise CompilerError(err, self.op.r)
 
 
+class _Bitwise(_IntBinOp):
+    """Base class for the `&`, `|`, and `^` bitwise operators."""
+
+    __slots__ = ()
+
+    # Python function computing the operation. Override in subclasses.
+    const_op = None
+
+    def __init__(self, left, right, op):
+        """Initialize node."""
+        super().__init__(left, right, op)
+
+    def _arith_const(self, left, right, ctype):
+        return shift_into_range(self.const_op(left, right), ctype)
+
+    def _nonarith(self, left, right, il_code):
+        err = f"invalid operand types for bitwise '{str(self.op)}'"
+        raise CompilerError(err, self.op.r)
+
+
+class BitAnd(_Bitwise):
+    """Expression that is bitwise and of two expressions."""
+
+    __slots__ = ()
+
+    default_il_cmd = math_cmds.BitAnd
+    const_op = operator.and_
+
+
+class BitOr(_Bitwise):
+    """Expression that is bitwise or of two expressions."""
+
+    __slots__ = ()
+
+    default_il_cmd = math_cmds.BitOr
+    const_op = operator.or_
+
+
+class BitXor(_Bitwise):
+    """Expression that is bitwise xor of two expressions."""
+
+    __slots__ = ()
+
+    default_il_cmd = math_cmds.BitXor
+    const_op = operator.xor
+
+
 class _BitShift(_IntBinOp):
     """Represents a `<<` and `>>` bitwise shift operators.
     Each of operands must have integer type.
     """
 
+    __slots__ = ()
+
     def __init__(self, left, right, op):
         """Initialize node."""
         super().__init__(left, right, op)
@@ -505,24 +808,49 @@ class _BitShift(_IntBinOp):
 class RBitShift(_BitShift):
     """Represent a `>>` operator."""
 
+    __slots__ = ()
+
     default_il_cmd = math_cmds.RBitShift
 
+    def _arith_const(self, left, right, ctype):
+        if not 0 <= right < ctype.size * 8:
+            raise NotImplementedError
+        return left >> right
+
 
 class LBitShift(_BitShift):
     """Represent a `<<` operator."""
 
+    __slots__ = ()
+
     default_il_cmd = math_cmds.LBitShift
 
+    def _arith_const(self, left, right, ctype):
+        if not 0 <= right < ctype.size * 8:
+            raise NotImplementedError
+        return shift_into_range(left << right, ctype)
+
 
 class _Equality(_ArithBinOp):
     """Base class for == and != nodes."""
 
+    __slots__ = ()
+
     eq_il_cmd = None
 
+    # Whether the result is 1 when the operands are equal.
+    when_equal = None
+
     def __init__(self, left, right, op):
         """Initialize node."""
         super().__init__(left, right, op)
 
+    def _result_ctype(self, ctype):
+        return ctypes.integer
+
+    def _arith_const(self, left, right, ctype):
+        return int((left == right) == self.when_equal)
+
     def _arith(self, left, right, il_code):
         """Check equality of arithmetic expressions."""
         out = ILValue(ctypes.integer)
@@ -570,24 +898,38 @@ class _Equality(_ArithBinOp):
 class Equality(_Equality):
     """Expression that checks equality of two expressions."""
 
+    __slots__ = ()
+
     eq_il_cmd = compare_cmds.EqualCmp
+    when_equal = True
 
 
 class Inequality(_Equality):
     """Expression that checks inequality of two expressions."""
 
+    __slots__ = ()
+
     eq_il_cmd = compare_cmds.NotEqualCmp
+    when_equal = False
 
 
 class _Relational(_ArithBinOp):
     """Base class for <, <=, >, and >= nodes."""
 
+    __slots__ = ()
+
     comp_cmd = None
 
     def __init__(self, left, right, op):
         """Initialize node."""
         super().__init__(left, right, op)
 
+    def _result_ctype(self, ctype):
+        return ctypes.integer
+
+    def _arith_const(self, left, right, ctype):
+        return int(self.const_op(left, right))
+
     def _arith(self, left, right, il_code):
         """Compare arithmetic expressions."""
         out = ILValue(ctypes.integer)
@@ -610,24 +952,34 @@ class _Relational(_ArithBinOp):
 
 
 class LessThan(_Relational):
+    __slots__ = ()
     comp_cmd = compare_cmds.LessCmp
+    const_op = operator.lt
 
 
 class GreaterThan(_Relational):
+    __slots__ = ()
     comp_cmd = compare_cmds.GreaterCmp
+    const_op = operator.gt
 
 
 class LessThanOrEq(_Relational):
+    __slots__ = ()
     comp_cmd = compare_cmds.LessOrEqCmp
+    const_op = operator.le
 
 
 class GreaterThanOrEq(_Relational):
+    __slots__ = ()
     comp_cmd = compare_cmds.GreaterOrEqCmp
+    const_op = operator.ge
 
 
 class _BoolAndOr(_RExprNode):
     """Base class for && and || operators."""
 
+    __slots__ = ("left", "right", "op")
+
     def __init__(self, left, right, op):
         """Initialize node."""
         super().__init__()
@@ -635,66 +987,267 @@ class _BoolAndOr(_RExprNode):
         self.right = right
         self.op = op
 
-    # JumpZero for &&, and JumpNotZero for ||
-    jump_cmd = None
+    # Whether a nonzero left operand decides the result, which is True for
+    # || and False for &&.
+    decided_by_true = None
+
+    def const_value(self, il_code, symbol_table, c):  # noqa D102
+        left = self.left.const_value(il_code, symbol_table, c)
+        right = self.right.const_value(il_code, symbol_table, c)
+        if not left or not right:
+            return None
+        if not left.ctype.is_scalar() or not right.ctype.is_scalar():
+            return None
 
-    # 1 for &&, 0 for ||
-    initial_value = 1
+        left = bool(left.base or left.val)
+        right = bool(right.base or right.val)
+        if self.decided_by_true:
+            return Constant(ctypes.integer, int(left or right))
+        return Constant(ctypes.integer, int(left and right))
 
     def make_il(self, il_code, symbol_table, c):
         # ILValue for storing the output of this boolean operation
         out = ILValue(ctypes.integer)
 
-        # ILValue for initial value of output variable.
-        init = ILValue(ctypes.integer)
-        il_code.register_literal_var(init, self.initial_value)
-
-        # ILValue for other value of output variable.
-        other = ILValue(ctypes.integer)
-        il_code.register_literal_var(other, 1 - self.initial_value)
+        zero = ILValue(ctypes.integer)
+        il_code.register_literal_var(zero, 0)
+        one = ILValue(ctypes.integer)
+        il_code.register_literal_var(one, 1)
 
-        # Label which immediately precedes the line which sets out to 0 or 1.
-        set_out = il_code.get_label()
+        # Label which precedes the line which sets out to 0.
+        set_zero = il_code.get_label()
 
-        # Label which skips the line which sets out to 0 or 1.
+        # Label which skips the line which sets out to 0.
         end = il_code.get_label()
 
+        c = c.set_branch(None, set_zero)
+        self.make_branch_il(il_code, symbol_table, c)
+        il_code.add(value_cmds.Set(out, one))
+        il_code.add(control_cmds.Jump(end))
+        il_code.add(control_cmds.Label(set_zero))
+        il_code.add(value_cmds.Set(out, zero))
+        il_code.add(control_cmds.Label(end))
+        return out
+
+    def make_branch_il(self, il_code, symbol_table, c):
+        """Make code which branches without computing a value of 0 or 1.
+
+        If the left operand decides the result, it jumps straight to the
+        target for that result. Otherwise, control falls through to the
+        right operand, which branches to the targets of this node.
+        """
+        # Label after this node, for when the left operand decides the
+        # result and that result falls through.
+        skip = None
+        if self.decided_by_true:
+            if not c.true_label:
+                skip = il_code.get_label()
+            left_c = c.set_branch(c.true_label or skip, None)
+        else:
+            if not c.false_label:
+                skip = il_code.get_label()
+            left_c = c.set_branch(None, c.false_label or skip)
+
         err = f"'{str(self.op)}' operator requires scalar operands"
-        left = self.left.make_il(il_code, symbol_table, c)
-        if not left.ctype.is_scalar():
+        left = self.left.make_branch_il(il_code, symbol_table, left_c)
+        if left and not left.ctype.is_scalar():
             raise CompilerError(err, self.left.r)
 
-        il_code.add(value_cmds.Set(out, init))
-        il_code.add(self.jump_cmd(left, set_out))
-        right = self.right.make_il(il_code, symbol_table, c)
-        if not right.ctype.is_scalar():
+        right = self.right.make_branch_il(il_code, symbol_table, c)
+        if right and not right.ctype.is_scalar():
             raise CompilerError(err, self.right.r)
 
-        il_code.add(self.jump_cmd(right, set_out))
-        il_code.add(control_cmds.Jump(end))
-        il_code.add(control_cmds.Label(set_out))
-        il_code.add(value_cmds.Set(out, other))
-        il_code.add(control_cmds.Label(end))
-        return out
+        if skip:
+            il_code.add(control_cmds.Label(skip))
+        return None
 
 
 class BoolAnd(_BoolAndOr):
     """Expression that performs boolean and of two values."""
 
-    jump_cmd = control_cmds.JumpZero
-    initial_value = 1
+    __slots__ = ()
+
+    decided_by_true = False
 
 
 class BoolOr(_BoolAndOr):
     """Expression that performs boolean or of two values."""
 
-    jump_cmd = control_cmds.JumpNotZero
-    initial_value = 0
+    __slots__ = ()
+
+    decided_by_true = True
+
+
+class Conditional(_RExprNode):
+    """Expression that is a conditional, like `cond ? a : b`.
+
+    When both arms are pure, as told by _is_pure, both are computed and the
+    result is chosen by a Select, which is a conditional move rather than a
+    branch. Otherwise, only the arm chosen is computed, behind a branch.
+    """
+
+    __slots__ = ("cond", "true_expr", "false_expr", "op")
+
+    def __init__(self, cond, true_expr, false_expr, op):
+        """Initialize node."""
+        super().__init__()
+        self.cond = cond
+        self.true_expr = true_expr
+        self.false_expr = false_expr
+        self.op = op
+
+    def make_il(self, il_code, symbol_table, c):
+        """Make code for this node."""
+        if not _is_pure(self.true_expr) or not _is_pure(self.false_expr):
+            def branch(branch_c):
+                self._check_cond(self.cond.make_branch_il(
+                    il_code, symbol_table, branch_c))
+
+            return self._branch_il(
+                il_code, c, branch,
+                lambda: self.true_expr.make_il(il_code, symbol_table, c),
+                lambda: self.false_expr.make_il(il_code, symbol_table, c))
+
+        cond = self.cond.make_il(il_code, symbol_table, c)
+        self._check_cond(cond)
+        true_val = self.true_expr.make_il(il_code, symbol_table, c)
+        false_val = self.false_expr.make_il(il_code, symbol_table, c)
+
+        ctype = self._result_ctype(true_val, false_val)
+        if not ctype.is_scalar():
+            def branch(branch_c):
+                _branch_on(cond, il_code, branch_c)
+
+            return self._branch_il(il_code, c, branch, lambda: true_val,
+                                   lambda: false_val)
+        elif cond.literal:
+            return set_type(true_val if cond.literal.val else false_val,
+                            ctype, il_code)
+
+        out = ILValue(ctype)
+        il_code.add(compare_cmds.Select(
+            out, _cond_value(cond, il_code),
+            set_type(true_val, ctype, il_code),
+            set_type(false_val, ctype, il_code)))
+        return out
+
+    def const_value(self, il_code, symbol_table, c):  # noqa D102
+        cond = self.cond.const_value(il_code, symbol_table, c)
+        true_val = self.true_expr.const_value(il_code, symbol_table, c)
+        false_val = self.false_expr.const_value(il_code, symbol_table, c)
+        if not cond or not true_val or not false_val:
+            return None
+
+        chosen = true_val if cond.base or cond.val else false_val
+        if true_val.ctype.is_arith() and false_val.ctype.is_arith():
+            return chosen.convert(
+                arith_conversion_type(true_val.ctype, false_val.ctype))
+        elif chosen.ctype.is_pointer():
+            return chosen
+        return None
+
+    def _branch_il(self, il_code, c, branch, true_arm, false_arm):
+        """Make code which computes only the arm the condition chooses.
+
+        The type of the result is only known once both arms are made, so
+        each arm is copied into the output, whose type is set at the end.
+
+        c - Context for this node
+        branch - function which makes code branching on the condition, given
+        the context to branch with
+        true_arm, false_arm - functions which make the code of each arm, and
+        return its ILValue
+        """
+        out = ILValue(ctypes.void)
+        false_label = il_code.get_label()
+        end = il_code.get_label()
+
+        branch(c.set_branch(None, false_label))
+        true_val = true_arm()
+        if not true_val.ctype.is_void():
+            il_code.add(value_cmds.Set(out, true_val))
+        il_code.add(control_cmds.Jump(end))
+
+        il_code.add(control_cmds.Label(false_label))
+        false_val = false_arm()
+        if not false_val.ctype.is_void():
+            il_code.add(value_cmds.Set(out, false_val))
+        il_code.add(control_cmds.Label(end))
+
+        out.ctype = self._result_ctype(true_val, false_val)
+        return out
+
+    def _check_cond(self, cond):
+        """Raise an error if the condition is not of scalar type."""
+        if cond and not cond.ctype.is_scalar():
+            err = "'?:' operator requires scalar condition"
+            raise CompilerError(err, self.cond.r)
+
+    def _result_ctype(self, true_val, false_val):
+        """Return the type of the result, given the ILValues of the arms."""
+        true_type = true_val.ctype
+        false_type = false_val.ctype
+
+        if true_type.is_arith() and false_type.is_arith():
+            return arith_conversion_type(true_type, false_type)
+        elif true_type.is_void() and false_type.is_void():
+            return ctypes.void
+        elif (true_type.is_struct_union()
+              and true_type.compatible(false_type)):
+            return true_type
+        elif true_type.is_pointer() and _is_null(false_val):
+            return true_type
+        elif false_type.is_pointer() and _is_null(true_val):
+            return false_type
+        elif true_type.is_pointer() and false_type.is_pointer():
+            if true_type.arg.is_void():
+                return true_type
+            elif false_type.arg.is_void():
+                return false_type
+            elif true_type.compatible(false_type):
+                return true_type
+            err = "pointer type mismatch in conditional expression"
+            raise CompilerError(err, self.op.r)
+
+        err = "type mismatch in conditional expression"
+        raise CompilerError(err, self.op.r)
+
+
+def _is_null(value):
+    """Return whether ILValue `value` is a null pointer constant."""
+    return (value.ctype.is_integral()
+            and getattr(value.literal, "val", None) == 0)
+
+
+def _is_pure(node):
+    """Return whether the expression of `node` may be computed when its
+    value is not used.
+
+    Such an expression has no side effects and cannot fault, so it reads
+    no memory but named objects, and does not divide.
+    """
+    if isinstance(node, (Number, String, Identifier)):
+        return True
+    elif isinstance(node, (ParenExpr, _ArithUnOp, BoolNot, Cast)):
+        return _is_pure(node.expr)
+    elif isinstance(node, AddrOf):
+        return isinstance(node.expr, Identifier)
+    elif isinstance(node, ObjMember):
+        return _is_pure(node.head)
+    elif isinstance(node, _ArithBinOp):
+        return (not isinstance(node, (Div, Mod))
+                and _is_pure(node.left) and _is_pure(node.right))
+    elif isinstance(node, Conditional):
+        return (_is_pure(node.cond) and _is_pure(node.true_expr)
+                and _is_pure(node.false_expr))
+    return False
 
 
 class Equals(_RExprNode):
     """Expression that is an assignment."""
 
+    __slots__ = ("left", "right", "op")
+
     def __init__(self, left, right, op):
         """Initialize node."""
         super().__init__()
@@ -717,6 +1270,8 @@ class Equals(_RExprNode):
 class _CompoundPlusMinus(_RExprNode):
     """Expression that is += or -=."""
 
+    __slots__ = ("left", "right", "op")
+
     # Command to execute to change the value of the variable.  Use
     # math_cmds.Add for +=, math_cmds.Subtr for -=, etc.
     command = None
@@ -763,12 +1318,18 @@ class _CompoundPlusMinus(_RExprNode):
 
         elif lvalue.ctype().is_arith() and right.ctype.is_arith():
             left = self.left.make_il(il_code, symbol_table, c)
-            out = ILValue(left.ctype)
-
             left, right = arith_convert(left, right, il_code)
-            il_code.add(self.command(out, left, right))
-            lvalue.set_to(out, il_code, self.op.r)
-            return out
+            command = _arith_cmd(self.command, left.ctype)
+            if not command:
+                err = f"invalid types for '{str(self.op)}' operator"
+                raise CompilerError(err, self.op.r)
+
+            # The operation is done in the type the operands are converted
+            # to, and the result converted back to the type of the left
+            # operand.
+            out = ILValue(left.ctype)
+            il_code.add(command(out, left, right))
+            return lvalue.set_to(out, il_code, self.op.r)
 
         else:
             err = f"invalid types for '{str(self.op)}' operator"
@@ -778,6 +1339,8 @@ class _CompoundPlusMinus(_RExprNode):
 class PlusEquals(_CompoundPlusMinus):
     """Expression that is +=."""
 
+    __slots__ = ()
+
     command = math_cmds.Add
     accept_pointer = True
 
@@ -785,6 +1348,8 @@ class PlusEquals(_CompoundPlusMinus):
 class MinusEquals(_CompoundPlusMinus):
     """Expression that is -=."""
 
+    __slots__ = ()
+
     command = math_cmds.Subtr
     accept_pointer = True
 
@@ -792,6 +1357,8 @@ class MinusEquals(_CompoundPlusMinus):
 class StarEquals(_CompoundPlusMinus):
     """Expression that is *=."""
 
+    __slots__ = ()
+
     command = math_cmds.Mult
     accept_pointer = False
 
@@ -799,6 +1366,8 @@ class StarEquals(_CompoundPlusMinus):
 class DivEquals(_CompoundPlusMinus):
     """Expression that is /=."""
 
+    __slots__ = ()
+
     command = math_cmds.Div
     accept_pointer = False
 
@@ -806,13 +1375,44 @@ class DivEquals(_CompoundPlusMinus):
 class ModEquals(_CompoundPlusMinus):
     """Expression that is %=."""
 
+    __slots__ = ()
+
     command = math_cmds.Mod
     accept_pointer = False
 
 
+class AmpEquals(_CompoundPlusMinus):
+    """Expression that is &=."""
+
+    __slots__ = ()
+
+    command = math_cmds.BitAnd
+    accept_pointer = False
+
+
+class PipeEquals(_CompoundPlusMinus):
+    """Expression that is |=."""
+
+    __slots__ = ()
+
+    command = math_cmds.BitOr
+    accept_pointer = False
+
+
+class CaretEquals(_CompoundPlusMinus):
+    """Expression that is ^=."""
+
+    __slots__ = ()
+
+    command = math_cmds.BitXor
+    accept_pointer = False
+
+
 class _IncrDecr(_RExprNode):
     """Base class for prefix/postfix increment/decrement operators."""
 
+    __slots__ = ("expr",)
+
     def __init__(self, expr):
         """Initialize node."""
         super().__init__()
@@ -846,15 +1446,16 @@ class _IncrDecr(_RExprNode):
             raise CompilerError(err, self.expr.r)
 
         new_val = ILValue(val.ctype)
+        cmd = _arith_cmd(self.cmd, val.ctype)
 
         if self.return_new:
-            il_code.add(self.cmd(new_val, val, one))
+            il_code.add(cmd(new_val, val, one))
             lval.set_to(new_val, il_code, self.expr.r)
             return new_val
         else:
             old_val = ILValue(val.ctype)
             il_code.add(value_cmds.Set(old_val, val))
-            il_code.add(self.cmd(new_val, val, one))
+            il_code.add(cmd(new_val, val, one))
             lval.set_to(new_val, il_code, self.expr.r)
             return old_val
 
@@ -862,6 +1463,8 @@ class _IncrDecr(_RExprNode):
 class PreIncr(_IncrDecr):
     """Prefix increment."""
 
+    __slots__ = ()
+
     descrip = "increment"
     cmd = math_cmds.Add
     return_new = True
@@ -870,6 +1473,8 @@ class PreIncr(_IncrDecr):
 class PostIncr(_IncrDecr):
     """Postfix increment."""
 
+    __slots__ = ()
+
     descrip = "increment"
     cmd = math_cmds.Add
     return_new = False
@@ -878,6 +1483,8 @@ class PostIncr(_IncrDecr):
 class PreDecr(_IncrDecr):
     """Prefix decrement."""
 
+    __slots__ = ()
+
     descrip = "decrement"
     cmd = math_cmds.Subtr
     return_new = True
@@ -886,6 +1493,8 @@ class PreDecr(_IncrDecr):
 class PostDecr(_IncrDecr):
     """Postfix decrement."""
 
+    __slots__ = ()
+
     descrip = "decrement"
     cmd = math_cmds.Subtr
     return_new = False
@@ -894,6 +1503,8 @@ class PostDecr(_IncrDecr):
 class _ArithUnOp(_RExprNode):
     """Base class for unary plus, minus, and bit-complement."""
 
+    __slots__ = ("expr",)
+
     descrip = None
     opnd_descrip = "arithmetic"
     cmd = None
@@ -920,10 +1531,21 @@ class _ArithUnOp(_RExprNode):
                 val = shift_into_range(val, expr.ctype)
                 il_code.register_literal_var(out, val)
             else:
-                il_code.add(self.cmd(out, expr))
+                il_code.add(_arith_cmd(self.cmd, expr.ctype)(out, expr))
             return out
         return expr
 
+    def const_value(self, il_code, symbol_table, c):  # noqa D102
+        expr = self.expr.const_value(il_code, symbol_table, c)
+        if not expr or expr.base or not self._check_type(expr):
+            return None
+
+        ctype = ctypes.integer if expr.ctype.size < 4 else expr.ctype
+        val = shift_into_range(expr.val, ctype)
+        if self.cmd:
+            val = shift_into_range(self._arith_const(val, ctype), ctype)
+        return Constant(ctype, val)
+
     def _check_type(self, expr):
         """Returns True if the argument has arithmetic type.
 
@@ -941,12 +1563,16 @@ class _ArithUnOp(_RExprNode):
 class UnaryPlus(_ArithUnOp):
     """Positive."""
 
+    __slots__ = ()
+
     descrip = "unary plus"
 
 
 class UnaryMinus(_ArithUnOp):
     """Negative."""
 
+    __slots__ = ()
+
     descrip = "unary minus"
     cmd = math_cmds.Neg
 
@@ -957,6 +1583,8 @@ class UnaryMinus(_ArithUnOp):
 class Compl(_ArithUnOp):
     """Logical bitwise negative."""
 
+    __slots__ = ()
+
     descrip = "bit-complement"
     opnd_descrip = "integral"
     cmd = math_cmds.Not
@@ -971,6 +1599,8 @@ class Compl(_ArithUnOp):
 class BoolNot(_RExprNode):
     """Boolean not."""
 
+    __slots__ = ("expr",)
+
     def __init__(self, expr):
         """Initialize node."""
         super().__init__()
@@ -989,58 +1619,97 @@ class BoolNot(_RExprNode):
 
         # ILValue for zero.
         zero = ILValue(ctypes.integer)
-        il_code.register_literal_var(zero, "0")
+        il_code.register_literal_var(zero, 0)
 
         # ILValue for one.
         one = ILValue(ctypes.integer)
-        il_code.register_literal_var(one, "1")
+        il_code.register_literal_var(one, 1)
 
         # Label which skips the line which sets out to 0.
         end = il_code.get_label()
 
         il_code.add(value_cmds.Set(out, one))
-        il_code.add(control_cmds.JumpZero(expr, end))
+        il_code.add(control_cmds.JumpZero(_cond_value(expr, il_code), end))
         il_code.add(value_cmds.Set(out, zero))
         il_code.add(control_cmds.Label(end))
 
         return out
 
+    def const_value(self, il_code, symbol_table, c):  # noqa D102
+        expr = self.expr.const_value(il_code, symbol_table, c)
+        if not expr or not expr.ctype.is_scalar():
+            return None
+        return Constant(ctypes.integer, int(not (expr.base or expr.val)))
+
+    def make_branch_il(self, il_code, symbol_table, c):
+        """Make code which branches on the operand with the targets swapped.
+
+        The operand is not converted to a value of 0 or 1 first.
+        """
+        c = c.set_branch(c.false_label, c.true_label)
+        expr = self.expr.make_branch_il(il_code, symbol_table, c)
+        if expr and not expr.ctype.is_scalar():
+            err = "'!' operator requires scalar operand"
+            raise CompilerError(err, self.r)
+        return None
+
 
 class _SizeofNode(_RExprNode):
-    """Base class for common logic for the two sizeof nodes."""
+    """Base class for common logic for the sizeof and _Alignof nodes."""
+
+    __slots__ = ()
+
+    # Name of the operator, for error messages
+    name = "sizeof"
 
     def __init__(self):
         super().__init__()
 
+    def measure(self, ctype):
+        """Return the measure of the given type this operator yields."""
+        return ctype.size
+
     def sizeof_ctype(self, ctype, range, il_code):
         """Raise CompilerError if ctype is not valid as sizeof argument."""
 
         if ctype.is_function():
-            err = "sizeof argument cannot have function type"
+            err = f"{self.name} argument cannot have function type"
             raise CompilerError(err, range)
 
         if ctype.is_incomplete():
-            err = "sizeof argument cannot have incomplete type"
+            err = f"{self.name} argument cannot have incomplete type"
             raise CompilerError(err, range)
 
         out = ILValue(ctypes.unsig_longint)
-        il_code.register_literal_var(out, ctype.size)
+        il_code.register_literal_var(out, self.measure(ctype))
         return out
 
+    def const_value(self, il_code, symbol_table, c):  # noqa D102
+        out = self.make_il(il_code, symbol_table, c)
+        return Constant(out.ctype, out.literal.val)
+
 
 class SizeofExpr(_SizeofNode):
     """Node representing sizeof with expression operand.
 
     expr (_ExprNode) - the expression to get the size of
     """
+
+    __slots__ = ("expr",)
+
     def __init__(self, expr):
         super().__init__()
         self.expr = expr
 
     def make_il(self, il_code, symbol_table, c):
-        """Return a compile-time integer literal as the expression size."""
+        """Return a compile-time integer literal as the expression size.
 
+        The operand is not evaluated, so its code is made in a scratch
+        function of a copy of the IL code. This works even outside of a
+        function, as in an array size.
+        """
         dummy_il_code = il_code.copy()
+        dummy_il_code.start_func(None)
         expr = self.expr.make_il_raw(dummy_il_code, symbol_table, c)
         return self.sizeof_ctype(expr.ctype, self.expr.r, il_code)
 
@@ -1050,6 +1719,9 @@ class SizeofType(_SizeofNode, Declaration):
 
     node (decl_nodes.Root) - a declaration tree for the type
     """
+
+    __slots__ = ()
+
     def __init__(self, node):
         _SizeofNode.__init__(self)
         Declaration.__init__(self, node)   # sets self.node = node
@@ -1058,11 +1730,27 @@ class SizeofType(_SizeofNode, Declaration):
         """Return a compile-time integer literal as the expression size."""
 
         self.set_self_vars(il_code, symbol_table, c)
-        base_type, _ = self.make_specs_ctype(self.node.specs, False)
+        # A type name has an abstract declarator, so a struct tag in it
+        # refers to the struct of that tag in scope.
+        base_type, _ = self.make_specs_ctype(self.node.specs, True)
         ctype, _ = self.make_ctype(self.node.decls[0], base_type)
         return self.sizeof_ctype(ctype, self.node.decls[0].r, il_code)
 
 
+class AlignofType(SizeofType):
+    """Node representing _Alignof, whose operand is always a type name.
+
+    node (decl_nodes.Root) - a declaration tree for the type
+    """
+
+    __slots__ = ()
+
+    name = "_Alignof"
+
+    def measure(self, ctype):  # noqa D102
+        return ctype.align
+
+
 class Cast(Declaration, _RExprNode):
     """Node representing a cast operation, like `(void*)p`.
 
@@ -1070,6 +1758,9 @@ class Cast(Declaration, _RExprNode):
 
     TODO: Share code between Cast and Declaration nodes more cleanly.
     """
+
+    __slots__ = ("expr",)
+
     def __init__(self, node, expr):
         Declaration.__init__(self, node)   # sets self.node = node
         _RExprNode.__init__(self)
@@ -1078,26 +1769,52 @@ class Cast(Declaration, _RExprNode):
 
     def make_il(self, il_code, symbol_table, c):
         """Make IL for this cast operation."""
+        ctype = self._cast_ctype(il_code, symbol_table, c)
+
+        il_value = self.expr.make_il(il_code, symbol_table, c)
+        self._check_operand(il_value.ctype, ctype)
+        return set_type(il_value, ctype, il_code)
+
+    def const_value(self, il_code, symbol_table, c):  # noqa D102
+        ctype = self._cast_ctype(il_code, symbol_table, c)
 
+        const = self.expr.const_value(il_code, symbol_table, c)
+        if not const:
+            return None
+        self._check_operand(const.ctype, ctype)
+        return None if ctype.is_void() else const.convert(ctype)
+
+    def _check_operand(self, from_type, ctype):
+        """Raise an error if a value of `from_type` cannot be cast to
+        `ctype`.
+        """
+        if not from_type.is_scalar():
+            err = "can only cast from scalar type"
+            raise CompilerError(err, self.r)
+        if ((from_type.is_floating() and ctype.is_pointer())
+              or (from_type.is_pointer() and ctype.is_floating())):
+            err = "cannot cast between pointer and floating type"
+            raise CompilerError(err, self.r)
+
+    def _cast_ctype(self, il_code, symbol_table, c):
+        """Return the type cast to, checking it is scalar or void."""
         self.set_self_vars(il_code, symbol_table, c)
-        base_type, _ = self.make_specs_ctype(self.node.specs, False)
+        # A type name has an abstract declarator, so a struct tag in it
+        # refers to the struct of that tag in scope.
+        base_type, _ = self.make_specs_ctype(self.node.specs, True)
         ctype, _ = self.make_ctype(self.node.decls[0], base_type)
 
         if not ctype.is_void() and not ctype.is_scalar():
             err = "can only cast to scalar or void type"
             raise CompilerError(err, self.node.decls[0].r)
-
-        il_value = self.expr.make_il(il_code, symbol_table, c)
-        if not il_value.ctype.is_scalar():
-            err = "can only cast from scalar type"
-            raise CompilerError(err, self.r)
-
-        return set_type(il_value, ctype, il_code)
+        return ctype
 
 
 class AddrOf(_RExprNode):
     """Address-of expression."""
 
+    __slots__ = ("expr",)
+
     def __init__(self, expr):
         """Initialize node."""
         super().__init__()
@@ -1112,10 +1829,52 @@ class AddrOf(_RExprNode):
             err = "operand of unary '&' must be lvalue"
             raise CompilerError(err, self.expr.r)
 
+    def const_value(self, il_code, symbol_table, c):  # noqa D102
+        return self.expr.const_addr(il_code, symbol_table, c)
+
+
+class LabelAddress(_RExprNode):
+    """Expression of the address of a label, like `&&end`, for a computed
+    goto. This is a GNU extension.
+
+    label (Token) - Name of the label.
+    """
+
+    __slots__ = ("label",)
+
+    def __init__(self, label):
+        """Initialize node."""
+        super().__init__()
+        self.label = label
+
+    def make_il(self, il_code, symbol_table, c):
+        """Make code for this node."""
+        if not c.labels:
+            err = "label address outside of a function"
+            raise CompilerError(err, self.r)
+
+        out = ILValue(PointerCType(ctypes.void))
+        il_code.add(control_cmds.LabelAddr(out, c.labels.take(self.label)))
+        return out
+
+    def const_value(self, il_code, symbol_table, c):
+        """Return the address of the label as an address constant.
+
+        The label is then given a symbol, by which static data in the same
+        function may hold its address.
+        """
+        if not c.labels:
+            err = "label address outside of a function"
+            raise CompilerError(err, self.r)
+        return Constant(PointerCType(ctypes.void), 0,
+                        c.labels.take_const(self.label))
+
 
 class Deref(_LExprNode):
     """Dereference expression."""
 
+    __slots__ = ("expr",)
+
     def __init__(self, expr):
         """Initialize node."""
         super().__init__()
@@ -1130,10 +1889,18 @@ class Deref(_LExprNode):
 
         return IndirectLValue(addr)
 
+    def const_addr(self, il_code, symbol_table, c):  # noqa D102
+        addr = self.expr.const_value(il_code, symbol_table, c)
+        if addr and addr.ctype.is_pointer():
+            return addr
+        return None
+
 
 class ArraySubsc(_LExprNode):
     """Array subscript."""
 
+    __slots__ = ("head", "arg")
+
     def __init__(self, head, arg):
         """Initialize node."""
         super().__init__()
@@ -1225,10 +1992,33 @@ class ArraySubsc(_LExprNode):
         el = array.ctype.el
         return RelativeLValue(el, array, el.size, arith)
 
+    def const_addr(self, il_code, symbol_table, c):
+        """Return the address of an element at a constant index.
+
+        The operands are evaluated as for `*(head + arg)`, so an array
+        operand decays to the address of its first element.
+        """
+        head = self.head.const_value(il_code, symbol_table, c)
+        arg = self.arg.const_value(il_code, symbol_table, c)
+        if not head or not arg:
+            return None
+        if arg.ctype.is_pointer():
+            head, arg = arg, head
+        if not head.ctype.is_pointer() or not arg.ctype.is_integral():
+            return None
+
+        if not head.ctype.arg.is_complete():
+            err = "cannot subscript pointer to incomplete type"
+            raise CompilerError(err, self.r)
+        return Constant(head.ctype, head.val + arg.val * head.ctype.arg.size,
+                        head.base)
+
 
 class _ObjLookup(_LExprNode):
     """Struct/union object lookup (. or ->)"""
 
+    __slots__ = ("head", "member")
+
     def __init__(self, head, member):
         """Initialize node."""
         super().__init__()
@@ -1252,6 +2042,8 @@ class _ObjLookup(_LExprNode):
 
         if struct_ctype.is_const():
             ctype = ctype.make_const()
+        if struct_ctype.is_volatile():
+            ctype = ctype.make_volatile()
 
         return offset, ctype
 
@@ -1259,6 +2051,8 @@ class _ObjLookup(_LExprNode):
 class ObjMember(_ObjLookup):
     """Struct/union object member (. operator)"""
 
+    __slots__ = ()
+
     def _lvalue(self, il_code, symbol_table, c):
         head_lv = self.head.lvalue(il_code, symbol_table, c)
         struct_ctype = head_lv.ctype() if head_lv else None
@@ -1267,20 +2061,33 @@ class ObjMember(_ObjLookup):
         if isinstance(head_lv, DirectLValue):
             head_val = self.head.make_il(il_code, symbol_table, c)
             return RelativeLValue(ctype, head_val, offset)
+        elif isinstance(head_lv, RelativeLValue) and not head_lv.count:
+            # A member of a member is at a fixed offset from the same base.
+            return RelativeLValue(ctype, head_lv.base,
+                                  head_lv.chunk + offset)
         else:
             struct_addr = head_lv.addr(il_code)
 
             shift = ILValue(ctypes.longint)
-            il_code.register_literal_var(shift, str(offset))
+            il_code.register_literal_var(shift, offset)
 
             out = ILValue(PointerCType(ctype))
             il_code.add(math_cmds.Add(out, struct_addr, shift))
             return IndirectLValue(out)
 
+    def const_addr(self, il_code, symbol_table, c):  # noqa D102
+        head = self.head.const_addr(il_code, symbol_table, c)
+        if not head:
+            return None
+        offset, ctype = self.get_offset_info(head.ctype.arg)
+        return Constant(PointerCType(ctype), head.val + offset, head.base)
+
 
 class ObjPtrMember(_ObjLookup):
     """Struct/union pointer object member (-> operator)"""
 
+    __slots__ = ()
+
     def _lvalue(self, il_code, symbol_table, c):
         struct_addr = self.head.make_il(il_code, symbol_table, c)
         if not struct_addr.ctype.is_pointer():
@@ -1289,12 +2096,19 @@ class ObjPtrMember(_ObjLookup):
 
         offset, ctype = self.get_offset_info(struct_addr.ctype.arg)
         shift = ILValue(ctypes.longint)
-        il_code.register_literal_var(shift, str(offset))
+        il_code.register_literal_var(shift, offset)
 
         out = ILValue(PointerCType(ctype))
         il_code.add(math_cmds.Add(out, struct_addr, shift))
         return IndirectLValue(out)
 
+    def const_addr(self, il_code, symbol_table, c):  # noqa D102
+        head = self.head.const_value(il_code, symbol_table, c)
+        if not head or not head.ctype.is_pointer():
+            return None
+        offset, ctype = self.get_offset_info(head.ctype.arg)
+        return Constant(PointerCType(ctype), head.val + offset, head.base)
+
 
 class FuncCall(_RExprNode):
     """Function call.
@@ -1302,6 +2116,9 @@ class FuncCall(_RExprNode):
     func - Expression of type function pointer
     args - List of expressions for each argument
     """
+
+    __slots__ = ("func", "args")
+
     def __init__(self, func, args):
         """Initialize node."""
         super().__init__()
@@ -1311,6 +2128,16 @@ class FuncCall(_RExprNode):
     def make_il(self, il_code, symbol_table, c):
         """Make code for this node."""
 
+        # A call of a library function the compiler knows may be expanded,
+        # which leaves no use of the function.
+        known = self._library_function(symbol_table)
+        if known:
+            final_args = self._get_args_with_prototype(
+                known.ctype, il_code, symbol_table, c)
+            expanded = self._expand(known, final_args, il_code)
+            if expanded:
+                return expanded
+
         # This is of function pointer type, so func.arg is the function type.
         func = self.func.make_il(il_code, symbol_table, c)
 
@@ -1325,30 +2152,94 @@ class FuncCall(_RExprNode):
             descrip = "function returns non-void incomplete type"
             raise CompilerError(descrip, self.func.r)
 
-        if func.ctype.arg.no_info:
-            final_args = self._get_args_without_prototype(
-                il_code, symbol_table, c)
-        else:
-            final_args = self._get_args_with_prototype(
-                func.ctype.arg, il_code, symbol_table, c)
+        if not known:
+            if func.ctype.arg.no_info:
+                final_args = self._get_args_without_prototype(
+                    il_code, symbol_table, c)
+            else:
+                final_args = self._get_args_with_prototype(
+                    func.ctype.arg, il_code, symbol_table, c)
 
         ret = ILValue(func.ctype.arg.ret)
         il_code.add(control_cmds.Call(func, final_args, ret))
         return ret
 
+    def _library_function(self, symbol_table):
+        """Return the function called, if it is a library function whose
+        calls may be expanded.
+
+        That is memcpy, memmove, memset, or strlen, declared with a
+        prototype and external linkage, as by string.h, and not defined in
+        the file.
+        """
+        if not isinstance(self.func, Identifier):
+            return None
+        name = self.func.identifier.content
+        var = symbol_table.lookup_variable(self.func.identifier)
+        if (name in library_functions and var.ctype.is_function()
+              and not var.ctype.no_info
+              and len(var.ctype.args) == library_functions[name]
+              and symbol_table.linkage_type.get(var) == symbol_table.EXTERNAL
+              and symbol_table.def_state.get(var) != symbol_table.DEFINED):
+            return var
+        return None
+
+    def _expand(self, func, args, il_code):
+        """Expand a call of a library function the compiler knows.
+
+        A call of memcpy, memmove, or memset with a literal size which is
+        small enough is done inline by a CopyAt or FillAt, and has the value
+        of its first argument. A call of strlen on a string literal is the
+        length of the string.
+
+        returns - the value of the call, or None if it is not expanded
+        """
+        name = self.func.identifier.content
+        if name == "strlen":
+            arg = self.args[0]
+            while isinstance(arg, ParenExpr):
+                arg = arg.expr
+            if not isinstance(arg, String):
+                return None
+            length = ILValue(func.ctype.ret)
+            il_code.register_literal_var(length, arg.chars.index(0))
+            return length
+
+        size = getattr(args[2].literal, "val", None)
+        if size is None:
+            return None
+        dest = args[0]
+        if name == "memset":
+            if size > value_cmds.FillAt.inline_max:
+                return None
+            if size:
+                il_code.add(value_cmds.FillAt(dest, args[1], size))
+        else:
+            overlap = name == "memmove"
+            limit = (value_cmds.CopyAt.overlap_max if overlap
+                     else value_cmds.CopyAt.inline_max)
+            if size > limit:
+                return None
+            if size:
+                il_code.add(value_cmds.CopyAt(dest, args[1], size, overlap))
+        return dest
+
     def _get_args_without_prototype(self, il_code, symbol_table, c):
         """Return list of argument ILValues for function this represents.
 
         Use _get_args_without_prototype when the function this represents
-        has no prototype. This function only performs integer promotion on the
-        arguments before passing them to the called function.
+        has no prototype. This function only performs the default argument
+        promotions, integer promotion and float to double, on the arguments
+        before passing them to the called function.
         """
         final_args = []
         for arg_given in self.args:
             arg = arg_given.make_il(il_code, symbol_table, c)
 
-            # perform integer promotions
-            if arg.ctype.is_arith() and arg.ctype.size < 4:
+            # perform default argument promotions
+            if arg.ctype.is_floating() and arg.ctype.size < 8:
+                arg = set_type(arg, ctypes.double, il_code)
+            elif arg.ctype.is_arith() and arg.ctype.size < 4:
                 arg = set_type(arg, ctypes.integer, il_code)
 
             final_args.append(arg)
@@ -1379,3 +2270,396 @@ class FuncCall(_RExprNode):
             final_args.append(
                 set_type(arg, arg_type.make_unqual(), il_code))
         return final_args
+
+
+class BuiltinExpect(_RExprNode):
+    """Call of `__builtin_expect(exp, c)`, which is `exp` as a long.
+
+    The call tells the compiler that `exp` is expected to equal the integer
+    constant `c`. When it is branched on, the branch the program is not
+    expected to take goes to a block with a label in il_code.cold_labels,
+    which the block layout moves out of the way of the expected path.
+
+    args - List of expressions for each argument
+    """
+
+    __slots__ = ("identifier", "args")
+
+    def __init__(self, identifier, args):
+        """Initialize node."""
+        super().__init__()
+        self.identifier = identifier
+        self.args = args
+
+    def make_il(self, il_code, symbol_table, c):
+        """Make code for this node."""
+        self._expected(il_code, symbol_table, c)
+        exp = self.args[0].make_il(il_code, symbol_table, c)
+        check_cast(exp, ctypes.longint, self.args[0].r)
+        return set_type(exp, ctypes.longint, il_code)
+
+    def make_branch_il(self, il_code, symbol_table, c):  # noqa D102
+        likely = self._expected(il_code, symbol_table, c).val != 0
+        hot, cold = c.true_label, c.false_label
+        if not likely:
+            hot, cold = cold, hot
+
+        # When the unexpected branch would fall through, the code it falls
+        # through to is cold. Otherwise the branch goes through a cold block
+        # which jumps on to its label.
+        out = il_code.get_label()
+        il_code.cold_labels.add(out)
+        if not cold:
+            exp = self.args[0].make_branch_il(il_code, symbol_table, c)
+            il_code.add(control_cmds.Label(out))
+        else:
+            after = None if hot else il_code.get_label()
+            labels = (hot or after, out) if likely else (out, hot or after)
+            exp = self.args[0].make_branch_il(il_code, symbol_table,
+                                              c.set_branch(*labels))
+            il_code.add(control_cmds.Label(out))
+            il_code.add(control_cmds.Jump(cold))
+            if after:
+                il_code.add(control_cmds.Label(after))
+
+        if exp:
+            check_cast(exp, ctypes.longint, self.args[0].r)
+        return exp
+
+    def _expected(self, il_code, symbol_table, c):
+        """Check the arguments, and return the expected value as a Constant.
+        """
+        name = self.identifier.content
+        if len(self.args) != 2:
+            err = ("incorrect number of arguments for function call"
+                   f" (expected 2, have {len(self.args)})")
+            raise CompilerError(err, self.args[-1].r if self.args else self.r)
+
+        expected = self.args[1].const_value(il_code, symbol_table, c)
+        if (not expected or expected.base
+              or not expected.ctype.is_integral()):
+            err = f"second argument of '{name}' must be an integer constant"
+            raise CompilerError(err, self.args[1].r)
+        return expected
+
+
+class BuiltinBits(_RExprNode):
+    """Call of a builtin on the bits of an unsigned integer, like
+    `__builtin_popcount(x)` or `__builtin_bswap64(x)`.
+
+    The argument is converted to the type the builtin takes, as for a
+    function with a prototype.
+
+    args - List of expressions for each argument
+    """
+
+    __slots__ = ("identifier", "args")
+
+    def __init__(self, identifier, args):
+        """Initialize node."""
+        super().__init__()
+        self.identifier = identifier
+        self.args = args
+
+    def make_il(self, il_code, symbol_table, c):
+        """Make code for this node."""
+        cmd, arg_type = bit_builtins[self.identifier.content]
+        self._check_args()
+        arg = self.args[0].make_il(il_code, symbol_table, c)
+        check_cast(arg, arg_type, self.args[0].r)
+        arg = set_type(arg, arg_type, il_code)
+
+        out = ILValue(self._ret_type())
+        command = cmd(out, arg)
+        # perform constant folding
+        val = None
+        if arg.literal:
+            val = command.evaluate({arg: arg.literal.val})
+        if val is None:
+            il_code.add(command)
+        else:
+            il_code.register_literal_var(out, val)
+        return out
+
+    def const_value(self, il_code, symbol_table, c):  # noqa D102
+        cmd, arg_type = bit_builtins[self.identifier.content]
+        self._check_args()
+        arg = self.args[0].const_value(il_code, symbol_table, c)
+        if (not arg or arg.base or not arg.ctype.is_integral()
+              or isinstance(arg.val, float)):
+            return None
+
+        value = ILValue(arg_type)
+        val = cmd(None, value).evaluate(
+            {value: shift_into_range(arg.val, arg_type)})
+        if val is None:
+            return None
+        return Constant(self._ret_type(), val)
+
+    def _ret_type(self):
+        """Return the type of the value of the builtin."""
+        cmd, arg_type = bit_builtins[self.identifier.content]
+        return arg_type if cmd is math_cmds.ByteSwap else ctypes.integer
+
+    def _check_args(self):
+        """Check that the builtin is given one argument."""
+        if len(self.args) != 1:
+            err = ("incorrect number of arguments for function call"
+                   f" (expected 1, have {len(self.args)})")
+            raise CompilerError(err, self.args[-1].r if self.args else self.r)
+
+
+class BuiltinAtomic(_RExprNode):
+    """Call of a builtin accessing an object atomically, like
+    `__atomic_fetch_add(p, 1, __ATOMIC_SEQ_CST)`.
+
+    The first argument points to the object, which has integral or pointer
+    type, and the values given are converted to its type. Each memory order
+    must be an integer constant, one of the __ATOMIC values <stdatomic.h>
+    defines.
+
+    args - List of expressions for each argument
+    """
+
+    __slots__ = ("identifier", "args")
+
+    def __init__(self, identifier, args):
+        """Initialize node."""
+        super().__init__()
+        self.identifier = identifier
+        self.args = args
+
+    def make_il(self, il_code, symbol_table, c):
+        """Make code for this node."""
+        cmd, num_args, after = atomic_builtins[self.identifier.content]
+        if len(self.args) != num_args:
+            err = ("incorrect number of arguments for function call"
+                   f" (expected {num_args}, have {len(self.args)})")
+            raise CompilerError(err, self.args[-1].r if self.args else self.r)
+
+        if cmd is atomic_cmds.AtomicFence:
+            il_code.add(cmd(self._order(self.args[0], il_code,
+                                        symbol_table, c)))
+            return ILValue(ctypes.void)
+
+        addr = self._addr(cmd, il_code, symbol_table, c)
+        ctype = addr.ctype.arg.make_unqual()
+        order = self._order(self.args[-1], il_code, symbol_table, c)
+        if cmd is atomic_cmds.AtomicLoad:
+            out = ILValue(ctype)
+            il_code.add(cmd(out, addr, order))
+            return out
+
+        if cmd is atomic_cmds.AtomicCompareExchange:
+            expected = self.args[1].make_il(il_code, symbol_table, c)
+            check_cast(expected, PointerCType(ctype), self.args[1].r)
+            expected = set_type(expected, PointerCType(ctype), il_code)
+
+        val = self.args[2 if cmd is atomic_cmds.AtomicCompareExchange
+                        else 1]
+        val_il = val.make_il(il_code, symbol_table, c)
+        check_cast(val_il, ctype, val.r)
+        val_il = set_type(val_il, ctype, il_code)
+
+        if cmd is atomic_cmds.AtomicStore:
+            il_code.add(cmd(addr, val_il, order))
+            return ILValue(ctypes.void)
+
+        if cmd is atomic_cmds.AtomicCompareExchange:
+            # Whether the exchange is weak is evaluated, but the exchange
+            # is always strong.
+            self.args[3].make_il(il_code, symbol_table, c)
+            failure = self._order(self.args[5], il_code, symbol_table, c)
+            order = self._order(self.args[4], il_code, symbol_table, c)
+            out = ILValue(ctypes.bool_t)
+            il_code.add(cmd(out, addr, expected, val_il, order, failure))
+            return out
+
+        out = ILValue(ctype)
+        il_code.add(cmd(out, addr, val_il, order))
+        if after:
+            new = ILValue(ctype)
+            il_code.add(after(new, out, val_il))
+            out = new
+        return out
+
+    def _addr(self, cmd, il_code, symbol_table, c):
+        """Return the address of the object the builtin accesses."""
+        name = self.identifier.content
+        addr = self.args[0].make_il(il_code, symbol_table, c)
+        if not addr.ctype.is_pointer():
+            err = f"first argument of '{name}' must have pointer type"
+            raise CompilerError(err, self.args[0].r)
+
+        ctype = addr.ctype.arg
+        arith = cmd in (atomic_cmds.AtomicFetchAdd, atomic_cmds.AtomicFetchSub)
+        if arith:
+            valid = ctype.is_integral() and not ctype.is_bool()
+        else:
+            valid = ctype.is_integral() or ctype.is_pointer()
+        if not valid or ctype.size not in {1, 2, 4, 8}:
+            err = (f"first argument of '{name}' must point to an integer"
+                   + ("" if arith else " or pointer"))
+            raise CompilerError(err, self.args[0].r)
+        if ctype.is_const() and cmd is not atomic_cmds.AtomicLoad:
+            err = f"first argument of '{name}' points to a const object"
+            raise CompilerError(err, self.args[0].r)
+        return addr
+
+    def _order(self, arg, il_code, symbol_table, c):
+        """Return the value of a memory order argument."""
+        order = arg.const_value(il_code, symbol_table, c)
+        if (not order or order.base or not order.ctype.is_integral()
+              or order.val not in range(atomic_cmds.SEQ_CST + 1)):
+            name = self.identifier.content
+            err = f"memory order of '{name}' must be an __ATOMIC constant"
+            raise CompilerError(err, arg.r)
+        return order.val
+
+
+class BuiltinPrefetch(_RExprNode):
+    """Call of `__builtin_prefetch(p, rw, locality)`, which prefetches the
+    memory at pointer `p`.
+
+    The optional `rw` and `locality` must be integer constants: `rw` is 1
+    if the memory is to be written and 0, the default, if it is to be read,
+    and `locality` is from 0, for memory used only once, to 3, the default,
+    for memory to keep in every level of the cache. A prefetch for a write
+    is made like one for a read.
+
+    args - List of expressions for each argument
+    """
+
+    __slots__ = ("identifier", "args")
+
+    def __init__(self, identifier, args):
+        """Initialize node."""
+        super().__init__()
+        self.identifier = identifier
+        self.args = args
+
+    def make_il(self, il_code, symbol_table, c):
+        """Make code for this node."""
+        if not 1 <= len(self.args) <= 3:
+            err = ("incorrect number of arguments for function call"
+                   f" (expected 1 to 3, have {len(self.args)})")
+            raise CompilerError(err, self.args[-1].r if self.args else self.r)
+
+        # The pointer is converted as to a parameter of type const void *.
+        addr = self.args[0].make_il(il_code, symbol_table, c)
+        const_void_p = PointerCType(ctypes.void.make_const())
+        check_cast(addr, const_void_p, self.args[0].r)
+        addr = set_type(addr, const_void_p, il_code)
+
+        consts = [self._const(arg, top, ordinal, il_code, symbol_table, c)
+                  for arg, top, ordinal in zip(self.args[1:], (1, 3),
+                                               ("second", "third"))]
+        locality = consts[1] if len(consts) == 2 else 3
+        il_code.add(stream_cmds.Prefetch(addr, locality))
+        return ILValue(ctypes.void)
+
+    def _const(self, arg, top, ordinal, il_code, symbol_table, c):
+        """Return the value of an argument which must be an integer constant
+        from 0 to `top`.
+        """
+        val = arg.const_value(il_code, symbol_table, c)
+        if (not val or val.base or not val.ctype.is_integral()
+              or val.val not in range(top + 1)):
+            name = self.identifier.content
+            err = (f"{ordinal} argument of '{name}' must be an integer "
+                   f"constant from 0 to {top}")
+            raise CompilerError(err, arg.r)
+        return val.val
+
+
+class BuiltinNontemporalStore(_RExprNode):
+    """Call of `__builtin_nontemporal_store(val, p)`, which stores `val` to
+    the object at pointer `p` around the cache.
+
+    The object has integral or pointer type, and `val` is converted to its
+    type, as by assignment.
+
+    args - List of expressions for each argument
+    """
+
+    __slots__ = ("identifier", "args")
+
+    def __init__(self, identifier, args):
+        """Initialize node."""
+        super().__init__()
+        self.identifier = identifier
+        self.args = args
+
+    def make_il(self, il_code, symbol_table, c):
+        """Make code for this node."""
+        name = self.identifier.content
+        if len(self.args) != 2:
+            err = ("incorrect number of arguments for function call"
+                   f" (expected 2, have {len(self.args)})")
+            raise CompilerError(err, self.args[-1].r if self.args else self.r)
+
+        val = self.args[0].make_il(il_code, symbol_table, c)
+        addr = self.args[1].make_il(il_code, symbol_table, c)
+        if not addr.ctype.is_pointer():
+            err = f"second argument of '{name}' must have pointer type"
+            raise CompilerError(err, self.args[1].r)
+
+        ctype = addr.ctype.arg
+        if not (ctype.is_integral() or ctype.is_pointer()):
+            err = (f"second argument of '{name}' must point to an integer "
+                   "or pointer")
+            raise CompilerError(err, self.args[1].r)
+        if ctype.is_const():
+            err = f"second argument of '{name}' points to a const object"
+            raise CompilerError(err, self.args[1].r)
+
+        check_cast(val, ctype.make_unqual(), self.args[0].r)
+        val = set_type(val, ctype.make_unqual(), il_code)
+        il_code.add(stream_cmds.NontemporalStore(addr, val))
+        return ILValue(ctypes.void)
+
+
+# Builtins on the bits of an integer, and for each the IL command computing
+# it and the type of its argument.
+bit_builtins = {
+    "__builtin_popcount": (math_cmds.PopCount, ctypes.unsig_int),
+    "__builtin_popcountl": (math_cmds.PopCount, ctypes.unsig_longint),
+    "__builtin_popcountll": (math_cmds.PopCount, ctypes.unsig_longint),
+    "__builtin_ctz": (math_cmds.CountTrailingZeros, ctypes.unsig_int),
+    "__builtin_ctzl": (math_cmds.CountTrailingZeros, ctypes.unsig_longint),
+    "__builtin_ctzll": (math_cmds.CountTrailingZeros, ctypes.unsig_longint),
+    "__builtin_clz": (math_cmds.CountLeadingZeros, ctypes.unsig_int),
+    "__builtin_clzl": (math_cmds.CountLeadingZeros, ctypes.unsig_longint),
+    "__builtin_clzll": (math_cmds.CountLeadingZeros, ctypes.unsig_longint),
+    "__builtin_bswap16": (math_cmds.ByteSwap, ctypes.unsig_short),
+    "__builtin_bswap32": (math_cmds.ByteSwap, ctypes.unsig_int),
+    "__builtin_bswap64": (math_cmds.ByteSwap, ctypes.unsig_longint),
+}
+
+# Builtins accessing an object atomically, and for each the IL command
+# accessing it, the number of arguments it takes, and the IL command which
+# computes the value it returns from the old value of the object, if any.
+atomic_builtins = {
+    "__atomic_load_n": (atomic_cmds.AtomicLoad, 2, None),
+    "__atomic_store_n": (atomic_cmds.AtomicStore, 3, None),
+    "__atomic_exchange_n": (atomic_cmds.AtomicExchange, 3, None),
+    "__atomic_fetch_add": (atomic_cmds.AtomicFetchAdd, 3, None),
+    "__atomic_fetch_sub": (atomic_cmds.AtomicFetchSub, 3, None),
+    "__atomic_add_fetch": (atomic_cmds.AtomicFetchAdd, 3, math_cmds.Add),
+    "__atomic_sub_fetch": (atomic_cmds.AtomicFetchSub, 3, math_cmds.Subtr),
+    "__atomic_compare_exchange_n": (
+        atomic_cmds.AtomicCompareExchange, 6, None),
+    "__atomic_thread_fence": (atomic_cmds.AtomicFence, 1, None),
+}
+
+# Functions built into the compiler, which are called without being declared,
+# and the node made for each call.
+builtins = {"__builtin_expect": BuiltinExpect,
+            "__builtin_prefetch": BuiltinPrefetch,
+            "__builtin_nontemporal_store": BuiltinNontemporalStore}
+builtins.update(dict.fromkeys(bit_builtins, BuiltinBits))
+builtins.update(dict.fromkeys(atomic_builtins, BuiltinAtomic))
+
+# Library functions whose calls FuncCall may expand inline, and the number
+# of arguments each takes.
+library_functions = {"memcpy": 3, "memmove": 3, "memset": 3, "strlen": 1}
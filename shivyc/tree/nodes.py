@@ -1,28 +1,52 @@
 """Nodes in the AST which represent statements or declarations."""
 
+import shivyc.abi as abi
 import shivyc.ctypes as ctypes
+import shivyc.spots as spots
+import shivyc.il_cmds.compare as compare_cmds
 import shivyc.il_cmds.control as control_cmds
+import shivyc.il_cmds.inline_asm as inline_asm
 import shivyc.il_cmds.value as value_cmds
 import shivyc.token_kinds as token_kinds
 import shivyc.tree.decl_nodes as decl_nodes
 from shivyc.ctypes import (PointerCType, ArrayCType, FunctionCType,
                            StructCType, UnionCType)
-from shivyc.errors import CompilerError
-from shivyc.il_gen import ILValue
-from shivyc.tree.utils import DirectLValue, report_err, set_type, check_cast
+from shivyc.errors import CompilerError, error_collector
+from shivyc.il_gen import FunctionLabel, ILValue
+from shivyc.timing import timer
+from shivyc.tree.utils import (Constant, DirectLValue, RelativeLValue,
+                               report_err, set_type, check_cast,
+                               shift_into_range)
 
 
 class Node:
     """Base class for representing a single node in the AST.
 
-    All AST nodes inherit from this class.
+    All AST nodes inherit from this class. Every class of node lists its
+    members in __slots__, so that nodes take no more memory than they need.
+
+    start_token (Token) - first token of this node, set by the parser
+    end_token (Token) - last token of this node, set by the parser
     """
 
+    __slots__ = ("start_token", "end_token")
+
     def __init__(self):
         """Initialize node."""
 
-        # Set range to None because it will be set by the parser.
-        self.r = None
+        # Set tokens to None because they will be set by the parser.
+        self.start_token = self.end_token = None
+        timer.count("ast_nodes")
+
+    @property
+    def r(self):
+        """Range from the first to the last token of this node, if any.
+
+        A node keeps only its two end tokens, and its Range is made when
+        needed, which is usually only to report an error.
+        """
+        if self.start_token:
+            return self.start_token.r + self.end_token.r
 
     def make_il(self, il_code, symbol_table, c):
         """Generate IL code for this node.
@@ -38,6 +62,8 @@ class Node:
 class Root(Node):
     """Root node of the program."""
 
+    __slots__ = ("nodes",)
+
     def __init__(self, nodes):
         """Initialize node."""
         super().__init__()
@@ -45,15 +71,29 @@ class Root(Node):
 
     def make_il(self, il_code, symbol_table, c):
         """Make code for the root."""
-        for node in self.nodes:
-            with report_err():
+        for _ in self.make_il_each(il_code, symbol_table, c):
+            pass
+
+    def make_il_each(self, il_code, symbol_table, c):
+        """Make code for each external declaration, yielding after each.
+
+        The functions defined by each declaration can then be compiled
+        before the code of the next is made. Each node is dropped from the
+        root once its code is made.
+        """
+        for i, node in enumerate(self.nodes):
+            self.nodes[i] = None
+            with timer.phase("make_il"), report_err():
                 c = c.set_global(True)
                 node.make_il(il_code, symbol_table, c)
+            yield
 
 
 class Compound(Node):
     """Node for a compound statement."""
 
+    __slots__ = ("items",)
+
     def __init__(self, items):
         """Initialize node."""
         super().__init__()
@@ -71,6 +111,7 @@ class Compound(Node):
 
         c = c.set_global(False)
         for item in self.items:
+            il_code.at(item.start_token)
             with report_err():
                 item.make_il(il_code, symbol_table, c)
 
@@ -81,6 +122,8 @@ class Compound(Node):
 class Return(Node):
     """Node for a return statement."""
 
+    __slots__ = ("return_value",)
+
     def __init__(self, return_value):
         """Initialize node."""
         super().__init__()
@@ -93,6 +136,11 @@ class Return(Node):
             il_value = self.return_value.make_il(il_code, symbol_table, c)
             check_cast(il_value, c.return_type, self.return_value.r)
             ret = set_type(il_value, c.return_type, il_code)
+
+            # A large struct is stored where the caller asked for it.
+            if c.return_addr:
+                il_code.add(value_cmds.SetAt(c.return_addr, ret))
+                ret = c.return_addr
             il_code.add(control_cmds.Return(ret))
         elif self.return_value and c.return_type.is_void():
             err = "function with void return type cannot return value"
@@ -107,6 +155,8 @@ class Return(Node):
 class _BreakContinue(Node):
     """Node for a break or continue statement."""
 
+    __slots__ = ()
+
     # Function which accepts a dummy variable and Context and returns the label
     # to which to jump when this statement is encountered.
     get_label = lambda _, c: None
@@ -132,6 +182,8 @@ class _BreakContinue(Node):
 class Break(_BreakContinue):
     """Node for a break statement."""
 
+    __slots__ = ()
+
     get_label = lambda _, c: c.break_label
     descrip = "break"
 
@@ -139,6 +191,8 @@ class Break(_BreakContinue):
 class Continue(_BreakContinue):
     """Node for a continue statement."""
 
+    __slots__ = ()
+
     get_label = lambda _, c: c.continue_label
     descrip = "continue"
 
@@ -146,6 +200,8 @@ class Continue(_BreakContinue):
 class EmptyStatement(Node):
     """Node for a statement which is just a semicolon."""
 
+    __slots__ = ()
+
     def __init__(self):
         """Initialize node."""
         super().__init__()
@@ -158,6 +214,8 @@ class EmptyStatement(Node):
 class ExprStatement(Node):
     """Node for a statement which contains one expression."""
 
+    __slots__ = ("expr",)
+
     def __init__(self, expr):
         """Initialize node."""
         super().__init__()
@@ -177,6 +235,8 @@ class IfStatement(Node):
 
     """
 
+    __slots__ = ("cond", "stat", "else_stat")
+
     def __init__(self, cond, stat, else_stat):
         """Initialize node."""
         super().__init__()
@@ -190,9 +250,10 @@ class IfStatement(Node):
 
         endif_label = il_code.get_label()
         with report_err():
-            cond = self.cond.make_il(il_code, symbol_table, c)
-            il_code.add(control_cmds.JumpZero(cond, endif_label))
+            self.cond.make_branch_il(
+                il_code, symbol_table, c.set_branch(None, endif_label))
 
+        il_code.at(self.stat.start_token)
         with report_err():
             self.stat.make_il(il_code, symbol_table, c)
 
@@ -200,6 +261,7 @@ class IfStatement(Node):
             end_label = il_code.get_label()
             il_code.add(control_cmds.Jump(end_label))
             il_code.add(control_cmds.Label(endif_label))
+            il_code.at(self.else_stat.start_token)
             with report_err():
                 self.else_stat.make_il(il_code, symbol_table, c)
             il_code.add(control_cmds.Label(end_label))
@@ -215,6 +277,8 @@ class WhileStatement(Node):
 
     """
 
+    __slots__ = ("cond", "stat")
+
     def __init__(self, cond, stat):
         """Initialize node."""
         super().__init__()
@@ -230,12 +294,15 @@ class WhileStatement(Node):
         c = c.set_continue(start).set_break(end)
 
         with report_err():
-            cond = self.cond.make_il(il_code, symbol_table, c)
-            il_code.add(control_cmds.JumpZero(cond, end))
+            self.cond.make_branch_il(
+                il_code, symbol_table, c.set_branch(None, end))
 
+        il_code.at(self.stat.start_token)
         with report_err():
             self.stat.make_il(il_code, symbol_table, c)
 
+        # The jump back is made for the test of the loop.
+        il_code.at(self.start_token)
         il_code.add(control_cmds.Jump(start))
         il_code.add(control_cmds.Label(end))
 
@@ -249,6 +316,8 @@ class ForStatement(Node):
     stat - Body of the for-statement
     """
 
+    __slots__ = ("first", "second", "third", "stat")
+
     def __init__(self, first, second, third, stat):
         """Initialize node."""
         super().__init__()
@@ -271,16 +340,20 @@ class ForStatement(Node):
         il_code.add(control_cmds.Label(start))
         with report_err():
             if self.second:
-                cond = self.second.make_il(il_code, symbol_table, c)
-                il_code.add(control_cmds.JumpZero(cond, end))
+                il_code.at(self.second.start_token)
+                self.second.make_branch_il(
+                    il_code, symbol_table, c.set_branch(None, end))
 
+        il_code.at(self.stat.start_token)
         with report_err():
             self.stat.make_il(il_code, symbol_table, c)
 
         il_code.add(control_cmds.Label(cont))
 
+        il_code.at(self.start_token)
         with report_err():
             if self.third:
+                il_code.at(self.third.start_token)
                 self.third.make_il(il_code, symbol_table, c)
 
         il_code.add(control_cmds.Jump(start))
@@ -289,6 +362,623 @@ class ForStatement(Node):
         symbol_table.end_scope()
 
 
+class SwitchStatement(Node):
+    """Node for a switch statement.
+
+    The case labels are dispatched to with a jump table if they are dense,
+    and otherwise with a binary search over their values, which may again
+    find a dense range of values to use a jump table for.
+
+    cond - Controlling expression of the switch-statement.
+    stat - Body of the switch-statement.
+    cases - List of the CaseStatement nodes in the body, not counting those
+    of nested switch-statements.
+    """
+
+    __slots__ = ("cond", "stat", "cases")
+
+    # Fewest case values for which a jump table is used.
+    table_min = 4
+
+    # Most table entries per case value for which a jump table is used.
+    table_spread = 3
+
+    # Most case values which are compared against one by one.
+    linear_max = 3
+
+    def __init__(self, cond, stat, cases):
+        """Initialize node."""
+        super().__init__()
+        self.cond = cond
+        self.stat = stat
+        self.cases = cases
+
+    def make_il(self, il_code, symbol_table, c):
+        """Make code for this node."""
+        value = self.cond.make_il(il_code, symbol_table, c)
+        if not value.ctype.is_integral():
+            err = "switch statement requires expression of integral type"
+            raise CompilerError(err, self.cond.r)
+
+        # perform integer promotion
+        ctype = ctypes.integer if value.ctype.size < 4 else value.ctype
+        value = set_type(value, ctype.make_unqual(), il_code)
+
+        end = il_code.get_label()
+        default = None
+        labels = {}
+        for case in self.cases:
+            case.label = il_code.get_label()
+            with report_err():
+                if not case.value:
+                    if default:
+                        err = "multiple default labels in one switch"
+                        raise CompilerError(err, case.r)
+                    default = case.label
+                    continue
+
+                val = case.get_value(il_code, symbol_table, c, value.ctype)
+                if val in labels:
+                    err = f"duplicate case value {val}"
+                    raise CompilerError(err, case.r)
+                labels[val] = case.label
+
+        self._dispatch(value, sorted(labels.items()), default or end,
+                       il_code)
+
+        with report_err():
+            self.stat.make_il(il_code, symbol_table, c.set_break(end))
+        il_code.add(control_cmds.Label(end))
+
+    def _dispatch(self, value, cases, default, il_code):
+        """Make code to jump to the label of the case `value` matches.
+
+        cases - List of tuples of a case value and its label, sorted by
+        value.
+        default - Label to jump to if no case matches.
+        """
+        if self._dense(cases):
+            low, high = cases[0][0], cases[-1][0]
+            table = {val: label for val, label in cases}
+            labels = [table.get(val, default) for val in range(low, high + 1)]
+            il_code.add(control_cmds.JumpTable(value, low, labels, default))
+
+        elif len(cases) <= self.linear_max:
+            for val, label in cases:
+                cond = ILValue(ctypes.integer)
+                il_code.add(compare_cmds.EqualCmp(
+                    cond, value, self._literal(val, value.ctype, il_code)))
+                il_code.add(control_cmds.JumpNotZero(cond, label))
+            il_code.add(control_cmds.Jump(default))
+
+        else:
+            mid = len(cases) // 2
+            upper = il_code.get_label()
+
+            cond = ILValue(ctypes.integer)
+            il_code.add(compare_cmds.GreaterOrEqCmp(
+                cond, value, self._literal(cases[mid][0], value.ctype,
+                                           il_code)))
+            il_code.add(control_cmds.JumpNotZero(cond, upper))
+            self._dispatch(value, cases[:mid], default, il_code)
+            il_code.add(control_cmds.Label(upper))
+            self._dispatch(value, cases[mid:], default, il_code)
+
+    def _dense(self, cases):
+        """Return whether a jump table should be used for the given cases."""
+        if len(cases) < self.table_min:
+            return False
+        low, high = cases[0][0], cases[-1][0]
+        return (high - low < self.table_spread * len(cases)
+                and ctypes.int_min <= low <= ctypes.int_max)
+
+    def _literal(self, val, ctype, il_code):
+        """Return a literal ILValue of the given value and type."""
+        il_value = ILValue(ctype)
+        il_code.register_literal_var(il_value, val)
+        return il_value
+
+
+class CaseStatement(Node):
+    """Node for a statement with a case or default label.
+
+    value - Expression of the case value, or None for a default label.
+    stat - Statement following the label.
+    label - Label of this statement, set by the enclosing switch-statement
+    when it makes code, or None if there is no enclosing switch-statement.
+    """
+
+    __slots__ = ("value", "stat", "label")
+
+    def __init__(self, value, stat):
+        """Initialize node."""
+        super().__init__()
+        self.value = value
+        self.stat = stat
+        self.label = None
+
+    def get_value(self, il_code, symbol_table, c, ctype):
+        """Return the case value, converted to the given type."""
+        il_value = self.value.make_il(il_code, symbol_table, c)
+        if not il_value.ctype.is_integral() or not il_value.literal:
+            err = "case label must be an integral constant expression"
+            raise CompilerError(err, self.value.r)
+        return shift_into_range(il_value.literal.val, ctype)
+
+    def make_il(self, il_code, symbol_table, c):
+        """Make code for this node."""
+        if not self.label:
+            descrip = "case" if self.value else "default"
+            err = f"{descrip} label not in switch statement"
+            raise CompilerError(err, self.r)
+
+        il_code.add(control_cmds.Label(self.label))
+        self.stat.make_il(il_code, symbol_table, c)
+
+
+class FunctionLabels:
+    """The labels of the goto statements of the function being made.
+
+    A label may be jumped to before it is defined, so each is given its IL
+    label when first named. A computed goto may jump to any label whose
+    address is taken in the function, so the IndirectJump commands of the
+    computed gotos are given those labels once the whole body is made. The
+    labels whose address is held by static data are given their names
+    then too, so that they have symbols.
+
+    il_code (ILCode) - IL code of the function.
+    func (ILValue) - The function.
+    labels (Dict[str, str]) - Map from the name of each label named so far
+    to its IL label.
+    defined (Dict[str, Label]) - Map from the name of each label defined so
+    far to its Label command.
+    uses (Dict[str, Token]) - Map from the name of each label named so far
+    to the token where it was first named.
+    jumps (List[IndirectJump]) - IL commands of the computed gotos.
+    in_data (Set[str]) - Names of the labels whose address is held by
+    static data.
+    """
+
+    def __init__(self, il_code, func):
+        """Initialize FunctionLabels."""
+        self.il_code = il_code
+        self.func = func
+        self.labels = {}
+        self.defined = {}
+        self.uses = {}
+        self.jumps = []
+        self.in_data = set()
+
+    def get(self, token):
+        """Return the IL label of the label named by `token`."""
+        name = token.content
+        if name not in self.labels:
+            self.labels[name] = self.il_code.get_label()
+            self.uses[name] = token
+        return self.labels[name]
+
+    def define(self, token):
+        """Return the Label command of the label `token` defines."""
+        if token.content in self.defined:
+            err = f"redefinition of label '{token.content}'"
+            raise CompilerError(err, token.r)
+        command = control_cmds.Label(self.get(token))
+        self.defined[token.content] = command
+        return command
+
+    def take(self, token):
+        """Return the IL label of the label whose address `token` takes."""
+        label = self.get(token)
+        self.il_code.taken_labels.add(label)
+        return label
+
+    def take_const(self, token):
+        """Return the address of the label `token` names, as the base of
+        an address constant.
+        """
+        self.take(token)
+        return FunctionLabel(self.func, token.content)
+
+    def finish(self):
+        """Check that every label named is defined, and give the computed
+        gotos the labels they may jump to.
+        """
+        for name, token in self.uses.items():
+            if name not in self.defined:
+                with report_err():
+                    err = f"use of undeclared label '{name}'"
+                    raise CompilerError(err, token.r)
+
+        taken = [label for label in self.labels.values()
+                 if label in self.il_code.taken_labels]
+        for jump in self.jumps:
+            jump.labels = list(taken)
+
+        for name in self.in_data:
+            if name in self.defined:
+                self.defined[name].name = name
+
+
+class Goto(Node):
+    """Node for a goto statement.
+
+    label (Token) - Name of the label jumped to.
+    """
+
+    __slots__ = ("label",)
+
+    def __init__(self, label):
+        """Initialize node."""
+        super().__init__()
+        self.label = label
+
+    def make_il(self, il_code, symbol_table, c):
+        """Make code for this node."""
+        il_code.add(control_cmds.Jump(c.labels.get(self.label)))
+
+
+class ComputedGoto(Node):
+    """Node for a goto statement to the address of a label, as taken by
+    `&&label`.
+
+    target - Expression of the address jumped to.
+    """
+
+    __slots__ = ("target",)
+
+    def __init__(self, target):
+        """Initialize node."""
+        super().__init__()
+        self.target = target
+
+    def make_il(self, il_code, symbol_table, c):
+        """Make code for this node."""
+        addr = self.target.make_il(il_code, symbol_table, c)
+        if not addr.ctype.is_pointer():
+            err = "operand of computed goto must have pointer type"
+            raise CompilerError(err, self.target.r)
+
+        jump = control_cmds.IndirectJump(addr, [])
+        c.labels.jumps.append(jump)
+        il_code.add(jump)
+
+
+class LabelStatement(Node):
+    """Node for a statement with a label which goto statements jump to.
+
+    label (Token) - Name of the label.
+    stat - Statement following the label.
+    """
+
+    __slots__ = ("label", "stat")
+
+    def __init__(self, label, stat):
+        """Initialize node."""
+        super().__init__()
+        self.label = label
+        self.stat = stat
+
+    def make_il(self, il_code, symbol_table, c):
+        """Make code for this node."""
+        with report_err():
+            il_code.add(c.labels.define(self.label))
+        il_code.at(self.stat.start_token)
+        self.stat.make_il(il_code, symbol_table, c)
+
+
+class Asm(Node):
+    """Node for a GNU extended asm statement.
+
+    template (Tuple[str, Range]) - Template of the asm, and its range.
+    outputs, inputs (List[Tuple]) - Output and input operands, each a tuple
+    of the identifier token of its name or None, its constraint string and
+    the range of that, and its expression.
+    clobbers (List[Tuple[str, Range]]) - Clobbered registers, and "memory"
+    and "cc", with their ranges.
+    """
+
+    __slots__ = ("template", "outputs", "inputs", "clobbers")
+
+    # Map from the name of each register an asm may clobber to the register.
+    clobber_regs = {name: reg for reg in spots.registers
+                    for name in spots.RegSpot.reg_map[reg.name]}
+    clobber_regs.update((reg.name, reg) for reg in spots.xmm_registers)
+
+    def __init__(self, template, outputs, inputs, clobbers):
+        """Initialize node."""
+        super().__init__()
+        self.template = template
+        self.outputs = outputs
+        self.inputs = inputs
+        self.clobbers = clobbers
+
+    def make_il(self, il_code, symbol_table, c):
+        """Make code for this node.
+
+        The address of each output is computed before the inputs, and each
+        register output is stored after the asm.
+        """
+        clobbers = []
+        memory = False
+        for name, r in self.clobbers:
+            if name == "memory":
+                memory = True
+            elif name in self.clobber_regs:
+                clobbers.append(self.clobber_regs[name])
+            elif name != "cc":
+                err = f"unknown register name '{name}' in 'asm'"
+                raise CompilerError(err, r)
+
+        operands = []
+        ins = []
+        outs = []
+        stores = []
+        reads = []
+        for name, (text, r), expr in self.outputs:
+            con = self._constraint(text, r, True)
+            lvalue = expr.lvalue(il_code, symbol_table, c)
+            if not lvalue or not lvalue.modable():
+                err = "output operand of 'asm' is not assignable"
+                raise CompilerError(err, expr.r)
+
+            ctype = lvalue.ctype()
+            if inline_asm.REG in con.kinds:
+                self._check_reg(ctype, expr.r)
+                out = ILValue(ctype.make_unqual())
+                op = inline_asm.Operand(inline_asm.REG, len(outs), None,
+                                        ctype.size, con.reg, None, True,
+                                        name and name.content)
+                outs.append(out)
+                stores.append((lvalue, out, expr.r))
+                if con.read:
+                    reads.append((len(operands), lvalue))
+            elif inline_asm.MEM in con.kinds:
+                op = inline_asm.Operand(inline_asm.MEM, len(ins), None,
+                                        ctype.size, None, None, True,
+                                        name and name.content)
+                ins.append(lvalue.addr(il_code))
+            else:
+                raise CompilerError("impossible constraint in 'asm'", r)
+            operands.append(op)
+
+        for name, (text, r), expr in self.inputs:
+            con = self._constraint(text, r, False)
+            operands.append(self._input(con, name, expr, r, operands, ins,
+                                        il_code, symbol_table, c))
+
+        # An output which is read as well is matched by a hidden input.
+        count = len(operands)
+        for n, lvalue in reads:
+            op = operands[n]
+            operands.append(inline_asm.Operand(
+                inline_asm.REG, len(ins), None, op.size, None, n, False,
+                None))
+            ins.append(lvalue.val(il_code))
+
+        template, r = self.template
+        self._check_template(template, r, operands[:count])
+        il_code.add(inline_asm.InlineAsm(template, operands, ins, outs,
+                                         clobbers, memory, self.r))
+        for lvalue, out, r in stores:
+            lvalue.set_to(out, il_code, r)
+
+    def _constraint(self, text, r, output):
+        """Return the Constraint of an operand, checking it is allowed for
+        an output or an input as given.
+        """
+        try:
+            con = inline_asm.parse_constraint(text)
+        except ValueError as e:
+            raise CompilerError(str(e), r)
+
+        if output and not con.output:
+            raise CompilerError("output operand constraint lacks '='", r)
+        elif not output and con.output:
+            err = f"input operand constraint contains '{text[0]}'"
+            raise CompilerError(err, r)
+        elif output and con.tie is not None:
+            err = "matching constraint not valid in output operand"
+            raise CompilerError(err, r)
+        return con
+
+    def _input(self, con, name, expr, r, operands, ins, il_code,
+               symbol_table, c):
+        """Make code for an input operand, and return its Operand."""
+        name = name and name.content
+        if con.tie is not None:
+            if (con.tie >= len(self.outputs)
+                  or operands[con.tie].kind != inline_asm.REG
+                  or self.outputs[con.tie][1][0].startswith("+")
+                  or any(op.tie == con.tie for op in operands)):
+                err = "matching constraint references invalid operand number"
+                raise CompilerError(err, r)
+
+        if inline_asm.IMM in con.kinds:
+            val = expr.const_value(il_code, symbol_table, c)
+            if val and not val.base and val.ctype.is_integral():
+                return inline_asm.Operand(inline_asm.IMM, None, val.val,
+                                          val.ctype.size, None, None, False,
+                                          name)
+            elif con.kinds == {inline_asm.IMM}:
+                raise CompilerError("impossible constraint in 'asm'", r)
+
+        if inline_asm.REG in con.kinds:
+            val = expr.make_il(il_code, symbol_table, c)
+            self._check_reg(val.ctype, expr.r)
+            ins.append(val)
+            return inline_asm.Operand(inline_asm.REG, len(ins) - 1, None,
+                                      val.ctype.size, con.reg, con.tie,
+                                      False, name)
+
+        lvalue = expr.lvalue(il_code, symbol_table, c)
+        if not lvalue:
+            err = "memory input of 'asm' is not an lvalue"
+            raise CompilerError(err, expr.r)
+        ins.append(lvalue.addr(il_code))
+        return inline_asm.Operand(inline_asm.MEM, len(ins) - 1, None,
+                                  lvalue.ctype().size, None, None, False,
+                                  name)
+
+    def _check_reg(self, ctype, r):
+        """Check that a value of type `ctype` fits in a general register."""
+        if not ctype.is_scalar() or ctype.is_floating():
+            err = "register operand of 'asm' must have integer or pointer type"
+            raise CompilerError(err, r)
+
+    def _check_template(self, template, r, operands):
+        """Check that the template only names the given operands."""
+        try:
+            pieces = inline_asm.parse_template(template)
+        except ValueError as e:
+            raise CompilerError(str(e), r)
+
+        names = {op.name for op in operands}
+        for piece in pieces:
+            if isinstance(piece, str) or piece[1] is None:
+                continue
+            operand = piece[1]
+            if isinstance(operand, str) and operand not in names:
+                err = f"undefined named operand '{operand}' in 'asm'"
+                raise CompilerError(err, r)
+            elif isinstance(operand, int) and operand >= len(operands):
+                raise CompilerError("operand number out of range in 'asm'", r)
+
+
+def _flatten_init(ctype, init):
+    """Return the scalar initializers of an object from its initializer.
+
+    Braces may be left out around the initializer of a member, in which
+    case the member takes as many initializers of the list as it has
+    scalars. Members without an initializer are zero, so they are not
+    listed.
+
+    ctype - Type of the object.
+    init - The initializer of the object.
+    returns - The type of the object, with the size of an array of unknown
+    size given by the number of its elements initialized, and a list of the
+    (offset, ctype, init) triples for each scalar initialized, where init
+    is an expression node or, for a character of a string, a Constant.
+    """
+    inits = []
+
+    def init_object(ctype, items, pos, offset):
+        """Initialize an object from items[pos:].
+
+        returns - the position after the items used, and the number of
+        elements initialized if the object is an array
+        """
+        item = items[pos]
+        if (ctype.is_array() and isinstance(item, decl_nodes.InitList)
+              and len(item.items) == 1 and _string_chars(item.items[0])):
+            item = item.items[0]
+
+        chars = _string_chars(item)
+        if ctype.is_array() and chars and _is_char_type(ctype.el):
+            length = len(chars) if ctype.n is None else ctype.n
+            if len(chars) - 1 > length:
+                err = "initializer-string for char array is too long"
+                raise CompilerError(err, item.r)
+            for i, char in enumerate(chars[:length]):
+                inits.append((offset + i, ctype.el, Constant(ctype.el, char)))
+            return pos + 1, length
+        elif isinstance(item, decl_nodes.InitList) and ctype.is_scalar():
+            if len(item.items) != 1:
+                err = "scalar initializer must have one element"
+                raise CompilerError(err, item.r)
+            init_object(ctype, item.items, 0, offset)
+            return pos + 1, None
+        elif isinstance(item, decl_nodes.InitList):
+            _, count = init_members(ctype, item.items, 0, offset, True)
+            return pos + 1, count
+        elif ctype.is_scalar():
+            inits.append((offset, ctype, item))
+            return pos + 1, None
+        else:
+            return init_members(ctype, items, pos, offset, False)
+
+    def init_members(ctype, items, pos, offset, braced):
+        """Initialize the members of an aggregate from items[pos:].
+
+        If the list is not braced, initializing stops after the last
+        member, and the rest of the items are left for the next object.
+
+        returns - as for init_object
+        """
+        count = None
+        if ctype.is_array():
+            count = 0
+            while pos < len(items) and (ctype.n is None or count < ctype.n):
+                pos, _ = init_object(ctype.el, items, pos,
+                                     offset + count * ctype.el.size)
+                count += 1
+        else:
+            members = ctype.members
+            if isinstance(ctype, UnionCType):
+                members = members[:1]
+            for member, _ in members:
+                if pos == len(items):
+                    break
+                member_offset, member_ctype = ctype.get_offset(member)
+                pos, _ = init_object(member_ctype, items, pos,
+                                     offset + member_offset)
+
+        if braced and pos < len(items):
+            err = "excess elements in initializer"
+            raise CompilerError(err, items[pos].r)
+        return pos, count
+
+    _, count = init_object(ctype, [init], 0, 0)
+    if ctype.is_array() and ctype.n is None:
+        ctype = ArrayCType(ctype.el, count or None)
+    return ctype, inits
+
+
+def _string_chars(node):
+    """Return the characters of an initializer if it is a string literal."""
+    import shivyc.tree.expr_nodes as expr_nodes
+
+    while isinstance(node, expr_nodes.ParenExpr):
+        node = node.expr
+    if isinstance(node, expr_nodes.String):
+        return node.chars
+    return None
+
+
+def _is_char_type(ctype):
+    """Return whether ctype is a character type, which a string initializes.
+    """
+    return ctype.is_integral() and ctype.size == 1 and not ctype.is_bool()
+
+
+def _const_init(init, ctype, il_code, symbol_table, c):
+    """Return the value of a scalar initializer, if it is constant.
+
+    init - Expression node or Constant initializing an object of `ctype`.
+    returns - The Constant converted to `ctype`, or None if the value is
+    not constant or is an address which does not fit in `ctype`.
+    """
+    if isinstance(init, Constant):
+        return init
+
+    const = init.const_value(il_code, symbol_table, c)
+    if not const:
+        return None
+    check_cast(const.il_value(il_code), ctype, init.r)
+    return const.convert(ctype)
+
+
+def _image_value(const):
+    """Return a constant as a value of the image static_initialize takes.
+
+    A floating value is given by the bits which represent it.
+    """
+    if const.base:
+        return const.base, const.val
+    elif const.ctype.is_floating():
+        return ctypes.float_bits(const.val, const.ctype.size)
+    return const.val
+
+
 class DeclInfo:
     """Contains information about the declaration of one identifier.
 
@@ -296,6 +986,9 @@ class DeclInfo:
     ctype - the ctype of this identifier
     storage - the storage class of this identifier
     init - the initial value of this identifier
+    inline - whether this identifier was declared with `inline`
+    thread_local - whether this identifier was declared with
+    `_Thread_local` or `__thread`
     """
 
     # Storage class specifiers for declarations
@@ -305,7 +998,8 @@ class DeclInfo:
     TYPEDEF = 4
 
     def __init__(self, identifier, ctype, range,
-                 storage=None, init=None, body=None, param_names=None):
+                 storage=None, init=None, body=None, param_names=None,
+                 inline=False, thread_local=False):
         self.identifier = identifier
         self.ctype = ctype
         self.range = range
@@ -313,6 +1007,8 @@ class DeclInfo:
         self.init = init
         self.body = body
         self.param_names = param_names
+        self.inline = inline
+        self.thread_local = thread_local
 
     def process(self, il_code, symbol_table, c):
         """Process given DeclInfo object.
@@ -324,6 +1020,9 @@ class DeclInfo:
             err = "missing identifier name in declaration"
             raise CompilerError(err, self.range)
 
+        if self.thread_local:
+            self.check_thread_local(c)
+
         # The typedef is special
         if self.storage == self.TYPEDEF:
             self.process_typedef(symbol_table)
@@ -333,6 +1032,10 @@ class DeclInfo:
             err = "function definition provided for non-function type"
             raise CompilerError(err, self.range)
 
+        if self.inline and not self.ctype.is_function():
+            err = "'inline' specifier on declaration of non-function"
+            raise CompilerError(err, self.range)
+
         linkage = self.get_linkage(symbol_table, c)
         defined = self.get_defined(symbol_table, c)
         storage = self.get_storage(defined, linkage, symbol_table)
@@ -346,7 +1049,11 @@ class DeclInfo:
             self.ctype,
             defined,
             linkage,
-            storage)
+            storage,
+            self.thread_local)
+
+        if self.inline:
+            symbol_table.inline_hints.add(var)
 
         if self.init:
             self.do_init(var, storage, il_code, symbol_table, c)
@@ -357,6 +1064,22 @@ class DeclInfo:
             err = "variable of incomplete type declared"
             raise CompilerError(err, self.range)
 
+    def check_thread_local(self, c):
+        """Check that a declaration with `_Thread_local` is of an object
+        with static storage.
+        """
+        if self.storage in {self.AUTO, self.TYPEDEF}:
+            err = ("'_Thread_local' may only be combined with 'static' or "
+                   "'extern'")
+            raise CompilerError(err, self.range)
+        if self.ctype.is_function():
+            err = "'_Thread_local' on declaration of function"
+            raise CompilerError(err, self.range)
+        if not c.is_global and not self.storage:
+            err = ("local variable declared '_Thread_local' must be "
+                   "'static' or 'extern'")
+            raise CompilerError(err, self.range)
+
     def process_typedef(self, symbol_table):
         """Process type declarations."""
 
@@ -375,22 +1098,111 @@ class DeclInfo:
 
         Caller must check that this object has an initializer.
         """
-        # little bit hacky, but will be fixed when full initializers are
-        # implemented shortly
-
-        init = self.init.make_il(il_code, symbol_table, c)
-        if storage == symbol_table.STATIC and not init.literal:
-            err = ("non-constant initializer for variable with static "
-                   "storage duration")
-            raise CompilerError(err, self.init.r)
-        elif storage == symbol_table.STATIC:
-            il_code.static_initialize(var, getattr(init.literal, "val", None))
-        elif var.ctype.is_arith() or var.ctype.is_pointer():
+        if not var.ctype.is_scalar() and not (
+                (var.ctype.is_array() or var.ctype.is_struct_union()
+                 and var.ctype.is_complete())
+                and self.is_aggregate_init(var.ctype)):
+            err = "declared variable is not of assignable type"
+            raise CompilerError(err, self.range)
+
+        ctype, inits = _flatten_init(var.ctype, self.init)
+        var.ctype = self.ctype = ctype
+
+        if storage == symbol_table.STATIC:
+            self.do_static_init(var, inits, il_code, symbol_table, c)
+        elif var.ctype.is_scalar():
+            init = inits[0][2].make_il(il_code, symbol_table, c)
             lval = DirectLValue(var)
             lval.set_to(init, il_code, self.identifier.r)
         else:
-            err = "declared variable is not of assignable type"
-            raise CompilerError(err, self.range)
+            self.do_aggregate_init(var, inits, il_code, symbol_table, c)
+
+    def is_aggregate_init(self, ctype):
+        """Return whether the initializer is one for an array or struct.
+
+        This is a braced list, or a string literal for a character array.
+        """
+        return (isinstance(self.init, decl_nodes.InitList)
+                or (ctype.is_array() and _string_chars(self.init)
+                    and _is_char_type(ctype.el)))
+
+    def do_static_init(self, var, inits, il_code, symbol_table, c):
+        """Initialize a variable with static storage to a constant.
+
+        The initializer is evaluated at compile time into an image of the
+        data of the variable, so the values are there when the program
+        starts and no code is run to store them.
+        """
+        image = []
+        for offset, ctype, init in inits:
+            const = _const_init(init, ctype, il_code, symbol_table, c)
+            if not const:
+                err = ("non-constant initializer for variable with static "
+                       "storage duration")
+                raise CompilerError(err, init.r)
+            if isinstance(const.base, FunctionLabel):
+                c.labels.in_data.add(const.base.name)
+            image.append((offset, ctype.size, _image_value(const)))
+        il_code.static_initialize(var, image)
+
+    def do_aggregate_init(self, var, inits, il_code, symbol_table, c):
+        """Create code initializing a local array or struct.
+
+        The nonzero constants of the initializer are copied in one block
+        from a read-only template of the object, the bytes which have no
+        initializer are zeroed in runs, and only the values which are not
+        constant are stored one at a time. A single nonzero constant is
+        stored directly, rather than copied from a template of its own.
+        """
+        covered = bytearray(var.ctype.size)
+        consts = []
+        stores = []
+        for offset, ctype, init in inits:
+            const = _const_init(init, ctype, il_code, symbol_table, c)
+            # The address of a label is stored by code, so that the label
+            # needs no symbol and the function may still be inlined.
+            if const and isinstance(const.base, FunctionLabel):
+                const = None
+            if const and not const.base and not _image_value(const):
+                continue
+            elif const:
+                consts.append((offset, ctype, init, const))
+            else:
+                stores.append((offset, ctype, init, None))
+            covered[offset:offset + ctype.size] = b"\1" * ctype.size
+
+        end = 0
+        if len(consts) > 1:
+            end = max(offset + ctype.size for offset, ctype, _, _ in consts)
+            covered[:end] = b"\1" * end
+
+            template = symbol_table.add_static_object(
+                ArrayCType(ctypes.char.make_const(), end),
+                f"__init_{self.identifier.content}")
+            il_code.static_initialize(
+                template, [(offset, ctype.size, _image_value(const))
+                           for offset, ctype, _, const in consts])
+            il_code.add(value_cmds.SetRel(template, var, 0))
+        else:
+            stores.extend(consts)
+
+        start = None
+        for i in range(len(covered) + 1):
+            if i < len(covered) and not covered[i]:
+                start = i if start is None else start
+            elif start is not None:
+                il_code.add(value_cmds.ZeroRel(var, start, i - start))
+                start = None
+
+        for offset, ctype, init, const in stores:
+            if const and not const.base:
+                val = ILValue(ctype)
+                il_code.register_literal_var(val, const.val)
+                r = self.range
+            else:
+                val = init.make_il(il_code, symbol_table, c)
+                r = init.r
+            RelativeLValue(ctype, var, offset).set_to(val, il_code, r)
 
     def do_body(self, il_code, symbol_table, c):
         """Create code for function body.
@@ -407,8 +1219,16 @@ class DeclInfo:
         if is_main:
             self.check_main_type()
 
-        c = c.set_return(self.ctype.ret)
         il_code.start_func(self.identifier.content)
+        il_code.at(self.identifier)
+
+        return_addr = None
+        if abi.in_memory(self.ctype.ret):
+            return_addr = ILValue(PointerCType(self.ctype.ret))
+            il_code.add(value_cmds.LoadArg(return_addr, None, self.ctype))
+        c = c.set_return(self.ctype.ret, return_addr)
+        c = c.set_labels(FunctionLabels(
+            il_code, symbol_table.lookup_variable(self.identifier)))
 
         symbol_table.new_scope()
 
@@ -418,9 +1238,13 @@ class DeclInfo:
             arg = symbol_table.add_variable(
                 param, ctype, symbol_table.DEFINED, None,
                 symbol_table.AUTOMATIC)
-            il_code.add(value_cmds.LoadArg(arg, i))
+            il_code.add(value_cmds.LoadArg(arg, i, self.ctype))
 
         self.body.make_il(il_code, symbol_table, c, no_scope=True)
+        c.labels.finish()
+
+        # The return at the end of the body is made for its closing brace.
+        il_code.at(self.body.end_token)
         if not il_code.always_returns() and is_main:
             zero = ILValue(ctypes.integer)
             il_code.register_literal_var(zero, 0)
@@ -508,6 +1332,8 @@ class Declaration(Node):
     the function
     """
 
+    __slots__ = ("node", "body", "il_code", "symbol_table", "c")
+
     def __init__(self, node, body=None):
         """Initialize node."""
         super().__init__()
@@ -539,6 +1365,10 @@ class Declaration(Node):
 
         any_dec = bool(node.decls)
         base_type, storage = self.make_specs_ctype(node.specs, any_dec)
+        inline = token_kinds.inline_kw in {spec.kind for spec in node.specs}
+        thread_local = any(spec.kind in {token_kinds.thread_local_kw,
+                                         token_kinds.thread_kw}
+                           for spec in node.specs)
 
         out = []
         for decl, init in zip(node.decls, node.inits):
@@ -552,7 +1382,7 @@ class Declaration(Node):
 
                 out.append(DeclInfo(
                     identifier, ctype, decl.r, storage, init,
-                    self.body, param_identifiers))
+                    self.body, param_identifiers, inline, thread_local))
 
         return out
 
@@ -567,7 +1397,8 @@ class Declaration(Node):
         current one.
         """
         if isinstance(decl, decl_nodes.Pointer):
-            new_ctype = PointerCType(prev_ctype, decl.const)
+            new_ctype = self.qualify(PointerCType(prev_ctype), decl.quals,
+                                     decl.r)
         elif isinstance(decl, decl_nodes.Array):
             new_ctype = self._generate_array_ctype(decl, prev_ctype)
         elif isinstance(decl, decl_nodes.Function):
@@ -581,20 +1412,20 @@ class Declaration(Node):
         """Generate a function ctype from a given a decl_node."""
 
         if decl.n:
-            il_value = decl.n.make_il(self.il_code, self.symbol_table, self.c)
-            if not il_value.ctype.is_integral():
+            size = decl.n.const_value(self.il_code, self.symbol_table, self.c)
+            if size and not size.ctype.is_integral():
                 err = "array size must have integral type"
                 raise CompilerError(err, decl.r)
-            if not il_value.literal:
+            if not size or size.base:
                 err = "array size must be compile-time constant"
                 raise CompilerError(err, decl.r)
-            if il_value.literal.val <= 0:
+            if size.val <= 0:
                 err = "array size must be positive"
                 raise CompilerError(err, decl.r)
             if not prev_ctype.is_complete():
                 err = "array elements must have complete type"
                 raise CompilerError(err, decl.r)
-            return ArrayCType(prev_ctype, il_value.literal.val)
+            return ArrayCType(prev_ctype, size.val)
         else:
             return ArrayCType(prev_ctype, None)
 
@@ -604,7 +1435,7 @@ class Declaration(Node):
         # Prohibit storage class specifiers in parameters.
         for param in decl.args:
             decl_info = self.get_decl_infos(param)[0]
-            if decl_info.storage:
+            if decl_info.storage or decl_info.thread_local:
                 err = "storage class specified for function parameter"
                 raise CompilerError(err, decl_info.range)
 
@@ -685,7 +1516,6 @@ class Declaration(Node):
         """
         spec_range = specs[0].r + specs[-1].r
         storage = self.get_storage([spec.kind for spec in specs], spec_range)
-        const = token_kinds.const_kw in {spec.kind for spec in specs}
 
         struct_union_specs = {token_kinds.struct_kw, token_kinds.union_kw}
         if any(s.kind in struct_union_specs for s in specs):
@@ -704,9 +1534,26 @@ class Declaration(Node):
         else:
             base_type = self.get_base_ctype(specs, spec_range)
 
-        if const: base_type = base_type.make_const()
+        base_type = self.qualify(base_type, {spec.kind for spec in specs},
+                                 spec_range)
         return base_type, storage
 
+    def qualify(self, ctype, kinds, r):
+        """Return `ctype` with the type qualifiers among the token `kinds`.
+
+        Only a pointer type may be restrict-qualified.
+        """
+        if token_kinds.const_kw in kinds:
+            ctype = ctype.make_const()
+        if token_kinds.volatile_kw in kinds:
+            ctype = ctype.make_volatile()
+        if token_kinds.restrict_kw in kinds:
+            if not ctype.is_pointer():
+                err = "invalid use of 'restrict'"
+                raise CompilerError(err, r)
+            ctype = ctype.make_restrict()
+        return ctype
+
     def get_base_ctype(self, specs, spec_range):
         """Return a base ctype given a list of specs."""
 
@@ -748,6 +1595,9 @@ class Declaration(Node):
             "int long signed": ctypes.longint,
             "long unsigned": ctypes.unsig_longint,
             "int long unsigned": ctypes.unsig_longint,
+
+            "float": ctypes.float_t,
+            "double": ctypes.double,
         }
 
         if specs_str in specs:
@@ -842,7 +1692,16 @@ class Declaration(Node):
                     members_set.add(name)
                     members.append((name, decl_info.ctype))
 
-        ctype.set_members(members)
+        # A packed struct or union lays out its members without padding.
+        packed = False
+        for attribute in node.attributes:
+            if attribute.content in {"packed", "__packed__"}:
+                packed = True
+            else:
+                err = f"ignoring unknown attribute '{attribute.content}'"
+                error_collector.add(CompilerError(err, attribute.r, True))
+
+        ctype.set_members(members, packed)
         return ctype
 
     def _check_struct_member_decl_info(self, decl_info, kind, members):
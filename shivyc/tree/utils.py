@@ -1,8 +1,11 @@
 """Utility objects for the AST nodes and IL generation steps of ShivyC."""
 
+import math
 from contextlib import contextmanager
 
 import shivyc.ctypes as ctypes
+import shivyc.il_cmds.atomic as atomic_cmds
+import shivyc.il_cmds.floating as float_cmds
 import shivyc.il_cmds.value as value_cmds
 import shivyc.il_cmds.math as math_cmds
 
@@ -41,6 +44,31 @@ class LValue:
         """Generate code for and return the value currently stored."""
         raise NotImplementedError
 
+    def volatile(self):
+        """Return whether this is a volatile scalar.
+
+        Each read and write of such an lvalue is an atomic access with
+        relaxed order through its address, which the optimizer does not
+        move, merge with another, or remove, and which keeps the object in
+        memory.
+        """
+        return self.ctype().is_volatile() and self.ctype().is_scalar()
+
+    def _load(self, il_code):
+        """Emit a read of this volatile lvalue, and return its value."""
+        out = ILValue(self.ctype().make_unqual())
+        il_code.add(atomic_cmds.AtomicLoad(out, self.addr(il_code),
+                                           atomic_cmds.RELAXED))
+        return out
+
+    def _store(self, rvalue, il_code, r):
+        """Emit a write of this volatile lvalue, as for set_to."""
+        check_cast(rvalue, self.ctype(), r)
+        right_cast = set_type(rvalue, self.ctype().make_unqual(), il_code)
+        il_code.add(atomic_cmds.AtomicStore(self.addr(il_code), right_cast,
+                                            atomic_cmds.RELAXED))
+        return right_cast
+
     def modable(self):
         """Return whether this is a modifiable lvalue."""
 
@@ -74,6 +102,8 @@ class DirectLValue(LValue):
         return self.il_value.ctype
 
     def set_to(self, rvalue, il_code, r):  # noqa D102
+        if self.volatile():
+            return self._store(rvalue, il_code, r)
         check_cast(rvalue, self.ctype(), r)
         return set_type(rvalue, self.ctype(), il_code, self.il_value)
 
@@ -83,6 +113,8 @@ class DirectLValue(LValue):
         return out
 
     def val(self, il_code):  # noqa D102
+        if self.volatile():
+            return self._load(il_code)
         return self.il_value
 
 
@@ -105,6 +137,8 @@ class IndirectLValue(LValue):
         return self.addr_val.ctype.arg
 
     def set_to(self, rvalue, il_code, r):  # noqa D102
+        if self.volatile():
+            return self._store(rvalue, il_code, r)
         check_cast(rvalue, self.ctype(), r)
         right_cast = set_type(rvalue, self.ctype(), il_code)
         il_code.add(value_cmds.SetAt(self.addr_val, right_cast))
@@ -114,6 +148,8 @@ class IndirectLValue(LValue):
         return self.addr_val
 
     def val(self, il_code):  # noqa D102
+        if self.volatile():
+            return self._load(il_code)
         out = ILValue(self.ctype())
         il_code.add(value_cmds.ReadAt(out, self.addr_val))
         return out
@@ -193,7 +229,7 @@ class RelativeLValue(LValue):
         self.fixed_chunk = new_chunk
 
         scale = ILValue(ctypes.longint)
-        scale_factor = str(int(self.chunk / new_chunk))
+        scale_factor = self.chunk // new_chunk
         il_code.register_literal_var(scale, scale_factor)
 
         self.fixed_count = ILValue(ctypes.longint)
@@ -203,6 +239,8 @@ class RelativeLValue(LValue):
         return self._ctype
 
     def set_to(self, rvalue, il_code, r):
+        if self.volatile():
+            return self._store(rvalue, il_code, r)
         self._fix_chunk_count(il_code)
         check_cast(rvalue, self.ctype(), r)
         right_cast = set_type(rvalue, self.ctype(), il_code)
@@ -218,6 +256,8 @@ class RelativeLValue(LValue):
         return out
 
     def val(self, il_code):
+        if self.volatile():
+            return self._load(il_code)
         self._fix_chunk_count(il_code)
         out = ILValue(self.ctype())
         il_code.add(value_cmds.ReadRel(
@@ -225,6 +265,63 @@ class RelativeLValue(LValue):
         return out
 
 
+class Constant:
+    """Value of a constant expression, computed at compile time.
+
+    A constant is either a number or an address constant, which is the
+    address of an object with static storage, of a function, or of a label
+    of the function being made, plus a fixed number of bytes. The value of
+    an address constant is not known until link time, so it can only
+    initialize static data.
+
+    ctype - CType of the value
+    val (int or float) - The value, or for an address constant the offset
+    in bytes from the start of `base`.
+    base (ILValue or FunctionLabel) - Object, function, or label an address
+    constant points into, or None if the value is just the number `val`.
+    """
+
+    def __init__(self, ctype, val, base=None):
+        """Initialize Constant."""
+        self.ctype = ctype
+        self.val = val
+        self.base = base
+
+    def il_value(self, il_code):
+        """Return an ILValue of this constant's type, to type check it.
+
+        An integer constant is registered as a literal, so a constant 0 is
+        recognized as a null pointer constant.
+        """
+        out = ILValue(self.ctype)
+        if not self.base:
+            il_code.register_literal_var(out, self.val)
+        return out
+
+    def convert(self, ctype):
+        """Return this constant converted to the given scalar ctype.
+
+        An address constant cannot be narrowed to an integer type smaller
+        than a pointer, nor converted to a floating type, so for that
+        conversion None is returned. Neither is an infinite or NaN value
+        converted to an integer type.
+        """
+        if ctype.is_bool():
+            return Constant(ctype, int(bool(self.base or self.val)))
+        elif self.base and (ctype.size != 8 or ctype.is_floating()):
+            return None
+        elif ctype.is_floating() or self.ctype.is_floating():
+            val = _convert_literal(self.val, self.ctype, ctype)
+            return Constant(ctype, val) if val is not None else None
+        elif self.base:
+            return Constant(ctype, self.val, self.base)
+        elif ctype.is_integral():
+            return Constant(ctype, shift_into_range(self.val, ctype))
+        else:
+            return Constant(ctype, shift_into_range(self.val,
+                                                    ctypes.unsig_longint))
+
+
 @contextmanager
 def report_err():
     """Catch and add any errors to error collector."""
@@ -264,16 +361,16 @@ def check_cast(il_value, ctype, range):
         # of compatible types, and the type pointed to by the left has all
         # the qualifiers of the type pointed to by the right
         if (ctype.arg.weak_compat(il_value.ctype.arg) and
-             (not il_value.ctype.arg.const or ctype.arg.const)):
+             ctype.arg.has_quals_of(il_value.ctype.arg)):
             return
 
         # Cast between void pointer and pointer to object type okay
         elif (ctype.arg.is_void() and il_value.ctype.arg.is_object() and
-              (not il_value.ctype.arg.const or ctype.arg.const)):
+              ctype.arg.has_quals_of(il_value.ctype.arg)):
             return
 
         elif (ctype.arg.is_object() and il_value.ctype.arg.is_void() and
-              (not il_value.ctype.arg.const or ctype.arg.const)):
+              ctype.arg.has_quals_of(il_value.ctype.arg)):
             return
 
         # error on any other kind of pointer cast - TODO: better errors
@@ -284,7 +381,8 @@ def check_cast(il_value, ctype, range):
             return
 
     # Cast from null pointer constant to pointer okay
-    elif ctype.is_pointer() and getattr(il_value.literal, "val", None) == 0:
+    elif (ctype.is_pointer() and il_value.ctype.is_integral()
+          and getattr(il_value.literal, "val", None) == 0):
         return
 
     # Cast from pointer to boolean okay
@@ -314,19 +412,42 @@ def set_type(il_value, ctype, il_code, output=None):
         return il_value
     elif output == il_value:
         return il_value
-    elif not output and il_value.literal:
+
+    if not output and il_value.literal:
+        val = _convert_literal(il_value.literal.val, il_value.ctype, ctype)
+        if val is not None:
+            output = ILValue(ctype)
+            il_code.register_literal_var(output, val)
+            return output
+
+    if not output:
         output = ILValue(ctype)
-        if ctype.is_integral():
-            val = shift_into_range(il_value.literal.val, ctype)
+    if il_value.ctype.is_floating() or ctype.is_floating():
+        if il_value.ctype.weak_compat(ctype):
+            il_code.add(value_cmds.Set(output, il_value))
         else:
-            val = il_value.literal.val
-        il_code.register_literal_var(output, val)
-        return output
+            il_code.add(float_cmds.Convert(output, il_value))
     else:
-        if not output:
-            output = ILValue(ctype)
         il_code.add(value_cmds.Set(output, il_value))
-        return output
+    return output
+
+
+def _convert_literal(val, from_type, ctype):
+    """Return literal value `val` of type `from_type` converted to `ctype`.
+
+    A floating value which is infinite or a NaN has no integral value, so
+    its conversion to an integral type other than _Bool is left to run, and
+    this returns None.
+    """
+    if ctype.is_floating():
+        return ctypes.in_range(val, ctype)
+    elif not ctype.is_integral():
+        return val
+    elif from_type.is_floating() and not ctype.is_bool():
+        if not math.isfinite(val):
+            return None
+        val = int(val)
+    return shift_into_range(val, ctype)
 
 
 def arith_conversion_type(type1, type2):
@@ -338,6 +459,12 @@ def arith_conversion_type(type1, type2):
     This functions disregards the qualifiers of the input, so it may or may
     not return a type with the same qualifier(s) as the input types.
     """
+    # If either operand has a floating type, the other is converted to the
+    # floating type of greater rank among them.
+    if type1.is_floating() or type2.is_floating():
+        return max([t for t in [type1, type2] if t.is_floating()],
+                   key=lambda t: t.size)
+
     # If an int can represent all values of the original type, the value is
     # converted to an int; otherwise, it is converted to an unsigned
     # int. These are called the integer promotions.
@@ -404,14 +531,23 @@ def get_size(ctype, num, il_code):
     long_num = set_type(num, ctypes.longint, il_code)
     total = ILValue(ctypes.longint)
     size = ILValue(ctypes.longint)
-    il_code.register_literal_var(size, str(ctype.size))
+    il_code.register_literal_var(size, ctype.size)
     il_code.add(math_cmds.Mult(total, long_num, size))
 
     return total
 
 
 def shift_into_range(val, ctype):
-    """Shift a numerical value into range for given integral ctype."""
+    """Shift a numerical value into range for given arithmetic ctype.
+
+    A value of floating type is rounded to the nearest value of the type.
+    """
+    if ctype.is_floating():
+        return ctypes.in_range(val, ctype)
+
+    # Any nonzero value converts to a _Bool of 1.
+    if ctype.is_bool():
+        return 1 if val else 0
 
     if ctype.signed:
         max_val = 1 << (ctype.size * 8 - 1)
@@ -0,0 +1,270 @@
+"""Benchmarks of the time the compiler takes to compile programs.
+
+Each program of the corpus is compiled and linked in a process of its own,
+with the time and peak memory of each phase of the compiler measured as
+described in shivyc/timing.py, and the results are written as a JSON
+report. The corpus is of programs generated to stress one part of the
+compiler each, like a large function or deeply nested expressions, and the
+programs in tests/general_tests.
+
+To run the benchmarks and save a report:
+
+python3 tests/benchmarks/compile_time.py --output report.json
+
+To compare a later run against that report:
+
+python3 tests/benchmarks/compile_time.py --compare report.json
+
+Flags after `--` are passed to each compile, as in
+`compile_time.py -- -fno-integrated-as` to time the external assembler.
+"""
+
+import argparse
+import json
+import pathlib
+import platform
+import subprocess
+import sys
+import tempfile
+import time
+
+root = pathlib.Path(__file__).resolve().parents[2]
+general_tests = root.joinpath("tests", "general_tests")
+
+# The compiler benchmarked is the one in this repository.
+sys.path.insert(0, str(root))
+
+
+def big_function():
+    """Return a program with a single function of thousands of statements.
+    """
+    lines = ["int work(int a, int b, int c) {", "  int s = 0;"]
+    for i in range(1500):
+        lines.append(f"  a = b + c * {i % 7 + 1} - s;")
+        lines.append(f"  if (a > {i}) s += a; else s -= b;")
+        lines.append(f"  b = c + {i % 5}; c = a - b;")
+    lines += ["  return s % 2;", "}",
+              "int main(int argc, char** argv) { return work(argc, 2, 3); }"]
+    return "\n".join(lines) + "\n"
+
+
+def deep_nesting():
+    """Return a program with deeply nested expressions and statements."""
+    depth = 60
+    expr = "a"
+    for i in range(depth):
+        expr = f"({expr} + {i} * (b - {i % 3}))"
+
+    lines = ["int main(int a, char** argv) {", "  int b = a + 1, s = 0;"]
+    for i in range(10):
+        lines.append(f"  s += {expr};")
+    for i in range(depth):
+        lines.append("  " * i + f"  if (s > {i}) {{")
+    lines.append("  " * depth + "  s = 0;")
+    for i in reversed(range(depth)):
+        lines.append("  " * i + "  }")
+    lines += ["  return s;", "}"]
+    return "\n".join(lines) + "\n"
+
+
+def many_functions():
+    """Return a program of hundreds of small functions."""
+    count = 300
+    lines = ["struct pair { int x; int y; };"]
+    for i in range(count):
+        lines += [f"int f{i}(struct pair* p, int n) {{",
+                  f"  for (int i = 0; i < n; i++) p->x += p->y * {i};",
+                  f"  if (p->x > {i}) return 0;",
+                  "  return 1;",
+                  "}"]
+    lines += ["int main() {", "  struct pair p;", "  p.x = 0; p.y = 1;",
+              "  int s = 0;"]
+    for i in range(count):
+        lines.append(f"  s += f{i}(&p, {i % 4});")
+    lines += ["  return s != 0;", "}"]
+    return "\n".join(lines) + "\n"
+
+
+def many_includes(directory):
+    """Write headers to the given directory, and return a program which
+    includes each of them, and the bundled headers, several times.
+    """
+    count = 100
+    for i in range(count):
+        guard = f"HEADER_{i}_H"
+        inner = f'#include "header{i - 1}.h"\n' if i else ""
+        text = (f"#ifndef {guard}\n#define {guard}\n{inner}"
+                f"#define VALUE_{i} {i}\n"
+                f"struct s{i} {{ int a; long b; char c[{i + 1}]; }};\n"
+                f"int g{i}(struct s{i}* p);\n#endif\n")
+        directory.joinpath(f"header{i}.h").write_text(text)
+
+    lines = [f"#include <{name}>" for name in
+             ["stdbool.h", "stdio.h", "stdlib.h", "string.h", "ctype.h"]]
+    for _ in range(3):
+        lines += [f'#include "header{i}.h"' for i in range(count)]
+    lines += ["int main() {",
+              f"  return VALUE_{count - 1} - {count - 1};",
+              "}"]
+    return "\n".join(lines) + "\n"
+
+
+def corpus(directory):
+    """Write the programs of the corpus to the given directory.
+
+    returns - list of each name of a program and list of its C files
+    """
+    programs = []
+    for name, make in [("big_function", big_function),
+                       ("deep_nesting", deep_nesting),
+                       ("many_functions", many_functions)]:
+        file = directory.joinpath(f"{name}.c")
+        file.write_text(make())
+        programs.append((name, [file]))
+
+    file = directory.joinpath("many_includes.c")
+    file.write_text(many_includes(directory))
+    programs.append(("many_includes", [file]))
+
+    for name, c_file in [("count", "count/Count.c"), ("pi", "pi/pi.c"),
+                         ("trie", "trie/trie.c")]:
+        programs.append((name, [general_tests.joinpath(c_file)]))
+    return programs
+
+
+def compile_once(files, flags, directory):
+    """Compile and link the given files in a process of their own.
+
+    returns - the results the process reports, as by run_child
+    """
+    report = directory.joinpath("report.json")
+    binary = directory.joinpath("out")
+    subprocess.check_call(
+        [sys.executable, __file__, "--child", str(report), "--"]
+        + [str(f) for f in files] + ["-o", str(binary)] + flags,
+        cwd=directory, stdout=sys.stderr)
+    return json.loads(report.read_text())
+
+
+def run_child(report, argv):
+    """Run the compiler with the given arguments, timing each phase, and
+    write the results to the given report file.
+    """
+    import shivyc.main
+    from shivyc.timing import timer
+
+    sys.argv = ["shivyc"] + argv
+    timer.enabled = True
+    start = time.perf_counter()
+    status = shivyc.main.main()
+    wall = time.perf_counter() - start
+
+    results = {"status": status, "wall": wall, "phases": timer.report()}
+    pathlib.Path(report).write_text(json.dumps(results))
+
+
+def best(runs):
+    """Return the best of several results of compile_once.
+
+    The time and peak memory of each phase are each the least of any run,
+    since the noise of the machine only ever makes them larger.
+    """
+    phases = {}
+    for run in runs:
+        for name, phase in run["phases"].items():
+            if name not in phases:
+                phases[name] = dict(phase)
+                continue
+            for key in ["time", "peak_rss_kb"]:
+                if phase[key] is not None:
+                    phases[name][key] = min(phases[name][key], phase[key])
+
+    rss = [phase["peak_rss_kb"] for phase in phases.values()
+           if phase["peak_rss_kb"] is not None]
+    return {"wall": min(run["wall"] for run in runs),
+            "peak_rss_kb": max(rss, default=None),
+            "phases": phases}
+
+
+def compare(report, baseline):
+    """Print the times of a report as ratios of the times of a baseline."""
+    print(f"{'program':<16}{'phase':<10}{'baseline':>10}{'now':>10}"
+          f"{'ratio':>8}")
+    for name, program in report["programs"].items():
+        old = baseline["programs"].get(name)
+        if not old:
+            continue
+        rows = [("wall", old["wall"], program["wall"])]
+        for phase, result in program["phases"].items():
+            if phase in old["phases"]:
+                rows.append((phase, old["phases"][phase]["time"],
+                             result["time"]))
+        for phase, before, now in rows:
+            ratio = f"{now / before:.2f}" if before else "-"
+            print(f"{name:<16}{phase:<10}{before:>10.3f}{now:>10.3f}"
+                  f"{ratio:>8}")
+
+
+def get_arguments():
+    """Get the command-line arguments of the benchmarks."""
+    parser = argparse.ArgumentParser(
+        description="Benchmark the time ShivyC takes to compile programs.")
+    parser.add_argument("--runs", type=int, default=3,
+                        help="compile each program N times, and report the "
+                        "best times (default: 3)")
+    parser.add_argument("--only", metavar="NAME", action="append",
+                        help="run only the named program; may be repeated")
+    parser.add_argument("--output", metavar="FILE",
+                        help="write the JSON report to FILE, rather than "
+                        "to standard output")
+    parser.add_argument("--compare", metavar="FILE",
+                        help="print the times as ratios of those in the "
+                        "JSON report in FILE")
+    parser.add_argument("--child", metavar="FILE", help=argparse.SUPPRESS)
+    parser.add_argument("flags", nargs="*",
+                        help="flags to pass to each compile, after `--`")
+    return parser.parse_args()
+
+
+def main():
+    """Run the benchmarks."""
+    args = get_arguments()
+    if args.child:
+        run_child(args.child, args.flags)
+        return 0
+
+    import shivyc
+    report = {"shivyc_version": shivyc.__version__,
+              "python": platform.python_version(),
+              "machine": platform.machine(),
+              "flags": args.flags,
+              "runs": args.runs,
+              "programs": {}}
+
+    with tempfile.TemporaryDirectory(prefix="shivyc-bench-") as temp_dir:
+        directory = pathlib.Path(temp_dir)
+        for name, files in corpus(directory):
+            if args.only and name not in args.only:
+                continue
+            runs = [compile_once(files, args.flags, directory)
+                    for _ in range(args.runs)]
+            if any(run["status"] for run in runs):
+                print(f"failed to compile {name}", file=sys.stderr)
+                return 1
+            report["programs"][name] = best(runs)
+            print(f"{name}: {report['programs'][name]['wall']:.3f}s",
+                  file=sys.stderr)
+
+    text = json.dumps(report, indent=2) + "\n"
+    if args.output:
+        pathlib.Path(args.output).write_text(text)
+    elif not args.compare:
+        print(text, end="")
+
+    if args.compare:
+        compare(report, json.loads(pathlib.Path(args.compare).read_text()))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,41 @@
+// Insert and look up pseudo-random keys in an open-addressing hash table.
+
+#define SIZE 65521
+
+unsigned int keys[SIZE];
+int counts[SIZE];
+
+unsigned int hash(unsigned int key) {
+  key = key * 40503 + 2531011;
+  return (key >> 7) % SIZE;
+}
+
+int lookup(unsigned int key) {
+  unsigned int slot = hash(key);
+  while (counts[slot] && keys[slot] != key) {
+    slot = slot + 1;
+    if (slot == SIZE) slot = 0;
+  }
+  return slot;
+}
+
+int main(int argc, char** argv) {
+  unsigned int seed = argc;
+  int distinct = 0;
+  for (int i = 0; i < 3000000; i++) {
+    seed = seed * 1664525 + 1013904223;
+    unsigned int key = (seed >> 10) % 40000;
+    int slot = lookup(key);
+    if (!counts[slot]) {
+      keys[slot] = key;
+      distinct++;
+    }
+    counts[slot]++;
+  }
+
+  unsigned int check = distinct;
+  for (unsigned int key = 0; key < 40000; key += 7) {
+    check = check * 33 + counts[lookup(key)];
+  }
+  return check % 251;
+}
@@ -0,0 +1,36 @@
+// Multiply square matrices of integers.
+
+#define N 200
+
+int a[N][N];
+int b[N][N];
+int c[N][N];
+
+void multiply() {
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) c[i][j] = 0;
+    for (int k = 0; k < N; k++) {
+      int v = a[i][k];
+      for (int j = 0; j < N; j++) c[i][j] += v * b[k][j];
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      a[i][j] = (i * argc + j) % 17 - 8;
+      b[i][j] = (i + j * argc) % 13 - 6;
+    }
+  }
+
+  unsigned int check = 0;
+  for (int round = 0; round < 10; round++) {
+    multiply();
+    for (int i = 0; i < N; i++) {
+      a[i][(i + round) % N] += c[i][N - 1 - i] % 5;
+      check = check * 7 + c[i][i];
+    }
+  }
+  return check % 251;
+}
@@ -0,0 +1,24 @@
+// Compute values with deeply and often recursive functions.
+
+int fib(int n) {
+  if (n < 2) return n;
+  return fib(n - 1) + fib(n - 2);
+}
+
+int ackermann(int m, int n) {
+  if (m == 0) return n + 1;
+  if (n == 0) return ackermann(m - 1, 1);
+  return ackermann(m - 1, ackermann(m, n - 1));
+}
+
+int hanoi(int n, int from, int to, int via) {
+  if (n == 0) return 0;
+  return hanoi(n - 1, from, via, to) + 1 + hanoi(n - 1, via, to, from);
+}
+
+int main(int argc, char** argv) {
+  int check = fib(29 + argc);
+  check += ackermann(2, 300 * argc);
+  check += hanoi(21 + argc, 1, 3, 2);
+  return check % 251;
+}
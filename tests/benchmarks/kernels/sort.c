@@ -0,0 +1,61 @@
+// Sort an array of pseudo-random numbers with quicksort and insertion sort.
+
+unsigned int data[200000];
+
+void insertion_sort(unsigned int* a, int n) {
+  for (int i = 1; i < n; i++) {
+    unsigned int v = a[i];
+    int j = i - 1;
+    while (j >= 0 && a[j] > v) {
+      a[j + 1] = a[j];
+      j--;
+    }
+    a[j + 1] = v;
+  }
+}
+
+void quicksort(unsigned int* a, int n) {
+  while (n > 16) {
+    unsigned int pivot = a[n / 2];
+    int i = 0, j = n - 1;
+    while (i <= j) {
+      while (a[i] < pivot) i++;
+      while (a[j] > pivot) j--;
+      if (i <= j) {
+        unsigned int t = a[i];
+        a[i] = a[j];
+        a[j] = t;
+        i++;
+        j--;
+      }
+    }
+    // Recurse into the smaller part, and loop on the larger.
+    if (j + 1 < n - i) {
+      quicksort(a, j + 1);
+      a = a + i;
+      n = n - i;
+    } else {
+      quicksort(a + i, n - i);
+      n = j + 1;
+    }
+  }
+  insertion_sort(a, n);
+}
+
+int main(int argc, char** argv) {
+  int n = 200000;
+  unsigned int seed = argc;
+  unsigned int check = 0;
+  for (int round = 0; round < 8; round++) {
+    for (int i = 0; i < n; i++) {
+      seed = seed * 1103515245 + 12345;
+      data[i] = seed >> 8;
+    }
+    quicksort(data, n);
+    for (int i = 1; i < n; i++) {
+      if (data[i - 1] > data[i]) return 255;
+    }
+    check = check * 31 + data[n / 3];
+  }
+  return check % 251;
+}
@@ -0,0 +1,53 @@
+// Scan a large buffer of text for words, lines, and a pattern.
+
+#include <string.h>
+
+char text[400001];
+
+int count_words(const char* s) {
+  int words = 0, in_word = 0;
+  for (; *s; s++) {
+    int letter = (*s >= 'a' && *s <= 'z');
+    if (letter && !in_word) words++;
+    in_word = letter;
+  }
+  return words;
+}
+
+int count_pattern(const char* s, int n, const char* pattern) {
+  int m = strlen(pattern);
+  int found = 0;
+  for (int i = 0; i + m <= n; i++) {
+    int j = 0;
+    while (j < m && s[i + j] == pattern[j]) j++;
+    if (j == m) found++;
+  }
+  return found;
+}
+
+int main(int argc, char** argv) {
+  const char* words[6];
+  words[0] = "the ";
+  words[1] = "quick ";
+  words[2] = "brown\n";
+  words[3] = "fox ";
+  words[4] = "jumps ";
+  words[5] = "over\n";
+
+  int n = 0;
+  unsigned int seed = argc;
+  while (n < 399980) {
+    seed = seed * 1103515245 + 12345;
+    const char* w = words[(seed >> 16) % 6];
+    while (*w) text[n++] = *w++;
+  }
+  text[n] = 0;
+
+  int check = 0;
+  for (int round = 0; round < 30; round++) {
+    check += count_words(text);
+    check += count_pattern(text, n, "fox jumps");
+    check += strlen(text) % 7;
+  }
+  return check % 251;
+}
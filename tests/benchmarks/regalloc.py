@@ -0,0 +1,196 @@
+"""Microbenchmarks of the register allocator, on synthetic IL functions.
+
+Each function is generated with a given number of live ranges, register
+pressure, and density of moves. It is a straight line of commands, each of
+which ends the live range of the oldest value live and starts a new one, so
+that `pressure` values are live throughout. A `moves` fraction of the new
+values are copies of the value which dies, which become preference edges
+for the allocator to coalesce, and the rest are sums of it and another live
+value. The seed of the generator is fixed, so each run allocates the same
+graphs.
+
+Only ASMGen._make_asm is timed, which builds the interference graph,
+allocates registers, and emits the ASM code of the function. The number of
+nodes and conflict edges of the graph, the spill candidates selected, and
+the moves coalesced are reported with the time, so a change in the time can
+be told apart from a change in the graph.
+
+To run the benchmarks and save a report:
+
+python3 tests/benchmarks/regalloc.py --output report.json
+
+To compare a later run against that report:
+
+python3 tests/benchmarks/regalloc.py --compare report.json
+
+Flags after `--` are passed to the compiler as if given on its command line,
+as in `regalloc.py -- -freg-alloc=linear` to time the linear scan allocator.
+"""
+
+import argparse
+import json
+import pathlib
+import platform
+import random
+import sys
+import time
+
+root = pathlib.Path(__file__).resolve().parents[2]
+
+# The compiler benchmarked is the one in this repository.
+sys.path.insert(0, str(root))
+
+import shivyc.ctypes as ctypes  # noqa: E402
+from shivyc.asm_gen import ASMCode, ASMGen  # noqa: E402
+from shivyc.il_cmds.control import Return  # noqa: E402
+from shivyc.il_cmds.math import Add  # noqa: E402
+from shivyc.il_cmds.value import Set  # noqa: E402
+from shivyc.il_gen import ILCode, ILValue, SymbolTable  # noqa: E402
+from shivyc.main import get_arguments  # noqa: E402
+from shivyc.timing import timer  # noqa: E402
+
+# Each function generated, by name, as its number of live ranges, register
+# pressure, and fraction of values which are moves. Each group varies one
+# of these from the same middle case, to show how the time scales with it.
+functions = {}
+for ranges in [250, 500, 1000, 2000, 4000]:
+    functions[f"ranges-{ranges}"] = (ranges, 8, 0.25)
+for pressure in [4, 12, 24, 48, 96]:
+    functions[f"pressure-{pressure}"] = (1000, pressure, 0.25)
+for moves in [0, 0.25, 0.5, 0.75]:
+    functions[f"moves-{moves}"] = (1000, 8, moves)
+
+
+def synthetic_function(il_code, name, ranges, pressure, moves, seed=0):
+    """Add the IL commands of a synthetic function to `il_code`.
+
+    ranges (int) - Number of live ranges, not counting the sums of the live
+    values at the end.
+    pressure (int) - Number of values live at once.
+    moves (float) - Fraction of the values after the first `pressure` which
+    are copies of another.
+    """
+    rng = random.Random(seed)
+    il_code.start_func(name)
+
+    live = []
+    for i in range(pressure):
+        v = ILValue(ctypes.integer)
+        literal = ILValue(ctypes.integer)
+        il_code.register_literal_var(literal, i + 1)
+        il_code.add(Set(v, literal))
+        live.append(v)
+
+    for _ in range(ranges - pressure):
+        dying = live.pop(0)
+        v = ILValue(ctypes.integer)
+        if not live or rng.random() < moves:
+            il_code.add(Set(v, dying))
+        else:
+            il_code.add(Add(v, dying, rng.choice(live)))
+        live.append(v)
+
+    total = live[0]
+    for v in live[1:]:
+        new_total = ILValue(ctypes.integer)
+        il_code.add(Add(new_total, total, v))
+        total = new_total
+    il_code.add(Return(total))
+
+
+def time_function(spec, flags, runs):
+    """Allocate the registers of a synthetic function several times.
+
+    returns - the best time of _make_asm, and the counters of the last run
+    """
+    il_code = ILCode()
+    synthetic_function(il_code, "bench", *spec)
+    args = get_arguments(["bench.c"] + flags)
+    asm_gen = ASMGen(il_code, SymbolTable(), ASMCode(), args)
+    job = asm_gen.function_job("bench")
+
+    best = None
+    for _ in range(runs):
+        timer.clear()
+        asm_code = ASMCode("bench")
+        start = time.perf_counter()
+        asm_gen._make_asm(*job, asm_code)
+        elapsed = time.perf_counter() - start
+        best = elapsed if best is None else min(best, elapsed)
+    return best, timer.report_counts()
+
+
+def compare(report, baseline):
+    """Print the times of a report as ratios of the times of a baseline."""
+    print(f"{'function':<16}{'nodes':>8}{'edges':>9}{'baseline':>10}"
+          f"{'now':>10}{'ratio':>8}")
+    for name, result in report["functions"].items():
+        old = baseline["functions"].get(name)
+        if not old:
+            continue
+        before, now = old["time"], result["time"]
+        ratio = f"{now / before:.2f}" if before else "-"
+        print(f"{name:<16}{result['nodes']:>8}{result['edges']:>9}"
+              f"{before:>10.4f}{now:>10.4f}{ratio:>8}")
+
+
+def get_arguments_bench():
+    """Get the command-line arguments of the benchmarks."""
+    parser = argparse.ArgumentParser(
+        description="Benchmark the register allocator of ShivyC.")
+    parser.add_argument("--runs", type=int, default=3,
+                        help="allocate each function N times, and report "
+                        "the best time (default: 3)")
+    parser.add_argument("--only", metavar="NAME", action="append",
+                        help="run only the named function; may be repeated")
+    parser.add_argument("--output", metavar="FILE",
+                        help="write the JSON report to FILE, rather than "
+                        "to standard output")
+    parser.add_argument("--compare", metavar="FILE",
+                        help="print the times as ratios of those in the "
+                        "JSON report in FILE")
+    parser.add_argument("flags", nargs="*",
+                        help="flags to pass to the compiler, after `--`")
+    return parser.parse_args()
+
+
+def main():
+    """Run the benchmarks."""
+    args = get_arguments_bench()
+
+    import shivyc
+    report = {"shivyc_version": shivyc.__version__,
+              "python": platform.python_version(),
+              "machine": platform.machine(),
+              "flags": args.flags,
+              "runs": args.runs,
+              "functions": {}}
+
+    timer.enabled = True
+    for name, spec in functions.items():
+        if args.only and name not in args.only:
+            continue
+        seconds, counts = time_function(spec, args.flags, args.runs)
+        ranges, pressure, moves = spec
+        report["functions"][name] = {
+            "ranges": ranges, "pressure": pressure, "moves": moves,
+            "nodes": counts.get("graph_nodes", 0),
+            "edges": counts.get("graph_edges", 0),
+            "spill_rounds": counts.get("spill_rounds", 0),
+            "coalesced_moves": counts.get("coalesced_moves", 0),
+            "time": seconds}
+        print(f"{name}: {seconds:.4f}s", file=sys.stderr)
+
+    text = json.dumps(report, indent=2) + "\n"
+    if args.output:
+        pathlib.Path(args.output).write_text(text)
+    elif not args.compare:
+        print(text, end="")
+
+    if args.compare:
+        compare(report, json.loads(pathlib.Path(args.compare).read_text()))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
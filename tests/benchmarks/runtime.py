@@ -0,0 +1,202 @@
+"""Benchmarks of the speed of the code the compiler generates.
+
+Each kernel in tests/benchmarks/kernels is compiled by ShivyC and by gcc at
+-O0 and -O2, checked to return the same value with each, and run several
+times. The cycles and instructions of each run are counted with
+`perf stat` where perf is installed and the kernel allows it, and the wall
+time is measured either way. The results, with the ratio of the counts of
+the ShivyC code to those of the gcc code, are written as a JSON report.
+
+To run the benchmarks:
+
+python3 tests/benchmarks/runtime.py --runs 5 --output report.json
+
+ShivyC may be run with other flags as variants of its own, to show what an
+optimization gains, as in:
+
+python3 tests/benchmarks/runtime.py --variant unrolled="-funroll-loops"
+"""
+
+import argparse
+import json
+import os
+import pathlib
+import platform
+import shlex
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+root = pathlib.Path(__file__).resolve().parents[2]
+kernels = root.joinpath("tests", "benchmarks", "kernels")
+
+# The compiler benchmarked is the one in this repository.
+sys.path.insert(0, str(root))
+
+# Compilers the ShivyC code is compared against, and the flags of each.
+references = {"gcc-O0": ["gcc", "-O0", "-w"],
+              "gcc-O2": ["gcc", "-O2", "-w"]}
+
+# Events counted by perf, as named in the report.
+events = ["cycles", "instructions"]
+
+
+def compile_kernel(command, file, binary):
+    """Compile a kernel with the given compiler command.
+
+    returns - whether the binary was built
+    """
+    env = dict(os.environ, PYTHONPATH=str(root))
+    result = subprocess.run(command + [str(file), "-o", str(binary)],
+                            stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                            cwd=binary.parent, env=env)
+    if result.returncode:
+        sys.stderr.write(result.stdout.decode(errors="replace"))
+    return result.returncode == 0
+
+
+def time_runs(binary, runs):
+    """Run a binary several times.
+
+    returns - its exit status, and the least wall time of any run
+    """
+    best = None
+    for _ in range(runs):
+        start = time.perf_counter()
+        status = subprocess.call([str(binary)], stdout=subprocess.DEVNULL)
+        elapsed = time.perf_counter() - start
+        best = elapsed if best is None else min(best, elapsed)
+    return status, best
+
+
+def count_events(binary, runs):
+    """Count the events of runs of a binary with `perf stat`.
+
+    returns - map from each event to its mean count over the runs, or to
+    None if perf is missing or cannot count it
+    """
+    counts = dict.fromkeys(events)
+    if not shutil.which("perf"):
+        return counts
+
+    result = subprocess.run(
+        ["perf", "stat", "-x", ",", "-r", str(runs),
+         "-e", ",".join(events), "--", str(binary)],
+        stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+
+    # Each line is of a count, its unit, and its event, like
+    # "1234,,cycles:u,...", with a count that is not a number if the event
+    # is not supported.
+    for line in result.stderr.decode(errors="replace").splitlines():
+        fields = line.split(",")
+        if len(fields) < 3:
+            continue
+        event = fields[2].split(":")[0]
+        if event in counts:
+            try:
+                counts[event] = float(fields[0])
+            except ValueError:
+                pass
+    return counts
+
+
+def ratio(a, b):
+    """Return a / b, or None if either is not known."""
+    if a is None or not b:
+        return None
+    return a / b
+
+
+def get_arguments():
+    """Get the command-line arguments of the benchmarks."""
+    parser = argparse.ArgumentParser(
+        description="Benchmark the code ShivyC generates against gcc.")
+    parser.add_argument("--runs", type=int, default=5,
+                        help="run each binary N times (default: 5)")
+    parser.add_argument("--only", metavar="NAME", action="append",
+                        help="run only the named kernel; may be repeated")
+    parser.add_argument("--variant", metavar="NAME=FLAGS", action="append",
+                        default=[],
+                        help="also benchmark ShivyC run with the given "
+                        "flags, as NAME; may be repeated")
+    parser.add_argument("--output", metavar="FILE",
+                        help="write the JSON report to FILE, rather than "
+                        "to standard output")
+    return parser.parse_args()
+
+
+def main():
+    """Run the benchmarks."""
+    args = get_arguments()
+
+    shivyc_command = [sys.executable, "-m", "shivyc.main"]
+    variants = {"shivyc": []}
+    for variant in args.variant:
+        name, _, flags = variant.partition("=")
+        variants[name] = shlex.split(flags)
+    compilers = {name: shivyc_command + flags
+                 for name, flags in variants.items()}
+    compilers.update(references)
+
+    import shivyc
+    report = {"shivyc_version": shivyc.__version__,
+              "machine": platform.machine(),
+              "runs": args.runs,
+              "perf": bool(shutil.which("perf")),
+              "variants": variants,
+              "references": references,
+              "kernels": {}}
+
+    files = sorted(kernels.glob("*.c"))
+    with tempfile.TemporaryDirectory(prefix="shivyc-bench-") as temp_dir:
+        for file in files:
+            if args.only and file.stem not in args.only:
+                continue
+
+            results = {}
+            for name, command in compilers.items():
+                binary = pathlib.Path(temp_dir, f"{file.stem}-{name}")
+                if not compile_kernel(command, file, binary):
+                    print(f"{name} failed to compile {file.name}",
+                          file=sys.stderr)
+                    return 1
+                status, seconds = time_runs(binary, args.runs)
+                results[name] = {"status": status, "seconds": seconds}
+                results[name].update(count_events(binary, args.runs))
+
+            statuses = {result["status"] for result in results.values()}
+            if len(statuses) > 1:
+                print(f"{file.name} returned different values: " +
+                      ", ".join(f"{name} {result['status']}"
+                                for name, result in results.items()),
+                      file=sys.stderr)
+                return 1
+
+            # Each ShivyC build is compared to each gcc build by cycles,
+            # or by time if the cycles were not counted.
+            ratios = {}
+            for name in compilers:
+                if name in references:
+                    continue
+                for ref in references:
+                    key = "cycles" if results[ref]["cycles"] else "seconds"
+                    ratios[f"{name}/{ref}"] = ratio(results[name][key],
+                                                    results[ref][key])
+            report["kernels"][file.stem] = {"results": results,
+                                            "ratios": ratios}
+            print(f"{file.stem}: " + ", ".join(
+                f"{key} {value:.2f}" for key, value in ratios.items()
+                if value is not None), file=sys.stderr)
+
+    text = json.dumps(report, indent=2) + "\n"
+    if args.output:
+        pathlib.Path(args.output).write_text(text)
+    else:
+        print(text, end="")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
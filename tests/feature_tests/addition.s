@@ -0,0 +1,23 @@
+	.intel_syntax noprefix
+	.section .text
+	.global main
+main:
+	push rbp
+	mov rbp, rsp
+__shivyc_label1:
+__shivyc_label2:
+__shivyc_label3:
+__shivyc_label4:
+__shivyc_label5:
+__shivyc_label6:
+__shivyc_label7:
+__shivyc_label8:
+__shivyc_label9:
+__shivyc_label10:
+__shivyc_label11:
+__shivyc_label12:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
@@ -0,0 +1,27 @@
+// Address arithmetic is folded into the addressing modes of loads, stores,
+// and leas.
+struct P { long x, y, z; };
+
+long get_y(struct P *p, int i) { return p[i].y + p->z; }
+void put(long *a, long i, long v) { a[i + 2] = v; }
+long before(long *a, long i) { return a[i - 1] + *(a - 1 + i); }
+char at(char *s, long i) { return s[i + 1]; }
+long *shift(long *a, long i) { return a + 2 * i + 3; }
+
+int main() {
+  struct P ps[3] = {{1, 2, 3}, {4, 5, 6}, {7, 8, 9}};
+  if (get_y(ps, 2) != 11) return 1;
+
+  long a[8] = {0};
+  put(a, 3, 42);
+  if (a[5] != 42) return 2;
+  if (before(a, 6) != 84) return 3;
+
+  if (at("hello", 3) != 'o') return 4;
+  if (shift(a, 1) != &a[5] || *shift(a, 1) != 42) return 5;
+
+  int odd = 0;
+  for (int i = 0; i < 8; i++) if (i % 2) odd++;
+  if (!odd) return 6;
+  return 0;
+}
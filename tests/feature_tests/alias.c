@@ -0,0 +1,75 @@
+// Loads and stores which alias analysis must keep or may remove. Each
+// function reads memory, writes it by some other way, and reads it again.
+
+int global;
+
+int through_same_type(int* p, int* q) {
+  int a = *p;
+  *q = 7;
+  return a + *p;
+}
+
+int through_char(int* p, char* c) {
+  int a = *p;
+  c[0] = 1;
+  return *p - a;
+}
+
+int global_by_call(void (*f)(void)) {
+  int a = global;
+  f();
+  return global - a;
+}
+
+void bump() { global += 5; }
+
+int* saved;
+void save(int* p) { saved = p; }
+
+int escaped_local() {
+  int x = 1;
+  save(&x);
+  int a = x;
+  *saved = 9;
+  return x - a;
+}
+
+int local_array(int* p) {
+  int a[3];
+  a[1] = 4;
+  *p = 8;  // p cannot point into a
+  a[2] = 6;
+  return a[1] + a[2];
+}
+
+int loop_load(int* p, int* q, int n) {
+  int total = 0;
+  for(int i = 0; i < n; i++) {
+    total += *p;
+    *q = i;
+  }
+  return total;
+}
+
+int overwritten(int* p, int* q) {
+  *p = 1;
+  int a = *q;
+  *p = 2;
+  return a;
+}
+
+int main() {
+  int x = 3;
+  if(through_same_type(&x, &x) != 10) return 1;
+  if(through_char(&x, (char*)&x) != 1 - 7) return 2;
+  if(global_by_call(bump) != 5) return 3;
+  if(escaped_local() != 8) return 4;
+  if(local_array(&x) != 10 || x != 8) return 5;
+
+  int y = 1;
+  if(loop_load(&y, &y, 4) != 1 + 0 + 1 + 2) return 6;
+
+  int z = 0;
+  if(overwritten(&z, &z) != 1 || z != 2) return 7;
+  return 0;
+}
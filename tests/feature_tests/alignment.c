@@ -0,0 +1,101 @@
+// Return: 0
+
+// Struct and union members are aligned and padded as the System V ABI lays
+// them out, so structs are shared with code compiled by other compilers.
+// A packed struct has no padding.
+
+void* memset(void*, int, unsigned long);
+void* memcpy(void*, void*, unsigned long);
+int memcmp(void*, void*, unsigned long);
+
+struct cl { char c; long l; };
+struct ci { char c; int i; char d; };
+struct sc { short s; char c; };
+struct nest { char c; struct ci ci; double d; };
+union u { char c[5]; int i; };
+struct pd { char c; double d; } __attribute__((packed));
+struct __attribute__((__packed__)) pi { char c; int i; };
+struct with_pd { char c; struct pd p; };
+
+struct ci global_ci = {1, 2, 3};
+char after_char = 9;
+struct cl global_cl[2] = {{1, 2}, {3, 4}};
+
+struct ci make_ci(char c, int i, char d) {
+  struct ci r;
+  r.c = c;
+  r.i = i;
+  r.d = d;
+  return r;
+}
+
+int sum_ci(struct ci a) { return a.c + a.i + a.d; }
+
+int main() {
+  if(sizeof(struct cl) != 16 || _Alignof(struct cl) != 8) return 1;
+  if(sizeof(struct ci) != 12 || _Alignof(struct ci) != 4) return 2;
+  if(sizeof(struct sc) != 4 || _Alignof(struct sc) != 2) return 3;
+  if(sizeof(struct nest) != 24 || _Alignof(struct nest) != 8) return 4;
+  if(sizeof(union u) != 8 || _Alignof(union u) != 4) return 5;
+  if(sizeof(struct pd) != 9 || _Alignof(struct pd) != 1) return 6;
+  if(sizeof(struct pi) != 5 || sizeof(struct with_pd) != 10) return 7;
+  if(_Alignof(char) != 1 || _Alignof(double) != 8) return 8;
+  if(_Alignof(int[3]) != 4 || _Alignof(long*) != 8) return 9;
+
+  // Member offsets
+  struct cl cl;
+  if((char*)&cl.l - (char*)&cl != 8) return 10;
+  struct nest n;
+  if((char*)&n.ci.d - (char*)&n != 12 || (char*)&n.d - (char*)&n != 16)
+    return 11;
+  struct pd pd;
+  if((char*)&pd.d - (char*)&pd != 1) return 12;
+
+  // Arrays of structs keep every element aligned.
+  struct sc arr[3];
+  if((char*)&arr[2].c - (char*)arr != 10) return 13;
+
+  // Members of packed structs at unaligned offsets are still accessed.
+  pd.c = 1;
+  pd.d = 2.5;
+  struct pd pd2;
+  pd2 = pd;
+  if(pd2.c != 1 || pd2.d != 2.5) return 14;
+  struct with_pd w;
+  w.p = pd;
+  w.c = 3;
+  if(w.p.d != 2.5 || w.p.c != 1) return 15;
+
+  // Layout is observed through the bytes, including by the C library.
+  struct ci ci;
+  memset(&ci, 0, sizeof(ci));
+  ci.c = 1;
+  ci.i = 258;
+  ci.d = 3;
+  char bytes[12] = {1, 0, 0, 0, 2, 1, 0, 0, 3, 0, 0, 0};
+  if(memcmp(&ci, bytes, 12)) return 16;
+  struct ci copy;
+  memcpy(&copy, bytes, 12);
+  if(copy.i != 258 || copy.d != 3) return 17;
+
+  // Passing and returning structs with padding
+  if(sum_ci(ci) != 262) return 18;
+  struct ci made;
+  made = make_ci(4, 5, 6);
+  if(made.c != 4 || made.i != 5 || made.d != 6) return 19;
+  if(sum_ci(make_ci(1, 1, 1)) != 3) return 20;
+
+  // Static data
+  if(global_ci.i != 2 || global_ci.d != 3 || after_char != 9) return 21;
+  if(global_cl[1].l != 4 || ((long)&global_cl[0].l & 7)) return 22;
+  long addr = (long)&global_ci;
+  if(addr & 3) return 23;
+
+  union u un;
+  un.i = 0;
+  un.c[0] = 1;
+  un.c[4] = 7;
+  if(un.i != 1) return 24;
+
+  return 0;
+}
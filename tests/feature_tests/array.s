@@ -0,0 +1,227 @@
+	.intel_syntax noprefix
+	.section .text
+	.global main
+main:
+	push rbp
+	mov rbp, rsp
+	sub rsp, 624
+	lea rax, [rbp-24]
+	cmp rax, rax
+	je __shivyc_label1
+	mov eax, 1
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label1:
+	cmp rax, rax
+	je __shivyc_label2
+	mov eax, 2
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label2:
+	lea rcx, [rbp-24+4*0]
+	cmp rcx, rcx
+	je __shivyc_label3
+	mov eax, 13
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label3:
+	mov rsi, rax
+	cmp rcx, rsi
+	je __shivyc_label4
+	mov eax, 13
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label4:
+	lea rdi, [rbp-24+4*3]
+	mov rdx, rcx
+	add rdx, 12
+	cmp rdi, rdx
+	je __shivyc_label5
+	mov eax, 14
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label5:
+	mov rdx, rax
+	add rdx, 20
+	add rcx, 20
+	cmp rdx, rcx
+	je __shivyc_label6
+	mov eax, 15
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label6:
+	lea rcx, [rbp-48]
+	cmp rcx, rcx
+	je __shivyc_label7
+	mov eax, 3
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label7:
+	cmp rcx, rcx
+	je __shivyc_label8
+	mov eax, 4
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label8:
+	cmp rax, rcx
+	jne __shivyc_label9
+	mov eax, 5
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label9:
+	cmp rax, rcx
+	jne __shivyc_label10
+	mov eax, 6
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label10:
+	lea rcx, [rbp-72]
+	mov edx, 0
+	cmp rax, rcx
+	jne __shivyc_label11
+	mov edx, 1
+	mov eax, 7
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label11:
+	cmp edx, 0
+	je __shivyc_label12
+	mov eax, 8
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label12:
+	lea rcx, [rbp-96]
+	cmp rax, rcx
+	jne __shivyc_label13
+	mov eax, 9
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label13:
+	cmp rsi, rcx
+	jne __shivyc_label14
+	mov eax, 10
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label14:
+	mov DWORD PTR [rax], 15
+	mov ecx, DWORD PTR [rax]
+	cmp ecx, 15
+	je __shivyc_label15
+	mov eax, 11
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label15:
+	mov rcx, rax
+	add rcx, 8
+	mov DWORD PTR [rcx], 20
+	mov ecx, DWORD PTR [rcx]
+	cmp ecx, 20
+	je __shivyc_label16
+	mov eax, 12
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label16:
+	mov ecx, DWORD PTR [rbp-24+4*0]
+	cmp ecx, 15
+	je __shivyc_label17
+	mov eax, 16
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label17:
+	mov ecx, DWORD PTR [rbp-24+4*2]
+	cmp ecx, 20
+	je __shivyc_label18
+	mov eax, 17
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label18:
+	add rax, 16
+	add rax, -8
+	mov eax, DWORD PTR [rax]
+	cmp eax, 20
+	je __shivyc_label19
+	mov eax, 21
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label19:
+	mov DWORD PTR [rbp-24+4*1], 35
+	mov DWORD PTR [rbp-24+4*3], 10
+	mov eax, DWORD PTR [rbp-24+4*1]
+	mov ecx, DWORD PTR [rbp-24+4*3]
+	add eax, ecx
+	mov DWORD PTR [rbp-24+4*4], eax
+	mov eax, 0
+	mov edx, 0
+__shivyc_label20:
+	cmp edx, 5
+	je __shivyc_label21
+	movsx rcx, edx
+	mov ecx, DWORD PTR [rbp-24+4*rcx]
+	add eax, ecx
+	add edx, 1
+	jmp __shivyc_label20
+__shivyc_label21:
+	cmp eax, 125
+	je __shivyc_label22
+	mov eax, 18
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label22:
+	lea rax, [rbp-216+8*6]
+	add rax, 12
+	mov DWORD PTR [rax], 10
+	mov eax, DWORD PTR [rax]
+	cmp eax, 10
+	je __shivyc_label23
+	mov eax, 19
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label23:
+	lea rax, [rbp-216+8*0]
+	mov rcx, rax
+	add rcx, 24
+	add rax, 24
+	cmp rcx, rax
+	je __shivyc_label24
+	mov eax, 20
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label24:
+	lea rax, [rbp-616+8*15]
+	add rax, 16
+	mov DWORD PTR [rax], 10
+	mov eax, DWORD PTR [rax]
+	cmp eax, 10
+	je __shivyc_label25
+	mov eax, 21
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label25:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
@@ -0,0 +1,19 @@
+	.intel_syntax noprefix
+	.section .text
+	.global main
+main:
+	push rbp
+	mov rbp, rsp
+	mov eax, 20
+__shivyc_label1:
+__shivyc_label2:
+__shivyc_label3:
+__shivyc_label4:
+__shivyc_label5:
+__shivyc_label6:
+__shivyc_label7:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
@@ -0,0 +1,76 @@
+#include <stdatomic.h>
+
+int counter;
+long total = 10;
+char flag;
+short half = 7;
+int* pointer;
+
+int add_n(int n) {
+  for (int i = 0; i < n; i++) atomic_fetch_add(&counter, 1);
+  return atomic_load(&counter);
+}
+
+// The store to `data` may not be moved after the release store to `ready`,
+// or merged with the store after it.
+int data;
+int ready;
+void publish(int val) {
+  data = val;
+  __atomic_store_n(&ready, 1, __ATOMIC_RELEASE);
+  data = val + 1;
+}
+
+// The load of `data` after the atomic load is not replaced with the value
+// loaded before it.
+int reload() {
+  int before = data;
+  __atomic_load_n(&ready, __ATOMIC_ACQUIRE);
+  return data - before;
+}
+
+int main() {
+  if (add_n(5) != 5) return 1;
+  if (add_n(3) != 8) return 2;
+
+  if (__atomic_fetch_add(&total, 5, __ATOMIC_RELAXED) != 10) return 3;
+  if (__atomic_add_fetch(&total, 5, __ATOMIC_SEQ_CST) != 20) return 4;
+  if (atomic_fetch_sub(&total, 7) != 20) return 5;
+  if (__atomic_sub_fetch(&total, 3, __ATOMIC_ACQ_REL) != 10) return 6;
+  if (total != 10) return 7;
+
+  if (__atomic_fetch_add(&flag, 200, __ATOMIC_SEQ_CST) != 0) return 8;
+  if (__atomic_fetch_add(&flag, 100, __ATOMIC_SEQ_CST) != -56) return 9;
+  if (flag != 44) return 10;
+  if (atomic_fetch_sub_explicit(&half, 9, memory_order_relaxed) != 7)
+    return 11;
+  if (half != -2) return 12;
+
+  int expected = 8;
+  if (!atomic_compare_exchange_strong(&counter, &expected, 20)) return 13;
+  if (counter != 20 || expected != 8) return 14;
+  if (atomic_compare_exchange_weak(&counter, &expected, 30)) return 15;
+  if (counter != 20 || expected != 20) return 16;
+  long old = 10;
+  if (!__atomic_compare_exchange_n(&total, &old, 11, 0, __ATOMIC_ACQUIRE,
+                                   __ATOMIC_RELAXED))
+    return 17;
+  if (total != 11) return 18;
+
+  if (atomic_exchange(&counter, 40) != 20) return 19;
+  if (counter != 40) return 20;
+  int x = 3;
+  if (__atomic_exchange_n(&pointer, &x, __ATOMIC_SEQ_CST)) return 21;
+  if (atomic_load_explicit(&pointer, memory_order_acquire) != &x) return 22;
+  atomic_store(&x, 12);
+  if (*pointer != 12) return 23;
+  atomic_store_explicit(pointer, 13, memory_order_relaxed);
+  if (x != 13) return 24;
+
+  atomic_thread_fence(memory_order_seq_cst);
+  atomic_thread_fence(memory_order_acquire);
+
+  publish(5);
+  if (data != 6 || ready != 1) return 25;
+  if (reload() != 0) return 26;
+}
@@ -0,0 +1,59 @@
+// Return: 0
+
+int popcount(unsigned x) {
+  int n = 0;
+  while(x) {
+    n += x & 1;
+    x = x >> 1;
+  }
+  return n;
+}
+
+// A mask compared against zero, or used as a condition, is lowered to a
+// test instruction.
+int is_set(long flags, int bit) {
+  if((flags & ((long)1 << bit)) == 0) return 0;
+  return 1;
+}
+int any(int x) { if(x & 6) return 1; return 0; }
+int high(char x) { return (x & 64) != 0; }
+
+int main() {
+  int a = 240, b = 60;
+  if((a & b) != 48) return 1;
+  if((a | b) != 252) return 2;
+  if((a ^ b) != 204) return 3;
+
+  a &= 63;
+  if(a != 48) return 4;
+  a |= 3;
+  if(a != 51) return 5;
+  a ^= 17;
+  if(a != 34) return 6;
+
+  if(popcount(65295) != 12) return 7;
+
+  long l = 4294967296;
+  if(!is_set(l, 32) || is_set(l, 31)) return 8;
+  if(!any(4) || any(9)) return 9;
+  if(!high(65) || high(63)) return 10;
+
+  // Operands are converted as for arithmetic first.
+  unsigned u = -1;
+  char c = -1;
+  if((u & 2147483648) == 0) return 11;
+  if((c & 128) != 128) return 12;
+  if((l & u) != 0) return 13;
+
+  // '&' binds tighter than '^', which binds tighter than '|'.
+  if((1 | 2 ^ 3 & 4) != 3) return 14;
+  if(~0 & 5 ^ 5) return 15;
+
+  int all = -1;
+  if((a & all) != 34) return 16;
+
+  #if (6 & 3 | 8 ^ 1) != 11
+  return 17;
+  #endif
+  return 0;
+}
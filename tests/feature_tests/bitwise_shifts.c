@@ -15,4 +15,14 @@ int main() {
 
   if ((1<<16)-1 != 65535) return 8;
   if (3<<8 != 768) return 9;
+
+  // Shifting an unsigned value right shifts in zeros.
+  unsigned int u = 1;
+  int n = -1;
+  for (int i = 0; i < 31; i++) {
+    u = u << 1;
+    n = n << 1;
+  }
+  if (u >> 31 != 1) return 10;
+  if (n >> 31 != -1) return 11;
 }
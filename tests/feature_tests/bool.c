@@ -36,4 +36,8 @@ int main() {
 
   (n = 3) || 1;
   if(n != 3) return 21;
+
+  struct { _Bool b; } s;
+  s.b = 7;
+  if(s.b != 1) return 22;
 }
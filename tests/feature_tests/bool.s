@@ -0,0 +1,118 @@
+	.intel_syntax noprefix
+	.section .text
+	.global main
+main:
+	push rbp
+	mov rbp, rsp
+	sub rsp, 16
+__shivyc_label3:
+__shivyc_label1:
+__shivyc_label5:
+__shivyc_label4:
+__shivyc_label7:
+__shivyc_label9:
+__shivyc_label8:
+__shivyc_label11:
+	lea rcx, [rbp-4]
+	cmp rcx, 0
+	je __shivyc_label13
+__shivyc_label13:
+__shivyc_label12:
+	cmp rcx, 0
+	je __shivyc_label15
+__shivyc_label15:
+	cmp rcx, 0
+	je __shivyc_label17
+	cmp rcx, 0
+	je __shivyc_label17
+	mov eax, 1
+	jmp __shivyc_label18
+__shivyc_label17:
+	mov eax, 0
+__shivyc_label18:
+	cmp eax, 1
+	je __shivyc_label16
+	mov eax, 8
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label16:
+__shivyc_label22:
+__shivyc_label21:
+__shivyc_label19:
+__shivyc_label25:
+__shivyc_label23:
+__shivyc_label30:
+__shivyc_label29:
+__shivyc_label27:
+__shivyc_label32:
+__shivyc_label31:
+__shivyc_label35:
+__shivyc_label38:
+__shivyc_label37:
+	cmp rcx, 0
+	jne __shivyc_label44
+	jmp __shivyc_label42
+__shivyc_label44:
+	mov eax, 1
+	jmp __shivyc_label43
+__shivyc_label42:
+	mov eax, 0
+__shivyc_label43:
+	cmp eax, 1
+	je __shivyc_label41
+	mov eax, 14
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label41:
+	cmp rcx, 0
+	jne __shivyc_label48
+	cmp rcx, 0
+	je __shivyc_label46
+__shivyc_label48:
+	mov eax, 1
+	jmp __shivyc_label47
+__shivyc_label46:
+	mov eax, 0
+__shivyc_label47:
+	cmp eax, 1
+	je __shivyc_label45
+	mov eax, 15
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label45:
+	mov eax, 0
+	cmp rcx, 0
+	jne __shivyc_label49
+	mov eax, 1
+	mov eax, 16
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label49:
+	cmp rcx, 0
+	jne __shivyc_label51
+	mov eax, 16
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label51:
+__shivyc_label53:
+__shivyc_label52:
+__shivyc_label54:
+__shivyc_label56:
+__shivyc_label57:
+__shivyc_label59:
+__shivyc_label62:
+__shivyc_label61:
+__shivyc_label63:
+__shivyc_label66:
+__shivyc_label65:
+__shivyc_label67:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
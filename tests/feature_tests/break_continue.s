@@ -0,0 +1,50 @@
+	.intel_syntax noprefix
+	.section .text
+	.global main
+main:
+	push rbp
+	mov rbp, rsp
+__shivyc_label2:
+__shivyc_label4:
+__shivyc_label7:
+	mov eax, 0
+__shivyc_label8:
+	cmp eax, 10
+	je __shivyc_label10
+	cmp eax, 5
+	jne __shivyc_label11
+	jmp __shivyc_label10
+__shivyc_label11:
+__shivyc_label9:
+	add eax, 1
+	jmp __shivyc_label8
+__shivyc_label10:
+	cmp eax, 5
+	je __shivyc_label12
+	mov eax, 1
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label12:
+	mov ecx, 0
+	mov eax, 0
+__shivyc_label13:
+	cmp ecx, 10
+	je __shivyc_label15
+	add eax, 1
+__shivyc_label17:
+	add ecx, 1
+	jmp __shivyc_label13
+__shivyc_label15:
+	cmp eax, 10
+	je __shivyc_label18
+	mov eax, 2
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label18:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
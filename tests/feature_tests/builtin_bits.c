@@ -0,0 +1,67 @@
+int popcount64(unsigned long x) { return __builtin_popcountl(x); }
+int ctz64(unsigned long x) { return __builtin_ctzll(x); }
+int clz32(unsigned int x) { return __builtin_clz(x); }
+int clz64(unsigned long x) { return __builtin_clzl(x); }
+unsigned long bswap64(unsigned long x) { return __builtin_bswap64(x); }
+
+unsigned long rotl64(unsigned long x, int n) {
+  return (x << n) | (x >> (64 - n));
+}
+unsigned int rotr32(unsigned int x, unsigned int n) {
+  return (x >> n) ^ (x << (32 - n));
+}
+unsigned int rotr7(unsigned int x) { return (x >> 7) + (x << 25); }
+
+// Not rotates: a signed value is shifted right arithmetically, and the
+// counts add up to less than the width.
+int not_rotate(int x) { return (x << 4) | (x >> 28); }
+unsigned int not_rotate_2(unsigned int x) { return (x << 4) | (x >> 27); }
+
+// Values read at run time, so that they are not folded.
+unsigned long wide = 4042322161;
+unsigned int narrow = 305419896;
+unsigned short half = 4660;
+
+// Builtins of constants are constant expressions.
+int table[] = {__builtin_popcount(255), __builtin_ctz(8), __builtin_clz(1),
+               __builtin_bswap16(4660)};
+
+int main() {
+  unsigned long x = wide << 32 | wide;
+  if (popcount64(x) != 34) return 1;
+  if (__builtin_popcount(narrow) != 13) return 2;
+  if (__builtin_popcount(0) != 0) return 3;
+  if (popcount64(-1) != 64) return 4;
+  if (__builtin_popcount(-1) != 32) return 5;
+
+  if (ctz64((unsigned long)1 << 40) != 40) return 6;
+  if (__builtin_ctz(narrow) != 3) return 7;
+  if (clz32(1) != 31) return 8;
+  if (clz32(narrow) != 3) return 9;
+  if (clz64(1) != 63) return 10;
+  if (clz64(x) != 0) return 11;
+  if (__builtin_clzl(wide) != 32) return 12;
+
+  unsigned long y = (unsigned long)16909060 << 32 | 84281096;
+  if (bswap64(y) != ((unsigned long)134678021 << 32 | 67305985)) return 13;
+  if (__builtin_bswap32(narrow) != 2018915346) return 14;
+  if (__builtin_bswap16(half) != 13330) return 15;
+  if (sizeof(__builtin_bswap16(half)) != 2) return 16;
+
+  if (rotl64((unsigned long)1 << 63 | 1, 4) != 24) return 17;
+  if (rotr32(narrow, 8) != 2014458966) return 18;
+  if (rotr7(128) != 1) return 19;
+  if (rotr7(narrow) != (narrow >> 7 | narrow << 25)) return 20;
+  for (int n = 1; n < 64; n++) {
+    unsigned long r = rotl64(x, n);
+    if (r != (x << n | x >> (64 - n))) return 21;
+    if (n < 32 && rotr32(narrow, n) != (narrow >> n | narrow << (32 - n)))
+      return 22;
+  }
+
+  if (not_rotate(-16) != -1) return 23;
+  if (not_rotate_2((unsigned int)1 << 31) != 16) return 24;
+
+  if (table[0] != 8 || table[1] != 3 || table[2] != 31) return 25;
+  if (table[3] != 13330) return 26;
+}
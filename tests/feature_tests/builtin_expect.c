@@ -0,0 +1,36 @@
+// Branches with __builtin_expect, whose unexpected paths are moved out of
+// line, and loops whose tests are moved to the end.
+
+int slow(int x) {
+  return x * 3;
+}
+
+int check(int* a, int n) {
+  int total = 0;
+  for(int i = 0; i < n; i++) {
+    if(__builtin_expect(a[i] < 0, 0)) {
+      total = slow(total);
+      continue;
+    }
+    total += a[i];
+  }
+  return total;
+}
+
+int likely(int x) {
+  if(__builtin_expect(x != 0, 1)) return 1;
+  else return 2;
+}
+
+int main() {
+  int a[5] = {1, 2, -1, 3, 4};
+  if(check(a, 5) != 16) return 1;
+  if(likely(5) != 1 || likely(0) != 2) return 2;
+  long v = __builtin_expect(7, 7);
+  if(v != 7) return 3;
+  int n = 0;
+  while(__builtin_expect(n < 10, 1)) n++;
+  if(n != 10) return 4;
+  if(__builtin_expect(n == 3 || n == 10, 1) && __builtin_expect(!n, 0)) return 5;
+  return 0;
+}
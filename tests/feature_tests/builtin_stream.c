@@ -0,0 +1,63 @@
+// Prefetches and stores around the cache, which must store the same values
+// as plain stores, in order with the accesses around them.
+
+int ints[100];
+int src[100];
+long longs[100];
+char chars[8];
+short shorts[8];
+int* ptrs[4];
+
+void fill(long* out, long v, int n) {
+  for(int i = 0; i < n; i++) {
+    __builtin_prefetch(&out[i + 8], 1, 0);
+    __builtin_nontemporal_store(v + i, &out[i]);
+  }
+}
+
+// Vectorized with -ftree-vectorize when dst + from is aligned.
+void copy(int* restrict dst, int* restrict src, int k, int from, int n) {
+  for(int i = from; i < n; i++)
+    __builtin_nontemporal_store(src[i] + k, &dst[i]);
+}
+
+int reload(int* p) {
+  *p = 1;
+  __builtin_nontemporal_store(2, p);
+  return *p;
+}
+
+int main() {
+  fill(longs, 5, 100);
+  for(int i = 0; i < 100; i++) {
+    if(longs[i] != 5 + i) return 1;
+  }
+  fill(longs + 1, 3, 99);
+  for(int i = 1; i < 100; i++) {
+    if(longs[i] != 2 + i) return 2;
+  }
+
+  for(int i = 0; i < 100; i++) src[i] = i;
+  copy(ints, src, 3, 0, 100);
+  for(int i = 0; i < 100; i++) {
+    if(ints[i] != i + 3) return 3;
+  }
+  copy(ints, src, 4, 1, 100);
+  if(ints[0] != 3) return 4;
+  for(int i = 1; i < 100; i++) {
+    if(ints[i] != i + 4) return 5;
+  }
+
+  __builtin_nontemporal_store(9, &chars[2]);
+  __builtin_nontemporal_store(-7, &shorts[3]);
+  __builtin_nontemporal_store(&ints[3], &ptrs[1]);
+  if(chars[2] != 9 || shorts[3] != -7 || *ptrs[1] != 7) return 6;
+  if(reload(&ints[0]) != 2) return 7;
+
+  __builtin_prefetch(ints);
+  __builtin_prefetch(ints, 0);
+  __builtin_prefetch(&ints[50], 0, 1);
+  __builtin_prefetch(&ints[50], 1, 2);
+  __builtin_prefetch(0);
+  return 0;
+}
@@ -0,0 +1,36 @@
+// Test the inline expansion of calls to memcpy, memmove, memset, and strlen.
+
+#include <string.h>
+struct S { long a, b; int c; };
+int main() {
+  struct S x, y;
+  x.a = 1; x.b = 2; x.c = 3;
+  memcpy(&y, &x, sizeof(struct S));
+  if (y.a != 1 || y.b != 2 || y.c != 3) return 1;
+  char buf[40];
+  for (int i = 0; i < 40; i++) buf[i] = i;
+  memmove(buf + 2, buf, 20);
+  if (buf[2] != 0 || buf[21] != 19 || buf[22] != 22) return 2;
+  memmove(buf, buf + 1, 7);
+  if (buf[0] != 1 || buf[6] != 5) return 3;
+  memset(buf, 0, 33);
+  if (buf[0] || buf[32] || buf[33] != 33) return 4;
+  memset(buf, 90, 19);
+  if (buf[0] != 90 || buf[18] != 90 || buf[19] != 0) return 5;
+  int v = 200;
+  memset(buf, v, 7);
+  if (buf[6] != (char)200 || buf[7] != 90) return 6;
+  memset(buf, v + 1, 24);
+  if (buf[23] != (char)201 || buf[24] != 0) return 7;
+  memset(buf, -1, 3);
+  if (buf[2] != -1) return 8;
+  if (strlen("hello") != 5) return 9;
+  char* p = memcpy(buf, "abc", 4);
+  if (p != buf || strlen(buf) != 3) return 10;
+  memcpy(buf, buf + 20, 0);
+  char big[300];
+  memset(big, 1, 300);
+  memcpy(big, big + 150, 150);
+  if (big[299] != 1) return 11;
+  return 0;
+}
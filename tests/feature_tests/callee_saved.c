@@ -0,0 +1,34 @@
+// Return: 0
+
+int sum3(int a, int b, int c) {
+  return a + b + c;
+}
+
+int fib(int n) {
+  if(n < 2) return n;
+
+  // `n` and `a` are live across the calls, so they are kept in
+  // callee-saved registers which fib itself must save and restore.
+  int a = fib(n - 1);
+  return a + fib(n - 2);
+}
+
+int main() {
+  int a = 1, b = 2, c = 3, d = 4, e = 5, f = 6;
+
+  int total = sum3(a, b, c);
+  total = total + sum3(d, e, f);
+  if(total != 21) return 1;
+
+  // Every local is still intact after the calls.
+  if(a + b + c + d + e + f != 21) return 2;
+
+  if(fib(15) != 610) return 3;
+
+  int g = 7, h = 8, i = 9, j = 10, k = 11, l = 12, m = 13, n = 14;
+  int x = sum3(g, h, i) + sum3(j, k, l) + sum3(m, n, a);
+  if(x != 85) return 4;
+  if(g + h + i + j + k + l + m + n != 84) return 5;
+
+  return 0;
+}
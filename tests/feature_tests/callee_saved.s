@@ -0,0 +1,75 @@
+	.intel_syntax noprefix
+	.section .text
+	.global sum3
+	.global fib
+	.global main
+sum3:
+	push rbp
+	mov rbp, rsp
+	add edi, esi
+	add edx, edi
+	mov eax, edx
+	mov rsp, rbp
+	pop rbp
+	ret
+fib:
+	push rbp
+	mov rbp, rsp
+	push rbx
+	push r12
+	push r13
+	sub rsp, 8
+	mov r12d, edi
+	cmp r12d, 2
+	jge __shivyc_label1
+	mov eax, r12d
+	lea rsp, [rbp-24]
+	pop r13
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label1:
+	lea r13, [fib]
+	mov edi, r12d
+	sub edi, 1
+	call r13
+	mov ebx, eax
+	sub r12d, 2
+	mov edi, r12d
+	call r13
+	add ebx, eax
+	mov eax, ebx
+	lea rsp, [rbp-24]
+	pop r13
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+main:
+	push rbp
+	mov rbp, rsp
+__shivyc_label7:
+__shivyc_label8:
+__shivyc_label2:
+__shivyc_label3:
+	lea rax, [fib]
+	mov edi, 15
+	call rax
+	cmp eax, 610
+	je __shivyc_label4
+	mov eax, 3
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label4:
+__shivyc_label9:
+__shivyc_label10:
+__shivyc_label11:
+__shivyc_label5:
+__shivyc_label6:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
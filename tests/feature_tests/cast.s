@@ -0,0 +1,27 @@
+	.intel_syntax noprefix
+	.section .text
+	.global main
+main:
+	push rbp
+	mov rbp, rsp
+	sub rsp, 16
+	lea rax, [rbp-8]
+	mov rcx, rax
+	add rcx, 0
+	mov QWORD PTR [rcx], 75
+	add rax, 0
+	mov eax, DWORD PTR [rax]
+	cmp eax, 75
+	je __shivyc_label1
+	mov eax, 1
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label1:
+__shivyc_label2:
+__shivyc_label3:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
@@ -0,0 +1,31 @@
+int main() {
+  int a = 3, b = -5;
+  unsigned int u = 3, v = 4294967291;
+  long big = 10000000000;
+
+  if(a < b) return 1;
+  if(!(b < a)) return 2;
+  if(u > v) return 3;
+  if(5 <= a) return 4;
+  if(big < 9000000000) return 5;
+  if(9000000000 > big) return 6;
+
+  int* p = &a;
+  int* q = &a;
+  if(p != q) return 7;
+
+  int* addr = &b;
+  if(*addr >= 0) return 8;
+
+  int count = 0;
+  while(count < 10) count++;
+  if(count != 10) return 9;
+
+  for(int i = 10; i != 0; i--) count += 1;
+  if(count != 20) return 10;
+
+  // The comparison result is used again
+  int less = a < 4;
+  if(less) count++;
+  if(count != 21 || less != 1) return 11;
+}
@@ -0,0 +1,102 @@
+	.intel_syntax noprefix
+	.section .text
+	.global main
+main:
+	push rbp
+	mov rbp, rsp
+	sub rsp, 16
+	mov DWORD PTR [rbp-4], 3
+	mov DWORD PTR [rbp-8], -5
+	mov eax, DWORD PTR [rbp-4]
+	cmp eax, DWORD PTR [rbp-8]
+	jge __shivyc_label1
+	mov eax, 1
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label1:
+	mov eax, DWORD PTR [rbp-8]
+	cmp eax, DWORD PTR [rbp-4]
+	jl __shivyc_label2
+	mov eax, 2
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label2:
+__shivyc_label3:
+	cmp DWORD PTR [rbp-4], 5
+	jl __shivyc_label4
+	mov eax, 4
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label4:
+__shivyc_label5:
+__shivyc_label6:
+	lea rax, [rbp-4]
+	cmp rax, rax
+	je __shivyc_label7
+	mov eax, 7
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label7:
+	lea rax, [rbp-8]
+	mov eax, DWORD PTR [rax]
+	cmp eax, 0
+	jl __shivyc_label8
+	mov eax, 8
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label8:
+	mov eax, 0
+__shivyc_label9:
+	cmp eax, 10
+	jge __shivyc_label10
+	add eax, 1
+	jmp __shivyc_label9
+__shivyc_label10:
+	cmp eax, 10
+	je __shivyc_label11
+	mov eax, 9
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label11:
+	mov ecx, 10
+__shivyc_label12:
+	cmp ecx, 0
+	je __shivyc_label14
+	add eax, 1
+	sub ecx, 1
+	jmp __shivyc_label12
+__shivyc_label14:
+	cmp eax, 20
+	je __shivyc_label15
+	mov eax, 10
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label15:
+	mov ecx, 0
+	cmp DWORD PTR [rbp-4], 4
+	jge __shivyc_label16
+	mov ecx, 1
+	add eax, 1
+__shivyc_label16:
+	cmp eax, 21
+	jne __shivyc_label18
+	cmp ecx, 1
+	je __shivyc_label17
+__shivyc_label18:
+	mov eax, 11
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label17:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
@@ -0,0 +1,196 @@
+	.intel_syntax noprefix
+	.section .text
+	.global main
+main:
+	push rbp
+	mov rbp, rsp
+	sub rsp, 32
+	mov DWORD PTR [rbp-4], 5
+	mov DWORD PTR [rbp-8], 10
+	mov eax, DWORD PTR [rbp-4]
+	cmp eax, DWORD PTR [rbp-8]
+	jne __shivyc_label1
+	mov eax, 1
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label1:
+	cmp DWORD PTR [rbp-4], 5
+	jne __shivyc_label2
+	jmp __shivyc_label3
+__shivyc_label2:
+	mov eax, 36
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label3:
+	lea rcx, [rbp-4]
+	lea rax, [rbp-8]
+	cmp rcx, rax
+	jne __shivyc_label4
+	mov eax, 2
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label4:
+	cmp rcx, rcx
+	je __shivyc_label5
+	mov eax, 3
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label5:
+	mov edx, 0
+	cmp rcx, 0
+	jne __shivyc_label6
+	mov edx, 1
+	mov eax, 4
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label6:
+	cmp edx, 0
+	je __shivyc_label7
+	mov eax, 5
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label7:
+	cmp rcx, 0
+	jne __shivyc_label8
+	mov eax, 6
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label8:
+	cmp rcx, 0
+	jne __shivyc_label9
+	mov eax, 10
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label9:
+	cmp rcx, 0
+	jne __shivyc_label10
+	mov eax, 11
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label10:
+	cmp rcx, rax
+	jne __shivyc_label11
+	mov eax, 12
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label11:
+	cmp rax, rcx
+	jne __shivyc_label12
+	mov eax, 13
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label12:
+	cmp rcx, rcx
+	je __shivyc_label13
+	mov eax, 14
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label13:
+__shivyc_label14:
+__shivyc_label15:
+	mov DWORD PTR [rbp-4], 5
+	mov DWORD PTR [rbp-8], 10
+	mov eax, DWORD PTR [rbp-4]
+	cmp eax, DWORD PTR [rbp-8]
+	jle __shivyc_label16
+	mov eax, 17
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label16:
+	mov eax, DWORD PTR [rbp-4]
+	cmp eax, DWORD PTR [rbp-8]
+	jl __shivyc_label17
+	mov eax, 18
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label17:
+	mov eax, DWORD PTR [rbp-8]
+	cmp eax, DWORD PTR [rbp-4]
+	jge __shivyc_label18
+	mov eax, 19
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label18:
+	mov eax, DWORD PTR [rbp-8]
+	cmp eax, DWORD PTR [rbp-4]
+	jg __shivyc_label19
+	mov eax, 20
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label19:
+	cmp DWORD PTR [rbp-4], 5
+	jge __shivyc_label20
+	mov eax, 21
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label20:
+	cmp DWORD PTR [rbp-8], 10
+	jge __shivyc_label21
+	mov eax, 22
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label21:
+__shivyc_label22:
+__shivyc_label23:
+__shivyc_label24:
+__shivyc_label25:
+__shivyc_label26:
+__shivyc_label27:
+__shivyc_label28:
+__shivyc_label29:
+__shivyc_label30:
+	lea rcx, [rbp-32+4*1]
+	lea rax, [rbp-32+4*3]
+	cmp rcx, rax
+	jbe __shivyc_label31
+	mov eax, 21
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label31:
+	cmp rcx, rax
+	jb __shivyc_label32
+	mov eax, 22
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label32:
+	cmp rax, rcx
+	jae __shivyc_label33
+	mov eax, 23
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label33:
+	cmp rax, rcx
+	ja __shivyc_label34
+	mov eax, 24
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label34:
+__shivyc_label35:
+__shivyc_label36:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
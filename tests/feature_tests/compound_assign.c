@@ -1,3 +1,21 @@
+// The result of a compound assignment to an int from a long operation is
+// truncated before it is stored, so it does not overwrite the object next to
+// the int while many values are live.
+long or_loop(long p1, long p2) {
+  int v3 = 1, v4 = 5;
+  long v0 = 7, a = p1 + 1, b = p2 + 2, c = p1 * 3, d = p2 * 5;
+  long e = p1 ^ 7, f = p1 - 9, g = p2 - 11, h = p1 * p2, k = p1 + p2;
+  long m = p1 - p2, n = p1 << 2;
+  for(int i = 0; i < 15; i++) {
+    v3 |= (unsigned long)p1 * 4294967296 + (unsigned long)i;
+    v0 += 1000000 / (v4 + v3 % 3);
+    v4 += 1;
+    a += b; b += c; c += d; d += e; e += f; f += g; g += h; h += k;
+    k += m; m += n; n += a;
+  }
+  return v0 + v3 + v4 + a + b + c + d + e + f + g + h + k + m + n;
+}
+
 int main() {
   int a, b;
 
@@ -48,4 +66,10 @@ int main() {
   b = a %= 100;
   if(a != 34) return 19;
   if(b != 34) return 20;
+
+  a = 1;
+  b = a |= 1099511627778;
+  if(a != 3 || b != 3) return 21;
+
+  if(or_loop(31, 2) != 22966433) return 22;
 }
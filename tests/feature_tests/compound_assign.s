@@ -0,0 +1,216 @@
+	.intel_syntax noprefix
+	.section .text
+	.global main
+main:
+	push rbp
+	mov rbp, rsp
+	sub rsp, 16
+	lea rax, [rbp-4]
+	mov rcx, rax
+	add rcx, 20
+	cmp rcx, rcx
+	je __shivyc_label1
+	mov eax, 1
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label1:
+	sub rcx, rax
+	mov rdx, rcx
+	sar rdx, 63
+	shr rdx, 62
+	add rcx, rdx
+	sar rcx, 2
+	mov edx, 0
+	cmp rcx, 5
+	je __shivyc_label2
+	mov edx, 1
+	mov eax, 2
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label2:
+	cmp edx, 0
+	je __shivyc_label3
+	mov eax, 3
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label3:
+	mov rcx, rax
+	sub rcx, 20
+	cmp rcx, rcx
+	je __shivyc_label4
+	mov eax, 4
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label4:
+	sub rax, rcx
+	mov rcx, rax
+	sar rcx, 63
+	shr rcx, 62
+	add rax, rcx
+	sar rax, 2
+	mov ecx, 0
+	cmp rax, 5
+	je __shivyc_label5
+	mov ecx, 1
+	mov eax, 5
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label5:
+	cmp ecx, 0
+	je __shivyc_label6
+	mov eax, 6
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label6:
+	mov DWORD PTR [rbp-4], 10
+	mov eax, DWORD PTR [rbp-4]
+	add eax, 5
+	mov DWORD PTR [rbp-4], eax
+	cmp DWORD PTR [rbp-4], eax
+	je __shivyc_label7
+	mov eax, 7
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label7:
+	cmp eax, 15
+	je __shivyc_label8
+	mov eax, 8
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label8:
+	cmp DWORD PTR [rbp-4], 15
+	je __shivyc_label9
+	mov eax, 9
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label9:
+	mov rax, 1099511627776
+	mov DWORD PTR [rbp-4], 10
+	movsx rcx, DWORD PTR [rbp-4]
+	add rax, rcx
+	mov DWORD PTR [rbp-4], eax
+	cmp DWORD PTR [rbp-4], 10
+	je __shivyc_label10
+	mov eax, 10
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label10:
+	mov DWORD PTR [rbp-4], 10
+	movsx rax, DWORD PTR [rbp-4]
+	mov rcx, 1099511627776
+	add rax, rcx
+	mov DWORD PTR [rbp-4], eax
+	cmp DWORD PTR [rbp-4], 10
+	je __shivyc_label11
+	mov eax, 11
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label11:
+	mov DWORD PTR [rbp-4], 10
+	mov eax, DWORD PTR [rbp-4]
+	sub eax, 15
+	mov DWORD PTR [rbp-4], eax
+	cmp DWORD PTR [rbp-4], eax
+	je __shivyc_label12
+	mov eax, 12
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label12:
+	mov ecx, DWORD PTR [rbp-4]
+	add ecx, 5
+	cmp ecx, 0
+	je __shivyc_label13
+	mov eax, 13
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label13:
+	add eax, 5
+	cmp eax, 0
+	je __shivyc_label14
+	mov eax, 14
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label14:
+	mov DWORD PTR [rbp-4], 10
+	movsx rax, DWORD PTR [rbp-4]
+	sal rax, 40
+	mov DWORD PTR [rbp-4], eax
+	cmp DWORD PTR [rbp-4], 0
+	je __shivyc_label15
+	mov eax, 15
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label15:
+	cmp eax, 0
+	je __shivyc_label16
+	mov eax, 16
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label16:
+	mov DWORD PTR [rbp-4], 10
+	mov eax, DWORD PTR [rbp-4]
+	mov ecx, eax
+	shr ecx, 31
+	add eax, ecx
+	sar eax, 1
+	mov DWORD PTR [rbp-4], eax
+	cmp DWORD PTR [rbp-4], 5
+	je __shivyc_label17
+	mov eax, 17
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label17:
+	cmp eax, 5
+	je __shivyc_label18
+	mov eax, 18
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label18:
+	mov DWORD PTR [rbp-4], 1234
+	movsx rax, DWORD PTR [rbp-4]
+	imul rax, 1374389535
+	sar rax, 37
+	mov rcx, rax
+	shr rcx, 63
+	add rax, rcx
+	imul eax, 100
+	neg eax
+	add eax, DWORD PTR [rbp-4]
+	mov DWORD PTR [rbp-4], eax
+	cmp DWORD PTR [rbp-4], 34
+	je __shivyc_label19
+	mov eax, 19
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label19:
+	cmp eax, 34
+	je __shivyc_label20
+	mov eax, 20
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label20:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
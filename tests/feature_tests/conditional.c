@@ -0,0 +1,57 @@
+// The helper defines a struct inside an include guard, so including it a
+// second time would be an error if the guard did not skip it.
+#include "conditional_helper.h"
+#include "conditional_helper.h"
+
+#define LEVEL 3
+
+#if LEVEL > 5
+int value = 1;
+#elif LEVEL > 2 && defined(LEVEL) && !defined NOT_DEFINED
+int value = 2;
+#else
+int value = 3;
+#endif
+
+#ifdef NOT_DEFINED
+int value = 4;
+#endif
+
+#ifndef LEVEL
+int value = 5;
+#endif
+
+// These lines are skipped without being tokenized.
+#if 0
+  this isn't C @ 0x10 "
+#if 1
+#error nested in skipped branch
+#endif
+#endif
+
+#if (1 << 4) == 16 && (-7 / 2 == -3) && (-7 % 2 == -1) && 'a' == 97
+int arith = 1;
+#endif
+
+#if 0 && 1 / 0
+#elif UNDEFINED_NAME == 0
+int undefined_zero = 1;
+#endif
+
+#if (LEVEL > 2 ? 1 ? 4 : 1 / 0 : 5) == 4 && (0 ? 1 / 0 : 6) == 6
+int ternary = 1;
+#endif
+
+#undef LEVEL
+#ifdef LEVEL
+int level_defined;
+#endif
+
+int main() {
+  struct point p;
+  p.x = 1;
+  if (value != 2) return 1;
+  if (arith + undefined_zero != 2) return 2;
+  if (ternary != 1) return 3;
+  return 0;
+}
@@ -0,0 +1,11 @@
+// Comments may come before and after the guard.
+#ifndef CONDITIONAL_HELPER_H
+#define CONDITIONAL_HELPER_H
+
+struct point {
+  int x;
+  int y;
+};
+
+#endif
+/* end of conditional_helper.h */
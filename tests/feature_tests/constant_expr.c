@@ -0,0 +1,52 @@
+// Initializers of static variables and array sizes are constant
+// expressions, evaluated at compile time.
+
+struct S { int a; long b; char c[6]; };
+
+int g = 5;
+int arr[4];
+int mat[2][3];
+struct S s;
+
+// Address constants
+int *pg = &g;
+int *pa = &arr[2];
+int *pa2 = arr + 3;
+int *pm = &mat[1][2];
+long *pb = &s.b;
+char *pc = &s.c[3];
+char *pc2 = s.c;
+char *str = "hello";
+char *str2 = "hello" + 2;
+_Bool nonnull = &g;
+
+static int helper(int x) { return x + 1; }
+int (*fp)(int) = helper;
+
+// Integer constants
+int size = sizeof(struct S) * 4;
+int shifted = 1 << 10;
+long diff = &arr[3] - &arr[1];
+unsigned char truncated = (unsigned char)300;
+int logic = (3 < 4) + (2 == 2) + (1 != 1) + !0 + (1 && 2) + (0 || 0);
+int rem = -7 % 3;
+int quot = -7 / 2;
+
+int table[sizeof(int) * 2 + (3 > 2)];
+
+int main() {
+  static int *local = &g;
+
+  if(*pg != 5) return 1;
+  if(pa != arr + 2 || pa2 != &arr[3]) return 2;
+  if(pm != &mat[1][2]) return 3;
+  if(pb != &s.b || pc != s.c + 3 || pc2 != s.c) return 4;
+  if(str[1] != 'e' || *str2 != 'l') return 5;
+  if(!nonnull || local != &g) return 6;
+  if(fp(4) != 5) return 7;
+
+  if(size != 4 * sizeof(struct S)) return 8;
+  if(shifted != 1024 || diff != 2 || truncated != 44) return 9;
+  if(logic != 4 || rem != -1 || quot != -3) return 10;
+  if(sizeof(table) != 9 * sizeof(int)) return 11;
+}
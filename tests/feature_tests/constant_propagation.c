@@ -0,0 +1,62 @@
+int feature_x() {
+  int enabled = 0;
+  int n = 7;
+
+  // Only the branch on a known condition survives
+  if(enabled) n = n * 100;
+  else n = n + 1;
+  return n;
+}
+
+int main() {
+  int a = 6, b = 4;
+  int c = a * b + 2;
+  if(c != 26) return 1;
+  if(feature_x() != 8) return 2;
+
+  // Division and remainder truncate toward zero
+  int d = -7, e = 2;
+  if(d / e != -3) return 3;
+  if(d % e != -1) return 4;
+
+  // Unsigned arithmetic wraps around
+  unsigned int u = 0;
+  u = u - 1;
+  if(u != 4294967295) return 5;
+  if(u / 2 != 2147483647) return 6;
+
+  // Constants too large for an immediate operand
+  long big = 1;
+  big = big << 40;
+  long big2 = big + 3;
+  if(big2 != 1099511627779) return 7;
+
+  // A literal on the left of a comparison
+  int x = 10;
+  int y = c;
+  if(!(5 < x)) return 8;
+  if(30 < y) return 9;
+  if(!(26 >= y)) return 10;
+
+  // Identities
+  int z = y + 0;
+  z = z * 1;
+  z = z - 0;
+  if(z != 26) return 11;
+
+  // A value only constant along the reachable path
+  int i, sum = 0;
+  for(i = 0; i < 5; i++) {
+    if(a != 6) sum = sum + 100;
+    sum = sum + 1;
+  }
+  if(sum != 5) return 12;
+
+  // Conversions
+  char ch = 300;
+  if(ch != 44) return 13;
+  _Bool t = 5;
+  if(t != 1) return 14;
+
+  return 0;
+}
@@ -0,0 +1,52 @@
+	.intel_syntax noprefix
+	.section .text
+	.global feature_x
+	.global main
+feature_x:
+	push rbp
+	mov rbp, rsp
+__shivyc_label1:
+	mov eax, 8
+	mov rsp, rbp
+	pop rbp
+	ret
+main:
+	push rbp
+	mov rbp, rsp
+__shivyc_label3:
+__shivyc_label21:
+__shivyc_label23:
+__shivyc_label4:
+__shivyc_label5:
+__shivyc_label6:
+__shivyc_label7:
+__shivyc_label8:
+__shivyc_label9:
+__shivyc_label10:
+__shivyc_label11:
+__shivyc_label12:
+__shivyc_label13:
+	mov ecx, 0
+	mov eax, 0
+__shivyc_label14:
+	cmp eax, 5
+	jge __shivyc_label16
+__shivyc_label17:
+	add ecx, 1
+	add eax, 1
+	jmp __shivyc_label14
+__shivyc_label16:
+	cmp ecx, 5
+	je __shivyc_label18
+	mov eax, 12
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label18:
+__shivyc_label19:
+__shivyc_label20:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
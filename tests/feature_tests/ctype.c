@@ -0,0 +1,38 @@
+// Tests that the macros of <ctype.h> agree with the library functions.
+
+#include <ctype.h>
+
+int main() {
+  for (int c = -1; c < 256; c++) {
+    if (!isalnum(c) != !(isalnum)(c)) return 1;
+    if (!isalpha(c) != !(isalpha)(c)) return 2;
+    if (!isascii(c) != !(isascii)(c)) return 3;
+    if (!iscntrl(c) != !(iscntrl)(c)) return 4;
+    if (!isdigit(c) != !(isdigit)(c)) return 5;
+    if (!isgraph(c) != !(isgraph)(c)) return 6;
+    if (!islower(c) != !(islower)(c)) return 7;
+    if (!isprint(c) != !(isprint)(c)) return 8;
+    if (!ispunct(c) != !(ispunct)(c)) return 9;
+    if (!isspace(c) != !(isspace)(c)) return 10;
+    if (!isupper(c) != !(isupper)(c)) return 11;
+    if (!isxdigit(c) != !(isxdigit)(c)) return 12;
+    if (toascii(c) != (toascii)(c)) return 13;
+    if (tolower(c) != (tolower)(c)) return 14;
+    if (toupper(c) != (toupper)(c)) return 15;
+  }
+
+  // Each argument is evaluated once.
+  char *s = "a1 ";
+  int n = 0;
+  while (isalnum(*s++)) n++;
+  if (n != 2 || *s) return 16;
+
+  int i = 0;
+  if (toupper(s[-3 + i++]) != 'A' || i != 1) return 17;
+
+  // The functions can still be named.
+  int (*f)(int) = isdigit;
+  if (!f('7') || f('x')) return 18;
+
+  return 0;
+}
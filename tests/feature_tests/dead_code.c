@@ -0,0 +1,61 @@
+int calls = 0;
+int global;
+
+int count_call() {
+  calls++;
+  return calls;
+}
+
+void set_at(int* p, int val) {
+  *p = val;
+}
+
+struct S {
+  int a;
+  long b[4];
+};
+
+int main() {
+  int arg = 3;
+
+  // Unused computations are removed, but calls are kept
+  int unused = arg * 5 + 2;
+  int also_unused = count_call();
+  if(calls != 1) return 1;
+
+  // Stores to a local never read again
+  int never_read;
+  int* p = &never_read;
+  *p = 10;
+  *p = arg;
+
+  int arr[10];
+  for(int i = 0; i < 10; i++) arr[i] = i * arg;
+
+  struct S s;
+  s.a = 4;
+  s.b[2] = 5;
+
+  // Stores through a pointer which escapes are kept
+  int escaped = 0;
+  set_at(&escaped, 7);
+  if(escaped != 7) return 2;
+
+  int through = 1;
+  int* q = &through;
+  *q = 8;
+  if(through != 8) return 3;
+
+  // Stores to globals are kept
+  global = arg;
+  if(global != 3) return 4;
+
+  int read[3];
+  read[1] = 6;
+  if(read[1] != 6) return 5;
+
+  // A loop computing a value which is never read
+  int sum = 0;
+  for(int i = 0; i < 5; i++) sum += count_call();
+  if(calls != 6) return 6;
+}
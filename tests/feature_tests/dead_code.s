@@ -0,0 +1,111 @@
+	.intel_syntax noprefix
+	.comm global 4
+	.section .data
+calls:
+	.zero 4
+
+	.section .text
+	.global calls
+	.global count_call
+	.global set_at
+	.global main
+count_call:
+	push rbp
+	mov rbp, rsp
+	mov eax, DWORD PTR [calls]
+	add eax, 1
+	mov DWORD PTR [calls], eax
+	mov eax, DWORD PTR [calls]
+	mov rsp, rbp
+	pop rbp
+	ret
+set_at:
+	push rbp
+	mov rbp, rsp
+	mov DWORD PTR [rdi], esi
+	mov rsp, rbp
+	pop rbp
+	ret
+main:
+	push rbp
+	mov rbp, rsp
+	sub rsp, 32
+	mov eax, DWORD PTR [calls]
+	add eax, 1
+	mov DWORD PTR [calls], eax
+__shivyc_label13:
+	cmp DWORD PTR [calls], 1
+	je __shivyc_label1
+	mov eax, 1
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label1:
+	mov eax, 0
+__shivyc_label2:
+	cmp eax, 10
+	jge __shivyc_label4
+	add eax, 1
+	jmp __shivyc_label2
+__shivyc_label4:
+	mov DWORD PTR [rbp-4], 0
+	lea rax, [rbp-4]
+	mov DWORD PTR [rax], 7
+__shivyc_label14:
+	cmp DWORD PTR [rbp-4], 7
+	je __shivyc_label5
+	mov eax, 2
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label5:
+	mov DWORD PTR [rbp-8], 1
+	lea rax, [rbp-8]
+	mov DWORD PTR [rax], 8
+	cmp DWORD PTR [rbp-8], 8
+	je __shivyc_label6
+	mov eax, 3
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label6:
+	mov DWORD PTR [global], 3
+	cmp DWORD PTR [global], 3
+	je __shivyc_label7
+	mov eax, 4
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label7:
+	mov DWORD PTR [rbp-24+4*1], 6
+	mov eax, DWORD PTR [rbp-24+4*1]
+	cmp eax, 6
+	je __shivyc_label8
+	mov eax, 5
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label8:
+	mov eax, 0
+__shivyc_label9:
+	cmp eax, 5
+	jge __shivyc_label11
+	mov ecx, DWORD PTR [calls]
+	add ecx, 1
+	mov DWORD PTR [calls], ecx
+__shivyc_label15:
+	add eax, 1
+	jmp __shivyc_label9
+__shivyc_label11:
+	cmp DWORD PTR [calls], 6
+	je __shivyc_label12
+	mov eax, 6
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label12:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
@@ -0,0 +1,42 @@
+// Return: 40
+
+// Static functions and data which nothing reachable refers to are dropped,
+// while those reached only through other static functions or through
+// static data must still be emitted.
+
+static int unused(int x) { return x * 7; }
+static int unused_data[100] = {1, 2, 3};
+static char* unused_str = "never used";
+
+static int defined_later(int x);
+static int calls_later(int x) { return defined_later(x) * 2; }
+
+static int in_table(int x) { return x + 3; }
+static int unused_in_table(int x) { return x - 3; }
+static int (*table[])(int) = {in_table};
+static int (*unused_table[])(int) = {unused_in_table};
+
+static int odd(int x);
+static int even(int x) {
+  if(x) return odd(x - 1);
+  return 1;
+}
+static int odd(int x) {
+  if(x) return even(x - 1);
+  return 0;
+}
+
+static int counter = 10;
+static int* counter_ptr = &counter;
+
+int main() {
+  if(calls_later(4) != 10) return 1;
+  if(table[0](1) != 4) return 2;
+  if(!even(10)) return 3;
+  if(odd(10)) return 4;
+
+  *counter_ptr += 30;
+  return counter;
+}
+
+static int defined_later(int x) { return x + 1; }
@@ -0,0 +1,39 @@
+	.intel_syntax noprefix
+	.section .text
+	.global f4
+	.global func
+	.global getFunc
+	.global main
+f4:
+	push rbp
+	mov rbp, rsp
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+func:
+	push rbp
+	mov rbp, rsp
+	mov eax, edi
+	mov rsp, rbp
+	pop rbp
+	ret
+getFunc:
+	push rbp
+	mov rbp, rsp
+	lea rax, [func]
+	mov rsp, rbp
+	pop rbp
+	ret
+main:
+	push rbp
+	mov rbp, rsp
+	sub rsp, 32
+	mov DWORD PTR [rbp-4], 7
+	lea rax, [rbp-4]
+	mov QWORD PTR [rbp-32+8*2], rax
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
@@ -0,0 +1,32 @@
+// Division and modulus by a literal are done without a divide instruction,
+// so check them on values the compiler cannot fold.
+
+int neg = -2147483647 - 1, pos = 2147483647, small = -37;
+unsigned umax = 4294967295;
+long lneg = -9223372036854775807 - 1, lpos = 1234567890123456789;
+unsigned long lumax = -1;
+
+int main() {
+  // Powers of two round toward zero.
+  if(small / 4 != -9 || small % 4 != -1) return 1;
+  if(small / -8 != 4 || small % -8 != -5) return 2;
+  if(neg / 2 != -1073741824 || neg % 16 != 0) return 3;
+  if(umax / 16 != 268435455 || umax % 16 != 15) return 4;
+  if(lumax % 1099511627776 != 1099511627775) return 5;
+  if(lneg / 1073741824 != -8589934592) return 6;
+
+  // Other divisors use a multiply.
+  if(small / 7 != -5 || small % 7 != -2) return 7;
+  if(small / -10 != 3 || small % -10 != -7) return 8;
+  if(neg / 7 != -306783378 || neg % 7 != -2) return 9;
+  if(pos / 10 != 214748364 || pos % 10 != 7) return 10;
+  if(umax / 7 != 613566756 || umax % 7 != 3) return 11;
+  if(umax / 10 != 429496729 || umax % 10 != 5) return 12;
+  if(lpos / 1000 != 1234567890123456 || lpos % 1000 != 789) return 13;
+  if(lneg / 7 != -1317624576693539401 || lneg % 7 != -1) return 14;
+  if(lumax / 7 != 2635249153387078802 || lumax % 7 != 1) return 15;
+  if(lumax / 10 != 1844674407370955161 || lumax % 10 != 5) return 16;
+
+  // Division by one or minus one.
+  if(small / -1 != 37 || small % -1 != 0 || small % 1 != 0) return 17;
+}
@@ -0,0 +1,417 @@
+	.intel_syntax noprefix
+	.section .data
+lpos:
+	.quad 1234567890123456789
+lneg:
+	.quad -9223372036854775808
+neg:
+	.int -2147483648
+pos:
+	.int 2147483647
+umax:
+	.int 4294967295
+small:
+	.int -37
+lumax:
+	.quad -1
+
+	.section .text
+	.global neg
+	.global pos
+	.global small
+	.global umax
+	.global lneg
+	.global lpos
+	.global lumax
+	.global main
+main:
+	push rbp
+	mov rbp, rsp
+	mov eax, DWORD PTR [small]
+	mov ecx, eax
+	sar ecx, 31
+	shr ecx, 30
+	add eax, ecx
+	sar eax, 2
+	cmp eax, -9
+	jne __shivyc_label2
+	mov eax, DWORD PTR [small]
+	mov ecx, eax
+	sar ecx, 31
+	shr ecx, 30
+	add ecx, eax
+	sar ecx, 2
+	sal ecx, 2
+	sub eax, ecx
+	cmp eax, -1
+	je __shivyc_label1
+__shivyc_label2:
+	mov eax, 1
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label1:
+	mov eax, DWORD PTR [small]
+	mov ecx, eax
+	sar ecx, 31
+	shr ecx, 29
+	add eax, ecx
+	sar eax, 3
+	neg eax
+	cmp eax, 4
+	jne __shivyc_label4
+	mov eax, DWORD PTR [small]
+	mov ecx, eax
+	sar ecx, 31
+	shr ecx, 29
+	add ecx, eax
+	sar ecx, 3
+	sal ecx, 3
+	sub eax, ecx
+	cmp eax, -5
+	je __shivyc_label3
+__shivyc_label4:
+	mov eax, 2
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label3:
+	mov eax, DWORD PTR [neg]
+	mov ecx, eax
+	shr ecx, 31
+	add eax, ecx
+	sar eax, 1
+	cmp eax, -1073741824
+	jne __shivyc_label6
+	mov eax, DWORD PTR [neg]
+	mov ecx, eax
+	sar ecx, 31
+	shr ecx, 28
+	add ecx, eax
+	sar ecx, 4
+	sal ecx, 4
+	sub eax, ecx
+	cmp eax, 0
+	je __shivyc_label5
+__shivyc_label6:
+	mov eax, 3
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label5:
+	mov eax, DWORD PTR [umax]
+	shr eax, 4
+	cmp eax, 268435455
+	jne __shivyc_label8
+	mov eax, DWORD PTR [umax]
+	and eax, 15
+	cmp eax, 15
+	je __shivyc_label7
+__shivyc_label8:
+	mov eax, 4
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label7:
+	mov rax, QWORD PTR [lumax]
+	sal rax, 24
+	shr rax, 24
+	mov rcx, 1099511627775
+	cmp rax, rcx
+	je __shivyc_label9
+	mov eax, 5
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label9:
+	mov rax, QWORD PTR [lneg]
+	mov rcx, rax
+	sar rcx, 63
+	shr rcx, 34
+	add rax, rcx
+	sar rax, 30
+	mov rcx, -8589934592
+	cmp rax, rcx
+	je __shivyc_label10
+	mov eax, 6
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label10:
+	movsx rax, DWORD PTR [small]
+	mov rcx, 2454267027
+	imul rax, rcx
+	sar rax, 34
+	mov rcx, rax
+	shr rcx, 63
+	add rax, rcx
+	cmp eax, -5
+	jne __shivyc_label12
+	movsx rax, DWORD PTR [small]
+	mov rcx, 2454267027
+	imul rax, rcx
+	sar rax, 34
+	mov rcx, rax
+	shr rcx, 63
+	add rax, rcx
+	imul eax, 7
+	neg eax
+	add eax, DWORD PTR [small]
+	cmp eax, -2
+	je __shivyc_label11
+__shivyc_label12:
+	mov eax, 7
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label11:
+	movsx rax, DWORD PTR [small]
+	imul rax, 1717986919
+	sar rax, 34
+	mov rcx, rax
+	shr rcx, 63
+	add rax, rcx
+	neg eax
+	cmp eax, 3
+	jne __shivyc_label14
+	movsx rax, DWORD PTR [small]
+	imul rax, 1717986919
+	sar rax, 34
+	mov rcx, rax
+	shr rcx, 63
+	add rax, rcx
+	neg eax
+	imul eax, -10
+	neg eax
+	add eax, DWORD PTR [small]
+	cmp eax, -7
+	je __shivyc_label13
+__shivyc_label14:
+	mov eax, 8
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label13:
+	movsx rax, DWORD PTR [neg]
+	mov rcx, 2454267027
+	imul rax, rcx
+	sar rax, 34
+	mov rcx, rax
+	shr rcx, 63
+	add rax, rcx
+	cmp eax, -306783378
+	jne __shivyc_label16
+	movsx rax, DWORD PTR [neg]
+	mov rcx, 2454267027
+	imul rax, rcx
+	sar rax, 34
+	mov rcx, rax
+	shr rcx, 63
+	add rax, rcx
+	imul eax, 7
+	neg eax
+	add eax, DWORD PTR [neg]
+	cmp eax, -2
+	je __shivyc_label15
+__shivyc_label16:
+	mov eax, 9
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label15:
+	movsx rax, DWORD PTR [pos]
+	imul rax, 1717986919
+	sar rax, 34
+	mov rcx, rax
+	shr rcx, 63
+	add rax, rcx
+	cmp eax, 214748364
+	jne __shivyc_label18
+	movsx rax, DWORD PTR [pos]
+	imul rax, 1717986919
+	sar rax, 34
+	mov rcx, rax
+	shr rcx, 63
+	add rax, rcx
+	imul eax, 10
+	neg eax
+	add eax, DWORD PTR [pos]
+	cmp eax, 7
+	je __shivyc_label17
+__shivyc_label18:
+	mov eax, 10
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label17:
+	mov eax, DWORD PTR [umax]
+	mov rcx, 613566757
+	imul rcx, rax
+	shr rcx, 32
+	add rax, rcx
+	shr rax, 3
+	cmp eax, 613566756
+	jne __shivyc_label20
+	mov eax, DWORD PTR [umax]
+	mov rcx, 613566757
+	imul rcx, rax
+	shr rcx, 32
+	add rax, rcx
+	shr rax, 3
+	imul eax, 7
+	neg eax
+	add eax, DWORD PTR [umax]
+	cmp eax, 3
+	je __shivyc_label19
+__shivyc_label20:
+	mov eax, 11
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label19:
+	mov eax, DWORD PTR [umax]
+	mov rcx, 3435973837
+	imul rax, rcx
+	shr rax, 35
+	cmp eax, 429496729
+	jne __shivyc_label22
+	mov eax, DWORD PTR [umax]
+	mov rcx, 3435973837
+	imul rax, rcx
+	shr rax, 35
+	imul eax, 10
+	neg eax
+	add eax, DWORD PTR [umax]
+	cmp eax, 5
+	je __shivyc_label21
+__shivyc_label22:
+	mov eax, 12
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label21:
+	mov rax, 2361183241434822607
+	imul QWORD PTR [lpos]
+	sar rdx, 7
+	mov rax, rdx
+	shr rax, 63
+	add rdx, rax
+	mov rax, 1234567890123456
+	cmp rdx, rax
+	jne __shivyc_label24
+	mov rax, 2361183241434822607
+	imul QWORD PTR [lpos]
+	sar rdx, 7
+	mov rax, rdx
+	shr rax, 63
+	add rdx, rax
+	imul rdx, 1000
+	neg rdx
+	add rdx, QWORD PTR [lpos]
+	cmp rdx, 789
+	je __shivyc_label23
+__shivyc_label24:
+	mov eax, 13
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label23:
+	mov rax, 5270498306774157605
+	imul QWORD PTR [lneg]
+	sar rdx, 1
+	mov rax, rdx
+	shr rax, 63
+	add rdx, rax
+	mov rax, -1317624576693539401
+	cmp rdx, rax
+	jne __shivyc_label26
+	mov rax, 5270498306774157605
+	imul QWORD PTR [lneg]
+	sar rdx, 1
+	mov rax, rdx
+	shr rax, 63
+	add rdx, rax
+	imul rdx, 7
+	neg rdx
+	add rdx, QWORD PTR [lneg]
+	cmp rdx, -1
+	je __shivyc_label25
+__shivyc_label26:
+	mov eax, 14
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label25:
+	mov rax, 2635249153387078803
+	mul QWORD PTR [lumax]
+	mov rax, QWORD PTR [lumax]
+	sub rax, rdx
+	shr rax, 1
+	add rax, rdx
+	shr rax, 2
+	mov rdx, rax
+	mov rax, 2635249153387078802
+	cmp rdx, rax
+	jne __shivyc_label28
+	mov rax, 2635249153387078803
+	mul QWORD PTR [lumax]
+	mov rax, QWORD PTR [lumax]
+	sub rax, rdx
+	shr rax, 1
+	add rax, rdx
+	shr rax, 2
+	imul rax, 7
+	neg rax
+	add rax, QWORD PTR [lumax]
+	mov rdx, rax
+	cmp rdx, 1
+	je __shivyc_label27
+__shivyc_label28:
+	mov eax, 15
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label27:
+	mov rax, -3689348814741910323
+	mul QWORD PTR [lumax]
+	shr rdx, 3
+	mov rax, 1844674407370955161
+	cmp rdx, rax
+	jne __shivyc_label30
+	mov rax, -3689348814741910323
+	mul QWORD PTR [lumax]
+	shr rdx, 3
+	imul rdx, 10
+	neg rdx
+	add rdx, QWORD PTR [lumax]
+	cmp rdx, 5
+	je __shivyc_label29
+__shivyc_label30:
+	mov eax, 16
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label29:
+	mov eax, DWORD PTR [small]
+	neg eax
+	cmp eax, 37
+	jne __shivyc_label32
+	mov eax, DWORD PTR [small]
+	mov eax, 0
+	cmp eax, 0
+	jne __shivyc_label32
+	mov eax, DWORD PTR [small]
+	mov eax, 0
+	cmp eax, 0
+	je __shivyc_label31
+__shivyc_label32:
+	mov eax, 17
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label31:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
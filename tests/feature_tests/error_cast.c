@@ -21,4 +21,10 @@ int main() {
 
   // error: storage specifier not permitted here
   (static int) a;
+
+  // error: cannot cast between pointer and floating type
+  (double) a;
+
+  // error: cannot cast between pointer and floating type
+  (int*) 1.0;
 }
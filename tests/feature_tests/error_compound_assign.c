@@ -37,4 +37,17 @@ int main() {
   v += 1;
   // error: invalid arithmetic on pointer to incomplete type
   v -= 1;
+
+  // error: invalid types for '&=' operator
+  p &= a;
+  // error: expression on left of '|=' is not assignable
+  10 |= a;
+  // error: invalid types for '^=' operator
+  a ^= q;
+
+  double d;
+  // error: invalid types for '%=' operator
+  d %= 2;
+  // error: invalid types for '&=' operator
+  a &= d;
 }
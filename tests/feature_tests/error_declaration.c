@@ -22,6 +22,9 @@ int var1;
 // error: redeclared 'var1' with different linkage
 static int var1;
 
+// error: 'inline' specifier on declaration of non-function
+inline int var2;
+
 int main() {
   // error: variable of incomplete type declared
   void a;
@@ -8,6 +8,8 @@ struct S incomplete_return();
 
 int main() {
   int a;
+  double d;
+  const int c = 0;
 
   // error: called object is not a function pointer
   a();
@@ -29,5 +31,32 @@ int main() {
   // error: function returns non-void incomplete type
   incomplete_return();
 
+  // error: incorrect number of arguments for function call (expected 2, have 1)
+  __builtin_expect(a);
+
+  // error: second argument of '__builtin_expect' must be an integer constant
+  if(__builtin_expect(a, a)) return 1;
+
+  // error: second argument of '__builtin_expect' must be an integer constant
+  __builtin_expect(a, "x");
+
+  // error: incorrect number of arguments for function call (expected 1 to 3, have 0)
+  __builtin_prefetch();
+
+  // error: third argument of '__builtin_prefetch' must be an integer constant from 0 to 3
+  __builtin_prefetch(&a, 0, 4);
+
+  // error: second argument of '__builtin_prefetch' must be an integer constant from 0 to 1
+  __builtin_prefetch(&a, a);
+
+  // error: second argument of '__builtin_nontemporal_store' must have pointer type
+  __builtin_nontemporal_store(1, a);
+
+  // error: second argument of '__builtin_nontemporal_store' must point to an integer or pointer
+  __builtin_nontemporal_store(1.0, &d);
+
+  // error: second argument of '__builtin_nontemporal_store' points to a const object
+  __builtin_nontemporal_store(1, &c);
+
   return 0;
 }
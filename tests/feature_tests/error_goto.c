@@ -0,0 +1,17 @@
+// error: label address outside of a function
+void* outside = &&nowhere;
+
+int main() {
+  // error: use of undeclared label 'nowhere'
+  goto nowhere;
+
+  int a = 1;
+here:
+  a = 2;
+  // error: redefinition of label 'here'
+here:
+  a = 3;
+
+  // error: operand of computed goto must have pointer type
+  goto *a;
+}
@@ -5,4 +5,16 @@ int f() {
 // error: non-constant initializer for variable with static storage duration
 int a = f();
 
+// error: excess elements in initializer
+int b[2] = {1, 2, 3};
+
+// error: initializer-string for char array is too long
+char c[2] = "abc";
+
+// error: scalar initializer must have one element
+int d = {1, 2};
+
+// error: non-constant initializer for variable with static storage duration
+int e[2] = {1, f()};
+
 int main() { }
@@ -0,0 +1,40 @@
+int main() {
+  int a, b;
+  double d;
+  const int c = 0;
+
+  // error: output operand constraint lacks '='
+  asm ("" : "r" (a));
+  // error: input operand constraint contains '='
+  asm ("" :: "=r" (a));
+  // error: unsupported constraint 'x' in 'asm'
+  asm ("" : "=x" (a));
+  // error: empty constraint in 'asm'
+  asm ("" :: "" (a));
+  // error: register operand of 'asm' must have integer or pointer type
+  asm ("" : "=r" (d));
+  // error: output operand of 'asm' is not assignable
+  asm ("" : "=r" (c));
+  // error: impossible constraint in 'asm'
+  asm ("" :: "i" (a));
+  // error: memory input of 'asm' is not an lvalue
+  asm ("" :: "m" (a + 1));
+  // error: matching constraint references invalid operand number
+  asm ("" :: "1" (a));
+  // error: matching constraint references invalid operand number
+  asm ("" : "=r" (a) : "0" (b), "0" (b));
+  // error: matching constraint not valid in output operand
+  asm ("" : "=0" (a));
+  // error: unknown register name 'foo' in 'asm'
+  asm ("" ::: "foo");
+  // error: operand number out of range in 'asm'
+  asm ("%1" : "=r" (a));
+  // error: undefined named operand 'x' in 'asm'
+  asm ("%[x]" : "=r" (a));
+  // error: invalid operand modifier 'y' in 'asm'
+  asm ("%y0" : "=r" (a));
+  // error: operand number missing after % in 'asm'
+  asm ("%" : "=r" (a));
+
+  asm ("nop" : "=r" (a) : "r" (b) : "cc", "memory");
+}
@@ -0,0 +1,9 @@
+// Tests errors of the assembler in the instructions of an asm statement.
+
+int main() {
+  int a = 1;
+  asm ("addl $1, %0" : "+r" (a));
+  // error: assembler error in 'asm': no such instruction: `frob'
+  asm ("frob");
+  return a;
+}
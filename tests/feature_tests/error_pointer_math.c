@@ -24,6 +24,15 @@ int main() {
   // error: invalid operand types for bitwise shift
   int* c; c << 3;
 
+  // error: invalid operand types for modulus
+  1.5 % 2;
+
+  // error: invalid operand types for bitwise shift
+  2.0 << 1;
+
+  // error: invalid operand types for addition
+  a + 1.5;
+
   void *p, *q;
   // error: invalid arithmetic on pointer to incomplete type
   p + 1;
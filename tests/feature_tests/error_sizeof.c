@@ -12,4 +12,10 @@ int main() {
 
   // error: sizeof argument cannot have function type
   sizeof(main);
+
+  // error: _Alignof argument cannot have incomplete type
+  _Alignof(struct S);
+
+  // error: _Alignof argument cannot have function type
+  _Alignof(int(void));
 }
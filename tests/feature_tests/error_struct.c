@@ -91,7 +91,7 @@ int main() {
   struct E e;
 
   // error: request for member in something not a structure or union
-  10.a;
+  (10).a;
 
   // error: request for member in something not a structure or union
   s_p.a;
@@ -0,0 +1,24 @@
+int main() {
+  int a = 1;
+
+  // error: case label not in switch statement
+  case 1: a = 2;
+
+  // error: default label not in switch statement
+  default: a = 3;
+
+  switch(a) {
+    case 1: break;
+    // error: duplicate case value 1
+    case 1: break;
+    default: break;
+    // error: multiple default labels in one switch
+    default: break;
+    // error: case label must be an integral constant expression
+    case a: break;
+  }
+
+  int* p = &a;
+  // error: switch statement requires expression of integral type
+  switch(p) { }
+}
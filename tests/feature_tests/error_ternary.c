@@ -0,0 +1,18 @@
+int main() {
+  struct A {} a;
+  struct B {} b;
+  int* p;
+  long* q;
+
+  // error: '?:' operator requires scalar condition
+  a ? 1 : 2;
+
+  // error: type mismatch in conditional expression
+  1 ? a : b;
+
+  // error: type mismatch in conditional expression
+  1 ? 3 : a;
+
+  // error: pointer type mismatch in conditional expression
+  1 ? p : q;
+}
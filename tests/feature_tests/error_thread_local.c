@@ -0,0 +1,26 @@
+// error: '_Thread_local' on declaration of function
+_Thread_local int func();
+
+// error: '_Thread_local' may only be combined with 'static' or 'extern'
+typedef __thread int tls_int;
+
+_Thread_local int a;
+// error: non-thread-local declaration of 'a' follows thread-local declaration
+extern int a;
+
+int b;
+// error: thread-local declaration of 'b' follows non-thread-local declaration
+extern __thread int b;
+
+// error: storage class specified for function parameter
+int param(_Thread_local int c);
+
+int main() {
+  // error: local variable declared '_Thread_local' must be 'static' or 'extern'
+  _Thread_local int d;
+  // error: '_Thread_local' may only be combined with 'static' or 'extern'
+  auto __thread int e;
+
+  static _Thread_local int f;
+  extern __thread int g;
+}
@@ -42,4 +42,19 @@ int main() {
   // error: conversion from incompatible pointer type
   struct A* ptr_X = &X;
   struct A* ptr_Y = &Y;
+
+  /////////////////////////////////////////////////////
+
+  volatile int v;
+  int i;
+  int *restrict r1 = &i;
+  volatile int *r2 = &v;
+  // error: conversion from incompatible pointer type
+  int *r3 = r2;
+
+  // error: invalid use of 'restrict'
+  restrict int r4;
+  int *restrict *r5;
+  // error: invalid use of 'restrict'
+  int restrict *r6;
 }
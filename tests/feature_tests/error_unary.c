@@ -7,4 +7,7 @@ int main() {
 
   // error: bit-complement requires integral type operand
   ~"";
+
+  // error: bit-complement requires integral type operand
+  ~1.5;
 }
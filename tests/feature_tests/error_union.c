@@ -96,7 +96,7 @@ int main() {
   } s, *s_p;
 
   // error: request for member in something not a structure or union
-  10.a;
+  (10).a;
 
   // error: request for member in something not a structure or union
   s_p.a;
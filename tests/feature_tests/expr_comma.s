@@ -0,0 +1,28 @@
+	.intel_syntax noprefix
+	.section .text
+	.global main
+main:
+	push rbp
+	mov rbp, rsp
+	sub rsp, 16
+	mov DWORD PTR [rbp-4], 5
+	lea rax, [rbp-4]
+	cmp DWORD PTR [rbp-4], 5
+	je __shivyc_label1
+	mov eax, 1
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label1:
+	cmp rax, rax
+	je __shivyc_label2
+	mov eax, 2
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label2:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
@@ -0,0 +1,119 @@
+// Return: 0
+
+// Floating types are computed in SSE registers, passed in them to and from
+// functions, and passed to variadic functions with the number of SSE
+// registers used in AL.
+
+int snprintf();
+int strcmp(char*, char*);
+double strtod(char*, char**);
+
+struct pair { float x, y; };
+struct mixed { double d; long l; };
+
+double scale = 2.5;
+float halves[3] = {0.5f, 1.5, 2};
+double neg_zero = -0.0;
+struct mixed init_mixed = {1.25, 7};
+
+double add(double a, double b) { return a + b; }
+float addf(float a, float b) { return a + b; }
+
+double sum_many(double a, int i, double b, float c, double d, double e,
+                double f, double g, double h, double k, long j, double m) {
+  return a + i + b + c + d + e + f + g + h + k + j + m;
+}
+
+struct pair swap(struct pair p) {
+  struct pair q;
+  q.x = p.y;
+  q.y = p.x;
+  return q;
+}
+
+struct mixed twice(struct mixed m) {
+  m.d *= 2;
+  m.l *= 2;
+  return m;
+}
+
+double poly(double x) {
+  double result = 0;
+  for(int i = 0; i < 4; i++) result = result * x + (i + 1);
+  return result;
+}
+
+int main() {
+  double a = 1.5, b = 0.25;
+  float f = 3;
+
+  if(a + b != 1.75) return 1;
+  if(a - b != 1.25) return 2;
+  if(a * b != 0.375) return 3;
+  if(a / b != 6) return 4;
+  if(-a != -1.5) return 5;
+  if(f / 2 != 1.5f) return 6;
+  if(add(a, b) != 1.75 || addf(f, 0.5f) != 3.5f) return 7;
+
+  // Comparisons, and a NaN, which compares unequal to everything.
+  double zero = 0, nan = zero / zero;
+  if(!(a > b) || a < b || !(b <= a) || b >= a) return 8;
+  if(nan == nan || !(nan != nan)) return 9;
+  if(nan < 1 || nan > 1 || nan <= 1 || nan >= 1) return 10;
+  if(!nan || !(a ? 1 : 0) || (zero ? 1 : 0)) return 11;
+  if(neg_zero != 0 || 1 / neg_zero > 0) return 12;
+
+  // Conversions
+  int i = -2.75;
+  unsigned u = 4000000000.0;
+  unsigned long ul = 12345678901234567890.0;
+  char c = 65.9;
+  _Bool bl = 0.1;
+  if(i != -2 || u != 4000000000 || c != 65 || bl != 1) return 13;
+  if(ul / 1000000 != 12345678901234) return 14;
+  unsigned long big = -1;
+  if((double)big != 18446744073709551616.0) return 15;
+  if((float)u != 4000000000.0f || (double)(unsigned char)200 != 200) return 16;
+  if((double)-3 != -3 || (float)(long)-5 != -5) return 17;
+  if((double)(float)0.1 == 0.1) return 18;
+
+  // Compound assignment, increment, and integer operands
+  double d = 1;
+  d += 2;
+  d *= 3;
+  d -= 1;
+  d /= 4;
+  d++;
+  ++d;
+  d--;
+  if(d != 3) return 19;
+  int n = 7;
+  n *= 1.5;
+  n += 0.9;
+  if(n != 10) return 20;
+
+  // Calls with floating arguments on the stack, and structs
+  if(sum_many(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12) != 78) return 21;
+  struct pair p = {1.5f, 2.5f};
+  struct pair q;
+  q = swap(p);
+  if(q.x != 2.5f || q.y != 1.5f) return 22;
+  struct mixed m;
+  m = twice(init_mixed);
+  if(m.d != 2.5 || m.l != 14) return 23;
+
+  // Static initializers and arrays
+  if(scale != 2.5 || halves[0] + halves[1] + halves[2] != 4) return 24;
+  double arr[5];
+  for(int k = 0; k < 5; k++) arr[k] = k * scale;
+  if(arr[4] != 10) return 25;
+  if(poly(2) != 26) return 26;
+
+  // Library functions with floating arguments and results
+  char buf[32];
+  snprintf(buf, 32, "%.2f %d %.1f", a, 3, f);
+  if(strcmp(buf, "1.50 3 3.0")) return 27;
+  if(strtod("2.5e2", 0) != 250) return 28;
+
+  return 0;
+}
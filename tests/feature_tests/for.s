@@ -0,0 +1,121 @@
+	.intel_syntax noprefix
+	.section .text
+	.global main
+main:
+	push rbp
+	mov rbp, rsp
+	push rbx
+	sub rsp, 8
+	mov ecx, 0
+	mov eax, 0
+__shivyc_label1:
+	cmp eax, 10
+	je __shivyc_label3
+	add ecx, eax
+	add eax, 1
+	jmp __shivyc_label1
+__shivyc_label3:
+	cmp ecx, 45
+	je __shivyc_label4
+	mov eax, 1
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label4:
+	mov ecx, 0
+	mov eax, 20
+__shivyc_label5:
+	mov edx, 0
+	cmp eax, 80
+	je __shivyc_label7
+	mov edx, 1
+	add ecx, eax
+	sal eax, 1
+	jmp __shivyc_label5
+__shivyc_label7:
+	cmp edx, 0
+	je __shivyc_label8
+	mov eax, 2
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label8:
+	cmp ecx, 60
+	je __shivyc_label9
+	mov eax, 3
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label9:
+	mov ecx, 0
+__shivyc_label10:
+	mov edx, 0
+	cmp eax, 100
+	je __shivyc_label12
+	mov edx, 1
+	add ecx, eax
+	add eax, 1
+	jmp __shivyc_label10
+__shivyc_label12:
+	cmp edx, 0
+	je __shivyc_label13
+	mov eax, 4
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label13:
+	cmp ecx, 1790
+	je __shivyc_label14
+	mov eax, 5
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label14:
+	mov ecx, 0
+__shivyc_label15:
+	mov edx, 0
+	cmp eax, 110
+	je __shivyc_label17
+	mov edx, 1
+	add ecx, eax
+	add eax, 1
+	jmp __shivyc_label15
+__shivyc_label17:
+	cmp edx, 0
+	je __shivyc_label18
+	mov eax, 6
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label18:
+	cmp ecx, 1045
+	je __shivyc_label19
+	mov eax, 7
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label19:
+	mov ebx, 0
+__shivyc_label20:
+	add ebx, 1
+	cmp ebx, 10
+	jne __shivyc_label23
+	lea rax, [exit]
+	mov edi, 0
+	call rax
+__shivyc_label23:
+	cmp ebx, 0
+	jne __shivyc_label24
+	lea rax, [exit]
+	mov edi, 1
+	call rax
+__shivyc_label24:
+	jmp __shivyc_label20
+	.att_syntax noprefix
@@ -0,0 +1,205 @@
+	.intel_syntax noprefix
+	.section .rodata.str1.1,"aMS",@progbits,1
+__strlit8:
+	.asciz "hey"
+__strlit21:
+	.asciz "1"
+__strlit22:
+	.asciz "heylo"
+__strlit50:
+	.asciz "hello"
+
+	.section .text
+	.global main
+main:
+	push rbp
+	mov rbp, rsp
+	push rbx
+	push r12
+	push r13
+	push r14
+	push r15
+	sub rsp, 24
+	lea rbx, [isalpha]
+	mov edi, 65
+	call rbx
+	mov cl, 0
+	cmp eax, 0
+	je __shivyc_label20
+	mov cl, 1
+__shivyc_label20:
+	movzx ecx, cl
+	cmp ecx, 1
+	je __shivyc_label1
+	mov eax, 1
+	lea rsp, [rbp-40]
+	pop r15
+	pop r14
+	pop r13
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label1:
+	lea rax, [atoi]
+	lea rdi, [__strlit21]
+	call rax
+	mov ecx, eax
+	mov eax, 1
+	cdq
+	idiv ecx
+	cmp eax, 1
+	je __shivyc_label2
+	mov eax, 14
+	lea rsp, [rbp-40]
+	pop r15
+	pop r14
+	pop r13
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label2:
+	mov edi, 52
+	call rbx
+	mov cl, 0
+	cmp eax, 0
+	je __shivyc_label21
+	mov cl, 1
+__shivyc_label21:
+	movzx ecx, cl
+	cmp ecx, 0
+	je __shivyc_label3
+	mov eax, 2
+	lea rsp, [rbp-40]
+	pop r15
+	pop r14
+	pop r13
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label3:
+	lea rax, [div]
+	mov edi, 50
+	mov esi, 5
+	call rax
+	cmp eax, 10
+	je __shivyc_label4
+	mov eax, 3
+	lea rsp, [rbp-40]
+	pop r15
+	pop r14
+	pop r13
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label4:
+	lea r15, [strcpy]
+	lea r12, [rbp-48]
+	lea rsi, [__strlit50]
+	mov rdi, r12
+	call r15
+	lea r14, [rbp-56]
+	lea rsi, [__strlit50]
+	mov rdi, r14
+	call r15
+	lea r13, [strcmp]
+	mov rdi, r12
+	mov rsi, r14
+	call r13
+	cmp eax, 0
+	je __shivyc_label5
+	mov eax, 4
+	lea rsp, [rbp-40]
+	pop r15
+	pop r14
+	pop r13
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label5:
+	mov rdi, r12
+	mov rsi, r14
+	call r13
+	cmp eax, 0
+	je __shivyc_label6
+	mov eax, 13
+	lea rsp, [rbp-40]
+	pop r15
+	pop r14
+	pop r13
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label6:
+	mov BYTE PTR [rbp-56+1*3], 102
+	mov rdi, r12
+	mov rsi, r14
+	call r13
+	cmp eax, 6
+	je __shivyc_label7
+	mov eax, 5
+	lea rsp, [rbp-40]
+	pop r15
+	pop r14
+	pop r13
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label7:
+	lea rsi, [__strlit8]
+	mov rdi, r14
+	call r15
+	lea rax, [strncpy]
+	mov rdi, r12
+	mov rsi, r14
+	mov rdx, 3
+	call rax
+	lea rsi, [__strlit22]
+	mov rdi, r12
+	call r13
+	cmp eax, 0
+	je __shivyc_label8
+	mov eax, 6
+	lea rsp, [rbp-40]
+	pop r15
+	pop r14
+	pop r13
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label8:
+	mov edi, 5
+	call rbx
+	cmp eax, 0
+	je __shivyc_label9
+	mov eax, 12
+	lea rsp, [rbp-40]
+	pop r15
+	pop r14
+	pop r13
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label9:
+	lea rax, [signal]
+	mov rsi, rbx
+	mov edi, 0
+	call rax
+	mov eax, 0
+	lea rsp, [rbp-40]
+	pop r15
+	pop r14
+	pop r13
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+	.att_syntax noprefix
@@ -0,0 +1,307 @@
+	.intel_syntax noprefix
+	.comm helper 4
+	.section .data
+i.70:
+	.zero 4
+i.148:
+	.zero 4
+
+	.section .text
+	.global add
+	.global counter1
+	.global counter2
+	.global void_exit
+	.global void_ret
+	.global int_ret
+	.global array_sum
+	.global call_function
+	.global return_const
+	.global ptr_value
+	.global sum_array
+	.global main
+add:
+	push rbp
+	mov rbp, rsp
+	movsx rdi, edi
+	add rsi, rdi
+	mov eax, esi
+	mov rsp, rbp
+	pop rbp
+	ret
+counter1:
+	push rbp
+	mov rbp, rsp
+	mov eax, DWORD PTR [i.148]
+	mov ecx, DWORD PTR [i.148]
+	add ecx, 1
+	mov DWORD PTR [i.148], ecx
+	mov rsp, rbp
+	pop rbp
+	ret
+counter2:
+	push rbp
+	mov rbp, rsp
+	mov eax, DWORD PTR [i.70]
+	mov ecx, DWORD PTR [i.70]
+	add ecx, 1
+	mov DWORD PTR [i.70], ecx
+	mov rsp, rbp
+	pop rbp
+	ret
+void_exit:
+	push rbp
+	mov rbp, rsp
+	mov DWORD PTR [helper], 3
+	mov rsp, rbp
+	pop rbp
+	ret
+void_ret:
+	push rbp
+	mov rbp, rsp
+	mov DWORD PTR [helper], 5
+	mov rsp, rbp
+	pop rbp
+	ret
+int_ret:
+	push rbp
+	mov rbp, rsp
+	mov eax, 1
+	mov rsp, rbp
+	pop rbp
+	ret
+array_sum:
+	push rbp
+	mov rbp, rsp
+	sub rsp, 16
+	mov QWORD PTR [rbp-8], rdi
+	mov rsi, 0
+	mov rax, QWORD PTR [rbp-8]
+	lea rsi, [rax+4*rsi]
+	mov eax, 0
+	mov edx, 0
+__shivyc_label1:
+	cmp edx, 3
+	jge __shivyc_label3
+	mov ecx, DWORD PTR [rsi]
+	add eax, ecx
+	add edx, 1
+	add rsi, 4
+	jmp __shivyc_label1
+__shivyc_label3:
+	mov rsp, rbp
+	pop rbp
+	ret
+call_function:
+	push rbp
+	mov rbp, rsp
+	mov rax, rdi
+	movsx rdx, edx
+	mov edi, esi
+	mov rsi, rdx
+	mov rsp, rbp
+	pop rbp
+	jmp rax
+return_const:
+	push rbp
+	mov rbp, rsp
+	mov eax, 4
+	mov rsp, rbp
+	pop rbp
+	ret
+ptr_value:
+	push rbp
+	mov rbp, rsp
+	mov eax, DWORD PTR [rdi]
+	mov rsp, rbp
+	pop rbp
+	ret
+sum_array:
+	push rbp
+	mov rbp, rsp
+	sub rsp, 16
+	mov QWORD PTR [rbp-8], rdi
+	mov r9, 0
+	mov rax, QWORD PTR [rbp-8]
+	lea r9, [rax+8*r9]
+	mov eax, 0
+	mov r8d, 0
+__shivyc_label4:
+	cmp r8d, esi
+	jge __shivyc_label6
+	mov QWORD PTR [rbp-16], r9
+	mov rdi, 0
+	mov rcx, QWORD PTR [rbp-16]
+	lea rdi, [rcx+4*rdi]
+	mov edx, 0
+__shivyc_label7:
+	cmp edx, 2
+	jge __shivyc_label9
+	mov ecx, DWORD PTR [rdi]
+	add eax, ecx
+	add edx, 1
+	add rdi, 4
+	jmp __shivyc_label7
+__shivyc_label9:
+	add r8d, 1
+	add r9, 8
+	jmp __shivyc_label4
+__shivyc_label6:
+	mov rsp, rbp
+	pop rbp
+	ret
+main:
+	push rbp
+	mov rbp, rsp
+	sub rsp, 48
+__shivyc_label26:
+__shivyc_label10:
+	lea rax, [helper_ret_5]
+	call rax
+	movsx rax, eax
+	add rax, 4
+__shivyc_label27:
+	cmp eax, 9
+	je __shivyc_label11
+	mov eax, 2
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label11:
+	lea rax, [helper_ret_6]
+	call rax
+	movsx rax, eax
+	add rax, 5
+__shivyc_label28:
+	cmp eax, 11
+	je __shivyc_label12
+	mov eax, 3
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label12:
+	mov eax, 0
+__shivyc_label13:
+	cmp eax, 5
+	jge __shivyc_label15
+	mov edx, DWORD PTR [i.148]
+	mov ecx, DWORD PTR [i.148]
+	add ecx, 1
+	mov DWORD PTR [i.148], ecx
+__shivyc_label29:
+	cmp edx, eax
+	je __shivyc_label16
+	mov eax, 4
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label16:
+	mov edx, DWORD PTR [i.70]
+	mov ecx, DWORD PTR [i.70]
+	add ecx, 1
+	mov DWORD PTR [i.70], ecx
+__shivyc_label30:
+	cmp edx, eax
+	je __shivyc_label17
+	mov eax, 5
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label17:
+	add eax, 1
+	jmp __shivyc_label13
+__shivyc_label15:
+	mov DWORD PTR [helper], 3
+__shivyc_label31:
+	cmp DWORD PTR [helper], 3
+	je __shivyc_label18
+	mov eax, 6
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label18:
+	mov DWORD PTR [helper], 5
+__shivyc_label32:
+	cmp DWORD PTR [helper], 5
+	je __shivyc_label19
+	mov eax, 7
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label19:
+	mov DWORD PTR [rbp-16+4*0], 1
+	mov DWORD PTR [rbp-16+4*1], 2
+	mov DWORD PTR [rbp-16+4*2], 3
+	lea rax, [array_sum]
+	lea rdi, [rbp-16]
+	call rax
+	cmp eax, 6
+	je __shivyc_label20
+	mov eax, 8
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label20:
+	lea rax, [add]
+	mov edi, 5
+	mov rsi, 6
+	call rax
+__shivyc_label33:
+	cmp eax, 11
+	je __shivyc_label21
+	mov eax, 9
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label21:
+__shivyc_label34:
+	mov DWORD PTR [rbp-20], 4
+	cmp DWORD PTR [rbp-20], 4
+	je __shivyc_label22
+	mov eax, 10
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label22:
+	lea rax, [rbp-20]
+	mov ecx, DWORD PTR [rax]
+__shivyc_label35:
+	cmp ecx, 4
+	je __shivyc_label23
+	mov eax, 11
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label23:
+	mov eax, DWORD PTR [rax]
+__shivyc_label36:
+	cmp eax, 4
+	je __shivyc_label24
+	mov eax, 12
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label24:
+	lea rax, [rbp-40+8*0]
+	mov DWORD PTR [rax], 1
+	add rax, 4
+	mov DWORD PTR [rax], 1
+	lea rax, [rbp-40+8*1]
+	mov DWORD PTR [rax], 1
+	add rax, 4
+	mov DWORD PTR [rax], 1
+	lea rax, [sum_array]
+	lea rdi, [rbp-40]
+	mov esi, 2
+	call rax
+	cmp eax, 4
+	je __shivyc_label25
+	mov eax, 13
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label25:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
@@ -0,0 +1,19 @@
+	.intel_syntax noprefix
+	.section .text
+	.global helper_ret_5
+	.global helper_ret_6
+helper_ret_5:
+	push rbp
+	mov rbp, rsp
+	mov eax, 5
+	mov rsp, rbp
+	pop rbp
+	ret
+helper_ret_6:
+	push rbp
+	mov rbp, rsp
+	mov eax, 6
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
@@ -0,0 +1,111 @@
+// Goto statements jump to labels of the function, and the GNU computed
+// goto jumps to the address of a label taken with `&&label`, as in the
+// dispatch loop of an interpreter. The addresses of labels may also
+// initialize static data in their function.
+
+int sum_to(int n) {
+  int i = 0, s = 0;
+loop:
+  if (i > n) goto done;
+  s += i;
+  i++;
+  goto loop;
+done:
+  return s;
+}
+
+int forward(int x) {
+  goto skip;
+  x = 100;
+skip:
+  {
+    goto inner;
+    x = 200;
+  inner:
+    x++;
+  }
+  return x;
+}
+
+#define HALT 0
+#define INC 1
+#define DEC 2
+#define DOUBLE 3
+#define JUMP_IF 4
+
+int run(const unsigned char* code) {
+  void* ops[] = {&&op_halt, &&op_inc, &&op_dec, &&op_double, &&op_jump_if};
+  int acc = 0, count = 0;
+  const unsigned char* pc = code;
+
+  goto *ops[*pc++];
+op_inc:
+  acc++;
+  count++;
+  goto *ops[*pc++];
+op_dec:
+  acc--;
+  count++;
+  goto *ops[*pc++];
+op_double:
+  acc *= 2;
+  count++;
+  goto *ops[*pc++];
+op_jump_if:
+  // Jumps back by the next byte while acc is below 100.
+  count++;
+  if (acc < 100) pc -= *pc;
+  else pc++;
+  goto *ops[*pc++];
+op_halt:
+  return acc + count * 1000;
+}
+
+int run_static(const unsigned char* code) {
+  static void* const ops[] = {&&op_halt, &&op_inc, &&op_dec, &&op_double};
+  int acc = 0;
+  const unsigned char* pc = code;
+
+  goto *ops[*pc++];
+op_inc:
+  acc++;
+  goto *ops[*pc++];
+op_dec:
+  acc--;
+  goto *ops[*pc++];
+op_double:
+  acc *= 2;
+  goto *ops[*pc++];
+op_halt:
+  return acc;
+}
+
+int choose(int x) {
+  void* target = x ? &&yes : &&no;
+  goto *target;
+yes:
+  return 1;
+no:
+  return 2;
+}
+
+int main() {
+  if (sum_to(10) != 55) return 1;
+  if (forward(5) != 6) return 2;
+
+  unsigned char straight[] = {INC, INC, DOUBLE, DOUBLE, DEC, HALT};
+  if (run(straight) != 5007) return 3;
+
+  unsigned char loop[] = {INC, DOUBLE, JUMP_IF, 3, HALT};
+  if (run(loop) != 126 + 18000) return 4;
+
+  if (choose(1) != 1 || choose(0) != 2) return 5;
+
+  unsigned char program[] = {INC, DOUBLE, INC, DOUBLE, DEC, HALT};
+  if (run_static(program) != 5) return 7;
+  if (run_static(program + 3) != -1) return 8;
+  if (&&end == 0) return 6;
+
+end:
+  return 0;
+}
@@ -0,0 +1,95 @@
+// Return: 0
+
+// Branches which only choose between values are made into conditional
+// moves, which must pick the same values the branches did, for each size
+// and signedness of value.
+
+int max(int a, int b) {
+  int m;
+  if(a > b) m = a;
+  else m = b;
+  return m;
+}
+
+unsigned umin(unsigned a, unsigned b) {
+  if(a < b) return a;
+  return b;
+}
+
+long clamp(long x, long lo, long hi) {
+  if(x < lo) x = lo;
+  if(x > hi) x = hi;
+  return x;
+}
+
+char pick(char a, char b, int c) {
+  char r = a;
+  if(c) r = b;
+  return r;
+}
+
+short smaller(short a, short b) {
+  short r = b;
+  if(a < b) r = a;
+  return r;
+}
+
+int* choose(int* p, int* q, int n) {
+  int* r;
+  if(n == 3) r = p + 1;
+  else r = q;
+  return r;
+}
+
+int both(int a, int b) {
+  int x, y;
+  if(a) {
+    x = b + 1;
+    y = b * 2;
+  } else {
+    x = b - 1;
+    y = 7;
+  }
+  return x * 10 + y;
+}
+
+int nested(int a, int b) {
+  int r = 0;
+  if(a) {
+    if(b) r = 1;
+    else r = 2;
+  }
+  return r;
+}
+
+_Bool to_bool(int a) {
+  _Bool r;
+  r = a;
+  return r;
+}
+
+int main() {
+  int arr[4];
+
+  if(max(3, 9) != 9) return 1;
+  if(max(-3, -9) != -3) return 2;
+  if(umin((unsigned)-5, 5) != 5) return 3;
+  if(umin(5, (unsigned)-5) != 5) return 4;
+  if(clamp(-5, 0, 10) != 0) return 5;
+  if(clamp(50, 0, 10) != 10) return 6;
+  if(clamp(7, 0, 10) != 7) return 7;
+  if(pick(3, -4, 0) != 3) return 8;
+  if(pick(3, -4, 1) != -4) return 9;
+  if(smaller(-2, 5) != -2) return 10;
+  if(smaller(6, 5) != 5) return 11;
+  if(choose(arr, arr + 2, 3) != arr + 1) return 12;
+  if(choose(arr, arr + 2, 4) != arr + 2) return 13;
+  if(both(1, 5) != 70) return 14;
+  if(both(0, 5) != 47) return 15;
+  if(nested(0, 1) != 0) return 16;
+  if(nested(1, 1) != 1) return 17;
+  if(nested(1, 0) != 2) return 18;
+  if(to_bool(256) != 1) return 19;
+  if(to_bool(0) != 0) return 20;
+  return 0;
+}
@@ -0,0 +1,33 @@
+	.intel_syntax noprefix
+	.section .text
+	.global main
+main:
+	push rbp
+	mov rbp, rsp
+__shivyc_label1:
+__shivyc_label2:
+__shivyc_label3:
+__shivyc_label4:
+__shivyc_label5:
+__shivyc_label6:
+__shivyc_label7:
+__shivyc_label8:
+__shivyc_label9:
+__shivyc_label10:
+__shivyc_label11:
+__shivyc_label12:
+__shivyc_label13:
+__shivyc_label14:
+__shivyc_label15:
+__shivyc_label16:
+__shivyc_label17:
+__shivyc_label18:
+__shivyc_label19:
+__shivyc_label20:
+__shivyc_label21:
+__shivyc_label22:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
@@ -3,8 +3,9 @@
 
 int main() {
   char* a = "test string";
+  char b[20];
 
   // Make sure the includes in include_helper.h were successful.
   isalpha(10);
-  strcpy(a, a);
+  strcpy(b, a);
 }
@@ -0,0 +1,26 @@
+	.intel_syntax noprefix
+	.section .rodata.str1.1,"aMS",@progbits,1
+__strlit19:
+	.asciz "test string"
+
+	.section .text
+	.global main
+main:
+	push rbp
+	mov rbp, rsp
+	push rbx
+	sub rsp, 24
+	lea rbx, [__strlit19]
+	lea rax, [isalpha]
+	mov edi, 10
+	call rax
+	lea rax, [strcpy]
+	lea rdi, [rbp-32]
+	mov rsi, rbx
+	call rax
+	mov eax, 0
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+	.att_syntax noprefix
@@ -0,0 +1,44 @@
+	.intel_syntax noprefix
+	.comm f 20
+	.comm s 8
+	.comm array1 20
+	.comm array3 100
+	.comm array2 20
+	.comm array4 100
+	.comm e 40
+	.section .text
+	.global check_completed
+	.global main
+main:
+	push rbp
+	mov rbp, rsp
+	lea rax, [check_completed]
+	mov rsp, rbp
+	pop rbp
+	jmp rax
+check_completed:
+	push rbp
+	mov rbp, rsp
+	mov DWORD PTR [s], 3
+	mov DWORD PTR [s+4], 5
+	mov eax, DWORD PTR [s]
+	cmp eax, 3
+	je __shivyc_label1
+	mov eax, 1
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label1:
+	mov eax, DWORD PTR [s+4]
+	cmp eax, 5
+	je __shivyc_label2
+	mov eax, 2
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label2:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
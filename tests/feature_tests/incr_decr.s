@@ -0,0 +1,161 @@
+	.intel_syntax noprefix
+	.section .text
+	.global main
+main:
+	push rbp
+	mov rbp, rsp
+	sub rsp, 32
+	mov DWORD PTR [rbp-4], 5
+	mov eax, DWORD PTR [rbp-4]
+	sub eax, 1
+	mov DWORD PTR [rbp-4], eax
+	cmp DWORD PTR [rbp-4], 4
+	je __shivyc_label1
+	mov eax, 1
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label1:
+	mov ecx, DWORD PTR [rbp-4]
+	mov eax, DWORD PTR [rbp-4]
+	sub eax, 1
+	mov DWORD PTR [rbp-4], eax
+	cmp ecx, 4
+	je __shivyc_label2
+	mov eax, 2
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label2:
+	mov eax, DWORD PTR [rbp-4]
+	sub eax, 1
+	mov DWORD PTR [rbp-4], eax
+	cmp eax, 2
+	je __shivyc_label3
+	mov eax, 3
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label3:
+	mov eax, DWORD PTR [rbp-4]
+	add eax, 1
+	mov DWORD PTR [rbp-4], eax
+	cmp eax, 3
+	je __shivyc_label4
+	mov eax, 4
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label4:
+	mov ecx, DWORD PTR [rbp-4]
+	mov eax, DWORD PTR [rbp-4]
+	add eax, 1
+	mov DWORD PTR [rbp-4], eax
+	cmp ecx, 3
+	je __shivyc_label5
+	mov eax, 5
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label5:
+	mov DWORD PTR [rbp-4], 5
+	lea rax, [rbp-4]
+	mov ecx, DWORD PTR [rax]
+	add ecx, 1
+	mov DWORD PTR [rax], ecx
+	cmp DWORD PTR [rbp-4], 6
+	je __shivyc_label6
+	mov eax, 6
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label6:
+	mov edx, DWORD PTR [rax]
+	mov ecx, edx
+	add ecx, 1
+	mov DWORD PTR [rax], ecx
+	cmp edx, 6
+	je __shivyc_label7
+	mov eax, 7
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label7:
+	mov ecx, DWORD PTR [rax]
+	sub ecx, 1
+	mov DWORD PTR [rax], ecx
+	cmp ecx, 6
+	je __shivyc_label8
+	mov eax, 8
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label8:
+	mov DWORD PTR [rbp-24+4*0], 10
+	mov ecx, DWORD PTR [rbp-24+4*0]
+	add ecx, 1
+	mov DWORD PTR [rbp-24+4*0], ecx
+	cmp ecx, 11
+	je __shivyc_label9
+	mov eax, 9
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label9:
+	mov ecx, DWORD PTR [rbp-24+4*0]
+	cmp ecx, 11
+	je __shivyc_label10
+	mov eax, 10
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label10:
+	mov rcx, rax
+	add rcx, 4
+	cmp rax, rax
+	je __shivyc_label11
+	mov eax, 11
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label11:
+	add rcx, 4
+	mov rdx, rax
+	add rdx, 8
+	mov esi, 0
+	cmp rcx, rdx
+	je __shivyc_label12
+	mov esi, 1
+	mov eax, 12
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label12:
+	sub rcx, 4
+	cmp esi, 0
+	je __shivyc_label13
+	mov eax, 13
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label13:
+	sub rcx, 4
+	sub rax, rcx
+	neg rax
+	mov rcx, rax
+	sar rcx, 63
+	shr rcx, 62
+	add rax, rcx
+	sar rax, 2
+	cmp rax, 0
+	je __shivyc_label14
+	mov eax, 14
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label14:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
@@ -0,0 +1,55 @@
+struct T {
+  int a, b, c;
+};
+
+struct T ts[10];
+
+int sum(int* p, int n) {
+  int s = 0;
+  for(int i = 0; i < n; i++) s += p[i];
+  return s;
+}
+
+int main() {
+  int arr[10];
+  for(int i = 0; i < 10; i++) arr[i] = i;
+  if(sum(arr, 10) != 45) return 1;
+  if(sum(arr + 5, 0) != 0) return 2;
+
+  // Elements of a size which needs a multiply to index
+  for(int i = 0; i < 10; i++) ts[i].b = i * 2;
+  int s = 0;
+  for(int i = 9; i >= 0; i -= 3) s += ts[i].b;
+  if(s != 36) return 3;
+
+  // Loops with a break and a continue
+  long* lp;
+  long longs[8];
+  lp = longs;
+  for(int i = 0; i < 8; i++) lp[i] = 100 + i;
+  s = 0;
+  for(int i = 1; i < 8; i++) {
+    if(i == 2) continue;
+    if(lp[i] == 106) break;
+    s += lp[i - 1];
+  }
+  if(s != 409) return 4;
+
+  // Address used after the loop
+  int* last;
+  int j;
+  for(j = 2; j < 7; j++) last = &arr[j * 1];
+  if(*last != 6 || j != 7) return 5;
+
+  // Unsigned index which wraps around
+  unsigned char c;
+  int count = 0;
+  for(c = 250; c != 4; c++) count += arr[c % 10];
+  if(count != 21) return 6;
+
+  // Nested loops over a two-dimensional array
+  int grid[4][5];
+  for(int r = 0; r < 4; r++)
+    for(int k = 0; k < 5; k++) grid[r][k] = r * k;
+  if(grid[3][4] != 12 || grid[2][3] != 6) return 7;
+}
@@ -0,0 +1,281 @@
+	.intel_syntax noprefix
+	.comm ts 120
+	.section .text
+	.global sum
+	.global main
+sum:
+	push rbp
+	mov rbp, rsp
+	sub rsp, 16
+	mov QWORD PTR [rbp-8], rdi
+	mov rdi, 0
+	mov rax, QWORD PTR [rbp-8]
+	lea rdi, [rax+4*rdi]
+	mov eax, 0
+	mov edx, 0
+__shivyc_label1:
+	cmp edx, esi
+	jge __shivyc_label3
+	mov ecx, DWORD PTR [rdi]
+	add eax, ecx
+	add edx, 1
+	add rdi, 4
+	jmp __shivyc_label1
+__shivyc_label3:
+	mov rsp, rbp
+	pop rbp
+	ret
+main:
+	push rbp
+	mov rbp, rsp
+	push rbx
+	push r12
+	push r13
+	sub rsp, 200
+	mov eax, 0
+__shivyc_label4:
+	cmp eax, 10
+	jge __shivyc_label6
+	movsx rcx, eax
+	mov DWORD PTR [rbp-64+4*rcx], eax
+	add eax, 1
+	jmp __shivyc_label4
+__shivyc_label6:
+	lea r13, [sum]
+	lea r12, [rbp-64]
+	mov rdi, r12
+	mov esi, 10
+	call r13
+	cmp eax, 45
+	je __shivyc_label7
+	mov eax, 1
+	lea rsp, [rbp-24]
+	pop r13
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label7:
+	add r12, 20
+	mov rdi, r12
+	mov esi, 0
+	call r13
+	cmp eax, 0
+	je __shivyc_label8
+	mov eax, 2
+	lea rsp, [rbp-24]
+	pop r13
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label8:
+	mov esi, 0
+	imul esi, 2
+	mov rax, 0
+	lea rax, [rax+2*rax]
+	lea rcx, [ts+4*rax]
+	mov eax, 0
+__shivyc_label9:
+	cmp eax, 10
+	jge __shivyc_label11
+	mov rdx, rcx
+	add rdx, 4
+	mov DWORD PTR [rdx], esi
+	add eax, 1
+	add esi, 2
+	add rcx, 12
+	jmp __shivyc_label9
+__shivyc_label11:
+	mov rax, 9
+	lea rax, [rax+2*rax]
+	lea rsi, [ts+4*rax]
+	mov eax, 0
+	mov edx, 9
+__shivyc_label12:
+	cmp edx, 0
+	jl __shivyc_label14
+	mov rcx, rsi
+	add rcx, 4
+	mov ecx, DWORD PTR [rcx]
+	add eax, ecx
+	sub edx, 3
+	add rsi, -36
+	jmp __shivyc_label12
+__shivyc_label14:
+	cmp eax, 36
+	je __shivyc_label15
+	mov eax, 3
+	lea rsp, [rbp-24]
+	pop r13
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label15:
+	lea rax, [rbp-128]
+	mov QWORD PTR [rbp-136], rax
+	mov rdx, 0
+	mov rax, QWORD PTR [rbp-136]
+	lea rdx, [rax+8*rdx]
+	mov ecx, 0
+__shivyc_label16:
+	cmp ecx, 8
+	jge __shivyc_label18
+	mov eax, 100
+	add eax, ecx
+	movsx rax, eax
+	mov QWORD PTR [rdx], rax
+	add ecx, 1
+	add rdx, 8
+	jmp __shivyc_label16
+__shivyc_label18:
+	mov rdi, 1
+	mov rax, QWORD PTR [rbp-136]
+	lea rdi, [rax+8*rdi]
+	mov esi, 1
+	sub esi, 1
+	movsx rsi, esi
+	mov rax, QWORD PTR [rbp-136]
+	lea rsi, [rax+8*rsi]
+	mov eax, 0
+	mov edx, 1
+__shivyc_label19:
+	cmp edx, 8
+	jge __shivyc_label21
+	cmp edx, 2
+	jne __shivyc_label22
+	jmp __shivyc_label20
+__shivyc_label22:
+	mov rcx, QWORD PTR [rdi]
+	cmp rcx, 106
+	jne __shivyc_label23
+	jmp __shivyc_label21
+__shivyc_label23:
+	mov rcx, QWORD PTR [rsi]
+	movsx rax, eax
+	add rax, rcx
+__shivyc_label20:
+	add edx, 1
+	add rdi, 8
+	add rsi, 8
+	jmp __shivyc_label19
+__shivyc_label21:
+	cmp eax, 409
+	je __shivyc_label24
+	mov eax, 4
+	lea rsp, [rbp-24]
+	pop r13
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label24:
+	mov eax, 2
+__shivyc_label25:
+	cmp eax, 7
+	jge __shivyc_label27
+	movsx rcx, eax
+	lea rbx, [rbp-64+4*rcx]
+	add eax, 1
+	jmp __shivyc_label25
+__shivyc_label27:
+	mov ecx, DWORD PTR [rbx]
+	cmp ecx, 6
+	jne __shivyc_label29
+	cmp eax, 7
+	je __shivyc_label28
+__shivyc_label29:
+	mov eax, 5
+	lea rsp, [rbp-24]
+	pop r13
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label28:
+	mov eax, 0
+	mov dl, 250
+__shivyc_label30:
+	movzx ecx, dl
+	cmp ecx, 4
+	je __shivyc_label32
+	movsx rsi, ecx
+	imul rsi, 1717986919
+	sar rsi, 34
+	mov rdi, rsi
+	shr rdi, 63
+	add rsi, rdi
+	imul esi, 10
+	neg esi
+	add esi, ecx
+	mov ecx, esi
+	movsx rcx, ecx
+	mov ecx, DWORD PTR [rbp-64+4*rcx]
+	add eax, ecx
+	add dl, 1
+	jmp __shivyc_label30
+__shivyc_label32:
+	cmp eax, 21
+	je __shivyc_label33
+	mov eax, 6
+	lea rsp, [rbp-24]
+	pop r13
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label33:
+	mov rax, 0
+	lea rax, [rax+4*rax]
+	lea rdi, [rbp-216+4*rax]
+	mov esi, 0
+__shivyc_label34:
+	cmp esi, 4
+	jge __shivyc_label36
+	mov QWORD PTR [rbp-224], rdi
+	mov rdx, 0
+	mov rax, QWORD PTR [rbp-224]
+	lea rdx, [rax+4*rdx]
+	mov eax, 0
+__shivyc_label37:
+	cmp eax, 5
+	jge __shivyc_label39
+	mov ecx, esi
+	imul ecx, eax
+	mov DWORD PTR [rdx], ecx
+	add eax, 1
+	add rdx, 4
+	jmp __shivyc_label37
+__shivyc_label39:
+	add esi, 1
+	add rdi, 20
+	jmp __shivyc_label34
+__shivyc_label36:
+	lea rax, [rbp-216+4*15]
+	add rax, 16
+	mov eax, DWORD PTR [rax]
+	cmp eax, 12
+	jne __shivyc_label41
+	lea rax, [rbp-216+4*10]
+	add rax, 12
+	mov eax, DWORD PTR [rax]
+	cmp eax, 6
+	je __shivyc_label40
+__shivyc_label41:
+	mov eax, 7
+	lea rsp, [rbp-24]
+	pop r13
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label40:
+	mov eax, 0
+	lea rsp, [rbp-24]
+	pop r13
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+	.att_syntax noprefix
@@ -0,0 +1,60 @@
+struct P { int x; long y; char name[4]; };
+struct Q { struct P p[2]; int n; };
+union U { int i; char c[4]; };
+
+int g[5] = {1, 2, 3};
+const int primes[] = {2, 3, 5, 7, 11};
+char hello[] = "hello";
+char cut[3] = "abc";
+int mat[2][3] = {{1, 2}, {4}};
+int elided[2][2] = {1, 2, 3};
+struct P gp = {3, 4, "ab"};
+struct Q gq = {{{1, 2}, {3}}, 9};
+union U gu = {1094861636};
+char *names[] = {"one", "two", 0};
+int *ptrs[] = {&g[1], g + 4};
+
+int sum(int *a, int n) {
+  int s = 0;
+  for (int i = 0; i < n; i++) s += a[i];
+  return s;
+}
+
+int check(int v) {
+  int table[64] = {1, 2, 3, 4, 5, 6, 7, 8};
+  int zeros[100] = {0};
+  int mixed[6] = {v, 2, v + 1, 4};
+  struct P p = {v, 7, {'x', 'y'}};
+  char s[10] = "hi";
+  int small[3] = {0, v};
+  long big[40] = {1};
+  int one = {v};
+  if (sum(table, 64) != 36) return 1;
+  if (sum(zeros, 100) != 0) return 2;
+  if (mixed[0] != v || mixed[2] != v + 1) return 3;
+  if (mixed[3] != 4 || mixed[5]) return 3;
+  if (p.x != v || p.y != 7 || p.name[1] != 'y' || p.name[3]) return 4;
+  if (s[0] != 'h' || s[2] || s[9]) return 5;
+  if (small[1] != v || small[0] || small[2]) return 6;
+  if (big[0] != 1 || big[39]) return 7;
+  if (one != v) return 8;
+  return 0;
+}
+int main() {
+  if (sum(g, 5) != 6) return 10;
+  if (sizeof(primes) != 20 || primes[4] != 11) return 11;
+  if (sizeof(hello) != 6 || hello[4] != 'o') return 12;
+  if (cut[2] != 'c') return 13;
+  if (mat[0][1] != 2 || mat[1][0] != 4 || mat[1][2]) return 14;
+  if (elided[1][0] != 3 || elided[1][1]) return 15;
+  if (gp.y != 4 || gp.name[1] != 'b') return 16;
+  if (gq.p[0].y != 2 || gq.p[1].x != 3 || gq.n != 9) return 17;
+  if (gu.c[0] != 68) return 18;
+  if (names[1][1] != 'w' || names[2]) return 19;
+  if (*ptrs[0] != 2 || ptrs[1] != &g[4]) return 20;
+  for (int i = 0; i < 3; i++) {
+    int r = check(i + 5);
+    if (r) return r;
+  }
+  return 0;
+}
@@ -0,0 +1,71 @@
+static int max(int a, int b) {
+  if(a > b) return a;
+  return b;
+}
+
+static inline int clamp(int x, int lo, int hi) {
+  if(x < lo) return lo;
+  if(x > hi) return hi;
+  return x;
+}
+
+// Called through max and clamp after they are inlined
+int clamp_max(int x, int y) {
+  return clamp(max(x, y), 0, 100);
+}
+
+static int counter() {
+  // Every inlined copy shares the same static variable
+  static int count = 0;
+  return ++count;
+}
+
+static void swap(int* a, int* b) {
+  int t = *a;
+  *a = *b;
+  *b = t;
+}
+
+static int fact(int n) {
+  if(n <= 1) return 1;
+  return n * fact(n - 1);
+}
+
+static int twice(int x) {
+  int y = x;
+  int* p = &y;
+  *p += x;
+  return y;
+}
+
+static long widen(char c) { return c; }
+
+int main() {
+  if(max(3, 5) != 5) return 1;
+  if(clamp(-4, 0, 10) != 0 || clamp(40, 0, 10) != 10) return 2;
+  if(clamp_max(200, 4) != 100 || clamp_max(-1, -2) != 0) return 3;
+
+  int sum = 0;
+  for(int i = 0; i < 10; i++) sum += max(i, 10 - i);
+  if(sum != 75) return 4;
+
+  counter();
+  counter();
+  if(counter() != 3) return 5;
+
+  int a = 1, b = 2;
+  swap(&a, &b);
+  if(a != 2 || b != 1) return 6;
+
+  if(fact(5) != 120) return 7;
+
+  // Each call gets its own copy of the locals of the callee
+  if(twice(3) + twice(4) != 14) return 8;
+
+  if(widen(300) != 44) return 9;
+
+  int (*f)(int, int) = max;
+  if(f(7, 2) != 7) return 10;
+
+  return 0;
+}
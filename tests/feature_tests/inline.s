@@ -0,0 +1,222 @@
+	.intel_syntax noprefix
+	.section .data
+count.71:
+	.zero 4
+
+	.section .text
+	.global clamp_max
+	.global main
+max:
+	push rbp
+	mov rbp, rsp
+	cmp edi, esi
+	jle __shivyc_label1
+	mov eax, edi
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label1:
+	mov eax, esi
+	mov rsp, rbp
+	pop rbp
+	ret
+clamp_max:
+	push rbp
+	mov rbp, rsp
+	cmp edi, esi
+	jle __shivyc_label21
+	jmp __shivyc_label22
+__shivyc_label21:
+	mov edi, esi
+__shivyc_label22:
+	cmp edi, 0
+	jge __shivyc_label23
+	mov edi, 0
+	jmp __shivyc_label25
+__shivyc_label23:
+	cmp edi, 100
+	jle __shivyc_label24
+	mov edi, 100
+	jmp __shivyc_label25
+__shivyc_label24:
+__shivyc_label25:
+	mov eax, edi
+	mov rsp, rbp
+	pop rbp
+	ret
+fact:
+	push rbp
+	mov rbp, rsp
+	push rbx
+	sub rsp, 8
+	mov ebx, edi
+	cmp ebx, 1
+	jg __shivyc_label4
+	mov eax, 1
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label4:
+	lea rax, [fact]
+	mov edi, ebx
+	sub edi, 1
+	call rax
+	imul ebx, eax
+	mov eax, ebx
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+main:
+	push rbp
+	mov rbp, rsp
+	push rbx
+	sub rsp, 24
+__shivyc_label26:
+__shivyc_label27:
+__shivyc_label5:
+__shivyc_label30:
+__shivyc_label31:
+__shivyc_label33:
+__shivyc_label6:
+	lea rbx, [clamp_max]
+	mov edi, 200
+	mov esi, 4
+	call rbx
+	cmp eax, 100
+	jne __shivyc_label9
+	mov edi, -1
+	mov esi, -2
+	call rbx
+	cmp eax, 0
+	je __shivyc_label8
+__shivyc_label9:
+	mov eax, 3
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label8:
+	mov eax, 0
+	mov edx, 0
+__shivyc_label10:
+	cmp edx, 10
+	jge __shivyc_label12
+	mov ecx, 10
+	sub ecx, edx
+	cmp edx, ecx
+	jle __shivyc_label34
+	mov ecx, edx
+	jmp __shivyc_label35
+__shivyc_label34:
+__shivyc_label35:
+	add eax, ecx
+	add edx, 1
+	jmp __shivyc_label10
+__shivyc_label12:
+	cmp eax, 75
+	je __shivyc_label13
+	mov eax, 4
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label13:
+	mov eax, DWORD PTR [count.71]
+	add eax, 1
+	mov DWORD PTR [count.71], eax
+__shivyc_label36:
+	mov eax, DWORD PTR [count.71]
+	add eax, 1
+	mov DWORD PTR [count.71], eax
+__shivyc_label37:
+	mov eax, DWORD PTR [count.71]
+	add eax, 1
+	mov DWORD PTR [count.71], eax
+__shivyc_label38:
+	cmp eax, 3
+	je __shivyc_label14
+	mov eax, 5
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label14:
+	mov DWORD PTR [rbp-12], 1
+	mov DWORD PTR [rbp-16], 2
+	lea rsi, [rbp-12]
+	lea rdx, [rbp-16]
+	mov ecx, DWORD PTR [rsi]
+	mov eax, DWORD PTR [rdx]
+	mov DWORD PTR [rsi], eax
+	mov DWORD PTR [rdx], ecx
+__shivyc_label39:
+	cmp DWORD PTR [rbp-12], 2
+	jne __shivyc_label16
+	cmp DWORD PTR [rbp-16], 1
+	je __shivyc_label15
+__shivyc_label16:
+	mov eax, 6
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label15:
+__shivyc_label40:
+	lea rax, [fact]
+	mov edi, 4
+	call rax
+	lea rax, [rax+4*rax]
+__shivyc_label41:
+	cmp eax, 120
+	je __shivyc_label17
+	mov eax, 7
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label17:
+	mov DWORD PTR [rbp-20], 3
+	lea rcx, [rbp-20]
+	mov eax, DWORD PTR [rcx]
+	add eax, 3
+	mov DWORD PTR [rcx], eax
+	mov eax, DWORD PTR [rbp-20]
+__shivyc_label42:
+	mov DWORD PTR [rbp-24], 4
+	lea rdx, [rbp-24]
+	mov ecx, DWORD PTR [rdx]
+	add ecx, 4
+	mov DWORD PTR [rdx], ecx
+	mov ecx, DWORD PTR [rbp-24]
+__shivyc_label43:
+	add eax, ecx
+	cmp eax, 14
+	je __shivyc_label18
+	mov eax, 8
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label18:
+__shivyc_label44:
+__shivyc_label19:
+	lea rax, [max]
+	mov edi, 7
+	mov esi, 2
+	call rax
+	cmp eax, 7
+	je __shivyc_label20
+	mov eax, 10
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label20:
+	mov eax, 0
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+	.att_syntax noprefix
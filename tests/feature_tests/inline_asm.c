@@ -0,0 +1,113 @@
+// Tests GNU extended asm statements.
+
+unsigned long rdtsc() {
+  unsigned lo, hi;
+  asm volatile ("rdtsc" : "=a" (lo), "=d" (hi));
+  return (unsigned long) hi << 32 | lo;
+}
+
+unsigned cpuid_max_leaf() {
+  unsigned a, b, c, d;
+  __asm__ __volatile__ ("cpuid"
+                        : "=a" (a), "=b" (b), "=c" (c), "=d" (d)
+                        : "a" (0));
+  return a;
+}
+
+int add(int a, int b) {
+  asm ("addl %1, %0" : "+r" (a) : "r" (b));
+  return a;
+}
+
+long named(int a, long b) {
+  long out;
+  asm ("leaq (%q[a],%[b]), %[out]"
+       : [out] "=r" (out) : [a] "r" (a), [b] "r" (b));
+  return out;
+}
+
+int square(int x) {
+  int y;
+  asm ("imull %0, %0" : "=r" (y) : "0" (x));
+  return y;
+}
+
+int sum_to(int n) {
+  int r;
+  asm ("xorl %0, %0\n"
+       "1%=:\n\t"
+       "addl %1, %0\n\t"
+       "decl %1\n\t"
+       "jnz 1%=b"
+       : "=&r" (r), "+r" (n) :: "cc");
+  return r;
+}
+
+void add_to(int *p, int v) {
+  asm ("addl %1, %0" : "+m" (*p) : "ri" (v));
+  asm ("addl %1, %0" : "+m" (*p) : "i" (100));
+}
+
+char low_byte(int x) {
+  char c;
+  asm ("movb %b1, %0" : "=r" (c) : "r" (x));
+  return c;
+}
+
+int clobbers(int x) {
+  asm volatile ("movq $7, %%rbx\n\tmovq $9, %%r12\n\tmovq $0, %%rdi"
+                ::: "rbx", "r12", "rdi", "memory");
+  return x + 1;
+}
+
+int dialect(int x) {
+  asm ("{addl $1, %0|add %0, 1}" : "+r" (x));
+  return x;
+}
+
+int offset(int x) {
+  int y;
+  asm ("leal %c2(%q1), %0" : "=r" (y) : "r" (x), "i" (5));
+  return y;
+}
+
+int percent() {
+  int x = 6;
+  asm ("movl $100 %% 7, %0" : "=r" (x));
+  return x;
+}
+
+int main() {
+  unsigned long t1 = rdtsc(), t2 = rdtsc();
+  if (t2 < t1) return 1;
+  if (cpuid_max_leaf() == 0) return 2;
+  if (add(3, 4) != 7) return 3;
+  if (named(30, 12) != 42) return 4;
+  if (square(9) != 81) return 5;
+  if (sum_to(4) != 10) return 6;
+
+  int m = 10;
+  add_to(&m, 5);
+  if (m != 115) return 7;
+
+  if (low_byte(321) != 65) return 8;
+  if (clobbers(5) != 6) return 9;
+  if (dialect(1) != 2) return 10;
+  if (percent() != 2) return 11;
+  if (offset(37) != 42) return 14;
+
+  // A loop keeps its values live across an asm which clobbers registers.
+  int total = 0;
+  for (int i = 0; i < 10; i++) {
+    asm ("" ::: "rax", "rcx", "rdx", "rsi", "rdi", "r8", "r9", "r10", "r11");
+    total += add(i, 1);
+  }
+  if (total != 55) return 12;
+
+  // The value an asm reads through memory is stored first.
+  int cell = 3, copy;
+  asm ("movl %1, %0" : "=r" (copy) : "m" (cell));
+  if (copy != 3) return 13;
+
+  return 0;
+}
@@ -0,0 +1,60 @@
+// Test calls to functions summarized earlier in the file.
+
+int table[8];
+int counter;
+
+// Pure: reads the table, but writes nothing outside.
+int total(int n) {
+  int s = 0;
+  for (int i = 0; i < n; i++) s += table[i];
+  return s;
+}
+
+// Const: depends only on its arguments.
+int mix(int a, int b) {
+  int r = 0;
+  for (int i = 0; i < b; i++) r = r * 3 + a + i;
+  return r;
+}
+
+// Writes through its argument.
+void fill(int* p, int n, int v) {
+  for (int i = 0; i < n; i++) p[i] = v;
+}
+
+// Writes a global, and its result is not used.
+int tick(int n) {
+  for (int i = 0; i < n; i++) counter++;
+  return counter;
+}
+
+int fact(int n) {
+  if (n < 2) return 1;
+  return n * fact(n - 1);
+}
+
+int main() {
+  fill(table, 8, 2);
+  int t1 = total(8);
+  table[3] = 10;
+  int t2 = total(8);
+  if (t1 != 16 || t2 != 24) return 1;
+
+  int a = 5, b = 6, c = 7, d = 8;
+  int m = 0;
+  for (int i = 0; i < 4; i++) m += mix(a, 3) + i;
+  if (m != mix(5, 3) * 4 + 6) return 2;
+  if (a + b + c + d != 26) return 3;
+
+  tick(5);
+  tick(2);
+  if (counter != 7) return 4;
+
+  int local[4];
+  fill(local, 4, 9);
+  if (local[0] + local[3] != 18) return 5;
+
+  if (fact(5) != 120) return 6;
+  if (total(8) + mix(1, 2) != 24 + mix(1, 2)) return 7;
+  return 0;
+}
@@ -0,0 +1,54 @@
+struct P {
+  int x;
+  int y;
+};
+
+struct P pts[10];
+int buf[16];
+int global = 3;
+
+int bump(int a) {
+  global++;
+  return a;
+}
+
+int main() {
+  int k = 2, sum = 0;
+
+  // The address of pts[k] and the value of global do not change
+  for(int i = 0; i < 10; i++) {
+    pts[i].x = i * global;
+    pts[i].y = k * 7 + global;
+  }
+  if(pts[9].x != 27 || pts[4].y != 17) return 1;
+
+  // Stores to another object do not change pts[k].x
+  for(int i = 0; i < 16; i++) buf[i] = pts[k].x + i;
+  if(buf[15] != 21) return 2;
+
+  // A call may change global on every iteration
+  for(int i = 0; i < 3; i++) sum += bump(global);
+  if(sum != 12 || global != 6) return 3;
+
+  // Stores through a pointer to the variable being read
+  int loc = 1;
+  int* p = &loc;
+  sum = 0;
+  for(int i = 0; i < 4; i++) {
+    sum += loc;
+    *p = *p + 1;
+  }
+  if(sum != 10 || loc != 5) return 4;
+
+  // Division is not moved out of a branch which never runs
+  int zero = k - 2, d = 0;
+  for(int i = 0; i < 3; i++) {
+    if(i > 5) d += 10 / zero;
+  }
+  if(d != 0) return 5;
+
+  // Loops which never run
+  int n = 0;
+  while(n > 0) sum += buf[k] * 100;
+  if(sum != 10) return 6;
+}
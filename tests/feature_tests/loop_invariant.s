@@ -0,0 +1,167 @@
+	.intel_syntax noprefix
+	.comm buf 64
+	.comm pts 80
+	.section .data
+global:
+	.int 3
+
+	.section .text
+	.global global
+	.global bump
+	.global main
+bump:
+	push rbp
+	mov rbp, rsp
+	mov eax, DWORD PTR [global]
+	add eax, 1
+	mov DWORD PTR [global], eax
+	mov eax, edi
+	mov rsp, rbp
+	pop rbp
+	ret
+main:
+	push rbp
+	mov rbp, rsp
+	sub rsp, 16
+	mov edi, 14
+	add edi, DWORD PTR [global]
+	mov edx, 0
+__shivyc_label1:
+	cmp edx, 10
+	jge __shivyc_label3
+	mov esi, edx
+	imul esi, DWORD PTR [global]
+	movsx rax, edx
+	lea rax, [pts+8*rax]
+	mov rcx, rax
+	add rcx, 0
+	mov DWORD PTR [rcx], esi
+	add rax, 4
+	mov DWORD PTR [rax], edi
+	add edx, 1
+	jmp __shivyc_label1
+__shivyc_label3:
+	lea rax, [pts+8*9]
+	add rax, 0
+	mov eax, DWORD PTR [rax]
+	cmp eax, 27
+	jne __shivyc_label5
+	lea rax, [pts+8*4]
+	add rax, 4
+	mov eax, DWORD PTR [rax]
+	cmp eax, 17
+	je __shivyc_label4
+__shivyc_label5:
+	mov eax, 1
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label4:
+	lea rax, [pts+8*2]
+	add rax, 0
+	mov esi, DWORD PTR [rax]
+	mov eax, 0
+__shivyc_label6:
+	cmp eax, 16
+	jge __shivyc_label8
+	mov edx, esi
+	add edx, eax
+	movsx rcx, eax
+	mov DWORD PTR [buf+4*rcx], edx
+	add eax, 1
+	jmp __shivyc_label6
+__shivyc_label8:
+	mov eax, DWORD PTR [buf+4*15]
+	cmp eax, 21
+	je __shivyc_label9
+	mov eax, 2
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label9:
+	mov eax, 0
+	mov edx, 0
+__shivyc_label10:
+	cmp edx, 3
+	jge __shivyc_label12
+	mov ecx, DWORD PTR [global]
+	mov esi, DWORD PTR [global]
+	add esi, 1
+	mov DWORD PTR [global], esi
+__shivyc_label28:
+	add eax, ecx
+	add edx, 1
+	jmp __shivyc_label10
+__shivyc_label12:
+	cmp eax, 12
+	jne __shivyc_label14
+	cmp DWORD PTR [global], 6
+	je __shivyc_label13
+__shivyc_label14:
+	mov eax, 3
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label13:
+	mov DWORD PTR [rbp-4], 1
+	lea rsi, [rbp-4]
+	mov edx, 0
+	mov ecx, 0
+__shivyc_label15:
+	cmp ecx, 4
+	jge __shivyc_label17
+	add edx, DWORD PTR [rbp-4]
+	mov eax, DWORD PTR [rsi]
+	add eax, 1
+	mov DWORD PTR [rsi], eax
+	add ecx, 1
+	jmp __shivyc_label15
+__shivyc_label17:
+	mov edi, 1
+	cmp edx, 10
+	jne __shivyc_label19
+	mov edi, 0
+	cmp DWORD PTR [rbp-4], 5
+	je __shivyc_label18
+__shivyc_label19:
+	mov eax, 4
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label18:
+	mov ecx, 0
+	mov esi, 0
+__shivyc_label20:
+	cmp esi, 3
+	jge __shivyc_label22
+	cmp esi, 5
+	jle __shivyc_label23
+	mov eax, 10
+	mov r8d, 0
+	cdq
+	idiv r8d
+	add ecx, eax
+__shivyc_label23:
+	add esi, 1
+	jmp __shivyc_label20
+__shivyc_label22:
+	cmp ecx, 0
+	je __shivyc_label24
+	mov eax, 5
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label24:
+__shivyc_label26:
+	cmp edi, 0
+	je __shivyc_label27
+	mov eax, 6
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label27:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
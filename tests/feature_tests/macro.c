@@ -0,0 +1,54 @@
+#include <stdbool.h>
+
+#define TEN 10
+#define SQUARE(x) ((x) * (x))
+#define ADD(a, b) ((a) + (b))
+#define EMPTY
+#define NO_ARGS() 7
+#define STR(x) #x
+#define XSTR(x) STR(x)
+#define CAT(a, b) a ## b
+#define XCAT(a, b) CAT(a, b)
+#define FIRST(a, ...) a
+#define CALL(f, ...) f(__VA_ARGS__)
+
+// A macro is not expanded inside its own expansion.
+#define PING PONG
+#define PONG PING
+
+// The name of a function-like macro may take its arguments from the
+// tokens after the macro it was expanded from.
+#define twice(x) (2 * (x))
+#define TWICE twice
+#define TIMES(a) a * TWICE
+
+int strcmp(const char*, const char*);
+int add3(int a, int b, int c) { return a + b + c; }
+
+int CAT(glob, al) = 3;
+
+int main() {
+  int count = 2;
+  int PING = 4;
+
+  if (TEN != 10) return 1;
+  if (SQUARE(TEN + 1) != 121) return 2;
+  if (ADD(SQUARE(2), TEN) EMPTY != 14) return 3;
+  if (NO_ARGS() != 7) return 4;
+  if (strcmp(STR(a  +   b), "a + b")) return 5;
+  if (strcmp(XSTR(TEN), "10")) return 6;
+  if (strcmp(STR("q\n"), "\"q\\n\"")) return 7;
+  if (XCAT(glob, al) != 3) return 8;
+  if (FIRST(5, 6, 7) != 5) return 9;
+  if (CALL(add3, 1, 2, 3) != 6) return 10;
+#define count (count + 1)
+  if (count != 3) return 11;
+#undef count
+  if (PING != 4) return 12;
+  if (TIMES(3)(4) != 24) return 13;
+  if (!true || false) return 14;
+
+  bool b = TEN;
+  if (b != 1) return 15;
+  return 0;
+}
@@ -0,0 +1,11 @@
+	.intel_syntax noprefix
+	.section .text
+	.global main
+main:
+	push rbp
+	mov rbp, rsp
+	mov eax, 4
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
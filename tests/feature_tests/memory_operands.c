@@ -0,0 +1,14 @@
+// Return: 82
+
+// Keeps more values live than there are registers, so that some are updated
+// in place on the stack.
+int f(int n) {
+  int a = 1, b = 2, c = 3, d = 4, e = 5, g = 6, h = 7, i = 8, j = 9, k = 10,
+      l = 11, m = 12, o = 13, p = 14, q = 15, r = 16;
+  for (int t = 0; t < n; t++) {
+    a += t; b -= 1; c += 1; d = -d; e = ~e; g += a; h -= g; i++; j--;
+    k += 3; l -= 7; m += b; o = o - c; p += 1; q -= 1; r = r + r;
+  }
+  return a + b + c + d + e + g + h + i + j + k + l + m + o + p + q + r;
+}
+int main() { return f(10) % 256; }
@@ -0,0 +1,50 @@
+// Multiplying by a literal uses shifts and leas where it can, and a pointer
+// plus an integer scales the integer with the addressing mode.
+
+int three = 3, minus = -7;
+long big = 123456789012;
+unsigned int uns = 4000000000;
+
+struct pair { int a, b; };
+
+int main() {
+  if(three * 2 != 6) return 1;
+  if(three * 3 != 9) return 2;
+  if(three * 5 != 15) return 3;
+  if(three * 9 != 27) return 4;
+  if(three * 10 != 30) return 5;
+  if(three * 40 != 120) return 6;
+  if(three * 45 != 135) return 7;
+  if(three * -1 != -3) return 8;
+  if(three * -24 != -72) return 9;
+  if(minus * 12 != -84) return 10;
+  if(minus * 7 != -49) return 11;
+  if(big * 9 != 1111111101108) return 12;
+  if(big * -16 != -1975308624192) return 13;
+  if(uns * 3 != 3410065408) return 14;
+  if(uns * 8 != 1935228928) return 15;
+
+  int arr[10];
+  long larr[10];
+  struct pair pairs[5];
+  for(int i = 0; i < 10; i++) {
+    arr[i] = i * 3;
+    larr[i] = i * 5;
+  }
+  for(int i = 0; i < 5; i++) {
+    pairs[i].a = i;
+    pairs[i].b = i * 25;
+  }
+
+  int* p = arr;
+  long* lp = larr;
+  struct pair* pp = pairs;
+  int idx = three;
+  if(*(p + idx) != 9) return 16;
+  if(*(lp + idx * 2) != 30) return 17;
+  if((pp + idx)->b != 75) return 18;
+  if(p[idx + 4] != 21) return 19;
+  if(*(idx + p) != 9) return 20;
+  if(&p[idx] - p != 3) return 21;
+  return 0;
+}
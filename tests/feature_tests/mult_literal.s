@@ -0,0 +1,281 @@
+	.intel_syntax noprefix
+	.section .data
+uns:
+	.int 4000000000
+big:
+	.quad 123456789012
+minus:
+	.int -7
+three:
+	.int 3
+
+	.section .text
+	.global three
+	.global minus
+	.global big
+	.global uns
+	.global main
+main:
+	push rbp
+	mov rbp, rsp
+	sub rsp, 192
+	mov eax, DWORD PTR [three]
+	sal eax, 1
+	cmp eax, 6
+	je __shivyc_label1
+	mov eax, 1
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label1:
+	mov eax, DWORD PTR [three]
+	lea rax, [rax+2*rax]
+	cmp eax, 9
+	je __shivyc_label2
+	mov eax, 2
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label2:
+	mov eax, DWORD PTR [three]
+	lea rax, [rax+4*rax]
+	cmp eax, 15
+	je __shivyc_label3
+	mov eax, 3
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label3:
+	mov eax, DWORD PTR [three]
+	lea rax, [rax+8*rax]
+	cmp eax, 27
+	je __shivyc_label4
+	mov eax, 4
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label4:
+	mov eax, DWORD PTR [three]
+	lea rax, [rax+4*rax]
+	sal eax, 1
+	cmp eax, 30
+	je __shivyc_label5
+	mov eax, 5
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label5:
+	mov eax, DWORD PTR [three]
+	lea rax, [rax+4*rax]
+	sal eax, 3
+	cmp eax, 120
+	je __shivyc_label6
+	mov eax, 6
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label6:
+	mov eax, DWORD PTR [three]
+	lea rax, [rax+4*rax]
+	lea rax, [rax+8*rax]
+	cmp eax, 135
+	je __shivyc_label7
+	mov eax, 7
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label7:
+	mov eax, DWORD PTR [three]
+	neg eax
+	cmp eax, -3
+	je __shivyc_label8
+	mov eax, 8
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label8:
+	mov eax, DWORD PTR [three]
+	lea rax, [rax+2*rax]
+	sal eax, 3
+	neg eax
+	cmp eax, -72
+	je __shivyc_label9
+	mov eax, 9
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label9:
+	mov eax, DWORD PTR [minus]
+	lea rax, [rax+2*rax]
+	sal eax, 2
+	cmp eax, -84
+	je __shivyc_label10
+	mov eax, 10
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label10:
+	mov eax, DWORD PTR [minus]
+	imul eax, 7
+	cmp eax, -49
+	je __shivyc_label11
+	mov eax, 11
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label11:
+	mov rax, QWORD PTR [big]
+	lea rax, [rax+8*rax]
+	mov rcx, 1111111101108
+	cmp rax, rcx
+	je __shivyc_label12
+	mov eax, 12
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label12:
+	mov rax, QWORD PTR [big]
+	sal rax, 4
+	neg rax
+	mov rcx, -1975308624192
+	cmp rax, rcx
+	je __shivyc_label13
+	mov eax, 13
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label13:
+	mov eax, DWORD PTR [uns]
+	lea rax, [rax+2*rax]
+	mov eax, eax
+	mov rcx, 3410065408
+	cmp rax, rcx
+	je __shivyc_label14
+	mov eax, 14
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label14:
+	mov eax, DWORD PTR [uns]
+	sal eax, 3
+	cmp eax, 1935228928
+	je __shivyc_label15
+	mov eax, 15
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label15:
+	mov edi, 0
+	imul edi, 3
+	mov edx, 0
+	imul edx, 5
+	mov eax, 0
+__shivyc_label16:
+	cmp eax, 10
+	jge __shivyc_label18
+	movsx rcx, eax
+	mov DWORD PTR [rbp-40+4*rcx], edi
+	movsx rsi, edx
+	mov QWORD PTR [rbp-120+8*rcx], rsi
+	add eax, 1
+	add edi, 3
+	add edx, 5
+	jmp __shivyc_label16
+__shivyc_label18:
+	mov esi, 0
+	imul esi, 25
+	mov edx, 0
+__shivyc_label19:
+	cmp edx, 5
+	jge __shivyc_label21
+	movsx rax, edx
+	lea rax, [rbp-160+8*rax]
+	mov rcx, rax
+	add rcx, 0
+	mov DWORD PTR [rcx], edx
+	add rax, 4
+	mov DWORD PTR [rax], esi
+	add edx, 1
+	add esi, 25
+	jmp __shivyc_label19
+__shivyc_label21:
+	lea rax, [rbp-40]
+	mov QWORD PTR [rbp-168], rax
+	lea rax, [rbp-120]
+	mov QWORD PTR [rbp-176], rax
+	lea rax, [rbp-160]
+	mov QWORD PTR [rbp-184], rax
+	mov ecx, DWORD PTR [three]
+	movsx rdx, ecx
+	mov rax, QWORD PTR [rbp-168]
+	lea rax, [rax+4*rdx]
+	mov esi, DWORD PTR [rax]
+	cmp esi, 9
+	je __shivyc_label22
+	mov eax, 16
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label22:
+	mov esi, ecx
+	sal esi, 1
+	movsx rsi, esi
+	mov rdi, QWORD PTR [rbp-176]
+	lea rsi, [rdi+8*rsi]
+	mov rsi, QWORD PTR [rsi]
+	cmp rsi, 30
+	je __shivyc_label23
+	mov eax, 17
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label23:
+	mov rsi, QWORD PTR [rbp-184]
+	lea rdx, [rsi+8*rdx]
+	add rdx, 4
+	mov edx, DWORD PTR [rdx]
+	cmp edx, 75
+	je __shivyc_label24
+	mov eax, 18
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label24:
+	add ecx, 4
+	movsx rcx, ecx
+	mov rdx, QWORD PTR [rbp-168]
+	lea rcx, [rdx+4*rcx]
+	mov ecx, DWORD PTR [rcx]
+	cmp ecx, 21
+	je __shivyc_label25
+	mov eax, 19
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label25:
+	mov ecx, DWORD PTR [rax]
+	cmp ecx, 9
+	je __shivyc_label26
+	mov eax, 20
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label26:
+	sub rax, QWORD PTR [rbp-168]
+	mov rcx, rax
+	sar rcx, 63
+	shr rcx, 62
+	add rax, rcx
+	sar rax, 2
+	cmp rax, 3
+	je __shivyc_label27
+	mov eax, 21
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label27:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
@@ -0,0 +1,68 @@
+// Return: 0
+
+// Operations on chars and shorts promoted to int are done at the narrower
+// width when only the low bits of their result are observed, and keep
+// every bit when more are.
+
+void add_one(char* dst, const char* src, int n) {
+  for(int i = 0; i < n; i++) dst[i] = src[i] + 1;
+}
+
+unsigned char mix(unsigned char a, unsigned char b) {
+  return ((a ^ b) & 15) | ~a << 4;
+}
+
+unsigned char hash(const unsigned char* s, int n) {
+  unsigned char h = 7;
+  for(int i = 0; i < n; i++) h = h * 31 + s[i];
+  return h;
+}
+
+short scale(short a, short b) {
+  return a * b - (a << 3);
+}
+
+signed char shift_down(signed char c) {
+  return (c << 1) >> 1;
+}
+
+int wide(char c) {
+  return c + 1;
+}
+
+unsigned char low_byte(long a, long b) {
+  return a * b + 3;
+}
+
+char negate(char c) {
+  return -c;
+}
+
+int main() {
+  char src[4] = {126, 127, -128, -1};
+  char dst[4];
+  add_one(dst, src, 4);
+  if(dst[0] != 127 || dst[1] != -128 || dst[2] != -127 || dst[3] != 0)
+    return 1;
+
+  if(mix(170, 85) != 95) return 2;
+  if(mix(0, 255) != 255) return 3;
+
+  unsigned char s[3] = {200, 13, 255};
+  if(hash(s, 3) != 243) return 4;
+
+  if(scale(300, 300) != 22064) return 5;
+  if(scale(-3, 7) != 3) return 6;
+
+  if(shift_down(64) != 64) return 7;
+  if(shift_down(-100) != -100) return 8;
+
+  if(wide(127) != 128) return 9;
+  if(wide(-128) != -127) return 10;
+
+  if(low_byte(1000003, 17) != 118) return 11;
+  if(negate(-128) != -128) return 12;
+  if(negate(5) != -5) return 13;
+
+  return 0;
+}
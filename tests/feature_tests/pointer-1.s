@@ -0,0 +1,70 @@
+	.intel_syntax noprefix
+	.section .text
+	.global main
+main:
+	push rbp
+	mov rbp, rsp
+	sub rsp, 32
+	mov DWORD PTR [rbp-4], 10
+	lea rdx, [rbp-4]
+	mov eax, DWORD PTR [rdx]
+	cmp eax, 10
+	je __shivyc_label1
+	mov eax, 1
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label1:
+	mov QWORD PTR [rbp-16], 20
+	lea rax, [rbp-16]
+	mov rax, QWORD PTR [rax]
+	add rax, 50
+	cmp rax, 70
+	je __shivyc_label2
+	mov eax, 2
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label2:
+	cmp rdx, rdx
+	je __shivyc_label3
+	mov eax, 5
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label3:
+	mov cl, 0
+	cmp rdx, 0
+	je __shivyc_label14
+	mov cl, 1
+__shivyc_label14:
+	lea rax, [rbp-20]
+	cmp rax, rax
+	je __shivyc_label4
+	mov eax, 3
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label4:
+	mov DWORD PTR [rbp-20], 10
+	mov eax, DWORD PTR [rax]
+	mov DWORD PTR [rbp-20], eax
+	cmp DWORD PTR [rbp-20], 10
+	je __shivyc_label5
+	mov eax, 4
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label5:
+	cmp cl, 0
+	je __shivyc_label6
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label6:
+	mov eax, 1
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
@@ -0,0 +1,77 @@
+	.intel_syntax noprefix
+	.section .text
+	.global main
+main:
+	push rbp
+	mov rbp, rsp
+	sub rsp, 32
+	mov DWORD PTR [rbp-4], 1
+	lea rax, [rbp-4]
+	mov DWORD PTR [rax], 2
+	cmp DWORD PTR [rbp-4], 2
+	je __shivyc_label1
+	mov eax, 1
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label1:
+	mov DWORD PTR [rbp-8], 0
+	lea rax, [rbp-8]
+	mov DWORD PTR [rax], 3
+	cmp DWORD PTR [rbp-8], 3
+	je __shivyc_label2
+	mov eax, 2
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label2:
+	lea rax, [rbp-12]
+	add rax, 8
+	mov DWORD PTR [rax], 4
+	mov ecx, DWORD PTR [rax]
+	mov eax, DWORD PTR [rax]
+	cmp ecx, eax
+	je __shivyc_label3
+	mov eax, 3
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label3:
+	mov BYTE PTR [rbp-13], 4
+	mov QWORD PTR [rbp-24], 3
+	lea rcx, [rbp-13]
+	mov al, BYTE PTR [rbp-24]
+	mov BYTE PTR [rcx], al
+	movsx eax, BYTE PTR [rbp-13]
+	cmp eax, 3
+	je __shivyc_label4
+	mov eax, 4
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label4:
+	mov BYTE PTR [rbp-13], 4
+	lea rcx, [rbp-24]
+	movsx rax, BYTE PTR [rbp-13]
+	mov QWORD PTR [rcx], rax
+	cmp QWORD PTR [rbp-24], 4
+	je __shivyc_label5
+	mov eax, 5
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label5:
+	lea rax, [rbp-28]
+	mov DWORD PTR [rax], 10
+	cmp DWORD PTR [rbp-28], 10
+	je __shivyc_label6
+	mov eax, 6
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label6:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
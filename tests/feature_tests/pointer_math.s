@@ -0,0 +1,133 @@
+	.intel_syntax noprefix
+	.section .text
+	.global main
+main:
+	push rbp
+	mov rbp, rsp
+	sub rsp, 16
+	mov DWORD PTR [rbp-4], 5
+	mov DWORD PTR [rbp-8], 10
+	mov DWORD PTR [rbp-12], 15
+	lea rsi, [rbp-4]
+	lea rdx, [rbp-8]
+	lea rcx, [rbp-12]
+	mov rax, rcx
+	add rax, 4
+	mov edi, DWORD PTR [rax]
+	cmp edi, 10
+	je __shivyc_label1
+	mov eax, 1
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label1:
+	mov eax, DWORD PTR [rax]
+	cmp eax, 10
+	je __shivyc_label2
+	mov eax, 2
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label2:
+	mov rax, rcx
+	add rax, 8
+	mov edi, DWORD PTR [rax]
+	cmp edi, 5
+	je __shivyc_label3
+	mov eax, 3
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label3:
+	mov eax, DWORD PTR [rax]
+	cmp eax, 5
+	je __shivyc_label4
+	mov eax, 4
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label4:
+	mov rax, rdx
+	add rax, 4
+	mov edi, DWORD PTR [rax]
+	cmp edi, 5
+	je __shivyc_label5
+	mov eax, 5
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label5:
+	mov edi, DWORD PTR [rax]
+	cmp edi, 5
+	je __shivyc_label6
+	mov eax, 6
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label6:
+	mov edi, 0
+	cmp rax, rsi
+	je __shivyc_label7
+	mov edi, 1
+	mov eax, 7
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label7:
+	cmp edi, 0
+	je __shivyc_label8
+	mov eax, 8
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label8:
+	mov rax, rsi
+	sub rax, rdx
+	mov rdi, rax
+	sar rdi, 63
+	shr rdi, 62
+	add rax, rdi
+	sar rax, 2
+	cmp rax, 1
+	je __shivyc_label9
+	mov eax, 9
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label9:
+	mov rax, rsi
+	sub rax, rcx
+	mov rdi, rax
+	sar rdi, 63
+	shr rdi, 62
+	add rax, rdi
+	sar rax, 2
+	cmp rax, 2
+	je __shivyc_label10
+	mov eax, 10
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label10:
+	mov rax, rsi
+	sub rax, 4
+	cmp rax, rdx
+	je __shivyc_label11
+	mov eax, 11
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label11:
+	sub rsi, 8
+	cmp rsi, rcx
+	je __shivyc_label12
+	mov eax, 12
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label12:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
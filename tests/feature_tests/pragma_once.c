@@ -0,0 +1,11 @@
+// The helper defines a struct, so including it a second time would be an
+// error if `#pragma once` were not honored.
+#include "pragma_once_helper.h"
+#include "pragma_once_helper.h"
+
+int main() {
+  struct once_point p;
+  p.x = 3;
+  p.y = 4;
+  return p.x * p.y - 12;
+}
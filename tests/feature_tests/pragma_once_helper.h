@@ -0,0 +1,7 @@
+#pragma once
+#include "pragma_once_helper.h"
+
+struct once_point {
+  int x;
+  int y;
+};
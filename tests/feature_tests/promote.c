@@ -0,0 +1,64 @@
+// Return: 0
+
+// Memory which a loop writes is kept in a register through the loop, and
+// stored back on every exit, when nothing else in the loop may access it.
+
+struct counter { int pad; int count; };
+
+long total;
+int hits;
+int seen;
+
+void count_up(struct counter* c, int n) {
+  c->count = 0;
+  for(int i = 0; i < n; i++) c->count += i;
+}
+
+int first_over(int* a, int n, int limit) {
+  for(int i = 0; i < n; i++) {
+    total += a[i];
+    if(total > limit) return i;
+  }
+  return -1;
+}
+
+void grid(int n) {
+  for(int i = 0; i < n; i++) {
+    for(int j = 0; j < n; j++) {
+      if(j == 3) break;
+      hits++;
+    }
+  }
+}
+
+// The pointer may point to the global, so neither is promoted.
+void both(int* p, int n) {
+  for(int i = 0; i < n; i++) {
+    seen += 1;
+    *p += 2;
+  }
+}
+
+int main() {
+  struct counter c;
+  count_up(&c, 10);
+  if(c.count != 45) return 1;
+
+  int a[5] = {4, 8, 15, 16, 23};
+  if(first_over(a, 5, 20) != 2 || total != 27) return 2;
+  total = 0;
+  if(first_over(a, 5, 100) != -1 || total != 66) return 3;
+
+  grid(5);
+  if(hits != 15) return 4;
+  grid(0);
+  if(hits != 15) return 5;
+
+  both(&seen, 4);
+  if(seen != 12) return 6;
+  int local = 1;
+  both(&local, 3);
+  if(local != 7 || seen != 15) return 7;
+
+  return 0;
+}
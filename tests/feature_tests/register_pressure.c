@@ -0,0 +1,24 @@
+// Return: 253
+
+// More values are live across the loop than there are registers, so the
+// comparison of x and y, which are both kept in memory, finds no free
+// register to load one into. It borrows a register holding a live value,
+// which is saved before the comparison and restored before its jump.
+
+int pressure(int n, int x, int y) {
+  int a = n, b = n + 1, c = n + 2, d = n + 3, e = n + 4, f = n + 5;
+  int g = n + 6, h = n + 7, i = n + 8, j = n + 9, k = n + 10, l = n + 11;
+  int m = n + 12, o = n + 13, p = n + 14, q = n + 15, r = n + 16;
+  int count = 0;
+  for(int t = 0; t < n; t++) {
+    a += b; b += c; c += d; d += e; e += f; f += g; g += h; h += i;
+    i += j; j += k; k += l; l += m; m += o; o += p; p += q; q += r; r += a;
+    if(x < y) count++;
+    a ^= b; b ^= c; c ^= d; d ^= e; e ^= f; f ^= g; g ^= h; h ^= i;
+    i ^= j; j ^= k; k ^= l; l ^= m; m ^= o; o ^= p; p ^= q; q ^= r; r ^= a;
+  }
+  return count + a + b + c + d + e + f + g + h + i + j + k + l + m + o + p
+         + q + r;
+}
+
+int main() { return pressure(3, 1, 2) & 255; }
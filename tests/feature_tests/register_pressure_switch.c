@@ -0,0 +1,31 @@
+// Return: 232
+
+// More values are live across the switch than there are registers, so no
+// register is free for the index into its jump table. The index is kept in
+// a register the jump clobbers rather than in one borrowed from a live
+// value, which would have to be restored before the range check and is
+// still read by the jump through the table.
+
+long pressure(long n, long k) {
+  long a = n, b = n + 1, c = n + 2, d = n + 3, e = n + 4, f = n + 5;
+  long g = n + 6, h = n + 7, i = n + 8, j = n + 9, l = n + 10, m = n + 11;
+  long o = n + 12, p = n + 13, q = n + 14, r = 0;
+  for(long t = 0; t < n; t++) {
+    a += b; b += c; c += d; d += e; e += f; f += g; g += h; h += i;
+    i += j; j += l; l += m; m += o; o += p; p += q; q += a;
+    switch(t + k) {
+      case 3: r += a; break;
+      case 4: r -= b; break;
+      case 5: r ^= c; break;
+      case 6: r += d * 2; break;
+      case 7: r += e; break;
+      case 8: r -= f; break;
+      default: r += 1;
+    }
+    a ^= b; b ^= c; c ^= d; d ^= e; e ^= f; f ^= g; g ^= h; h ^= i;
+    i ^= j; j ^= l; l ^= m; m ^= o; o ^= p; p ^= q; q ^= a;
+  }
+  return r + k + a + b + c + d + e + f + g + h + i + j + l + m + o + p + q;
+}
+
+int main() { return pressure(9, 2) & 255; }
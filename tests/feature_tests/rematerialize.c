@@ -0,0 +1,63 @@
+// Return: 102
+
+// Under register pressure, a value which is cheap to recompute, like the
+// address of an array or a literal, is recomputed at each use instead of
+// being stored to the stack and reloaded.
+
+int ga[4], gb[4], gc[4];
+
+int sink(int* p) { return *p; }
+
+int f(int n) {
+  int la[4], lb[4];
+  int *pa = ga, *pb = gb, *pc = gc, *qa = la, *qb = lb;
+  long a = n, b = n * 2, c = n * 3, d = n * 5, e = n * 7, f = n * 11;
+  long g = n * 13, h = n * 17, i = n * 19, j = n * 23, k = n * 29;
+  long l = n * 31, m = n * 37, o = n * 41;
+  for(int t = 0; t < 4; t++) {
+    pa[t] = t + a; pb[t] = t + b; pc[t] = t + c; qa[t] = t * d; qb[t] = t * e;
+    a += f; b += g; c += h; d += i; e += j; f += k; g += l; h += m; i += o;
+  }
+  return sink(pa + 1) + sink(pb + 2) + pc[3] + qa[3] + qb[2]
+         + a + b + c + d + e + f + g + h + i + j + k + l + m + o;
+}
+
+// The literal divisor is rematerialized into a register the division does
+// not use, not RAX or RDX, which hold the dividend.
+long mod_loop(long p1, long p2) {
+  signed char v3 = 1000;
+  long v0 = 3041710, a = p1 + 1, b = p2 + 2, c = p1 * 3, d = p2 * 5;
+  long e = p1 ^ 7, f = p1 - 9, g = p2 - 11, h = p1 * p2, k = p1 + p2;
+  long m = p1 - p2, n = p1 << 2;
+  for(int i = 0; i < 15; i++) {
+    v0 -= p1 >> (((unsigned long)((long)(int)i / 7)
+                  % (((unsigned long)v3 / 17) | 1)) & 31);
+    a += b; b += c; c += d; d += e; e += f; f += g; g += h; h += k;
+    k += m; m += n; n += a;
+  }
+  return v0 + a + b + c + d + e + f + g + h + k + m + n;
+}
+
+// Literal arguments of a call, which clobbers every register that holds
+// no value across it, are rematerialized into registers the call clobbers.
+long args8(long a, long b, long c, long d, long e, long f, long g, long h) {
+  return a + b * 2 + c * 3 + d * 4 + e * 5 + f * 6 + g * 7 + h * 8;
+}
+
+long call_loop(long x) {
+  long c1 = 1, c2 = 2, c3 = 3, s = 0;
+  long a = x + 3, b = x * 4, c = x * 5, d = x * 6, e = x * 7;
+  long f = x * 8, g = x * 9, h = x * 10, i = x * 11, j = x * 12;
+  for(long t = 0; t < 5; t++) {
+    a += b ^ t; b += c ^ t; c += d ^ t; d += e ^ t; e += f ^ t;
+    f += g ^ t; g += h ^ t; h += i ^ t; i += j ^ t; j += a ^ t;
+    s += args8(a, b, c, d, e, c1, c2, c3);
+  }
+  return s + a + b + c + d + e + f + g + h + i + j;
+}
+
+int main() {
+  if(mod_loop(31, 2) != 24634701) return 1;
+  if(call_loop(3) != 29817) return 2;
+  return f(3) % 256;
+}
@@ -0,0 +1,66 @@
+// Accesses through pointers based on different restrict-qualified
+// parameters do not alias, so loads may be hoisted out of loops, loops may
+// be vectorized without checking for overlap, and memory may be kept in
+// registers.
+
+void add(int* restrict a, int* restrict b, int* restrict c, int n) {
+  for(int i = 0; i < n; i++) a[i] = b[i] + c[i];
+}
+
+void scale(long* restrict out, long* restrict k, long* in, int n) {
+  for(int i = 0; i < n; i++) out[i] = in[i] * *k;
+}
+
+void total(int* restrict sum, int* restrict a, int n) {
+  *sum = 1;
+  for(int i = 0; i < n; i++) *sum += a[i];
+}
+
+int copy(int* restrict dst, int* restrict src, int n) {
+  int* d = dst + 1;
+  int* s = src;
+  for(int i = 0; i < n; i++) {
+    *d = *s;
+    d++;
+    s++;
+  }
+  return dst[n];
+}
+
+int not_restrict(int* restrict p, int* q) {
+  int a = *p;
+  *q = 5;
+  return a + *q;
+}
+
+int main() {
+  int a[20], b[20], c[20];
+  for(int i = 0; i < 20; i++) {
+    b[i] = i;
+    c[i] = 2 * i;
+  }
+  add(a, b, c, 20);
+  for(int i = 0; i < 20; i++) {
+    if(a[i] != 3 * i) return 1;
+  }
+
+  long in[10], out[10], k = 3;
+  for(int i = 0; i < 10; i++) in[i] = i;
+  scale(out, &k, in, 10);
+  for(int i = 0; i < 10; i++) {
+    if(out[i] != 3 * i) return 2;
+  }
+
+  int sum;
+  total(&sum, b, 20);
+  if(sum != 191) return 3;
+
+  int src[5] = {1, 2, 3, 4, 5};
+  int dst[6];
+  if(copy(dst, src, 5) != 5 || dst[1] != 1) return 4;
+
+  int x = 1;
+  if(not_restrict(&x, &x) != 6) return 5;
+
+  return 0;
+}
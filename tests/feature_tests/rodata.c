@@ -0,0 +1,33 @@
+// String literals and const static data are stored in read-only sections,
+// and identical string literals are stored only once.
+
+const int answer = 42;
+static const long big = 5000000000;
+const char tentative[4];
+
+int length(const char* s) {
+  int n = 0;
+  while(s[n]) n++;
+  return n;
+}
+
+int main() {
+  static const int local = 9;
+  if(answer + local != 51) return 1;
+  if(big / 1000 != 5000000) return 2;
+  if(tentative[3]) return 3;
+
+  const char* a = "same";
+  const char* b = "same";
+  if(a != b) return 4;
+
+  // Strings with special characters or a null character inside.
+  const char* c = "tab\there \"quoted\" \\ \n";
+  if(length(c) != 21 || c[3] != 9 || c[9] != 34 || c[20] != 10) return 6;
+  const char* d = "ab\0cd";
+  if(length(d) != 2 || d[3] != 'c' || d[5]) return 7;
+  const char* e = "ab\0cd";
+  if(d != e) return 8;
+
+  return 0;
+}
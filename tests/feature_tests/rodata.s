@@ -0,0 +1,161 @@
+	.intel_syntax noprefix
+	.comm tentative 4
+	.section .rodata
+big.27:
+	.quad 5000000000
+answer:
+	.int 42
+__strlit41:
+	.ascii "ab\000cd\000"
+local.49:
+	.int 9
+
+	.section .rodata.str1.1,"aMS",@progbits,1
+__strlit26:
+	.asciz "tab\there \"quoted\" \\ \n"
+__strlit28:
+	.asciz "same"
+
+	.section .text
+	.global answer
+	.global length
+	.global main
+length:
+	push rbp
+	mov rbp, rsp
+	mov eax, 0
+__shivyc_label1:
+	movsx rcx, eax
+	add rcx, rdi
+	mov cl, BYTE PTR [rcx]
+	cmp cl, 0
+	je __shivyc_label2
+	add eax, 1
+	jmp __shivyc_label1
+__shivyc_label2:
+	mov rsp, rbp
+	pop rbp
+	ret
+main:
+	push rbp
+	mov rbp, rsp
+	mov eax, DWORD PTR [answer]
+	add eax, DWORD PTR [local.49]
+	cmp eax, 51
+	je __shivyc_label3
+	mov eax, 1
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label3:
+	mov rax, 2361183241434822607
+	imul QWORD PTR [big.27]
+	sar rdx, 7
+	mov rax, rdx
+	shr rax, 63
+	add rdx, rax
+	cmp rdx, 5000000
+	je __shivyc_label4
+	mov eax, 2
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label4:
+	mov al, BYTE PTR [tentative+1*3]
+	cmp al, 0
+	je __shivyc_label5
+	mov eax, 3
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label5:
+	lea rcx, [__strlit28]
+	lea rax, [__strlit28]
+	cmp rcx, rax
+	je __shivyc_label6
+	mov eax, 4
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label6:
+	lea rdx, [__strlit26]
+	mov ecx, 0
+__shivyc_label12:
+	movsx rax, ecx
+	add rax, rdx
+	mov al, BYTE PTR [rax]
+	cmp al, 0
+	je __shivyc_label13
+	add ecx, 1
+	jmp __shivyc_label12
+__shivyc_label13:
+__shivyc_label14:
+	cmp ecx, 21
+	jne __shivyc_label8
+	mov rax, rdx
+	add rax, 3
+	mov al, BYTE PTR [rax]
+	movsx eax, al
+	cmp eax, 9
+	jne __shivyc_label8
+	mov rax, rdx
+	add rax, 9
+	mov al, BYTE PTR [rax]
+	movsx eax, al
+	cmp eax, 34
+	jne __shivyc_label8
+	add rdx, 20
+	mov al, BYTE PTR [rdx]
+	movsx eax, al
+	cmp eax, 10
+	je __shivyc_label7
+__shivyc_label8:
+	mov eax, 6
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label7:
+	lea rdx, [__strlit41]
+	mov ecx, 0
+__shivyc_label15:
+	movsx rax, ecx
+	add rax, rdx
+	mov al, BYTE PTR [rax]
+	cmp al, 0
+	je __shivyc_label16
+	add ecx, 1
+	jmp __shivyc_label15
+__shivyc_label16:
+__shivyc_label17:
+	cmp ecx, 2
+	jne __shivyc_label10
+	mov rax, rdx
+	add rax, 3
+	mov al, BYTE PTR [rax]
+	movsx eax, al
+	cmp eax, 99
+	jne __shivyc_label10
+	mov rax, rdx
+	add rax, 5
+	mov al, BYTE PTR [rax]
+	cmp al, 0
+	je __shivyc_label9
+__shivyc_label10:
+	mov eax, 7
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label9:
+	lea rax, [__strlit41]
+	cmp rdx, rax
+	je __shivyc_label11
+	mov eax, 8
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label11:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
@@ -0,0 +1,34 @@
+struct point { int x, y; };
+struct rect { struct point a, b; long area; };
+struct point make(int x, int y) { struct point p; p.x = x; p.y = y; return p; }
+int dist(struct point p, struct point q) {
+  int dx = p.x - q.x, dy = p.y - q.y;
+  return dx * dx + dy * dy;
+}
+int loop(int n) {
+  struct point p = {0, 0};
+  for (int i = 0; i < n; i++) { p.x += i; p.y += 2 * i; }
+  struct point q;
+  q = p;
+  q.x++;
+  struct rect r = {{1, 2}, {3}};
+  r.b = q;
+  r.area = (r.b.x - r.a.x) * (r.b.y - r.a.y);
+  return q.x + q.y + r.area;
+}
+int main() {
+  struct point a, b = {0, 0};
+  a = make(3, 4);
+  if (dist(a, b) != 25) return 1;
+  if (loop(4) != 6 + 1 + 12 + (7 - 1) * (12 - 2)) return 2;
+  struct point c; c.x = 1; c.y = 2; struct point *pc = &c; pc->y = 5;
+  if (c.y != 5) return 3;
+
+  struct flags { _Bool on; char c; struct point p; } f = {0}, g;
+  f.on = 7;
+  f.p.y = f.on + 1;
+  g = f;
+  g.c = g.p.y * 3;
+  if (!g.on || g.c != 6 || g.p.x || f.c) return 4;
+  return 0;
+}
@@ -0,0 +1,52 @@
+// Return: 0
+
+// The ASM code is scheduled, so commands move past each other within a
+// block. A store through a pointer must stay ahead of the loads of what it
+// may point to, and a write of part of a register ahead of the reads of
+// the whole.
+
+int g[4];
+char bytes[8];
+
+void store(int* p, int v) { *p = v; }
+
+int through_pointer(int* p, int* q) {
+  int a = *q;
+  *p = a + 1;
+  int b = *q;
+  return a * 10 + b;
+}
+
+int main() {
+  int local = 3;
+  int* p = &local;
+  *p = *p * 2 + local;
+  if(local != 9) return 1;
+
+  int x = 5;
+  if(through_pointer(&x, &x) != 56) return 2;
+  int y = 5, z = 7;
+  if(through_pointer(&y, &z) != 77 || y != 8) return 3;
+
+  g[0] = 1; g[1] = 2; g[2] = g[0] + g[1]; g[3] = g[2] * g[1];
+  if(g[3] != 6) return 4;
+
+  for(int i = 0; i < 8; i++) bytes[i] = i * 3;
+  long sum = 0;
+  for(int i = 0; i < 8; i++) sum = sum * 2 + bytes[i];
+  if(sum != 741) return 5;
+
+  int arr[3] = {1, 2, 3};
+  store(arr + 1, 10);
+  if(arr[0] + arr[1] + arr[2] != 14) return 6;
+
+  double d = 1.5, e = d * 4;
+  float f = e / 3;
+  if(f != 2) return 7;
+
+  unsigned char c = 200;
+  int w = c + (c > 100) + (c >> 4);
+  if(w != 213) return 8;
+
+  return 0;
+}
@@ -0,0 +1,57 @@
+int calls;
+
+int t(int x) {
+  calls = calls * 10 + x;
+  return 1;
+}
+
+int f(int x) {
+  calls = calls * 10 + x;
+  return 0;
+}
+
+int main() {
+  calls = 0;
+  if(t(1) && f(2) && t(3)) return 1;
+  if(calls != 12) return 2;
+
+  calls = 0;
+  if(f(1) || t(2) || t(3)) {
+    if(calls != 12) return 3;
+  } else return 4;
+
+  calls = 0;
+  if(!(f(1) || f(2)) && !t(3)) return 5;
+  if(calls != 123) return 6;
+
+  calls = 0;
+  if((f(1) && t(2)) || (t(3) && !f(4))) {
+    if(calls != 134) return 7;
+  } else return 8;
+
+  int i = 0, n = 0;
+  while(i < 10 && !(i > 5 && i % 2)) {
+    i++;
+    n++;
+  }
+  if(i != 7 || n != 7) return 9;
+
+  n = 0;
+  for(i = 0; i < 3 || (i < 8 && i != 6); i++) n++;
+  if(n != 6) return 10;
+
+  // Boolean values computed from nested conditions
+  int a = 3, b = 0;
+  int v = a && (b || a > 2);
+  if(v != 1) return 11;
+  v = !a || (b && a);
+  if(v != 0) return 12;
+  v = !!a + !b;
+  if(v != 2) return 13;
+
+  int *p = 0;
+  if(p && *p) return 14;
+  if(!p || *p) {} else return 15;
+
+  return 0;
+}
@@ -0,0 +1,198 @@
+	.intel_syntax noprefix
+	.comm calls 4
+	.section .text
+	.global t
+	.global f
+	.global main
+t:
+	push rbp
+	mov rbp, rsp
+	mov eax, DWORD PTR [calls]
+	lea rax, [rax+4*rax]
+	sal eax, 1
+	add edi, eax
+	mov DWORD PTR [calls], edi
+	mov eax, 1
+	mov rsp, rbp
+	pop rbp
+	ret
+f:
+	push rbp
+	mov rbp, rsp
+	mov eax, DWORD PTR [calls]
+	lea rax, [rax+4*rax]
+	sal eax, 1
+	add edi, eax
+	mov DWORD PTR [calls], edi
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+main:
+	push rbp
+	mov rbp, rsp
+	mov DWORD PTR [calls], 0
+	mov eax, DWORD PTR [calls]
+	lea rax, [rax+4*rax]
+	sal eax, 1
+	add eax, 1
+	mov DWORD PTR [calls], eax
+__shivyc_label40:
+	mov eax, DWORD PTR [calls]
+	lea rax, [rax+4*rax]
+	sal eax, 1
+	add eax, 2
+	mov DWORD PTR [calls], eax
+__shivyc_label41:
+__shivyc_label1:
+	cmp DWORD PTR [calls], 12
+	je __shivyc_label2
+	mov eax, 2
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label2:
+	mov DWORD PTR [calls], 0
+	mov eax, DWORD PTR [calls]
+	lea rax, [rax+4*rax]
+	sal eax, 1
+	add eax, 1
+	mov DWORD PTR [calls], eax
+__shivyc_label43:
+	mov eax, DWORD PTR [calls]
+	lea rax, [rax+4*rax]
+	sal eax, 1
+	add eax, 2
+	mov DWORD PTR [calls], eax
+__shivyc_label44:
+__shivyc_label4:
+	cmp DWORD PTR [calls], 12
+	je __shivyc_label5
+	mov eax, 3
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label5:
+__shivyc_label6:
+	mov DWORD PTR [calls], 0
+	mov eax, DWORD PTR [calls]
+	lea rax, [rax+4*rax]
+	sal eax, 1
+	add eax, 1
+	mov DWORD PTR [calls], eax
+__shivyc_label46:
+	mov eax, DWORD PTR [calls]
+	lea rax, [rax+4*rax]
+	sal eax, 1
+	add eax, 2
+	mov DWORD PTR [calls], eax
+__shivyc_label47:
+	mov eax, DWORD PTR [calls]
+	lea rax, [rax+4*rax]
+	sal eax, 1
+	add eax, 3
+	mov DWORD PTR [calls], eax
+__shivyc_label48:
+__shivyc_label7:
+	cmp DWORD PTR [calls], 123
+	je __shivyc_label8
+	mov eax, 6
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label8:
+	mov DWORD PTR [calls], 0
+	mov eax, DWORD PTR [calls]
+	lea rax, [rax+4*rax]
+	sal eax, 1
+	add eax, 1
+	mov DWORD PTR [calls], eax
+__shivyc_label49:
+__shivyc_label11:
+	mov eax, DWORD PTR [calls]
+	lea rax, [rax+4*rax]
+	sal eax, 1
+	add eax, 3
+	mov DWORD PTR [calls], eax
+__shivyc_label51:
+	mov eax, DWORD PTR [calls]
+	lea rax, [rax+4*rax]
+	sal eax, 1
+	add eax, 4
+	mov DWORD PTR [calls], eax
+__shivyc_label52:
+	cmp DWORD PTR [calls], 134
+	je __shivyc_label12
+	mov eax, 7
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label12:
+__shivyc_label13:
+	mov ecx, 0
+	mov eax, 0
+__shivyc_label14:
+	cmp ecx, 10
+	jge __shivyc_label15
+	cmp ecx, 5
+	jle __shivyc_label16
+	mov edx, ecx
+	mov esi, edx
+	shr esi, 31
+	add esi, edx
+	sar esi, 1
+	sal esi, 1
+	sub edx, esi
+	cmp edx, 0
+	jne __shivyc_label15
+__shivyc_label16:
+	add ecx, 1
+	add eax, 1
+	jmp __shivyc_label14
+__shivyc_label15:
+	cmp ecx, 7
+	jne __shivyc_label18
+	cmp eax, 7
+	je __shivyc_label17
+__shivyc_label18:
+	mov eax, 9
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label17:
+	mov ecx, 0
+	mov eax, 0
+__shivyc_label19:
+	cmp ecx, 3
+	jl __shivyc_label22
+	cmp ecx, 8
+	jge __shivyc_label21
+	cmp ecx, 6
+	je __shivyc_label21
+__shivyc_label22:
+	add eax, 1
+	add ecx, 1
+	jmp __shivyc_label19
+__shivyc_label21:
+	cmp eax, 6
+	je __shivyc_label23
+	mov eax, 10
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label23:
+__shivyc_label25:
+__shivyc_label27:
+__shivyc_label28:
+__shivyc_label31:
+__shivyc_label33:
+__shivyc_label34:
+__shivyc_label35:
+__shivyc_label36:
+__shivyc_label38:
+__shivyc_label39:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
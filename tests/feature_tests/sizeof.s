@@ -0,0 +1,60 @@
+	.intel_syntax noprefix
+	.comm global 4
+	.section .text
+	.global f
+	.global main
+f:
+	push rbp
+	mov rbp, rsp
+	mov DWORD PTR [global], 10
+	mov rsp, rbp
+	pop rbp
+	ret
+main:
+	push rbp
+	mov rbp, rsp
+__shivyc_label1:
+__shivyc_label2:
+__shivyc_label3:
+__shivyc_label4:
+__shivyc_label5:
+__shivyc_label6:
+__shivyc_label7:
+__shivyc_label8:
+__shivyc_label9:
+__shivyc_label10:
+__shivyc_label11:
+__shivyc_label12:
+__shivyc_label13:
+__shivyc_label14:
+__shivyc_label15:
+__shivyc_label16:
+__shivyc_label17:
+__shivyc_label18:
+__shivyc_label19:
+__shivyc_label20:
+__shivyc_label21:
+__shivyc_label22:
+__shivyc_label23:
+__shivyc_label24:
+__shivyc_label25:
+__shivyc_label26:
+__shivyc_label27:
+__shivyc_label28:
+__shivyc_label29:
+__shivyc_label30:
+__shivyc_label31:
+__shivyc_label32:
+__shivyc_label33:
+	cmp DWORD PTR [global], 0
+	je __shivyc_label34
+	mov eax, 33
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label34:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
@@ -0,0 +1,50 @@
+// Return: 0
+
+// A local variable whose address is taken is kept in a register between
+// the commands which may read or write it through a pointer, and its home
+// in memory is brought up to date around them.
+
+void bump(int* p) { (*p)++; }
+int read(int* p) { return *p; }
+
+int count_calls(int n) {
+  int calls = 0;
+  for(int i = 0; i < n; i++) {
+    if(i % 3 == 0) bump(&calls);
+  }
+  return calls;
+}
+
+int twice(int a) {
+  int* p = &a;
+  a = a * 2;
+  int seen = read(p);
+  *p += 1;
+  return seen * 100 + a;
+}
+
+int main() {
+  if(count_calls(10) != 4) return 1;
+  if(twice(7) != 1415) return 2;
+
+  int i = 0, total = 0;
+  int* q = &i;
+  while(i < 10) {
+    total += i;
+    if(i == 4) *q = 7;
+    i++;
+  }
+  if(total != 27) return 3;
+
+  long wide = 5;
+  char* bytes = (char*)&wide;
+  bytes[0] = 9;
+  if(wide != 9) return 4;
+
+  short s = 3;
+  bump((int*)0 == 0 ? &total : 0);
+  s += read(&total);
+  if(s != 31 || total != 28) return 5;
+
+  return 0;
+}
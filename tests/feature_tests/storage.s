@@ -0,0 +1,203 @@
+	.intel_syntax noprefix
+	.local intern_var.12
+	.comm intern_var.12 4
+	.comm tent_var_1 4
+	.comm tent_var 4
+	.section .data
+a.24:
+	.int 1
+b.46:
+	.int 7
+tent_var_2:
+	.int 10
+
+	.section .text
+	.global tent_var_2
+	.global func
+	.global main
+main:
+	push rbp
+	mov rbp, rsp
+	push rbx
+	sub rsp, 8
+	mov rax, QWORD PTR [stdout]
+	mov al, BYTE PTR [rax]
+	movsx eax, al
+	add eax, 124
+	cmp eax, 0
+	je __shivyc_label1
+	mov eax, 1
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label1:
+	cmp DWORD PTR [extern_var], 0
+	je __shivyc_label2
+	mov eax, 2
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label2:
+	mov DWORD PTR [extern_var], 18
+	cmp DWORD PTR [extern_var], 18
+	je __shivyc_label3
+	mov eax, 3
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label3:
+	cmp ecx, 18
+	jne __shivyc_label4
+	mov eax, 4
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label4:
+	cmp DWORD PTR [extern_var], 18
+	je __shivyc_label5
+	mov eax, 5
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label5:
+	mov DWORD PTR [intern_var.12], 7
+	cmp DWORD PTR [intern_var.12], 7
+	je __shivyc_label6
+	mov eax, 6
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label6:
+	cmp DWORD PTR [intern_var.12], 7
+	je __shivyc_label7
+	mov eax, 7
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label7:
+	cmp DWORD PTR [extern_var_2], 8
+	je __shivyc_label8
+	mov eax, 8
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label8:
+	cmp DWORD PTR [a], 3
+	je __shivyc_label9
+	mov eax, 9
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label9:
+	lea rax, [set_a_to_1]
+	call rax
+	cmp DWORD PTR [a], 1
+	je __shivyc_label10
+	mov eax, 10
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label10:
+	cmp DWORD PTR [b.46], 7
+	je __shivyc_label11
+	mov eax, 11
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label11:
+	lea rax, [set_b_to_1]
+	call rax
+	cmp DWORD PTR [b.46], 7
+	je __shivyc_label12
+	mov eax, 12
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label12:
+	mov ebx, 1
+__shivyc_label13:
+	cmp ebx, 10
+	jge __shivyc_label15
+	lea rax, [func]
+	call rax
+	cmp eax, ebx
+	je __shivyc_label16
+	mov eax, 13
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label16:
+	add ebx, 1
+	jmp __shivyc_label13
+__shivyc_label15:
+	cmp DWORD PTR [tent_var], 0
+	je __shivyc_label17
+	mov eax, 14
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label17:
+	cmp DWORD PTR [tent_var_1], 0
+	je __shivyc_label18
+	mov eax, 15
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label18:
+	lea rax, [set_tent_vars]
+	call rax
+	cmp DWORD PTR [tent_var], 3
+	je __shivyc_label19
+	mov eax, 16
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label19:
+	cmp DWORD PTR [tent_var_1], 3
+	je __shivyc_label20
+	mov eax, 17
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label20:
+	cmp DWORD PTR [tent_var_2], 10
+	je __shivyc_label21
+	mov eax, 18
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label21:
+	mov eax, 0
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+func:
+	push rbp
+	mov rbp, rsp
+	mov eax, DWORD PTR [a.24]
+	mov ecx, DWORD PTR [a.24]
+	add ecx, 1
+	mov DWORD PTR [a.24], ecx
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
@@ -0,0 +1,43 @@
+	.intel_syntax noprefix
+	.comm tent_var_1 4
+	.comm tent_var 4
+	.section .data
+b.6:
+	.int 4
+extern_var_2:
+	.int 8
+a:
+	.int 3
+extern_var:
+	.zero 4
+
+	.section .text
+	.global extern_var
+	.global extern_var_2
+	.global a
+	.global set_a_to_1
+	.global set_b_to_1
+	.global set_tent_vars
+set_a_to_1:
+	push rbp
+	mov rbp, rsp
+	mov DWORD PTR [a], 1
+	mov rsp, rbp
+	pop rbp
+	ret
+set_b_to_1:
+	push rbp
+	mov rbp, rsp
+	mov DWORD PTR [b.6], 1
+	mov rsp, rbp
+	pop rbp
+	ret
+set_tent_vars:
+	push rbp
+	mov rbp, rsp
+	mov DWORD PTR [tent_var], 3
+	mov DWORD PTR [tent_var_1], 3
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
@@ -0,0 +1,130 @@
+	.intel_syntax noprefix
+	.section .rodata.str1.1,"aMS",@progbits,1
+__strlit11:
+	.asciz "hello"
+__strlit18:
+	.asciz "123"
+__strlit19:
+	.asciz "/g"
+__strlit20:
+	.asciz "\\x"
+__strlit36:
+	.asciz "/8"
+
+	.section .text
+	.global main
+main:
+	push rbp
+	mov rbp, rsp
+	push rbx
+	sub rsp, 8
+	lea rbx, [strcmp]
+	lea rdi, [__strlit11]
+	lea rsi, [__strlit11]
+	call rbx
+	cmp eax, 0
+	je __shivyc_label1
+	mov eax, 1
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label1:
+	lea rsi, [__strlit11]
+	lea rdi, [__strlit11]
+	call rbx
+	cmp eax, 0
+	je __shivyc_label2
+	mov eax, 2
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label2:
+__shivyc_label3:
+__shivyc_label4:
+__shivyc_label5:
+__shivyc_label6:
+__shivyc_label7:
+__shivyc_label8:
+__shivyc_label9:
+__shivyc_label10:
+__shivyc_label11:
+__shivyc_label12:
+__shivyc_label13:
+__shivyc_label14:
+__shivyc_label15:
+__shivyc_label16:
+__shivyc_label17:
+	lea rdi, [__strlit11]
+	lea rsi, [__strlit11]
+	call rbx
+	cmp eax, 0
+	je __shivyc_label18
+	mov eax, 18
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label18:
+	lea rdi, [__strlit18]
+	lea rsi, [__strlit18]
+	call rbx
+	cmp eax, 0
+	je __shivyc_label19
+	mov eax, 19
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label19:
+	lea rdi, [__strlit18]
+	lea rsi, [__strlit18]
+	call rbx
+	cmp eax, 0
+	je __shivyc_label20
+	mov eax, 20
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label20:
+	lea rdi, [__strlit36]
+	lea rsi, [__strlit36]
+	call rbx
+	cmp eax, 0
+	je __shivyc_label21
+	mov eax, 21
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label21:
+	lea rdi, [__strlit19]
+	lea rsi, [__strlit19]
+	call rbx
+	cmp eax, 0
+	je __shivyc_label22
+	mov eax, 22
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label22:
+	lea rdi, [__strlit20]
+	lea rsi, [__strlit20]
+	call rbx
+	cmp eax, 0
+	je __shivyc_label23
+	mov eax, 23
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label23:
+	mov eax, 0
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+	.att_syntax noprefix
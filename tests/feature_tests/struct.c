@@ -17,7 +17,7 @@ int main() {
   char* p2 = p1;
 
   // this is a hacky test to check sizeof(struct A)
-  void* p3 = p2 - 8*4;
+  void* p3 = p2 - 8*6;
 
   if(p3 != q) return 1;
 
@@ -87,4 +87,37 @@ int main() {
       int e_int;
     } nested_union_e;
   };
+
+  // Check copying structs larger than one register
+  struct G {
+    long a;
+    long b;
+    int c;
+    char d;
+  } g_array[3], g_copy;
+
+  g_array[2].a = 1;
+  g_array[2].b = 2;
+  g_array[2].c = 3;
+  g_array[2].d = 4;
+  g_copy = g_array[2];
+  if(g_copy.a != 1 || g_copy.b != 2) return 17;
+  if(g_copy.c != 3 || g_copy.d != 4) return 18;
+
+  // Check copying structs large enough to use a string copy
+  struct H {
+    long a[40];
+    char b[3];
+  } h_array[2], h_copy, *h_ptr;
+
+  h_array[1].a[0] = 5;
+  h_array[1].a[39] = 6;
+  h_array[1].b[2] = 7;
+  h_copy = h_array[1];
+  if(h_copy.a[0] != 5 || h_copy.a[39] != 6) return 19;
+  if(h_copy.b[2] != 7) return 20;
+
+  h_ptr = &h_array[0];
+  *h_ptr = h_copy;
+  if(h_array[0].a[39] != 6 || h_array[0].b[2] != 7) return 21;
 }
@@ -0,0 +1,273 @@
+	.intel_syntax noprefix
+	.section .text
+	.global main
+main:
+	push rbp
+	mov rbp, rsp
+	sub rsp, 2128
+	lea rdx, [rbp-32]
+	mov rax, rdx
+	add rax, 32
+	sub rax, 32
+	cmp rax, rdx
+	je __shivyc_label1
+	mov eax, 1
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label1:
+	lea rax, [rbp-32]
+	cmp rax, rax
+	je __shivyc_label2
+	mov eax, 2
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label2:
+	mov DWORD PTR [rbp-32], 10
+	mov eax, DWORD PTR [rbp-32]
+	cmp eax, 10
+	je __shivyc_label3
+	mov eax, 3
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label3:
+	lea rax, [rbp-32]
+	mov QWORD PTR [rbp-8], rax
+	mov rcx, QWORD PTR [rbp-8]
+	mov DWORD PTR [rcx], 20
+	mov ecx, DWORD PTR [rbp-32]
+	cmp ecx, 20
+	je __shivyc_label4
+	mov eax, 4
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label4:
+	mov rcx, rdx
+	add rcx, 20
+	mov DWORD PTR [rcx], 15
+	mov esi, DWORD PTR [rbp-12]
+	cmp esi, 15
+	je __shivyc_label5
+	mov eax, 5
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label5:
+	mov ecx, DWORD PTR [rcx]
+	cmp ecx, 15
+	je __shivyc_label6
+	mov eax, 11
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label6:
+	cmp rdx, rax
+	je __shivyc_label7
+	mov eax, 6
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label7:
+	lea rax, [rbp-28]
+	add rax, 4
+	mov QWORD PTR [rax], 10
+	mov rcx, QWORD PTR [rax]
+	cmp rcx, 10
+	je __shivyc_label8
+	mov eax, 7
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label8:
+	mov rcx, QWORD PTR [rax]
+	cmp rcx, 10
+	je __shivyc_label9
+	mov eax, 8
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label9:
+	mov rcx, QWORD PTR [rax]
+	cmp rcx, 10
+	je __shivyc_label10
+	mov eax, 12
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label10:
+	mov rcx, QWORD PTR [rax]
+	cmp rcx, 10
+	je __shivyc_label11
+	mov eax, 9
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label11:
+	mov QWORD PTR [rax], 20
+	mov rax, QWORD PTR [rax]
+	cmp rax, 20
+	je __shivyc_label12
+	mov eax, 10
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label12:
+	lea rax, [rbp-352+8*12]
+	add rax, 4
+	add rax, 0
+	mov DWORD PTR [rax], 3
+	mov eax, DWORD PTR [rax]
+	cmp eax, 3
+	je __shivyc_label13
+	mov eax, 13
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label13:
+	lea rax, [rbp-352+8*0]
+	add rax, 96
+	add rax, 4
+	add rax, 0
+	mov eax, DWORD PTR [rax]
+	cmp eax, 3
+	je __shivyc_label14
+	mov eax, 14
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label14:
+	lea rax, [rbp-752+8*25]
+	add rax, 0
+	add rax, 20
+	mov DWORD PTR [rax], 3
+	mov eax, DWORD PTR [rax]
+	cmp eax, 3
+	je __shivyc_label15
+	mov eax, 15
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label15:
+	mov DWORD PTR [rbp-2120], 3
+	mov eax, DWORD PTR [rbp-2120]
+	cmp eax, 3
+	je __shivyc_label16
+	mov eax, 16
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label16:
+	lea rax, [rbp-816+1*42]
+	mov rcx, rax
+	add rcx, 0
+	mov QWORD PTR [rcx], 1
+	mov rcx, rax
+	add rcx, 8
+	mov QWORD PTR [rcx], 2
+	mov rcx, rax
+	add rcx, 16
+	mov DWORD PTR [rcx], 3
+	add rax, 20
+	mov BYTE PTR [rax], 4
+	movdqu xmm15, XMMWORD PTR [rbp-816+1*42]
+	movdqu XMMWORD PTR [rbp-2120], xmm15
+	movdqu xmm15, XMMWORD PTR [rbp-811+1*42]
+	movdqu XMMWORD PTR [rbp-2115], xmm15
+	mov rax, QWORD PTR [rbp-2120]
+	cmp rax, 1
+	jne __shivyc_label18
+	mov rax, QWORD PTR [rbp-2112]
+	cmp rax, 2
+	je __shivyc_label17
+__shivyc_label18:
+	mov eax, 17
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label17:
+	mov eax, DWORD PTR [rbp-2104]
+	cmp eax, 3
+	jne __shivyc_label20
+	mov al, BYTE PTR [rbp-2100]
+	movsx eax, al
+	cmp eax, 4
+	je __shivyc_label19
+__shivyc_label20:
+	mov eax, 18
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label19:
+	lea rax, [rbp-1464+1*323]
+	mov rcx, rax
+	add rcx, 0
+	mov QWORD PTR [rcx], 5
+	add rcx, 312
+	mov QWORD PTR [rcx], 6
+	add rax, 320
+	add rax, 2
+	mov BYTE PTR [rax], 7
+	lea rsi, [rbp-1464+1*323]
+	lea rdi, [rbp-2120]
+	mov rcx, 323
+	rep movsb
+	lea rsi, [rbp-2120]
+	lea rdi, [rbp-1792]
+	mov rcx, 323
+	rep movsb
+	lea rax, [rbp-1792]
+	mov rcx, QWORD PTR [rax]
+	cmp rcx, 5
+	jne __shivyc_label22
+	add rax, 312
+	mov rax, QWORD PTR [rax]
+	cmp rax, 6
+	je __shivyc_label21
+__shivyc_label22:
+	mov eax, 19
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label21:
+	lea rax, [rbp-1472]
+	add rax, 2
+	mov al, BYTE PTR [rax]
+	movsx eax, al
+	cmp eax, 7
+	je __shivyc_label23
+	mov eax, 20
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label23:
+	lea rax, [rbp-1464+1*0]
+	lea rsi, [rbp-1792]
+	lea rdi, [rax]
+	mov rcx, 323
+	rep movsb
+	mov rcx, rax
+	add rcx, 0
+	add rcx, 312
+	mov rcx, QWORD PTR [rcx]
+	cmp rcx, 6
+	jne __shivyc_label25
+	add rax, 320
+	add rax, 2
+	mov al, BYTE PTR [rax]
+	movsx eax, al
+	cmp eax, 7
+	je __shivyc_label24
+__shivyc_label25:
+	mov eax, 21
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label24:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
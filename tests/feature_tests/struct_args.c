@@ -0,0 +1,82 @@
+// Arguments past the sixth are passed on the stack, structs of at most 16
+// bytes in registers, and larger structs on the stack. A struct of at most
+// 16 bytes is returned in registers, and a larger one through a pointer
+// passed in by the caller.
+
+struct three { char a, b, c; };
+struct pair { long x; int y; };
+struct big { long a, b, c; };
+
+long many(long a, long b, long c, long d, long e, long f, long g, int h,
+          char i) {
+  return a + 2 * b + 3 * c + 4 * d + 5 * e + 6 * f + 7 * g + 8 * h + 9 * i;
+}
+
+struct three make_three(char a, char b, char c) {
+  struct three t;
+  t.a = a; t.b = b; t.c = c;
+  return t;
+}
+
+struct pair make_pair(long x, int y) {
+  struct pair p;
+  p.x = x; p.y = y;
+  return p;
+}
+
+struct big make_big(long a, long b, long c) {
+  struct big s;
+  s.a = a; s.b = b; s.c = c;
+  return s;
+}
+
+int sum_three(struct three t) {
+  return t.a * 100 + t.b * 10 + t.c;
+}
+
+long sum_pair(int before, struct pair p, int after) {
+  return before + p.x * 10 + p.y + after;
+}
+
+long sum_big(struct big s) {
+  return s.a * 100 + s.b * 10 + s.c;
+}
+
+// The pair does not fit in the one register left, so it goes on the stack.
+long mixed(int a, int b, int c, int d, int e, struct pair p, struct big s,
+           char z) {
+  return a + b + c + d + e + p.x + p.y + s.a + s.b + s.c + z;
+}
+
+// Calls another function with arguments of its own on the stack.
+long forward(long a, long b, long c, long d, long e, long f, long g, int h,
+             char i) {
+  return many(i, h, g, f, e, d, c, b, a) + 1;
+}
+
+int main() {
+  if(many(1, 2, 3, 4, 5, 6, 7, 8, 9) != 285) return 1;
+  if(forward(1, 2, 3, 4, 5, 6, 7, 8, 9) != 166) return 2;
+
+  struct three t;
+  t = make_three(1, 2, 3);
+  if(t.a != 1 || t.b != 2 || t.c != 3) return 3;
+  if(sum_three(t) != 123) return 4;
+
+  struct pair p;
+  p = make_pair(7, 8);
+  if(p.x != 7 || p.y != 8) return 5;
+  if(sum_pair(1, p, 2) != 81) return 6;
+
+  struct big s;
+  s = make_big(1, 2, 3);
+  if(s.a != 1 || s.b != 2 || s.c != 3) return 7;
+  if(sum_big(s) != 123) return 8;
+
+  // The struct is read while the new value is stored over it.
+  s = make_big(s.c, s.b, s.a);
+  if(sum_big(s) != 321) return 9;
+
+  if(mixed(1, 2, 3, 4, 5, p, s, 100) != 136) return 10;
+  return 0;
+}
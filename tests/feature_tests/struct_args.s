@@ -0,0 +1,425 @@
+	.intel_syntax noprefix
+	.section .text
+	.global many
+	.global make_three
+	.global make_pair
+	.global make_big
+	.global sum_three
+	.global sum_pair
+	.global sum_big
+	.global mixed
+	.global forward
+	.global main
+many:
+	push rbp
+	mov rbp, rsp
+	mov rax, rdi
+	mov r11, QWORD PTR [rbp+16]
+	mov r10d, DWORD PTR [rbp+24]
+	mov dil, BYTE PTR [rbp+32]
+	sal rsi, 1
+	add rax, rsi
+	lea rdx, [rdx+2*rdx]
+	add rax, rdx
+	sal rcx, 2
+	add rax, rcx
+	lea r8, [r8+4*r8]
+	add rax, r8
+	lea r9, [r9+2*r9]
+	sal r9, 1
+	add rax, r9
+	imul r11, 7
+	add rax, r11
+	sal r10d, 3
+	movsx r10, r10d
+	add rax, r10
+	movsx edi, dil
+	lea rdi, [rdi+8*rdi]
+	movsx rdi, edi
+	add rax, rdi
+	mov rsp, rbp
+	pop rbp
+	ret
+make_three:
+	push rbp
+	mov rbp, rsp
+	sub rsp, 16
+	mov BYTE PTR [rbp-8], dil
+	mov BYTE PTR [rbp-7], sil
+	mov BYTE PTR [rbp-6], dl
+	movzx rax, WORD PTR [rbp-8]
+	movzx rcx, BYTE PTR [rbp-6]
+	sal rcx, 16
+	or rax, rcx
+	mov rsp, rbp
+	pop rbp
+	ret
+make_pair:
+	push rbp
+	mov rbp, rsp
+	sub rsp, 16
+	mov QWORD PTR [rbp-16], rdi
+	mov DWORD PTR [rbp-8], esi
+	mov rax, QWORD PTR [rbp-16]
+	mov edx, DWORD PTR [rbp-8]
+	mov rsp, rbp
+	pop rbp
+	ret
+make_big:
+	push rbp
+	mov rbp, rsp
+	sub rsp, 32
+	mov QWORD PTR [rbp-24], rsi
+	mov QWORD PTR [rbp-16], rdx
+	mov QWORD PTR [rbp-8], rcx
+	movdqu xmm15, XMMWORD PTR [rbp-24]
+	movdqu XMMWORD PTR [rdi], xmm15
+	movdqu xmm15, XMMWORD PTR [rbp-16]
+	movdqu XMMWORD PTR [rdi+8], xmm15
+	mov rax, rdi
+	mov rsp, rbp
+	pop rbp
+	ret
+sum_three:
+	push rbp
+	mov rbp, rsp
+	sub rsp, 16
+	mov WORD PTR [rbp-8], di
+	shr rdi, 16
+	mov BYTE PTR [rbp-6], dil
+	mov al, BYTE PTR [rbp-8]
+	movsx eax, al
+	lea rax, [rax+4*rax]
+	lea rax, [rax+4*rax]
+	sal eax, 2
+	mov cl, BYTE PTR [rbp-7]
+	movsx ecx, cl
+	lea rcx, [rcx+4*rcx]
+	sal ecx, 1
+	add eax, ecx
+	mov cl, BYTE PTR [rbp-6]
+	movsx ecx, cl
+	add eax, ecx
+	mov rsp, rbp
+	pop rbp
+	ret
+sum_pair:
+	push rbp
+	mov rbp, rsp
+	sub rsp, 16
+	mov QWORD PTR [rbp-16], rsi
+	mov DWORD PTR [rbp-8], edx
+	mov rax, QWORD PTR [rbp-16]
+	lea rax, [rax+4*rax]
+	sal rax, 1
+	movsx rdi, edi
+	add rax, rdi
+	mov edx, DWORD PTR [rbp-8]
+	movsx rdx, edx
+	add rax, rdx
+	movsx rcx, ecx
+	add rax, rcx
+	mov rsp, rbp
+	pop rbp
+	ret
+sum_big:
+	push rbp
+	mov rbp, rsp
+	sub rsp, 32
+	mov rax, QWORD PTR [rbp+16]
+	mov QWORD PTR [rbp-24], rax
+	mov rax, QWORD PTR [rbp+24]
+	mov QWORD PTR [rbp-16], rax
+	mov rax, QWORD PTR [rbp+32]
+	mov QWORD PTR [rbp-8], rax
+	mov rax, QWORD PTR [rbp-24]
+	lea rax, [rax+4*rax]
+	lea rax, [rax+4*rax]
+	sal rax, 2
+	mov rcx, QWORD PTR [rbp-16]
+	lea rcx, [rcx+4*rcx]
+	sal rcx, 1
+	add rax, rcx
+	mov rcx, QWORD PTR [rbp-8]
+	add rax, rcx
+	mov rsp, rbp
+	pop rbp
+	ret
+mixed:
+	push rbp
+	mov rbp, rsp
+	sub rsp, 48
+	mov rax, QWORD PTR [rbp+16]
+	mov QWORD PTR [rbp-40], rax
+	mov rax, QWORD PTR [rbp+24]
+	mov DWORD PTR [rbp-32], eax
+	mov rax, QWORD PTR [rbp+32]
+	mov QWORD PTR [rbp-24], rax
+	mov rax, QWORD PTR [rbp+40]
+	mov QWORD PTR [rbp-16], rax
+	mov rax, QWORD PTR [rbp+48]
+	mov QWORD PTR [rbp-8], rax
+	add edi, esi
+	add edx, edi
+	add ecx, edx
+	add r8d, ecx
+	mov rax, QWORD PTR [rbp-40]
+	movsx r8, r8d
+	add rax, r8
+	mov ecx, DWORD PTR [rbp-32]
+	movsx rcx, ecx
+	add rax, rcx
+	mov rcx, QWORD PTR [rbp-24]
+	add rax, rcx
+	mov rcx, QWORD PTR [rbp-16]
+	add rax, rcx
+	mov rcx, QWORD PTR [rbp-8]
+	add rax, rcx
+	movsx r9, r9b
+	add rax, r9
+	mov rsp, rbp
+	pop rbp
+	ret
+forward:
+	push rbp
+	mov rbp, rsp
+	push rbx
+	sub rsp, 24
+	mov r10, rdi
+	mov rax, rsi
+	mov r11, QWORD PTR [rbp+16]
+	mov esi, DWORD PTR [rbp+24]
+	mov dil, BYTE PTR [rbp+32]
+	lea rbx, [many]
+	movsx rdi, dil
+	movsx rsi, esi
+	mov QWORD PTR [rsp], rdx
+	mov DWORD PTR [rsp+8], eax
+	mov BYTE PTR [rsp+16], r10b
+	mov rdx, r11
+	xchg r9, rcx
+	call rbx
+	add rax, 1
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+main:
+	push rbp
+	mov rbp, rsp
+	push rbx
+	push r12
+	sub rsp, 80
+	lea rax, [many]
+	mov QWORD PTR [rsp], 7
+	mov DWORD PTR [rsp+8], 8
+	mov BYTE PTR [rsp+16], 9
+	mov rdi, 1
+	mov rsi, 2
+	mov rdx, 3
+	mov rcx, 4
+	mov r8, 5
+	mov r9, 6
+	call rax
+	cmp rax, 285
+	je __shivyc_label1
+	mov eax, 1
+	lea rsp, [rbp-16]
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label1:
+	lea rax, [forward]
+	mov QWORD PTR [rsp], 7
+	mov DWORD PTR [rsp+8], 8
+	mov BYTE PTR [rsp+16], 9
+	mov rdi, 1
+	mov rsi, 2
+	mov rdx, 3
+	mov rcx, 4
+	mov r8, 5
+	mov r9, 6
+	call rax
+	cmp rax, 166
+	je __shivyc_label2
+	mov eax, 2
+	lea rsp, [rbp-16]
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label2:
+	lea rax, [make_three]
+	mov dil, 1
+	mov sil, 2
+	mov dl, 3
+	call rax
+	mov WORD PTR [rbp-40], ax
+	shr rax, 16
+	mov BYTE PTR [rbp-38], al
+	mov al, BYTE PTR [rbp-40]
+	movsx eax, al
+	cmp eax, 1
+	jne __shivyc_label4
+	mov al, BYTE PTR [rbp-39]
+	movsx eax, al
+	cmp eax, 2
+	jne __shivyc_label4
+	mov al, BYTE PTR [rbp-38]
+	movsx eax, al
+	cmp eax, 3
+	je __shivyc_label3
+__shivyc_label4:
+	mov eax, 3
+	lea rsp, [rbp-16]
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label3:
+	lea rax, [sum_three]
+	movzx rdi, WORD PTR [rbp-40]
+	movzx rcx, BYTE PTR [rbp-38]
+	sal rcx, 16
+	or rdi, rcx
+	call rax
+	cmp eax, 123
+	je __shivyc_label5
+	mov eax, 4
+	lea rsp, [rbp-16]
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label5:
+	lea rax, [make_pair]
+	mov rdi, 7
+	mov esi, 8
+	call rax
+	mov QWORD PTR [rbp-56], rax
+	mov DWORD PTR [rbp-48], edx
+	mov rax, QWORD PTR [rbp-56]
+	cmp rax, 7
+	jne __shivyc_label7
+	mov eax, DWORD PTR [rbp-48]
+	cmp eax, 8
+	je __shivyc_label6
+__shivyc_label7:
+	mov eax, 5
+	lea rsp, [rbp-16]
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label6:
+	lea rax, [sum_pair]
+	mov edi, 1
+	mov rsi, QWORD PTR [rbp-56]
+	mov edx, DWORD PTR [rbp-48]
+	mov ecx, 2
+	call rax
+	cmp rax, 81
+	je __shivyc_label8
+	mov eax, 6
+	lea rsp, [rbp-16]
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label8:
+	lea r12, [make_big]
+	mov rsi, 1
+	mov rdx, 2
+	mov rcx, 3
+	lea rdi, [rbp-40]
+	call r12
+	mov rax, QWORD PTR [rbp-40]
+	cmp rax, 1
+	jne __shivyc_label10
+	mov rax, QWORD PTR [rbp-32]
+	cmp rax, 2
+	jne __shivyc_label10
+	mov rax, QWORD PTR [rbp-24]
+	cmp rax, 3
+	je __shivyc_label9
+__shivyc_label10:
+	mov eax, 7
+	lea rsp, [rbp-16]
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label9:
+	lea rbx, [sum_big]
+	mov rax, QWORD PTR [rbp-40]
+	mov QWORD PTR [rsp], rax
+	mov rax, QWORD PTR [rbp-32]
+	mov QWORD PTR [rsp+8], rax
+	mov rax, QWORD PTR [rbp-24]
+	mov QWORD PTR [rsp+16], rax
+	call rbx
+	cmp rax, 123
+	je __shivyc_label11
+	mov eax, 8
+	lea rsp, [rbp-16]
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label11:
+	mov rsi, QWORD PTR [rbp-24]
+	mov rdx, QWORD PTR [rbp-32]
+	mov rcx, QWORD PTR [rbp-40]
+	lea rdi, [rbp-40]
+	call r12
+	mov rax, QWORD PTR [rbp-40]
+	mov QWORD PTR [rsp], rax
+	mov rax, QWORD PTR [rbp-32]
+	mov QWORD PTR [rsp+8], rax
+	mov rax, QWORD PTR [rbp-24]
+	mov QWORD PTR [rsp+16], rax
+	call rbx
+	cmp rax, 321
+	je __shivyc_label12
+	mov eax, 9
+	lea rsp, [rbp-16]
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label12:
+	lea rax, [mixed]
+	mov r10, QWORD PTR [rbp-56]
+	mov QWORD PTR [rsp], r10
+	mov r10d, DWORD PTR [rbp-48]
+	mov QWORD PTR [rsp+8], r10
+	mov r10, QWORD PTR [rbp-40]
+	mov QWORD PTR [rsp+16], r10
+	mov r10, QWORD PTR [rbp-32]
+	mov QWORD PTR [rsp+24], r10
+	mov r10, QWORD PTR [rbp-24]
+	mov QWORD PTR [rsp+32], r10
+	mov edi, 1
+	mov esi, 2
+	mov edx, 3
+	mov ecx, 4
+	mov r8d, 5
+	mov r9b, 100
+	call rax
+	cmp rax, 136
+	je __shivyc_label13
+	mov eax, 10
+	lea rsp, [rbp-16]
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label13:
+	mov eax, 0
+	lea rsp, [rbp-16]
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+	.att_syntax noprefix
@@ -0,0 +1,101 @@
+// Dense case values are dispatched to with a jump table, and sparse ones
+// with a binary search.
+
+long five_billion = 5000000000;
+
+int dense(int x) {
+  switch(x) {
+    case 0: return 10;
+    case 1: return 11;
+    case 2: case 3: return 12;
+    case 5: return 15;
+    case 6: x = x * 2;
+    case 7: return x + 100;
+    default: return -1;
+  }
+}
+
+int sparse(long x) {
+  int r = 0;
+  switch(x) {
+    case -1000: r = 1; break;
+    case 7: r = 2; break;
+    case 100: r = 3; break;
+    case 1000: r = 4; break;
+    case 5000000000: r = 5; break;
+    case 123456: r = 6; break;
+    case 20: r = 7; break;
+    case 21: r = 8; break;
+  }
+  return r;
+}
+
+int vowel(unsigned char c) {
+  switch(c) {
+    case 'a': case 'e': case 'i': case 'o': case 'u': return 1;
+    case 255: return 2;
+    default: return 0;
+  }
+}
+
+int nested(int a, int b) {
+  int t = 0;
+  for(int i = 0; i < a; i++) {
+    switch(i % 4) {
+      case 0:
+        switch(b) { case 1: t += 1; break; default: t += 2; }
+        break;
+      case 1: continue;
+      case 2: t += 10;
+      default: t += 100;
+    }
+    t += 1000;
+  }
+  return t;
+}
+
+// More values are live across the jump table than there are registers.
+long live(long x, long k) {
+  long a = x + 3, b = x * 4, c = x * 5, d = x * 6, e = x * 7, f = x * 8;
+  long g = x * 9, h = x * 10, i = x * 11, j = x * 12, l = x * 13;
+  long m = x * 14, r = 0;
+  for(long t = 0; t < k; t++) {
+    a += b ^ t; b += c ^ t; c += d ^ t; d += e ^ t; e += f ^ t;
+    f += g ^ t; g += h ^ t; h += i ^ t; i += j ^ t; j += l ^ t;
+    l += m ^ t; m += a ^ t;
+    switch(t + k) {
+      case 10: r += a; break;
+      case 11: r += b; break;
+      case 12: r += c; break;
+      case 13: r += d; break;
+      case 14: r += e; break;
+      default: r += 100;
+    }
+  }
+  return r + k + x + a + b + c + d + e + f + g + h + i + j + l + m;
+}
+
+int main() {
+  if(dense(-1) != -1 || dense(0) != 10 || dense(3) != 12) return 1;
+  if(dense(4) != -1 || dense(5) != 15 || dense(6) != 112) return 2;
+  if(dense(7) != 107 || dense(8) != -1) return 3;
+
+  if(sparse(-1000) != 1 || sparse(7) != 2 || sparse(100) != 3) return 4;
+  if(sparse(1000) != 4 || sparse(five_billion) != 5) return 5;
+  if(sparse(123456) != 6 || sparse(20) != 7 || sparse(21) != 8) return 6;
+  if(sparse(22) != 0 || sparse(0) != 0) return 7;
+
+  if(vowel('a') != 1 || vowel('b') != 0 || vowel(255) != 2) return 8;
+
+  if(nested(10, 1) != 7423 || nested(7, 3) != 5324) return 9;
+
+  int k = 5;
+  switch(k) { }
+  switch(k) default: k = 3;
+  switch(k) { case 1 + 2: k = 9; }
+  if(k != 9) return 10;
+
+  if(live(8, 6) != 65557) return 11;
+
+  return 0;
+}
@@ -0,0 +1,364 @@
+	.intel_syntax noprefix
+	.section .data
+five_billion:
+	.quad 5000000000
+
+	.section .rodata
+	.align 8
+__shivyc_label191:
+	.quad __shivyc_label2
+	.quad __shivyc_label3
+	.quad __shivyc_label5
+	.quad __shivyc_label4
+	.quad __shivyc_label9
+	.quad __shivyc_label6
+	.quad __shivyc_label7
+	.quad __shivyc_label8
+
+	.section .text
+	.global five_billion
+	.global dense
+	.global sparse
+	.global vowel
+	.global nested
+	.global main
+dense:
+	push rbp
+	mov rbp, rsp
+	mov eax, edi
+	cmp eax, 7
+	ja __shivyc_label9
+	jmp QWORD PTR [__shivyc_label191+8*rax]
+__shivyc_label2:
+	mov eax, 10
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label3:
+	mov eax, 11
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label5:
+__shivyc_label4:
+	mov eax, 12
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label6:
+	mov eax, 15
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label7:
+	sal edi, 1
+__shivyc_label8:
+	add edi, 100
+	mov eax, edi
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label9:
+	mov eax, -1
+	mov rsp, rbp
+	pop rbp
+	ret
+sparse:
+	push rbp
+	mov rbp, rsp
+	cmp rdi, 100
+	jge __shivyc_label19
+	cmp rdi, 20
+	jge __shivyc_label20
+	cmp rdi, -1000
+	je __shivyc_label11
+	cmp rdi, 7
+	je __shivyc_label12
+	mov eax, 0
+	jmp __shivyc_label10
+__shivyc_label20:
+	cmp rdi, 20
+	je __shivyc_label17
+	cmp rdi, 21
+	je __shivyc_label18
+	mov eax, 0
+	jmp __shivyc_label10
+__shivyc_label19:
+	cmp rdi, 123456
+	jge __shivyc_label21
+	cmp rdi, 100
+	je __shivyc_label13
+	cmp rdi, 1000
+	je __shivyc_label14
+	mov eax, 0
+	jmp __shivyc_label10
+__shivyc_label21:
+	cmp rdi, 123456
+	je __shivyc_label16
+	mov rax, 5000000000
+	cmp rdi, rax
+	je __shivyc_label15
+	mov eax, 0
+	jmp __shivyc_label10
+__shivyc_label11:
+	mov eax, 1
+	jmp __shivyc_label10
+__shivyc_label12:
+	mov eax, 2
+	jmp __shivyc_label10
+__shivyc_label13:
+	mov eax, 3
+	jmp __shivyc_label10
+__shivyc_label14:
+	mov eax, 4
+	jmp __shivyc_label10
+__shivyc_label15:
+	mov eax, 5
+	jmp __shivyc_label10
+__shivyc_label16:
+	mov eax, 6
+	jmp __shivyc_label10
+__shivyc_label17:
+	mov eax, 7
+	jmp __shivyc_label10
+__shivyc_label18:
+	mov eax, 8
+__shivyc_label10:
+	mov rsp, rbp
+	pop rbp
+	ret
+vowel:
+	push rbp
+	mov rbp, rsp
+	movzx edi, dil
+	cmp edi, 111
+	jge __shivyc_label30
+	cmp edi, 97
+	je __shivyc_label27
+	cmp edi, 101
+	je __shivyc_label26
+	cmp edi, 105
+	je __shivyc_label25
+	jmp __shivyc_label29
+__shivyc_label30:
+	cmp edi, 111
+	je __shivyc_label24
+	cmp edi, 117
+	je __shivyc_label23
+	cmp edi, 255
+	je __shivyc_label28
+	jmp __shivyc_label29
+__shivyc_label27:
+__shivyc_label26:
+__shivyc_label25:
+__shivyc_label24:
+__shivyc_label23:
+	mov eax, 1
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label28:
+	mov eax, 2
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label29:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+nested:
+	push rbp
+	mov rbp, rsp
+	mov r8d, 1
+	cmp esi, 1
+	je __shivyc_label192
+	mov r8d, 0
+__shivyc_label192:
+	mov eax, 0
+	mov ecx, 0
+__shivyc_label31:
+	cmp ecx, edi
+	jge __shivyc_label33
+	mov edx, ecx
+	mov esi, edx
+	sar esi, 31
+	shr esi, 30
+	add esi, edx
+	sar esi, 2
+	sal esi, 2
+	sub edx, esi
+	cmp edx, 0
+	je __shivyc_label35
+	cmp edx, 1
+	je __shivyc_label36
+	cmp edx, 2
+	je __shivyc_label37
+	jmp __shivyc_label38
+__shivyc_label35:
+	cmp r8d, 0
+	jne __shivyc_label40
+	jmp __shivyc_label41
+__shivyc_label40:
+	add eax, 1
+	jmp __shivyc_label39
+__shivyc_label41:
+	add eax, 2
+__shivyc_label39:
+	jmp __shivyc_label34
+__shivyc_label36:
+	jmp __shivyc_label32
+__shivyc_label37:
+	add eax, 10
+__shivyc_label38:
+	add eax, 100
+__shivyc_label34:
+	add eax, 1000
+__shivyc_label32:
+	add ecx, 1
+	jmp __shivyc_label31
+__shivyc_label33:
+	mov rsp, rbp
+	pop rbp
+	ret
+main:
+	push rbp
+	mov rbp, rsp
+	push rbx
+	sub rsp, 8
+__shivyc_label70:
+__shivyc_label75:
+__shivyc_label76:
+__shivyc_label85:
+__shivyc_label89:
+__shivyc_label95:
+__shivyc_label42:
+__shivyc_label100:
+__shivyc_label105:
+__shivyc_label111:
+__shivyc_label115:
+__shivyc_label122:
+__shivyc_label125:
+__shivyc_label44:
+__shivyc_label133:
+__shivyc_label135:
+__shivyc_label140:
+__shivyc_label145:
+__shivyc_label46:
+	lea rbx, [sparse]
+	mov rdi, -1000
+	call rbx
+	cmp eax, 1
+	jne __shivyc_label49
+	mov rdi, 7
+	call rbx
+	cmp eax, 2
+	jne __shivyc_label49
+	mov rdi, 100
+	call rbx
+	cmp eax, 3
+	je __shivyc_label48
+__shivyc_label49:
+	mov eax, 4
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label48:
+	mov rdi, 1000
+	call rbx
+	cmp eax, 4
+	jne __shivyc_label51
+	mov rdi, QWORD PTR [five_billion]
+	call rbx
+	cmp eax, 5
+	je __shivyc_label50
+__shivyc_label51:
+	mov eax, 5
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label50:
+	mov rdi, 123456
+	call rbx
+	cmp eax, 6
+	jne __shivyc_label53
+	mov rdi, 20
+	call rbx
+	cmp eax, 7
+	jne __shivyc_label53
+	mov rdi, 21
+	call rbx
+	cmp eax, 8
+	je __shivyc_label52
+__shivyc_label53:
+	mov eax, 6
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label52:
+	mov rdi, 22
+	call rbx
+	cmp eax, 0
+	jne __shivyc_label55
+	mov rdi, 0
+	call rbx
+	cmp eax, 0
+	je __shivyc_label54
+__shivyc_label55:
+	mov eax, 7
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label54:
+	lea rbx, [vowel]
+	mov dil, 97
+	call rbx
+	cmp eax, 1
+	jne __shivyc_label57
+	mov dil, 98
+	call rbx
+	cmp eax, 0
+	jne __shivyc_label57
+	mov dil, 255
+	call rbx
+	cmp eax, 2
+	je __shivyc_label56
+__shivyc_label57:
+	mov eax, 8
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label56:
+	lea rbx, [nested]
+	mov edi, 10
+	mov esi, 1
+	call rbx
+	cmp eax, 7423
+	jne __shivyc_label59
+	mov edi, 7
+	mov esi, 3
+	call rbx
+	cmp eax, 5324
+	je __shivyc_label58
+__shivyc_label59:
+	mov eax, 9
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label58:
+__shivyc_label60:
+__shivyc_label62:
+__shivyc_label64:
+__shivyc_label65:
+	mov eax, 0
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+	.att_syntax noprefix
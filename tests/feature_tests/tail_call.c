@@ -0,0 +1,63 @@
+// Each of these recursions is deep enough to overflow the stack unless the
+// calls in tail position reuse the frame.
+
+long sum(long n, long acc) {
+  if(n == 0) return acc;
+  return sum(n - 1, acc + n);
+}
+
+int is_odd(int n);
+int is_even(int n) {
+  if(n == 0) return 1;
+  return is_odd(n - 1);
+}
+int is_odd(int n) {
+  if(n == 0) return 0;
+  return is_even(n - 1);
+}
+
+int count;
+void countdown(int n) {
+  if(n == 0) return;
+  count++;
+  countdown(n - 1);
+}
+
+int weigh(int a, int b, int c, int d, int e, int f) {
+  return a + 2 * b + 3 * c + 4 * d + 5 * e + 6 * f;
+}
+
+// The arguments are passed in each other's registers.
+int reverse(int a, int b, int c, int d, int e, int f) {
+  return weigh(f, e, d, c, b, a);
+}
+
+int rotate(int a, int b, int c, int d, int e, int f) {
+  return weigh(b, c, d, e, f, a);
+}
+
+int deref(int* p, int n) {
+  if(n == 0) return *p;
+  return deref(p, n - 1);
+}
+
+// This function passes a pointer into its frame, so its calls may not
+// reuse the frame.
+int pass_local(int n) {
+  int x = n;
+  if(n == 0) return 0;
+  return deref(&x, 3) + pass_local(n - 1);
+}
+
+int main() {
+  if(sum(3000000, 0) != 4500001500000) return 1;
+  if(!is_even(3000000) || is_odd(3000000)) return 2;
+
+  countdown(3000000);
+  if(count != 3000000) return 3;
+
+  if(reverse(1, 2, 3, 4, 5, 6) != 56) return 4;
+  if(rotate(1, 2, 3, 4, 5, 6) != 2 + 6 + 12 + 20 + 30 + 6) return 5;
+  if(pass_local(4) != 10) return 6;
+  return 0;
+}
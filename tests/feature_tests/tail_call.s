@@ -0,0 +1,274 @@
+	.intel_syntax noprefix
+	.comm count 4
+	.section .text
+	.global sum
+	.global is_odd
+	.global is_even
+	.global countdown
+	.global weigh
+	.global reverse
+	.global rotate
+	.global deref
+	.global pass_local
+	.global main
+sum:
+	push rbp
+	mov rbp, rsp
+__shivyc_label26:
+	cmp rdi, 0
+	jne __shivyc_label1
+	mov rax, rsi
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label1:
+	mov rax, rdi
+	sub rax, 1
+	add rsi, rdi
+	mov rdi, rax
+	jmp __shivyc_label26
+is_even:
+	push rbp
+	mov rbp, rsp
+__shivyc_label29:
+	cmp edi, 0
+	jne __shivyc_label2
+	mov eax, 1
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label2:
+	sub edi, 1
+	cmp edi, 0
+	jne __shivyc_label14
+	jmp __shivyc_label15
+__shivyc_label14:
+	sub edi, 1
+	jmp __shivyc_label29
+__shivyc_label15:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+is_odd:
+	push rbp
+	mov rbp, rsp
+	cmp edi, 0
+	jne __shivyc_label3
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label3:
+	lea rax, [is_even]
+	sub edi, 1
+	mov rsp, rbp
+	pop rbp
+	jmp rax
+countdown:
+	push rbp
+	mov rbp, rsp
+__shivyc_label36:
+	cmp edi, 0
+	jne __shivyc_label4
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label4:
+	mov eax, DWORD PTR [count]
+	add eax, 1
+	mov DWORD PTR [count], eax
+	sub edi, 1
+	jmp __shivyc_label36
+weigh:
+	push rbp
+	mov rbp, rsp
+	sal esi, 1
+	add edi, esi
+	lea rdx, [rdx+2*rdx]
+	add edi, edx
+	sal ecx, 2
+	add edi, ecx
+	lea r8, [r8+4*r8]
+	add edi, r8d
+	lea r9, [r9+2*r9]
+	sal r9d, 1
+	add edi, r9d
+	mov eax, edi
+	mov rsp, rbp
+	pop rbp
+	ret
+reverse:
+	push rbp
+	mov rbp, rsp
+	lea rax, [weigh]
+	xchg r9, rdi
+	xchg r8, rsi
+	xchg rcx, rdx
+	mov rsp, rbp
+	pop rbp
+	jmp rax
+rotate:
+	push rbp
+	mov rbp, rsp
+	lea rax, [weigh]
+	xchg r9, rdi
+	xchg r8, rdi
+	xchg rcx, rdi
+	xchg rdx, rdi
+	xchg rsi, rdi
+	mov rsp, rbp
+	pop rbp
+	jmp rax
+deref:
+	push rbp
+	mov rbp, rsp
+__shivyc_label42:
+	cmp esi, 0
+	jne __shivyc_label5
+	mov eax, DWORD PTR [rdi]
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label5:
+	sub esi, 1
+	jmp __shivyc_label42
+pass_local:
+	push rbp
+	mov rbp, rsp
+	push rbx
+	push r12
+	sub rsp, 16
+	mov r12d, edi
+	mov DWORD PTR [rbp-20], r12d
+	cmp r12d, 0
+	jne __shivyc_label6
+	mov eax, 0
+	lea rsp, [rbp-16]
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label6:
+	lea rdi, [rbp-20]
+__shivyc_label16:
+	lea rax, [deref]
+	mov esi, 2
+	call rax
+	mov ebx, eax
+__shivyc_label17:
+	lea rax, [pass_local]
+	sub r12d, 1
+	mov edi, r12d
+	call rax
+	add ebx, eax
+	mov eax, ebx
+	lea rsp, [rbp-16]
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+main:
+	push rbp
+	mov rbp, rsp
+	push rbx
+	sub rsp, 8
+__shivyc_label18:
+	lea rax, [sum]
+	mov rdi, 2999999
+	mov rsi, 3000000
+	call rax
+__shivyc_label19:
+	mov rcx, 4500001500000
+	cmp rax, rcx
+	je __shivyc_label7
+	mov eax, 1
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label7:
+	lea rbx, [is_even]
+	mov edi, 3000000
+	call rbx
+	cmp eax, 0
+	je __shivyc_label9
+__shivyc_label20:
+	mov edi, 2999999
+	call rbx
+__shivyc_label21:
+	cmp eax, 0
+	je __shivyc_label8
+__shivyc_label9:
+	mov eax, 2
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label8:
+__shivyc_label22:
+	mov eax, DWORD PTR [count]
+	add eax, 1
+	mov DWORD PTR [count], eax
+	lea rax, [countdown]
+	mov edi, 2999999
+	call rax
+__shivyc_label23:
+	cmp DWORD PTR [count], 3000000
+	je __shivyc_label10
+	mov eax, 3
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label10:
+	lea rbx, [weigh]
+	mov edi, 6
+	mov esi, 5
+	mov edx, 4
+	mov ecx, 3
+	mov r8d, 2
+	mov r9d, 1
+	call rbx
+__shivyc_label24:
+	cmp eax, 56
+	je __shivyc_label11
+	mov eax, 4
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label11:
+	mov edi, 2
+	mov esi, 3
+	mov edx, 4
+	mov ecx, 5
+	mov r8d, 6
+	mov r9d, 1
+	call rbx
+__shivyc_label25:
+	cmp eax, 76
+	je __shivyc_label12
+	mov eax, 5
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label12:
+	lea rax, [pass_local]
+	mov edi, 4
+	call rax
+	cmp eax, 10
+	je __shivyc_label13
+	mov eax, 6
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+__shivyc_label13:
+	mov eax, 0
+	lea rsp, [rbp-8]
+	pop rbx
+	pop rbp
+	ret
+	.att_syntax noprefix
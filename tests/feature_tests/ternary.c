@@ -0,0 +1,70 @@
+// Return: 0
+
+// A conditional whose arms have no side effects is computed with a
+// conditional move, and any other is computed with a branch, which must
+// only compute the arm chosen.
+
+int calls = 0;
+int count(int x) {
+  calls++;
+  return x;
+}
+
+struct pair { int a, b; };
+
+int max(int a, int b) { return a > b ? a : b; }
+unsigned umin(unsigned a, unsigned b) { return a < b ? a : b; }
+long widen(int c, char a, long b) { return c ? a : b; }
+int* nonnull(int* p, int* q) { return p ? p : q; }
+int sign(int x) { return x > 0 ? 1 : x < 0 ? -1 : 0; }
+
+int main() {
+  int arr[3];
+  int i = 5;
+  int* p = 0;
+  void* v = arr;
+  struct pair s1, s2, s3;
+
+  if(max(3, 9) != 9) return 1;
+  if(max(-3, -9) != -3) return 2;
+  if(umin((unsigned)-1, 7) != 7) return 3;
+  if(widen(1, -2, 100) != -2) return 4;
+  if(widen(0, -2, 10000000000) != 10000000000) return 5;
+  if(nonnull(p, arr) != arr) return 6;
+  if(nonnull(arr + 1, arr) != arr + 1) return 7;
+  if(sign(-7) != -1 || sign(0) != 0 || sign(12) != 1) return 8;
+
+  // Only the arm chosen is computed.
+  if((i ? count(1) : count(2)) != 1) return 9;
+  if(calls != 1) return 10;
+  i = 0 ? i++ : i--;
+  if(i != 5) return 11;
+
+  // The usual arithmetic conversions apply to both arms.
+  if((1 ? -1 : (unsigned)0) < 0) return 12;
+  if(sizeof(1 ? (char)1 : (char)2) != 4) return 13;
+  if(sizeof(0 ? 1 : (long)2) != 8) return 14;
+
+  // Pointers, null pointer constants, and void pointers.
+  p = i ? arr : 0;
+  if(p != arr) return 15;
+  if((i ? v : arr) != v) return 16;
+  if((i ? 0 : arr) != 0) return 17;
+
+  // Structs and void arms.
+  s1.a = 1;
+  s2.a = 2;
+  s3 = i == 5 ? s1 : s2;
+  if(s3.a != 1) return 18;
+  i ? (void)count(3) : (void)count(4);
+  if(calls != 2) return 19;
+
+  // The condition may be any scalar, and conditionals nest to the right.
+  if((p ? 3 : 4) != 3) return 20;
+  if((0 ? 1 : 0 ? 2 : 3) != 3) return 21;
+
+  // Constant expressions.
+  static int table[1 ? 3 : -1];
+  if(sizeof(table) != 12) return 22;
+  return 0;
+}
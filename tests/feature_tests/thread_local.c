@@ -0,0 +1,89 @@
+// Thread-local objects, both those defined here and reached at a fixed
+// offset from the thread pointer, and those defined by the helper and
+// reached through the global offset table.
+
+extern __thread int shared_count;
+extern _Thread_local long helper_array[4];
+int* shared_count_addr();
+
+_Thread_local int counter;
+static __thread int initialized = 42;
+__thread long local_array[5] = {1, 2, 3, 4, 5};
+__thread struct {
+  int a;
+  long b;
+} pair = {7, 8};
+
+int pthread_create(unsigned long* thread, void* attr, void* (*start)(void*),
+                   void* arg);
+int pthread_join(unsigned long thread, void** ret);
+
+int calls() {
+  static _Thread_local int count;
+  return ++count;
+}
+
+long sum(int n) {
+  long total = 0;
+  for (int i = 0; i < n; i++) total += local_array[i] + helper_array[i % 4];
+  return total;
+}
+
+// The values the other thread saw, and the addresses of its objects.
+int seen[8];
+int* addrs[3];
+
+void* worker(void* arg) {
+  seen[0] = counter;
+  seen[1] = initialized;
+  seen[2] = shared_count;
+  seen[3] = pair.a;
+  seen[4] = sum(5);
+  seen[5] = calls();
+
+  counter = 20;
+  initialized = 21;
+  shared_count = 22;
+  local_array[2] = 100;
+  helper_array[1] = 200;
+  seen[6] = counter + initialized + shared_count;
+  seen[7] = sum(5);
+
+  addrs[0] = &counter;
+  addrs[1] = shared_count_addr();
+  addrs[2] = (int*)&local_array[1];
+  return arg;
+}
+
+int main() {
+  if (counter != 0 || initialized != 42 || shared_count != 5) return 1;
+  if (pair.a != 7 || pair.b != 8) return 2;
+  if (sum(5) != 15) return 3;
+
+  counter = 1;
+  initialized++;
+  shared_count += 2;
+  pair.b = 9;
+  for (int i = 0; i < 4; i++) helper_array[i] = i;
+  if (sum(5) != 21) return 4;
+  if (calls() != 1 || calls() != 2) return 5;
+  if (shared_count_addr() != &shared_count) return 6;
+  int* p = &counter;
+  *p += 2;
+  if (counter != 3) return 7;
+
+  unsigned long thread;
+  if (pthread_create(&thread, 0, worker, 0)) return 8;
+  pthread_join(thread, 0);
+
+  // The other thread started with the initial values, and changed only
+  // its own copies.
+  if (seen[0] != 0 || seen[1] != 42 || seen[2] != 5 || seen[3] != 7)
+    return 9;
+  if (seen[4] != 15 || seen[5] != 1) return 10;
+  if (seen[6] != 63 || seen[7] != 312) return 11;
+  if (counter != 3 || initialized != 43 || shared_count != 7) return 12;
+  if (pair.b != 9 || sum(5) != 21 || calls() != 3) return 13;
+  if (addrs[0] == &counter || addrs[1] == &shared_count) return 14;
+  if (addrs[2] == (int*)&local_array[1]) return 15;
+}
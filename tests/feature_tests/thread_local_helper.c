@@ -0,0 +1,4 @@
+__thread int shared_count = 5;
+_Thread_local long helper_array[4];
+
+int* shared_count_addr() { return &shared_count; }
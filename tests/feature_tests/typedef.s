@@ -0,0 +1,31 @@
+	.intel_syntax noprefix
+	.section .text
+	.global main
+	.global function
+main:
+	push rbp
+	mov rbp, rsp
+	sub rsp, 16
+__shivyc_label1:
+	lea rax, [rbp-4]
+	mov DWORD PTR [rbp-4], 3
+	mov eax, DWORD PTR [rax]
+	cmp eax, 3
+	je __shivyc_label2
+	mov eax, 2
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label2:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+function:
+	push rbp
+	mov rbp, rsp
+	mov eax, esi
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
@@ -0,0 +1,145 @@
+	.intel_syntax noprefix
+	.section .text
+	.global main
+main:
+	push rbp
+	mov rbp, rsp
+	sub rsp, 144
+	lea rcx, [rbp-16]
+	lea rax, [rbp-16]
+	cmp rax, rax
+	je __shivyc_label1
+	mov eax, 2
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label1:
+	mov DWORD PTR [rbp-16], 10
+	mov eax, DWORD PTR [rbp-16]
+	cmp eax, 10
+	je __shivyc_label2
+	mov eax, 3
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label2:
+	lea rax, [rbp-16]
+	mov QWORD PTR [rbp-16], rax
+	mov rdx, QWORD PTR [rbp-16]
+	mov DWORD PTR [rdx], 20
+	mov edx, DWORD PTR [rbp-16]
+	cmp edx, 20
+	je __shivyc_label3
+	mov eax, 4
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label3:
+	mov rdx, rcx
+	add rdx, 0
+	mov DWORD PTR [rdx], 15
+	mov esi, DWORD PTR [rbp-16]
+	cmp esi, 15
+	je __shivyc_label4
+	mov eax, 5
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label4:
+	mov edx, DWORD PTR [rdx]
+	cmp edx, 15
+	je __shivyc_label5
+	mov eax, 11
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label5:
+	cmp rcx, rax
+	je __shivyc_label6
+	mov eax, 6
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label6:
+	add rax, 0
+	mov QWORD PTR [rax], 10
+	mov rcx, QWORD PTR [rax]
+	cmp rcx, 10
+	je __shivyc_label7
+	mov eax, 7
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label7:
+	mov rcx, QWORD PTR [rax]
+	cmp rcx, 10
+	je __shivyc_label8
+	mov eax, 8
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label8:
+	mov rcx, QWORD PTR [rax]
+	cmp rcx, 10
+	je __shivyc_label9
+	mov eax, 12
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label9:
+	mov rcx, QWORD PTR [rax]
+	cmp rcx, 10
+	je __shivyc_label10
+	mov eax, 9
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label10:
+	mov QWORD PTR [rax], 20
+	mov rax, QWORD PTR [rax]
+	cmp rax, 20
+	je __shivyc_label11
+	mov eax, 10
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label11:
+	lea rax, [rbp-136+4*9]
+	add rax, 0
+	add rax, 0
+	mov DWORD PTR [rax], 3
+	mov eax, DWORD PTR [rax]
+	cmp eax, 3
+	je __shivyc_label12
+	mov eax, 13
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label12:
+	lea rax, [rbp-136+4*0]
+	add rax, 36
+	add rax, 0
+	add rax, 0
+	mov eax, DWORD PTR [rax]
+	cmp eax, 3
+	je __shivyc_label13
+	mov eax, 14
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label13:
+	mov DWORD PTR [rbp-140], 4294967295
+	mov ax, WORD PTR [rbp-140]
+	movzx eax, ax
+	cmp eax, 65535
+	je __shivyc_label14
+	mov eax, 15
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label14:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
@@ -0,0 +1,56 @@
+// Loops which -funroll-loops unrolls, fully or with a loop for the rest.
+// Without that flag, this tests the same loops as they are.
+
+int sum(int* a, int n) {
+  int s = 0;
+  for(int i = 0; i < n; i++) s += a[i];
+  return s;
+}
+
+long weigh(char* a, unsigned long n) {
+  long odd = 0, even = 0;
+  for(unsigned long i = 0; i < n; i++) {
+    if(a[i] % 2) odd += a[i] * i;
+    else even -= a[i];
+  }
+  return odd * 1000 + even;
+}
+
+int fib(int start, int n) {
+  int a = start, b = 1;
+  for(int i = start; i < n; i++) {
+    int c = a + b;
+    a = b;
+    b = c;
+  }
+  return a;
+}
+
+int main() {
+  int a[50];
+  int total = 0;
+  for(int i = 0; i < 8; i++) total += i * i;
+  if(total != 140) return 1;
+
+  for(int i = 0; i < 50; i++) a[i] = 3 * i - 20;
+
+  // Every count of iterations left over, and loops which run no trips.
+  for(int n = 0; n < 12; n++) {
+    if(sum(a, n) != 3 * n * (n - 1) / 2 - 20 * n) return 2;
+  }
+  if(sum(a, 50) != 2675) return 3;
+  if(sum(a, -7)) return 4;
+
+  char c[13];
+  for(int i = 0; i < 13; i++) c[i] = i * 7;
+  if(weigh(c, 13) != 2002000 - 294) return 5;
+  if(weigh(c, 0) || weigh(c, 1)) return 6;
+
+  if(fib(0, 20) != 6765 || fib(1, 2) != 1 || fib(5, 3) != 5) return 7;
+
+  // Fully unrolled, with the index and a value left over used after.
+  int i, last = 0;
+  for(i = 3; i < 6; i++) last = a[i] + i;
+  if(i != 6 || last != 0) return 8;
+  return 0;
+}
@@ -0,0 +1,46 @@
+struct P {
+  int x;
+  int y;
+};
+
+struct P pts[8];
+int global = 1;
+
+void bump(int* p) {
+  (*p)++;
+  global++;
+}
+
+int main() {
+  for(int i = 0; i < 8; i++) {
+    pts[i].x = i;
+    pts[i].y = pts[i].x * 3;
+  }
+
+  int sum = 0;
+  for(int i = 0; i < 8; i++) sum += pts[i].x + pts[i].y;
+  if(sum != 112) return 1;
+
+  // Same expression, in either operand order
+  int a = sum * 2 + 1, b = 2 * sum + 1;
+  if(a != b) return 2;
+
+  // Reads must not be reused after a store or a call
+  int loc = 5;
+  int* p = &loc;
+  int r1 = *p + 1;
+  *p = 10;
+  int r2 = *p + 1;
+  if(r1 != 6 || r2 != 11) return 3;
+
+  int g1 = global;
+  bump(&loc);
+  int g2 = global;
+  if(g1 != 1 || g2 != 2) return 4;
+  if(loc != 11) return 5;
+
+  // Same operation on values of different type
+  unsigned int u = 4294967295;
+  int s = -1;
+  if(u / 2 == s / 2) return 6;
+}
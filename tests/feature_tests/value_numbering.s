@@ -0,0 +1,124 @@
+	.intel_syntax noprefix
+	.comm pts 64
+	.section .data
+global:
+	.int 1
+
+	.section .text
+	.global global
+	.global bump
+	.global main
+bump:
+	push rbp
+	mov rbp, rsp
+	mov eax, DWORD PTR [rdi]
+	add eax, 1
+	mov DWORD PTR [rdi], eax
+	mov eax, DWORD PTR [global]
+	add eax, 1
+	mov DWORD PTR [global], eax
+	mov rsp, rbp
+	pop rbp
+	ret
+main:
+	push rbp
+	mov rbp, rsp
+	sub rsp, 16
+	mov edx, 0
+__shivyc_label1:
+	cmp edx, 8
+	jge __shivyc_label3
+	movsx rax, edx
+	lea rcx, [pts+8*rax]
+	mov rax, rcx
+	add rax, 0
+	mov DWORD PTR [rax], edx
+	mov eax, DWORD PTR [rax]
+	lea rax, [rax+2*rax]
+	add rcx, 4
+	mov DWORD PTR [rcx], eax
+	add edx, 1
+	jmp __shivyc_label1
+__shivyc_label3:
+	mov eax, 0
+	mov esi, 0
+__shivyc_label4:
+	cmp esi, 8
+	jge __shivyc_label6
+	movsx rcx, esi
+	lea rdx, [pts+8*rcx]
+	mov rcx, rdx
+	add rcx, 0
+	mov ecx, DWORD PTR [rcx]
+	add rdx, 4
+	mov edx, DWORD PTR [rdx]
+	add ecx, edx
+	add eax, ecx
+	add esi, 1
+	jmp __shivyc_label4
+__shivyc_label6:
+	cmp eax, 112
+	je __shivyc_label7
+	mov eax, 1
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label7:
+	sal eax, 1
+	add eax, 1
+	cmp eax, eax
+	je __shivyc_label8
+	mov eax, 2
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label8:
+	mov DWORD PTR [rbp-4], 5
+	lea rdx, [rbp-4]
+	mov ecx, DWORD PTR [rdx]
+	add ecx, 1
+	mov DWORD PTR [rdx], 10
+	mov eax, DWORD PTR [rdx]
+	add eax, 1
+	cmp ecx, 6
+	jne __shivyc_label10
+	cmp eax, 11
+	je __shivyc_label9
+__shivyc_label10:
+	mov eax, 3
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label9:
+	mov ecx, DWORD PTR [global]
+	mov eax, DWORD PTR [rdx]
+	add eax, 1
+	mov DWORD PTR [rdx], eax
+	mov eax, DWORD PTR [global]
+	add eax, 1
+	mov DWORD PTR [global], eax
+__shivyc_label15:
+	mov eax, DWORD PTR [global]
+	cmp ecx, 1
+	jne __shivyc_label12
+	cmp eax, 2
+	je __shivyc_label11
+__shivyc_label12:
+	mov eax, 4
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label11:
+	cmp DWORD PTR [rbp-4], 11
+	je __shivyc_label13
+	mov eax, 5
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label13:
+__shivyc_label14:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
@@ -0,0 +1,75 @@
+// Loops which -ftree-vectorize and -mavx2 run on several elements at once.
+// Without those flags, this tests the same loops run one element at a time.
+
+void add(int* a, int* b, int* c, int n) {
+  for(int i = 0; i < n; i++) a[i] = b[i] + c[i];
+}
+
+void scale(short* a, short* b, short k, int n) {
+  for(int i = 0; i < n; i++) a[i] = b[i] * k + 3;
+}
+
+void bytes(char* a, char* b, int n) {
+  int i;
+  for(i = 0; i < n; i++) a[i] = b[i] - 1;
+}
+
+void square(int* a, int* b, int n) {
+  for(int i = 0; i < n; i++) a[i] = b[i] * b[i] - 7;
+}
+
+void from(long* a, long* b, long start, long n) {
+  for(long i = start; i < n; i++) a[i] = 5 - b[i];
+}
+
+int main() {
+  int a[100], b[100], c[100];
+  for(int i = 0; i < 100; i++) {
+    b[i] = i * 3;
+    c[i] = 1000 - i;
+  }
+
+  // Every trip count, including those with no vector or no loop at all.
+  for(int n = 0; n < 20; n++) {
+    for(int i = 0; i < 21; i++) a[i] = -1;
+    add(a, b, c, n);
+    for(int i = 0; i < n; i++) if(a[i] != 1000 + 2 * i) return 1;
+    if(a[n] != -1) return 2;
+  }
+
+  // The store overlaps the lanes of the next loads, or of the last ones.
+  add(b + 1, b, c, 50);
+  for(int i = 1; i <= 50; i++) if(b[i] != 1000 * i - i * (i - 1) / 2) return 3;
+  for(int i = 0; i < 100; i++) b[i] = i;
+  add(b, b + 3, c, 60);
+  for(int i = 0; i < 60; i++) if(b[i] != i + 3 + 1000 - i) return 4;
+  add(b, b, b, 100);
+  for(int i = 0; i < 60; i++) if(b[i] != 2006) return 5;
+
+  short s[50], t[50];
+  for(int i = 0; i < 50; i++) t[i] = i * 100 - 2000;
+  scale(s, t, -3, 47);
+  for(int i = 0; i < 47; i++) if(s[i] != (short)((i * 100 - 2000) * -3 + 3))
+    return 6;
+
+  char x[77], y[77];
+  for(int i = 0; i < 77; i++) y[i] = i * 5;
+  bytes(x, y, 77);
+  for(int i = 0; i < 77; i++) if(x[i] != (char)(i * 5 - 1)) return 7;
+  bytes(y + 2, y, 70);
+  for(int i = 0; i < 72; i++) if(y[i] != (char)(i * 5 - i / 2 * 11)) return 8;
+
+  square(a, c, 99);
+  for(int i = 0; i < 99; i++) if(a[i] != (1000 - i) * (1000 - i) - 7) return 9;
+
+  long la[33], lb[33];
+  for(int i = 0; i < 33; i++) {
+    la[i] = 0;
+    lb[i] = (long)i * 1000000007;
+  }
+  from(la, lb, 3, 33);
+  for(int i = 0; i < 3; i++) if(la[i] != 0) return 10;
+  for(int i = 3; i < 33; i++) if(la[i] != 5 - (long)i * 1000000007) return 11;
+  from(la, lb, 40, 33);
+  return 0;
+}
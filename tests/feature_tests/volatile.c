@@ -0,0 +1,50 @@
+// Volatile objects are loaded and stored once for each access the program
+// makes, even where the value is known.
+
+volatile int flag;
+
+struct regs {
+  int status;
+  long data;
+};
+
+int sum(volatile int* p, int n) {
+  int s = 0;
+  for(int i = 0; i < n; i++) s += *p;
+  return s;
+}
+
+int main() {
+  volatile int x = 3;
+  x = 4;
+  x = 5;
+  int y = x + x;
+  if(y != 10) return 1;
+
+  volatile double d = 1.5;
+  d += 2;
+  if(d != 3.5) return 2;
+
+  volatile struct regs r;
+  r.status = 7;
+  r.data = r.status + 1;
+  if(r.data != 8) return 3;
+
+  struct regs* volatile rp = (struct regs*)&r;
+  if(rp->status != 7) return 4;
+
+  flag++;
+  flag++;
+  if(flag != 2) return 5;
+  if(sum(&flag, 3) != 6) return 6;
+
+  volatile int arr[3] = {1, 2, 3};
+  arr[1] += arr[2];
+  if(arr[1] != 5) return 7;
+
+  const volatile int cv = 9;
+  const volatile int* pcv = &cv;
+  if(*pcv != 9) return 8;
+
+  return 0;
+}
@@ -0,0 +1,74 @@
+	.intel_syntax noprefix
+	.section .text
+	.global main
+main:
+	push rbp
+	mov rbp, rsp
+	mov eax, 0
+__shivyc_label1:
+	mov ecx, 0
+	cmp eax, 5
+	je __shivyc_label2
+	mov ecx, 1
+	add eax, 1
+	jmp __shivyc_label1
+__shivyc_label2:
+	cmp ecx, 0
+	je __shivyc_label3
+	mov eax, 1
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label3:
+	mov eax, 0
+	mov ecx, 0
+__shivyc_label4:
+	mov edx, 0
+	cmp eax, 5
+	je __shivyc_label5
+	mov edx, 1
+	add ecx, eax
+	add eax, 1
+	jmp __shivyc_label4
+__shivyc_label5:
+	cmp edx, 0
+	je __shivyc_label6
+	mov eax, 2
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label6:
+	cmp ecx, 10
+	je __shivyc_label7
+	mov eax, 3
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label7:
+	cmp ecx, 100
+	jne __shivyc_label9
+	mov eax, 4
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label9:
+	mov eax, 0
+__shivyc_label10:
+	cmp ecx, 10
+	jne __shivyc_label11
+	add ecx, 1
+	add eax, 1
+	cmp eax, 1
+	je __shivyc_label12
+	mov eax, 5
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label12:
+	jmp __shivyc_label10
+__shivyc_label11:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
@@ -0,0 +1,56 @@
+// Return: 0
+
+// A constant too large to be an immediate operand is moved into a register
+// once, outside the loops which use it, and shared by its uses.
+
+unsigned long hash(char* s) {
+  unsigned long h = 1469598103934665603;
+  for(; *s; s++) {
+    h = h ^ *s;
+    h = h * 1099511628211;
+  }
+  return h;
+}
+
+long mask(long* a, int n) {
+  long s = 0;
+  for(int i = 0; i < n; i++) {
+    s += a[i] & 1099511627775;
+    if(a[i] > 4294967296) s -= 4294967296;
+  }
+  return s;
+}
+
+struct S {
+  int a;
+  long l;
+};
+
+void store(struct S* s, long* arr, int i) {
+  s->l = 1234567890123;
+  arr[i] = 7000000000;
+  arr[i + 1] = -7000000000;
+}
+
+int main() {
+  if(hash("hello") != 25347132070217633) return 1;
+
+  long a[3] = {1099511627781, 7, -1};
+  if(mask(a, 3) != 1099511627787 - 4294967296) return 2;
+
+  long b = -1;
+  if((b & 1099511627775) + 1 != 1099511627776) return 3;
+  if(b * 4294967297 != -4294967297) return 4;
+
+  struct S s;
+  long arr[3];
+  store(&s, arr, 1);
+  if(s.l != 1234567890123) return 5;
+  if(arr[1] != 7000000000 || arr[2] != -7000000000) return 6;
+
+  s.l = 1234567890123;
+  arr[0] = 7000000000;
+  if(s.l != 1234567890123 || arr[0] != 7000000000) return 7;
+
+  return 0;
+}
@@ -0,0 +1,31 @@
+// error: no macro name given in #define directive
+#define
+// error: macro names must be identifiers
+#define 3
+// error: invalid macro parameter list
+#define DUP(x, x) x
+// error: '#' is not followed by a macro parameter
+#define BAD_STR(x) #y
+// error: '##' cannot appear at either end of a macro expansion
+#define BAD_PASTE ## a
+// error: invalid preprocessing directive '#foo'
+#foo
+// error: #if with no expression
+#if
+#endif
+// error: division by zero in preprocessor expression
+#if 1 / 0
+#endif
+// error: #else without #if
+#else
+// error: #error stop here
+#error stop here
+
+#define ONE(x) x
+int main() {
+  // error: macro 'ONE' requires 1 argument, but 2 given
+  return ONE(1, 2);
+}
+
+// error: unterminated conditional directive
+#if 1
@@ -0,0 +1,29 @@
+	.intel_syntax noprefix
+	.section .rodata.str1.1,"aMS",@progbits,1
+__strlit5:
+	.asciz "*/"
+__strlit8:
+	.asciz "hel  lo///*"
+
+	.section .text
+	.global main
+main:
+	push rbp
+	mov rbp, rsp
+	lea rdi, [__strlit8]
+	lea rax, [strcmp]
+	lea rsi, [__strlit8]
+	call rax
+	cmp eax, 0
+	je __shivyc_label1943
+	mov eax, 1
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label1943:
+__shivyc_label1944:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
@@ -0,0 +1,79 @@
+	.intel_syntax noprefix
+	.section .rodata.str1.1,"aMS",@progbits,1
+__strlit29:
+	.asciz "\"\\\n\\t"
+
+	.section .text
+	.global main
+main:
+	push rbp
+	mov rbp, rsp
+	lea rcx, [__strlit29]
+	mov al, BYTE PTR [rcx]
+	movsx eax, al
+	cmp eax, 34
+	je __shivyc_label1949
+	mov eax, 1
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label1949:
+	mov rax, rcx
+	add rax, 1
+	mov al, BYTE PTR [rax]
+	movsx eax, al
+	cmp eax, 92
+	je __shivyc_label1950
+	mov eax, 2
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label1950:
+	mov rax, rcx
+	add rax, 2
+	mov al, BYTE PTR [rax]
+	movsx eax, al
+	cmp eax, 10
+	je __shivyc_label1951
+	mov eax, 3
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label1951:
+	mov rax, rcx
+	add rax, 3
+	mov al, BYTE PTR [rax]
+	movsx eax, al
+	cmp eax, 92
+	je __shivyc_label1952
+	mov eax, 4
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label1952:
+	mov rax, rcx
+	add rax, 4
+	mov al, BYTE PTR [rax]
+	movsx eax, al
+	cmp eax, 116
+	je __shivyc_label1953
+	mov eax, 5
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label1953:
+	add rcx, 5
+	mov al, BYTE PTR [rcx]
+	movsx eax, al
+	cmp eax, 0
+	je __shivyc_label1954
+	mov eax, 6
+	mov rsp, rbp
+	pop rbp
+	ret
+__shivyc_label1954:
+	mov eax, 0
+	mov rsp, rbp
+	pop rbp
+	ret
+	.att_syntax noprefix
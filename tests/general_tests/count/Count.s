@@ -0,0 +1,316 @@
+	.intel_syntax noprefix
+	.section .rodata.str1.1,"aMS",@progbits,1
+__strlit92:
+	.asciz " //%d"
+
+	.section .text
+	.global main
+main:
+	push rbp
+	mov rbp, rsp
+	push rbx
+	push r12
+	push r13
+	push r14
+	push r15
+	sub rsp, 56
+	lea rax, [__strlit92]
+	mov QWORD PTR [rbp-56], rax
+	mov r10d, 0
+	mov ebx, 0
+	mov r15d, 0
+	mov r9d, 0
+	mov r13d, 0
+	mov esi, 0
+	mov edi, 0
+	mov edx, 0
+	mov eax, 0
+	mov ecx, 0
+	mov r12d, 0
+__shivyc_label1962:
+	mov DWORD PTR [rbp-64], r10d
+	mov DWORD PTR [rbp-80], ebx
+	mov r14d, r9d
+	mov DWORD PTR [rbp-60], esi
+	mov DWORD PTR [rbp-84], edi
+	mov DWORD PTR [rbp-76], edx
+	mov DWORD PTR [rbp-68], eax
+	mov DWORD PTR [rbp-88], ecx
+	lea rax, [getchar]
+	mov QWORD PTR [rbp-48], rax
+	call QWORD PTR [rbp-48]
+	mov ebx, eax
+	cmp ebx, -1
+	je __shivyc_label1963
+	call QWORD PTR [rbp-48]
+	mov DWORD PTR [rbp-72], eax
+	mov eax, 1
+	cmp ebx, 92
+	je __shivyc_label2042
+	mov eax, 0
+__shivyc_label2042:
+	mov DWORD PTR [rbp-92], eax
+	cmp DWORD PTR [rbp-92], 0
+	je __shivyc_label1964
+	cmp DWORD PTR [rbp-72], 10
+	jne __shivyc_label1964
+	lea rax, [putchar]
+	mov QWORD PTR [rbp-48], rax
+	mov edi, ebx
+	call QWORD PTR [rbp-48]
+	mov edi, DWORD PTR [rbp-72]
+	call QWORD PTR [rbp-48]
+	mov eax, DWORD PTR [rbp-64]
+	mov ebx, DWORD PTR [rbp-80]
+	mov edx, r14d
+	mov r14d, DWORD PTR [rbp-60]
+	mov edi, DWORD PTR [rbp-84]
+	mov esi, DWORD PTR [rbp-76]
+	mov r8d, DWORD PTR [rbp-68]
+	mov ecx, DWORD PTR [rbp-88]
+	jmp __shivyc_label1965
+__shivyc_label1964:
+	lea rax, [ungetc]
+	mov rsi, QWORD PTR [stdin]
+	mov edi, DWORD PTR [rbp-72]
+	call rax
+	mov eax, 0
+	cmp DWORD PTR [rbp-80], 47
+	jne __shivyc_label1966
+	mov eax, 1
+	cmp ebx, 42
+	jne __shivyc_label1966
+	cmp r15d, 0
+	jne __shivyc_label1966
+	cmp r14d, 0
+	jne __shivyc_label1966
+	cmp r13d, 0
+	jne __shivyc_label1966
+	mov eax, 1
+	mov ecx, DWORD PTR [rbp-76]
+	mov edx, 0
+	jmp __shivyc_label1967
+__shivyc_label1966:
+	cmp DWORD PTR [rbp-80], 42
+	jne __shivyc_label1968
+	cmp ebx, 47
+	jne __shivyc_label1968
+	mov eax, 0
+	mov ecx, DWORD PTR [rbp-84]
+	mov edx, 1
+	jmp __shivyc_label1969
+__shivyc_label1968:
+	cmp eax, 0
+	je __shivyc_label1970
+	cmp ebx, 47
+	jne __shivyc_label1970
+	cmp r15d, 0
+	jne __shivyc_label1970
+	cmp r14d, 0
+	jne __shivyc_label1970
+	cmp DWORD PTR [rbp-60], 0
+	jne __shivyc_label1970
+	mov r13d, 1
+	mov ecx, DWORD PTR [rbp-76]
+	jmp __shivyc_label1971
+__shivyc_label1970:
+	cmp ebx, 34
+	jne __shivyc_label1972
+	cmp r14d, 0
+	jne __shivyc_label1972
+	cmp DWORD PTR [rbp-60], 0
+	jne __shivyc_label1972
+	cmp r13d, 0
+	jne __shivyc_label1972
+	cmp DWORD PTR [rbp-68], 0
+	jne __shivyc_label1972
+	mov ecx, 1
+	cmp r15d, 0
+	je __shivyc_label1973
+	mov ecx, 0
+__shivyc_label1973:
+	mov eax, r14d
+	jmp __shivyc_label1974
+__shivyc_label1972:
+	mov eax, r14d
+	cmp ebx, 39
+	jne __shivyc_label1975
+	mov eax, r14d
+	cmp r15d, 0
+	jne __shivyc_label1975
+	mov eax, r14d
+	cmp DWORD PTR [rbp-60], 0
+	jne __shivyc_label1975
+	mov eax, r14d
+	cmp r13d, 0
+	jne __shivyc_label1975
+	mov eax, r14d
+	cmp DWORD PTR [rbp-68], 0
+	jne __shivyc_label1975
+	mov eax, 1
+	cmp r14d, 0
+	je __shivyc_label1976
+	mov eax, 0
+__shivyc_label1976:
+__shivyc_label1975:
+	mov ecx, r15d
+__shivyc_label1974:
+	mov r15d, ecx
+	mov r14d, eax
+	mov ecx, DWORD PTR [rbp-84]
+__shivyc_label1971:
+	mov eax, DWORD PTR [rbp-60]
+	mov edx, 0
+__shivyc_label1969:
+__shivyc_label1967:
+	mov DWORD PTR [rbp-80], r15d
+	mov DWORD PTR [rbp-76], r14d
+	mov r15d, r13d
+	mov r14d, eax
+	mov r13d, ecx
+	mov DWORD PTR [rbp-48], edx
+	cmp DWORD PTR [rbp-92], 0
+	je __shivyc_label1977
+	mov eax, 1
+	cmp DWORD PTR [rbp-68], 0
+	je __shivyc_label1978
+	mov eax, 0
+__shivyc_label1978:
+	jmp __shivyc_label1979
+__shivyc_label1977:
+	mov eax, 0
+__shivyc_label1979:
+	mov DWORD PTR [rbp-72], eax
+	mov edx, r13d
+	cmp ebx, 123
+	je __shivyc_label1980
+	mov edx, r13d
+	cmp ebx, 125
+	je __shivyc_label1980
+	lea rax, [isspace]
+	mov edi, ebx
+	call rax
+	mov edx, r13d
+	cmp eax, 0
+	jne __shivyc_label1980
+	mov edx, r13d
+	cmp r14d, 0
+	jne __shivyc_label1980
+	mov edx, r13d
+	cmp r15d, 0
+	jne __shivyc_label1980
+	mov edx, r13d
+	cmp DWORD PTR [rbp-48], 0
+	jne __shivyc_label1980
+	mov edx, 1
+__shivyc_label1980:
+	mov eax, 0
+	cmp ebx, 101
+	jne __shivyc_label1981
+	mov eax, 1
+	cmp r12d, 0
+	jne __shivyc_label1981
+	cmp r14d, 0
+	jne __shivyc_label1981
+	cmp r15d, 0
+	jne __shivyc_label1981
+	add r12d, 1
+	mov eax, r13d
+	jmp __shivyc_label1982
+__shivyc_label1981:
+	cmp ebx, 108
+	jne __shivyc_label1983
+	cmp r12d, 1
+	jne __shivyc_label1983
+	add r12d, 1
+	jmp __shivyc_label1984
+__shivyc_label1983:
+	cmp ebx, 115
+	jne __shivyc_label1985
+	cmp r12d, 2
+	jne __shivyc_label1985
+	add r12d, 1
+	jmp __shivyc_label1986
+__shivyc_label1985:
+	cmp eax, 0
+	je __shivyc_label1987
+	cmp r12d, 3
+	jne __shivyc_label1987
+	mov edx, DWORD PTR [rbp-88]
+	jmp __shivyc_label1988
+__shivyc_label1987:
+__shivyc_label1988:
+	mov r12d, 0
+__shivyc_label1986:
+__shivyc_label1984:
+	mov eax, DWORD PTR [rbp-88]
+__shivyc_label1982:
+	mov DWORD PTR [rbp-68], r12d
+	mov r12d, 1
+	cmp ebx, 10
+	je __shivyc_label2045
+	mov r12d, 0
+__shivyc_label2045:
+	mov esi, DWORD PTR [rbp-64]
+	mov ecx, r13d
+	cmp r12d, 0
+	je __shivyc_label1989
+	mov esi, DWORD PTR [rbp-64]
+	mov ecx, r13d
+	cmp edx, 0
+	je __shivyc_label1989
+	mov esi, DWORD PTR [rbp-64]
+	mov ecx, r13d
+	cmp r14d, 0
+	jne __shivyc_label1989
+	lea rax, [printf]
+	mov r13d, DWORD PTR [rbp-64]
+	add r13d, 1
+	mov esi, r13d
+	mov rdi, QWORD PTR [rbp-56]
+	call rax
+	mov esi, r13d
+	mov edx, 0
+	mov ecx, 0
+	mov eax, 0
+__shivyc_label1989:
+	mov r13d, esi
+	mov DWORD PTR [rbp-48], edx
+	mov DWORD PTR [rbp-60], ecx
+	mov DWORD PTR [rbp-64], eax
+	cmp r12d, 0
+	je __shivyc_label1990
+	mov r15d, 0
+__shivyc_label1990:
+	mov r12d, r15d
+	lea rax, [putchar]
+	mov edi, ebx
+	call rax
+	mov eax, r13d
+	mov r15d, DWORD PTR [rbp-80]
+	mov edx, DWORD PTR [rbp-76]
+	mov r13d, r12d
+	mov edi, DWORD PTR [rbp-48]
+	mov esi, DWORD PTR [rbp-60]
+	mov r8d, DWORD PTR [rbp-72]
+	mov ecx, DWORD PTR [rbp-64]
+	mov r12d, DWORD PTR [rbp-68]
+__shivyc_label1965:
+	mov r10d, eax
+	mov eax, esi
+	mov r9d, edx
+	mov esi, r14d
+	mov edx, eax
+	mov eax, r8d
+	jmp __shivyc_label1962
+__shivyc_label1963:
+	mov eax, 0
+	lea rsp, [rbp-40]
+	pop r15
+	pop r14
+	pop r13
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+	.att_syntax noprefix
@@ -0,0 +1,99 @@
+	.intel_syntax noprefix
+	.section .rodata.str1.1,"aMS",@progbits,1
+__strlit49:
+	.asciz "%.4d"
+__strlit88:
+	.asciz "\n"
+
+	.section .text
+	.global main
+main:
+	push rbp
+	mov rbp, rsp
+	push rbx
+	push r12
+	push r13
+	push r14
+	sub rsp, 11216
+	mov eax, 0
+__shivyc_label2046:
+	mov ecx, eax
+	sub ecx, 2800
+	cmp ecx, 0
+	je __shivyc_label2048
+	mov ecx, eax
+	add ecx, 1
+	movsx rax, eax
+	mov DWORD PTR [rbp-11240+4*rax], 2000
+	mov eax, ecx
+	jmp __shivyc_label2046
+__shivyc_label2048:
+	lea r13, [__strlit49]
+	mov r12d, 2800
+	imul r12d, 2
+	mov ebx, 2800
+	mov esi, 0
+__shivyc_label2049:
+	cmp r12d, 0
+	je __shivyc_label2051
+	mov ecx, ebx
+	mov r14d, 0
+	mov edi, r12d
+__shivyc_label2052:
+	movsx r9, ecx
+	mov eax, DWORD PTR [rbp-11240+4*r9]
+	imul eax, 10000
+	add r14d, eax
+	mov r8d, edi
+	sub r8d, 1
+	mov eax, r14d
+	cdq
+	idiv r8d
+	mov DWORD PTR [rbp-11240+4*r9], edx
+	mov edi, r8d
+	sub edi, 1
+	mov eax, r14d
+	cdq
+	idiv r8d
+	mov r14d, eax
+	sub ecx, 1
+	cmp ecx, 0
+	je __shivyc_label2054
+	imul r14d, ecx
+	jmp __shivyc_label2052
+__shivyc_label2054:
+	sub ebx, 14
+	add r12d, -28
+	lea rcx, [printf]
+	movsx rax, r14d
+	imul rax, 1759218605
+	sar rax, 44
+	mov rdx, rax
+	shr rdx, 63
+	add rax, rdx
+	add esi, eax
+	mov rdi, r13
+	call rcx
+	movsx rsi, r14d
+	imul rsi, 1759218605
+	sar rsi, 44
+	mov rax, rsi
+	shr rax, 63
+	add rsi, rax
+	imul esi, 10000
+	neg esi
+	add esi, r14d
+	jmp __shivyc_label2049
+__shivyc_label2051:
+	lea rax, [printf]
+	lea rdi, [__strlit88]
+	call rax
+	mov eax, 0
+	lea rsp, [rbp-32]
+	pop r14
+	pop r13
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+	.att_syntax noprefix
@@ -0,0 +1,292 @@
+	.intel_syntax noprefix
+	.section .rodata.str1.1,"aMS",@progbits,1
+__strlit27:
+	.asciz "tests/general_tests/trie/words.txt"
+__strlit75:
+	.asciz "found word %s\n"
+__strlit119:
+	.asciz "notawordeithereither"
+__strlit126:
+	.asciz "notaword"
+__strlit145:
+	.asciz "populate"
+__strlit149:
+	.asciz "market"
+__strlit169:
+	.asciz "cannot find word %s\n"
+__strlit172:
+	.asciz "proper"
+__strlit197:
+	.asciz "notawordeither"
+__strlit201:
+	.asciz "motion"
+__strlit207:
+	.asciz "they're"
+__strlit224:
+	.asciz "doctor"
+__strlit228:
+	.asciz "many"
+__strlit250:
+	.asciz "r"
+
+	.section .text
+	.global load
+	.global check
+	.global main
+main:
+	push rbp
+	mov rbp, rsp
+	push rbx
+	push r12
+	push r13
+	push r14
+	push r15
+	sub rsp, 88
+	lea rax, [load]
+	lea rdi, [__strlit27]
+	call rax
+	mov r14, rax
+	lea rax, [__strlit224]
+	mov QWORD PTR [rbp-120+8*0], rax
+	lea rax, [__strlit207]
+	mov QWORD PTR [rbp-120+8*1], rax
+	lea rax, [__strlit228]
+	mov QWORD PTR [rbp-120+8*2], rax
+	lea rax, [__strlit149]
+	mov QWORD PTR [rbp-120+8*3], rax
+	lea rax, [__strlit145]
+	mov QWORD PTR [rbp-120+8*4], rax
+	lea rax, [__strlit172]
+	mov QWORD PTR [rbp-120+8*5], rax
+	lea rax, [__strlit201]
+	mov QWORD PTR [rbp-120+8*6], rax
+	lea rax, [__strlit126]
+	mov QWORD PTR [rbp-120+8*7], rax
+	lea rax, [__strlit197]
+	mov QWORD PTR [rbp-120+8*8], rax
+	lea rax, [__strlit119]
+	mov QWORD PTR [rbp-120+8*9], rax
+	lea r13, [__strlit75]
+	lea r12, [__strlit169]
+	mov ebx, 0
+__shivyc_label2059:
+	cmp ebx, 10
+	jge __shivyc_label2061
+	movsx rax, ebx
+	mov r15, QWORD PTR [rbp-120+8*rax]
+	lea rax, [check]
+	mov rdi, r14
+	mov rsi, r15
+	call rax
+	cmp al, 0
+	je __shivyc_label2062
+	lea rax, [printf]
+	mov rdi, r13
+	mov rsi, r15
+	call rax
+	jmp __shivyc_label2063
+__shivyc_label2062:
+	lea rax, [printf]
+	mov rdi, r12
+	mov rsi, r15
+	call rax
+__shivyc_label2063:
+	add ebx, 1
+	jmp __shivyc_label2059
+__shivyc_label2061:
+	mov eax, 0
+	lea rsp, [rbp-40]
+	pop r15
+	pop r14
+	pop r13
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+load:
+	push rbp
+	mov rbp, rsp
+	push rbx
+	push r12
+	push r13
+	push r14
+	sub rsp, 16
+	mov rbx, rdi
+	lea r14, [malloc]
+	mov rdi, 220
+	call r14
+	mov QWORD PTR [rbp-40], rax
+	mov rdx, 0
+	sal rdx, 3
+	mov ecx, 0
+__shivyc_label2064:
+	cmp ecx, 27
+	jge __shivyc_label2066
+	mov rax, QWORD PTR [rbp-40]
+	add rax, 0
+	add rax, rdx
+	mov QWORD PTR [rax], 0
+	add ecx, 1
+	add rdx, 8
+	jmp __shivyc_label2064
+__shivyc_label2066:
+	mov rax, QWORD PTR [rbp-40]
+	add rax, 216
+	mov DWORD PTR [rax], 1
+	lea rax, [fopen]
+	lea rsi, [__strlit250]
+	mov rdi, rbx
+	call rax
+	mov rbx, rax
+	lea r13, [rbp-40]
+	mov r12, r13
+__shivyc_label2067:
+	lea rax, [fgetc]
+	mov rdi, rbx
+	call rax
+	movsx eax, al
+	mov ecx, eax
+	add ecx, 1
+	cmp ecx, 0
+	je __shivyc_label2068
+	cmp eax, 10
+	jne __shivyc_label2069
+	mov rax, QWORD PTR [r12]
+	add rax, 216
+	mov DWORD PTR [rax], 1
+	mov r12, r13
+	jmp __shivyc_label2070
+__shivyc_label2069:
+	cmp eax, 39
+	jne __shivyc_label2071
+	mov r12, QWORD PTR [r12]
+	add r12, 0
+	add r12, 208
+	jmp __shivyc_label2072
+__shivyc_label2071:
+	mov rcx, QWORD PTR [r12]
+	add rcx, 0
+	mov QWORD PTR [rbp-48], rcx
+	sub eax, 97
+	movsx rax, eax
+	mov r12, QWORD PTR [rbp-48]
+	lea r12, [r12+8*rax]
+__shivyc_label2072:
+	mov rax, QWORD PTR [r12]
+	cmp rax, 0
+	jne __shivyc_label2073
+	mov rdi, 220
+	call r14
+	mov QWORD PTR [r12], rax
+	add rax, 216
+	mov DWORD PTR [rax], 0
+	mov rdx, 0
+	sal rdx, 3
+	mov ecx, 0
+__shivyc_label2074:
+	cmp ecx, 27
+	jge __shivyc_label2076
+	mov rax, QWORD PTR [r12]
+	add rax, 0
+	add rax, rdx
+	mov QWORD PTR [rax], 0
+	add ecx, 1
+	add rdx, 8
+	jmp __shivyc_label2074
+__shivyc_label2076:
+__shivyc_label2073:
+__shivyc_label2070:
+	jmp __shivyc_label2067
+__shivyc_label2068:
+	mov rax, QWORD PTR [r12]
+	add rax, 216
+	mov eax, DWORD PTR [rax]
+	cmp eax, 0
+	jne __shivyc_label2077
+	mov rax, QWORD PTR [r12]
+	add rax, 216
+	mov DWORD PTR [rax], 1
+__shivyc_label2077:
+	lea rax, [fclose]
+	mov rdi, rbx
+	call rax
+	mov rax, QWORD PTR [rbp-40]
+	lea rsp, [rbp-32]
+	pop r14
+	pop r13
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+check:
+	push rbp
+	mov rbp, rsp
+	push rbx
+	push r12
+	push r13
+	push r14
+	sub rsp, 16
+	mov rbx, rdi
+	mov r14, rsi
+	lea rax, [strlen]
+	mov rdi, r14
+	call rax
+	mov r13d, eax
+	mov r12d, 0
+__shivyc_label2078:
+	cmp r12d, r13d
+	jge __shivyc_label2080
+	movsx rcx, r12d
+	add rcx, r14
+	mov al, BYTE PTR [rcx]
+	movsx eax, al
+	cmp eax, 39
+	jne __shivyc_label2081
+	add rbx, 0
+	add rbx, 208
+	mov rbx, QWORD PTR [rbx]
+	jmp __shivyc_label2082
+__shivyc_label2081:
+	add rbx, 0
+	mov QWORD PTR [rbp-40], rbx
+	lea rax, [tolower]
+	mov dil, BYTE PTR [rcx]
+	movsx edi, dil
+	call rax
+	sub eax, 97
+	movsx rax, eax
+	mov rcx, QWORD PTR [rbp-40]
+	lea rax, [rcx+8*rax]
+	mov rbx, QWORD PTR [rax]
+__shivyc_label2082:
+	cmp rbx, 0
+	jne __shivyc_label2083
+	jmp __shivyc_label2080
+__shivyc_label2083:
+	add r12d, 1
+	jmp __shivyc_label2078
+__shivyc_label2080:
+	cmp rbx, 0
+	je __shivyc_label2084
+	add rbx, 216
+	mov eax, DWORD PTR [rbx]
+	cmp eax, 0
+	je __shivyc_label2084
+	mov ecx, 1
+	jmp __shivyc_label2085
+__shivyc_label2084:
+	mov ecx, 0
+__shivyc_label2085:
+	mov al, 0
+	cmp ecx, 0
+	je __shivyc_label2104
+	mov al, 1
+__shivyc_label2104:
+	lea rsp, [rbp-32]
+	pop r14
+	pop r13
+	pop r12
+	pop rbx
+	pop rbp
+	ret
+	.att_syntax noprefix
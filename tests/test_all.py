@@ -10,6 +10,9 @@ If a file name ends in "_helper.c", a test function is not generated for
 that file, but that file is linked into another test. For example,
 "function_helper.c" is linked into the test for "function.c".
 
+Each feature test is also run with each set of flags in flag_variants, which
+turn on optimizations and code generation the default flags leave off.
+
 If the C file contains a line of the form:
 
 // Return: ###
@@ -26,18 +29,49 @@ Then, the test expects compilation to raise an error or warning on the
 following line whose message is the string "____".
 """
 
+import ctypes
 import glob
+import os
 import pathlib
 import subprocess
+import tempfile
 import unittest
+import unittest.mock
 
+import shivyc.jit
 import shivyc.main
 from shivyc.errors import error_collector
 
+# The argument parser, which compile_with_shivyc mocks out.
+get_arguments = shivyc.main.get_arguments
+
+
+def _cpu_has(*features):
+    """Return whether the processor running the tests has the features."""
+    try:
+        with open("/proc/cpuinfo") as f:
+            flags = set(f.read().split())
+    except OSError:
+        return False
+    return all(feature in flags for feature in features)
+
+
+# Suffix of the name of each feature test run with other flags, and the
+# arguments those flags set.
+flag_variants = {
+    "unroll": {"unroll_loops": True},
+    "linear": {"reg_alloc": "linear"},
+    "vectorize": {"vectorize": True, "omit_frame_pointer": True},
+}
+if _cpu_has("popcnt", "bmi1", "abm"):
+    flag_variants["vectorize"].update(popcnt=True, bmi=True, lzcnt=True)
+
 
-def compile_with_shivyc(test_file_names):
+def compile_with_shivyc(test_file_names, flags=None):
     """Compile given file with ShivyC.
 
+    flags (dict) - Arguments to set other than the defaults, as in
+    flag_variants
     Errors are saved in the error collector.
 
     """
@@ -45,8 +79,59 @@ def compile_with_shivyc(test_file_names):
     class MockArguments:
         files = test_file_names
         show_reg_alloc_perf = False
+        reg_alloc_graph_dir = None
+        show_spills = False
+        reg_alloc = "graph"
         variables_on_stack = False
-
+        omit_frame_pointer = False
+        peephole = True
+        vectorize = False
+        avx2 = False
+        popcnt = False
+        bmi = False
+        lzcnt = False
+        tune = "generic"
+        align_loops = True
+        unroll_loops = False
+        unroll_factor = 4
+        profile_generate = False
+        profile_use = False
+        profile_file = "shivyc.prof"
+        strict_aliasing = True
+        show_peephole_hits = False
+        verbose_asm = False
+        debug = False
+        integrated_as = True
+        pipe = False
+        max_errors = 0
+        jobs = 1
+        cache_dir = None
+        pch = True
+        parse_memo = True
+        show_cache_stats = False
+        serve = None
+        run = False
+        run_args = []
+        compile_only = False
+        asm_only = False
+        output = None
+        dep_file = False
+        dep_file_name = None
+        time_report = None
+        opt_level = 2
+        dump_il_after = None
+        lto = False
+        function_sections = False
+        data_sections = False
+        linker_args = []
+        static = False
+        linker = None
+        pic = None
+        shared = False
+        pie = False
+
+    for name, value in (flags or {}).items():
+        setattr(MockArguments, name, value)
     shivyc.main.get_arguments = lambda: MockArguments()
 
     # Mock out error collector functions
@@ -80,8 +165,10 @@ def _read_params(test_file_name):
     return exp_errors, exp_warnings, exp_ret_val
 
 
-def generate_test(test_file_name, helper_name):
-    """Return a function that tests given file."""
+def generate_test(test_file_name, helper_name, flags=None):
+    """Return a function that tests given file, compiled with the given
+    arguments set as in flag_variants.
+    """
 
     def test_function(self):
         exp_errors, exp_warnings, exp_ret_val = _read_params(test_file_name)
@@ -90,12 +177,12 @@ def generate_test(test_file_name, helper_name):
             files = [test_file_name, helper_name]
         else:
             files = [test_file_name]
-        compile_with_shivyc(files)
+        compile_with_shivyc(files, flags)
 
         act_errors = []
         act_warnings = []
 
-        for issue in error_collector.issues:
+        for issue in sorted(error_collector.issues):
             issue_list = act_warnings if issue.warning else act_errors
             issue_list.append((issue.descrip, issue.range.start.line))
 
@@ -108,19 +195,25 @@ def generate_test(test_file_name, helper_name):
     return test_function
 
 
-def new(glob_str, dct):
-    """The implementation of __new__ used for generating tests."""
+def new(glob_str, dct, variant=None):
+    """The implementation of __new__ used for generating tests.
+
+    variant (str) - Key of the flags in flag_variants to compile with
+    """
     test_file_names = glob.glob(glob_str)
     for test_file_name in test_file_names:
         short_name = test_file_name.split("/")[-1][:-2]
         test_func_name = "test_" + short_name
+        if variant:
+            test_func_name += "_" + variant
 
         if not short_name.endswith("_helper"):
             helper_name = test_file_name.replace(".c", "_helper.c")
             if helper_name not in test_file_names:
                 helper_name = None
 
-            dct[test_func_name] = generate_test(test_file_name, helper_name)
+            dct[test_func_name] = generate_test(
+                test_file_name, helper_name, flag_variants.get(variant))
 
 
 class TestUtils(unittest.TestCase):
@@ -162,6 +255,22 @@ class FeatureTests(TestUtils, metaclass=MetaFeatureTests):
     pass
 
 
+class MetaFlagVariantTests(type):
+    """Metaclass for creating feature tests run with other flags."""
+
+    def __new__(meta, name, bases, dct):
+        """Create FlagVariantTests class."""
+        for variant in flag_variants:
+            new("tests/feature_tests/*.c", dct, variant)
+        return super().__new__(meta, name, bases, dct)
+
+
+class FlagVariantTests(TestUtils, metaclass=MetaFlagVariantTests):
+    """Feature tests compiled with each set of flags in flag_variants."""
+
+    pass
+
+
 class IntegrationTests(TestUtils):
     """Integration tests for the compiler.
 
@@ -220,3 +329,115 @@ class IntegrationTests(TestUtils):
         """Test the trie.c program."""
 
         self.io_test("general_tests/trie", "trie.c", None)
+
+    def test_compile_string(self):
+        """Test compiling source code in memory with compile_string."""
+        source = "int main() { int x = 6; return x * 7; }"
+        with unittest.mock.patch.object(shivyc.main, "get_arguments",
+                                        get_arguments):
+            asm = shivyc.main.compile_string(source, ["-S"])
+            objs = [shivyc.main.compile_string(source),
+                    shivyc.main.compile_string(
+                        source, ["-fno-integrated-as", "-O1"])]
+            bad = shivyc.main.compile_string("int main() { return x; }")
+            self.assertIsNone(bad)
+            self.assertEqual(len(error_collector.issues), 1)
+
+        self.assertIn("main:", asm)
+        with tempfile.TemporaryDirectory() as temp:
+            for obj in objs:
+                obj_name = os.path.join(temp, "string.o")
+                with open(obj_name, "wb") as obj_file:
+                    obj_file.write(obj)
+                out = os.path.join(temp, "out")
+                subprocess.run(["gcc", obj_name, "-o", out,
+                                "-z", "noexecstack"], check=True)
+                self.assertEqual(subprocess.run([out]).returncode, 42)
+
+    def test_pipe(self):
+        """Test piping the ASM of files compiled at once to `as`."""
+        files = ["tests/feature_tests/function_def.c",
+                 "tests/feature_tests/function_def_helper.c"]
+        with tempfile.TemporaryDirectory() as temp:
+            out = os.path.join(temp, "out")
+            flags = files + ["-fno-integrated-as", "-pipe", "-j2", "-o", out,
+                             "-Wl,-z,noexecstack"]
+            with unittest.mock.patch.object(
+                    shivyc.main, "get_arguments",
+                    lambda: get_arguments(flags)):
+                self.assertEqual(shivyc.main.main(), 0)
+            self.assertEqual(subprocess.run([out]).returncode, 0)
+            self.assertEqual(os.listdir(temp), ["out"])
+
+    def test_debug_info(self):
+        """Test that -g maps the code of a function to its source lines."""
+        source = "int twice(int x) {\n  return 2 * x;\n}\n"
+        source += "int main() { return twice(21) - 42; }\n"
+        with unittest.mock.patch.object(shivyc.main, "get_arguments",
+                                        get_arguments):
+            asm = shivyc.main.compile_string(source, ["-S", "-g"])
+            objs = [shivyc.main.compile_string(source, ["-g"]),
+                    shivyc.main.compile_string(
+                        source, ["-g", "-fno-integrated-as"])]
+
+        self.assertIn("\t.loc 1 2\n", asm)
+        self.assertIn("\t.cfi_startproc\n", asm)
+        with tempfile.TemporaryDirectory() as temp:
+            for obj in objs:
+                obj_name = os.path.join(temp, "string.o")
+                with open(obj_name, "wb") as obj_file:
+                    obj_file.write(obj)
+                out = os.path.join(temp, "out")
+                subprocess.run(["gcc", obj_name, "-o", out, "-no-pie",
+                                "-z", "noexecstack"], check=True)
+                symbols = subprocess.run(["nm", out], capture_output=True,
+                                         text=True, check=True).stdout
+                twice = next(line.split()[0] for line in symbols.splitlines()
+                             if line.endswith(" twice"))
+                lines = subprocess.run(
+                    ["addr2line", "-e", out, hex(int(twice, 16)),
+                     hex(int(twice, 16) + 4)],
+                    capture_output=True, text=True, check=True).stdout
+                self.assertEqual(
+                    [line.rsplit("/", 1)[-1] for line in lines.split()],
+                    ["string.c:1", "string.c:2"])
+
+    def test_max_errors(self):
+        """Test that compiling stops at the limit of -fmax-errors."""
+        source = "int main() { a = 1; b = 2; c = 3; d = 4; return 0; }"
+        with unittest.mock.patch.object(shivyc.main, "get_arguments",
+                                        get_arguments):
+            self.assertIsNone(shivyc.main.compile_string(source))
+            self.assertEqual(error_collector.errors, 4)
+            self.assertIsNone(shivyc.main.compile_string(
+                source, ["-fmax-errors=2"]))
+
+        descrips = [issue.descrip for issue in error_collector.issues]
+        self.assertEqual(descrips, [
+            "use of undeclared identifier 'a'",
+            "use of undeclared identifier 'b'",
+            "compilation terminated due to -fmax-errors=2"])
+
+    def test_jit(self):
+        """Test loading compiled code into the process and calling it."""
+        source = """
+        #include <stdlib.h>
+        #include <string.h>
+        int count;
+        static const char* names[] = {"zero", "one", "two"};
+        long len_of(int i) { count++; return strlen(names[i]); }
+        int main(int argc, char** argv) {
+          long n = len_of(1);
+          return atoi(argv[1]) + n + count;
+        }
+        """
+        with unittest.mock.patch.object(shivyc.main, "get_arguments",
+                                        get_arguments):
+            program = shivyc.jit.compile_string(source)
+            bad = shivyc.jit.compile_string("int f(); int main() { f(); }")
+            self.assertIsNone(bad)
+            self.assertEqual(len(error_collector.issues), 1)
+
+        len_of = program.function("len_of", ctypes.c_long, [ctypes.c_int])
+        self.assertEqual(len_of(2), 3)
+        self.assertEqual(program.run(["prog", "40"]), 45)